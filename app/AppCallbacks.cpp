@@ -1,8 +1,10 @@
 #include "EntropyApp.h"
 
+#include "image/ImageSampler.h"
 #include "logic/app/DataHelper.h"
 #include "rendering/TextureSetup.h"
 
+#include <array>
 #include <utility>
 
 namespace fs = std::filesystem;
@@ -17,10 +19,15 @@ void EntropyApp::setCallbacks()
     [this]() { m_imgui.render(); },
     [this]() {
       pollDicomSeriesScan();
+      m_callbackHandler.pollPoissonSegmentation();
       m_itkSnapSync.update();
       m_entropyInstanceSync.update();
       const bool syncEnabled = m_data.settings().cursorSyncEnabled() || m_data.settings().entropyInstanceSyncEnabled();
-      if (syncEnabled && !m_data.state().animating()) {
+
+      // Keep checking for streamed time points that are read in the background, so they are shown once read
+      const bool timePointsPending = !m_data.renderData().m_pendingTimePointUploads.empty();
+
+      if ((syncEnabled || timePointsPending) && !m_data.state().animating()) {
         m_glfw.setEventProcessingMode(EventProcessingMode::WaitTimeout);
         m_glfw.setWaitTimeout(1.0 / 30.0);
       }
@@ -34,6 +41,9 @@ void EntropyApp::setCallbacks()
   imguiCallbacks.platform.postEmptyGlfwEvent = [this]() {
     m_glfw.postEmptyEvent();
   };
+  imguiCallbacks.platform.invalidateViewRenderCache = [this]() {
+    m_rendering.invalidateViewRenderCache();
+  };
   imguiCallbacks.platform.readjustViewport = [this]() {
     resize(m_data.windowData().getWindowSize().x, m_data.windowData().getWindowSize().y);
   };
@@ -267,29 +277,22 @@ void EntropyApp::setCallbacks()
     }
 
     if (const auto coords = data::getImageVoxelCoordsContinuousAtCrosshairs(m_data, imageIndex)) {
+      ImageSamplerOptions options;
       if (getOnlyActiveComponent) {
-        if (
-          const auto a =
-            image->valueLinear<double>(image->settings().activeComponent(), coords->x, coords->y, coords->z))
-        {
-          // Return empty vector if component has undefined value
-          values.push_back(*a);
-        }
-        else {
-          return std::vector<double>{};
-        }
+        options.firstComponent = image->settings().activeComponent();
       }
       else {
-        for (uint32_t i = 0; i < image->header().numComponentsPerPixel(); ++i) {
-          if (const auto a = image->valueLinear<double>(i, coords->x, coords->y, coords->z)) {
-            values.push_back(*a);
-          }
-          else {
-            // Return empty vector if any component has undefined value
-            return std::vector<double>{};
-          }
-        }
+        options.numComponents = image->header().numComponentsPerPixel();
+      }
+
+      const std::array<glm::vec3, 1> position{*coords};
+      const auto samples = sampleImageAtPixels(*image, position, options);
+
+      // Return empty vector if any component has undefined value
+      if (!samples || !samples->isValid(0)) {
+        return std::vector<double>{};
       }
+      values = samples->values;
     }
 
     return values;
@@ -324,6 +327,11 @@ void EntropyApp::setCallbacks()
     return m_callbackHandler.clearSegVoxels(segUid);
   };
 
+  imguiCallbacks.editing.exportSegLabelMeshes =
+    [this](const uuids::uuid& segUid, const std::filesystem::path& directory) -> bool {
+    return m_callbackHandler.exportSegLabelMeshes(segUid, directory);
+  };
+
   imguiCallbacks.editing.removeSeg = [this](const uuids::uuid& segUid) -> bool {
     bool success = false;
     success |= m_data.removeSeg(segUid);
@@ -336,6 +344,14 @@ void EntropyApp::setCallbacks()
     return m_callbackHandler.executePoissonSegmentation(imageUid, seedSegUid, segType);
   };
 
+  imguiCallbacks.editing.getPoissonSegProgress = [this]() -> std::optional<float> {
+    return m_callbackHandler.poissonSegmentationProgress();
+  };
+
+  imguiCallbacks.editing.cancelPoissonSeg = [this]() {
+    m_callbackHandler.cancelPoissonSegmentation();
+  };
+
   imguiCallbacks.editing.setLockManualImageTransformation = [this](const uuids::uuid& imageUid, bool locked) -> bool {
     return m_callbackHandler.setLockManualImageTransformation(imageUid, locked);
   };
@@ -332,6 +332,9 @@ void EntropyApp::onImagesReady()
   renderData.m_imageTextures.clear();
   renderData.m_imageTextureLayouts.clear();
   renderData.m_distanceMapTextures.clear();
+  renderData.m_macrocells.clear();
+  renderData.m_brickedTextures.clear();
+  renderData.m_timePointUploadRings.clear();
   renderData.m_segTextures.clear();
   renderData.m_segTextureLayouts.clear();
   renderData.m_labelBufferTextures.clear();
@@ -495,6 +498,7 @@ void EntropyApp::resize(int windowWidth, int windowHeight)
 void EntropyApp::render()
 {
   pollDicomSeriesScan();
+  m_callbackHandler.pollPoissonSegmentation();
   m_glfw.renderOnce();
 }
 
@@ -563,6 +567,16 @@ ImGuiWrapper& EntropyApp::imgui()
   return m_imgui;
 }
 
+const Rendering& EntropyApp::rendering() const
+{
+  return m_rendering;
+}
+
+Rendering& EntropyApp::rendering()
+{
+  return m_rendering;
+}
+
 const WindowData& EntropyApp::windowData() const
 {
   return m_data.windowData();
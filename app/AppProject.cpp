@@ -999,6 +999,9 @@ void EntropyApp::closeProject()
   renderData.m_imageTextures.clear();
   renderData.m_imageTextureLayouts.clear();
   renderData.m_distanceMapTextures.clear();
+  renderData.m_macrocells.clear();
+  renderData.m_brickedTextures.clear();
+  renderData.m_timePointUploadRings.clear();
   renderData.m_segTextures.clear();
   renderData.m_segTextureLayouts.clear();
   renderData.m_labelBufferTextures.clear();
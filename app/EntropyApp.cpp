@@ -9,6 +9,7 @@
 
 #include "layout/LayoutFileSerialization.h"
 
+#include "logic/app/AppPaths.h"
 #include "logic/app/DataHelper.h"
 #include "logic/app/ImageSelectionPolicy.h"
 #include "logic/app/LoadingStatusItems.h"
@@ -181,6 +182,15 @@ ViewType nativeSliceViewType(const Image& image)
   return ViewType::Axial;
 }
 
+/// DICOM discovery options that keep file header indexes in the user cache directory, so that
+/// folders are scanned quickly when they are opened again
+dicom::DiscoverOptions dicomDiscoverOptions()
+{
+  dicom::DiscoverOptions options;
+  options.indexDirectory = app_paths::cacheDirectory() / "dicom";
+  return options;
+}
+
 serialize::DicomSource makeDicomSourceSnapshot(const dicom::SeriesInfo& series)
 {
   serialize::DicomSource source;
@@ -220,7 +230,7 @@ std::optional<dicom::SeriesInfo> resolveDicomSource(const serialize::DicomSource
     return std::nullopt;
   }
 
-  dicom::DiscoverResult result = dicom::discoverSeries(inputs);
+  dicom::DiscoverResult result = dicom::discoverSeries(inputs, dicomDiscoverOptions());
   for (const auto& series : result.series) {
     if (!series.loadable()) {
       continue;
@@ -237,6 +247,27 @@ std::optional<dicom::SeriesInfo> resolveDicomSource(const serialize::DicomSource
   return std::nullopt;
 }
 
+/// Resets the project prefetcher when leaving the scope of a project load
+class PrefetcherReset
+{
+public:
+  explicit PrefetcherReset(std::unique_ptr<ImagePrefetcher>& prefetcher)
+    : m_prefetcher(prefetcher)
+  {
+  }
+
+  PrefetcherReset(const PrefetcherReset&) = delete;
+  PrefetcherReset& operator=(const PrefetcherReset&) = delete;
+
+  ~PrefetcherReset()
+  {
+    m_prefetcher.reset();
+  }
+
+private:
+  std::unique_ptr<ImagePrefetcher>& m_prefetcher;
+};
+
 constexpr uint64_t LargeImageWarningBytes = 2ull * 1024ull * 1024ull * 1024ull;
 
 bool shouldPromptForLargeImage(const ImageHeader& header)
@@ -244,6 +275,18 @@ bool shouldPromptForLargeImage(const ImageHeader& header)
   return header.memoryImageSizeInBytes() >= LargeImageWarningBytes;
 }
 
+Image readSegmentationFile(const fs::path& fileName)
+{
+  // Creating an image as a segmentation will convert the pixel components to the most
+  // suitable unsigned integer type
+  return Image(fileName, Image::ImageRepresentation::Segmentation, Image::MultiComponentBufferType::SeparateImages);
+}
+
+Image readDeformationFieldFile(const fs::path& fileName)
+{
+  return Image(fileName, Image::ImageRepresentation::Image, Image::MultiComponentBufferType::InterleavedImage);
+}
+
 } // namespace
 
 std::pair<std::optional<uuids::uuid>, bool> EntropyApp::loadImage(const fs::path& fileName, bool ignoreIfAlreadyLoaded)
@@ -258,15 +301,34 @@ std::pair<std::optional<uuids::uuid>, bool> EntropyApp::loadImage(const fs::path
 
       if (image->header().fileName() == fileName) {
         spdlog::info("Image {} has already been loaded as {}", fileName, imageUid);
+        releasePrefetchedImage(ImagePrefetcher::Kind::Image, fileName);
         markLoadingStatusItemLoaded(GuiData::LoadingStatusItem::Kind::Image, fileName);
         return {imageUid, false};
       }
     }
   }
 
+  std::optional<Image> image = takePrefetchedImage(ImagePrefetcher::Kind::Image, fileName);
+  if (!image) {
+    image = readImageFile(fileName);
+  }
+  if (!image) {
+    return {std::nullopt, false};
+  }
+
+  logLoadedImageDetails(*image, fileName);
+
+  auto loadedImage = std::make_pair(m_data.addImage(std::move(*image)), true);
+  spdlog::info("Loaded image from {} as {}", fileName, loadedImage.first);
+  markLoadingStatusItemLoaded(GuiData::LoadingStatusItem::Kind::Image, fileName);
+  return loadedImage;
+}
+
+std::optional<Image> EntropyApp::readImageFile(const fs::path& fileName)
+{
   std::optional<Image> dicomImage;
   if (dicom::canReadDicomHeader(fileName)) {
-    dicom::DiscoverResult result = dicom::discoverSeries({fileName});
+    dicom::DiscoverResult result = dicom::discoverSeries({fileName}, dicomDiscoverOptions());
     std::error_code ec;
     const fs::path canonicalFileName = fs::weakly_canonical(fileName, ec);
     const fs::path comparableFileName = ec ? fileName : canonicalFileName;
@@ -295,20 +357,35 @@ std::pair<std::optional<uuids::uuid>, bool> EntropyApp::loadImage(const fs::path
         "Image file {} is a DICOM slice; loading containing series {}",
         fileName,
         matchingSeries->seriesInstanceUid);
-      dicomImage = dicom::loadSeriesImage(*matchingSeries);
+      dicomImage = dicom::loadSeriesImage(
+        *matchingSeries,
+        Image::ImageRepresentation::Image,
+        Image::MultiComponentBufferType::SeparateImages,
+        [this, &fileName](double fraction) {
+          setLoadingStatusItemProgress(GuiData::LoadingStatusItem::Kind::Image, fileName, static_cast<float>(fraction));
+        },
+        &m_imageLoadCancelled);
+
+      if (!dicomImage && m_imageLoadCancelled) {
+        return std::nullopt;
+      }
     }
   }
 
-  Image image = dicomImage
-                  ? std::move(*dicomImage)
-                  : Image(fileName, Image::ImageRepresentation::Image, Image::MultiComponentBufferType::SeparateImages);
-
-  logLoadedImageDetails(image, fileName);
+  std::optional<ImageFrameCacheOptions> frameStreaming;
+  if (const auto cacheBytes = m_data.settings().timeFrameCacheBytes()) {
+    frameStreaming = ImageFrameCacheOptions{};
+    frameStreaming->maxCacheBytes = *cacheBytes;
+  }
 
-  auto loadedImage = std::make_pair(m_data.addImage(std::move(image)), true);
-  spdlog::info("Loaded image from {} as {}", fileName, loadedImage.first);
-  markLoadingStatusItemLoaded(GuiData::LoadingStatusItem::Kind::Image, fileName);
-  return loadedImage;
+  if (dicomImage) {
+    return dicomImage;
+  }
+  return Image(
+    fileName,
+    Image::ImageRepresentation::Image,
+    Image::MultiComponentBufferType::SeparateImages,
+    frameStreaming);
 }
 
 std::pair<std::optional<uuids::uuid>, bool> EntropyApp::loadDicomSeriesImage(const dicom::SeriesInfo& series)
@@ -318,9 +395,25 @@ std::pair<std::optional<uuids::uuid>, bool> EntropyApp::loadDicomSeriesImage(con
     return {std::nullopt, false};
   }
 
-  std::optional<Image> image = dicom::loadSeriesImage(series);
+  std::optional<Image> image = dicom::loadSeriesImage(
+    series,
+    Image::ImageRepresentation::Image,
+    Image::MultiComponentBufferType::SeparateImages,
+    [this, &series](double fraction) {
+      setLoadingStatusItemProgress(
+        GuiData::LoadingStatusItem::Kind::Image,
+        series.files.front(),
+        static_cast<float>(fraction));
+    },
+    &m_imageLoadCancelled);
   if (!image) {
-    spdlog::error("Could not load DICOM series {}", series.seriesInstanceUid);
+    // A canceled load is not an error
+    if (m_imageLoadCancelled) {
+      spdlog::info("Canceled loading DICOM series {}", series.seriesInstanceUid);
+    }
+    else {
+      spdlog::error("Could not load DICOM series {}", series.seriesInstanceUid);
+    }
     return {std::nullopt, false};
   }
 
@@ -371,15 +464,15 @@ std::pair<std::optional<uuids::uuid>, bool> EntropyApp::loadSegmentation(
       spdlog::info("Segmentation from file {} has already been loaded as {}", fileName, segUid);
 
       if (!canLoadSameSegFileTwice) {
+        releasePrefetchedImage(ImagePrefetcher::Kind::Segmentation, fileName);
         markLoadingStatusItemLoaded(GuiData::LoadingStatusItem::Kind::Segmentation, fileName);
         return {segUid, false};
       }
     }
   }
 
-  // Creating an image as a segmentation will convert the pixel components to the most
-  // suitable unsigned integer type
-  Image seg(fileName, Image::ImageRepresentation::Segmentation, Image::MultiComponentBufferType::SeparateImages);
+  std::optional<Image> prefetchedSeg = takePrefetchedImage(ImagePrefetcher::Kind::Segmentation, fileName);
+  Image seg = prefetchedSeg ? std::move(*prefetchedSeg) : readSegmentationFile(fileName);
 
   // Set the default opacity:
   seg.settings().setOpacity(0.5);
@@ -505,6 +598,7 @@ std::pair<std::optional<uuids::uuid>, bool> EntropyApp::loadDeformationField(con
     if (const Image* def = m_data.def(defUid)) {
       if (def->header().fileName() == fileName) {
         spdlog::info("Warp field from {} has already been loaded as {}", fileName, defUid);
+        releasePrefetchedImage(ImagePrefetcher::Kind::Deformation, fileName);
         markLoadingStatusItemLoaded(GuiData::LoadingStatusItem::Kind::Image, fileName);
         return {defUid, false};
       }
@@ -518,12 +612,14 @@ std::pair<std::optional<uuids::uuid>, bool> EntropyApp::loadDeformationField(con
         mutableImage->settings().setComponentRenderMode(ComponentRenderMode::Magnitude);
       }
       spdlog::info("Using already-loaded image {} from {} as a warp field", imageUid, fileName);
+      releasePrefetchedImage(ImagePrefetcher::Kind::Deformation, fileName);
       markLoadingStatusItemLoaded(GuiData::LoadingStatusItem::Kind::Image, fileName);
       return {imageUid, false};
     }
   }
 
-  Image def(fileName, Image::ImageRepresentation::Image, Image::MultiComponentBufferType::InterleavedImage);
+  std::optional<Image> prefetchedDef = takePrefetchedImage(ImagePrefetcher::Kind::Deformation, fileName);
+  Image def = prefetchedDef ? std::move(*prefetchedDef) : readDeformationFieldFile(fileName);
 
   if (def.header().numComponentsPerPixel() < 3) {
     spdlog::error(
@@ -667,7 +763,12 @@ bool EntropyApp::loadSerializedImage(
   }
 
   if (!imageUid) {
-    spdlog::error("Unable to load image from {}", imageToLoad.m_imageFileName);
+    if (m_imageLoadCancelled) {
+      spdlog::debug("Loading image from {} was canceled", imageToLoad.m_imageFileName);
+    }
+    else {
+      spdlog::error("Unable to load image from {}", imageToLoad.m_imageFileName);
+    }
     return false;
   }
 
@@ -1731,9 +1832,10 @@ void EntropyApp::beginDicomSeriesScan(const std::vector<fs::path>& inputPaths, b
   m_glfw.postEmptyEvent();
 
   m_futureDiscoverDicom = std::async(std::launch::async, [scanInputs]() {
-    return dicom::discoverSeries(
-      scanInputs,
-      dicom::DiscoverOptions{.recursive = true, .includePrivateMetadata = false});
+    dicom::DiscoverOptions options = dicomDiscoverOptions();
+    options.recursive = true;
+    options.includePrivateMetadata = false;
+    return dicom::discoverSeries(scanInputs, options);
   });
 }
 
@@ -2056,6 +2158,9 @@ bool EntropyApp::removeImage(const uuids::uuid& imageUid)
   renderData.m_imageTextures.erase(imageUid);
   renderData.m_imageTextureLayouts.erase(imageUid);
   renderData.m_distanceMapTextures.erase(imageUid);
+  renderData.m_macrocells.erase(imageUid);
+  renderData.m_brickedTextures.erase(imageUid);
+  renderData.m_timePointUploadRings.erase(imageUid);
   renderData.m_uniforms.erase(imageUid);
 
   for (const auto& segUid : segUids) {
@@ -2089,6 +2194,10 @@ bool EntropyApp::removeImage(const uuids::uuid& imageUid)
 
 void EntropyApp::loadImagesFromParams(const InputParams& params)
 {
+  if (params.timeFrameCacheMiB) {
+    m_data.settings().setTimeFrameCacheBytes(*params.timeFrameCacheMiB * 1024u * 1024u);
+  }
+
   if (!params.dicomPaths.empty()) {
     m_pendingLayoutsFile = params.layoutsFile;
     performOpenDicomSeriesFolders(params.dicomPaths);
@@ -2140,6 +2249,24 @@ void EntropyApp::markLoadingStatusItemLoaded(GuiData::LoadingStatusItem::Kind ki
   }
 }
 
+void EntropyApp::setLoadingStatusItemProgress(
+  GuiData::LoadingStatusItem::Kind kind,
+  const fs::path& fileName,
+  float fractionLoaded)
+{
+  if (!m_data.guiData().m_loadingStatus) {
+    return;
+  }
+
+  std::scoped_lock lock(m_data.guiData().m_loadingStatus->mutex);
+  for (auto& item : m_data.guiData().m_loadingStatus->items) {
+    if (!item.loaded && item.kind == kind && loading_status::equivalentPath(item.fileName, fileName)) {
+      item.fractionLoaded = fractionLoaded;
+      break;
+    }
+  }
+}
+
 void EntropyApp::hideLoadingStatus()
 {
   if (!m_data.guiData().m_loadingStatus) {
@@ -2222,22 +2349,69 @@ void EntropyApp::startAsyncImageLoad(
     });
 }
 
-bool EntropyApp::loadProject(const serialize::EntropyProject& projectToLoad)
+std::unique_ptr<ImagePrefetcher> EntropyApp::makeProjectPrefetcher(const serialize::EntropyProject& project)
 {
-  static constexpr size_t defaultReferenceImageIndex = 0;
+  std::vector<ImagePrefetcher::Request> requests;
 
-  m_preserveLayoutsOnImagesReady = false;
-  m_pendingAddedImageUids.clear();
-  m_pendingWarpAssignment = std::nullopt;
-  m_pendingInverseWarpReferences.clear();
+  auto addRequests = [this, &requests](const serialize::Image& image) {
+    // Images of DICOM sources are resolved while loading and decode their slices in parallel
+    if (!image.m_dicomSource) {
+      requests.push_back(
+        {ImagePrefetcher::Kind::Image, image.m_imageFileName, [this, fileName = image.m_imageFileName]() {
+           return readImageFile(fileName);
+         }});
+    }
+    for (const auto& warpPath : {image.m_inverseWarpFieldPath, image.m_forwardWarpFieldPath}) {
+      if (warpPath) {
+        requests.push_back({ImagePrefetcher::Kind::Deformation, *warpPath, [fileName = *warpPath]() {
+                              return std::optional<Image>{readDeformationFieldFile(fileName)};
+                            }});
+      }
+    }
+    for (const auto& seg : image.m_segmentations) {
+      requests.push_back({ImagePrefetcher::Kind::Segmentation, seg.m_segFileName, [fileName = seg.m_segFileName]() {
+                            return std::optional<Image>{readSegmentationFile(fileName)};
+                          }});
+    }
+  };
 
-  spdlog::debug("Begin loading images in new thread");
+  addRequests(project.m_referenceImage);
+  for (const auto& image : project.m_additionalImages) {
+    addRequests(image);
+  }
 
-  if (m_imageLoadCancelled) {
-    return false;
+  return std::make_unique<ImagePrefetcher>(
+    std::move(requests),
+    0,
+    &m_imageLoadCancelled,
+    [this](const ImagePrefetcher::Request& request, bool success) {
+      if (success) {
+        const auto kind = (ImagePrefetcher::Kind::Segmentation == request.kind)
+                            ? GuiData::LoadingStatusItem::Kind::Segmentation
+                            : GuiData::LoadingStatusItem::Kind::Image;
+        setLoadingStatusItemProgress(kind, request.fileName, 1.0f);
+      }
+    });
+}
+
+std::optional<Image> EntropyApp::takePrefetchedImage(ImagePrefetcher::Kind kind, const fs::path& fileName)
+{
+  return m_projectPrefetcher ? m_projectPrefetcher->take(kind, fileName) : std::nullopt;
+}
+
+void EntropyApp::releasePrefetchedImage(ImagePrefetcher::Kind kind, const fs::path& fileName)
+{
+  if (m_projectPrefetcher) {
+    m_projectPrefetcher->release(kind, fileName);
   }
+}
 
+bool EntropyApp::loadProjectImages(const serialize::EntropyProject& projectToLoad)
+{
   if (!loadSerializedImage(projectToLoad.m_referenceImage, true)) {
+    if (m_imageLoadCancelled) {
+      return false;
+    }
     spdlog::critical("Could not load reference image from {}", projectToLoad.m_referenceImage.m_imageFileName);
     return false;
   }
@@ -2247,7 +2421,7 @@ bool EntropyApp::loadProject(const serialize::EntropyProject& projectToLoad)
   }
 
   for (const auto& additionalImage : projectToLoad.m_additionalImages) {
-    if (!loadSerializedImage(additionalImage, false)) {
+    if (!loadSerializedImage(additionalImage, false) && !m_imageLoadCancelled) {
       spdlog::error("Could not load additional image from {}; skipping it", additionalImage.m_imageFileName);
     }
 
@@ -2256,6 +2430,36 @@ bool EntropyApp::loadProject(const serialize::EntropyProject& projectToLoad)
     }
   }
 
+  return true;
+}
+
+bool EntropyApp::loadProject(const serialize::EntropyProject& projectToLoad)
+{
+  static constexpr size_t defaultReferenceImageIndex = 0;
+
+  m_preserveLayoutsOnImagesReady = false;
+  m_pendingAddedImageUids.clear();
+  m_pendingWarpAssignment = std::nullopt;
+  m_pendingInverseWarpReferences.clear();
+
+  spdlog::debug("Begin loading images in new thread");
+
+  if (m_imageLoadCancelled) {
+    return false;
+  }
+
+  // Image files are read concurrently, but are added to the app data in project order. The prefetcher is
+  // dropped on every exit, including exceptions, so that later loads never take its stale reads.
+  m_projectPrefetcher = makeProjectPrefetcher(projectToLoad);
+  const bool imagesLoaded = [this, &projectToLoad]() {
+    const PrefetcherReset prefetcherReset(m_projectPrefetcher);
+    return loadProjectImages(projectToLoad);
+  }();
+
+  if (!imagesLoaded) {
+    return false;
+  }
+
   for (const PendingInverseWarpReference& pendingReference : m_pendingInverseWarpReferences) {
     std::optional<uuids::uuid> resolvedReferenceUid;
     for (const uuids::uuid& candidateUid : m_data.imageUidsOrdered()) {
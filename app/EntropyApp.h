@@ -6,6 +6,7 @@
 
 #include "logic/app/CallbackHandler.h"
 #include "logic/app/Data.h"
+#include "logic/app/ImagePrefetcher.h"
 #include "logic/app/Settings.h"
 #include "logic/app/State.h"
 #include "logic/sync/EntropyInstanceSync.h"
@@ -23,6 +24,7 @@
 #include <cstdint>
 #include <functional>
 #include <future>
+#include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -238,6 +240,12 @@ public:
   /** @brief Access mutable ImGui services. */
   ImGuiWrapper& imgui();
 
+  /** @brief Access immutable render logic. */
+  const Rendering& rendering() const;
+
+  /** @brief Access mutable render logic. */
+  Rendering& rendering();
+
   /** @brief Access immutable layout/window state. */
   const WindowData& windowData() const;
 
@@ -308,6 +316,12 @@ private:
   /** @brief Mark one loading-status row as loaded. */
   void markLoadingStatusItemLoaded(GuiData::LoadingStatusItem::Kind kind, const std::filesystem::path& fileName);
 
+  /** @brief Set the partial progress of one loading-status row that is not yet loaded. */
+  void setLoadingStatusItemProgress(
+    GuiData::LoadingStatusItem::Kind kind,
+    const std::filesystem::path& fileName,
+    float fractionLoaded);
+
   /** @brief Hide and clear the loading-status popup. */
   void hideLoadingStatus();
 
@@ -360,6 +374,18 @@ private:
   /** @brief Load a serialized project snapshot into application data. */
   bool loadProject(const serialize::EntropyProject& project);
 
+  /** @brief Load the reference and additional images of a project, in project order. */
+  bool loadProjectImages(const serialize::EntropyProject& project);
+
+  /** @brief Start reading the image, segmentation and warp files of a project concurrently. */
+  std::unique_ptr<ImagePrefetcher> makeProjectPrefetcher(const serialize::EntropyProject& project);
+
+  /** @brief Take an image read ahead by the project prefetcher, or std::nullopt when there is none. */
+  std::optional<Image> takePrefetchedImage(ImagePrefetcher::Kind kind, const std::filesystem::path& fileName);
+
+  /** @brief Drop an image read ahead by the project prefetcher that will not be taken. */
+  void releasePrefetchedImage(ImagePrefetcher::Kind kind, const std::filesystem::path& fileName);
+
   /** @brief Create a serialized snapshot of the current project state. */
   serialize::EntropyProject createProjectSnapshot() const;
 
@@ -411,6 +437,13 @@ private:
     const std::filesystem::path& fileName,
     bool ignoreIfAlreadyLoaded);
 
+  /**
+   * @brief Read an image file, or the DICOM series that contains it, without adding it to the app data.
+   * @return The image, or std::nullopt when loading a DICOM series was canceled.
+   * @throws Propagates image-loading exceptions from the image library.
+   */
+  std::optional<Image> readImageFile(const std::filesystem::path& fileName);
+
   /**
    * @brief Load an already-discovered DICOM series without rescanning its source folder.
    * @param series DICOM series to load.
@@ -439,6 +472,11 @@ private:
    */
   std::atomic<bool> m_imageLoadCancelled;
 
+  /**
+   * Reads project image files ahead of the loader while a project loads
+   */
+  std::unique_ptr<ImagePrefetcher> m_projectPrefetcher;
+
   /**
    * Atomic boolean set to true when all project images are loaded from disk and
    * ready to be loaded into textures
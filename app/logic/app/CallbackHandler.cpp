@@ -18,6 +18,7 @@
 #include "logic/segmentation/Poisson.h"
 #include "logic/segmentation/SegHelpers.h"
 #include "logic/segmentation/SegHelpers.tpp"
+#include "mesh/MeshLoading.h"
 
 #include "rendering/Rendering.h"
 #include "rendering/TextureSetup.h"
@@ -35,6 +36,7 @@
 #include <glm/gtx/transform.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <limits>
 #include <utility>
@@ -108,6 +110,13 @@ bool anyTimeSeriesPlaybackRunning(const AppData& appData)
 CallbackHandler::CallbackHandler(AppData& appData, GlfwWrapper& glfwWrapper, Rendering& rendering)
   : m_appData(appData), m_glfw(glfwWrapper), m_rendering(rendering)
 {
+  // Keep the label statistics of edited segmentations current:
+  m_segEditHistory.setEditObserver(
+    [this](const uuid& segUid, std::span<const SegmentationLabelRun> runs, bool undone) {
+      if (auto it = m_segLabelIndices.find(segUid); std::end(m_segLabelIndices) != it) {
+        it->second.applyRuns(runs, undone);
+      }
+    });
 }
 
 bool CallbackHandler::clearSegVoxels(const uuid& segUid)
@@ -117,16 +126,63 @@ bool CallbackHandler::clearSegVoxels(const uuid& segUid)
     return false;
   }
 
-  seg->setAllValues(0);
-
   const glm::uvec3 dataOffset = glm::uvec3{0};
   const glm::uvec3 dataSize = glm::uvec3{seg->header().pixelDimensions()};
 
+  // The clear is undone as a step of its own. Its runs also keep the label statistics current.
+  endSegmentStroke();
+  const auto labelsBefore = SegEditHistory::captureBlock(*seg, glm::ivec3{dataOffset}, glm::ivec3{dataSize} - 1);
+
+  seg->setAllValues(0);
+
+  if (labelsBefore) {
+    recordSegmentationEdit(segUid, *labelsBefore, *seg);
+  }
+  else {
+    // Steps recorded before the clear can no longer be replayed onto the segmentation
+    spdlog::warn("Could not record clearing segmentation {}; discarding its edit history", segUid);
+    m_segEditHistory.clear();
+    m_segLabelIndices.erase(segUid);
+  }
+
   m_rendering.updateSegTexture(segUid, seg->header().memoryComponentType(), dataOffset, dataSize, seg->bufferAsVoid(0));
 
   return true;
 }
 
+bool CallbackHandler::exportSegLabelMeshes(const uuid& segUid, const std::filesystem::path& directory)
+{
+  const Image* seg = m_appData.seg(segUid);
+  if (!seg) {
+    return false;
+  }
+
+  // The label index limits meshing to the bounds of the labels. Export writes the full meshes,
+  // so no levels of detail are made.
+  const auto records = generateLabelMeshCpuRecords(*seg, {}, SurfaceNetsSettings{}, segLabelIndex(segUid), false);
+  if (records.empty()) {
+    spdlog::warn("Segmentation {} has no label surfaces to export", segUid);
+    return false;
+  }
+
+  // Strip both extensions of names like "seg.nii.gz"
+  std::filesystem::path baseName = seg->header().fileName().filename();
+  while (baseName.has_extension()) {
+    baseName = baseName.stem();
+  }
+  if (baseName.empty()) {
+    baseName = "segmentation";
+  }
+
+  bool success = true;
+  for (const auto& [label, record] : records) {
+    const std::filesystem::path fileName = directory / (baseName.string() + "_label" + std::to_string(label) + ".ply");
+    success &= writeMeshToFile(*record, fileName.string());
+  }
+
+  return success;
+}
+
 std::optional<uuid> CallbackHandler::createBlankImageAndTexture(
   const uuid& matchImageUid,
   const ComponentType& componentType,
@@ -394,11 +450,24 @@ std::optional<uuid> CallbackHandler::assignSegToImageWithColorTableAndTextures(
   return segUid;
 }
 
+CallbackHandler::PoissonTask::~PoissonTask()
+{
+  cancel = true;
+  if (future.valid()) {
+    future.wait();
+  }
+}
+
 bool CallbackHandler::executePoissonSegmentation(
   const uuid& imageUid,
   const uuid& seedSegUid,
   const SeedSegmentationType& segType)
 {
+  if (m_poissonTask) {
+    spdlog::warn("Cannot start a Poisson segmentation while another one is running");
+    return false;
+  }
+
   // Algorithm inputs:
   const Image* image = m_appData.image(imageUid);
   const Image* seedSeg = m_appData.seg(seedSegUid);
@@ -427,47 +496,126 @@ bool CallbackHandler::executePoissonSegmentation(
   const uint32_t seedComp = 0;
   const glm::ivec3 dims{seedSeg->header().pixelDimensions()};
 
-  // Buffer will either point to data of the image (if the image has float components)
-  // or to data of a vector with float components:
-  const float* imageBuffer = nullptr;
-  std::vector<float> imageVector;
+  // The inputs are copied, since the image and seeds may be edited while the segmentation runs.
+  // Image values are converted to float:
+  std::vector<float> imageVector(image->header().numPixels(), 0.0f);
 
-  if (ComponentType::Float32 == image->header().memoryComponentType()) {
-    imageBuffer = static_cast<const float*>(image->bufferAsVoid(imComp));
-  }
-  else {
-    imageVector.resize(image->header().numPixels(), 0.0f);
-    for (std::size_t i = 0; i < image->header().numPixels(); ++i) {
-      imageVector[i] = image->value<float>(imComp, i).value_or(0.0f);
-    }
-    imageBuffer = imageVector.data();
-  }
+  image->visitComponentView(imComp, 0, [&imageVector](const auto& view) {
+    view.forEachVoxel([&imageVector](std::size_t i, const auto& value) {
+      imageVector[i] = static_cast<float>(value);
+    });
+  });
 
-  // Buffer will either point to data of the seed segmentation, with all components converted to
-  // uint8_t and labels compressed to be in a contiguous range.
+  // Seed segmentation, with all components converted to uint8_t and labels compressed to be in a
+  // contiguous range.
   constexpr bool ignoreBackgroundLabel = false;
 
   std::vector<uint8_t> seedSegVector(seedSeg->header().numPixels(), 0u);
 
-  for (std::size_t i = 0; i < seedSeg->header().numPixels(); ++i) {
-    seedSegVector[i] = seedSeg->value<uint8_t>(seedComp, i).value_or(0u);
+  seedSeg->visitComponentView(seedComp, 0, [&seedSegVector](const auto& view) {
+    view.forEachVoxel([&seedSegVector](std::size_t i, const auto& value) {
+      seedSegVector[i] = static_cast<uint8_t>(value);
+    });
+  });
+
+  // Take the seed labels from the label index, unless they do not fit in the uint8_t seed buffer:
+  const SegLabelIndex* seedLabelIndex = segLabelIndex(seedSegUid);
+  const std::vector<uint32_t> seedLabels = seedLabelIndex ? seedLabelIndex->labels() : std::vector<uint32_t>{};
+  const bool seedLabelsIndexed = !seedLabels.empty() && seedLabels.back() <= std::numeric_limits<uint8_t>::max();
+
+  LabelIndexMaps seedLabelMaps = seedLabelsIndexed
+                                   ? seedLabelIndex->labelIndexMaps(ignoreBackgroundLabel)
+                                   : createLabelIndexMaps(dims, seedSegVector.data(), ignoreBackgroundLabel);
+
+  if (seedLabelMaps.labelToIndex.empty()) {
+    spdlog::error("Seed segmentation {} has no labels for Poisson segmentation", seedSegUid);
+    return false;
+  }
+
+  const VoxelDistances voxelDists = computeVoxelDistances(image->header().spacing(), true);
+
+  spdlog::info("Executing Poisson segmentation on image {} with seeds {}", imageUid, seedSegUid);
+
+  auto task = std::make_unique<PoissonTask>();
+  task->imageUid = imageUid;
+  task->seedSegUid = seedSegUid;
+  task->segType = segType;
+  task->numComps = static_cast<uint32_t>(seedLabelMaps.labelToIndex.size());
+
+  PoissonTask* t = task.get();
+
+  task->future = std::async(
+    std::launch::async,
+    [t,
+     seeds = std::move(seedSegVector),
+     imageValues = std::move(imageVector),
+     labelMaps = std::move(seedLabelMaps),
+     dims,
+     voxelDists]() {
+      return computePoissonSegmentation(
+        seeds, imageValues, dims, voxelDists, labelMaps, PoissonSolverSettings{}, &t->cancel, [t](float fraction) {
+          t->progress = fraction;
+        });
+    });
+
+  m_poissonTask = std::move(task);
+
+  // Keep the event loop polling for the result:
+  m_glfw.postEmptyEvent();
+  return true;
+}
+
+void CallbackHandler::pollPoissonSegmentation()
+{
+  if (!m_poissonTask) {
+    return;
+  }
+
+  using namespace std::chrono_literals;
+  if (m_poissonTask->future.wait_for(0ms) != std::future_status::ready) {
+    m_glfw.postEmptyEvent();
+    return;
+  }
+
+  const std::unique_ptr<PoissonTask> task = std::move(m_poissonTask);
+  const uuid& imageUid = task->imageUid;
+
+  PoissonSegmentation output;
+  try {
+    output = task->future.get();
+  }
+  catch (const std::exception& e) {
+    spdlog::error("Exception in Poisson segmentation of image {}: {}", imageUid, e.what());
+    return;
+  }
+
+  if (output.canceled) {
+    spdlog::info("Canceled Poisson segmentation of image {}", imageUid);
+    return;
+  }
+
+  if (output.labels.empty() || output.potentials.size() != task->numComps) {
+    spdlog::error("Poisson segmentation of image {} failed", imageUid);
+    return;
+  }
+
+  const Image* image = m_appData.image(imageUid);
+  if (!image) {
+    spdlog::warn("Discarding Poisson segmentation of image {}, which was removed", imageUid);
+    return;
   }
 
-  const uint8_t* seedSegBuffer = seedSegVector.data();
-  const LabelIndexMaps labelMaps = createLabelIndexMaps(dims, seedSegBuffer, ignoreBackgroundLabel);
   const size_t numSegsForImage = m_appData.imageToSegUids(imageUid).size();
 
   const std::string resultSegDisplayName =
-    ((SeedSegmentationType::Binary == segType) ? std::string("Binary Poisson segmentation ")
-                                               : std::string("Multi-label Poisson segmentation ")) +
+    ((SeedSegmentationType::Binary == task->segType) ? std::string("Binary Poisson segmentation ")
+                                                     : std::string("Multi-label Poisson segmentation ")) +
     std::to_string(numSegsForImage + 1) + " for image '" + image->settings().displayName() + "'";
 
-  //    SPDLOG_TRACE( "resultSegDisplayName = {}", resultSegDisplayName );
-
   const auto resultSegUid = createBlankSegWithColorTableAndTextures(imageUid, resultSegDisplayName);
   if (!resultSegUid) {
     spdlog::error("Unable to create blank segmentation matching image {}", imageUid);
-    return false;
+    return;
   }
 
   const std::string potDisplayName = std::string("Potential maps for '") + image->settings().displayName() + "'";
@@ -476,8 +624,7 @@ bool CallbackHandler::executePoissonSegmentation(
   // labels in the seed segmentation, including label zero. Component 0 of the
   // image holds the potential for all labels. Component i >= 1 of the image holds the
   // potential of label index i.
-  const uint32_t numLabels = static_cast<uint32_t>(labelMaps.labelToIndex.size() - 1);
-  const uint32_t numComps = static_cast<uint32_t>(labelMaps.labelToIndex.size());
+  const uint32_t numComps = task->numComps;
 
   // Create potential image with float components
   const auto potImageUid =
@@ -485,7 +632,7 @@ bool CallbackHandler::executePoissonSegmentation(
 
   if (!potImageUid) {
     spdlog::error("Unable to create blank potential image matching image {}", imageUid);
-    return false;
+    return;
   }
 
   spdlog::debug("Generated blank potential image {} with {} components", *potImageUid, numComps);
@@ -496,89 +643,51 @@ bool CallbackHandler::executePoissonSegmentation(
 
   if (!resultSeg) {
     spdlog::error("Null result segmentation {} for Poisson", *resultSegUid);
-    return false;
+    return;
   }
 
   if (!potImage) {
     spdlog::error("Null potential image {} for Poisson", *potImageUid);
-    return false;
+    return;
   }
 
-  if (image->header().pixelDimensions() != resultSeg->header().pixelDimensions()) {
+  if (output.labels.size() != resultSeg->header().numPixels()) {
     spdlog::error(
       "Dimensions of image {} ({}) and result segmentation {} ({}) do not match",
       imageUid,
       glm::to_string(image->header().pixelDimensions()),
       *resultSegUid,
       glm::to_string(resultSeg->header().pixelDimensions()));
-    return false;
+    return;
   }
 
-  if (image->header().pixelDimensions() != potImage->header().pixelDimensions()) {
+  if (output.labels.size() != potImage->header().numPixels()) {
     spdlog::error(
       "Dimensions of image {} ({}) and potential image {} ({}) do not match",
       imageUid,
       glm::to_string(image->header().pixelDimensions()),
       *potImageUid,
       glm::to_string(potImage->header().pixelDimensions()));
-    return false;
+    return;
   }
 
   spdlog::info(
-    "Executing Poisson segmentation on image {} with seeds {}; "
-    "resulting segmentation: {}; resulting potential: {}",
+    "Finished Poisson segmentation of image {} with seeds {}; resulting segmentation: {}; resulting potential: {}",
     imageUid,
-    seedSegUid,
+    task->seedSegUid,
     *resultSegUid,
     *potImageUid);
 
-  const VoxelDistances voxelDists = computeVoxelDistances(image->header().spacing(), true);
-
-  const float beta = computeBeta(imageBuffer, dims);
-  spdlog::debug("Poisson beta = {}", beta);
-
-  const uint32_t numIts = 10000;
-  const float rjac = 0.6f;
-
-  //    switch ( segType )
-  //    {
-  //    case SeedSegmentationType::Binary:
-  //    {
-  //        // First potential component is for all labels:
-  //        float* potBuffer = static_cast<float*>( potImage->bufferAsVoid(0) );
-  //        uint8_t* resultSegBuffer = static_cast<uint8_t*>( resultSeg->bufferAsVoid(0) );
-
-  //        initializePotential( seedSegBuffer, potBuffer, dims, 0u );
-  //        sor( seedSegBuffer, imageBuffer, potBuffer, dims, voxelDists, rjac, numIts, beta );
-  //        computeResultSeg( potBuffer, resultSegBuffer, dims );
-  //        break;
-  //    }
-  //    case SeedSegmentationType::MultiLabel:
-  //    {
-  //        break;
-  //    }
-  //    }
-
-  float* potBuffer = static_cast<float*>(potImage->bufferAsVoid(0));
-  uint8_t* resultSegBuffer = static_cast<uint8_t*>(resultSeg->bufferAsVoid(0));
-
-  // 0th component of potential initialized by all labels:
-  initializePotential(seedSegBuffer, potBuffer, dims, 0u);
-  sor(seedSegBuffer, imageBuffer, potBuffer, dims, voxelDists, rjac, numIts, beta);
-
-  std::vector<const float*> potBuffers(numLabels);
-
-  // Loop over all label indices:
-  for (uint32_t i = 1; i <= numLabels; ++i) {
-    // ith component of potential initialized by label i:
-    potBuffer = static_cast<float*>(potImage->bufferAsVoid(i));
-    potBuffers[i - 1] = potBuffer;
-
-    initializePotential(seedSegBuffer, potBuffer, dims, labelMaps.indexToLabel.at(i));
-    sor(seedSegBuffer, imageBuffer, potBuffer, dims, voxelDists, rjac, numIts, beta);
+  for (uint32_t i = 0; i < numComps; ++i) {
+    std::ranges::copy(output.potentials[i], static_cast<float*>(potImage->bufferAsVoid(i)));
   }
+  std::ranges::copy(output.labels, static_cast<uint8_t*>(resultSeg->bufferAsVoid(0)));
 
-  computeResultSeg(potBuffers, resultSegBuffer, dims);
+  // Record the result as an edit of the blank segmentation, so that it can be undone:
+  SegmentationBlock blankSeg;
+  blankSeg.size = resultSeg->header().pixelDimensions();
+  m_segEditHistory.endStep();
+  recordSegmentationEdit(*resultSegUid, blankSeg, *resultSeg);
 
   potImage->updateComponentStats();
   resultSeg->updateComponentStats();
@@ -606,8 +715,21 @@ bool CallbackHandler::executePoissonSegmentation(
     resultSeg->header().pixelDimensions(),
     resultSeg->bufferAsVoid(0));
   spdlog::debug("Done updating segmentation texture");
+}
 
-  return true;
+void CallbackHandler::cancelPoissonSegmentation()
+{
+  if (m_poissonTask) {
+    m_poissonTask->cancel = true;
+  }
+}
+
+std::optional<float> CallbackHandler::poissonSegmentationProgress() const
+{
+  if (!m_poissonTask) {
+    return std::nullopt;
+  }
+  return m_poissonTask->progress.load();
 }
 
 void CallbackHandler::recenterViews(
@@ -776,6 +898,12 @@ void CallbackHandler::doSegment(const ViewHit& hit, bool swapFgAndBg)
 
   const AppSettings& settings = m_appData.settings();
 
+  // All edits of a stroke are undone as one step:
+  if (!m_segmentStrokeStarted) {
+    m_segEditHistory.beginStep();
+    m_segmentStrokeStarted = true;
+  }
+
   // Paint on each segmentation
   for (const auto& [imageUid, segUid] : imageSegUids) {
     Image* seg = m_appData.seg(segUid);
@@ -794,7 +922,10 @@ void CallbackHandler::doSegment(const ViewHit& hit, bool swapFgAndBg)
     const glm::ivec3 roundedPixelPos{glm::round(pixelPos3)};
 
     if (glm::any(glm::lessThan(roundedPixelPos, voxelZero)) || glm::any(glm::greaterThanEqual(roundedPixelPos, dims))) {
-      continue; // This pixel is outside the image
+      // This pixel is outside the image. Forget the last position, so that the brush is not swept
+      // from where the stroke left the image to where it enters again.
+      m_segmentStrokePositions.erase(segUid);
+      continue;
     }
 
     // View plane normal vector transformed into Voxel space:
@@ -804,28 +935,116 @@ void CallbackHandler::doSegment(const ViewHit& hit, bool swapFgAndBg)
     // View plane equation:
     const glm::vec4 voxelViewPlane = math::makePlane(voxelViewPlaneNormal, pixelPos3);
 
-    auto updateSegTexture = [this, &segUid](
-                              const ComponentType& memoryComponentType,
-                              const glm::uvec3& dataOffset,
-                              const glm::uvec3& dataSize,
-                              const LabelType* data) {
-      m_rendering.updateSegTextureWithInt64Data(segUid, memoryComponentType, dataOffset, dataSize, data);
-    };
+    // Sweep the brush from the last position of the stroke in this view, so that fast strokes leave no gaps:
+    glm::vec3 strokeStartPos = pixelPos3;
+    if (const auto it = m_segmentStrokePositions.find(segUid);
+        it != m_segmentStrokePositions.end() && it->second.first == hit.viewUid)
+    {
+      strokeStartPos = it->second.second;
+    }
+    m_segmentStrokePositions.insert_or_assign(segUid, std::make_pair(hit.viewUid, pixelPos3));
 
-    paintSegmentation(
+    const auto footprint = computeSegmentationStrokeFootprint(
       *seg,
-      labelToPaint,
-      labelToReplace,
-      settings.replaceBackgroundWithForeground(),
       settings.useRoundBrush(),
       settings.use3dBrush(),
       settings.useIsotropicBrush(),
       brushSize,
-      roundedPixelPos,
+      strokeStartPos,
+      pixelPos3,
       voxelViewPlane,
-      activeBrushSpacing,
-      updateSegTexture);
+      activeBrushSpacing);
+
+    if (footprint.empty()) {
+      continue;
+    }
+
+    const auto labelsBefore = SegEditHistory::captureBlock(*seg, footprint.minVoxel, footprint.maxVoxel);
+
+    // Changed voxels are uploaded from the segmentation buffer once per rendered frame:
+    updateSegmentationVoxels(
+      footprint,
+      labelToPaint,
+      labelToReplace,
+      settings.replaceBackgroundWithForeground(),
+      *seg,
+      [this, &segUid](const glm::uvec3& dataOffset, const glm::uvec3& dataSize) {
+        m_rendering.markSegTextureDirty(segUid, dataOffset, dataSize);
+      });
+
+    if (labelsBefore) {
+      recordSegmentationEdit(segUid, *labelsBefore, *seg);
+    }
+  }
+}
+
+void CallbackHandler::endSegmentStroke()
+{
+  m_segmentStrokePositions.clear();
+  m_segmentStrokeStarted = false;
+  m_segEditHistory.endStep();
+}
+
+bool CallbackHandler::undoSegmentationEdit()
+{
+  endSegmentStroke();
+
+  const bool undone = m_segEditHistory.undo(
+    [this](const uuid& segUid) { return m_appData.seg(segUid); },
+    [this](const uuid& segUid, const glm::uvec3& offset, const glm::uvec3& size) {
+      m_rendering.markSegTextureDirty(segUid, offset, size);
+    });
+
+  if (!undone) {
+    spdlog::debug("No segmentation edit to undo");
+  }
+  return undone;
+}
+
+bool CallbackHandler::redoSegmentationEdit()
+{
+  endSegmentStroke();
+
+  const bool redone = m_segEditHistory.redo(
+    [this](const uuid& segUid) { return m_appData.seg(segUid); },
+    [this](const uuid& segUid, const glm::uvec3& offset, const glm::uvec3& size) {
+      m_rendering.markSegTextureDirty(segUid, offset, size);
+    });
+
+  if (!redone) {
+    spdlog::debug("No segmentation edit to redo");
+  }
+  return redone;
+}
+
+void CallbackHandler::recordSegmentationEdit(const uuid& segUid, const SegmentationBlock& before, const Image& seg)
+{
+  static constexpr unsigned int sk_bytesPerMbShift = 20;
+
+  const std::size_t budgetMb = m_appData.settings().segUndoMemoryBudgetInMb();
+  m_segEditHistory.setMemoryBudget(budgetMb << sk_bytesPerMbShift);
+  m_segEditHistory.record(segUid, before, seg);
+}
+
+SegLabelIndex* CallbackHandler::segLabelIndex(const uuid& segUid)
+{
+  if (auto it = m_segLabelIndices.find(segUid); std::end(m_segLabelIndices) != it) {
+    if (const Image* seg = m_appData.seg(segUid); seg && seg->header().pixelDimensions() == it->second.dimensions()) {
+      return &it->second;
+    }
+    m_segLabelIndices.erase(it);
   }
+
+  const Image* seg = m_appData.seg(segUid);
+  if (!seg) {
+    return nullptr;
+  }
+
+  auto index = SegLabelIndex::build(*seg);
+  if (!index) {
+    return nullptr;
+  }
+  return &m_segLabelIndices.insert_or_assign(segUid, std::move(*index)).first->second;
 }
 
 void CallbackHandler::clearBrushPreview()
@@ -946,35 +1165,41 @@ void CallbackHandler::updateBrushPreview(const ViewHit& hit, bool swapFgAndBg, b
       voxelViewPlane,
       activeBrushSpacing);
 
-    if (footprint.voxels.empty()) {
+    if (footprint.empty()) {
       continue;
     }
 
     if (onlyChangedVoxels) {
-      SegmentationVoxelSet changedVoxels;
-      glm::ivec3 minVoxel{std::numeric_limits<int>::max()};
-      glm::ivec3 maxVoxel{std::numeric_limits<int>::lowest()};
+      SegmentationBrushFootprint changed;
+      changed.minVoxel = glm::ivec3{std::numeric_limits<int>::max()};
+      changed.maxVoxel = glm::ivec3{std::numeric_limits<int>::lowest()};
 
-      for (const auto& p : footprint.voxels) {
+      footprint.forEachVoxel([&](const glm::ivec3& p) {
         const int64_t currentLabel = seg->value<int64_t>(0, p.x, p.y, p.z).value_or(0);
         const bool wouldChange = settings.replaceBackgroundWithForeground()
                                    ? (labelToReplace == currentLabel && labelToPaint != currentLabel)
                                    : (labelToPaint != currentLabel);
         if (!wouldChange) {
-          continue;
+          return;
         }
 
-        changedVoxels.insert(p);
-        minVoxel = glm::min(minVoxel, p);
-        maxVoxel = glm::max(maxVoxel, p);
-      }
+        // Voxels arrive in span order, so extend the last span or start a new one:
+        if (!changed.spans.empty() && changed.spans.back().z == p.z && changed.spans.back().y == p.y &&
+            changed.spans.back().xEnd == p.x)
+        {
+          ++changed.spans.back().xEnd;
+        }
+        else {
+          changed.spans.push_back(SegmentationVoxelSpan{p.y, p.z, p.x, p.x + 1});
+        }
+        changed.minVoxel = glm::min(changed.minVoxel, p);
+        changed.maxVoxel = glm::max(changed.maxVoxel, p);
+      });
 
-      footprint.voxels = std::move(changedVoxels);
-      footprint.minVoxel = minVoxel;
-      footprint.maxVoxel = maxVoxel;
+      footprint = std::move(changed);
     }
 
-    if (footprint.voxels.empty()) {
+    if (footprint.empty()) {
       continue;
     }
 
@@ -983,12 +1208,12 @@ void CallbackHandler::updateBrushPreview(const ViewHit& hit, bool swapFgAndBg, b
       static_cast<size_t>(previewSize.x) * static_cast<size_t>(previewSize.y) * static_cast<size_t>(previewSize.z);
     m_brushPreviewData.assign(N, 0);
 
-    for (const auto& p : footprint.voxels) {
-      const glm::ivec3 q = p - footprint.minVoxel;
+    for (const SegmentationVoxelSpan& span : footprint.spans) {
+      const glm::ivec3 q = glm::ivec3{span.xBegin, span.y, span.z} - footprint.minVoxel;
       const size_t index = static_cast<size_t>(q.x) +
                            static_cast<size_t>(previewSize.x) *
                              (static_cast<size_t>(q.y) + static_cast<size_t>(previewSize.y) * static_cast<size_t>(q.z));
-      m_brushPreviewData[index] = 1;
+      std::fill_n(m_brushPreviewData.begin() + static_cast<std::ptrdiff_t>(index), span.xEnd - span.xBegin, 1);
     }
 
     glm::vec4 previewColor{1.0f};
@@ -1067,25 +1292,27 @@ void CallbackHandler::paintActiveSegmentationWithAnnotation()
     return;
   }
 
-  auto updateSegTexture = [this, &activeSegUid](
-                            const ComponentType& memoryComponentType,
-                            const glm::uvec3& dataOffset,
-                            const glm::uvec3& dataSize,
-                            const LabelType* data) {
-    if (!activeSegUid) {
-      return;
-    }
+  const SegmentationBrushFootprint footprint = computePolygonFillFootprint(*seg, annot);
+  if (footprint.empty()) {
+    return;
+  }
 
-    m_rendering.updateSegTextureWithInt64Data(*activeSegUid, memoryComponentType, dataOffset, dataSize, data);
-  };
+  const auto labelsBefore = SegEditHistory::captureBlock(*seg, footprint.minVoxel, footprint.maxVoxel);
 
-  fillSegmentationWithPolygon(
-    *seg,
-    annot,
+  updateSegmentationVoxels(
+    footprint,
     static_cast<LabelType>(m_appData.settings().foregroundLabel()),
     static_cast<LabelType>(m_appData.settings().backgroundLabel()),
     m_appData.settings().replaceBackgroundWithForeground(),
-    updateSegTexture);
+    *seg,
+    [this, &activeSegUid](const glm::uvec3& dataOffset, const glm::uvec3& dataSize) {
+      m_rendering.markSegTextureDirty(*activeSegUid, dataOffset, dataSize);
+    });
+
+  if (labelsBefore) {
+    m_segEditHistory.endStep();
+    recordSegmentationEdit(*activeSegUid, *labelsBefore, *seg);
+  }
 }
 
 void CallbackHandler::doWindowLevel(
@@ -1669,6 +1896,13 @@ void CallbackHandler::doThreeDIsosurfacePick(const ViewHit& hit)
     const glm::vec3 worldRayOrigin = helper::world_T_ndc(hit.view->threeDCamera(), glm::vec3{hit.viewClipPos, -1.0f});
     const glm::vec3 worldRayDirection = helper::worldRayDirection(hit.view->threeDCamera(), hit.viewClipPos);
 
+    // Skip empty space with the raycaster's macrocells when they cover the sampled component and time point
+    const auto& macrocells = m_appData.renderData().m_macrocells;
+    const auto macrocellsIt = macrocells.find(imageUid);
+    const bool useMacrocells = std::end(macrocells) != macrocellsIt &&
+                               activeComponent == macrocellsIt->second.grid.component() &&
+                               activeTimePoint == macrocellsIt->second.grid.timePoint();
+
     const auto hitResult = camera3d::pickFirstIsoSurfaceHit(
       {.worldRayOrigin = worldRayOrigin,
        .worldRayDirection = worldRayDirection,
@@ -1679,9 +1913,12 @@ void CallbackHandler::doThreeDIsosurfacePick(const ViewHit& hit)
        .renderFrontFaces = m_appData.renderData().m_renderFrontFaces,
        .renderBackFaces = m_appData.renderData().m_renderBackFaces,
        .isoValues = isoValues,
+       // Sampled per point rather than batched: each ray sample depends on the previous ones through
+       // macrocell skipping, bisection refinement and stopping at the first hit
        .sampleValue = [image, activeComponent, activeTimePoint](const glm::vec3& pixelPos) {
          return image->valueLinear<double>(activeComponent, pixelPos.x, pixelPos.y, pixelPos.z, activeTimePoint);
-       }});
+       },
+       .macrocells = useMacrocells ? &macrocellsIt->second.grid : nullptr});
 
     if (hitResult) {
       m_appData.state().setWorldCrosshairsPos(hitResult->worldPosition);
@@ -2512,37 +2749,17 @@ void CallbackHandler::moveCrosshairsToSegLabelCentroid(const uuid& imageUid, std
     return;
   }
 
-  const void* data = seg->bufferAsVoid(comp0);
-  const glm::ivec3 dims{seg->header().pixelDimensions()};
   const LabelType label = static_cast<LabelType>(labelIndex);
 
   std::optional<glm::vec3> pixelCentroid = std::nullopt;
 
-  switch (seg->header().memoryComponentType()) {
-    case ComponentType::Int8:
-      pixelCentroid = computePixelCentroid<int8_t>(data, dims, label);
-      break;
-    case ComponentType::UInt8:
-      pixelCentroid = computePixelCentroid<uint8_t>(data, dims, label);
-      break;
-    case ComponentType::Int16:
-      pixelCentroid = computePixelCentroid<int16_t>(data, dims, label);
-      break;
-    case ComponentType::UInt16:
-      pixelCentroid = computePixelCentroid<uint16_t>(data, dims, label);
-      break;
-    case ComponentType::Int32:
-      pixelCentroid = computePixelCentroid<int32_t>(data, dims, label);
-      break;
-    case ComponentType::UInt32:
-      pixelCentroid = computePixelCentroid<uint32_t>(data, dims, label);
-      break;
-    case ComponentType::Float32:
-      pixelCentroid = computePixelCentroid<float>(data, dims, label);
-      break;
-    default:
-      pixelCentroid = std::nullopt;
-      break;
+  if (const SegLabelIndex* labelIndexStats = segLabelIndex(*activeSegUid)) {
+    pixelCentroid = labelIndexStats->centroid(static_cast<uint32_t>(label));
+  }
+  else {
+    seg->visitComponentView(comp0, 0, [&](const auto& view) {
+      pixelCentroid = computePixelCentroid(view, label);
+    });
   }
 
   if (!pixelCentroid) {
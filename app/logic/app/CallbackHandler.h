@@ -2,15 +2,25 @@
 
 #include "common/SegmentationTypes.h"
 #include "common/Types.h"
+#include "image/SegEditHistory.h"
+#include "image/SegLabelIndex.h"
 #include "logic/app/ImageScaleInteraction.h"
 #include "logic/interaction/ViewHit.h"
+#include "logic/segmentation/Poisson.h"
 
 #include <glm/fwd.hpp>
+#include <glm/vec3.hpp>
 #include <uuid.h>
 
+#include <atomic>
 #include <cstdint>
+#include <filesystem>
+#include <future>
+#include <memory>
 #include <optional>
 #include <set>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 class AppData;
@@ -36,6 +46,15 @@ public:
    */
   bool clearSegVoxels(const uuid& segUid);
 
+  /**
+   * @brief Mesh the surfaces of all labels of a segmentation with surface nets and write one PLY file
+   * per label, named after the segmentation file and the label
+   * @param segUid
+   * @param directory Directory of the mesh files
+   * @return True iff the segmentation has labels and all of their meshes were written
+   */
+  bool exportSegLabelMeshes(const uuid& segUid, const std::filesystem::path& directory);
+
   /// Create a blank multi-component image with the same header as the given image
   std::optional<uuid> createBlankImageAndTexture(
     const uuid& matchImageUid,
@@ -60,8 +79,22 @@ public:
     bool createLabelColorTable,
     bool removeSegOnFailure);
 
+  /**
+   * @brief Start a Poisson (random walker) segmentation of an image from seeds, in the background.
+   * The resulting segmentation and potential image are added by pollPoissonSegmentation() when done.
+   * @return False if the inputs are invalid or another Poisson segmentation is running.
+   */
   bool executePoissonSegmentation(const uuid& imageUid, const uuid& seedSegUid, const SeedSegmentationType& segType);
 
+  /// @brief Add the results of a finished Poisson segmentation. Call once per frame.
+  void pollPoissonSegmentation();
+
+  /// @brief Request the running Poisson segmentation to stop. Its results are discarded.
+  void cancelPoissonSegmentation();
+
+  /// @brief Fraction of the running Poisson segmentation that is complete, or std::nullopt if none is running.
+  std::optional<float> poissonSegmentationProgress() const;
+
   /**
    * @brief Move the crosshairs
    * @param windowLastPos
@@ -77,13 +110,21 @@ public:
   void doCrosshairsScroll(const ViewHit& hit, const glm::vec2& scrollOffset, bool fineScroll);
 
   /**
-   * @brief Segment the image
-   * @param windowLastPos
-   * @param windowCurrPos
-   * @param leftButton
+   * @brief Segment the image, sweeping the brush from the previous position of the current stroke
+   * @param hit Brush position
+   * @param swapFgAndBg Paint the background label over the foreground label
    */
   void doSegment(const ViewHit& hit, bool swapFgAndBg);
 
+  /// End the current segmentation stroke, so that the next doSegment starts a new stroke
+  void endSegmentStroke();
+
+  /// Undo the newest segmentation edit step (brush stroke, polygon fill or seed segmentation result)
+  bool undoSegmentationEdit();
+
+  /// Redo the newest undone segmentation edit step
+  bool redoSegmentationEdit();
+
   void updateBrushPreview(const ViewHit& hit, bool swapFgAndBg, bool paintingPreview);
   void refreshBrushPreviewIfNeeded();
   void clearBrushPreview();
@@ -348,6 +389,38 @@ private:
   uint64_t m_lastBrushPreviewRevision = 0;
   std::vector<int64_t> m_brushPreviewData;
 
+  /// Voxel position of the last brush stamp of the current stroke on each segmentation, keyed by
+  /// segmentation UID, along with the view painted in
+  std::unordered_map<uuid, std::pair<uuid, glm::vec3>> m_segmentStrokePositions;
+
+  /// Whether the edit history step of the current stroke has begun
+  bool m_segmentStrokeStarted = false;
+
+  /// Undo/redo journal of segmentation edits. Each brush stroke is one step.
+  SegEditHistory m_segEditHistory;
+
+  /// Label statistics of segmentations, keyed by segmentation UID. Indices are built on first use
+  /// and then updated from the edits observed in m_segEditHistory.
+  std::unordered_map<uuid, SegLabelIndex> m_segLabelIndices;
+
+  /// Poisson segmentation running in the background
+  struct PoissonTask
+  {
+    uuid imageUid;
+    uuid seedSegUid;
+    SeedSegmentationType segType = SeedSegmentationType::MultiLabel;
+    uint32_t numComps = 0; //!< Number of potential image components
+
+    std::atomic_bool cancel{false};
+    std::atomic<float> progress{0.0f};
+    std::future<PoissonSegmentation> future;
+
+    /// Cancels the segmentation and waits for it to stop
+    ~PoissonTask();
+  };
+
+  std::unique_ptr<PoissonTask> m_poissonTask;
+
   /**
    * @brief This function is intended to run prior to cursor callbacks that require an active view.
    * If there is an active view and the active is NOT equal to the given view UID, then return
@@ -358,6 +431,12 @@ private:
    */
   bool checkAndSetActiveView(const uuid& viewUid);
 
+  /// Record an edit of a segmentation in the undo history, within its memory budget from the settings
+  void recordSegmentationEdit(const uuid& segUid, const SegmentationBlock& before, const Image& seg);
+
+  /// Get the label index of a segmentation, building it if needed. Returns nullptr if there is no segmentation.
+  SegLabelIndex* segLabelIndex(const uuid& segUid);
+
   /// Move any 3D view whose camera eye follows the global crosshairs.
   void updateThreeDViewsFollowingCrosshairs();
 };
@@ -1,5 +1,6 @@
 #include "logic/app/Data.h"
 #include "logic/camera/CameraHelpers.h"
+#include "mesh/MeshCpuRecord.h"
 #include "common/UuidUtility.h"
 
 #include <glm/glm.hpp>
@@ -1028,6 +1029,8 @@ bool AppData::removeIsosurface(const uuid& imageUid, ComponentIndexType comp, co
     std::remove(data.m_isosurfaceUidsSorted.begin(), data.m_isosurfaceUidsSorted.end(), isosurfaceUid),
     data.m_isosurfaceUidsSorted.end());
 
+  data.m_isosurfaceMeshes.erase(isosurfaceUid);
+
   return (data.m_isosurfaces.erase(isosurfaceUid) > 0);
 }
 
@@ -1296,65 +1299,141 @@ Isosurface* AppData::isosurface(const uuid& imageUid, ComponentIndexType comp, c
   return const_cast<Isosurface*>(const_cast<const AppData*>(this)->isosurface(imageUid, comp, isosurfaceUid));
 }
 
-#if 0
+bool AppData::beginIsosurfaceMeshUpdate(
+  const uuid& imageUid,
+  ComponentIndexType comp,
+  const uuid& isosurfaceUid,
+  double isoValue,
+  uint32_t timePoint)
+{
+  std::lock_guard<std::mutex> lock(m_componentDataMutex);
+
+  auto it = m_imageToComponentData.find(imageUid);
+  if (std::end(m_imageToComponentData) == it || comp >= it->second.size()) {
+    return false;
+  }
+
+  auto& data = it->second.at(comp);
+  if (!data.m_isosurfaces.contains(isosurfaceUid)) {
+    return false;
+  }
+
+  auto& mesh = data.m_isosurfaceMeshes[isosurfaceUid];
+  if (mesh.generating) {
+    return false;
+  }
+
+  if (mesh.requested && mesh.requestedValue == isoValue && mesh.requestedTimePoint == timePoint) {
+    return false;
+  }
+
+  mesh.requestedValue = isoValue;
+  mesh.requestedTimePoint = timePoint;
+  mesh.requested = true;
+  mesh.generating = true;
+  return true;
+}
+
 bool AppData::updateIsosurfaceMeshCpuRecord(
   const uuid& imageUid,
-  ComponentIndexType component,
+  ComponentIndexType comp,
   const uuid& isosurfaceUid,
-  std::unique_ptr<MeshCpuRecord> cpuRecord
-)
+  std::unique_ptr<MeshCpuRecord> cpuRecord)
 {
   std::lock_guard<std::mutex> lock(m_componentDataMutex);
 
-  auto compDataIt = m_imageToComponentData.find(imageUid);
+  auto it = m_imageToComponentData.find(imageUid);
+  if (std::end(m_imageToComponentData) == it || comp >= it->second.size()) {
+    return false;
+  }
 
-  if (std::end(m_imageToComponentData) != compDataIt)
-  {
-    if (component < compDataIt->second.size())
-    {
-      auto& isosurfaces = compDataIt->second.at(component).m_isosurfaces;
-      auto surfaceIt = isosurfaces.find(isosurfaceUid);
-
-      if (std::end(isosurfaces) != surfaceIt)
-      {
-        surfaceIt->second.mesh.setCpuData(std::move(cpuRecord));
-        return true;
-      }
-    }
+  // The surface may have been removed while its mesh was generated
+  auto& meshes = it->second.at(comp).m_isosurfaceMeshes;
+  auto meshIt = meshes.find(isosurfaceUid);
+  if (std::end(meshes) == meshIt) {
+    return false;
   }
 
-  return false;
+  meshIt->second.generating = false;
+
+  if (!cpuRecord) {
+    return false;
+  }
+
+  meshIt->second.cpuRecord = std::move(cpuRecord);
+  meshIt->second.cpuRecordTimePoint = meshIt->second.requestedTimePoint;
+  return true;
+}
+
+std::shared_ptr<const MeshCpuRecord>
+AppData::isosurfaceMeshCpuRecord(const uuid& imageUid, ComponentIndexType comp, const uuid& isosurfaceUid) const
+{
+  std::lock_guard<std::mutex> lock(m_componentDataMutex);
+
+  auto it = m_imageToComponentData.find(imageUid);
+  if (std::end(m_imageToComponentData) == it || comp >= it->second.size()) {
+    return nullptr;
+  }
+
+  const auto& meshes = it->second.at(comp).m_isosurfaceMeshes;
+  const auto meshIt = meshes.find(isosurfaceUid);
+  return (std::end(meshes) != meshIt) ? meshIt->second.cpuRecord : nullptr;
 }
 
-bool AppData::updateIsosurfaceMeshGpuRecord(
+bool AppData::isosurfaceMeshInSync(
   const uuid& imageUid,
-  ComponentIndexType component,
+  ComponentIndexType comp,
   const uuid& isosurfaceUid,
-  std::unique_ptr<MeshGpuRecord> gpuRecord
-)
+  double isoValue,
+  uint32_t timePoint) const
 {
   std::lock_guard<std::mutex> lock(m_componentDataMutex);
 
-  auto compDataIt = m_imageToComponentData.find(imageUid);
+  auto it = m_imageToComponentData.find(imageUid);
+  if (std::end(m_imageToComponentData) == it || comp >= it->second.size()) {
+    return false;
+  }
 
-  if (std::end(m_imageToComponentData) != compDataIt)
-  {
-    if (component < compDataIt->second.size())
-    {
-      auto& isosurfaces = compDataIt->second.at(component).m_isosurfaces;
-      auto surfaceIt = isosurfaces.find(isosurfaceUid);
-
-      if (std::end(isosurfaces) != surfaceIt)
-      {
-        surfaceIt->second.mesh.setGpuData(std::move(gpuRecord));
-        return true;
-      }
-    }
+  const auto& meshes = it->second.at(comp).m_isosurfaceMeshes;
+  const auto meshIt = meshes.find(isosurfaceUid);
+  if (std::end(meshes) == meshIt || !meshIt->second.cpuRecord) {
+    return false;
   }
 
-  return false;
+  return meshIt->second.cpuRecord->meshInfo().isoValue() == isoValue &&
+         meshIt->second.cpuRecordTimePoint == timePoint;
+}
+
+std::shared_ptr<const IsosurfaceBlockRanges>
+AppData::isosurfaceBlockRanges(const uuid& imageUid, ComponentIndexType comp, uint32_t timePoint) const
+{
+  std::lock_guard<std::mutex> lock(m_componentDataMutex);
+
+  auto it = m_imageToComponentData.find(imageUid);
+  if (std::end(m_imageToComponentData) == it || comp >= it->second.size()) {
+    return nullptr;
+  }
+
+  const auto& ranges = it->second.at(comp).m_isosurfaceBlockRanges;
+  const auto rangesIt = ranges.find(timePoint);
+  return (std::end(ranges) != rangesIt) ? rangesIt->second : nullptr;
+}
+
+void AppData::setIsosurfaceBlockRanges(
+  const uuid& imageUid,
+  ComponentIndexType comp,
+  uint32_t timePoint,
+  std::shared_ptr<const IsosurfaceBlockRanges> blockRanges)
+{
+  std::lock_guard<std::mutex> lock(m_componentDataMutex);
+
+  auto it = m_imageToComponentData.find(imageUid);
+  if (std::end(m_imageToComponentData) == it || comp >= it->second.size()) {
+    return;
+  }
+
+  it->second.at(comp).m_isosurfaceBlockRanges[timePoint] = std::move(blockRanges);
 }
-#endif
 
 const ImageColorMap* AppData::imageColorMap(const uuid& colorMapUid) const
 {
@@ -39,6 +39,9 @@
 #include <unordered_set>
 #include <vector>
 
+class IsosurfaceBlockRanges;
+class MeshCpuRecord;
+
 using ComponentIndexType = uint32_t;
 
 /**
@@ -282,21 +285,61 @@ public:
 
   Isosurface* isosurface(const uuid& imageUid, ComponentIndexType component, const uuid& isosurfaceUid);
 
-  /*
+  /**
+   * @brief Start a mesh generation task for an isosurface, unless one is already running for it or
+   * its mesh was already requested at this isovalue and time point. Tasks of a surface run one at a time,
+   * so while its isovalue is being dragged, only the latest value is meshed after each task.
+   *
+   * @param[in] imageUid UID of image
+   * @param[in] component Image component
+   * @param[in] isosurfaceUid Isosurface UID
+   * @param[in] isoValue Isovalue to mesh
+   * @param[in] timePoint Image time point to mesh
+   *
+   * @return True iff the caller must now start the mesh generation task
+   */
+  bool beginIsosurfaceMeshUpdate(
+    const uuid& imageUid,
+    ComponentIndexType component,
+    const uuid& isosurfaceUid,
+    double isoValue,
+    uint32_t timePoint);
+
+  /**
+   * @brief Finish the mesh generation task of an isosurface. This is called from the task's thread.
+   *
+   * @param[in] cpuRecord Generated mesh, or null if the task failed
+   *
+   * @return True iff the mesh was stored for the isosurface
+   */
   bool updateIsosurfaceMeshCpuRecord(
     const uuid& imageUid,
     ComponentIndexType component,
     const uuid& isosurfaceUid,
-    std::unique_ptr<MeshCpuRecord> cpuRecord
-  );
+    std::unique_ptr<MeshCpuRecord> cpuRecord);
+
+  /// Get the latest mesh of an isosurface, or null if none has been generated
+  std::shared_ptr<const MeshCpuRecord>
+  isosurfaceMeshCpuRecord(const uuid& imageUid, ComponentIndexType component, const uuid& isosurfaceUid) const;
 
-  bool updateIsosurfaceMeshGpuRecord(
+  /// Is the latest mesh of an isosurface generated at this isovalue and time point?
+  bool isosurfaceMeshInSync(
     const uuid& imageUid,
     ComponentIndexType component,
     const uuid& isosurfaceUid,
-    std::unique_ptr<MeshGpuRecord> gpuRecord
-  );
-*/
+    double isoValue,
+    uint32_t timePoint) const;
+
+  /// Get the cached isosurface block ranges of an image component at a time point, or null if not cached
+  std::shared_ptr<const IsosurfaceBlockRanges>
+  isosurfaceBlockRanges(const uuid& imageUid, ComponentIndexType component, uint32_t timePoint) const;
+
+  /// Cache the isosurface block ranges of an image component at a time point. This may be called from any thread.
+  void setIsosurfaceBlockRanges(
+    const uuid& imageUid,
+    ComponentIndexType component,
+    uint32_t timePoint,
+    std::shared_ptr<const IsosurfaceBlockRanges> blockRanges);
 
   const ImageColorMap* imageColorMap(const uuid& mapUid) const;
   ImageColorMap* imageColorMap(const uuid& mapUid);
@@ -547,6 +590,24 @@ private:
 
     std::vector<uuid> m_isosurfaceUidsSorted;           //!< Sorted isosurface uids
     std::unordered_map<uuid, Isosurface> m_isosurfaces; //!< Isosurfaces
+
+    /// Mesh of an isosurface and the state of its generation task
+    struct IsosurfaceMesh
+    {
+      std::shared_ptr<const MeshCpuRecord> cpuRecord; //!< Latest generated mesh
+      uint32_t cpuRecordTimePoint = 0;                //!< Image time point of the latest mesh
+      double requestedValue = 0.0;                    //!< Isovalue of the latest task
+      uint32_t requestedTimePoint = 0;                //!< Image time point of the latest task
+      bool requested = false;                         //!< Has a task been started?
+      bool generating = false;                        //!< Is a task running?
+    };
+
+    /// Isosurface meshes, keyed by isosurface UID
+    std::unordered_map<uuid, IsosurfaceMesh> m_isosurfaceMeshes;
+
+    /// Block ranges for meshing the isosurfaces of the component, keyed by time point.
+    /// They depend only on the image values, so all isosurfaces of the component share them.
+    std::map<uint32_t, std::shared_ptr<const IsosurfaceBlockRanges>> m_isosurfaceBlockRanges;
   };
 
   mutable std::mutex m_componentDataMutex;
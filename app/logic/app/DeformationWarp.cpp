@@ -3,9 +3,12 @@
 #include "logic/app/Data.h"
 
 #include "image/Image.h"
+#include "image/ImageSampler.h"
 
 #include <glm/gtc/epsilon.hpp>
 
+#include <array>
+
 namespace deformation_warp
 {
 namespace
@@ -39,18 +42,17 @@ std::optional<glm::vec3> sampleWarpDisplacementWorld(const Image& warpField, con
     return std::nullopt;
   }
 
-  const glm::vec4 warpVoxelH = warpField.transformations().pixel_T_worldDef() * glm::vec4{worldPos, 1.0f};
-  const glm::vec3 warpVoxel = homogeneousPointToVec3(warpVoxelH);
-  const uint32_t timePoint = warpField.timeAxis().clamp(warpField.settings().activeTimePoint());
+  ImageSamplerOptions options;
+  options.timePoint = warpField.timeAxis().clamp(warpField.settings().activeTimePoint());
+  options.numComponents = 3;
 
-  const auto dx = warpField.valueLinear<double>(0, warpVoxel.x, warpVoxel.y, warpVoxel.z, timePoint);
-  const auto dy = warpField.valueLinear<double>(1, warpVoxel.x, warpVoxel.y, warpVoxel.z, timePoint);
-  const auto dz = warpField.valueLinear<double>(2, warpVoxel.x, warpVoxel.y, warpVoxel.z, timePoint);
-  if (!dx || !dy || !dz) {
+  std::array<double, 3> displacement;
+  if (!sampleImageAtWorldPoint(warpField, worldPos, displacement, options)) {
     return std::nullopt;
   }
 
-  return glm::vec3{static_cast<float>(*dx), static_cast<float>(*dy), static_cast<float>(*dz)};
+  return glm::vec3{
+    static_cast<float>(displacement[0]), static_cast<float>(displacement[1]), static_cast<float>(displacement[2])};
 }
 
 glm::vec4 inverseWarpSampleWorldPosition(const AppData& appData, const uuids::uuid& imageUid, const glm::vec4& worldPos)
@@ -0,0 +1,162 @@
+#include "logic/app/ImagePrefetcher.h"
+
+#include "common/Parallel.h"
+
+#include <spdlog/fmt/std.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+ImagePrefetcher::ImagePrefetcher(
+  std::vector<Request> requests,
+  unsigned int maxThreads,
+  const std::atomic_bool* cancel,
+  ReadCallback onRead)
+  : m_cancel(cancel)
+  , m_onRead(std::move(onRead))
+{
+  m_entries.reserve(requests.size());
+  for (auto& request : requests) {
+    auto key = std::make_pair(request.kind, request.fileName.string());
+    if (m_entryIndices.contains(key)) {
+      continue;
+    }
+    m_entryIndices.emplace(std::move(key), m_entries.size());
+    m_entries.push_back(Entry{std::move(request), State::Queued, std::nullopt});
+  }
+
+  const unsigned int budget = parallel::threadBudget();
+  if (0 == maxThreads) {
+    maxThreads = std::max(budget, 2u) - 1u;
+  }
+  const std::size_t numThreads = std::min<std::size_t>(maxThreads, m_entries.size());
+
+  // The workers and the caller of take() may all read at once
+  m_readThreadBudget = std::max(budget / static_cast<unsigned int>(numThreads + 1), 1u);
+
+  spdlog::debug(
+    "Prefetching {} image files on {} threads with {} threads per read",
+    m_entries.size(),
+    numThreads,
+    m_readThreadBudget);
+
+  m_workers.reserve(numThreads);
+  for (std::size_t t = 0; t < numThreads; ++t) {
+    m_workers.emplace_back(&ImagePrefetcher::runWorker, this);
+  }
+}
+
+ImagePrefetcher::~ImagePrefetcher()
+{
+  {
+    std::scoped_lock lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+
+  for (auto& worker : m_workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+std::optional<Image> ImagePrefetcher::take(Kind kind, const fs::path& fileName)
+{
+  std::unique_lock lock(m_mutex);
+
+  const auto it = m_entryIndices.find(std::make_pair(kind, fileName.string()));
+  if (it == m_entryIndices.end()) {
+    return std::nullopt;
+  }
+
+  Entry& entry = m_entries[it->second];
+
+  if (State::Queued == entry.state) {
+    // Read it here rather than wait for a worker to reach it
+    entry.state = State::Taken;
+    lock.unlock();
+    return read(entry);
+  }
+
+  m_cv.wait(lock, [&entry]() { return State::Reading != entry.state; });
+
+  if (State::Taken == entry.state) {
+    return std::nullopt;
+  }
+
+  entry.state = State::Taken;
+  return std::exchange(entry.image, std::nullopt);
+}
+
+void ImagePrefetcher::release(Kind kind, const fs::path& fileName)
+{
+  std::scoped_lock lock(m_mutex);
+
+  const auto it = m_entryIndices.find(std::make_pair(kind, fileName.string()));
+  if (it == m_entryIndices.end()) {
+    return;
+  }
+
+  Entry& entry = m_entries[it->second];
+  entry.state = State::Taken;
+  entry.image = std::nullopt;
+}
+
+std::size_t ImagePrefetcher::size() const
+{
+  return m_entries.size();
+}
+
+std::size_t ImagePrefetcher::numThreads() const
+{
+  return m_workers.size();
+}
+
+std::optional<Image> ImagePrefetcher::read(const Entry& entry) const
+{
+  std::optional<Image> image;
+
+  try {
+    const parallel::ScopedThreadBudget budget(m_readThreadBudget);
+    image = entry.request.read();
+  }
+  catch (const std::exception& e) {
+    spdlog::debug("Could not prefetch image from {}: {}", entry.request.fileName, e.what());
+  }
+
+  if (m_onRead) {
+    m_onRead(entry.request, image.has_value());
+  }
+  return image;
+}
+
+void ImagePrefetcher::runWorker()
+{
+  std::unique_lock lock(m_mutex);
+
+  while (!m_stop && !(m_cancel && m_cancel->load())) {
+    while (m_nextEntry < m_entries.size() && State::Queued != m_entries[m_nextEntry].state) {
+      ++m_nextEntry;
+    }
+    if (m_nextEntry == m_entries.size()) {
+      return;
+    }
+
+    Entry& entry = m_entries[m_nextEntry++];
+    entry.state = State::Reading;
+    lock.unlock();
+
+    std::optional<Image> image = read(entry);
+
+    lock.lock();
+    // A read released while in progress is discarded
+    if (State::Reading == entry.state) {
+      entry.image = std::move(image);
+      entry.state = State::Done;
+    }
+    m_cv.notify_all();
+  }
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "image/Image.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Reads the image files of a project concurrently, ahead of their insertion into the app data.
+ *
+ * Reads are started in request order on a bounded pool of worker threads. The loader then takes each
+ * read image in its own order, waiting for reads in progress. Images that no worker has started yet
+ * are read by the caller of take(), so the loader never waits on a queued read.
+ *
+ * Each read runs under a share of the thread budget of the constructing thread (see
+ * parallel::threadBudget()), so that parallel work within reads, such as decoding DICOM slices or
+ * computing image statistics, does not multiply the thread count by the number of workers.
+ */
+class ImagePrefetcher
+{
+public:
+  /// Kind of file read, which determines how the file is read
+  enum class Kind : std::uint8_t
+  {
+    Image,
+    Segmentation,
+    Deformation
+  };
+
+  /// Read one image. Exceptions are caught and reported as failed reads.
+  using Reader = std::function<std::optional<Image>()>;
+
+  struct Request
+  {
+    Kind kind = Kind::Image;
+    std::filesystem::path fileName;
+    Reader read;
+  };
+
+  /// Called on the reading thread after each read, with true on success
+  using ReadCallback = std::function<void(const Request& request, bool success)>;
+
+  /**
+   * @param requests Files to read, in the order that they will be taken. Repeated kind and file name
+   * pairs are read once.
+   * @param maxThreads Maximum number of worker threads. Zero uses one fewer than the thread budget.
+   * @param cancel Optional flag that stops workers from starting further reads when set.
+   * @param onRead Optional callback run after each read.
+   */
+  explicit ImagePrefetcher(
+    std::vector<Request> requests,
+    unsigned int maxThreads = 0,
+    const std::atomic_bool* cancel = nullptr,
+    ReadCallback onRead = {});
+
+  ImagePrefetcher(const ImagePrefetcher&) = delete;
+  ImagePrefetcher& operator=(const ImagePrefetcher&) = delete;
+
+  /// @brief Stop starting reads and wait for reads in progress to finish.
+  ~ImagePrefetcher();
+
+  /**
+   * @brief Take the image read for a request, waiting for the read when it is in progress.
+   * @return The image, or std::nullopt when the file was not requested, was already taken, or could
+   * not be read. Callers then read the file themselves, which reports the failure as usual.
+   */
+  std::optional<Image> take(Kind kind, const std::filesystem::path& fileName);
+
+  /**
+   * @brief Drop the image read for a request that the loader will not take, such as a file that is
+   * already loaded. A queued read is not started, and a read in progress is discarded when it finishes.
+   */
+  void release(Kind kind, const std::filesystem::path& fileName);
+
+  /// @brief Number of distinct files requested.
+  std::size_t size() const;
+
+  /// @brief Number of worker threads.
+  std::size_t numThreads() const;
+
+private:
+  enum class State : std::uint8_t
+  {
+    Queued,
+    Reading,
+    Done,
+    Taken
+  };
+
+  struct Entry
+  {
+    Request request;
+    State state = State::Queued;
+    std::optional<Image> image;
+  };
+
+  /// Run a request's reader outside of the lock
+  std::optional<Image> read(const Entry& entry) const;
+
+  void runWorker();
+
+  const std::atomic_bool* m_cancel = nullptr;
+  const ReadCallback m_onRead;
+
+  /// Thread budget of each read, shared between the workers and the caller of take()
+  unsigned int m_readThreadBudget = 1;
+
+  std::vector<Entry> m_entries;
+  std::map<std::pair<Kind, std::string>, std::size_t> m_entryIndices; //!< Keyed by kind and file name
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::size_t m_nextEntry = 0; //!< Next entry for workers to consider
+  bool m_stop = false;
+
+  std::vector<std::thread> m_workers;
+};
@@ -26,7 +26,8 @@ bool imageSettingsEqual(
          a->m_window == b->m_window && a->m_thresholdLow == b->m_thresholdLow &&
          a->m_thresholdHigh == b->m_thresholdHigh && a->m_opacity == b->m_opacity &&
          a->m_activeComponent == b->m_activeComponent && a->m_activeTimePoint == b->m_activeTimePoint &&
-         a->m_timePlaybackLoop == b->m_timePlaybackLoop && a->m_timePlaybackPlaying == b->m_timePlaybackPlaying &&
+         a->m_timePlaybackLoop == b->m_timePlaybackLoop && a->m_timePlaybackBounce == b->m_timePlaybackBounce &&
+         a->m_timePlaybackPlaying == b->m_timePlaybackPlaying &&
          a->m_timePlaybackSpeed == b->m_timePlaybackSpeed && a->m_componentRenderMode == b->m_componentRenderMode &&
          a->m_hasComponentRenderMode == b->m_hasComponentRenderMode && a->m_complexPhaseUnit == b->m_complexPhaseUnit &&
          a->m_complexPhaseRange == b->m_complexPhaseRange &&
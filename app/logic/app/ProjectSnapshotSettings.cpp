@@ -576,6 +576,7 @@ serialize::ImageSettings imageSettings(const Image& image, std::optional<glm::ve
   settings.m_colorInterpolationMode = imageSettings.colorInterpolationMode();
   settings.m_activeTimePoint = imageSettings.activeTimePoint();
   settings.m_timePlaybackLoop = imageSettings.timePlaybackLoop();
+  settings.m_timePlaybackBounce = imageSettings.timePlaybackBounce();
   settings.m_timePlaybackPlaying = imageSettings.timePlaybackPlaying();
   settings.m_timePlaybackSpeed = imageSettings.timePlaybackSpeed();
   settings.m_componentLevels.reserve(imageSettings.numComponents());
@@ -764,6 +765,7 @@ void applyImageSettings(Image& image, const serialize::ImageSettings& settings)
   }
   imageSettings.setActiveTimePoint(image.timeAxis().clamp(settings.m_activeTimePoint));
   imageSettings.setTimePlaybackLoop(settings.m_timePlaybackLoop);
+  imageSettings.setTimePlaybackBounce(settings.m_timePlaybackBounce);
   imageSettings.setTimePlaybackPlaying(settings.m_timePlaybackPlaying && image.isTimeSeries());
   imageSettings.setTimePlaybackSpeed(settings.m_timePlaybackSpeed);
   imageSettings.setOpacity(settings.m_opacity);
@@ -288,6 +288,16 @@ void AppSettings::setSynchronizeTimeSeries(bool synchronize)
   m_synchronizeTimeSeries = synchronize;
 }
 
+std::optional<std::size_t> AppSettings::timeFrameCacheBytes() const
+{
+  return m_timeFrameCacheBytes;
+}
+
+void AppSettings::setTimeFrameCacheBytes(std::optional<std::size_t> bytes)
+{
+  m_timeFrameCacheBytes = bytes;
+}
+
 bool AppSettings::automaticUpdateChecksEnabled() const
 {
   return m_automaticUpdateChecksEnabled;
@@ -613,6 +623,19 @@ void AppSettings::setBrushSizeInMm(float size)
   bumpBrushPreviewRevision();
 }
 
+uint32_t AppSettings::segUndoMemoryBudgetInMb() const
+{
+  return m_segUndoMemoryBudgetInMb;
+}
+
+void AppSettings::setSegUndoMemoryBudgetInMb(uint32_t megabytes)
+{
+  static constexpr uint32_t sk_minBudgetMb = 1;
+  static constexpr uint32_t sk_maxBudgetMb = 65536;
+
+  m_segUndoMemoryBudgetInMb = std::min(std::max(megabytes, sk_minBudgetMb), sk_maxBudgetMb);
+}
+
 bool AppSettings::crosshairsMoveWhileAnnotating() const
 {
   return m_crosshairsMoveWhileAnnotating;
@@ -197,6 +197,13 @@ public:
   /// @brief Set whether time-series images change frames together.
   void setSynchronizeTimeSeries(bool synchronize);
 
+  /// @brief Get the size in bytes of the frame cache through which the time points of 4D images are
+  /// streamed, or std::nullopt when all time points are loaded up front.
+  std::optional<std::size_t> timeFrameCacheBytes() const;
+
+  /// @brief Set the size in bytes of the frame cache for streaming the time points of 4D images.
+  void setTimeFrameCacheBytes(std::optional<std::size_t> bytes);
+
   /// @brief Return whether Entropy should check GitHub for updates automatically.
   bool automaticUpdateChecksEnabled() const;
 
@@ -268,6 +275,10 @@ public:
   float brushSizeInMm() const;
   void setBrushSizeInMm(float size);
 
+  /// Memory budget of the segmentation undo history, in mebibytes
+  uint32_t segUndoMemoryBudgetInMb() const;
+  void setSegUndoMemoryBudgetInMb(uint32_t megabytes);
+
   bool crosshairsMoveWhileAnnotating() const;
   void setCrosshairsMoveWhileAnnotating(bool set);
 
@@ -298,6 +309,7 @@ private:
   UiLayoutTabPlacement m_layoutTabPlacement = UiLayoutTabPlacement::Top;
   bool m_showGlobalTimeControls = true;
   bool m_synchronizeTimeSeries = true;
+  std::optional<std::size_t> m_timeFrameCacheBytes = std::nullopt;
   bool m_automaticUpdateChecksEnabled = false;
   std::vector<RecentPathGroup> m_recentImageGroups;
   std::vector<RecentPathGroup> m_recentDicomGroups;
@@ -338,7 +350,8 @@ private:
   bool m_brushPreviewWhilePainting = true;
   SegmentationOutlineStyle m_brushPreviewOutlineStyle = SegmentationOutlineStyle::ViewPixel;
   uint64_t m_brushPreviewRevision = 0;
-  uint32_t m_brushSizeInVoxels = 1u; //!< Brush size (diameter) in voxels
-  float m_brushSizeInMm = 1.0f;      //!< Brush size (diameter) in millimeters
+  uint32_t m_brushSizeInVoxels = 1u;         //!< Brush size (diameter) in voxels
+  float m_brushSizeInMm = 1.0f;              //!< Brush size (diameter) in millimeters
+  uint32_t m_segUndoMemoryBudgetInMb = 256u; //!< Memory budget of the segmentation undo history (MiB)
   /* End segmentation drawing variables */
 };
@@ -394,7 +394,8 @@ json toJson(
         {"style", enumToName(settings.brushPreviewStyle(), sk_brushPreviewStyleNames)},
         {"fillOpacity", settings.brushPreviewFillOpacity()},
         {"showWhilePainting", settings.brushPreviewWhilePainting()},
-        {"outlineStyle", enumToName(settings.brushPreviewOutlineStyle(), sk_segmentationOutlineNames)}}}}},
+        {"outlineStyle", enumToName(settings.brushPreviewOutlineStyle(), sk_segmentationOutlineNames)}}},
+      {"undo", {{"memoryBudgetMb", settings.segUndoMemoryBudgetInMb()}}}}},
     {"rendering",
      {{"frameRate",
        {{"limit", renderPreferences.limitFrameRate},
@@ -598,6 +599,11 @@ void applyJson(
         settings.setBrushPreviewOutlineStyle(*parsed);
       }
     }
+    if (const auto undo = segmentation->find("undo"); undo != segmentation->end() && undo->is_object()) {
+      if (const auto budget = undo->find("memoryBudgetMb"); budget != undo->end() && budget->is_number_unsigned()) {
+        settings.setSegUndoMemoryBudgetInMb(budget->get<uint32_t>());
+      }
+    }
   }
 
   if (const auto rendering = root.find("rendering"); rendering != root.end() && rendering->is_object()) {
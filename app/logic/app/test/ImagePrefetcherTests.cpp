@@ -0,0 +1,190 @@
+#include "logic/app/ImagePrefetcher.h"
+
+#include "common/Parallel.h"
+
+#include "ImageFixtures.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+/// One-voxel image whose value identifies the file it was "read" from
+Image makeVoxelImage(uint16_t value)
+{
+  return image_fixtures::makeScalarImage<uint16_t>(
+    {1, 1, 1}, glm::dvec3{1.0}, [value](const glm::vec3&) { return value; }, "voxel-" + std::to_string(value));
+}
+
+std::optional<uint16_t> voxelValue(const std::optional<Image>& image)
+{
+  return image ? image->value<uint16_t>(0, 0) : std::nullopt;
+}
+} // namespace
+
+TEST_CASE("Image prefetcher reads files concurrently and hands them out by file", "[ImagePrefetcher]")
+{
+  constexpr uint16_t numFiles = 12;
+
+  std::atomic<int> numReads{0};
+  std::atomic<int> numConcurrent{0};
+  std::atomic<int> maxConcurrent{0};
+
+  std::vector<ImagePrefetcher::Request> requests;
+  for (uint16_t i = 0; i < numFiles; ++i) {
+    requests.push_back(ImagePrefetcher::Request{
+      ImagePrefetcher::Kind::Image,
+      "image-" + std::to_string(i) + ".nrrd",
+      [i, &numReads, &numConcurrent, &maxConcurrent]() -> std::optional<Image> {
+        ++numReads;
+        const int concurrent = ++numConcurrent;
+        int expected = maxConcurrent;
+        while (concurrent > expected && !maxConcurrent.compare_exchange_weak(expected, concurrent)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        --numConcurrent;
+        return makeVoxelImage(i);
+      }});
+  }
+
+  // Repeated requests are read once
+  requests.push_back(requests.front());
+
+  std::mutex readMutex;
+  std::vector<std::string> readFiles;
+
+  ImagePrefetcher prefetcher(
+    std::move(requests),
+    4,
+    nullptr,
+    [&readMutex, &readFiles](const ImagePrefetcher::Request& request, bool success) {
+      std::scoped_lock lock(readMutex);
+      if (success) {
+        readFiles.push_back(request.fileName.string());
+      }
+    });
+
+  CHECK(prefetcher.size() == numFiles);
+  CHECK(prefetcher.numThreads() == 4);
+
+  for (uint16_t i = 0; i < numFiles; ++i) {
+    CHECK(voxelValue(prefetcher.take(ImagePrefetcher::Kind::Image, "image-" + std::to_string(i) + ".nrrd")) == i);
+  }
+
+  CHECK(numReads == numFiles);
+  CHECK(maxConcurrent <= 4);
+  CHECK(readFiles.size() == numFiles);
+
+  // Images are handed out once, and only for the requested kind
+  CHECK_FALSE(prefetcher.take(ImagePrefetcher::Kind::Image, "image-0.nrrd").has_value());
+  CHECK_FALSE(prefetcher.take(ImagePrefetcher::Kind::Segmentation, "image-1.nrrd").has_value());
+  CHECK_FALSE(prefetcher.take(ImagePrefetcher::Kind::Image, "unknown.nrrd").has_value());
+}
+
+TEST_CASE("Image prefetcher reports failed reads as missing images", "[ImagePrefetcher]")
+{
+  std::vector<ImagePrefetcher::Request> requests{
+    {ImagePrefetcher::Kind::Segmentation, "seg.nrrd", []() -> std::optional<Image> { return makeVoxelImage(7); }},
+    {ImagePrefetcher::Kind::Deformation,
+     "warp.nrrd",
+     []() -> std::optional<Image> { throw std::runtime_error("unreadable"); }},
+    {ImagePrefetcher::Kind::Image, "empty.nrrd", []() -> std::optional<Image> { return std::nullopt; }}};
+
+  ImagePrefetcher prefetcher(std::move(requests), 2);
+
+  CHECK(voxelValue(prefetcher.take(ImagePrefetcher::Kind::Segmentation, "seg.nrrd")) == uint16_t{7});
+  CHECK_FALSE(prefetcher.take(ImagePrefetcher::Kind::Deformation, "warp.nrrd").has_value());
+  CHECK_FALSE(prefetcher.take(ImagePrefetcher::Kind::Image, "empty.nrrd").has_value());
+}
+
+TEST_CASE("Image prefetcher reads queued files on the taking thread after cancellation", "[ImagePrefetcher]")
+{
+  const std::atomic_bool cancel{true};
+  std::atomic<int> numReads{0};
+
+  std::vector<ImagePrefetcher::Request> requests;
+  for (uint16_t i = 0; i < 3; ++i) {
+    requests.push_back(ImagePrefetcher::Request{
+      ImagePrefetcher::Kind::Image,
+      "image-" + std::to_string(i) + ".nrrd",
+      [i, &numReads]() -> std::optional<Image> {
+        ++numReads;
+        return makeVoxelImage(i);
+      }});
+  }
+
+  ImagePrefetcher prefetcher(std::move(requests), 2, &cancel);
+
+  // Canceled workers start no reads, so taking an image does not wait on them
+  CHECK(voxelValue(prefetcher.take(ImagePrefetcher::Kind::Image, "image-2.nrrd")) == uint16_t{2});
+  CHECK(numReads == 1);
+}
+
+TEST_CASE("Image prefetcher drops released images", "[ImagePrefetcher]")
+{
+  const std::atomic_bool cancel{true};
+  std::atomic<int> numReads{0};
+
+  std::vector<ImagePrefetcher::Request> requests{
+    {ImagePrefetcher::Kind::Image,
+     "queued.nrrd",
+     [&numReads]() -> std::optional<Image> {
+       ++numReads;
+       return makeVoxelImage(1);
+     }},
+    {ImagePrefetcher::Kind::Segmentation, "seg.nrrd", []() -> std::optional<Image> { return makeVoxelImage(2); }}};
+
+  ImagePrefetcher prefetcher(std::move(requests), 1, &cancel);
+
+  // A released queued read is never started
+  prefetcher.release(ImagePrefetcher::Kind::Image, "queued.nrrd");
+  CHECK_FALSE(prefetcher.take(ImagePrefetcher::Kind::Image, "queued.nrrd").has_value());
+  CHECK(numReads == 0);
+
+  CHECK(voxelValue(prefetcher.take(ImagePrefetcher::Kind::Segmentation, "seg.nrrd")) == uint16_t{2});
+  prefetcher.release(ImagePrefetcher::Kind::Segmentation, "unknown.nrrd");
+}
+
+TEST_CASE("Image prefetcher shares the thread budget between concurrent reads", "[ImagePrefetcher]")
+{
+  constexpr unsigned int numWorkers = 3;
+  const parallel::ScopedThreadBudget outerBudget(8);
+  const unsigned int readBudget = std::max(parallel::threadBudget() / (numWorkers + 1), 1u);
+
+  std::mutex budgetMutex;
+  std::vector<unsigned int> budgets;
+
+  std::vector<ImagePrefetcher::Request> requests;
+  for (uint16_t i = 0; i < 6; ++i) {
+    requests.push_back(ImagePrefetcher::Request{
+      ImagePrefetcher::Kind::Image,
+      "image-" + std::to_string(i) + ".nrrd",
+      [i, &budgetMutex, &budgets]() -> std::optional<Image> {
+        std::scoped_lock lock(budgetMutex);
+        budgets.push_back(parallel::threadBudget());
+        return makeVoxelImage(i);
+      }});
+  }
+
+  ImagePrefetcher prefetcher(std::move(requests), numWorkers);
+  for (uint16_t i = 0; i < 6; ++i) {
+    CHECK(voxelValue(prefetcher.take(ImagePrefetcher::Kind::Image, "image-" + std::to_string(i) + ".nrrd")) == i);
+  }
+
+  REQUIRE(budgets.size() == 6);
+  for (const unsigned int budget : budgets) {
+    CHECK(budget == readBudget);
+  }
+
+  // The taking thread keeps its own budget outside of reads
+  CHECK(parallel::threadBudget() == std::min(8u, std::max(std::thread::hardware_concurrency(), 1u)));
+}
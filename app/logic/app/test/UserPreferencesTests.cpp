@@ -54,6 +54,7 @@ void setNonDefaultSettings(AppSettings& settings)
   settings.setBrushPreviewOutlineStyle(SegmentationOutlineStyle::ImageVoxel);
   settings.setBrushSizeInVoxels(17);
   settings.setBrushSizeInMm(3.25f);
+  settings.setSegUndoMemoryBudgetInMb(64);
   settings.setCrosshairsMoveWhileAnnotating(true);
   settings.setLockAnatomicalCoordinateAxesWithReferenceImage(true);
   settings.recordRecentImageGroup({"/data/image-a.nii.gz", "/data/image-b.nii.gz"});
@@ -224,6 +225,7 @@ void requireSettingsEqual(const AppSettings& actual, const AppSettings& expected
   CHECK(actual.brushPreviewOutlineStyle() == expected.brushPreviewOutlineStyle());
   CHECK(actual.brushSizeInVoxels() == expected.brushSizeInVoxels());
   CHECK(actual.brushSizeInMm() == Catch::Approx(expected.brushSizeInMm()));
+  CHECK(actual.segUndoMemoryBudgetInMb() == expected.segUndoMemoryBudgetInMb());
   CHECK(actual.crosshairsMoveWhileAnnotating() == expected.crosshairsMoveWhileAnnotating());
   CHECK(
     actual.lockAnatomicalCoordinateAxesWithReferenceImage() ==
@@ -576,6 +578,9 @@ TEST_CASE("user preferences preserve defaults for missing and invalid fields", "
       "brush": {
         "sizeVoxels": 9999
       },
+      "undo": {
+        "memoryBudgetMb": 999999
+      },
       "brushPreview": {
         "fillOpacity": -1
       }
@@ -636,6 +641,7 @@ TEST_CASE("user preferences preserve defaults for missing and invalid fields", "
   CHECK(renderPreferences.scaleBarTargetFraction == Catch::Approx(1.0f));
   CHECK(renderPreferences.scaleBarMarginPx == Catch::Approx(12.0f));
   CHECK(settings.brushSizeInVoxels() == 511);
+  CHECK(settings.segUndoMemoryBudgetInMb() == 65536);
   CHECK(settings.brushPreviewFillOpacity() == Catch::Approx(0.0f));
   CHECK(renderPreferences.localNccPatchRadius == user_preferences::RenderPreferences{}.localNccPatchRadius);
   CHECK(
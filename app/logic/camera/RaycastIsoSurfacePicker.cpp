@@ -1,6 +1,7 @@
 #include "logic/camera/RaycastIsoSurfacePicker.h"
 
 #include "common/MathFuncs.h"
+#include "image/ImageMacrocellGrid.h"
 
 #include <glm/glm.hpp>
 
@@ -89,18 +90,51 @@ std::optional<IsoSurfacePickHit> pickFirstIsoSurfaceHit(const IsoSurfacePickRequ
   const float tStart = std::max(0.0f, entryT);
   const float tEnd = exitT;
   const float step = std::max(k_minStepLength, request.stepLength);
+  const ImageMacrocellGrid* macrocells = request.macrocells;
+
+  auto pixelPosAt = [&request, &worldDir](float t) {
+    return glm::vec3{request.pixel_T_world * glm::vec4{request.worldRayOrigin + t * worldDir, 1.0f}};
+  };
 
   float oldT = tStart;
-  glm::vec3 oldPixelPos{request.pixel_T_world * glm::vec4{request.worldRayOrigin + oldT * worldDir, 1.0f}};
-  std::optional<double> oldValue = request.sampleValue(oldPixelPos);
+  std::optional<double> oldValue = request.sampleValue(pixelPosAt(oldT));
   if (!oldValue) {
     return std::nullopt;
   }
 
-  for (float t = std::min(tStart + step, tEnd); t <= tEnd + 0.5f * step; t += step) {
+  // Samples are at fixed multiples of the step from the start, so that skipping steps does not move them
+  for (int k = 1;; ++k) {
+    float t = tStart + static_cast<float>(k) * step;
+    if (k > 1 && t > tEnd + 0.5f * step) {
+      break;
+    }
+
+    if (macrocells) {
+      const std::optional<float> activeT =
+        macrocells->firstActiveRayParameter(pixelRayOrigin, pixelRayDirection, oldT, tEnd, request.isoValues);
+      if (!activeT) {
+        return std::nullopt; // No isosurface crosses the rest of the ray
+      }
+
+      if (*activeT > std::min(t, tEnd)) {
+        // Values do not cross any isovalue between samples before the active cell, so resume at the last
+        // sample before it
+        int startK = std::max(k - 1, static_cast<int>((*activeT - tStart) / step));
+        while (startK > k - 1 && tStart + static_cast<float>(startK) * step > *activeT) {
+          --startK;
+        }
+
+        if (startK > k - 1) {
+          k = startK + 1;
+          t = tStart + static_cast<float>(k) * step;
+          oldT = tStart + static_cast<float>(startK) * step;
+          oldValue = request.sampleValue(pixelPosAt(oldT));
+        }
+      }
+    }
+
     const float clampedT = std::min(t, tEnd);
-    const glm::vec3 pixelPos{request.pixel_T_world * glm::vec4{request.worldRayOrigin + clampedT * worldDir, 1.0f}};
-    const std::optional<double> value = request.sampleValue(pixelPos);
+    const std::optional<double> value = request.sampleValue(pixelPosAt(clampedT));
     if (!value) {
       oldT = clampedT;
       oldValue = std::nullopt;
@@ -120,9 +154,7 @@ std::optional<IsoSurfacePickHit> pickFirstIsoSurfaceHit(const IsoSurfacePickRequ
 
         const float hitT = refineIsoCrossing(request, oldT, clampedT, *oldValue, isoValue);
         if (!nearestStepHit || hitT < nearestStepHit->rayDistance) {
-          const glm::vec3 hitPixelPos{
-            request.pixel_T_world * glm::vec4{request.worldRayOrigin + hitT * worldDir, 1.0f}};
-          const glm::vec4 worldH = request.world_T_pixel * glm::vec4{hitPixelPos, 1.0f};
+          const glm::vec4 worldH = request.world_T_pixel * glm::vec4{pixelPosAt(hitT), 1.0f};
           nearestStepHit =
             IsoSurfacePickHit{.worldPosition = glm::vec3{worldH} / worldH.w, .rayDistance = hitT, .isoIndex = i};
         }
@@ -7,6 +7,8 @@
 #include <optional>
 #include <span>
 
+class ImageMacrocellGrid;
+
 namespace camera3d
 {
 
@@ -25,6 +27,8 @@ struct IsoSurfacePickHit
  *
  * The picker mirrors the volume raycaster's threshold-crossing rule, but keeps the implementation
  * independent from OpenGL so it can be unit-tested and used synchronously from mouse callbacks.
+ * With a macrocell grid of the sampled image component, the ray steps whose samples lie in cells that
+ * no isosurface crosses are skipped without sampling, which does not change the hit.
  */
 struct IsoSurfacePickRequest
 {
@@ -39,6 +43,9 @@ struct IsoSurfacePickRequest
 
   std::span<const double> isoValues; //!< Native image-intensity isovalues to test
   std::function<std::optional<double>(const glm::vec3&)> sampleValue;
+
+  /// Optional min/max macrocells of the values returned by sampleValue, for empty-space skipping
+  const ImageMacrocellGrid* macrocells{nullptr};
 };
 
 /**
@@ -1,10 +1,18 @@
 #include "logic/camera/RaycastIsoSurfacePicker.h"
 
+#include "image/Image.h"
+#include "image/ImageMacrocellGrid.h"
+
+#include "ImageFixtures.h"
+
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
 #include <vector>
 
 namespace
@@ -41,6 +49,17 @@ camera3d::IsoSurfacePickRequest xGradientRequest(
     .sampleValue = sampleXGradient};
 }
 
+/// Float image of two small balls in a zero background, so that most of the image is empty space
+Image makeSparseImage(const glm::uvec3& dims)
+{
+  const glm::vec3 centerA = 0.3f * glm::vec3{dims};
+  const glm::vec3 centerB = 0.7f * glm::vec3{dims};
+
+  return image_fixtures::makeScalarImage<float>(dims, glm::dvec3{1.0}, [&](const glm::vec3& p) {
+    return std::max({0.0f, 6.0f - glm::length(p - centerA), 4.0f - glm::length(p - centerB)});
+  });
+}
+
 } // namespace
 
 TEST_CASE("raycast isosurface picker returns the first front-face crossing", "[camera][raycast][picking]")
@@ -89,3 +108,76 @@ TEST_CASE("raycast isosurface picker returns no hit on ray or isovalue miss", "[
   CHECK_FALSE(camera3d::pickFirstIsoSurfaceHit(
     xGradientRequest(glm::vec3{-2.0f, 2.0f, 0.0f}, glm::vec3{1.0f, 0.0f, 0.0f}, visibleIso)));
 }
+
+TEST_CASE("raycast isosurface picker skips empty macrocells without changing hits", "[camera][raycast][picking]")
+{
+  const glm::uvec3 dims{64, 56, 48};
+  const Image image = makeSparseImage(dims);
+  const auto macrocells = ImageMacrocellGrid::build(image, 0);
+  REQUIRE(macrocells.has_value());
+
+  // Anisotropic voxel spacing and an offset origin
+  glm::mat4 world_T_pixel{1.0f};
+  world_T_pixel[0][0] = 0.8f;
+  world_T_pixel[1][1] = 1.1f;
+  world_T_pixel[2][2] = 1.5f;
+  world_T_pixel[3] = glm::vec4{-20.0f, 5.0f, 12.0f, 1.0f};
+  const glm::mat4 pixel_T_world = glm::inverse(world_T_pixel);
+
+  std::size_t numSamples = 0;
+  auto sampleValue = [&image, &numSamples](const glm::vec3& pixelPos) {
+    ++numSamples;
+    return image.valueLinear<double>(0, pixelPos.x, pixelPos.y, pixelPos.z);
+  };
+
+  const std::array<double, 2> isos{1.5, 3.0};
+
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+  std::size_t numHits = 0;
+  std::size_t numBruteForceSamples = 0;
+  std::size_t numSkippingSamples = 0;
+
+  for (int n = 0; n < 300; ++n) {
+    // Rays from outside of the image through random points of it, two thirds of which are near the balls
+    const glm::vec3 jitter{unit(rng) - 0.5f, unit(rng) - 0.5f, unit(rng) - 0.5f};
+    const glm::vec3 pixelTarget = (0 == n % 3) ? glm::vec3{unit(rng), unit(rng), unit(rng)} * glm::vec3{dims}
+                                               : glm::vec3{dims} * ((1 == n % 3) ? 0.3f : 0.7f) + 6.0f * jitter;
+    const glm::vec3 worldTarget{world_T_pixel * glm::vec4{pixelTarget, 1.0f}};
+    const glm::vec3 worldOrigin =
+      worldTarget + 150.0f * glm::normalize(glm::vec3{unit(rng) - 0.5f, unit(rng) - 0.5f, unit(rng) - 0.5f});
+
+    camera3d::IsoSurfacePickRequest request{
+      .worldRayOrigin = worldOrigin,
+      .worldRayDirection = glm::normalize(worldTarget - worldOrigin),
+      .pixel_T_world = pixel_T_world,
+      .world_T_pixel = world_T_pixel,
+      .pixelDimensions = glm::vec3{dims},
+      .stepLength = 0.4f,
+      .renderFrontFaces = true,
+      .renderBackFaces = (0 == n % 2),
+      .isoValues = isos,
+      .sampleValue = sampleValue};
+
+    numSamples = 0;
+    const auto bruteForceHit = camera3d::pickFirstIsoSurfaceHit(request);
+    numBruteForceSamples += numSamples;
+
+    request.macrocells = &(*macrocells);
+    numSamples = 0;
+    const auto skippingHit = camera3d::pickFirstIsoSurfaceHit(request);
+    numSkippingSamples += numSamples;
+
+    REQUIRE(bruteForceHit.has_value() == skippingHit.has_value());
+    if (bruteForceHit) {
+      ++numHits;
+      CHECK(skippingHit->isoIndex == bruteForceHit->isoIndex);
+      CHECK(skippingHit->rayDistance == bruteForceHit->rayDistance);
+      CHECK(skippingHit->worldPosition == bruteForceHit->worldPosition);
+    }
+  }
+
+  CHECK(numHits > 50);
+  CHECK(4 * numSkippingSamples < numBruteForceSamples);
+}
@@ -11,68 +11,57 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
 
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/component_wise.hpp>
-
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <utility>
 #include <vector>
 
 namespace
 {
 
-bool voxelInterectsPlane(const glm::vec4& voxelViewPlane, const glm::vec3& voxelPos)
-{
-  static const glm::vec3 cornerOffset{0.5f, 0.5f, 0.5f};
-  return math::testAABBoxPlaneIntersection(voxelPos, voxelPos + cornerOffset, voxelViewPlane);
-}
-
-bool isVoxelInSeg(const glm::ivec3 segDims, const glm::ivec3& voxelPos)
+/// Append the voxels of a row whose extent [x - halfWidth, x + halfWidth] overlaps an interval inside the polygon
+void appendScanlineRuns(
+  const std::vector<std::pair<float, float>>& intervals,
+  float halfWidth,
+  std::vector<std::pair<int, int>>& runs)
 {
-  return (
-    voxelPos.x >= 0 && voxelPos.x < segDims.x && voxelPos.y >= 0 && voxelPos.y < segDims.y && voxelPos.z >= 0 &&
-    voxelPos.z < segDims.z);
+  for (const auto& [t0, t1] : intervals) {
+    runs.emplace_back(static_cast<int>(std::ceil(t0 - halfWidth)), static_cast<int>(std::ceil(t1 + halfWidth)));
+  }
 }
 
 } // namespace
 
 /// @todo Implement algorithm for filling smoothed polygons.
-void fillSegmentationWithPolygon(
-  Image& seg,
-  const Annotation* annot,
-
-  int64_t labelToPaint,
-  int64_t labelToReplace,
-  bool brushReplacesBgWithFg,
-
-  const std::function<void(
-    const ComponentType& memoryComponentType,
-    const glm::uvec3& offset,
-    const glm::uvec3& size,
-    const int64_t* data)>& updateSegTexture)
+SegmentationBrushFootprint
+computePolygonFillFootprint(const Image& seg, const Annotation* annot, PolygonFillRule fillRule)
 {
-  static constexpr std::size_t OUTER_BOUNDARY = 0;
-
   // Fill based on corners of voxels?
-  // If true, then the test for whether a voxel is in the polygon is based only the voxel center.
-  // If false, then the test is based on all voxel corners.
+  // If false, then the test for whether a voxel is in the polygon is based only the voxel center.
+  // If true, then voxels are also filled when the polygon covers any of their corners.
   /// @todo Make this a setting
   static constexpr bool sk_fillBasedOnCorners = true;
 
   if (!annot->isClosed() || annot->isSmoothed()) {
     spdlog::warn("Cannot fill annotation polygon that is not closed and not smoothed.");
-    return;
+    return {};
   }
 
+  // Outer boundary, followed by the boundaries of holes, in the space of the annotation plane
+  const std::vector<std::vector<glm::vec2>>& boundaries = annot->polygon().getAllVertices();
+  if (boundaries.empty() || boundaries.front().size() < 3) return {};
+
   const glm::mat4& pixel_T_subject = seg.transformations().pixel_T_subject();
   const glm::mat4& subject_T_pixel = seg.transformations().subject_T_pixel();
 
   // Convert from space of the annotation plane to segmentation pixel coordinates
-  auto convertPointFromAnnotPlaneToRoundedSegPixelCoords = [&pixel_T_subject, &annot](const glm::vec2& annotPlanePos) {
+  auto convertPointFromAnnotPlaneToSegPixelCoords = [&pixel_T_subject, &annot](const glm::vec2& annotPlanePos) {
     const glm::vec4 subjectPos{annot->unprojectFromAnnotationPlaneToSubjectPoint(annotPlanePos), 1.0f};
     const glm::vec4 pixelPos = pixel_T_subject * subjectPos;
-    return glm::ivec3{glm::round(glm::vec3{pixelPos / pixelPos.w})};
+    return glm::vec3{pixelPos / pixelPos.w};
   };
 
   // Convert from segmentation pixel coordinates to the space of the annotation plane
@@ -81,113 +70,179 @@ void fillSegmentationWithPolygon(
     return annot->projectSubjectPointToAnnotationPlane(glm::vec3{subjectPos / subjectPos.w});
   };
 
-  // Min and max corners of the polygon AABB in annotation plane space:
-  const auto aabb = annot->polygon().getAABBox();
-  if (!aabb) return;
-
-  const glm::vec2 annotPlaneAabbMinCorner = aabb->first;
-  const glm::vec2 annotPlaneAabbMaxCorner = aabb->second;
-
-  const glm::ivec3 pixelAabbMinCorner = convertPointFromAnnotPlaneToRoundedSegPixelCoords(annotPlaneAabbMinCorner);
-  const glm::ivec3 pixelAabbMaxCorner = convertPointFromAnnotPlaneToRoundedSegPixelCoords(annotPlaneAabbMaxCorner);
-
-  // Polygon vertices in the space of the annotation plane
-  const std::vector<glm::vec2>& annotPlaneVertices = annot->getBoundaryVertices(OUTER_BOUNDARY);
-  if (annotPlaneVertices.empty()) return;
+  // Projection from Pixel space onto the annotation plane is affine, so each image row (along the x axis)
+  // projects to a scanline with the same direction in the plane:
+  const glm::vec2 annotPlaneOrigin = convertPointFromSegPixelCoordsToAnnotPlane(glm::vec3{0.0f});
+  const glm::vec2 annotPlaneStepX = convertPointFromSegPixelCoordsToAnnotPlane({1.0f, 0.0f, 0.0f}) - annotPlaneOrigin;
+  const glm::vec2 annotPlaneStepY = convertPointFromSegPixelCoordsToAnnotPlane({0.0f, 1.0f, 0.0f}) - annotPlaneOrigin;
+  const glm::vec2 annotPlaneStepZ = convertPointFromSegPixelCoordsToAnnotPlane({0.0f, 0.0f, 1.0f}) - annotPlaneOrigin;
 
   // Subject plane normal vector transformed into Voxel space:
   const glm::vec3 pixelAnnotPlaneNormal =
     glm::normalize(glm::inverseTranspose(glm::mat3(pixel_T_subject)) * glm::vec3{annot->getSubjectPlaneEquation()});
 
-  // First vertex in Subject space, then in Pixel space:
-  const glm::vec3 subjectAnnotPlanePoint =
-    annot->unprojectFromAnnotationPlaneToSubjectPoint(annotPlaneVertices.front());
+  // Annotation plane in Pixel space:
+  const glm::vec4 pixelPlaneEquation = math::makePlane(
+    pixelAnnotPlaneNormal,
+    convertPointFromAnnotPlaneToSegPixelCoords(boundaries.front().front()));
+
+  // A voxel intersects the plane when its center is within this distance of the plane
+  const glm::vec3 absNormal = glm::abs(pixelAnnotPlaneNormal);
+  const float slabRadius = 0.5f * (absNormal.x + absNormal.y + absNormal.z);
+
+  // Voxel bounds of the outer boundary, clamped to the segmentation:
+  glm::vec3 pixelMinCorner{std::numeric_limits<float>::max()};
+  glm::vec3 pixelMaxCorner{std::numeric_limits<float>::lowest()};
+
+  for (const glm::vec2& vertex : boundaries.front()) {
+    const glm::vec3 pixelPos = convertPointFromAnnotPlaneToSegPixelCoords(vertex);
+    pixelMinCorner = glm::min(pixelMinCorner, pixelPos);
+    pixelMaxCorner = glm::max(pixelMaxCorner, pixelPos);
+  }
+
+  const glm::ivec3 segDims{seg.header().pixelDimensions()};
+  const glm::ivec3 minVoxel = glm::max(glm::ivec3{glm::floor(pixelMinCorner)} - 1, glm::ivec3{0});
+  const glm::ivec3 maxVoxel = glm::min(glm::ivec3{glm::ceil(pixelMaxCorner)} + 1, segDims - 1);
+
+  if (glm::any(glm::lessThan(maxVoxel, minVoxel))) return {};
+
+  // When the plane is closest to perpendicular to the x axis, each row pierces the plane in only a few voxels,
+  // which are tested individually. Otherwise, the rows of voxels that intersect the plane are scanned.
+  const bool rowsPierceThePlane = (absNormal.x >= absNormal.y && absNormal.x >= absNormal.z);
+
+  const PolygonScanConverter polygon(
+    boundaries,
+    rowsPierceThePlane ? glm::vec2{1.0f, 0.0f} : annotPlaneStepX,
+    fillRule);
+
+  // Offsets in the annotation plane of the corners of a voxel from its center, and of the
+  // edges of a voxel row that run parallel to the row from the row center:
+  std::vector<glm::vec2> voxelCornerOffsets;
+  std::vector<glm::vec2> rowEdgeOffsets;
+
+  if (sk_fillBasedOnCorners) {
+    for (const float dz : {-0.5f, 0.5f}) {
+      for (const float dy : {-0.5f, 0.5f}) {
+        rowEdgeOffsets.push_back(dy * annotPlaneStepY + dz * annotPlaneStepZ);
+        for (const float dx : {-0.5f, 0.5f}) {
+          voxelCornerOffsets.push_back(rowEdgeOffsets.back() + dx * annotPlaneStepX);
+        }
+      }
+    }
+  }
+
+  auto voxelInPolygon = [&polygon, &voxelCornerOffsets](const glm::vec2& voxelCenter) {
+    return polygon.contains(voxelCenter) ||
+           std::ranges::any_of(voxelCornerOffsets, [&polygon, &voxelCenter](const glm::vec2& offset) {
+             return polygon.contains(voxelCenter + offset);
+           });
+  };
 
-  const glm::vec4 pixelAnnotPlanePoint = pixel_T_subject * glm::vec4{subjectAnnotPlanePoint, 1.0f};
+  SegmentationBrushFootprint footprint;
+  footprint.minVoxel = glm::ivec3{std::numeric_limits<int>::max()};
+  footprint.maxVoxel = glm::ivec3{std::numeric_limits<int>::lowest()};
+
+  std::vector<std::pair<float, float>> intervals;
+  std::vector<std::pair<int, int>> runs;
+
+  for (int k = minVoxel.z; k <= maxVoxel.z; ++k) {
+    for (int j = minVoxel.y; j <= maxVoxel.y; ++j) {
+      // Voxels [xBegin, xEnd) of the row that intersect the plane,
+      // for which |n.x * i + n.y * j + n.z * k + d| <= slabRadius:
+      const float rowDistance =
+        glm::dot(pixelPlaneEquation, glm::vec4{0.0f, static_cast<float>(j), static_cast<float>(k), 1.0f});
+
+      int xBegin = minVoxel.x;
+      int xEnd = maxVoxel.x + 1;
+
+      if (absNormal.x > 0.0f) {
+        // Clamp before rounding, since the bounds are huge when the plane is nearly parallel to the rows
+        const float x0 = (-rowDistance - slabRadius) / pixelPlaneEquation.x;
+        const float x1 = (-rowDistance + slabRadius) / pixelPlaneEquation.x;
+        const float lo = std::clamp(std::min(x0, x1), static_cast<float>(xBegin), static_cast<float>(xEnd));
+        const float hi = std::clamp(std::max(x0, x1), static_cast<float>(xBegin - 1), static_cast<float>(xEnd - 1));
+        xBegin = static_cast<int>(std::ceil(lo));
+        xEnd = static_cast<int>(std::floor(hi)) + 1;
+      }
+      else if (std::abs(rowDistance) > slabRadius) {
+        continue;
+      }
 
-  // Annotation plane in Pixel space:
-  const glm::vec4 pixelPlaneEquation =
-    math::makePlane(pixelAnnotPlaneNormal, glm::vec3{pixelAnnotPlanePoint / pixelAnnotPlanePoint.w});
+      if (xBegin >= xEnd) continue;
 
-  // Loop over the AABB in Pixel/Voxel space. Note that this is inefficient and tests
-  // too many voxels when the annotation plane is oblique in Voxel space.
+      const glm::vec2 rowOrigin =
+        annotPlaneOrigin + static_cast<float>(j) * annotPlaneStepY + static_cast<float>(k) * annotPlaneStepZ;
 
-  const int minK = std::min(pixelAabbMinCorner.z, pixelAabbMaxCorner.z) - 1;
-  const int maxK = std::max(pixelAabbMinCorner.z, pixelAabbMaxCorner.z) + 1;
+      runs.clear();
 
-  const int minJ = std::min(pixelAabbMinCorner.y, pixelAabbMaxCorner.y) - 1;
-  const int maxJ = std::max(pixelAabbMinCorner.y, pixelAabbMaxCorner.y) + 1;
+      if (rowsPierceThePlane) {
+        for (int i = xBegin; i < xEnd; ++i) {
+          if (voxelInPolygon(rowOrigin + static_cast<float>(i) * annotPlaneStepX)) {
+            runs.emplace_back(i, i + 1);
+          }
+        }
+      }
+      else {
+        polygon.scan(rowOrigin, intervals);
+        appendScanlineRuns(intervals, 0.0f, runs);
 
-  const int minI = std::min(pixelAabbMinCorner.x, pixelAabbMaxCorner.x) - 1;
-  const int maxI = std::max(pixelAabbMinCorner.x, pixelAabbMaxCorner.x) + 1;
+        for (const glm::vec2& offset : rowEdgeOffsets) {
+          polygon.scan(rowOrigin + offset, intervals);
+          appendScanlineRuns(intervals, 0.5f, runs);
+        }
 
-  SegmentationVoxelSet voxelsToChange;
+        std::sort(runs.begin(), runs.end());
+      }
 
-  const glm::ivec3 segDims{seg.header().pixelDimensions()};
+      // Merge the runs into disjoint spans of the voxels that intersect the plane:
+      for (const auto& [runBegin, runEnd] : runs) {
+        const int spanBegin = std::max(runBegin, xBegin);
+        const int spanEnd = std::min(runEnd, xEnd);
+        if (spanBegin >= spanEnd) continue;
 
-  for (int k = minK; k <= maxK; ++k) {
-    for (int j = minJ; j <= maxJ; ++j) {
-      for (int i = minI; i <= maxI; ++i) {
-        const glm::ivec3 roundedPixelPos{i, j, k};
-        const glm::vec3 pixelPos{roundedPixelPos};
-
-        if (!isVoxelInSeg(segDims, roundedPixelPos)) continue;
-
-        // Does the voxel intersect the annotation plane?
-        // This check is needed when the annotation plane is oblique in Pixel space
-        // due to our inefficient algorithm.
-        if (!voxelInterectsPlane(pixelPlaneEquation, pixelPos)) continue;
-
-        const glm::vec2 annotPlanePos = convertPointFromSegPixelCoordsToAnnotPlane(pixelPos);
-
-        if (
-          math::pnpoly(annotPlaneVertices, annotPlanePos) ||
-          (sk_fillBasedOnCorners &&
-           (math::pnpoly(
-              annotPlaneVertices,
-              convertPointFromSegPixelCoordsToAnnotPlane(pixelPos + glm::vec3{0.5f, 0.5f, 0.5f})) ||
-            math::pnpoly(
-              annotPlaneVertices,
-              convertPointFromSegPixelCoordsToAnnotPlane(pixelPos + glm::vec3{0.5f, 0.5f, -0.5f})) ||
-            math::pnpoly(
-              annotPlaneVertices,
-              convertPointFromSegPixelCoordsToAnnotPlane(pixelPos + glm::vec3{0.5f, -0.5f, 0.5f})) ||
-            math::pnpoly(
-              annotPlaneVertices,
-              convertPointFromSegPixelCoordsToAnnotPlane(pixelPos + glm::vec3{0.5f, -0.5f, -0.5f})) ||
-            math::pnpoly(
-              annotPlaneVertices,
-              convertPointFromSegPixelCoordsToAnnotPlane(pixelPos + glm::vec3{-0.5f, 0.5f, 0.5f})) ||
-            math::pnpoly(
-              annotPlaneVertices,
-              convertPointFromSegPixelCoordsToAnnotPlane(pixelPos + glm::vec3{-0.5f, 0.5f, -0.5f})) ||
-            math::pnpoly(
-              annotPlaneVertices,
-              convertPointFromSegPixelCoordsToAnnotPlane(pixelPos + glm::vec3{-0.5f, -0.5f, 0.5f})) ||
-            math::pnpoly(
-              annotPlaneVertices,
-              convertPointFromSegPixelCoordsToAnnotPlane(pixelPos + glm::vec3{-0.5f, -0.5f, -0.5f})))))
-        {
-          voxelsToChange.insert(roundedPixelPos);
-          continue;
+        SegmentationVoxelSpan* last = footprint.spans.empty() ? nullptr : &footprint.spans.back();
+        if (last && last->z == k && last->y == j && last->xEnd >= spanBegin) {
+          last->xEnd = std::max(last->xEnd, spanEnd);
+        }
+        else {
+          footprint.spans.push_back(SegmentationVoxelSpan{j, k, spanBegin, spanEnd});
         }
       }
     }
   }
 
-  // Min/max corners of the set of voxels to change
-  glm::ivec3 maxVoxel{std::numeric_limits<int>::lowest()};
-  glm::ivec3 minVoxel{std::numeric_limits<int>::max()};
+  if (footprint.spans.empty()) return {};
+
+  for (const SegmentationVoxelSpan& span : footprint.spans) {
+    footprint.minVoxel = glm::min(footprint.minVoxel, glm::ivec3{span.xBegin, span.y, span.z});
+    footprint.maxVoxel = glm::max(footprint.maxVoxel, glm::ivec3{span.xEnd - 1, span.y, span.z});
+  }
+
+  return footprint;
+}
 
-  for (const auto& p : voxelsToChange) {
-    minVoxel = glm::min(minVoxel, p);
-    maxVoxel = glm::max(maxVoxel, p);
+void fillSegmentationWithPolygon(
+  Image& seg,
+  const Annotation* annot,
+  PolygonFillRule fillRule,
+
+  int64_t labelToPaint,
+  int64_t labelToReplace,
+  bool brushReplacesBgWithFg,
+
+  const std::function<void(
+    const ComponentType& memoryComponentType,
+    const glm::uvec3& offset,
+    const glm::uvec3& size,
+    const int64_t* data)>& updateSegTexture)
+{
+  const SegmentationBrushFootprint footprint = computePolygonFillFootprint(seg, annot, fillRule);
+  if (footprint.empty()) {
+    return;
   }
 
   updateSegmentationVoxels(
-    voxelsToChange,
-    minVoxel,
-    maxVoxel,
+    footprint,
     labelToPaint,
     labelToReplace,
     brushReplacesBgWithFg,
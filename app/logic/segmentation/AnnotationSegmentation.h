@@ -1,6 +1,8 @@
 #pragma once
 
 #include "common/Types.h"
+#include "image/SegUtil.h"
+#include "logic/segmentation/PolygonRasterizer.h"
 
 #include <glm/fwd.hpp>
 
@@ -9,9 +11,26 @@
 class Annotation;
 class Image;
 
+/**
+ * @brief Compute the segmentation voxels covered by the filled polygon of a closed, unsmoothed annotation.
+ *
+ * The polygon, including its holes, is scan converted along the image rows that intersect the annotation
+ * plane, so oblique planes are filled within the slab of voxels that the plane passes through.
+ *
+ * @param seg Segmentation image.
+ * @param annot Annotation whose polygon is filled.
+ * @param fillRule Rule for filling holes and self-intersecting boundaries.
+ * @return The voxels, or an empty footprint when the annotation cannot be filled.
+ */
+SegmentationBrushFootprint computePolygonFillFootprint(
+  const Image& seg,
+  const Annotation* annot,
+  PolygonFillRule fillRule = PolygonFillRule::EvenOdd);
+
 void fillSegmentationWithPolygon(
   Image& seg,
   const Annotation* annot,
+  PolygonFillRule fillRule,
 
   int64_t labelToPaint,
   int64_t labelToReplace,
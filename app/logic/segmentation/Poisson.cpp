@@ -3,9 +3,16 @@
 #include <glm/glm.hpp>
 #include <spdlog/spdlog.h>
 
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/string_cast.hpp>
+
+#include <algorithm>
+#include <array>
+#include <barrier>
 #include <cmath>
 #include <cstddef>
 #include <limits>
+#include <thread>
 
 namespace
 {
@@ -309,3 +316,474 @@ float computeBeta(const float* image, const glm::ivec3& dims)
 // potential boundary values in (int16_t format)
 // maximum number of SOR iterations
 //(optional): input conductivity image in (double format)
+
+PoissonSolver::PoissonSolver(
+  const uint8_t* seeds,
+  const float* image,
+  const glm::ivec3& dims,
+  const VoxelDistances& distances,
+  const PoissonSolverSettings& settings)
+  : m_dims(dims)
+  , m_boxMin(0)
+  , m_boxMax(dims - glm::ivec3{1})
+  , m_boxDims(dims)
+  , m_settings(settings)
+{
+  const int zDelta = dims.x * dims.y;
+  const int yDelta = dims.x;
+
+  // Bounds of the seeds:
+  glm::ivec3 seedMin{std::numeric_limits<int>::max()};
+  glm::ivec3 seedMax{std::numeric_limits<int>::lowest()};
+
+  for (int k = 0; k < dims.z; ++k) {
+    for (int j = 0; j < dims.y; ++j) {
+      for (int i = 0; i < dims.x; ++i) {
+        if (0 != seeds[k * zDelta + j * yDelta + i]) {
+          seedMin = glm::min(seedMin, glm::ivec3{i, j, k});
+          seedMax = glm::max(seedMax, glm::ivec3{i, j, k});
+        }
+      }
+    }
+  }
+
+  if (glm::any(glm::lessThan(seedMax, seedMin))) {
+    spdlog::warn("No seeds for the Poisson potential solver");
+    return;
+  }
+
+  for (int a = 0; a < 3; ++a) {
+    const auto extent = static_cast<float>(seedMax[a] - seedMin[a] + 1);
+    const int padding = std::max(
+      static_cast<int>(settings.minBoxPadding), static_cast<int>(std::ceil(settings.boxPaddingFraction * extent)));
+
+    m_boxMin[a] = std::max(seedMin[a] - padding, 0);
+    m_boxMax[a] = std::min(seedMax[a] + padding, dims[a] - 1);
+  }
+
+  m_boxDims = m_boxMax - m_boxMin + glm::ivec3{1};
+
+  const std::size_t N = static_cast<std::size_t>(m_boxDims.x) * m_boxDims.y * m_boxDims.z;
+
+  m_free.resize(N);
+  m_weightX.assign(N, 0.0f);
+  m_weightY.assign(N, 0.0f);
+  m_weightZ.assign(N, 0.0f);
+  m_diagonal.assign(N, 0.0f);
+
+  // Edge weights fall with the intensity difference across the edge, relative to the mean difference:
+  const float beta = (settings.edgeWeightScale > 0.0f) ? computeBeta(image, dims) : 0.0f;
+
+  auto edgeWeight = [&](int n, int m, float distance) {
+    if (beta <= 0.0f) {
+      return 1.0f / distance;
+    }
+    const float grad = settings.edgeWeightScale * (image[n] - image[m]) / beta;
+    return std::exp(-0.5f * grad * grad) / distance;
+  };
+
+  std::size_t b = 0;
+
+  for (int k = 0; k < m_boxDims.z; ++k) {
+    for (int j = 0; j < m_boxDims.y; ++j) {
+      for (int i = 0; i < m_boxDims.x; ++i, ++b) {
+        const int n = (m_boxMin.z + k) * zDelta + (m_boxMin.y + j) * yDelta + (m_boxMin.x + i);
+
+        m_free[b] = (0 == seeds[n]) ? 1u : 0u;
+
+        if (i < m_boxDims.x - 1) {
+          m_weightX[b] = edgeWeight(n, n + 1, distances.distX);
+        }
+        if (j < m_boxDims.y - 1) {
+          m_weightY[b] = edgeWeight(n, n + yDelta, distances.distY);
+        }
+        if (k < m_boxDims.z - 1) {
+          m_weightZ[b] = edgeWeight(n, n + zDelta, distances.distZ);
+        }
+      }
+    }
+  }
+
+  const std::size_t bzDelta = static_cast<std::size_t>(m_boxDims.x) * m_boxDims.y;
+  const std::size_t byDelta = m_boxDims.x;
+  b = 0;
+
+  for (int k = 0; k < m_boxDims.z; ++k) {
+    for (int j = 0; j < m_boxDims.y; ++j) {
+      for (int i = 0; i < m_boxDims.x; ++i, ++b) {
+        m_diagonal[b] = m_weightX[b] + m_weightY[b] + m_weightZ[b] + ((i > 0) ? m_weightX[b - 1] : 0.0f) +
+                        ((j > 0) ? m_weightY[b - byDelta] : 0.0f) + ((k > 0) ? m_weightZ[b - bzDelta] : 0.0f);
+      }
+    }
+  }
+
+  spdlog::debug(
+    "Poisson potential solver box spans voxels {} to {} of {}",
+    glm::to_string(m_boxMin),
+    glm::to_string(m_boxMax),
+    glm::to_string(dims));
+}
+
+PoissonSolverResult
+PoissonSolver::solve(float* potential, const std::atomic_bool* cancel, const ProgressCallback& onProgress) const
+{
+  static constexpr uint32_t sk_progressInterval = 16;
+
+  PoissonSolverResult result;
+
+  if (m_free.empty()) {
+    // Without seeds, the initial potential is left as is
+    result.converged = true;
+    return result;
+  }
+
+  const glm::ivec3& bd = m_boxDims;
+  const std::size_t N = m_free.size();
+  const std::size_t yDelta = bd.x;
+  const std::size_t zDelta = static_cast<std::size_t>(bd.x) * bd.y;
+  const std::size_t imageYDelta = m_dims.x;
+  const std::size_t imageZDelta = static_cast<std::size_t>(m_dims.x) * m_dims.y;
+
+  auto imageIndex = [&](int i, int j, int k) {
+    return static_cast<std::size_t>(k) * imageZDelta + static_cast<std::size_t>(j) * imageYDelta +
+           static_cast<std::size_t>(i);
+  };
+
+  // Solution x, residual r, preconditioned residual z, search direction p and q = A * p.
+  // Seeded voxels hold their fixed potential in x and zero in the other vectors.
+  std::vector<float> x(N);
+  std::vector<float> r(N);
+  std::vector<float> z(N);
+  std::vector<float> p(N);
+  std::vector<float> q(N);
+
+  for (int k = 0; k < bd.z; ++k) {
+    for (int j = 0; j < bd.y; ++j) {
+      const float* row = potential + imageIndex(m_boxMin.x, m_boxMin.y + j, m_boxMin.z + k);
+      std::copy(row, row + bd.x, x.begin() + static_cast<std::ptrdiff_t>(k * zDelta + j * yDelta));
+    }
+  }
+
+  // Weighted sum of the values of the neighbors of box voxel b
+  auto neighborSum = [&](const std::vector<float>& v, std::size_t b, int i, int j, int k) {
+    double sum = 0.0;
+    if (i < bd.x - 1) {
+      sum += m_weightX[b] * v[b + 1];
+    }
+    if (i > 0) {
+      sum += m_weightX[b - 1] * v[b - 1];
+    }
+    if (j < bd.y - 1) {
+      sum += m_weightY[b] * v[b + yDelta];
+    }
+    if (j > 0) {
+      sum += m_weightY[b - yDelta] * v[b - yDelta];
+    }
+    if (k < bd.z - 1) {
+      sum += m_weightZ[b] * v[b + zDelta];
+    }
+    if (k > 0) {
+      sum += m_weightZ[b - zDelta] * v[b - zDelta];
+    }
+    return sum;
+  };
+
+  unsigned int numThreads = (0 == m_settings.numThreads) ? std::thread::hardware_concurrency() : m_settings.numThreads;
+  numThreads = std::clamp(numThreads, 1u, static_cast<unsigned int>(bd.z));
+  const int slabSize = (bd.z + static_cast<int>(numThreads) - 1) / static_cast<int>(numThreads);
+
+  // Per-thread partial sums of the dot products of each phase
+  std::vector<std::array<double, 2>> partials(numThreads, {0.0, 0.0});
+
+  enum class Phase
+  {
+    Initialize, //!< Initial residual, preconditioned residual and direction
+    Multiply,   //!< q = A * p
+    Update,     //!< Update of solution and residuals
+    Direction   //!< New search direction
+  };
+
+  Phase phase = Phase::Initialize;
+  bool stop = false;
+  double rz = 0.0;
+  double initialResidualSq = 0.0;
+  double alpha = 0.0;
+  double beta = 0.0;
+
+  const double logTolerance = std::log(static_cast<double>(m_settings.tolerance));
+  double reportedFraction = 0.0;
+
+  auto sumPartials = [&partials](std::size_t c) {
+    double sum = 0.0;
+    for (const auto& partial : partials) {
+      sum += partial[c];
+    }
+    return sum;
+  };
+
+  auto reportProgress = [&]() noexcept {
+    if (!onProgress) {
+      return;
+    }
+
+    double fraction = static_cast<double>(result.iterations) / std::max(m_settings.maxIterations, 1u);
+    if (result.relativeResidual > 0.0 && logTolerance < 0.0) {
+      fraction = std::max(fraction, std::log(result.relativeResidual) / logTolerance);
+    }
+    if (result.converged) {
+      fraction = 1.0;
+    }
+
+    // The residual does not fall monotonically, but reported progress does:
+    fraction = std::max(fraction, reportedFraction);
+    reportedFraction = fraction;
+
+    try {
+      onProgress(static_cast<float>(std::clamp(fraction, 0.0, 1.0)));
+    }
+    catch (...) {
+      spdlog::warn("Exception in Poisson solver progress callback");
+    }
+  };
+
+  // Runs on one thread once all threads have finished a phase:
+  auto onPhaseComplete = [&]() noexcept {
+    switch (phase) {
+      case Phase::Initialize: {
+        rz = sumPartials(0);
+        initialResidualSq = sumPartials(1);
+        result.relativeResidual = (initialResidualSq > 0.0) ? 1.0 : 0.0;
+        result.converged = (initialResidualSq <= 0.0);
+        stop = result.converged;
+        phase = Phase::Multiply;
+        break;
+      }
+      case Phase::Multiply: {
+        const double pq = sumPartials(0);
+        stop = (pq <= 0.0);
+        alpha = stop ? 0.0 : rz / pq;
+        phase = Phase::Update;
+        break;
+      }
+      case Phase::Update: {
+        ++result.iterations;
+
+        const double rzNext = sumPartials(0);
+        result.relativeResidual = std::sqrt(sumPartials(1) / initialResidualSq);
+        beta = (rz > 0.0) ? rzNext / rz : 0.0;
+        rz = rzNext;
+
+        if (result.relativeResidual <= m_settings.tolerance) {
+          result.converged = true;
+          stop = true;
+        }
+        else if (cancel && cancel->load()) {
+          result.canceled = true;
+          stop = true;
+        }
+        else if (result.iterations >= m_settings.maxIterations) {
+          stop = true;
+        }
+
+        if (stop || 0 == result.iterations % sk_progressInterval) {
+          reportProgress();
+        }
+        phase = Phase::Direction;
+        break;
+      }
+      case Phase::Direction: {
+        phase = Phase::Multiply;
+        break;
+      }
+    }
+  };
+
+  std::barrier sync(static_cast<std::ptrdiff_t>(numThreads), onPhaseComplete);
+
+  auto work = [&](unsigned int t) {
+    const int kBegin = std::min(bd.z, static_cast<int>(t) * slabSize);
+    const int kEnd = std::min(bd.z, kBegin + slabSize);
+
+    auto forEachBoxVoxel = [&](auto&& fn) {
+      std::size_t b = static_cast<std::size_t>(kBegin) * zDelta;
+      for (int k = kBegin; k < kEnd; ++k) {
+        for (int j = 0; j < bd.y; ++j) {
+          for (int i = 0; i < bd.x; ++i, ++b) {
+            fn(b, i, j, k);
+          }
+        }
+      }
+    };
+
+    double rzPart = 0.0;
+    double rrPart = 0.0;
+
+    forEachBoxVoxel([&](std::size_t b, int i, int j, int k) {
+      if (!m_free[b]) {
+        r[b] = z[b] = p[b] = 0.0f;
+        return;
+      }
+      r[b] = static_cast<float>(neighborSum(x, b, i, j, k) - m_diagonal[b] * x[b]);
+      z[b] = (m_diagonal[b] > 0.0f) ? r[b] / m_diagonal[b] : 0.0f;
+      p[b] = z[b];
+      rzPart += static_cast<double>(r[b]) * z[b];
+      rrPart += static_cast<double>(r[b]) * r[b];
+    });
+
+    partials[t] = {rzPart, rrPart};
+    sync.arrive_and_wait();
+
+    while (!stop) {
+      double pqPart = 0.0;
+
+      forEachBoxVoxel([&](std::size_t b, int i, int j, int k) {
+        q[b] = m_free[b] ? static_cast<float>(m_diagonal[b] * p[b] - neighborSum(p, b, i, j, k)) : 0.0f;
+        pqPart += static_cast<double>(p[b]) * q[b];
+      });
+
+      partials[t] = {pqPart, 0.0};
+      sync.arrive_and_wait();
+      if (stop) {
+        break;
+      }
+
+      rzPart = 0.0;
+      rrPart = 0.0;
+
+      forEachBoxVoxel([&](std::size_t b, int, int, int) {
+        if (!m_free[b]) {
+          return;
+        }
+        x[b] += static_cast<float>(alpha * p[b]);
+        r[b] -= static_cast<float>(alpha * q[b]);
+        z[b] = (m_diagonal[b] > 0.0f) ? r[b] / m_diagonal[b] : 0.0f;
+        rzPart += static_cast<double>(r[b]) * z[b];
+        rrPart += static_cast<double>(r[b]) * r[b];
+      });
+
+      partials[t] = {rzPart, rrPart};
+      sync.arrive_and_wait();
+      if (stop) {
+        break;
+      }
+
+      forEachBoxVoxel([&](std::size_t b, int, int, int) {
+        p[b] = static_cast<float>(z[b] + beta * p[b]);
+      });
+
+      sync.arrive_and_wait();
+    }
+  };
+
+  if (1 == numThreads) {
+    work(0);
+  }
+  else {
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    for (unsigned int t = 0; t < numThreads; ++t) {
+      threads.emplace_back(work, t);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  // Write the solution in the box, then extend it to the voxels outside of the box:
+  for (int k = 0; k < bd.z; ++k) {
+    for (int j = 0; j < bd.y; ++j) {
+      const auto rowBegin = x.begin() + static_cast<std::ptrdiff_t>(k * zDelta + j * yDelta);
+      std::copy(rowBegin, rowBegin + bd.x, potential + imageIndex(m_boxMin.x, m_boxMin.y + j, m_boxMin.z + k));
+    }
+  }
+
+  if (m_boxDims != m_dims) {
+    for (int k = 0; k < m_dims.z; ++k) {
+      for (int j = 0; j < m_dims.y; ++j) {
+        for (int i = 0; i < m_dims.x; ++i) {
+          const glm::ivec3 nearest = glm::clamp(glm::ivec3{i, j, k}, m_boxMin, m_boxMax);
+          if (nearest != glm::ivec3{i, j, k}) {
+            potential[imageIndex(i, j, k)] = potential[imageIndex(nearest.x, nearest.y, nearest.z)];
+          }
+        }
+      }
+    }
+  }
+
+  SPDLOG_TRACE(
+    "Poisson solve stopped after {} iterations with relative residual {}", result.iterations, result.relativeResidual);
+
+  return result;
+}
+
+const glm::ivec3& PoissonSolver::boxMin() const
+{
+  return m_boxMin;
+}
+
+const glm::ivec3& PoissonSolver::boxMax() const
+{
+  return m_boxMax;
+}
+
+PoissonSegmentation computePoissonSegmentation(
+  const std::vector<uint8_t>& seeds,
+  const std::vector<float>& image,
+  const glm::ivec3& dims,
+  const VoxelDistances& distances,
+  const LabelIndexMaps& labelMaps,
+  const PoissonSolverSettings& settings,
+  const std::atomic_bool* cancel,
+  const PoissonSolver::ProgressCallback& onProgress)
+{
+  PoissonSegmentation segmentation;
+
+  const std::size_t N = static_cast<std::size_t>(dims.x) * dims.y * dims.z;
+  const std::size_t numComps = labelMaps.labelToIndex.size();
+
+  if (seeds.size() != N || image.size() != N || 0 == numComps) {
+    spdlog::error("Invalid inputs to Poisson segmentation");
+    return segmentation;
+  }
+
+  const PoissonSolver solver(seeds.data(), image.data(), dims, distances, settings);
+
+  segmentation.potentials.resize(numComps);
+
+  for (std::size_t c = 0; c < numComps; ++c) {
+    std::vector<float>& potential = segmentation.potentials[c];
+    potential.resize(N, 0.0f);
+
+    // Component 0 is initialized by all labels, component c by label index c:
+    initializePotential(seeds.data(), potential.data(), dims, (0 == c) ? 0 : labelMaps.indexToLabel.at(c));
+
+    const PoissonSolverResult result = solver.solve(potential.data(), cancel, [&](float fraction) {
+      if (onProgress) {
+        onProgress((static_cast<float>(c) + fraction) / static_cast<float>(numComps));
+      }
+    });
+
+    spdlog::debug(
+      "Poisson potential {} of {}: {} iterations, relative residual {}, converged: {}",
+      c,
+      numComps,
+      result.iterations,
+      result.relativeResidual,
+      result.converged);
+
+    if (result.canceled) {
+      segmentation.canceled = true;
+      return segmentation;
+    }
+  }
+
+  std::vector<const float*> labelPotentials;
+  for (std::size_t c = 1; c < numComps; ++c) {
+    labelPotentials.push_back(segmentation.potentials[c].data());
+  }
+
+  segmentation.labels.resize(N, 0u);
+  computeResultSeg(labelPotentials, segmentation.labels.data(), dims);
+
+  return segmentation;
+}
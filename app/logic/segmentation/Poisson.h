@@ -2,10 +2,12 @@
 
 #include "common/SegmentationTypes.h"
 
-#include <glm/fwd.hpp>
+#include <glm/vec3.hpp>
 
 #include <array>
+#include <atomic>
 #include <cstdint>
+#include <functional>
 #include <vector>
 
 class Image;
@@ -33,3 +35,133 @@ void sor(
 
 // Compute a decent value for the 'beta' parameter used in SOR.
 float computeBeta(const float* image, const glm::ivec3& dims);
+
+/**
+ * @brief Settings of the conjugate gradient potential solver.
+ */
+struct PoissonSolverSettings
+{
+  float tolerance = 1.0e-5f;     //!< Stop when the residual norm has fallen by this factor
+  uint32_t maxIterations = 5000; //!< Stop after this many iterations, even if not converged
+
+  uint32_t minBoxPadding = 8;       //!< Minimum padding of the solved box around the seeds, in voxels
+  float boxPaddingFraction = 0.25f; //!< Padding of the solved box, as a fraction of the seed extent
+
+  /// Scale of the image intensity differences in edge weights. With 0, edges are weighted by length only.
+  float edgeWeightScale = 0.0f;
+
+  unsigned int numThreads = 0; //!< Number of solver threads, or 0 to use the hardware concurrency
+};
+
+/**
+ * @brief Outcome of solving for one potential.
+ */
+struct PoissonSolverResult
+{
+  uint32_t iterations = 0;
+  double relativeResidual = 0.0; //!< Residual norm relative to the initial residual norm
+  bool converged = false;
+  bool canceled = false;
+};
+
+/**
+ * @brief Potential solver for random walker segmentation, using conjugate gradients with a Jacobi
+ * preconditioner.
+ *
+ * It solves the system of sor(): the potential is harmonic at unseeded voxels, fixed at seeded voxels
+ * and has no flux through the domain boundary. Rather than running a fixed number of iterations, it
+ * stops when the residual norm has fallen below the tolerance. The system is only solved in a box
+ * around the seeds, padded by the settings; voxels outside of the box take the potential of the
+ * nearest box voxel.
+ *
+ * Edge weights and the preconditioner depend only on the seeds and the image, so they are computed
+ * once and shared by the solves for all labels. Each iteration is split between threads by slabs of
+ * slices of the box.
+ */
+class PoissonSolver
+{
+public:
+  /// Called with the fraction of a solve that is complete
+  using ProgressCallback = std::function<void(float fraction)>;
+
+  /**
+   * @param seeds Seed labels, with 0 at unseeded voxels.
+   * @param image Image intensities, used for the edge weights when PoissonSolverSettings::edgeWeightScale > 0.
+   * @param dims Dimensions of the seed and image buffers.
+   * @param distances Distances between neighboring voxels.
+   * @param settings Solver settings.
+   */
+  PoissonSolver(
+    const uint8_t* seeds,
+    const float* image,
+    const glm::ivec3& dims,
+    const VoxelDistances& distances,
+    const PoissonSolverSettings& settings);
+
+  /**
+   * @brief Solve for a potential.
+   * @param potential Potential initialized by initializePotential(), which is overwritten by the solution.
+   * @param cancel Optional flag that stops the solve when set.
+   * @param onProgress Optional progress callback, called from a solver thread.
+   */
+  PoissonSolverResult solve(
+    float* potential,
+    const std::atomic_bool* cancel = nullptr,
+    const ProgressCallback& onProgress = nullptr) const;
+
+  /// @brief Inclusive voxel bounds of the solved box.
+  const glm::ivec3& boxMin() const;
+  const glm::ivec3& boxMax() const;
+
+private:
+  glm::ivec3 m_dims;
+  glm::ivec3 m_boxMin;
+  glm::ivec3 m_boxMax;
+  glm::ivec3 m_boxDims;
+
+  PoissonSolverSettings m_settings;
+
+  /// Per box voxel: whether the voxel is unseeded, and so solved for
+  std::vector<uint8_t> m_free;
+
+  /// Per box voxel: weights of the edges to the +x, +y and +z neighbors (0 at the box boundary)
+  std::vector<float> m_weightX;
+  std::vector<float> m_weightY;
+  std::vector<float> m_weightZ;
+
+  /// Per box voxel: sum of the weights of all edges of the voxel
+  std::vector<float> m_diagonal;
+};
+
+/**
+ * @brief Potentials and labels computed by Poisson (random walker) segmentation.
+ */
+struct PoissonSegmentation
+{
+  /// Potential of all labels (component 0), followed by the potential of each label index
+  std::vector<std::vector<float>> potentials;
+
+  std::vector<uint8_t> labels; //!< Resulting segmentation labels
+  bool canceled = false;
+};
+
+/**
+ * @brief Compute the potentials of all seed labels and the segmentation of the maximum potentials.
+ * @param seeds Seed segmentation.
+ * @param image Image intensities.
+ * @param dims Dimensions of the seed and image buffers.
+ * @param distances Distances between neighboring voxels.
+ * @param labelMaps Seed labels mapped to indices; index 0 is the potential of all labels.
+ * @param settings Solver settings.
+ * @param cancel Optional flag that stops the computation when set.
+ * @param onProgress Optional callback with the fraction of all potentials that is complete.
+ */
+PoissonSegmentation computePoissonSegmentation(
+  const std::vector<uint8_t>& seeds,
+  const std::vector<float>& image,
+  const glm::ivec3& dims,
+  const VoxelDistances& distances,
+  const LabelIndexMaps& labelMaps,
+  const PoissonSolverSettings& settings,
+  const std::atomic_bool* cancel = nullptr,
+  const PoissonSolver::ProgressCallback& onProgress = nullptr);
@@ -0,0 +1,192 @@
+#include "logic/segmentation/PolygonRasterizer.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+/// Maximum number of bands into which edges are bucketed
+constexpr std::size_t sk_maxNumBands = 4096;
+
+/// Twice the signed area of a closed boundary: positive when counter-clockwise
+float signedArea(const std::vector<glm::vec2>& boundary)
+{
+  float area = 0.0f;
+  for (std::size_t i = 0, n = boundary.size(); i < n; ++i) {
+    const glm::vec2& a = boundary[i];
+    const glm::vec2& b = boundary[(i + 1) % n];
+    area += a.x * b.y - b.x * a.y;
+  }
+  return area;
+}
+
+} // namespace
+
+PolygonScanConverter::PolygonScanConverter(
+  const std::vector<std::vector<glm::vec2>>& boundaries,
+  const glm::vec2& direction,
+  PolygonFillRule fillRule)
+  : m_direction(direction)
+  , m_invDirectionLengthSq(1.0f / glm::dot(direction, direction))
+  , m_fillRule(fillRule)
+{
+  const float outerArea = boundaries.empty() ? 0.0f : signedArea(boundaries.front());
+
+  for (std::size_t b = 0; b < boundaries.size(); ++b) {
+    const std::vector<glm::vec2>& boundary = boundaries[b];
+    const std::size_t n = boundary.size();
+    if (n < 3) {
+      continue;
+    }
+
+    // Holes wind opposite to the outer boundary under the non-zero rule
+    const bool reverse =
+      (PolygonFillRule::NonZero == fillRule && b > 0 && (signedArea(boundary) > 0.0f) == (outerArea > 0.0f));
+
+    for (std::size_t i = 0; i < n; ++i) {
+      glm::vec2 a = boundary[i];
+      glm::vec2 c = boundary[(i + 1) % n];
+      if (reverse) {
+        std::swap(a, c);
+      }
+
+      // Coordinates across (s) and along (t) the scanlines
+      const float sa = m_direction.x * a.y - m_direction.y * a.x;
+      const float sc = m_direction.x * c.y - m_direction.y * c.x;
+      if (sa == sc) {
+        continue; // Edges parallel to the scanlines never cross them
+      }
+
+      const float ta = glm::dot(m_direction, a) * m_invDirectionLengthSq;
+      const float tc = glm::dot(m_direction, c) * m_invDirectionLengthSq;
+
+      m_edges.push_back(Edge{std::min(sa, sc), std::max(sa, sc), sa, ta, (tc - ta) / (sc - sa), (sc > sa) ? 1 : -1});
+    }
+  }
+
+  if (m_edges.empty()) {
+    return;
+  }
+
+  // Bucket the edges into bands of equal width that span all edges:
+  float sBegin = m_edges.front().sMin;
+  float sEnd = m_edges.front().sMax;
+  for (const Edge& edge : m_edges) {
+    sBegin = std::min(sBegin, edge.sMin);
+    sEnd = std::max(sEnd, edge.sMax);
+  }
+
+  const std::size_t numBands = std::min(m_edges.size(), sk_maxNumBands);
+  m_bandsBegin = sBegin;
+  m_bandsPerUnit = static_cast<float>(numBands) / (sEnd - sBegin);
+
+  auto bandRange = [this, numBands](const Edge& edge) {
+    const auto band = [this, numBands](float s) {
+      return std::min(static_cast<std::size_t>(std::max((s - m_bandsBegin) * m_bandsPerUnit, 0.0f)), numBands - 1);
+    };
+    return std::pair{band(edge.sMin), band(edge.sMax)};
+  };
+
+  m_bandOffsets.assign(numBands + 1, 0);
+  for (const Edge& edge : m_edges) {
+    const auto [first, last] = bandRange(edge);
+    for (std::size_t band = first; band <= last; ++band) {
+      ++m_bandOffsets[band + 1];
+    }
+  }
+
+  for (std::size_t band = 0; band < numBands; ++band) {
+    m_bandOffsets[band + 1] += m_bandOffsets[band];
+  }
+
+  std::vector<std::size_t> fill(m_bandOffsets.begin(), m_bandOffsets.end() - 1);
+  m_bandEdges.resize(m_bandOffsets.back());
+
+  for (std::size_t e = 0; e < m_edges.size(); ++e) {
+    const auto [first, last] = bandRange(m_edges[e]);
+    for (std::size_t band = first; band <= last; ++band) {
+      m_bandEdges[fill[band]++] = static_cast<uint32_t>(e);
+    }
+  }
+}
+
+template<typename Fn>
+void PolygonScanConverter::forEachCrossing(const glm::vec2& origin, Fn&& fn) const
+{
+  if (m_bandEdges.empty()) {
+    return;
+  }
+
+  const float s = m_direction.x * origin.y - m_direction.y * origin.x;
+  const float band = (s - m_bandsBegin) * m_bandsPerUnit;
+  if (band < 0.0f) {
+    return;
+  }
+
+  // Scanlines past the last band are tested against its edges, which they cannot cross
+  const std::size_t lastBand = m_bandOffsets.size() - 2;
+  const std::size_t b =
+    (band < static_cast<float>(lastBand)) ? static_cast<std::size_t>(band) : lastBand;
+  const float tOrigin = glm::dot(m_direction, origin) * m_invDirectionLengthSq;
+
+  // The lower end of every edge is included and the upper end excluded, so a scanline through a vertex
+  // counts it once
+  for (std::size_t i = m_bandOffsets[b]; i < m_bandOffsets[b + 1]; ++i) {
+    const Edge& edge = m_edges[m_bandEdges[i]];
+    if (edge.sMin <= s && s < edge.sMax) {
+      fn(edge.tStart + (s - edge.sStart) * edge.dtds - tOrigin, edge.winding);
+    }
+  }
+}
+
+void PolygonScanConverter::scan(const glm::vec2& origin, std::vector<std::pair<float, float>>& intervals) const
+{
+  intervals.clear();
+
+  std::vector<std::pair<float, int>> crossings;
+  forEachCrossing(origin, [&crossings](float t, int w) { crossings.emplace_back(t, w); });
+
+  std::sort(crossings.begin(), crossings.end());
+
+  int winding = 0;
+  int count = 0;
+  float intervalStart = 0.0f;
+
+  auto inside = [this, &winding, &count]() {
+    return (PolygonFillRule::EvenOdd == m_fillRule) ? (1 == (count & 1)) : (0 != winding);
+  };
+
+  for (const auto& [t, w] : crossings) {
+    const bool wasInside = inside();
+    winding += w;
+    ++count;
+    const bool isInside = inside();
+
+    if (!wasInside && isInside) {
+      intervalStart = t;
+    }
+    else if (wasInside && !isInside && intervalStart < t) {
+      intervals.emplace_back(intervalStart, t);
+    }
+  }
+}
+
+bool PolygonScanConverter::contains(const glm::vec2& point) const
+{
+  // Crossings of the ray from the point along the scanline, which wind around the point the same
+  // number of times as the crossings behind it
+  int winding = 0;
+  int count = 0;
+
+  forEachCrossing(point, [&winding, &count](float t, int w) {
+    if (t > 0.0f) {
+      winding += w;
+      ++count;
+    }
+  });
+
+  return (PolygonFillRule::EvenOdd == m_fillRule) ? (1 == (count & 1)) : (0 != winding);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Rule that decides which regions of a polygon with holes or self-intersections are inside.
+ */
+enum class PolygonFillRule
+{
+  EvenOdd, //!< Points are inside when a ray from them crosses the boundaries an odd number of times
+  NonZero  //!< Points are inside when the boundaries wind around them a non-zero number of times
+};
+
+/**
+ * @brief Scanline rasterizer of a planar polygon with holes.
+ *
+ * Scanlines are the parallel lines origin + t * direction. The polygon edges are expressed once in a frame
+ * aligned with the scan direction and are bucketed into bands across the scanlines, so each scanline and each
+ * point test only visits the few edges that can cross it. All boundaries are closed. With the non-zero rule,
+ * holes are oriented opposite to the outer boundary, so that they are never filled regardless of how they
+ * were drawn.
+ */
+class PolygonScanConverter
+{
+public:
+  /**
+   * @param boundaries Outer boundary of the polygon, followed by the boundaries of its holes.
+   * @param direction Direction of the scanlines, which must be non-zero.
+   * @param fillRule Rule for filling the polygon.
+   */
+  PolygonScanConverter(
+    const std::vector<std::vector<glm::vec2>>& boundaries,
+    const glm::vec2& direction,
+    PolygonFillRule fillRule);
+
+  /**
+   * @brief Compute where a scanline is inside of the polygon.
+   * @param origin Origin of the scanline.
+   * @param[out] intervals Sorted, disjoint intervals [t0, t1) of the scanline parameter that are inside.
+   */
+  void scan(const glm::vec2& origin, std::vector<std::pair<float, float>>& intervals) const;
+
+  /// @brief Test whether a point is inside of the polygon.
+  bool contains(const glm::vec2& point) const;
+
+private:
+  /// Polygon edge in the frame of the scanlines
+  struct Edge
+  {
+    float sMin; //!< Minimum coordinate across scanlines
+    float sMax; //!< Maximum coordinate across scanlines, exclusive
+    float sStart;
+    float tStart; //!< Coordinate along scanlines at sStart
+    float dtds;   //!< Change of the coordinate along scanlines per unit across scanlines
+    int winding;  //!< +1 or -1, by the direction in which the edge crosses scanlines
+  };
+
+  /// Call a function with the coordinate along the scanline and winding of every edge that crosses a scanline
+  template<typename Fn>
+  void forEachCrossing(const glm::vec2& origin, Fn&& fn) const;
+
+  glm::vec2 m_direction;
+  float m_invDirectionLengthSq;
+  PolygonFillRule m_fillRule;
+  std::vector<Edge> m_edges;
+
+  float m_bandsBegin = 0.0f; //!< Coordinate across scanlines where the first band begins
+  float m_bandsPerUnit = 0.0f;
+
+  /// Edges that overlap each band, with the edges of band b at [m_bandOffsets[b], m_bandOffsets[b + 1])
+  std::vector<std::size_t> m_bandOffsets;
+  std::vector<uint32_t> m_bandEdges;
+};
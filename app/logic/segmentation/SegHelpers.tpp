@@ -1,29 +1,26 @@
 #pragma once
 
 #include "common/SegmentationTypes.h"
+#include "image/ImageView.h"
 
 #include <glm/glm.hpp>
 
 #include <optional>
 
 template<typename T>
-std::optional<glm::vec3> computePixelCentroid(const void* data, const glm::ivec3& dims, const LabelType& label)
+std::optional<glm::vec3> computePixelCentroid(const ImageView<T>& view, const LabelType& label)
 {
-  glm::vec3 coordSum{0.0f, 0.0f, 0.0f};
+  glm::dvec3 coordSum{0.0, 0.0, 0.0};
   std::size_t count = 0;
 
-  const T* dataCast = static_cast<const T*>(data);
+  const glm::i64vec3 dims{view.dimensions()};
 
-  for (int k = 0; k < dims.z; ++k) {
-    for (int j = 0; j < dims.y; ++j) {
-      for (int i = 0; i < dims.x; ++i) {
-        if (label == static_cast<LabelType>(dataCast[k * dims.x * dims.y + j * dims.x + i])) {
-          coordSum += glm::vec3{i, j, k};
-          ++count;
-        }
-      }
+  view.forEachInRegion(glm::i64vec3{0}, dims, [&](const glm::i64vec3& voxel, const auto& value) {
+    if (label == static_cast<LabelType>(value)) {
+      coordSum += glm::dvec3{voxel};
+      ++count;
     }
-  }
+  });
 
   if (0 == count) {
     // No voxels found with this segmentation label. Return null so that we don't
@@ -31,7 +28,7 @@ std::optional<glm::vec3> computePixelCentroid(const void* data, const glm::ivec3
     return std::nullopt;
   }
 
-  return coordSum / static_cast<float>(count);
+  return glm::vec3{coordSum / static_cast<double>(count)};
 }
 
 template<typename T>
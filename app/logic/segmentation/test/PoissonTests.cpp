@@ -0,0 +1,162 @@
+#include "logic/segmentation/Poisson.h"
+#include "logic/segmentation/SegHelpers.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+
+constexpr glm::ivec3 sk_dims{16, 14, 6};
+
+std::size_t voxelIndex(int i, int j, int k)
+{
+  return static_cast<std::size_t>(k) * sk_dims.x * sk_dims.y + static_cast<std::size_t>(j) * sk_dims.x + i;
+}
+
+/// Three labels seeded along short lines through the slices
+std::vector<uint8_t> makeSeeds()
+{
+  std::vector<uint8_t> seeds(static_cast<std::size_t>(sk_dims.x) * sk_dims.y * sk_dims.z, 0u);
+  for (int k = 1; k < 5; ++k) {
+    seeds[voxelIndex(2, 3, k)] = 1u;
+    seeds[voxelIndex(3, 3, k)] = 1u;
+    seeds[voxelIndex(13, 11, k)] = 2u;
+    seeds[voxelIndex(8, 2, k)] = 3u;
+  }
+  return seeds;
+}
+
+LabelIndexMaps makeLabelMaps()
+{
+  LabelIndexMaps labelMaps;
+  for (LabelType label = 0; label <= 3; ++label) {
+    labelMaps.labelToIndex.emplace(label, static_cast<std::size_t>(label));
+    labelMaps.indexToLabel.emplace(static_cast<std::size_t>(label), label);
+  }
+  return labelMaps;
+}
+
+float maxAbsDifference(const std::vector<float>& a, const std::vector<float>& b)
+{
+  float maxDiff = 0.0f;
+  for (std::size_t n = 0; n < a.size(); ++n) {
+    maxDiff = std::max(maxDiff, std::fabs(a[n] - b[n]));
+  }
+  return maxDiff;
+}
+
+} // namespace
+
+TEST_CASE("Conjugate gradient potentials match the SOR potentials", "[segmentation][Poisson]")
+{
+  const std::vector<uint8_t> seeds = makeSeeds();
+  const std::vector<float> image(seeds.size(), 0.0f);
+  const VoxelDistances distances = computeVoxelDistances({1.0f, 1.0f, 2.0f}, true);
+
+  for (const LabelType label : {0, 2}) {
+    std::vector<float> sorPotential(seeds.size(), 0.0f);
+    initializePotential(seeds.data(), sorPotential.data(), sk_dims, label);
+    sor(seeds.data(), image.data(), sorPotential.data(), sk_dims, distances, 0.6f, 10000, 1.0f);
+
+    // Solve the whole image, so that the solutions are comparable everywhere
+    for (const unsigned int numThreads : {1u, 4u}) {
+      PoissonSolverSettings settings;
+      settings.minBoxPadding = 100;
+      settings.numThreads = numThreads;
+
+      std::vector<float> potential(seeds.size(), 0.0f);
+      initializePotential(seeds.data(), potential.data(), sk_dims, label);
+
+      const PoissonSolver solver(seeds.data(), image.data(), sk_dims, distances, settings);
+      const PoissonSolverResult result = solver.solve(potential.data());
+
+      CHECK(result.converged);
+      CHECK_FALSE(result.canceled);
+      CHECK(result.iterations < 1000);
+      CHECK(result.relativeResidual <= settings.tolerance);
+      CHECK(maxAbsDifference(potential, sorPotential) < 1.0e-3f);
+    }
+  }
+}
+
+TEST_CASE("Poisson solver is restricted to a padded box around the seeds", "[segmentation][Poisson]")
+{
+  const std::vector<uint8_t> seeds = makeSeeds();
+  const std::vector<float> image(seeds.size(), 0.0f);
+  const VoxelDistances distances = computeVoxelDistances({1.0f, 1.0f, 1.0f}, true);
+
+  PoissonSolverSettings settings;
+  settings.minBoxPadding = 1;
+  settings.boxPaddingFraction = 0.0f;
+
+  const PoissonSolver solver(seeds.data(), image.data(), sk_dims, distances, settings);
+  CHECK(solver.boxMin() == glm::ivec3(1, 1, 0));
+  CHECK(solver.boxMax() == glm::ivec3(14, 12, 5));
+
+  std::vector<float> potential(seeds.size(), 0.0f);
+  initializePotential(seeds.data(), potential.data(), sk_dims, 1);
+  CHECK(solver.solve(potential.data()).converged);
+
+  // Voxels outside of the box take the potential of the nearest box voxel
+  CHECK(potential[voxelIndex(0, 0, 3)] == potential[voxelIndex(1, 1, 3)]);
+  CHECK(potential[voxelIndex(15, 13, 2)] == potential[voxelIndex(14, 12, 2)]);
+}
+
+TEST_CASE("Poisson segmentation labels voxels by their maximum potential", "[segmentation][Poisson]")
+{
+  const std::vector<uint8_t> seeds = makeSeeds();
+  const VoxelDistances distances = computeVoxelDistances({1.0f, 1.0f, 1.0f}, true);
+  const LabelIndexMaps labelMaps = makeLabelMaps();
+
+  // An intensity edge between x = 7 and x = 8
+  std::vector<float> image(seeds.size(), 0.0f);
+  for (int k = 0; k < sk_dims.z; ++k) {
+    for (int j = 0; j < sk_dims.y; ++j) {
+      for (int i = 8; i < sk_dims.x; ++i) {
+        image[voxelIndex(i, j, k)] = 100.0f;
+      }
+    }
+  }
+
+  std::vector<float> progress;
+
+  PoissonSolverSettings settings;
+  settings.edgeWeightScale = 1.0f;
+
+  const PoissonSegmentation segmentation = computePoissonSegmentation(
+    seeds, image, sk_dims, distances, labelMaps, settings, nullptr, [&progress](float fraction) {
+      progress.push_back(fraction);
+    });
+
+  REQUIRE_FALSE(segmentation.canceled);
+  REQUIRE(segmentation.potentials.size() == 4);
+  REQUIRE(segmentation.labels.size() == seeds.size());
+
+  // Result labels are one more than the index of the label with maximum potential
+  CHECK(segmentation.labels[voxelIndex(2, 3, 2)] == 1u);
+  CHECK(segmentation.labels[voxelIndex(13, 11, 2)] == 2u);
+  CHECK(segmentation.labels[voxelIndex(8, 2, 2)] == 3u);
+
+  // Labels spread up to the intensity edge, but not across it
+  CHECK(segmentation.labels[voxelIndex(7, 12, 3)] == 1u);
+  CHECK(segmentation.labels[voxelIndex(8, 12, 3)] != 1u);
+
+  REQUIRE_FALSE(progress.empty());
+  CHECK(std::ranges::is_sorted(progress));
+  CHECK(progress.back() == 1.0f);
+
+  // A canceled segmentation stops without labels
+  const std::atomic_bool cancel{true};
+  const PoissonSegmentation canceled =
+    computePoissonSegmentation(seeds, image, sk_dims, distances, labelMaps, settings, &cancel);
+  CHECK(canceled.canceled);
+  CHECK(canceled.labels.empty());
+}
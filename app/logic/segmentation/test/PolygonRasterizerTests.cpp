@@ -0,0 +1,120 @@
+#include "logic/segmentation/PolygonRasterizer.h"
+
+#include "common/MathFuncs.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using Intervals = std::vector<std::pair<float, float>>;
+
+/// Axis-aligned square boundary, counter-clockwise unless reversed
+std::vector<glm::vec2> makeSquare(float minCorner, float maxCorner, bool clockwise = false)
+{
+  std::vector<glm::vec2> square{
+    {minCorner, minCorner}, {maxCorner, minCorner}, {maxCorner, maxCorner}, {minCorner, maxCorner}};
+  if (clockwise) {
+    std::swap(square[1], square[3]);
+  }
+  return square;
+}
+
+/// Five-pointed star drawn as one self-intersecting boundary
+std::vector<glm::vec2> makePentagram(float radius)
+{
+  std::vector<glm::vec2> star;
+  for (int i = 0; i < 5; ++i) {
+    const float angle = 1.5707963f + static_cast<float>(2 * i) * 1.2566371f;
+    star.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
+  }
+  return star;
+}
+
+} // namespace
+
+TEST_CASE("Polygon scanlines are split by holes under both fill rules", "[segmentation][polygon]")
+{
+  for (const bool holeIsClockwise : {false, true}) {
+    const std::vector<std::vector<glm::vec2>> boundaries{
+      makeSquare(0.0f, 10.0f), makeSquare(4.0f, 6.0f, holeIsClockwise)};
+
+    for (const PolygonFillRule rule : {PolygonFillRule::EvenOdd, PolygonFillRule::NonZero}) {
+      const PolygonScanConverter polygon(boundaries, {1.0f, 0.0f}, rule);
+
+      Intervals intervals;
+      polygon.scan({-2.0f, 5.0f}, intervals);
+      REQUIRE(intervals.size() == 2);
+      CHECK(intervals[0] == std::pair(2.0f, 6.0f));
+      CHECK(intervals[1] == std::pair(8.0f, 12.0f));
+
+      polygon.scan({0.0f, 2.0f}, intervals);
+      REQUIRE(intervals.size() == 1);
+      CHECK(intervals[0] == std::pair(0.0f, 10.0f));
+
+      polygon.scan({0.0f, 11.0f}, intervals);
+      CHECK(intervals.empty());
+
+      CHECK(polygon.contains({1.0f, 1.0f}));
+      CHECK_FALSE(polygon.contains({5.0f, 5.0f}));
+    }
+  }
+}
+
+TEST_CASE("Self-intersecting polygons are filled by their fill rule", "[segmentation][polygon]")
+{
+  const std::vector<std::vector<glm::vec2>> boundaries{makePentagram(10.0f)};
+
+  const PolygonScanConverter evenOdd(boundaries, {1.0f, 0.0f}, PolygonFillRule::EvenOdd);
+  const PolygonScanConverter nonZero(boundaries, {1.0f, 0.0f}, PolygonFillRule::NonZero);
+
+  // The central pentagon is wound twice
+  CHECK_FALSE(evenOdd.contains({0.0f, 0.0f}));
+  CHECK(nonZero.contains({0.0f, 0.0f}));
+
+  // The points of the star are wound once
+  CHECK(evenOdd.contains({0.0f, 8.0f}));
+  CHECK(nonZero.contains({0.0f, 8.0f}));
+
+  // A scanline through the center crosses two points of the star and the pentagon between them
+  Intervals intervals;
+  evenOdd.scan({-20.0f, 0.5f}, intervals);
+  CHECK(intervals.size() == 2);
+  nonZero.scan({-20.0f, 0.5f}, intervals);
+  CHECK(intervals.size() == 1);
+}
+
+TEST_CASE("Oblique polygon scanlines agree with point-in-polygon tests", "[segmentation][polygon]")
+{
+  // Concave polygon with vertices that lie exactly on some scanlines
+  const std::vector<glm::vec2> outline{
+    {0.0f, 0.0f}, {8.0f, 0.0f}, {8.0f, 3.0f}, {4.0f, 1.0f}, {5.0f, 6.0f}, {2.0f, 4.0f}, {0.0f, 6.0f}};
+
+  const glm::vec2 direction{0.8f, 0.3f};
+  const PolygonScanConverter polygon({outline}, direction, PolygonFillRule::EvenOdd);
+
+  Intervals intervals;
+  for (int row = -40; row <= 40; ++row) {
+    const glm::vec2 origin{-2.0f, 0.25f * static_cast<float>(row)};
+    polygon.scan(origin, intervals);
+
+    for (int step = 0; step <= 200; ++step) {
+      const float t = 0.1f * static_cast<float>(step) + 0.05f;
+      const glm::vec2 point = origin + t * direction;
+
+      bool insideInterval = false;
+      for (const auto& [t0, t1] : intervals) {
+        insideInterval |= (t0 <= t && t < t1);
+      }
+
+      CHECK(insideInterval == (1 == math::pnpoly(outline, point)));
+      CHECK(polygon.contains(point) == insideInterval);
+    }
+  }
+}
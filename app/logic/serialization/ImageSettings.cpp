@@ -40,6 +40,7 @@ void to_json(json& j, const serialize::ImageSettings& settings)
   json time = json::object();
   addIfChanged(time, "activePoint", settings.m_activeTimePoint, defaults.m_activeTimePoint);
   addIfChanged(time, "playbackLoop", settings.m_timePlaybackLoop, defaults.m_timePlaybackLoop);
+  addIfChanged(time, "playbackBounce", settings.m_timePlaybackBounce, defaults.m_timePlaybackBounce);
   addIfChanged(time, "playbackPlaying", settings.m_timePlaybackPlaying, defaults.m_timePlaybackPlaying);
   addIfChanged(time, "playbackSpeed", settings.m_timePlaybackSpeed, defaults.m_timePlaybackSpeed);
   addIfNotEmpty(j, "time", std::move(time));
@@ -279,6 +280,9 @@ void from_json(const json& j, serialize::ImageSettings& settings)
     if (const auto loop = time->find("playbackLoop"); loop != time->end() && loop->is_boolean()) {
       settings.m_timePlaybackLoop = loop->get<bool>();
     }
+    if (const auto bounce = time->find("playbackBounce"); bounce != time->end() && bounce->is_boolean()) {
+      settings.m_timePlaybackBounce = bounce->get<bool>();
+    }
     if (const auto playing = time->find("playbackPlaying"); playing != time->end() && playing->is_boolean()) {
       settings.m_timePlaybackPlaying = playing->get<bool>();
     }
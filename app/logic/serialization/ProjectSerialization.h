@@ -302,6 +302,7 @@ struct ImageSettings
   uint32_t m_activeComponent = 0;     //!< Active image component
   uint32_t m_activeTimePoint = 0;     //!< Active time point for time-series images
   bool m_timePlaybackLoop = true;     //!< Loop time playback
+  bool m_timePlaybackBounce = false;  //!< Reverse time playback at the first and last time points
   bool m_timePlaybackPlaying = false; //!< Time playback is running
   double m_timePlaybackSpeed = 1.0;   //!< Time playback speed multiplier
   ProjectComponentRenderMode m_componentRenderMode =
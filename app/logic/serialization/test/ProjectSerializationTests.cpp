@@ -852,6 +852,7 @@ TEST_CASE("Project serialization preserves image edge settings", "[project][seri
     .m_activeComponent = 2,
     .m_activeTimePoint = 4,
     .m_timePlaybackLoop = false,
+    .m_timePlaybackBounce = true,
     .m_timePlaybackPlaying = true,
     .m_timePlaybackSpeed = 1.5,
     .m_componentRenderMode = serialize::ProjectComponentRenderMode::ComplexPhase,
@@ -950,6 +951,7 @@ TEST_CASE("Project serialization preserves image edge settings", "[project][seri
   CHECK(transform.at("allowExaggeratedWarp") == true);
   CHECK(time.at("activePoint") == 4);
   CHECK(time.at("playbackLoop") == false);
+  CHECK(time.at("playbackBounce") == true);
   CHECK(time.at("playbackPlaying") == true);
   CHECK(time.at("playbackSpeed") == 1.5);
   CHECK(components.at("active") == 2);
@@ -1067,6 +1069,7 @@ TEST_CASE("Project serialization preserves image edge settings", "[project][seri
   CHECK(parsedSettings.m_activeComponent == 2);
   CHECK(parsedSettings.m_activeTimePoint == 4);
   CHECK_FALSE(parsedSettings.m_timePlaybackLoop);
+  CHECK(parsedSettings.m_timePlaybackBounce);
   CHECK(parsedSettings.m_timePlaybackPlaying);
   CHECK(parsedSettings.m_timePlaybackSpeed == 1.5);
   CHECK(parsedSettings.m_level == 30.0);
@@ -0,0 +1,544 @@
+#include "mesh/MarchingCubes.h"
+
+#include "common/Parallel.h"
+#include "image/Image.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace
+{
+
+constexpr uint32_t sk_blockSize = IsosurfaceBlockRanges::sk_blockSize;
+
+/// Offset of cube corner n from the base corner of its cell
+glm::ivec3 cornerOffset(int n)
+{
+  return {n & 1, (n >> 1) & 1, (n >> 2) & 1};
+}
+
+/**
+ * @brief Triangles of the 256 cases of inside and outside cube corners, as cube edges. Edge 4 * a + n
+ * points along axis a from the n-th corner whose bit a is clear.
+ *
+ * The table is generated instead of being written out: on every cube face, each crossing where the face
+ * boundary enters the inside is joined to the next crossing where it leaves, walking counter-clockwise as
+ * seen from outside of the cube. This separates the inside corners of ambiguous faces, and the segments of
+ * the six faces link into loops that are triangulated as fans.
+ */
+class CaseTable
+{
+public:
+  static constexpr int sk_maxTriangles = 12;
+
+  struct Case
+  {
+    int numTriangles = 0;
+    std::array<std::array<uint8_t, 3>, sk_maxTriangles> triangles{};
+  };
+
+  CaseTable()
+  {
+    for (int n = 0; n < 12; ++n) {
+      const int axis = n / 4;
+      const int others = n % 4;
+
+      // Insert a zero bit at the axis position
+      const int low = others & ((1 << axis) - 1);
+      const int high = (others >> axis) << (axis + 1);
+      m_edgeBase[static_cast<std::size_t>(n)] = low | high;
+      m_edgeAxis[static_cast<std::size_t>(n)] = axis;
+    }
+
+    for (int c = 0; c < 256; ++c) {
+      m_cases[static_cast<std::size_t>(c)] = makeCase(c);
+    }
+  }
+
+  const Case& operator[](int c) const
+  {
+    return m_cases[static_cast<std::size_t>(c)];
+  }
+
+  int edgeBase(int edge) const
+  {
+    return m_edgeBase[static_cast<std::size_t>(edge)];
+  }
+
+  int edgeAxis(int edge) const
+  {
+    return m_edgeAxis[static_cast<std::size_t>(edge)];
+  }
+
+private:
+  int edgeBetween(int c0, int c1) const
+  {
+    const int axis = (c0 ^ c1) == 1 ? 0 : ((c0 ^ c1) == 2 ? 1 : 2);
+    const int base = std::min(c0, c1);
+    for (int n = 4 * axis; n < 4 * axis + 4; ++n) {
+      if (m_edgeBase[static_cast<std::size_t>(n)] == base) {
+        return n;
+      }
+    }
+    return -1;
+  }
+
+  /// Bit mask of the cube faces that contain an edge, with bit 2 * axis + side for each face
+  int faces(int edge) const
+  {
+    const int axis = m_edgeAxis[static_cast<std::size_t>(edge)];
+    const int base = m_edgeBase[static_cast<std::size_t>(edge)];
+
+    int mask = 0;
+    for (int a = 0; a < 3; ++a) {
+      if (a != axis) {
+        mask |= 1 << (2 * a + ((base >> a) & 1));
+      }
+    }
+    return mask;
+  }
+
+  Case makeCase(int c) const
+  {
+    auto inside = [c](int corner) { return 0 != (c & (1 << corner)); };
+
+    // The crossing that follows each crossing where a face boundary enters the inside
+    std::array<int, 12> next;
+    next.fill(-1);
+
+    for (int axis = 0; axis < 3; ++axis) {
+      for (int side = 0; side < 2; ++side) {
+        const int a1 = (axis + 1) % 3;
+        const int a2 = (axis + 2) % 3;
+        const int base = side << axis;
+
+        // Counter-clockwise about +axis, reversed on the face that looks along -axis
+        std::array<int, 4> corners{base, base | (1 << a1), base | (1 << a1) | (1 << a2), base | (1 << a2)};
+        if (0 == side) {
+          std::swap(corners[1], corners[3]);
+        }
+
+        std::array<int, 4> crossings;
+        std::array<bool, 4> entering;
+        int count = 0;
+
+        for (int n = 0; n < 4; ++n) {
+          const int c0 = corners[static_cast<std::size_t>(n)];
+          const int c1 = corners[static_cast<std::size_t>((n + 1) % 4)];
+          if (inside(c0) != inside(c1)) {
+            crossings[static_cast<std::size_t>(count)] = edgeBetween(c0, c1);
+            entering[static_cast<std::size_t>(count)] = inside(c1);
+            ++count;
+          }
+        }
+
+        for (int n = 0; n < count; ++n) {
+          if (entering[static_cast<std::size_t>(n)]) {
+            next[static_cast<std::size_t>(crossings[static_cast<std::size_t>(n)])] =
+              crossings[static_cast<std::size_t>((n + 1) % count)];
+          }
+        }
+      }
+    }
+
+    Case result;
+    std::array<bool, 12> visited{};
+
+    for (int start = 0; start < 12; ++start) {
+      if (visited[static_cast<std::size_t>(start)] || next[static_cast<std::size_t>(start)] < 0) {
+        continue;
+      }
+
+      std::vector<int> loop;
+      for (int e = start; !visited[static_cast<std::size_t>(e)]; e = next[static_cast<std::size_t>(e)]) {
+        visited[static_cast<std::size_t>(e)] = true;
+        loop.push_back(e);
+      }
+
+      // Start the fan where none of its diagonals lie on a cube face. Otherwise, a diagonal across an
+      // ambiguous face can coincide with one in the neighboring cell, and four triangles share an edge.
+      const std::size_t size = loop.size();
+      std::size_t first = 0;
+      int fewestOnFaces = std::numeric_limits<int>::max();
+
+      for (std::size_t s = 0; s < size; ++s) {
+        int onFaces = 0;
+        for (std::size_t n = 2; n + 1 < size; ++n) {
+          onFaces += (0 != (faces(loop[s]) & faces(loop[(s + n) % size]))) ? 1 : 0;
+        }
+        if (onFaces < fewestOnFaces) {
+          fewestOnFaces = onFaces;
+          first = s;
+        }
+      }
+
+      for (std::size_t n = 1; n + 1 < size; ++n) {
+        result.triangles[static_cast<std::size_t>(result.numTriangles++)] = {
+          static_cast<uint8_t>(loop[first]),
+          static_cast<uint8_t>(loop[(first + n) % size]),
+          static_cast<uint8_t>(loop[(first + n + 1) % size])};
+      }
+    }
+
+    return result;
+  }
+
+  std::array<Case, 256> m_cases;
+  std::array<int, 12> m_edgeBase;
+  std::array<int, 12> m_edgeAxis;
+};
+
+const CaseTable& caseTable()
+{
+  static const CaseTable s_table;
+  return s_table;
+}
+
+/// Vertices on the voxel edges owned by one block
+struct BlockVertices
+{
+  /// Sorted keys of the edges, relative to the block's first voxel
+  std::vector<uint32_t> edgeKeys;
+  std::vector<glm::vec3> positions; //!< Positions in Pixel space
+  std::vector<glm::vec3> gradients; //!< Value gradients in Pixel space
+};
+
+/// Key of the edge along an axis from a voxel, relative to the first voxel of its block
+uint32_t edgeKey(const glm::ivec3& local, int axis)
+{
+  constexpr uint32_t size = sk_blockSize + 1;
+  return ((static_cast<uint32_t>(local.z) * size + static_cast<uint32_t>(local.y)) * size +
+          static_cast<uint32_t>(local.x)) *
+           3 +
+         static_cast<uint32_t>(axis);
+}
+
+} // namespace
+
+std::optional<IsosurfaceBlockRanges> IsosurfaceBlockRanges::build(
+  const Image& image,
+  uint32_t component,
+  uint32_t timePoint,
+  unsigned int numThreads)
+{
+  IsosurfaceBlockRanges ranges;
+  ranges.m_dimensions = image.header().pixelDimensions();
+
+  // Blocks cover the cells between voxels, so images that are one voxel thin have no blocks
+  for (int a = 0; a < 3; ++a) {
+    ranges.m_blockCounts[a] =
+      (ranges.m_dimensions[a] < 2) ? 0u : (ranges.m_dimensions[a] - 1 + sk_blockSize - 1) / sk_blockSize;
+  }
+
+  const std::size_t numBlocks =
+    static_cast<std::size_t>(ranges.m_blockCounts.x) * ranges.m_blockCounts.y * ranges.m_blockCounts.z;
+  ranges.m_minValues.assign(numBlocks, std::numeric_limits<double>::max());
+  ranges.m_maxValues.assign(numBlocks, std::numeric_limits<double>::lowest());
+
+  const glm::ivec3 dims{ranges.m_dimensions};
+  const glm::ivec3 counts{ranges.m_blockCounts};
+
+  const bool visited = image.visitComponentView(component, timePoint, [&](const auto& view) {
+    parallel::forEachSlab(numThreads, 0, counts.z, [&](unsigned int, int bzBegin, int bzEnd) {
+      for (int bz = bzBegin; bz < bzEnd; ++bz) {
+        for (int by = 0; by < counts.y; ++by) {
+          for (int bx = 0; bx < counts.x; ++bx) {
+            const glm::ivec3 lo = glm::ivec3{bx, by, bz} * static_cast<int>(sk_blockSize);
+            const glm::ivec3 hi = glm::min(lo + static_cast<int>(sk_blockSize), dims - 1);
+
+            double minValue = std::numeric_limits<double>::max();
+            double maxValue = std::numeric_limits<double>::lowest();
+
+            for (int k = lo.z; k <= hi.z; ++k) {
+              for (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                  const double value = static_cast<double>(view.at(
+                    static_cast<std::size_t>(i), static_cast<std::size_t>(j), static_cast<std::size_t>(k)));
+                  minValue = std::min(minValue, value);
+                  maxValue = std::max(maxValue, value);
+                }
+              }
+            }
+
+            const std::size_t b = (static_cast<std::size_t>(bz) * static_cast<std::size_t>(counts.y) +
+                                   static_cast<std::size_t>(by)) *
+                                    static_cast<std::size_t>(counts.x) +
+                                  static_cast<std::size_t>(bx);
+            ranges.m_minValues[b] = minValue;
+            ranges.m_maxValues[b] = maxValue;
+          }
+        }
+      }
+    });
+  });
+
+  if (!visited) {
+    return std::nullopt;
+  }
+
+  return ranges;
+}
+
+const glm::uvec3& IsosurfaceBlockRanges::dimensions() const
+{
+  return m_dimensions;
+}
+
+const glm::uvec3& IsosurfaceBlockRanges::blockCounts() const
+{
+  return m_blockCounts;
+}
+
+std::size_t IsosurfaceBlockRanges::numBlocks() const
+{
+  return m_minValues.size();
+}
+
+bool IsosurfaceBlockRanges::isActive(std::size_t block, double isoValue) const
+{
+  // The surface separates values below the isovalue from values at or above it
+  return m_minValues[block] < isoValue && isoValue <= m_maxValues[block];
+}
+
+std::size_t IsosurfaceBlockRanges::numActiveBlocks(double isoValue) const
+{
+  std::size_t count = 0;
+  for (std::size_t b = 0; b < numBlocks(); ++b) {
+    count += isActive(b, isoValue) ? 1 : 0;
+  }
+  return count;
+}
+
+std::optional<IsosurfaceMesh> generateIsosurfaceMesh(
+  const Image& image,
+  uint32_t component,
+  double isoValue,
+  const IsosurfaceSettings& settings,
+  const IsosurfaceBlockRanges* blockRanges)
+{
+  const unsigned int numThreads = std::max(settings.numThreads, 1u);
+
+  std::optional<IsosurfaceBlockRanges> builtRanges;
+  if (!blockRanges || blockRanges->dimensions() != image.header().pixelDimensions()) {
+    builtRanges = IsosurfaceBlockRanges::build(image, component, settings.timePoint, numThreads);
+    if (!builtRanges) {
+      spdlog::error(
+        "Unable to extract isosurface of component {} of image {}", component, image.settings().displayName());
+      return std::nullopt;
+    }
+    blockRanges = &(*builtRanges);
+  }
+
+  const glm::ivec3 dims{blockRanges->dimensions()};
+  const glm::ivec3 counts{blockRanges->blockCounts()};
+  const int blockSize = static_cast<int>(sk_blockSize);
+
+  std::vector<int> activeBlocks;
+  for (std::size_t b = 0; b < blockRanges->numBlocks(); ++b) {
+    if (blockRanges->isActive(b, isoValue)) {
+      activeBlocks.push_back(static_cast<int>(b));
+    }
+  }
+
+  auto blockOrigin = [&counts, blockSize](int b) {
+    return glm::ivec3{b % counts.x, (b / counts.x) % counts.y, b / (counts.x * counts.y)} * blockSize;
+  };
+
+  // Voxels whose edges a block owns: those of its cells, and the last voxels of the image for the last blocks
+  auto ownedEnd = [&dims, blockSize](const glm::ivec3& origin) {
+    glm::ivec3 end = origin + blockSize;
+    for (int a = 0; a < 3; ++a) {
+      if (end[a] >= dims[a] - 1) {
+        end[a] = dims[a];
+      }
+    }
+    return end;
+  };
+
+  auto blockIndex = [&counts](const glm::ivec3& b) {
+    return (b.z * counts.y + b.y) * counts.x + b.x;
+  };
+
+  const CaseTable& table = caseTable();
+
+  // Indexed by block, only set for active blocks
+  std::vector<BlockVertices> vertices(blockRanges->numBlocks());
+  std::vector<std::vector<uint32_t>> triangles(activeBlocks.size());
+  std::vector<uint32_t> vertexOffsets(blockRanges->numBlocks() + 1, 0);
+
+  const bool extracted = image.visitComponentView(component, settings.timePoint, [&](const auto& view) {
+    auto valueAt = [&view](int i, int j, int k) {
+      return static_cast<double>(
+        view.at(static_cast<std::size_t>(i), static_cast<std::size_t>(j), static_cast<std::size_t>(k)));
+    };
+
+    // Central differences, which become one-sided on the image boundary
+    auto gradientAt = [&](const glm::ivec3& p) {
+      glm::vec3 gradient;
+      for (int a = 0; a < 3; ++a) {
+        glm::ivec3 lo = p;
+        glm::ivec3 hi = p;
+        lo[a] = std::max(p[a] - 1, 0);
+        hi[a] = std::min(p[a] + 1, dims[a] - 1);
+        gradient[a] = (hi[a] == lo[a]) ? 0.0f
+                                       : static_cast<float>(
+                                           (valueAt(hi.x, hi.y, hi.z) - valueAt(lo.x, lo.y, lo.z)) / (hi[a] - lo[a]));
+      }
+      return gradient;
+    };
+
+    // Create the vertices of the crossed edges that each active block owns:
+    parallel::forEachSlab(numThreads, 0, static_cast<int>(activeBlocks.size()), [&](unsigned int, int begin, int end) {
+      for (int n = begin; n < end; ++n) {
+        const int b = activeBlocks[static_cast<std::size_t>(n)];
+        const glm::ivec3 origin = blockOrigin(b);
+        const glm::ivec3 last = ownedEnd(origin);
+        BlockVertices& block = vertices[static_cast<std::size_t>(b)];
+
+        for (int k = origin.z; k < last.z; ++k) {
+          for (int j = origin.y; j < last.y; ++j) {
+            for (int i = origin.x; i < last.x; ++i) {
+              const glm::ivec3 p{i, j, k};
+              const double value = valueAt(i, j, k);
+
+              for (int a = 0; a < 3; ++a) {
+                glm::ivec3 q = p;
+                if (++q[a] >= dims[a]) {
+                  continue;
+                }
+
+                const double otherValue = valueAt(q.x, q.y, q.z);
+                if ((value >= isoValue) == (otherValue >= isoValue)) {
+                  continue;
+                }
+
+                const float t = static_cast<float>((isoValue - value) / (otherValue - value));
+                glm::vec3 position{p};
+                position[a] += t;
+
+                block.edgeKeys.push_back(edgeKey(p - origin, a));
+                block.positions.push_back(position);
+                block.gradients.push_back(glm::mix(gradientAt(p), gradientAt(q), t));
+              }
+            }
+          }
+        }
+      }
+    });
+
+    for (std::size_t b = 0; b < vertices.size(); ++b) {
+      vertexOffsets[b + 1] = vertexOffsets[b] + static_cast<uint32_t>(vertices[b].edgeKeys.size());
+    }
+
+    // Global index of the vertex on an edge, which may be owned by a neighboring block
+    auto findVertex = [&](const glm::ivec3& p, int axis) {
+      const glm::ivec3 owner = glm::min(p / blockSize, counts - 1);
+      const int b = blockIndex(owner);
+      const std::vector<uint32_t>& keys = vertices[static_cast<std::size_t>(b)].edgeKeys;
+      const auto it = std::lower_bound(keys.begin(), keys.end(), edgeKey(p - owner * blockSize, axis));
+      return vertexOffsets[static_cast<std::size_t>(b)] + static_cast<uint32_t>(it - keys.begin());
+    };
+
+    // Create the triangles of the cells of each active block:
+    parallel::forEachSlab(numThreads, 0, static_cast<int>(activeBlocks.size()), [&](unsigned int, int begin, int end) {
+      for (int n = begin; n < end; ++n) {
+        const glm::ivec3 origin = blockOrigin(activeBlocks[static_cast<std::size_t>(n)]);
+        const glm::ivec3 last = glm::min(origin + blockSize, dims - 1);
+        std::vector<uint32_t>& indices = triangles[static_cast<std::size_t>(n)];
+
+        for (int k = origin.z; k < last.z; ++k) {
+          for (int j = origin.y; j < last.y; ++j) {
+            // Inside bits of the four corners at x = i, as the bits of the corners on the low x side of a cell
+            auto column = [&](int i) {
+              return ((valueAt(i, j, k) >= isoValue) ? 0x01 : 0) | ((valueAt(i, j + 1, k) >= isoValue) ? 0x04 : 0) |
+                     ((valueAt(i, j, k + 1) >= isoValue) ? 0x10 : 0) |
+                     ((valueAt(i, j + 1, k + 1) >= isoValue) ? 0x40 : 0);
+            };
+
+            int left = column(origin.x);
+
+            for (int i = origin.x; i < last.x; ++i) {
+              const int right = column(i + 1);
+              const int c = left | (right << 1);
+              left = right;
+
+              const CaseTable::Case& cellCase = table[c];
+              for (int t = 0; t < cellCase.numTriangles; ++t) {
+                for (const uint8_t edge : cellCase.triangles[static_cast<std::size_t>(t)]) {
+                  const glm::ivec3 p = glm::ivec3{i, j, k} + cornerOffset(table.edgeBase(edge));
+                  indices.push_back(findVertex(p, table.edgeAxis(edge)));
+                }
+              }
+            }
+          }
+        }
+      }
+    });
+  });
+
+  if (!extracted) {
+    spdlog::error(
+      "Unable to extract isosurface of component {} of image {}", component, image.settings().displayName());
+    return std::nullopt;
+  }
+
+  const glm::mat4& subject_T_pixel = image.transformations().subject_T_pixel();
+  const glm::mat3 normal_T_gradient = glm::inverseTranspose(glm::mat3{subject_T_pixel});
+
+  // Reverse the triangles if the transformation to Subject space flips orientation
+  const bool flip = (glm::determinant(glm::mat3{subject_T_pixel}) < 0.0f);
+
+  IsosurfaceMesh mesh;
+  mesh.positions.resize(vertexOffsets.back());
+  mesh.normals.resize(vertexOffsets.back());
+
+  parallel::forEachSlab(numThreads, 0, static_cast<int>(vertices.size()), [&](unsigned int, int begin, int end) {
+    for (int b = begin; b < end; ++b) {
+      const BlockVertices& block = vertices[static_cast<std::size_t>(b)];
+      const std::size_t offset = vertexOffsets[static_cast<std::size_t>(b)];
+
+      for (std::size_t v = 0; v < block.positions.size(); ++v) {
+        const glm::vec4 p = subject_T_pixel * glm::vec4{block.positions[v], 1.0f};
+        mesh.positions[offset + v] = glm::vec3{p / p.w};
+
+        // Normals point down the gradient, out of the region at or above the isovalue
+        const glm::vec3 normal = -(normal_T_gradient * block.gradients[v]);
+        const float length = glm::length(normal);
+        mesh.normals[offset + v] = (length > 0.0f) ? normal / length : glm::vec3{0.0f};
+      }
+    }
+  });
+
+  std::size_t numIndices = 0;
+  for (const auto& indices : triangles) {
+    numIndices += indices.size();
+  }
+
+  mesh.indices.reserve(numIndices);
+  for (const auto& indices : triangles) {
+    mesh.indices.insert(mesh.indices.end(), indices.begin(), indices.end());
+  }
+
+  if (flip) {
+    for (std::size_t n = 0; n + 2 < mesh.indices.size(); n += 3) {
+      std::swap(mesh.indices[n + 1], mesh.indices[n + 2]);
+    }
+  }
+
+  spdlog::debug(
+    "Extracted isosurface at value {} of image {} from {} of {} blocks: {} vertices and {} triangles",
+    isoValue,
+    image.settings().displayName(),
+    activeBlocks.size(),
+    blockRanges->numBlocks(),
+    mesh.positions.size(),
+    mesh.indices.size() / 3);
+
+  return mesh;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <vector>
+
+class Image;
+
+/**
+ * @brief Settings for extracting isosurfaces with marching cubes.
+ */
+struct IsosurfaceSettings
+{
+  uint32_t timePoint = 0; //!< Time point of the image to extract
+
+  /// Maximum number of threads
+  unsigned int numThreads = std::thread::hardware_concurrency();
+};
+
+/**
+ * @brief Closed (within the image) triangle mesh of an isosurface.
+ */
+struct IsosurfaceMesh
+{
+  std::vector<glm::vec3> positions; //!< Vertex positions in Subject space
+  std::vector<glm::vec3> normals;   //!< Unit vertex normals in Subject space, pointing towards lower values
+  std::vector<uint32_t> indices;    //!< Triangle vertex indices, counter-clockwise when viewed from lower values
+};
+
+/**
+ * @brief Minimum and maximum values of blocks of an image component, which let isosurface extraction
+ * skip the blocks that the isosurface cannot cross. Build the ranges once and reuse them while the
+ * isovalue changes; they must be rebuilt when the image values change.
+ *
+ * Block b covers the marching cubes cells [b * sk_blockSize, (b + 1) * sk_blockSize) along each axis,
+ * so its range includes the voxels on its upper faces, which it shares with the next blocks.
+ */
+class IsosurfaceBlockRanges
+{
+public:
+  static constexpr uint32_t sk_blockSize = 16; //!< Number of cells along each side of a block
+
+  /**
+   * @brief Compute the block ranges of one component of one time point of an image.
+   * @return The ranges, or std::nullopt if the component or time point is invalid.
+   */
+  static std::optional<IsosurfaceBlockRanges> build(
+    const Image& image,
+    uint32_t component,
+    uint32_t timePoint = 0,
+    unsigned int numThreads = std::thread::hardware_concurrency());
+
+  /// @brief Get the voxel dimensions of the image.
+  const glm::uvec3& dimensions() const;
+
+  /// @brief Get the number of blocks along each axis.
+  const glm::uvec3& blockCounts() const;
+
+  std::size_t numBlocks() const;
+
+  /// @brief Test whether the isosurface at a value can cross a block.
+  bool isActive(std::size_t block, double isoValue) const;
+
+  /// @brief Get the number of blocks that the isosurface at a value can cross.
+  std::size_t numActiveBlocks(double isoValue) const;
+
+private:
+  IsosurfaceBlockRanges() = default;
+
+  glm::uvec3 m_dimensions{0};
+  glm::uvec3 m_blockCounts{0};
+  std::vector<double> m_minValues; //!< Minimum value of each block, in x-fastest block order
+  std::vector<double> m_maxValues; //!< Maximum value of each block, in x-fastest block order
+};
+
+/**
+ * @brief Extract the isosurface of an image component with parallel marching cubes.
+ *
+ * Only the blocks whose value range contains the isovalue are visited. Each block creates the vertices
+ * of the voxel edges that it owns and the triangles of its cells, which refer to the vertices of
+ * neighboring blocks across block seams, so the mesh has no duplicate vertices and does not depend on
+ * the number of threads. Voxels with values at or above the isovalue are inside of the surface.
+ * Ambiguous cube faces separate the inside voxels, so the triangles of neighboring cells always match.
+ *
+ * @param image Image whose component is meshed.
+ * @param component Image component.
+ * @param isoValue Value of the isosurface.
+ * @param settings Extraction settings.
+ * @param blockRanges Optional block ranges of the component, which are computed if not provided or
+ * if they do not match the image.
+ * @return The mesh, which is empty if the isosurface does not cross the image, or std::nullopt if the
+ * component or time point is invalid.
+ */
+std::optional<IsosurfaceMesh> generateIsosurfaceMesh(
+  const Image& image,
+  uint32_t component,
+  double isoValue,
+  const IsosurfaceSettings& settings = {},
+  const IsosurfaceBlockRanges* blockRanges = nullptr);
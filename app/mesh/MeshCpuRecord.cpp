@@ -1,18 +1,81 @@
 #include "mesh/MeshCpuRecord.h"
 
-MeshCpuRecord::MeshCpuRecord(vtkSmartPointer<vtkPolyData> polyData, MeshInfo meshInfo)
-  : m_polyData(polyData), m_meshInfo(std::move(meshInfo))
+#include <algorithm>
+#include <utility>
+
+MeshCpuRecord::MeshCpuRecord(
+  std::vector<glm::vec3> positions,
+  std::vector<glm::vec3> normals,
+  std::vector<uint32_t> indices,
+  MeshInfo meshInfo)
+  : m_positions(std::move(positions))
+  , m_normals(std::move(normals))
+  , m_indices(std::move(indices))
+  , m_meshInfo(std::move(meshInfo))
+{
+}
+
+const std::vector<glm::vec3>& MeshCpuRecord::positions(std::size_t level) const
+{
+  return (0 == level || m_levelsOfDetail.empty()) ? m_positions : simplifiedLevel(level).positions;
+}
+
+const std::vector<glm::vec3>& MeshCpuRecord::normals(std::size_t level) const
+{
+  return (0 == level || m_levelsOfDetail.empty()) ? m_normals : simplifiedLevel(level).normals;
+}
+
+const std::vector<uint32_t>& MeshCpuRecord::indices(std::size_t level) const
+{
+  return (0 == level || m_levelsOfDetail.empty()) ? m_indices : simplifiedLevel(level).indices;
+}
+
+std::size_t MeshCpuRecord::numVertices(std::size_t level) const
+{
+  return positions(level).size();
+}
+
+std::size_t MeshCpuRecord::numTriangles(std::size_t level) const
+{
+  return indices(level).size() / 3;
+}
+
+void MeshCpuRecord::setLevelsOfDetail(std::vector<MeshLevelOfDetail> levels)
+{
+  m_levelsOfDetail = std::move(levels);
+}
+
+std::size_t MeshCpuRecord::numLevelsOfDetail() const
+{
+  return 1 + m_levelsOfDetail.size();
+}
+
+std::vector<float> MeshCpuRecord::levelErrors() const
+{
+  std::vector<float> errors{0.0f};
+  for (const MeshLevelOfDetail& level : m_levelsOfDetail) {
+    errors.push_back(level.error);
+  }
+  return errors;
+}
+
+std::vector<std::size_t> MeshCpuRecord::levelTriangleCounts() const
 {
+  std::vector<std::size_t> counts{numTriangles(0)};
+  for (const MeshLevelOfDetail& level : m_levelsOfDetail) {
+    counts.push_back(level.indices.size() / 3);
+  }
+  return counts;
 }
 
-const vtkSmartPointer<vtkPolyData> MeshCpuRecord::polyData() const
+std::size_t MeshCpuRecord::levelOfDetailForScreenSize(float pixelsPerUnit) const
 {
-  return m_polyData;
+  return selectLevelOfDetail(levelErrors(), pixelsPerUnit);
 }
 
-vtkSmartPointer<vtkPolyData> MeshCpuRecord::polyData()
+const MeshLevelOfDetail& MeshCpuRecord::simplifiedLevel(std::size_t level) const
 {
-  return m_polyData;
+  return m_levelsOfDetail[std::min(level, m_levelsOfDetail.size()) - 1];
 }
 
 const MeshInfo& MeshCpuRecord::meshInfo() const
@@ -1,19 +1,28 @@
 #pragma once
 
+#include "mesh/MeshDecimation.h"
 #include "mesh/MeshInfo.hpp"
 #include "mesh/MeshProperties.h"
 
-#include <vtkPolyData.h>
-#include <vtkSmartPointer.h>
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 /**
  * @brief Record for CPU storage of meshes.
- * Under the hood, mesh data is vtkPolyData.
+ * Under the hood, mesh data is an indexed triangle list with per-vertex normals in Subject space.
+ * The record may also hold simplified levels of detail of the mesh. Level 0 is always the full mesh.
  */
 class MeshCpuRecord
 {
 public:
-  MeshCpuRecord(vtkSmartPointer<vtkPolyData> polyData, MeshInfo meshInfo);
+  MeshCpuRecord(
+    std::vector<glm::vec3> positions,
+    std::vector<glm::vec3> normals,
+    std::vector<uint32_t> indices,
+    MeshInfo meshInfo);
 
   MeshCpuRecord(const MeshCpuRecord&) = default;
   MeshCpuRecord& operator=(const MeshCpuRecord&) = default;
@@ -23,8 +32,32 @@ public:
 
   ~MeshCpuRecord() = default;
 
-  const vtkSmartPointer<vtkPolyData> polyData() const;
-  vtkSmartPointer<vtkPolyData> polyData();
+  /// Mesh data at a level of detail. Levels past the coarsest one give the coarsest level.
+  const std::vector<glm::vec3>& positions(std::size_t level = 0) const;
+  const std::vector<glm::vec3>& normals(std::size_t level = 0) const;
+  const std::vector<uint32_t>& indices(std::size_t level = 0) const;
+
+  std::size_t numVertices(std::size_t level = 0) const;
+  std::size_t numTriangles(std::size_t level = 0) const;
+
+  /// @brief Set the simplified levels of detail, from finest to coarsest.
+  void setLevelsOfDetail(std::vector<MeshLevelOfDetail> levels);
+
+  /// @brief Get the number of levels of detail, including the full mesh.
+  std::size_t numLevelsOfDetail() const;
+
+  /// @brief Get the errors of all levels of detail, starting with 0 for the full mesh.
+  std::vector<float> levelErrors() const;
+
+  /// @brief Get the triangle counts of all levels of detail, starting with the full mesh.
+  std::vector<std::size_t> levelTriangleCounts() const;
+
+  /**
+   * @brief Get the level of detail to draw for the projected size of the mesh on screen.
+   * @param pixelsPerUnit Screen pixels per unit of Subject space at the mesh
+   * @return Coarsest level whose error projects to at most one pixel
+   */
+  std::size_t levelOfDetailForScreenSize(float pixelsPerUnit) const;
 
   const MeshInfo& meshInfo() const;
 
@@ -33,7 +66,14 @@ public:
   void setProperties(MeshProperties);
 
 private:
-  vtkSmartPointer<vtkPolyData> m_polyData;
+  std::vector<glm::vec3> m_positions; //!< Vertex positions
+  std::vector<glm::vec3> m_normals;   //!< Unit vertex normals
+  std::vector<uint32_t> m_indices;    //!< Triangle vertex indices
+
+  std::vector<MeshLevelOfDetail> m_levelsOfDetail; //!< Simplified levels, not including the full mesh
+
+  /// Simplified level for a level index greater than 0
+  const MeshLevelOfDetail& simplifiedLevel(std::size_t level) const;
 
   MeshInfo m_meshInfo;
   MeshProperties m_properties;
@@ -0,0 +1,652 @@
+#include "mesh/MeshDecimation.h"
+
+#include "common/Parallel.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <tuple>
+#include <utility>
+
+namespace
+{
+
+using Triangle = std::array<uint32_t, 3>;
+
+/// Minimum number of triangles for splitting a mesh into slabs that are decimated in parallel
+constexpr std::size_t sk_minParallelTriangles = 20000;
+
+/// Symmetric 4x4 matrix whose quadratic form is the sum of squared distances to a set of planes
+struct Quadric
+{
+  /// Upper triangle of the matrix, row by row
+  std::array<double, 10> m{};
+
+  static Quadric fromPlane(const glm::dvec3& n, double d)
+  {
+    Quadric q;
+    q.m = {n.x * n.x, n.x * n.y, n.x * n.z, n.x * d, n.y * n.y, n.y * n.z, n.y * d, n.z * n.z, n.z * d, d * d};
+    return q;
+  }
+
+  Quadric& operator+=(const Quadric& other)
+  {
+    for (std::size_t i = 0; i < m.size(); ++i) {
+      m[i] += other.m[i];
+    }
+    return *this;
+  }
+
+  double error(const glm::dvec3& p) const
+  {
+    return m[0] * p.x * p.x + 2.0 * m[1] * p.x * p.y + 2.0 * m[2] * p.x * p.z + 2.0 * m[3] * p.x +
+           m[4] * p.y * p.y + 2.0 * m[5] * p.y * p.z + 2.0 * m[6] * p.y + m[7] * p.z * p.z + 2.0 * m[8] * p.z +
+           m[9];
+  }
+
+  /// Position of least error, unless the planes are (nearly) parallel and it is not unique
+  std::optional<glm::dvec3> minimizer() const
+  {
+    const double c00 = m[4] * m[7] - m[5] * m[5];
+    const double c01 = m[2] * m[5] - m[1] * m[7];
+    const double c02 = m[1] * m[5] - m[2] * m[4];
+    const double det = m[0] * c00 + m[1] * c01 + m[2] * c02;
+
+    const double scale = std::max({std::abs(m[0]), std::abs(m[4]), std::abs(m[7])});
+    if (std::abs(det) <= 1.0e-6 * scale * scale * scale) {
+      return std::nullopt;
+    }
+
+    const double c11 = m[0] * m[7] - m[2] * m[2];
+    const double c12 = m[1] * m[2] - m[0] * m[5];
+    const double c22 = m[0] * m[4] - m[1] * m[1];
+    const glm::dvec3 b{-m[3], -m[6], -m[8]};
+
+    return glm::dvec3{
+             c00 * b.x + c01 * b.y + c02 * b.z, c01 * b.x + c11 * b.y + c12 * b.z, c02 * b.x + c12 * b.y + c22 * b.z} /
+           det;
+  }
+};
+
+/**
+ * @brief Greedy quadric error edge collapser (Garland and Heckbert). Edges are collapsed in order of
+ * increasing error from a priority queue whose entries become stale when their vertices change.
+ */
+class EdgeCollapser
+{
+public:
+  EdgeCollapser(
+    std::vector<glm::vec3> positions,
+    std::vector<Quadric> quadrics,
+    std::vector<uint8_t> locked,
+    std::vector<Triangle> triangles)
+    : m_positions(std::move(positions))
+    , m_quadrics(std::move(quadrics))
+    , m_locked(std::move(locked))
+    , m_triangles(std::move(triangles))
+    , m_triangleRemoved(m_triangles.size(), 0)
+    , m_vertexTriangles(m_positions.size())
+    , m_stamps(m_positions.size(), 0)
+    , m_numTriangles(m_triangles.size())
+  {
+    for (std::size_t t = 0; t < m_triangles.size(); ++t) {
+      for (const uint32_t v : m_triangles[t]) {
+        m_vertexTriangles[v].push_back(static_cast<uint32_t>(t));
+      }
+    }
+  }
+
+  /**
+   * @brief Collapse edges until no more than a number of triangles remain or the next collapse exceeds an error.
+   * @return Largest quadric error of the collapses
+   */
+  double run(std::size_t targetTriangles, double maxCost)
+  {
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    edges.reserve(3 * m_triangles.size());
+    for (const Triangle& tri : m_triangles) {
+      for (std::size_t e = 0; e < 3; ++e) {
+        edges.emplace_back(std::minmax(tri[e], tri[(e + 1) % 3]));
+      }
+    }
+
+    std::ranges::sort(edges);
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    for (const auto& [u, v] : edges) {
+      pushEdge(u, v);
+    }
+
+    double largestCost = 0.0;
+
+    while (m_numTriangles > targetTriangles && !m_queue.empty()) {
+      const Candidate candidate = m_queue.top();
+      if (candidate.cost > maxCost) {
+        break;
+      }
+      m_queue.pop();
+
+      if (candidate.stampU != m_stamps[candidate.u] || candidate.stampV != m_stamps[candidate.v]) {
+        continue; // Stale
+      }
+
+      if (!canCollapse(candidate.u, candidate.v, candidate.position)) {
+        continue;
+      }
+
+      collapse(candidate.u, candidate.v, candidate.position);
+      largestCost = std::max(largestCost, candidate.cost);
+    }
+
+    return largestCost;
+  }
+
+  const std::vector<glm::vec3>& positions() const
+  {
+    return m_positions;
+  }
+
+  const std::vector<Quadric>& quadrics() const
+  {
+    return m_quadrics;
+  }
+
+  std::vector<Triangle> remainingTriangles() const
+  {
+    std::vector<Triangle> triangles;
+    triangles.reserve(m_numTriangles);
+    for (std::size_t t = 0; t < m_triangles.size(); ++t) {
+      if (!m_triangleRemoved[t]) {
+        triangles.push_back(m_triangles[t]);
+      }
+    }
+    return triangles;
+  }
+
+private:
+  /// Collapse of vertex v into vertex u, which moves to a position
+  struct Candidate
+  {
+    double cost;
+    uint32_t u;
+    uint32_t v;
+    uint32_t stampU;
+    uint32_t stampV;
+    glm::vec3 position;
+
+    bool operator>(const Candidate& other) const
+    {
+      return std::tie(cost, u, v) > std::tie(other.cost, other.u, other.v);
+    }
+  };
+
+  void pushEdge(uint32_t u, uint32_t v)
+  {
+    if (m_locked[u] && m_locked[v]) {
+      return;
+    }
+
+    // Locked vertices survive in place
+    if (m_locked[v]) {
+      std::swap(u, v);
+    }
+
+    Quadric q = m_quadrics[u];
+    q += m_quadrics[v];
+
+    const glm::dvec3 pu{m_positions[u]};
+    const glm::dvec3 pv{m_positions[v]};
+    glm::dvec3 best = pu;
+
+    if (!m_locked[u]) {
+      // The optimal position, unless it lies far from the edge, or else the best of the ends and midpoint
+      const glm::dvec3 mid = 0.5 * (pu + pv);
+      best = mid;
+
+      const auto optimal = q.minimizer();
+      if (optimal && glm::length(*optimal - mid) <= glm::length(pv - pu)) {
+        best = *optimal;
+      }
+
+      for (const glm::dvec3& p : {mid, pu, pv}) {
+        if (q.error(p) < q.error(best)) {
+          best = p;
+        }
+      }
+    }
+
+    m_queue.push(Candidate{std::max(q.error(best), 0.0), u, v, m_stamps[u], m_stamps[v], glm::vec3{best}});
+  }
+
+  /// Sorted neighbors of a vertex
+  void neighbors(uint32_t v, std::vector<uint32_t>& result) const
+  {
+    result.clear();
+    for (const uint32_t t : m_vertexTriangles[v]) {
+      if (!m_triangleRemoved[t]) {
+        for (const uint32_t w : m_triangles[t]) {
+          if (w != v) {
+            result.push_back(w);
+          }
+        }
+      }
+    }
+
+    std::ranges::sort(result);
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+  }
+
+  bool canCollapse(uint32_t u, uint32_t v, const glm::vec3& position)
+  {
+    neighbors(u, m_neighborsU);
+    neighbors(v, m_neighborsV);
+
+    if (!std::ranges::binary_search(m_neighborsU, v)) {
+      return false;
+    }
+
+    // Link condition: the only shared neighbors are the opposite vertices of the triangles of the edge,
+    // otherwise the collapse pinches the surface
+    std::size_t edgeTriangles = 0;
+    for (const uint32_t t : m_vertexTriangles[u]) {
+      const Triangle& tri = m_triangles[t];
+      if (!m_triangleRemoved[t] && std::ranges::find(tri, v) != tri.end()) {
+        ++edgeTriangles;
+      }
+    }
+
+    std::size_t shared = 0;
+    for (const uint32_t w : m_neighborsU) {
+      shared += std::ranges::binary_search(m_neighborsV, w) ? 1 : 0;
+    }
+
+    if (shared != edgeTriangles || m_numTriangles <= 2 * edgeTriangles) {
+      return false;
+    }
+
+    // The triangles that remain must not fold over
+    for (const uint32_t moved : {u, v}) {
+      for (const uint32_t t : m_vertexTriangles[moved]) {
+        const Triangle& tri = m_triangles[t];
+        if (m_triangleRemoved[t] || (std::ranges::find(tri, u) != tri.end() && std::ranges::find(tri, v) != tri.end()))
+        {
+          continue;
+        }
+
+        std::array<glm::vec3, 3> corners{m_positions[tri[0]], m_positions[tri[1]], m_positions[tri[2]]};
+        const glm::vec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+
+        for (std::size_t n = 0; n < 3; ++n) {
+          if (tri[n] == moved) {
+            corners[n] = position;
+          }
+        }
+
+        const glm::vec3 after = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+        const float lengths = glm::length(before) * glm::length(after);
+
+        if (glm::length(before) > 0.0f && (lengths <= 0.0f || glm::dot(before, after) < 0.2f * lengths)) {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  void collapse(uint32_t u, uint32_t v, const glm::vec3& position)
+  {
+    m_positions[u] = position;
+    m_quadrics[u] += m_quadrics[v];
+
+    for (const uint32_t t : m_vertexTriangles[v]) {
+      if (m_triangleRemoved[t]) {
+        continue;
+      }
+
+      Triangle& tri = m_triangles[t];
+      if (std::ranges::find(tri, u) != tri.end()) {
+        m_triangleRemoved[t] = 1;
+        --m_numTriangles;
+        continue;
+      }
+
+      std::ranges::replace(tri, v, u);
+      m_vertexTriangles[u].push_back(t);
+    }
+
+    m_vertexTriangles[v].clear();
+    std::erase_if(m_vertexTriangles[u], [this](uint32_t t) { return 0 != m_triangleRemoved[t]; });
+
+    ++m_stamps[u];
+    ++m_stamps[v];
+
+    neighbors(u, m_neighborsU);
+    for (const uint32_t w : m_neighborsU) {
+      pushEdge(u, w);
+    }
+  }
+
+  std::vector<glm::vec3> m_positions;
+  std::vector<Quadric> m_quadrics;
+  std::vector<uint8_t> m_locked;
+  std::vector<Triangle> m_triangles;
+  std::vector<uint8_t> m_triangleRemoved;
+  std::vector<std::vector<uint32_t>> m_vertexTriangles;
+  std::vector<uint32_t> m_stamps; //!< Changed when a vertex moves, which makes its queued collapses stale
+  std::size_t m_numTriangles;
+
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> m_queue;
+  std::vector<uint32_t> m_neighborsU;
+  std::vector<uint32_t> m_neighborsV;
+};
+
+/// Simplified mesh and the index of each of its vertices in the mesh that was simplified
+struct Decimation
+{
+  MeshLevelOfDetail mesh;
+  std::vector<uint32_t> sourceVertices;
+};
+
+bool isValidMesh(
+  const std::vector<glm::vec3>& positions,
+  const std::vector<uint32_t>& indices,
+  const std::vector<uint8_t>& lockedVertices)
+{
+  return 0 == indices.size() % 3 && (lockedVertices.empty() || lockedVertices.size() == positions.size()) &&
+         std::ranges::all_of(indices, [&positions](uint32_t i) { return i < positions.size(); });
+}
+
+Decimation decimate(
+  const std::vector<glm::vec3>& positions,
+  const std::vector<uint32_t>& indices,
+  const std::vector<uint8_t>& lockedVertices,
+  const MeshDecimationSettings& settings)
+{
+  const std::size_t numVertices = positions.size();
+  const unsigned int numThreads = std::max(settings.numThreads, 1u);
+
+  std::vector<Triangle> triangles(indices.size() / 3);
+  for (std::size_t t = 0; t < triangles.size(); ++t) {
+    triangles[t] = {indices[3 * t], indices[3 * t + 1], indices[3 * t + 2]};
+  }
+
+  // Quadrics of the planes of the triangles around each vertex:
+  std::vector<Quadric> quadrics(numVertices);
+  for (const Triangle& tri : triangles) {
+    const glm::dvec3 a{positions[tri[0]]};
+    const glm::dvec3 normal = glm::cross(glm::dvec3{positions[tri[1]]} - a, glm::dvec3{positions[tri[2]]} - a);
+    const double length = glm::length(normal);
+    if (length <= 0.0) {
+      continue;
+    }
+
+    const Quadric plane = Quadric::fromPlane(normal / length, -glm::dot(normal / length, a));
+    for (const uint32_t v : tri) {
+      quadrics[v] += plane;
+    }
+  }
+
+  std::vector<uint8_t> locked = lockedVertices.empty() ? std::vector<uint8_t>(numVertices, 0) : lockedVertices;
+
+  // Lock the vertices of edges that do not have exactly two triangles:
+  if (settings.preserveBoundary) {
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    edges.reserve(3 * triangles.size());
+    for (const Triangle& tri : triangles) {
+      for (std::size_t e = 0; e < 3; ++e) {
+        edges.emplace_back(std::minmax(tri[e], tri[(e + 1) % 3]));
+      }
+    }
+
+    std::ranges::sort(edges);
+    for (std::size_t begin = 0, end = 0; begin < edges.size(); begin = end) {
+      while (end < edges.size() && edges[end] == edges[begin]) {
+        ++end;
+      }
+      if (2 != end - begin) {
+        locked[edges[begin].first] = 1;
+        locked[edges[begin].second] = 1;
+      }
+    }
+  }
+
+  const float ratio = std::clamp(settings.triangleRatio, 0.0f, 1.0f);
+  const std::size_t target = static_cast<std::size_t>(std::ceil(ratio * static_cast<double>(triangles.size())));
+  const double maxCost = static_cast<double>(settings.maxError) * static_cast<double>(settings.maxError);
+  double largestCost = 0.0;
+
+  std::vector<glm::vec3> current = positions;
+
+  // Decimate slabs along the longest axis in parallel, keeping the vertices on slab seams:
+  if (numThreads > 1 && triangles.size() >= sk_minParallelTriangles && target < triangles.size()) {
+    glm::vec3 lo{std::numeric_limits<float>::max()};
+    glm::vec3 hi{std::numeric_limits<float>::lowest()};
+    for (const glm::vec3& p : positions) {
+      lo = glm::min(lo, p);
+      hi = glm::max(hi, p);
+    }
+
+    const glm::vec3 extent = hi - lo;
+    const int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+    const float slabsPerUnit = (extent[axis] > 0.0f) ? static_cast<float>(numThreads) / extent[axis] : 0.0f;
+
+    constexpr int sk_unassigned = -1;
+    constexpr int sk_seam = -2;
+    std::vector<int> vertexSlabs(numVertices, sk_unassigned);
+    std::vector<std::vector<uint32_t>> slabTriangles(numThreads);
+
+    for (std::size_t t = 0; t < triangles.size(); ++t) {
+      const Triangle& tri = triangles[t];
+      const float centroid = (positions[tri[0]][axis] + positions[tri[1]][axis] + positions[tri[2]][axis]) / 3.0f;
+      const int slab =
+        std::clamp(static_cast<int>((centroid - lo[axis]) * slabsPerUnit), 0, static_cast<int>(numThreads) - 1);
+      slabTriangles[static_cast<std::size_t>(slab)].push_back(static_cast<uint32_t>(t));
+
+      for (const uint32_t v : tri) {
+        if (sk_unassigned == vertexSlabs[v]) {
+          vertexSlabs[v] = slab;
+        }
+        else if (slab != vertexSlabs[v]) {
+          vertexSlabs[v] = sk_seam;
+        }
+      }
+    }
+
+    std::vector<std::vector<Triangle>> remaining(numThreads);
+    std::vector<double> slabCosts(numThreads, 0.0);
+
+    parallel::forEachSlab(numThreads, 0, static_cast<int>(numThreads), [&](unsigned int, int begin, int end) {
+      for (int s = begin; s < end; ++s) {
+        const std::vector<uint32_t>& slab = slabTriangles[static_cast<std::size_t>(s)];
+
+        std::vector<uint32_t> globals;
+        globals.reserve(3 * slab.size());
+        for (const uint32_t t : slab) {
+          globals.insert(globals.end(), triangles[t].begin(), triangles[t].end());
+        }
+        std::ranges::sort(globals);
+        globals.erase(std::unique(globals.begin(), globals.end()), globals.end());
+
+        auto local = [&globals](uint32_t v) {
+          return static_cast<uint32_t>(std::ranges::lower_bound(globals, v) - globals.begin());
+        };
+
+        std::vector<glm::vec3> localPositions(globals.size());
+        std::vector<Quadric> localQuadrics(globals.size());
+        std::vector<uint8_t> localLocked(globals.size());
+        for (std::size_t n = 0; n < globals.size(); ++n) {
+          localPositions[n] = positions[globals[n]];
+          localQuadrics[n] = quadrics[globals[n]];
+          localLocked[n] = (locked[globals[n]] || sk_seam == vertexSlabs[globals[n]]) ? 1 : 0;
+        }
+
+        std::vector<Triangle> localTriangles(slab.size());
+        for (std::size_t n = 0; n < slab.size(); ++n) {
+          const Triangle& tri = triangles[slab[n]];
+          localTriangles[n] = {local(tri[0]), local(tri[1]), local(tri[2])};
+        }
+
+        EdgeCollapser collapser(
+          std::move(localPositions), std::move(localQuadrics), localLocked, std::move(localTriangles));
+        const std::size_t slabTarget = static_cast<std::size_t>(std::ceil(ratio * static_cast<double>(slab.size())));
+        slabCosts[static_cast<std::size_t>(s)] = collapser.run(slabTarget, maxCost);
+
+        // Vertices that are not locked belong to this slab only
+        for (std::size_t n = 0; n < globals.size(); ++n) {
+          if (!localLocked[n]) {
+            current[globals[n]] = collapser.positions()[n];
+            quadrics[globals[n]] = collapser.quadrics()[n];
+          }
+        }
+
+        for (Triangle tri : collapser.remainingTriangles()) {
+          for (uint32_t& v : tri) {
+            v = globals[v];
+          }
+          remaining[static_cast<std::size_t>(s)].push_back(tri);
+        }
+      }
+    });
+
+    triangles.clear();
+    for (std::size_t s = 0; s < numThreads; ++s) {
+      triangles.insert(triangles.end(), remaining[s].begin(), remaining[s].end());
+      largestCost = std::max(largestCost, slabCosts[s]);
+    }
+  }
+
+  // Decimate the whole mesh, including the slab seams
+  EdgeCollapser collapser(std::move(current), std::move(quadrics), locked, std::move(triangles));
+  largestCost = std::max(largestCost, collapser.run(target, maxCost));
+
+  // Keep the vertices of the remaining triangles, in their original order:
+  const std::vector<Triangle> simplified = collapser.remainingTriangles();
+
+  Decimation result;
+  std::vector<uint32_t> newIndices(numVertices, std::numeric_limits<uint32_t>::max());
+  for (const Triangle& tri : simplified) {
+    for (const uint32_t v : tri) {
+      newIndices[v] = 0;
+    }
+  }
+
+  for (uint32_t v = 0; v < numVertices; ++v) {
+    if (0 == newIndices[v]) {
+      newIndices[v] = static_cast<uint32_t>(result.sourceVertices.size());
+      result.sourceVertices.push_back(v);
+      result.mesh.positions.push_back(collapser.positions()[v]);
+    }
+  }
+
+  result.mesh.indices.reserve(3 * simplified.size());
+  result.mesh.normals.assign(result.mesh.positions.size(), glm::vec3{0.0f});
+
+  for (const Triangle& tri : simplified) {
+    const uint32_t a = newIndices[tri[0]];
+    const uint32_t b = newIndices[tri[1]];
+    const uint32_t c = newIndices[tri[2]];
+    result.mesh.indices.insert(result.mesh.indices.end(), {a, b, c});
+
+    const std::vector<glm::vec3>& p = result.mesh.positions;
+    const glm::vec3 normal = glm::cross(p[b] - p[a], p[c] - p[a]);
+    result.mesh.normals[a] += normal;
+    result.mesh.normals[b] += normal;
+    result.mesh.normals[c] += normal;
+  }
+
+  for (glm::vec3& normal : result.mesh.normals) {
+    const float length = glm::length(normal);
+    normal = (length > 0.0f) ? normal / length : glm::vec3{0.0f};
+  }
+
+  result.mesh.error = static_cast<float>(std::sqrt(largestCost));
+  return result;
+}
+
+} // namespace
+
+std::optional<MeshLevelOfDetail> decimateMesh(
+  const std::vector<glm::vec3>& positions,
+  const std::vector<uint32_t>& indices,
+  const std::vector<uint8_t>& lockedVertices,
+  const MeshDecimationSettings& settings)
+{
+  if (!isValidMesh(positions, indices, lockedVertices)) {
+    return std::nullopt;
+  }
+
+  return decimate(positions, indices, lockedVertices, settings).mesh;
+}
+
+std::optional<std::vector<MeshLevelOfDetail>> generateLevelsOfDetail(
+  const std::vector<glm::vec3>& positions,
+  const std::vector<uint32_t>& indices,
+  const std::vector<uint8_t>& lockedVertices,
+  const std::vector<float>& triangleRatios,
+  const MeshDecimationSettings& settings)
+{
+  if (!isValidMesh(positions, indices, lockedVertices)) {
+    return std::nullopt;
+  }
+
+  std::vector<MeshLevelOfDetail> levels;
+  std::vector<uint8_t> locked = lockedVertices;
+  const double numTriangles = static_cast<double>(indices.size() / 3);
+
+  for (const float ratio : triangleRatios) {
+    const MeshLevelOfDetail* previous = levels.empty() ? nullptr : &levels.back();
+    const std::vector<glm::vec3>& levelPositions = previous ? previous->positions : positions;
+    const std::vector<uint32_t>& levelIndices = previous ? previous->indices : indices;
+
+    MeshDecimationSettings levelSettings = settings;
+    levelSettings.triangleRatio =
+      levelIndices.empty() ? 1.0f
+                           : static_cast<float>(ratio * numTriangles / static_cast<double>(levelIndices.size() / 3));
+
+    Decimation decimation = decimate(levelPositions, levelIndices, locked, levelSettings);
+    decimation.mesh.error += previous ? previous->error : 0.0f;
+
+    if (!locked.empty()) {
+      std::vector<uint8_t> levelLocked(decimation.sourceVertices.size());
+      for (std::size_t v = 0; v < levelLocked.size(); ++v) {
+        levelLocked[v] = locked[decimation.sourceVertices[v]];
+      }
+      locked = std::move(levelLocked);
+    }
+
+    levels.push_back(std::move(decimation.mesh));
+  }
+
+  return levels;
+}
+
+std::size_t selectLevelOfDetail(const std::vector<float>& levelErrors, float pixelsPerUnit, float maxPixelError)
+{
+  for (std::size_t level = levelErrors.size(); level > 1; --level) {
+    if (levelErrors[level - 1] * pixelsPerUnit <= maxPixelError) {
+      return level - 1;
+    }
+  }
+  return 0;
+}
+
+std::size_t selectLevelOfDetailForFidelity(const std::vector<std::size_t>& levelTriangleCounts, float fidelity)
+{
+  if (levelTriangleCounts.empty()) {
+    return 0;
+  }
+
+  const double minTriangles = std::clamp(fidelity, 0.0f, 1.0f) * static_cast<double>(levelTriangleCounts.front());
+
+  for (std::size_t level = levelTriangleCounts.size(); level > 1; --level) {
+    if (static_cast<double>(levelTriangleCounts[level - 1]) >= minTriangles) {
+      return level - 1;
+    }
+  }
+  return 0;
+}
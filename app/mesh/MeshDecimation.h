@@ -0,0 +1,94 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Settings for simplifying triangle meshes with quadric error edge collapses.
+ */
+struct MeshDecimationSettings
+{
+  /// Fraction of the triangles to keep
+  float triangleRatio = 0.25f;
+
+  /// Largest allowed distance of the simplified surface from the original, in the units of the positions
+  float maxError = std::numeric_limits<float>::max();
+
+  /// Keep the vertices of open and non-manifold edges, such as where a surface is cut by the image boundary
+  bool preserveBoundary = true;
+
+  /// Maximum number of threads
+  unsigned int numThreads = std::thread::hardware_concurrency();
+};
+
+/**
+ * @brief Simplified triangle mesh.
+ */
+struct MeshLevelOfDetail
+{
+  std::vector<glm::vec3> positions;
+  std::vector<glm::vec3> normals; //!< Unit, area-weighted vertex normals
+  std::vector<uint32_t> indices;  //!< Triangle vertex indices, with the orientation of the original triangles
+
+  /// Estimated largest distance of the surface from the original surface, in the units of the positions
+  float error = 0.0f;
+};
+
+/**
+ * @brief Simplify a triangle mesh by collapsing the edges with the smallest quadric error.
+ *
+ * Collapses that would fold triangles over or make the surface non-manifold are rejected. The mesh is
+ * first split into slabs that are simplified on parallel threads while the vertices on slab seams are
+ * kept; the seams are then simplified on the whole mesh. The result depends on the number of threads.
+ *
+ * @param positions Vertex positions.
+ * @param indices Triangle vertex indices.
+ * @param lockedVertices Non-zero for vertices that must be kept in place, such as those shared with other
+ * meshes, or empty to lock none.
+ * @param settings Decimation settings.
+ * @return The simplified mesh, or std::nullopt if the indices or locked vertices do not match the positions.
+ */
+std::optional<MeshLevelOfDetail> decimateMesh(
+  const std::vector<glm::vec3>& positions,
+  const std::vector<uint32_t>& indices,
+  const std::vector<uint8_t>& lockedVertices,
+  const MeshDecimationSettings& settings = {});
+
+/**
+ * @brief Generate successively coarser levels of detail of a triangle mesh. Each level is simplified
+ * from the previous one, and its error includes the errors of the previous levels.
+ *
+ * @param triangleRatios Fractions of the triangles of the original mesh to keep at each level, in
+ * decreasing order. The triangle ratio of the settings is ignored.
+ * @see decimateMesh for the other parameters.
+ * @return The levels, coarsest last, or std::nullopt if the indices or locked vertices do not match.
+ */
+std::optional<std::vector<MeshLevelOfDetail>> generateLevelsOfDetail(
+  const std::vector<glm::vec3>& positions,
+  const std::vector<uint32_t>& indices,
+  const std::vector<uint8_t>& lockedVertices,
+  const std::vector<float>& triangleRatios,
+  const MeshDecimationSettings& settings = {});
+
+/**
+ * @brief Select the level of detail to draw for the projected size of a mesh on screen.
+ * @param levelErrors Errors of the levels, from the full mesh (error 0) to the coarsest level.
+ * @param pixelsPerUnit Screen pixels per unit of the mesh positions at the mesh.
+ * @param maxPixelError Largest error to allow on screen, in pixels.
+ * @return Index of the coarsest level whose error projects to at most \p maxPixelError pixels.
+ */
+std::size_t selectLevelOfDetail(const std::vector<float>& levelErrors, float pixelsPerUnit, float maxPixelError = 1.0f);
+
+/**
+ * @brief Select the level of detail to export for a fidelity chosen by the user.
+ * @param levelTriangleCounts Triangle counts of the levels, from the full mesh to the coarsest level.
+ * @param fidelity Fraction of the triangles of the full mesh to keep at least, from 0 to 1.
+ * @return Index of the coarsest level with at least the requested fraction of triangles.
+ */
+std::size_t selectLevelOfDetailForFidelity(const std::vector<std::size_t>& levelTriangleCounts, float fidelity);
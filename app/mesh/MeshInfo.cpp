@@ -1,6 +1,8 @@
 #include "mesh/MeshInfo.hpp"
 
-MeshInfo::MeshInfo(MeshSource meshSource, MeshPrimitiveType primitiveType, boost::variant<double, uint32_t> scalarValue)
+#include <utility>
+
+MeshInfo::MeshInfo(MeshSource meshSource, MeshPrimitiveType primitiveType, std::variant<double, uint32_t> scalarValue)
   : m_meshSource(std::move(meshSource)), m_primitiveType(std::move(primitiveType)), m_scalarValue(scalarValue)
 {
 }
@@ -15,19 +17,25 @@ MeshPrimitiveType MeshInfo::primitiveType() const
   return m_primitiveType;
 }
 
-boost::variant<double, uint32_t> MeshInfo::scalarValue() const
+std::variant<double, uint32_t> MeshInfo::scalarValue() const
 {
   return m_scalarValue;
 }
 
 double MeshInfo::isoValue() const
 {
-  return boost::apply_visitor(IsoValueVisitor(), m_scalarValue);
+  if (const double* isoValue = std::get_if<double>(&m_scalarValue)) {
+    return *isoValue;
+  }
+  return -1.0;
 }
 
 uint32_t MeshInfo::labelIndex() const
 {
-  return boost::apply_visitor(LabelVisitor(), m_scalarValue);
+  if (const uint32_t* labelIndex = std::get_if<uint32_t>(&m_scalarValue)) {
+    return *labelIndex;
+  }
+  return 0;
 }
 
 /*
@@ -2,15 +2,14 @@
 
 #include "mesh/MeshTypes.h"
 
-#include <boost/variant.hpp>
-
 #include <cstddef>
+#include <cstdint>
 #include <variant>
 
 class MeshInfo
 {
 public:
-  MeshInfo(MeshSource meshSource, MeshPrimitiveType primitiveType, boost::variant<double, uint32_t> scalarValue);
+  MeshInfo(MeshSource meshSource, MeshPrimitiveType primitiveType, std::variant<double, uint32_t> scalarValue);
 
   MeshInfo(const MeshInfo&) = default;
   MeshInfo& operator=(const MeshInfo&) = default;
@@ -24,7 +23,7 @@ public:
   MeshPrimitiveType primitiveType() const;
 
   // Scalar value is an index for label meshes
-  boost::variant<double, uint32_t> scalarValue() const;
+  std::variant<double, uint32_t> scalarValue() const;
 
   double isoValue() const;
 
@@ -35,31 +34,7 @@ private:
   MeshPrimitiveType m_primitiveType;
 
   // Either isovalue or label index
-  boost::variant<double, uint32_t> m_scalarValue;
-
-  struct IsoValueVisitor : public boost::static_visitor<double>
-  {
-    double operator()(double s) const
-    {
-      return s;
-    }
-    double operator()(uint32_t) const
-    {
-      return -1.0;
-    }
-  };
-
-  struct LabelVisitor : public boost::static_visitor<uint32_t>
-  {
-    uint32_t operator()(double) const
-    {
-      return 0;
-    }
-    uint32_t operator()(uint32_t s) const
-    {
-      return s;
-    }
-  };
+  std::variant<double, uint32_t> m_scalarValue;
 };
 
 // std::ostream& operator<< ( std::ostream&, const imageio::MeshInfo& );
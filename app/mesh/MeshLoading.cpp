@@ -1,132 +1,179 @@
 #include "mesh/MeshLoading.h"
+#include "mesh/MarchingCubes.h"
 #include "mesh/MeshCpuRecord.h"
-#include "mesh/vtkdetails/MeshGeneration.hpp"
+#include "mesh/MeshDecimation.h"
+#include "mesh/SurfaceNets.h"
 
-#include "common/MathFuncs.h"
-#include "common/VnlMath.h"
 #include "common/UuidUtility.h"
 
 #include "image/Image.h"
-#include "image/ImageHeader.h"
-#include "internal/ImageUtility.tpp"
-
-#include "rendering/utility/CreateGLObjects.h"
 
 #include <glm/glm.hpp>
-#include <glm/gtc/type_ptr.hpp>
-
-#include <vnl/vnl_matrix_fixed.h>
-
-#include <vtkImageData.h>
-#include <vtkPolyData.h>
-#include <vtkSmartPointer.h>
 
 #include <spdlog/fmt/ostr.h>
 #include <spdlog/spdlog.h>
 
-#include <limits>
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace
 {
 
-std::unique_ptr<MeshCpuRecord>
-_generateIsosurfaceMeshCpuRecord(vtkImageData* imageData, const ImageHeader& imageHeader, double isoValue)
+// Note: triangle strips offer no speed advantage over indexed triangles on modern hardware
+constexpr MeshPrimitiveType sk_primitiveType = MeshPrimitiveType::Triangles;
+
+/// Fractions of the triangles of the full mesh that are kept in the levels of detail
+const std::vector<float> sk_levelOfDetailTriangleRatios{0.25f, 0.0625f};
+
+/**
+ * @brief Generate the simplified levels of detail of a mesh record.
+ * @param lockedVertices Vertices to keep in place, or empty to lock none
+ */
+void addLevelsOfDetail(MeshCpuRecord& record, const std::vector<uint8_t>& lockedVertices)
 {
-  // Note: triangle strips offer no speed advantage over indexed triangles on modern hardware
-  static const MeshPrimitiveType sk_primitiveType = MeshPrimitiveType::Triangles;
+  auto levels =
+    generateLevelsOfDetail(record.positions(), record.indices(), lockedVertices, sk_levelOfDetailTriangleRatios);
 
-  if (!imageData) {
-    spdlog::error("Error generating iso-surface mesh: Image data is null.");
-    return nullptr;
+  if (!levels) {
+    spdlog::warn("Unable to generate levels of detail of mesh");
+    return;
   }
 
-  const vnl_matrix_fixed<double, 3, 3> imageDirections =
-    math::convert::toVnlMatrixFixed(glm::dmat3{imageHeader.directions()});
+  record.setLevelsOfDetail(std::move(*levels));
+}
 
-  vtkSmartPointer<vtkPolyData> polyData = nullptr;
+/// Write the bytes of a 4-byte value in little-endian order, which binary PLY and STL files use here
+template<typename T>
+void writeLittleEndian(std::ostream& os, T value)
+{
+  static_assert(sizeof(T) == sizeof(uint32_t));
 
-  try {
-    polyData = ::vtkdetails::generateIsoSurfaceMesh(imageData, imageDirections, isoValue, sk_primitiveType);
+  uint32_t bits = std::bit_cast<uint32_t>(value);
+  if constexpr (std::endian::native == std::endian::big) {
+    bits = std::byteswap(bits);
   }
-  catch (const std::exception& e) {
-    spdlog::error("Error generating iso-surface mesh: {}", e.what());
-    return nullptr;
+  os.write(reinterpret_cast<const char*>(&bits), sizeof(bits));
+}
+
+void writeLittleEndian(std::ostream& os, const glm::vec3& v)
+{
+  writeLittleEndian(os, v.x);
+  writeLittleEndian(os, v.y);
+  writeLittleEndian(os, v.z);
+}
+
+bool writePly(const MeshCpuRecord& record, std::size_t level, std::ofstream& os)
+{
+  const bool hasNormals = (record.normals(level).size() == record.numVertices(level));
+
+  os << "ply\n"
+     << "format binary_little_endian 1.0\n"
+     << "comment Entropy\n"
+     << "element vertex " << record.numVertices(level) << "\n"
+     << "property float x\n"
+     << "property float y\n"
+     << "property float z\n";
+
+  if (hasNormals) {
+    os << "property float nx\n"
+       << "property float ny\n"
+       << "property float nz\n";
   }
-  catch (...) {
-    spdlog::error("Error generating iso-surface mesh");
-    return nullptr;
+
+  os << "element face " << record.numTriangles(level) << "\n"
+     << "property list uchar uint vertex_indices\n"
+     << "end_header\n";
+
+  for (std::size_t v = 0; v < record.numVertices(level); ++v) {
+    writeLittleEndian(os, record.positions(level)[v]);
+    if (hasNormals) {
+      writeLittleEndian(os, record.normals(level)[v]);
+    }
   }
 
-  if (!polyData) {
-    spdlog::error("Error generating iso-surface mesh: vtkPolyData is null.");
-    return nullptr;
+  static constexpr char sk_numTriangleVertices = 3;
+
+  for (std::size_t t = 0; t < record.numTriangles(level); ++t) {
+    os.write(&sk_numTriangleVertices, 1);
+    for (std::size_t i = 0; i < 3; ++i) {
+      writeLittleEndian(os, record.indices(level)[3 * t + i]);
+    }
   }
 
-  return std::make_unique<MeshCpuRecord>(polyData, MeshInfo(MeshSource::IsoSurface, sk_primitiveType, isoValue));
+  return static_cast<bool>(os);
 }
 
-/*
-std::unique_ptr<MeshCpuRecord> generateLabelMesh(
-    vtkImageData* imageData,
-    const ImageHeader& imageHeader,
-    uint32_t labelIndex )
+bool writeStl(const MeshCpuRecord& record, std::size_t level, std::ofstream& os)
 {
-    // Note: triangle strips offer no speed advantage over indexed triangles on modern hardware
-    static const MeshPrimitiveType sk_primitiveType = MeshPrimitiveType::Triangles;
-
-    // Parcellation image must have exactly one scalar component
-    if ( 1 != imageHeader.numComponentsPerPixel() ||
-        PixelType::Scalar != imageHeader.pixelType() )
-    {
-        spdlog::error( "Error computing mesh at label index {}: "
-                      "Pixel type must be single-component scalar.", labelIndex );
-        return nullptr;
-    }
-
-    // Parcellation pixels are indices that must be of unsigned integer type
-    if ( ! isUnsignedIntegerType( imageHeader.memoryComponentType() ) )
-    {
-        spdlog::error( "Error computing mesh at label index {}: "
-                      "Parcellation component type must be unsigned integral.", labelIndex );
-        return nullptr;
-    }
+  // 80-byte header, which must not start with "solid", followed by the triangle count
+  std::string header(80, '\0');
+  header.replace(0, 7, "Entropy");
+  os.write(header.data(), static_cast<std::streamsize>(header.size()));
+  writeLittleEndian(os, static_cast<uint32_t>(record.numTriangles(level)));
+
+  static constexpr char sk_attributeByteCount[2] = {0, 0};
+
+  for (std::size_t t = 0; t < record.numTriangles(level); ++t) {
+    const glm::vec3& a = record.positions(level)[record.indices(level)[3 * t + 0]];
+    const glm::vec3& b = record.positions(level)[record.indices(level)[3 * t + 1]];
+    const glm::vec3& c = record.positions(level)[record.indices(level)[3 * t + 2]];
+
+    const glm::vec3 cross = glm::cross(b - a, c - a);
+    const float length = glm::length(cross);
+
+    writeLittleEndian(os, (length > 0.0f) ? cross / length : glm::vec3{0.0f});
+    writeLittleEndian(os, a);
+    writeLittleEndian(os, b);
+    writeLittleEndian(os, c);
+    os.write(sk_attributeByteCount, 2);
+  }
 
-    if ( ! imageData )
-    {
-        spdlog::error( "Parcellation image data is null" );
-        return nullptr;
-    }
+  return static_cast<bool>(os);
+}
 
-    const vnl_matrix_fixed< double, 3, 3 > imageDirections =
-        math::convert::toVnlMatrixFixed( glm::dmat3{ imageHeader.directions() } );
+bool writeObj(const MeshCpuRecord& record, std::size_t level, std::ofstream& os)
+{
+  const bool hasNormals = (record.normals(level).size() == record.numVertices(level));
 
-    try
-    {
-        auto polyData = ::vtkdetails::generateLabelMesh(
-            imageData, imageDirections, labelIndex, sk_primitiveType );
+  os.precision(9);
+  os << "# Entropy\n";
 
-        if ( ! polyData )
-        {
-            spdlog::error( "Error computing mesh at label index {} ", labelIndex );
-            return nullptr;
-        }
+  for (const glm::vec3& p : record.positions(level)) {
+    os << "v " << p.x << " " << p.y << " " << p.z << "\n";
+  }
 
-        return std::make_unique<MeshCpuRecord>(
-            polyData, MeshInfo( MeshSource::Label, sk_primitiveType, labelIndex ) );
+  if (hasNormals) {
+    for (const glm::vec3& n : record.normals(level)) {
+      os << "vn " << n.x << " " << n.y << " " << n.z << "\n";
     }
-    catch ( const std::exception& e )
-    {
-        spdlog::error( "Error generating label mesh at index {}: {}", labelIndex, e.what() );
-        return nullptr;
-    }
-    catch ( ... )
-    {
-        spdlog::error( "Error generating label mesh at index {}", labelIndex);
-        return nullptr;
+  }
+
+  // OBJ indices are one-based
+  for (std::size_t t = 0; t < record.numTriangles(level); ++t) {
+    os << "f";
+    for (std::size_t i = 0; i < 3; ++i) {
+      const uint64_t index = static_cast<uint64_t>(record.indices(level)[3 * t + i]) + 1;
+      if (hasNormals) {
+        os << " " << index << "//" << index;
+      }
+      else {
+        os << " " << index;
+      }
     }
+    os << "\n";
+  }
+
+  return static_cast<bool>(os);
 }
-*/
 
 } // namespace
 
@@ -134,12 +181,15 @@ std::future<AsyncTaskDetails> generateIsosurfaceMeshCpuRecord(
   const Image& image,
   const uuids::uuid& imageUid,
   uint32_t component,
+  uint32_t timePoint,
   double isoValue,
   const uuids::uuid& isosurfaceUid,
+  std::shared_ptr<const IsosurfaceBlockRanges> blockRanges,
+  std::function<void(std::shared_ptr<const IsosurfaceBlockRanges>)> blockRangesUpdater,
   std::function<bool(const uuids::uuid& isosurfaceUid, std::unique_ptr<MeshCpuRecord>)> meshCpuRecordUpdater,
   std::function<void()> addTaskToIsosurfaceGpuMeshGenerationQueue)
 {
-  // Lambda to generate the CPU mesh record using VTK's marching cubes.
+  // Lambda to generate the CPU mesh record using marching cubes.
   // Need to capture by value, since the function is executed asynchronously.
   auto generateMesh = [=](const std::function<void(bool success, std::unique_ptr<MeshCpuRecord>)>& onGenerateDone) {
     spdlog::info("Start generating mesh for isosurface {} at value {} of image {}", isosurfaceUid, isoValue, imageUid);
@@ -152,26 +202,52 @@ std::future<AsyncTaskDetails> generateIsosurfaceMeshCpuRecord(
     retval.objectUid = isosurfaceUid;
     retval.success = false;
 
-    // Cast image component to float prior to mesh generation
-    using ImageCompType = float;
-    const auto itkImage = createItkImageFromImageComponent<ImageCompType>(image, component);
-    const auto vtkImageData = convertItkImageToVtkImageData<ImageCompType>(itkImage);
+    IsosurfaceSettings settings;
+    settings.timePoint = timePoint;
 
-    if (!vtkImageData) {
-      spdlog::error("Image {} has null vtkImageData when generating isosurface", imageUid);
-      onGenerateDone(false, nullptr);
-      return retval;
-    }
+    std::optional<IsosurfaceMesh> mesh;
 
-    auto cpuRecord = _generateIsosurfaceMeshCpuRecord(vtkImageData.Get(), image.header(), isoValue);
+    try {
+      // The ranges only depend on the image values, so they are reused across isovalues
+      std::shared_ptr<const IsosurfaceBlockRanges> ranges = blockRanges;
+      if (!ranges || ranges->dimensions() != image.header().pixelDimensions()) {
+        if (auto built = IsosurfaceBlockRanges::build(image, component, timePoint, settings.numThreads)) {
+          ranges = std::make_shared<const IsosurfaceBlockRanges>(std::move(*built));
+          if (blockRangesUpdater) {
+            blockRangesUpdater(ranges);
+          }
+        }
+      }
 
-    if (!cpuRecord) {
+      mesh = generateIsosurfaceMesh(image, component, isoValue, settings, ranges.get());
+    }
+    catch (const std::exception& e) {
+      spdlog::error("Error generating iso-surface mesh: {}", e.what());
+      mesh = std::nullopt;
+    }
+
+    if (!mesh) {
       spdlog::error("Error generating isosurface CPU mesh record for image {}", imageUid);
       onGenerateDone(false, nullptr);
       return retval;
     }
 
-    spdlog::info("Done generating mesh for isosurface {} at value {} of image", isosurfaceUid, isoValue, imageUid);
+    auto cpuRecord = std::make_unique<MeshCpuRecord>(
+      std::move(mesh->positions),
+      std::move(mesh->normals),
+      std::move(mesh->indices),
+      MeshInfo(MeshSource::IsoSurface, sk_primitiveType, isoValue));
+
+    // The image boundary, where the isosurface may be open, is preserved
+    addLevelsOfDetail(*cpuRecord, {});
+
+    spdlog::info(
+      "Done generating mesh with {} triangles and {} levels of detail for isosurface {} at value {} of image {}",
+      cpuRecord->numTriangles(),
+      cpuRecord->numLevelsOfDetail(),
+      isosurfaceUid,
+      isoValue,
+      imageUid);
 
     onGenerateDone(true, std::move(cpuRecord));
 
@@ -181,30 +257,110 @@ std::future<AsyncTaskDetails> generateIsosurfaceMeshCpuRecord(
 
   // Called when mesh generation is done
   auto generateDone = [=](bool success, std::unique_ptr<MeshCpuRecord> cpuMeshRecord) {
+    bool updated = false;
+
     if (!success || !cpuMeshRecord) {
       spdlog::error("CPU mesh record for isosurface was not generated successfully");
-      return false;
-    }
 
-    if (meshCpuRecordUpdater(isosurfaceUid, std::move(cpuMeshRecord))) {
+      // Let the owner know that the task is over, so that it stops waiting for a mesh
+      meshCpuRecordUpdater(isosurfaceUid, nullptr);
+    }
+    else if (meshCpuRecordUpdater(isosurfaceUid, std::move(cpuMeshRecord))) {
       spdlog::debug("Updated mesh CPU record for isosurface {}", isosurfaceUid);
-      addTaskToIsosurfaceGpuMeshGenerationQueue();
-      return true;
+      updated = true;
     }
     else {
-      spdlog::error("Error updating mesh CPU record for isosurface {}", isosurfaceUid);
-      return false;
+      spdlog::debug("Discarded mesh CPU record for isosurface {}", isosurfaceUid);
     }
+
+    addTaskToIsosurfaceGpuMeshGenerationQueue();
+    return updated;
   };
 
   return std::async(std::launch::async, generateMesh, generateDone);
 }
 
-bool writeMeshToFile(const MeshCpuRecord& record, const std::string& fileName)
+std::map<uint32_t, std::unique_ptr<MeshCpuRecord>> generateLabelMeshCpuRecords(
+  const Image& seg,
+  const std::vector<uint32_t>& labels,
+  const SurfaceNetsSettings& settings,
+  const SegLabelIndex* labelIndex,
+  bool withLevelsOfDetail)
 {
-  if (record.polyData().GetPointer()) {
-    return (::vtkdetails::writePolyData(record.polyData(), fileName.c_str()));
+  std::map<uint32_t, std::unique_ptr<MeshCpuRecord>> records;
+
+  std::optional<std::vector<LabelSurfaceMesh>> meshes;
+
+  try {
+    meshes = generateLabelSurfaceMeshes(seg, labels, settings, labelIndex);
+  }
+  catch (const std::exception& e) {
+    spdlog::error("Error generating label meshes: {}", e.what());
+    meshes = std::nullopt;
+  }
+
+  if (!meshes) {
+    spdlog::error("Error generating label meshes of segmentation {}", seg.settings().displayName());
+    return records;
+  }
+
+  for (LabelSurfaceMesh& mesh : *meshes) {
+    auto record = std::make_unique<MeshCpuRecord>(
+      std::move(mesh.positions),
+      std::move(mesh.normals),
+      std::move(mesh.indices),
+      MeshInfo(MeshSource::Label, sk_primitiveType, mesh.label));
+
+    if (withLevelsOfDetail) {
+      // Keep the vertices shared with adjacent labels, so that neighboring label meshes still meet
+      addLevelsOfDetail(*record, mesh.interfaces);
+    }
+
+    records.emplace(mesh.label, std::move(record));
+  }
+
+  spdlog::info(
+    "Generated meshes of {} labels of segmentation {}", records.size(), seg.settings().displayName());
+
+  return records;
+}
+
+bool writeMeshToFile(const MeshCpuRecord& record, const std::string& fileName, float fidelity)
+{
+  std::string extension = std::filesystem::path(fileName).extension().string();
+  std::transform(std::begin(extension), std::end(extension), std::begin(extension), [](unsigned char c) {
+    return static_cast<char>(std::tolower(c));
+  });
+
+  bool (*writer)(const MeshCpuRecord&, std::size_t, std::ofstream&) = nullptr;
+
+  if (".ply" == extension) {
+    writer = writePly;
+  }
+  else if (".stl" == extension) {
+    writer = writeStl;
+  }
+  else if (".obj" == extension) {
+    writer = writeObj;
+  }
+  else {
+    spdlog::error("Cannot write mesh to {}: unsupported file extension '{}'", fileName, extension);
+    return false;
+  }
+
+  std::ofstream os(fileName, std::ios::binary | std::ios::trunc);
+  if (!os) {
+    spdlog::error("Cannot open {} for writing mesh", fileName);
+    return false;
+  }
+
+  const std::size_t level = selectLevelOfDetailForFidelity(record.levelTriangleCounts(), fidelity);
+
+  if (!writer(record, level, os)) {
+    spdlog::error("Error writing mesh to {}", fileName);
+    return false;
   }
 
-  return false;
+  spdlog::info("Wrote mesh with {} triangles to {}", record.numTriangles(level), fileName);
+  return true;
 }
@@ -2,27 +2,73 @@
 
 #include "common/AsyncTasks.h"
 #include "mesh/MeshCpuRecord.h"
+#include "mesh/SurfaceNets.h"
 
 #include <functional>
 #include <future>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 class Image;
+class IsosurfaceBlockRanges;
+class SegLabelIndex;
 
+/**
+ * @brief Generate the mesh of an isosurface asynchronously with marching cubes. The record also holds
+ * simplified levels of detail of the mesh.
+ *
+ * @param image Image whose component is meshed. It is copied, so it may change while the task runs.
+ * @param imageUid UID of the image
+ * @param component Image component
+ * @param timePoint Time point of the image to mesh
+ * @param isoValue Isovalue of the surface
+ * @param isosurfaceUid UID of the isosurface
+ * @param blockRanges Block ranges of the component at the time point, or null to compute them
+ * @param blockRangesUpdater Called with the block ranges when the task had to compute them,
+ * so that later tasks of the same component and time point can reuse them
+ * @param meshCpuRecordUpdater Called with the generated mesh record, or with null if generation failed
+ * @param addTaskToIsosurfaceGpuMeshGenerationQueue Called once the task is done, so that its future is collected
+ */
 std::future<AsyncTaskDetails> generateIsosurfaceMeshCpuRecord(
   const Image& image,
   const uuids::uuid& imageUid,
   uint32_t component,
+  uint32_t timePoint,
   double isoValue,
   const uuids::uuid& isosurfaceUid,
+  std::shared_ptr<const IsosurfaceBlockRanges> blockRanges,
+  std::function<void(std::shared_ptr<const IsosurfaceBlockRanges>)> blockRangesUpdater,
   std::function<bool(const uuids::uuid& isosurfaceUid, std::unique_ptr<MeshCpuRecord>)> meshCpuRecordUpdater,
   std::function<void()> addTaskToIsosurfaceGpuMeshGenerationQueue);
 
+/**
+ * @brief Generate the surface meshes of segmentation labels in one pass with surface nets.
+ * @see generateLabelSurfaceMeshes for the parameters.
+ * @param withLevelsOfDetail Also simplify each mesh into levels of detail, which keep the vertices that are
+ * shared with adjacent labels
+ * @return Mesh records keyed by label. Labels without voxels have no record.
+ */
+std::map<uint32_t, std::unique_ptr<MeshCpuRecord>> generateLabelMeshCpuRecords(
+  const Image& seg,
+  const std::vector<uint32_t>& labels,
+  const SurfaceNetsSettings& settings = {},
+  const SegLabelIndex* labelIndex = nullptr,
+  bool withLevelsOfDetail = true);
+
 /// @todo Put this function here
 // std::map< int64_t, double >
 // generateImageHistogramAtLabelValues(
 //         vtkImageData* imageData,
 //         const std::unordered_set<int64_t>& labelValues );
 
-bool writeMeshToFile(const MeshCpuRecord&, const std::string& fileName);
+/**
+ * @brief Write a mesh to a file. The format follows the file extension (case insensitive):
+ * binary PLY with vertex normals (.ply), binary STL (.stl) or Wavefront OBJ with vertex normals (.obj).
+ *
+ * @param fidelity Fraction of the triangles of the full mesh to keep at least, from 0 to 1. The coarsest
+ * level of detail of the record with enough triangles is written, so the default writes the full mesh.
+ * @return True iff the mesh was written.
+ */
+bool writeMeshToFile(const MeshCpuRecord&, const std::string& fileName, float fidelity = 1.0f);
@@ -0,0 +1,513 @@
+#include "mesh/SurfaceNets.h"
+
+#include "common/Parallel.h"
+#include "image/Image.h"
+#include "image/SegLabelIndex.h"
+
+#include <glm/glm.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <map>
+#include <utility>
+
+namespace
+{
+
+constexpr uint32_t sk_comp = 0;
+constexpr uint32_t sk_timePoint = 0;
+constexpr uint32_t sk_noVertex = std::numeric_limits<uint32_t>::max();
+
+using Quad = std::array<uint32_t, 4>;
+using LabelQuads = std::map<uint32_t, std::vector<Quad>>;
+
+/// Labels whose surfaces are extracted
+class LabelSelection
+{
+public:
+  explicit LabelSelection(std::vector<uint32_t> labels)
+    : m_labels(std::move(labels))
+  {
+    std::ranges::sort(m_labels);
+  }
+
+  bool contains(uint32_t label) const
+  {
+    return m_labels.empty() ? (0 != label) : std::ranges::binary_search(m_labels, label);
+  }
+
+private:
+  std::vector<uint32_t> m_labels; //!< Sorted labels, or empty to select all non-zero labels
+};
+
+/**
+ * @brief Vertices of the surface net. Cell c has voxels c to c + 1 as its corners, so the cells of a
+ * region of voxels span from one voxel before the region to its last voxel. Vertices are stored row by
+ * row of cells, in increasing x order within each row.
+ */
+struct NetVertices
+{
+  glm::ivec3 cellMin{0};
+  glm::ivec3 cellMax{0}; //!< Inclusive
+
+  std::vector<std::size_t> rowOffsets; //!< Vertices of row r are [rowOffsets[r], rowOffsets[r + 1])
+  std::vector<glm::ivec3> cells;
+  std::vector<glm::vec3> positions;    //!< Positions in Pixel space
+  std::vector<uint8_t> junctions;      //!< Non-zero where three or more labels meet
+  std::vector<uint8_t> interfaces;     //!< Non-zero where two or more non-zero labels meet
+
+  std::size_t row(int j, int k) const
+  {
+    return static_cast<std::size_t>(k - cellMin.z) * static_cast<std::size_t>(cellMax.y - cellMin.y + 1) +
+           static_cast<std::size_t>(j - cellMin.y);
+  }
+
+  uint32_t find(int i, int j, int k) const
+  {
+    if (j < cellMin.y || j > cellMax.y || k < cellMin.z || k > cellMax.z) {
+      return sk_noVertex;
+    }
+
+    const std::size_t r = row(j, k);
+    const auto first = cells.begin() + static_cast<std::ptrdiff_t>(rowOffsets[r]);
+    const auto last = cells.begin() + static_cast<std::ptrdiff_t>(rowOffsets[r + 1]);
+    const auto it = std::lower_bound(first, last, i, [](const glm::ivec3& cell, int x) { return cell.x < x; });
+
+    return (it != last && it->x == i) ? static_cast<uint32_t>(it - cells.begin()) : sk_noVertex;
+  }
+};
+
+/// Number of distinct labels among the corners of a cell, optionally ignoring background
+int countDistinctLabels(const std::array<uint32_t, 8>& corners, bool ignoreBackground = false)
+{
+  int count = 0;
+  for (std::size_t n = 0; n < corners.size(); ++n) {
+    if (ignoreBackground && 0 == corners[n]) {
+      continue;
+    }
+    if (std::find(corners.begin(), corners.begin() + static_cast<std::ptrdiff_t>(n), corners[n]) ==
+        corners.begin() + static_cast<std::ptrdiff_t>(n))
+    {
+      ++count;
+    }
+  }
+  return count;
+}
+
+/// Place a vertex at the center of every cell with more than one label, including a selected one
+template<typename LabelAt>
+void createVertices(
+  const LabelAt& labelAt,
+  const LabelSelection& selection,
+  unsigned int numThreads,
+  NetVertices& net)
+{
+  const std::size_t numRows = net.row(net.cellMax.y, net.cellMax.z) + 1;
+  std::vector<std::size_t> rowCounts(numRows, 0);
+  std::vector<NetVertices> slabs(numThreads);
+
+  parallel::forEachSlab(numThreads, net.cellMin.z, net.cellMax.z + 1, [&](unsigned int t, int kBegin, int kEnd) {
+    NetVertices& slab = slabs[t];
+
+    for (int k = kBegin; k < kEnd; ++k) {
+      for (int j = net.cellMin.y; j <= net.cellMax.y; ++j) {
+        const std::size_t start = slab.cells.size();
+
+        // Labels of the four voxels of the cell corners at x = i, which slide along the row
+        auto column = [&](int i) {
+          return std::array<uint32_t, 4>{
+            labelAt(i, j, k), labelAt(i, j + 1, k), labelAt(i, j, k + 1), labelAt(i, j + 1, k + 1)};
+        };
+
+        std::array<uint32_t, 4> left = column(net.cellMin.x);
+
+        for (int i = net.cellMin.x; i <= net.cellMax.x; ++i) {
+          const std::array<uint32_t, 4> right = column(i + 1);
+          const std::array<uint32_t, 8> corners{
+            left[0], left[1], left[2], left[3], right[0], right[1], right[2], right[3]};
+          left = right;
+
+          const bool mixed = std::ranges::any_of(corners, [&corners](uint32_t l) { return l != corners[0]; });
+          if (!mixed || !std::ranges::any_of(corners, [&selection](uint32_t l) { return selection.contains(l); })) {
+            continue;
+          }
+
+          slab.cells.emplace_back(i, j, k);
+          slab.positions.push_back(glm::vec3{i, j, k} + 0.5f);
+          slab.junctions.push_back(countDistinctLabels(corners) >= 3 ? 1 : 0);
+          slab.interfaces.push_back(countDistinctLabels(corners, true) >= 2 ? 1 : 0);
+        }
+
+        rowCounts[net.row(j, k)] = slab.cells.size() - start;
+      }
+    }
+  });
+
+  // Slabs hold consecutive rows, so concatenating them keeps the vertices in row order
+  net.rowOffsets.assign(numRows + 1, 0);
+  for (std::size_t r = 0; r < numRows; ++r) {
+    net.rowOffsets[r + 1] = net.rowOffsets[r] + rowCounts[r];
+  }
+
+  net.cells.reserve(net.rowOffsets.back());
+  net.positions.reserve(net.rowOffsets.back());
+  net.junctions.reserve(net.rowOffsets.back());
+  net.interfaces.reserve(net.rowOffsets.back());
+
+  for (const NetVertices& slab : slabs) {
+    net.cells.insert(net.cells.end(), slab.cells.begin(), slab.cells.end());
+    net.positions.insert(net.positions.end(), slab.positions.begin(), slab.positions.end());
+    net.junctions.insert(net.junctions.end(), slab.junctions.begin(), slab.junctions.end());
+    net.interfaces.insert(net.interfaces.end(), slab.interfaces.begin(), slab.interfaces.end());
+  }
+}
+
+/**
+ * @brief Make a quad for every pair of neighboring voxels with different labels, from the vertices of the
+ * four cells around the edge between the voxels. The quad faces from the first voxel to the second in the
+ * mesh of the first voxel's label, and the other way in the mesh of the second voxel's label.
+ */
+template<typename LabelAt>
+std::vector<LabelQuads> createQuads(
+  const LabelAt& labelAt,
+  const LabelSelection& selection,
+  unsigned int numThreads,
+  const NetVertices& net)
+{
+  std::vector<LabelQuads> slabQuads(numThreads);
+
+  // Voxels of the region are those of the cells, excluding the first ones
+  const glm::ivec3 voxelMin = net.cellMin + 1;
+  const glm::ivec3 voxelMax = net.cellMax;
+
+  parallel::forEachSlab(numThreads, net.cellMin.z, net.cellMax.z + 1, [&](unsigned int t, int kBegin, int kEnd) {
+    LabelQuads& quads = slabQuads[t];
+
+    auto addQuad = [&](uint32_t label, uint32_t otherLabel, const std::array<glm::ivec3, 4>& cells) {
+      const bool first = selection.contains(label);
+      const bool second = selection.contains(otherLabel);
+      if (!first && !second) {
+        return;
+      }
+
+      Quad quad;
+      for (std::size_t n = 0; n < 4; ++n) {
+        quad[n] = net.find(cells[n].x, cells[n].y, cells[n].z);
+        if (sk_noVertex == quad[n]) {
+          return;
+        }
+      }
+
+      if (first) {
+        quads[label].push_back(quad);
+      }
+      if (second) {
+        quads[otherLabel].push_back(Quad{quad[3], quad[2], quad[1], quad[0]});
+      }
+    };
+
+    for (int k = kBegin; k < kEnd; ++k) {
+      for (int j = net.cellMin.y; j <= net.cellMax.y; ++j) {
+        for (int i = net.cellMin.x; i <= net.cellMax.x; ++i) {
+          const uint32_t label = labelAt(i, j, k);
+          const bool inY = (voxelMin.y <= j && j <= voxelMax.y);
+          const bool inZ = (voxelMin.z <= k && k <= voxelMax.z);
+          const bool inX = (voxelMin.x <= i && i <= voxelMax.x);
+
+          if (inY && inZ) {
+            const uint32_t next = labelAt(i + 1, j, k);
+            if (next != label) {
+              addQuad(label, next, {glm::ivec3{i, j - 1, k - 1}, {i, j, k - 1}, {i, j, k}, {i, j - 1, k}});
+            }
+          }
+          if (inZ && inX) {
+            const uint32_t next = labelAt(i, j + 1, k);
+            if (next != label) {
+              addQuad(label, next, {glm::ivec3{i - 1, j, k - 1}, {i - 1, j, k}, {i, j, k}, {i, j, k - 1}});
+            }
+          }
+          if (inX && inY) {
+            const uint32_t next = labelAt(i, j, k + 1);
+            if (next != label) {
+              addQuad(label, next, {glm::ivec3{i - 1, j - 1, k}, {i, j - 1, k}, {i, j, k}, {i - 1, j, k}});
+            }
+          }
+        }
+      }
+    }
+  });
+
+  return slabQuads;
+}
+
+/**
+ * @brief Find the neighbors of each vertex: the vertices of the six face-adjacent cells, where the face
+ * between the cells is crossed by the surface (its four voxels do not all have the same label).
+ * Junction vertices only neighbor other junction vertices.
+ */
+template<typename LabelAt>
+std::vector<std::array<uint32_t, 6>>
+findNeighbors(const LabelAt& labelAt, unsigned int numThreads, const NetVertices& net)
+{
+  std::vector<std::array<uint32_t, 6>> neighbors(net.cells.size());
+
+  parallel::forEachSlab(numThreads, 0, static_cast<int>(net.cells.size()), [&](unsigned int, int vBegin, int vEnd) {
+    for (int v = vBegin; v < vEnd; ++v) {
+      const glm::ivec3& c = net.cells[static_cast<std::size_t>(v)];
+      std::array<uint32_t, 6>& adjacent = neighbors[static_cast<std::size_t>(v)];
+      adjacent.fill(sk_noVertex);
+
+      for (int axis = 0; axis < 3; ++axis) {
+        for (int side = 0; side < 2; ++side) {
+          glm::ivec3 other = c;
+          other[axis] += (0 == side) ? -1 : 1;
+
+          const uint32_t n = net.find(other.x, other.y, other.z);
+          if (sk_noVertex == n || (net.junctions[static_cast<std::size_t>(v)] && !net.junctions[n])) {
+            continue;
+          }
+
+          // Voxels of the shared face, which lie in the plane of the corners of both cells
+          glm::ivec3 p = c;
+          p[axis] += side;
+          const int a1 = (axis + 1) % 3;
+          const int a2 = (axis + 2) % 3;
+
+          std::array<uint32_t, 4> face;
+          for (int n2 = 0; n2 < 4; ++n2) {
+            glm::ivec3 q = p;
+            q[a1] += (n2 & 1);
+            q[a2] += (n2 >> 1);
+            face[static_cast<std::size_t>(n2)] = labelAt(q.x, q.y, q.z);
+          }
+
+          if (std::ranges::any_of(face, [&face](uint32_t l) { return l != face[0]; })) {
+            adjacent[static_cast<std::size_t>(2 * axis + side)] = n;
+          }
+        }
+      }
+    }
+  });
+
+  return neighbors;
+}
+
+/// Relax every vertex towards the average of its neighbors, keeping it inside of its cell
+void smoothVertices(
+  const std::vector<std::array<uint32_t, 6>>& neighbors,
+  const SurfaceNetsSettings& settings,
+  unsigned int numThreads,
+  NetVertices& net)
+{
+  std::vector<glm::vec3> smoothed(net.positions.size());
+  const int numVertices = static_cast<int>(net.positions.size());
+
+  for (uint32_t iter = 0; iter < settings.smoothingIterations; ++iter) {
+    parallel::forEachSlab(numThreads, 0, numVertices, [&](unsigned int, int vBegin, int vEnd) {
+      for (int v = vBegin; v < vEnd; ++v) {
+        const std::size_t vi = static_cast<std::size_t>(v);
+        glm::vec3 sum{0.0f};
+        int count = 0;
+
+        for (const uint32_t n : neighbors[vi]) {
+          if (sk_noVertex != n) {
+            sum += net.positions[n];
+            ++count;
+          }
+        }
+
+        const glm::vec3& p = net.positions[vi];
+        if (0 == count) {
+          smoothed[vi] = p;
+          continue;
+        }
+
+        const glm::vec3 cell{net.cells[vi]};
+        const glm::vec3 relaxed = p + settings.smoothingRelaxation * (sum / static_cast<float>(count) - p);
+        smoothed[vi] = glm::clamp(relaxed, cell, cell + 1.0f);
+      }
+    });
+
+    std::swap(net.positions, smoothed);
+  }
+}
+
+/// Build the mesh of one label from its quads in Subject space
+LabelSurfaceMesh buildLabelMesh(
+  uint32_t label,
+  const std::vector<const std::vector<Quad>*>& quadLists,
+  const NetVertices& net,
+  const glm::mat4& subject_T_pixel,
+  std::vector<uint32_t>& localIndices)
+{
+  // Reverse the triangles if the transformation to Subject space flips orientation
+  const bool flip = (glm::determinant(glm::mat3{subject_T_pixel}) < 0.0f);
+
+  LabelSurfaceMesh mesh;
+  mesh.label = label;
+
+  std::vector<uint32_t> touched;
+
+  auto localIndex = [&](uint32_t v) {
+    if (sk_noVertex == localIndices[v]) {
+      localIndices[v] = static_cast<uint32_t>(mesh.positions.size());
+      touched.push_back(v);
+
+      const glm::vec4 p = subject_T_pixel * glm::vec4{net.positions[v], 1.0f};
+      mesh.positions.emplace_back(p / p.w);
+      mesh.interfaces.push_back(net.interfaces[v]);
+    }
+    return localIndices[v];
+  };
+
+  auto addTriangle = [&](uint32_t a, uint32_t b, uint32_t c) {
+    mesh.indices.insert(mesh.indices.end(), {a, flip ? c : b, flip ? b : c});
+  };
+
+  for (const std::vector<Quad>* quads : quadLists) {
+    for (const Quad& quad : *quads) {
+      const std::array<uint32_t, 4> q{
+        localIndex(quad[0]), localIndex(quad[1]), localIndex(quad[2]), localIndex(quad[3])};
+
+      // Split along the shorter diagonal
+      const glm::vec3 d02 = mesh.positions[q[2]] - mesh.positions[q[0]];
+      const glm::vec3 d13 = mesh.positions[q[3]] - mesh.positions[q[1]];
+
+      if (glm::dot(d02, d02) <= glm::dot(d13, d13)) {
+        addTriangle(q[0], q[1], q[2]);
+        addTriangle(q[0], q[2], q[3]);
+      }
+      else {
+        addTriangle(q[0], q[1], q[3]);
+        addTriangle(q[1], q[2], q[3]);
+      }
+    }
+  }
+
+  for (const uint32_t v : touched) {
+    localIndices[v] = sk_noVertex;
+  }
+
+  // Area-weighted vertex normals
+  mesh.normals.assign(mesh.positions.size(), glm::vec3{0.0f});
+  for (std::size_t n = 0; n + 2 < mesh.indices.size(); n += 3) {
+    const uint32_t a = mesh.indices[n];
+    const uint32_t b = mesh.indices[n + 1];
+    const uint32_t c = mesh.indices[n + 2];
+    const glm::vec3 normal = glm::cross(mesh.positions[b] - mesh.positions[a], mesh.positions[c] - mesh.positions[a]);
+    mesh.normals[a] += normal;
+    mesh.normals[b] += normal;
+    mesh.normals[c] += normal;
+  }
+
+  for (glm::vec3& normal : mesh.normals) {
+    const float length = glm::length(normal);
+    normal = (length > 0.0f) ? normal / length : glm::vec3{0.0f};
+  }
+
+  return mesh;
+}
+
+} // namespace
+
+std::optional<std::vector<LabelSurfaceMesh>> generateLabelSurfaceMeshes(
+  const Image& seg,
+  const std::vector<uint32_t>& labels,
+  const SurfaceNetsSettings& settings,
+  const SegLabelIndex* labelIndex)
+{
+  const glm::ivec3 dims{seg.header().pixelDimensions()};
+  const unsigned int numThreads = std::max(settings.numThreads, 1u);
+
+  std::vector<uint32_t> selectedLabels = labels;
+  glm::ivec3 voxelMin{0};
+  glm::ivec3 voxelMax = dims - 1;
+
+  // Limit the extraction to the bounding box of the selected labels:
+  if (labelIndex && labelIndex->dimensions() == glm::uvec3{dims}) {
+    if (selectedLabels.empty()) {
+      for (const uint32_t label : labelIndex->labels()) {
+        if (0 != label) {
+          selectedLabels.push_back(label);
+        }
+      }
+    }
+
+    voxelMin = glm::ivec3{std::numeric_limits<int>::max()};
+    voxelMax = glm::ivec3{std::numeric_limits<int>::lowest()};
+
+    for (const uint32_t label : selectedLabels) {
+      if (const SegLabelStats* stats = labelIndex->stats(label)) {
+        voxelMin = glm::min(voxelMin, glm::ivec3{stats->minVoxel});
+        voxelMax = glm::max(voxelMax, glm::ivec3{stats->maxVoxel});
+      }
+    }
+
+    if (glm::any(glm::lessThan(voxelMax, voxelMin))) {
+      return std::vector<LabelSurfaceMesh>{};
+    }
+  }
+
+  const LabelSelection selection(selectedLabels);
+
+  NetVertices net;
+  net.cellMin = voxelMin - 1;
+  net.cellMax = voxelMax;
+
+  std::vector<LabelQuads> slabQuads;
+
+  const bool extracted = seg.visitComponentView(sk_comp, sk_timePoint, [&](const auto& view) {
+    // Voxels outside of the image are background
+    auto labelAt = [&view](int i, int j, int k) -> uint32_t {
+      return view.contains(i, j, k) ? static_cast<uint32_t>(view.at(
+                                        static_cast<std::size_t>(i),
+                                        static_cast<std::size_t>(j),
+                                        static_cast<std::size_t>(k)))
+                                    : 0u;
+    };
+
+    createVertices(labelAt, selection, numThreads, net);
+    slabQuads = createQuads(labelAt, selection, numThreads, net);
+
+    if (settings.smoothingIterations > 0) {
+      smoothVertices(findNeighbors(labelAt, numThreads, net), settings, numThreads, net);
+    }
+  });
+
+  if (!extracted) {
+    spdlog::error("Unable to extract label surfaces of segmentation {}", seg.settings().displayName());
+    return std::nullopt;
+  }
+
+  // Quads of each label, in slab order
+  std::map<uint32_t, std::vector<const std::vector<Quad>*>> labelQuads;
+  for (const LabelQuads& quads : slabQuads) {
+    for (const auto& [label, list] : quads) {
+      labelQuads[label].push_back(&list);
+    }
+  }
+
+  std::vector<std::pair<uint32_t, std::vector<const std::vector<Quad>*>>> work(labelQuads.begin(), labelQuads.end());
+  std::vector<LabelSurfaceMesh> meshes(work.size());
+
+  const glm::mat4& subject_T_pixel = seg.transformations().subject_T_pixel();
+
+  parallel::forEachSlab(numThreads, 0, static_cast<int>(work.size()), [&](unsigned int, int begin, int end) {
+    std::vector<uint32_t> localIndices(net.positions.size(), sk_noVertex);
+    for (int n = begin; n < end; ++n) {
+      const auto& [label, quadLists] = work[static_cast<std::size_t>(n)];
+      meshes[static_cast<std::size_t>(n)] = buildLabelMesh(label, quadLists, net, subject_T_pixel, localIndices);
+    }
+  });
+
+  spdlog::debug(
+    "Extracted surfaces of {} labels with {} vertices from segmentation {}",
+    meshes.size(),
+    net.positions.size(),
+    seg.settings().displayName());
+
+  return meshes;
+}
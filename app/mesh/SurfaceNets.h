@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <vector>
+
+class Image;
+class SegLabelIndex;
+
+/**
+ * @brief Settings for extracting the surfaces of segmentation labels with surface nets.
+ */
+struct SurfaceNetsSettings
+{
+  /// Number of iterations of constrained smoothing of the vertices, or 0 for blocky surfaces
+  uint32_t smoothingIterations = 10;
+
+  /// Fraction of the way that each smoothing iteration moves a vertex to the average of its neighbors
+  float smoothingRelaxation = 0.5f;
+
+  /// Maximum number of threads
+  unsigned int numThreads = std::thread::hardware_concurrency();
+};
+
+/**
+ * @brief Closed triangle mesh of the surface of one segmentation label.
+ */
+struct LabelSurfaceMesh
+{
+  uint32_t label = 0;
+  std::vector<glm::vec3> positions; //!< Vertex positions in Subject space
+  std::vector<glm::vec3> normals;   //!< Unit vertex normals in Subject space, pointing out of the label
+  std::vector<uint32_t> indices;    //!< Triangle vertex indices, counter-clockwise when viewed from outside
+
+  /// Non-zero for vertices next to voxels of another non-zero label, whose surface may share the vertex
+  std::vector<uint8_t> interfaces;
+};
+
+/**
+ * @brief Extract the surfaces of segmentation labels in one parallel pass with multi-label surface nets.
+ *
+ * One vertex is placed in every cell of 2x2x2 voxels that contains more than one label, and one quad is
+ * made for every pair of neighboring voxels with different labels. The quad is added to the meshes of both
+ * labels with opposite orientations, so neighboring labels share their boundary vertices exactly and every
+ * mesh is watertight. Voxels outside of the image are background (label 0). Smoothing relaxes each vertex
+ * towards its neighbors while keeping it inside of its cell; vertices where three or more labels meet are
+ * only relaxed along the junction, so label boundaries do not drift.
+ *
+ * @param seg Segmentation image. Component 0 of time point 0 is meshed.
+ * @param labels Labels to mesh, or empty to mesh all non-zero labels.
+ * @param settings Extraction settings.
+ * @param labelIndex Optional index of the segmentation, whose label bounding boxes limit the extraction to
+ * the region around the requested labels.
+ * @return Meshes of the requested labels that have voxels, in ascending label order, or std::nullopt if the
+ * segmentation has no readable component.
+ */
+std::optional<std::vector<LabelSurfaceMesh>> generateLabelSurfaceMeshes(
+  const Image& seg,
+  const std::vector<uint32_t>& labels,
+  const SurfaceNetsSettings& settings = {},
+  const SegLabelIndex* labelIndex = nullptr);
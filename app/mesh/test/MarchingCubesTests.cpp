@@ -0,0 +1,148 @@
+#include "mesh/MarchingCubes.h"
+
+#include "image/Image.h"
+
+#include "ImageFixtures.h"
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <numbers>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+/// Volume enclosed by a mesh, which is negative if the mesh is inside-out
+double signedVolume(const IsosurfaceMesh& mesh)
+{
+  double volume = 0.0;
+  for (std::size_t n = 0; n + 2 < mesh.indices.size(); n += 3) {
+    const glm::vec3& a = mesh.positions[mesh.indices[n]];
+    const glm::vec3& b = mesh.positions[mesh.indices[n + 1]];
+    const glm::vec3& c = mesh.positions[mesh.indices[n + 2]];
+    volume += static_cast<double>(glm::dot(a, glm::cross(b, c))) / 6.0;
+  }
+  return volume;
+}
+
+/// A mesh is a closed, consistently oriented manifold if every edge is traversed once in each direction
+bool isClosedManifold(const IsosurfaceMesh& mesh)
+{
+  std::map<std::pair<uint32_t, uint32_t>, int> edges;
+  for (std::size_t n = 0; n + 2 < mesh.indices.size(); n += 3) {
+    for (std::size_t e = 0; e < 3; ++e) {
+      ++edges[std::pair(mesh.indices[n + e], mesh.indices[n + (e + 1) % 3])];
+    }
+  }
+
+  for (const auto& [edge, count] : edges) {
+    const auto reverse = edges.find(std::pair(edge.second, edge.first));
+    if (1 != count || reverse == edges.end() || 1 != reverse->second) {
+      return false;
+    }
+  }
+  return !edges.empty();
+}
+
+/// Every vertex is used by a triangle
+bool allVerticesUsed(const IsosurfaceMesh& mesh)
+{
+  std::vector<bool> used(mesh.positions.size(), false);
+  for (const uint32_t index : mesh.indices) {
+    used[index] = true;
+  }
+  return std::find(used.begin(), used.end(), false) == used.end();
+}
+
+} // namespace
+
+TEST_CASE("Isosurface of a ball is closed and encloses its volume", "[mesh]")
+{
+  const glm::vec3 spacing{0.8f, 1.0f, 1.25f};
+  const glm::vec3 center{20.0f, 17.0f, 14.0f};
+  constexpr float radius = 11.0f;
+
+  // Signed distance from the sphere in Subject space, which is positive inside
+  const Image image =
+    image_fixtures::makeScalarImage<float>({41, 35, 29}, glm::dvec3{spacing}, [&](const glm::vec3& p) {
+      return radius - glm::length(spacing * p - center);
+    });
+
+  const auto mesh = generateIsosurfaceMesh(image, 0, 0.0);
+  REQUIRE(mesh.has_value());
+  REQUIRE(mesh->normals.size() == mesh->positions.size());
+
+  CHECK(isClosedManifold(*mesh));
+  CHECK(allVerticesUsed(*mesh));
+  CHECK(signedVolume(*mesh) == Catch::Approx(4.0 / 3.0 * std::numbers::pi * radius * radius * radius).epsilon(0.01));
+
+  for (std::size_t v = 0; v < mesh->positions.size(); ++v) {
+    CHECK(std::abs(glm::length(mesh->positions[v] - center) - radius) < 0.1f);
+    CHECK(glm::dot(mesh->normals[v], glm::normalize(mesh->positions[v] - center)) > 0.95f);
+  }
+
+  // No surface outside of the value range
+  const auto empty = generateIsosurfaceMesh(image, 0, 1000.0);
+  REQUIRE(empty.has_value());
+  CHECK(empty->positions.empty());
+  CHECK(empty->indices.empty());
+
+  CHECK_FALSE(generateIsosurfaceMesh(image, 1, 0.0).has_value());
+}
+
+TEST_CASE("Isosurfaces of random binary volumes are closed manifolds", "[mesh]")
+{
+  std::mt19937 generator(17);
+  std::bernoulli_distribution coin(0.5);
+  const glm::uvec3 dims{37, 20, 19};
+
+  // Random voxels exercise every case, including ambiguous faces, and a background border closes the surface
+  const Image image = image_fixtures::makeScalarImage<float>(dims, {1.0, 1.0, 1.0}, [&](const glm::vec3& p) {
+    const bool border = glm::any(glm::equal(p, glm::vec3{0.0f})) || glm::any(glm::equal(p, glm::vec3{dims - 1u}));
+    return (!border && coin(generator)) ? 1.0f : 0.0f;
+  });
+
+  const auto mesh = generateIsosurfaceMesh(image, 0, 0.5);
+  REQUIRE(mesh.has_value());
+  CHECK(isClosedManifold(*mesh));
+  CHECK(allVerticesUsed(*mesh));
+  CHECK(signedVolume(*mesh) > 0.0);
+}
+
+TEST_CASE("Isosurface extraction skips blocks and does not depend on threads", "[mesh]")
+{
+  const glm::vec3 center{50.0f, 12.0f, 40.0f};
+  const Image image = image_fixtures::makeScalarImage<float>({70, 60, 50}, {1.0, 1.0, 1.0}, [&](const glm::vec3& p) {
+    return 6.0f - glm::length(p - center);
+  });
+
+  const auto ranges = IsosurfaceBlockRanges::build(image, 0);
+  REQUIRE(ranges.has_value());
+  CHECK(ranges->blockCounts() == glm::uvec3(5, 4, 4));
+  CHECK(ranges->numActiveBlocks(0.0) > 0);
+  CHECK(ranges->numActiveBlocks(0.0) <= 8);
+  CHECK(ranges->numActiveBlocks(100.0) == 0);
+
+  IsosurfaceSettings settings;
+  settings.numThreads = 1;
+  const auto reference = generateIsosurfaceMesh(image, 0, 0.0, settings);
+  REQUIRE(reference.has_value());
+  CHECK(isClosedManifold(*reference));
+
+  for (unsigned int numThreads : {2u, 7u, 64u}) {
+    settings.numThreads = numThreads;
+    const auto mesh = generateIsosurfaceMesh(image, 0, 0.0, settings, &(*ranges));
+    REQUIRE(mesh.has_value());
+    CHECK(mesh->positions == reference->positions);
+    CHECK(mesh->indices == reference->indices);
+  }
+}
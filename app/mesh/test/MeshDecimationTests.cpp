@@ -0,0 +1,219 @@
+#include "mesh/MeshDecimation.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+struct TestMesh
+{
+  std::vector<glm::vec3> positions;
+  std::vector<uint32_t> indices;
+};
+
+/// Sphere made by subdividing an icosahedron, with outward-facing triangles
+TestMesh makeIcosphere(float radius, int subdivisions)
+{
+  const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+
+  TestMesh mesh;
+  mesh.positions = {
+    {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0}, {0, -1, t}, {0, 1, t},
+    {0, -1, -t}, {0, 1, -t}, {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+  mesh.indices = {0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11, 1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+                  3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9, 4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1};
+
+  for (int s = 0; s < subdivisions; ++s) {
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> midpoints;
+    auto midpoint = [&mesh, &midpoints](uint32_t a, uint32_t b) {
+      const uint32_t next = static_cast<uint32_t>(mesh.positions.size());
+      const auto [it, inserted] = midpoints.try_emplace(std::minmax(a, b), next);
+      if (inserted) {
+        mesh.positions.push_back(0.5f * (mesh.positions[a] + mesh.positions[b]));
+      }
+      return it->second;
+    };
+
+    std::vector<uint32_t> indices;
+    for (std::size_t n = 0; n < mesh.indices.size(); n += 3) {
+      const uint32_t a = mesh.indices[n];
+      const uint32_t b = mesh.indices[n + 1];
+      const uint32_t c = mesh.indices[n + 2];
+      const uint32_t ab = midpoint(a, b);
+      const uint32_t bc = midpoint(b, c);
+      const uint32_t ca = midpoint(c, a);
+      indices.insert(indices.end(), {a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca});
+    }
+    mesh.indices = std::move(indices);
+  }
+
+  for (glm::vec3& p : mesh.positions) {
+    p = radius * glm::normalize(p);
+  }
+  return mesh;
+}
+
+/// Square grid of n x n cells in the z = 0 plane, with a bump in the middle
+TestMesh makeBumpyGrid(int n)
+{
+  TestMesh mesh;
+  for (int j = 0; j <= n; ++j) {
+    for (int i = 0; i <= n; ++i) {
+      const float x = static_cast<float>(i) / static_cast<float>(n) - 0.5f;
+      const float y = static_cast<float>(j) / static_cast<float>(n) - 0.5f;
+      mesh.positions.emplace_back(x, y, 0.2f * std::exp(-20.0f * (x * x + y * y)));
+    }
+  }
+
+  for (int j = 0; j < n; ++j) {
+    for (int i = 0; i < n; ++i) {
+      const uint32_t v = static_cast<uint32_t>(j * (n + 1) + i);
+      const uint32_t row = static_cast<uint32_t>(n + 1);
+      mesh.indices.insert(mesh.indices.end(), {v, v + 1, v + row + 1, v, v + row + 1, v + row});
+    }
+  }
+  return mesh;
+}
+
+/// A mesh is a closed, consistently oriented manifold if every edge is traversed once in each direction
+bool isClosedManifold(const std::vector<uint32_t>& indices)
+{
+  std::map<std::pair<uint32_t, uint32_t>, int> edges;
+  for (std::size_t n = 0; n + 2 < indices.size(); n += 3) {
+    for (std::size_t e = 0; e < 3; ++e) {
+      ++edges[std::pair(indices[n + e], indices[n + (e + 1) % 3])];
+    }
+  }
+
+  for (const auto& [edge, count] : edges) {
+    const auto reverse = edges.find(std::pair(edge.second, edge.first));
+    if (1 != count || reverse == edges.end() || 1 != reverse->second) {
+      return false;
+    }
+  }
+  return !edges.empty();
+}
+
+bool containsPosition(const std::vector<glm::vec3>& positions, const glm::vec3& p)
+{
+  return std::find(positions.begin(), positions.end(), p) != positions.end();
+}
+
+} // namespace
+
+TEST_CASE("Decimated spheres stay closed and close to the original surface", "[mesh][decimation]")
+{
+  constexpr float radius = 10.0f;
+  const TestMesh sphere = makeIcosphere(radius, 5);
+  const std::size_t numTriangles = sphere.indices.size() / 3;
+  REQUIRE(numTriangles == 20480);
+
+  // Large enough to be split into slabs for each thread
+  for (unsigned int numThreads : {1u, 4u}) {
+    MeshDecimationSettings settings;
+    settings.triangleRatio = 0.1f;
+    settings.numThreads = numThreads;
+
+    const auto decimated = decimateMesh(sphere.positions, sphere.indices, {}, settings);
+    REQUIRE(decimated.has_value());
+
+    const std::size_t numDecimated = decimated->indices.size() / 3;
+    CHECK(numDecimated <= numTriangles / 10 + 2);
+    CHECK(numDecimated >= numTriangles / 20);
+    CHECK(isClosedManifold(decimated->indices));
+    CHECK(decimated->normals.size() == decimated->positions.size());
+
+    CHECK(decimated->error > 0.0f);
+    CHECK(decimated->error < 0.1f * radius);
+
+    for (std::size_t v = 0; v < decimated->positions.size(); ++v) {
+      const glm::vec3& p = decimated->positions[v];
+      CHECK(std::abs(glm::length(p) - radius) <= decimated->error + 1.0e-3f);
+      CHECK(glm::dot(decimated->normals[v], glm::normalize(p)) > 0.9f);
+    }
+  }
+
+  // The error limit stops decimation early
+  MeshDecimationSettings limited;
+  limited.triangleRatio = 0.0f;
+  limited.maxError = 0.01f;
+  const auto accurate = decimateMesh(sphere.positions, sphere.indices, {}, limited);
+  REQUIRE(accurate.has_value());
+  CHECK(accurate->error <= 0.01f);
+  CHECK(accurate->indices.size() / 3 > numTriangles / 10);
+
+  CHECK_FALSE(decimateMesh(sphere.positions, {0, 1}, {}).has_value());
+  CHECK_FALSE(decimateMesh(sphere.positions, sphere.indices, {1, 0, 1}).has_value());
+}
+
+TEST_CASE("Decimation keeps boundaries and locked vertices", "[mesh][decimation]")
+{
+  const TestMesh grid = makeBumpyGrid(40);
+  const uint32_t row = 41;
+
+  // Lock a line of vertices through the bump, as if it were shared with another mesh
+  std::vector<uint8_t> locked(grid.positions.size(), 0);
+  for (uint32_t i = 0; i < row; ++i) {
+    locked[20 * row + i] = 1;
+  }
+
+  MeshDecimationSettings settings;
+  settings.triangleRatio = 0.05f;
+  const auto decimated = decimateMesh(grid.positions, grid.indices, locked, settings);
+  REQUIRE(decimated.has_value());
+  CHECK(decimated->indices.size() < grid.indices.size() / 4);
+
+  for (uint32_t n = 0; n < row; ++n) {
+    CHECK(containsPosition(decimated->positions, grid.positions[n]));
+    CHECK(containsPosition(decimated->positions, grid.positions[40 * row + n]));
+    CHECK(containsPosition(decimated->positions, grid.positions[n * row]));
+    CHECK(containsPosition(decimated->positions, grid.positions[n * row + 40]));
+    CHECK(containsPosition(decimated->positions, grid.positions[20 * row + n]));
+  }
+
+  // Triangles keep facing up
+  for (std::size_t n = 0; n < decimated->indices.size(); n += 3) {
+    const glm::vec3& a = decimated->positions[decimated->indices[n]];
+    const glm::vec3& b = decimated->positions[decimated->indices[n + 1]];
+    const glm::vec3& c = decimated->positions[decimated->indices[n + 2]];
+    CHECK(glm::cross(b - a, c - a).z > 0.0f);
+  }
+}
+
+TEST_CASE("Levels of detail are selected by screen size and fidelity", "[mesh][decimation]")
+{
+  const TestMesh sphere = makeIcosphere(5.0f, 4);
+
+  const auto levels = generateLevelsOfDetail(sphere.positions, sphere.indices, {}, {0.25f, 0.0625f});
+  REQUIRE(levels.has_value());
+  REQUIRE(levels->size() == 2);
+
+  std::vector<float> errors{0.0f};
+  std::vector<std::size_t> triangleCounts{sphere.indices.size() / 3};
+  for (const MeshLevelOfDetail& level : *levels) {
+    CHECK(isClosedManifold(level.indices));
+    CHECK(level.error > errors.back());
+    CHECK(level.indices.size() / 3 < triangleCounts.back());
+    errors.push_back(level.error);
+    triangleCounts.push_back(level.indices.size() / 3);
+  }
+
+  // Far away meshes are drawn coarsely, and close ones in full
+  CHECK(selectLevelOfDetail(errors, 0.5f / errors[2]) == 2);
+  CHECK(selectLevelOfDetail(errors, 0.5f * (1.0f / errors[1] + 1.0f / errors[2])) == 1);
+  CHECK(selectLevelOfDetail(errors, 2.0f / errors[1]) == 0);
+  CHECK(selectLevelOfDetail({0.0f}, 1.0f) == 0);
+
+  CHECK(selectLevelOfDetailForFidelity(triangleCounts, 1.0f) == 0);
+  CHECK(selectLevelOfDetailForFidelity(triangleCounts, 0.2f) == 1);
+  CHECK(selectLevelOfDetailForFidelity(triangleCounts, 0.0f) == 2);
+}
@@ -0,0 +1,189 @@
+#include "mesh/MeshLoading.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+/// Unit right triangle in the z = 0 plane, facing +z
+MeshCpuRecord makeTriangleRecord()
+{
+  return MeshCpuRecord(
+    {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}},
+    {{0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}},
+    {0, 1, 2},
+    MeshInfo(MeshSource::IsoSurface, MeshPrimitiveType::Triangles, 0.5));
+}
+
+std::string readFile(const fs::path& path)
+{
+  std::ifstream is(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+float readFloat(const std::string& bytes, std::size_t offset)
+{
+  float value = 0.0f;
+  std::memcpy(&value, bytes.data() + offset, sizeof(value));
+  return value;
+}
+
+uint32_t readUint(const std::string& bytes, std::size_t offset)
+{
+  uint32_t value = 0;
+  std::memcpy(&value, bytes.data() + offset, sizeof(value));
+  return value;
+}
+
+} // namespace
+
+TEST_CASE("Meshes are written in the format of the file extension", "[mesh][loading]")
+{
+  const fs::path directory = fs::temp_directory_path() / "entropy-mesh-loading-tests";
+  fs::remove_all(directory);
+  fs::create_directories(directory);
+
+  const MeshCpuRecord record = makeTriangleRecord();
+  REQUIRE(1 == record.numTriangles());
+  REQUIRE(0.5 == record.meshInfo().isoValue());
+
+  SECTION("Binary PLY with vertex normals")
+  {
+    const fs::path file = directory / "mesh.PLY";
+    REQUIRE(writeMeshToFile(record, file.string()));
+
+    const std::string bytes = readFile(file);
+    const std::string endHeader = "end_header\n";
+    const std::size_t dataStart = bytes.find(endHeader) + endHeader.size();
+    const std::string header = bytes.substr(0, dataStart);
+
+    CHECK(header.starts_with("ply\nformat binary_little_endian 1.0\n"));
+    CHECK(header.find("element vertex 3\n") != std::string::npos);
+    CHECK(header.find("property float nz\n") != std::string::npos);
+    CHECK(header.find("element face 1\n") != std::string::npos);
+
+    // 3 vertices of 6 floats each, then a count byte and 3 indices
+    REQUIRE(bytes.size() == dataStart + 3 * 6 * sizeof(float) + 1 + 3 * sizeof(uint32_t));
+    CHECK(1.0f == readFloat(bytes, dataStart + 6 * sizeof(float)));
+    CHECK(1.0f == readFloat(bytes, dataStart + 5 * sizeof(float)));
+
+    const std::size_t faceStart = dataStart + 3 * 6 * sizeof(float);
+    CHECK(3 == bytes[faceStart]);
+    CHECK(0 == readUint(bytes, faceStart + 1));
+    CHECK(2 == readUint(bytes, faceStart + 1 + 2 * sizeof(uint32_t)));
+  }
+
+  SECTION("Binary STL with facet normals")
+  {
+    const fs::path file = directory / "mesh.stl";
+    REQUIRE(writeMeshToFile(record, file.string()));
+
+    const std::string bytes = readFile(file);
+    REQUIRE(bytes.size() == 80 + sizeof(uint32_t) + 50);
+    CHECK(!bytes.starts_with("solid"));
+    CHECK(1 == readUint(bytes, 80));
+
+    const std::size_t facetStart = 80 + sizeof(uint32_t);
+    CHECK(0.0f == readFloat(bytes, facetStart));
+    CHECK(1.0f == readFloat(bytes, facetStart + 2 * sizeof(float)));
+    CHECK(1.0f == readFloat(bytes, facetStart + 6 * sizeof(float)));
+  }
+
+  SECTION("Wavefront OBJ with one-based indices")
+  {
+    const fs::path file = directory / "mesh.obj";
+    REQUIRE(writeMeshToFile(record, file.string()));
+
+    std::istringstream lines(readFile(file));
+    std::vector<std::string> faces;
+    int numVertices = 0;
+    int numNormals = 0;
+    for (std::string line; std::getline(lines, line);) {
+      numVertices += line.starts_with("v ") ? 1 : 0;
+      numNormals += line.starts_with("vn ") ? 1 : 0;
+      if (line.starts_with("f ")) {
+        faces.push_back(line);
+      }
+    }
+
+    CHECK(3 == numVertices);
+    CHECK(3 == numNormals);
+    REQUIRE(1 == faces.size());
+    CHECK("f 1//1 2//2 3//3" == faces.front());
+  }
+
+  SECTION("Unsupported extensions are rejected")
+  {
+    const fs::path file = directory / "mesh.vtk";
+    CHECK(!writeMeshToFile(record, file.string()));
+    CHECK(!fs::exists(file));
+  }
+
+  fs::remove_all(directory);
+}
+
+TEST_CASE("Mesh records select levels of detail by screen size and fidelity", "[mesh][loading]")
+{
+  // Unit square of two triangles, with a coarser level of one triangle
+  MeshCpuRecord record(
+    {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}, {0.0f, 1.0f, 0.0f}},
+    {},
+    {0, 1, 2, 0, 2, 3},
+    MeshInfo(MeshSource::Label, MeshPrimitiveType::Triangles, uint32_t{4}));
+
+  MeshLevelOfDetail coarse;
+  coarse.positions = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}};
+  coarse.indices = {0, 1, 2};
+  coarse.error = 0.5f;
+  record.setLevelsOfDetail({coarse});
+
+  REQUIRE(2 == record.numLevelsOfDetail());
+  CHECK(2 == record.numTriangles(0));
+  CHECK(1 == record.numTriangles(1));
+  CHECK(1 == record.numTriangles(5));
+
+  // The error of 0.5 units projects to 1 pixel at 2 pixels per unit
+  CHECK(1 == record.levelOfDetailForScreenSize(1.0f));
+  CHECK(1 == record.levelOfDetailForScreenSize(2.0f));
+  CHECK(0 == record.levelOfDetailForScreenSize(4.0f));
+
+  const fs::path directory = fs::temp_directory_path() / "entropy-mesh-lod-tests";
+  fs::remove_all(directory);
+  fs::create_directories(directory);
+
+  const fs::path file = directory / "mesh.obj";
+
+  auto countFaces = [&file]() {
+    std::istringstream lines(readFile(file));
+    int numFaces = 0;
+    for (std::string line; std::getline(lines, line);) {
+      numFaces += line.starts_with("f ") ? 1 : 0;
+    }
+    return numFaces;
+  };
+
+  // The full mesh is written by default
+  REQUIRE(writeMeshToFile(record, file.string()));
+  CHECK(2 == countFaces());
+
+  REQUIRE(writeMeshToFile(record, file.string(), 0.5f));
+  CHECK(1 == countFaces());
+
+  REQUIRE(writeMeshToFile(record, file.string(), 0.75f));
+  CHECK(2 == countFaces());
+
+  fs::remove_all(directory);
+}
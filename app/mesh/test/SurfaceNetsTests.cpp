@@ -0,0 +1,202 @@
+#include "mesh/SurfaceNets.h"
+#include "mesh/MeshLoading.h"
+
+#include "image/Image.h"
+#include "image/SegLabelIndex.h"
+
+#include "ImageFixtures.h"
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using image_fixtures::fillBox;
+using image_fixtures::makeSegmentation;
+
+/// Volume enclosed by a mesh, which is negative if the mesh is inside-out
+double signedVolume(const LabelSurfaceMesh& mesh)
+{
+  double volume = 0.0;
+  for (std::size_t n = 0; n + 2 < mesh.indices.size(); n += 3) {
+    const glm::vec3& a = mesh.positions[mesh.indices[n]];
+    const glm::vec3& b = mesh.positions[mesh.indices[n + 1]];
+    const glm::vec3& c = mesh.positions[mesh.indices[n + 2]];
+    volume += static_cast<double>(glm::dot(a, glm::cross(b, c))) / 6.0;
+  }
+  return volume;
+}
+
+/// A mesh is closed and consistently oriented if every edge is traversed equally often in both directions
+bool isClosed(const LabelSurfaceMesh& mesh)
+{
+  std::map<std::pair<uint32_t, uint32_t>, int> edges;
+  for (std::size_t n = 0; n + 2 < mesh.indices.size(); n += 3) {
+    for (std::size_t e = 0; e < 3; ++e) {
+      ++edges[std::pair(mesh.indices[n + e], mesh.indices[n + (e + 1) % 3])];
+    }
+  }
+
+  for (const auto& [edge, count] : edges) {
+    const auto reverse = edges.find(std::pair(edge.second, edge.first));
+    if (reverse == edges.end() || reverse->second != count) {
+      return false;
+    }
+  }
+  return !edges.empty();
+}
+
+} // namespace
+
+TEST_CASE("Blocky label surfaces enclose the label voxels exactly", "[mesh][segmentation]")
+{
+  Image seg = makeSegmentation({12, 9, 7}, {0.5, 1.0, 2.0});
+  fillBox(seg, {2, 2, 1}, {5, 4, 3}, 3);
+  fillBox(seg, {6, 2, 1}, {11, 8, 6}, 7); // Touches label 3 and the image boundary
+
+  SurfaceNetsSettings settings;
+  settings.smoothingIterations = 0;
+
+  const auto meshes = generateLabelSurfaceMeshes(seg, {}, settings);
+  REQUIRE(meshes.has_value());
+  REQUIRE(meshes->size() == 2);
+
+  CHECK(meshes->at(0).label == 3);
+  CHECK(isClosed(meshes->at(0)));
+  CHECK(signedVolume(meshes->at(0)) == Catch::Approx(4 * 3 * 3 * 1.0));
+
+  CHECK(meshes->at(1).label == 7);
+  CHECK(isClosed(meshes->at(1)));
+  CHECK(signedVolume(meshes->at(1)) == Catch::Approx(6 * 7 * 6 * 1.0));
+
+  // Normals point out of the label
+  const LabelSurfaceMesh& box = meshes->at(0);
+  for (std::size_t v = 0; v < box.positions.size(); ++v) {
+    CHECK(glm::dot(box.normals[v], box.positions[v] - glm::vec3{1.75f, 3.0f, 4.0f}) > 0.0f);
+  }
+}
+
+TEST_CASE("Neighboring label surfaces share their smoothed boundary", "[mesh][segmentation]")
+{
+  Image seg = makeSegmentation({16, 16, 16}, {1.0, 1.0, 1.0});
+  fillBox(seg, {3, 3, 3}, {12, 12, 12}, 1);
+  fillBox(seg, {6, 5, 4}, {9, 12, 10}, 2);
+  fillBox(seg, {2, 7, 7}, {8, 9, 9}, 4);
+
+  const auto meshes = generateLabelSurfaceMeshes(seg, {0, 1, 2, 4});
+  REQUIRE(meshes.has_value());
+  REQUIRE(meshes->size() == 4);
+
+  double labelVolume = 0.0;
+  for (const LabelSurfaceMesh& mesh : *meshes) {
+    CHECK(isClosed(mesh));
+    if (0 != mesh.label) {
+      CHECK(signedVolume(mesh) > 0.0);
+      labelVolume += signedVolume(mesh);
+    }
+  }
+
+  // The labels tile the inside of the background surface without gaps or overlaps
+  CHECK(signedVolume(meshes->at(0)) < 0.0);
+  CHECK(labelVolume == Catch::Approx(-signedVolume(meshes->at(0))).epsilon(1.0e-4));
+
+  // Vertices of label 2 next to labels 1 or 4 are flagged and shared with their surfaces
+  const LabelSurfaceMesh& inner = meshes->at(2);
+  REQUIRE(inner.interfaces.size() == inner.positions.size());
+
+  std::size_t numInterfaces = 0;
+  for (std::size_t v = 0; v < inner.positions.size(); ++v) {
+    if (inner.interfaces[v]) {
+      ++numInterfaces;
+      const auto& outer = meshes->at(1).positions;
+      const auto& crossing = meshes->at(3).positions;
+      CHECK(
+        (std::find(outer.begin(), outer.end(), inner.positions[v]) != outer.end() ||
+         std::find(crossing.begin(), crossing.end(), inner.positions[v]) != crossing.end()));
+    }
+  }
+  CHECK(numInterfaces > 0);
+  CHECK(numInterfaces < inner.positions.size());
+}
+
+TEST_CASE("Label surfaces do not depend on threads or the label index", "[mesh][segmentation]")
+{
+  Image seg = makeSegmentation({20, 18, 11}, {0.8, 0.8, 1.5});
+  fillBox(seg, {1, 1, 1}, {8, 9, 5}, 1);
+  fillBox(seg, {5, 4, 3}, {15, 12, 9}, 2);
+  fillBox(seg, {12, 2, 0}, {19, 17, 2}, 5);
+
+  SurfaceNetsSettings settings;
+  settings.numThreads = 1;
+  const auto reference = generateLabelSurfaceMeshes(seg, {2, 5}, settings);
+  REQUIRE(reference.has_value());
+  REQUIRE(reference->size() == 2);
+
+  const auto index = SegLabelIndex::build(seg);
+  REQUIRE(index.has_value());
+
+  for (unsigned int numThreads : {3u, 8u, 64u}) {
+    settings.numThreads = numThreads;
+
+    for (const SegLabelIndex* labelIndex : {static_cast<const SegLabelIndex*>(nullptr), &(*index)}) {
+      const auto meshes = generateLabelSurfaceMeshes(seg, {5, 2}, settings, labelIndex);
+      REQUIRE(meshes.has_value());
+      REQUIRE(meshes->size() == reference->size());
+
+      for (std::size_t n = 0; n < meshes->size(); ++n) {
+        CHECK(meshes->at(n).label == reference->at(n).label);
+        CHECK(meshes->at(n).positions == reference->at(n).positions);
+        CHECK(meshes->at(n).indices == reference->at(n).indices);
+      }
+    }
+  }
+
+  // Labels without voxels have no mesh
+  const auto absent = generateLabelSurfaceMeshes(seg, {3}, settings, &(*index));
+  REQUIRE(absent.has_value());
+  CHECK(absent->empty());
+}
+
+TEST_CASE("Label surfaces become mesh records keyed by label", "[mesh][segmentation]")
+{
+  Image seg = makeSegmentation({10, 9, 8}, {1.0, 1.0, 1.0});
+  fillBox(seg, {1, 1, 1}, {4, 4, 4}, 2);
+  fillBox(seg, {5, 1, 1}, {8, 6, 5}, 9);
+
+  const auto meshes = generateLabelSurfaceMeshes(seg, {});
+  REQUIRE(meshes.has_value());
+  REQUIRE(meshes->size() == 2);
+
+  const auto records = generateLabelMeshCpuRecords(seg, {});
+  REQUIRE(records.size() == 2);
+
+  for (const LabelSurfaceMesh& mesh : *meshes) {
+    const auto it = records.find(mesh.label);
+    REQUIRE(it != records.end());
+
+    const MeshCpuRecord& record = *it->second;
+    CHECK(record.meshInfo().meshSource() == MeshSource::Label);
+    CHECK(record.meshInfo().labelIndex() == mesh.label);
+    CHECK(record.positions() == mesh.positions);
+    CHECK(record.indices() == mesh.indices);
+
+    // Two simplified levels of detail follow the full mesh
+    REQUIRE(3 == record.numLevelsOfDetail());
+    CHECK(record.numTriangles(2) <= record.numTriangles(1));
+    CHECK(record.numTriangles(1) <= record.numTriangles(0));
+  }
+
+  // Export meshes need no levels of detail
+  const auto fullRecords = generateLabelMeshCpuRecords(seg, {}, {}, nullptr, false);
+  REQUIRE(fullRecords.size() == 2);
+  CHECK(1 == fullRecords.begin()->second->numLevelsOfDetail());
+}
@@ -0,0 +1,394 @@
+#include "rendering/Rendering.h"
+
+#include "common/FrameProfiler.h"
+#include "common/Viewport.h"
+#include "image/Image.h"
+#include "image/ImageSettings.h"
+#include "image/ImageTransformations.h"
+#include "logic/app/Data.h"
+#include "logic/camera/CameraHelpers.h"
+#include "rendering/RenderData.h"
+#include "rendering/helpers/BrickedTextureHelpers.h"
+#include "rendering/helpers/ImageDrawingHelpers.h"
+#include "rendering/helpers/PipelineHelpers.h"
+#include "rendering/utility/gl/GLShaderProgram.h"
+#include "rendering/utility/gl/GLTexture.h"
+#include "viewer/ViewModes.h"
+#include "viewer/ViewTypes.h"
+#include "windowing/View.h"
+#include "windowing/WindowData.h"
+
+#include <glm/glm.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <limits>
+#include <list>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using namespace uuids;
+namespace bricking = rendering::bricking;
+
+const Uniforms::SamplerIndexType msk_brickIndirectionTexSampler{7};
+
+GLTexture createIndirectionTexture()
+{
+  // Entries are looked up individually and must not be interpolated
+  static const tex::MinificationFilter sk_minFilter = tex::MinificationFilter::Nearest;
+  static const tex::MagnificationFilter sk_maxFilter = tex::MagnificationFilter::Nearest;
+
+  GLTexture::PixelStoreSettings pixelPackSettings;
+  pixelPackSettings.m_alignment = 1;
+  GLTexture::PixelStoreSettings pixelUnpackSettings = pixelPackSettings;
+
+  GLTexture texture(tex::Target::Texture3D, GLTexture::MultisampleSettings(), pixelPackSettings, pixelUnpackSettings);
+  texture.generate();
+  texture.setMinificationFilter(sk_minFilter);
+  texture.setMagnificationFilter(sk_maxFilter);
+  texture.setWrapMode(tex::WrapMode::ClampToEdge);
+  texture.setAutoGenerateMipmaps(false);
+  return texture;
+}
+
+/// Upload the slot and level of the finest resident brick of each level-0 brick into an RGBA 16-bit integer texture
+void uploadIndirectionTexture(RenderData::BrickedTexture& bricked)
+{
+  static constexpr GLint sk_mipmapLevel = 0;
+  static const ComponentType sk_compType = ComponentType::UInt16;
+
+  const std::vector<uint16_t> table = bricking::buildIndirectionTable(bricked.pyramid, bricked.cache);
+
+  bricked.indirectionTexture.setSize(bricked.pyramid.brickCounts(0));
+  bricked.indirectionTexture.setData(
+    sk_mipmapLevel,
+    GLTexture::getSizedInternalRGBAFormat(sk_compType),
+    GLTexture::getBufferPixelRGBAFormat(sk_compType),
+    GLTexture::getBufferPixelDataType(sk_compType),
+    table.data());
+
+  bricked.indirectionChanged = false;
+}
+
+/// Bounding box of the view in continuous voxel coordinates, where voxel i spans [i, i + 1). Slices of 2D views are
+/// bounded at the crosshairs depth; intensity projections and 3D views span the full view depth.
+std::pair<glm::vec3, glm::vec3> visibleVoxelBox(const View& view, const Image& image, const glm::vec3& worldXhairs)
+{
+  const glm::mat4 pixel_T_clip = image.transformations().pixel_T_worldDef() * helper::world_T_clip(view.camera());
+
+  const bool fullDepth =
+    ViewType::ThreeD == view.viewType() || IntensityProjectionMode::None != view.intensityProjectionMode();
+
+  const glm::vec4 clipXhairs = helper::clip_T_world(view.camera()) * glm::vec4{worldXhairs, 1.0f};
+  const float xhairsDepth = clipXhairs.z / clipXhairs.w;
+
+  glm::vec3 boxMin{std::numeric_limits<float>::max()};
+  glm::vec3 boxMax{std::numeric_limits<float>::lowest()};
+
+  for (int c = 0; c < 8; ++c) {
+    const float depth = fullDepth ? ((c & 4) ? 1.0f : -1.0f) : xhairsDepth;
+    const glm::vec4 p = pixel_T_clip * glm::vec4{(c & 1) ? 1.0f : -1.0f, (c & 2) ? 1.0f : -1.0f, depth, 1.0f};
+    const glm::vec3 voxel = glm::vec3{p} / p.w + 0.5f;
+    boxMin = glm::min(boxMin, voxel);
+    boxMax = glm::max(boxMax, voxel);
+  }
+
+  return {boxMin, boxMax};
+}
+
+/// Build the coarse levels of a brick pyramid. This runs in the background on a copy of the image, which shares its
+/// pixel buffers with the original. Returns no levels if the component could not be read.
+std::vector<std::vector<float>> buildCoarseLevels(
+  const Image& image,
+  const bricking::BrickPyramid& pyramid,
+  uint32_t component,
+  uint32_t timePoint)
+{
+  const ImageSettings& settings = image.settings();
+  const profiling::CpuScope scope("Build brick pyramid", [&settings] { return settings.displayName(); });
+
+  const unsigned int numThreads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::vector<float>> coarseLevels;
+
+  if (pyramid.numLevels() < 2) {
+    return coarseLevels;
+  }
+
+  const bool visited = image.visitComponentView(component, timePoint, [&](const auto& view) {
+    coarseLevels.push_back(bricking::downsampleLevel(
+      [&view, &settings](const glm::uvec3& v) {
+        return settings.mapNativeIntensityToTexture(static_cast<double>(view.at(v.x, v.y, v.z)));
+      },
+      pyramid.levelSize(0),
+      numThreads));
+  });
+
+  if (!visited) {
+    spdlog::warn("Unable to build the brick pyramid for component {} of image {}", component, settings.displayName());
+    return {};
+  }
+
+  for (uint32_t level = 2; level < pyramid.numLevels(); ++level) {
+    const std::vector<float>& finer = coarseLevels.back();
+    const glm::uvec3 finerSize = pyramid.levelSize(level - 1);
+
+    coarseLevels.push_back(bricking::downsampleLevel(
+      [&finer, &finerSize](const glm::uvec3& v) {
+        return finer[(static_cast<std::size_t>(v.z) * finerSize.y + v.y) * finerSize.x + v.x];
+      },
+      finerSize,
+      numThreads));
+  }
+
+  return coarseLevels;
+}
+
+/// Move the coarse levels of a bricked texture out of their background build once it finishes
+void collectCoarseLevels(RenderData::BrickedTexture& bricked, const uuid& imageUid)
+{
+  using namespace std::chrono_literals;
+
+  if (!bricked.futureCoarseLevels.valid() || bricked.futureCoarseLevels.wait_for(0ms) != std::future_status::ready) {
+    return;
+  }
+
+  try {
+    bricked.coarseLevels = bricked.futureCoarseLevels.get();
+    spdlog::debug("Built {} coarse pyramid levels of image {}", bricked.coarseLevels.size(), imageUid);
+  }
+  catch (const std::exception& e) {
+    spdlog::error("Exception building the brick pyramid of image {}: {}", imageUid, e.what());
+  }
+}
+
+} // namespace
+
+RenderData::BrickedTexture* Rendering::ensureBrickedTexture(const uuid& imageUid)
+{
+  RenderData& R = m_appData.renderData();
+
+  const Image* image = m_appData.image(imageUid);
+  const auto textureIt = R.m_imageTextures.find(imageUid);
+
+  const bool bricked = RenderData::TextureDimension::Bricked ==
+                       rendering::textureLayoutOrDefault(R.m_imageTextureLayouts, imageUid).dimension;
+
+  if (
+    !bricked || !image || !image->hasPixelData() || std::end(R.m_imageTextures) == textureIt ||
+    textureIt->second.empty())
+  {
+    R.m_brickedTextures.erase(imageUid);
+    return nullptr;
+  }
+
+  const ImageSettings& settings = image->settings();
+  const uint32_t component = settings.activeComponent();
+  const uint32_t timePoint = image->timeAxis().clamp(settings.activeTimePoint());
+
+  auto it = R.m_brickedTextures.find(imageUid);
+  if (std::end(R.m_brickedTextures) != it && it->second.component == component && it->second.timePoint == timePoint) {
+    return &it->second;
+  }
+
+  R.m_brickedTextures.erase(imageUid);
+
+  bricking::BrickPyramid pyramid(image->header().pixelDimensions());
+  const glm::uvec3 slotCounts = textureIt->second.front().size() / pyramid.storedSize();
+
+  spdlog::debug(
+    "Building a pyramid of {} levels for component {} at time point {} of image {}; the brick pool has {} slots",
+    pyramid.numLevels(),
+    component,
+    timePoint,
+    imageUid,
+    static_cast<std::size_t>(slotCounts.x) * slotCounts.y * slotCounts.z);
+
+  const std::size_t bytesPerBrick = pyramid.storedVoxelsPerBrick() * sizeof(float);
+
+  it = R.m_brickedTextures
+         .emplace(
+           imageUid,
+           RenderData::BrickedTexture{
+             .pyramid = pyramid,
+             .cache = bricking::BrickCache(slotCounts, bytesPerBrick),
+             .component = component,
+             .timePoint = timePoint,
+             .coarseLevels = {},
+             .futureCoarseLevels =
+               std::async(std::launch::async, buildCoarseLevels, *image, pyramid, component, timePoint),
+             .indirectionTexture = createIndirectionTexture(),
+             .indirectionChanged = true})
+         .first;
+
+  return &it->second;
+}
+
+void Rendering::beginBrickedTextureFrame()
+{
+  for (auto& [imageUid, bricked] : m_appData.renderData().m_brickedTextures) {
+    const bricking::BrickCacheStats& stats = bricked.cache.frameStats();
+    if (stats.requests > 0) {
+      spdlog::trace(
+        "Bricks of image {}: {} requested, hit rate {:.3f}, {} evicted, {} rejected, {} bytes uploaded",
+        imageUid,
+        stats.requests,
+        stats.hitRate(),
+        stats.evictions,
+        stats.rejected,
+        stats.bytesUploaded);
+    }
+
+    bricked.cache.beginFrame();
+  }
+}
+
+bool Rendering::hasPendingBrickedTextures(const View& view) const
+{
+  const RenderData& R = m_appData.renderData();
+
+  return std::ranges::any_of(view.renderedImages(), [&R](const uuid& imageUid) {
+    const auto it = R.m_brickedTextures.find(imageUid);
+    return std::end(R.m_brickedTextures) != it && it->second.futureCoarseLevels.valid();
+  });
+}
+
+void Rendering::updateBrickedTexturesForView(const View& view, const glm::vec3& worldOffsetXhairs)
+{
+  static constexpr GLint sk_mipmapLevel = 0;
+  static const ComponentType sk_compType = ComponentType::Float32;
+
+  RenderData& R = m_appData.renderData();
+  std::vector<float> brickData;
+
+  for (const uuid& imageUid : view.renderedImages()) {
+    if (
+      RenderData::TextureDimension::Bricked !=
+      rendering::textureLayoutOrDefault(R.m_imageTextureLayouts, imageUid).dimension)
+    {
+      continue;
+    }
+
+    const Image* image = m_appData.image(imageUid);
+    RenderData::BrickedTexture* bricked = ensureBrickedTexture(imageUid);
+    if (!image || !bricked) {
+      continue;
+    }
+
+    const profiling::CpuScope scope("Page bricks", [image] { return image->settings().displayName(); });
+
+    collectCoarseLevels(*bricked, imageUid);
+
+    const bricking::BrickPyramid& pyramid = bricked->pyramid;
+    GLTexture& pool = R.m_imageTextures.at(imageUid).front();
+
+    const glm::mat4 viewClip_T_voxel =
+      glm::inverse(image->transformations().pixel_T_worldDef() * helper::world_T_clip(view.camera()));
+    const float screenPixelsPerVoxel = rendering::image_drawing::maxScreenPixelsPerVoxelAxis(
+      viewClip_T_voxel,
+      view.windowClip_T_viewClip(),
+      m_appData.windowData().viewport());
+
+    const auto [voxelMin, voxelMax] = visibleVoxelBox(view, *image, worldOffsetXhairs);
+
+    // Other views of the frame keep the bricks that they requested. Until the coarse levels are built, only the
+    // bricks of level 0 nearest the view center are paged in.
+    const std::size_t maxBricks = bricked->cache.numSlots() - bricked->cache.numUsedInFrame();
+    const std::vector<bricking::BrickKey> plan = bricking::planBricks(
+      pyramid,
+      voxelMin,
+      voxelMax,
+      (screenPixelsPerVoxel > 0.0f) ? 1.0f / screenPixelsPerVoxel : 1.0f,
+      maxBricks,
+      static_cast<uint32_t>(bricked->coarseLevels.size()));
+
+    for (const bricking::BrickKey& key : plan) {
+      const std::optional<bricking::BrickCache::Request> request = bricked->cache.request(key);
+      if (!request || request->hit) {
+        continue;
+      }
+
+      if (0 == key.level) {
+        const ImageSettings& settings = image->settings();
+        image->visitComponentView(bricked->component, bricked->timePoint, [&](const auto& imageView) {
+          bricking::extractBrick(
+            pyramid,
+            key,
+            [&imageView, &settings](const glm::uvec3& v) {
+              return settings.mapNativeIntensityToTexture(static_cast<double>(imageView.at(v.x, v.y, v.z)));
+            },
+            brickData);
+        });
+      }
+      else {
+        const std::vector<float>& levelData = bricked->coarseLevels[key.level - 1];
+        const glm::uvec3 levelSize = pyramid.levelSize(key.level);
+
+        bricking::extractBrick(
+          pyramid,
+          key,
+          [&levelData, &levelSize](const glm::uvec3& v) {
+            return levelData[(static_cast<std::size_t>(v.z) * levelSize.y + v.y) * levelSize.x + v.x];
+          },
+          brickData);
+      }
+
+      pool.setSubData(
+        sk_mipmapLevel,
+        bricked->cache.slotCoordinates(request->slot) * pyramid.storedSize(),
+        pyramid.storedSize(),
+        GLTexture::getBufferPixelNormalizedRedFormat(sk_compType),
+        GLTexture::getBufferPixelDataType(sk_compType),
+        brickData.data());
+
+      bricked->indirectionChanged = true;
+    }
+
+    if (bricked->indirectionChanged) {
+      uploadIndirectionTexture(*bricked);
+    }
+  }
+}
+
+std::list<std::reference_wrapper<GLTexture>> Rendering::bindBrickedTextures(const ImgSegPair& p)
+{
+  std::list<std::reference_wrapper<GLTexture>> boundTextures;
+  if (!p.first) {
+    return boundTextures;
+  }
+
+  RenderData& R = m_appData.renderData();
+  if (const auto it = R.m_brickedTextures.find(*p.first); std::end(R.m_brickedTextures) != it) {
+    it->second.indirectionTexture.bind(msk_brickIndirectionTexSampler.index);
+    boundTextures.emplace_back(it->second.indirectionTexture);
+  }
+
+  return boundTextures;
+}
+
+void Rendering::setBrickedTextureUniforms(GLShaderProgram& program, const ImgSegPair& p)
+{
+  // Always point the indirection sampler away from the image unit, which holds a texture of another sampler type
+  program.setSamplerUniform("u_brickIndirectionTex", msk_brickIndirectionTexSampler.index);
+
+  const RenderData& R = m_appData.renderData();
+  const auto it = p.first ? R.m_brickedTextures.find(*p.first) : std::end(R.m_brickedTextures);
+  if (std::end(R.m_brickedTextures) == it) {
+    return;
+  }
+
+  const bricking::BrickPyramid& pyramid = it->second.pyramid;
+  program.setUniform("u_brickVolumeSize", glm::vec3{pyramid.volumeSize()});
+  program.setUniform("u_brickPoolSize", glm::vec3{it->second.cache.slotCounts() * pyramid.storedSize()});
+  program.setUniform("u_brickPayloadSize", glm::vec3{pyramid.payloadSize()});
+  program.setUniform("u_brickApronSize", glm::vec3{pyramid.apronSize()});
+}
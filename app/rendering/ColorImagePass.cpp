@@ -71,6 +71,7 @@ void Rendering::renderColorImageForImage(
         program = &shaderProgramForTextureDimension(
           m_shaderPrograms,
           m_shaderPrograms2D,
+          m_shaderProgramsBricked,
           renderWarped ? ShaderProgramType::ImageColorLinearWarped : ShaderProgramType::ImageColorLinear,
           imageTextureLayout.dimension);
         break;
@@ -79,6 +80,7 @@ void Rendering::renderColorImageForImage(
         program = &shaderProgramForTextureDimension(
           m_shaderPrograms,
           m_shaderPrograms2D,
+          m_shaderProgramsBricked,
           renderWarped ? ShaderProgramType::ImageColorCubicWarped : ShaderProgramType::ImageColorCubic,
           imageTextureLayout.dimension);
         break;
@@ -156,6 +158,7 @@ void Rendering::renderColorImageForImage(
         program = &shaderProgramForTextureDimension(
           m_shaderPrograms,
           m_shaderPrograms2D,
+          m_shaderProgramsBricked,
           renderWarped ? ShaderProgramType::EdgeSobelLinearWarped : ShaderProgramType::EdgeSobelLinear,
           imageTextureLayout.dimension);
         break;
@@ -164,6 +167,7 @@ void Rendering::renderColorImageForImage(
         program = &shaderProgramForTextureDimension(
           m_shaderPrograms,
           m_shaderPrograms2D,
+          m_shaderProgramsBricked,
           renderWarped ? ShaderProgramType::EdgeSobelCubicWarped : ShaderProgramType::EdgeSobelCubic,
           imageTextureLayout.dimension);
         break;
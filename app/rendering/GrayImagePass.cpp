@@ -106,6 +106,7 @@ void Rendering::renderGrayImageForImage(
         program = &shaderProgramForTextureDimension(
           m_shaderPrograms,
           m_shaderPrograms2D,
+          m_shaderProgramsBricked,
           doXray ? (renderWarped ? ShaderProgramType::XrayLinearWarped : ShaderProgramType::XrayLinear)
                  : (renderWarped ? ShaderProgramType::ImageGrayLinearWarped : ShaderProgramType::ImageGrayLinear),
           imageTextureLayout.dimension);
@@ -116,6 +117,7 @@ void Rendering::renderGrayImageForImage(
           program = &shaderProgramForTextureDimension(
             m_shaderPrograms,
             m_shaderPrograms2D,
+            m_shaderProgramsBricked,
             renderWarped ? ShaderProgramType::XrayLinearWarped : ShaderProgramType::XrayLinear,
             imageTextureLayout.dimension);
         }
@@ -134,6 +136,7 @@ void Rendering::renderGrayImageForImage(
           program = &shaderProgramForTextureDimension(
             m_shaderPrograms,
             m_shaderPrograms2D,
+            m_shaderProgramsBricked,
             shaderType,
             imageTextureLayout.dimension);
         }
@@ -143,6 +146,7 @@ void Rendering::renderGrayImageForImage(
         program = &shaderProgramForTextureDimension(
           m_shaderPrograms,
           m_shaderPrograms2D,
+          m_shaderProgramsBricked,
           doXray ? (renderWarped ? ShaderProgramType::XrayCubicWarped : ShaderProgramType::XrayCubic)
                  : (renderWarped ? ShaderProgramType::ImageGrayCubicWarped : ShaderProgramType::ImageGrayCubic),
           imageTextureLayout.dimension);
@@ -159,6 +163,7 @@ void Rendering::renderGrayImageForImage(
       program->setSamplerUniform("u_imgTex", msk_imgTexSampler.index);
       program->setSamplerUniform("u_cmapTex", msk_imgCmapTexSampler.index);
       setTexture2DAxesUniforms(*program, imageTextureLayout);
+      setBrickedTextureUniforms(*program, imgSegPair);
 
       program->setUniform("u_numCheckers", static_cast<float>(renderData.m_numCheckerboardSquares));
       program->setUniform("u_tex_T_world", uniforms.imgTexture_T_world);
@@ -231,6 +236,7 @@ void Rendering::renderGrayImageForImage(
         program = &shaderProgramForTextureDimension(
           m_shaderPrograms,
           m_shaderPrograms2D,
+          m_shaderProgramsBricked,
           renderWarped ? ShaderProgramType::EdgeSobelLinearWarped : ShaderProgramType::EdgeSobelLinear,
           imageTextureLayout.dimension);
         break;
@@ -239,6 +245,7 @@ void Rendering::renderGrayImageForImage(
         program = &shaderProgramForTextureDimension(
           m_shaderPrograms,
           m_shaderPrograms2D,
+          m_shaderProgramsBricked,
           renderWarped ? ShaderProgramType::EdgeSobelCubicWarped : ShaderProgramType::EdgeSobelCubic,
           imageTextureLayout.dimension);
         break;
@@ -254,6 +261,7 @@ void Rendering::renderGrayImageForImage(
       program->setSamplerUniform("u_imgTex", msk_imgTexSampler.index);
       program->setSamplerUniform("u_cmapTex", msk_imgCmapTexSampler.index);
       setTexture2DAxesUniforms(*program, imageTextureLayout);
+      setBrickedTextureUniforms(*program, imgSegPair);
 
       program->setUniform("u_numCheckers", static_cast<float>(renderData.m_numCheckerboardSquares));
       program->setUniform("u_tex_T_world", uniforms.imgTexture_T_world);
@@ -1,5 +1,6 @@
 #include "rendering/Rendering.h"
 
+#include "common/FrameProfiler.h"
 #include "common/Types.h"
 #include "image/Image.h"
 #include "image/ImageSettings.h"
@@ -157,17 +158,27 @@ void Rendering::renderAllImagesForView(
           return;
         }
 
+        const profiling::GpuScope layerScope("Image layer", [img] { return img->settings().displayName(); });
+
         const RenderData::ImageUniforms& U = R.m_uniforms.at(imgUid);
         const std::optional<uuid> deformationUid = activeRenderableDeformationUid(imgUid);
         const bool renderWarped = deformationUid.has_value();
         const RenderData::PlanarTextureLayout imageTextureLayout =
           rendering::textureLayoutOrDefault(R.m_imageTextureLayouts, imgSegPair.first);
 
-        if (
+        const bool renderAsVector =
           ComponentRenderMode::VectorDirectionColor == img->settings().componentRenderMode() ||
           ComponentRenderMode::VectorSignedNormalProjection == img->settings().componentRenderMode() ||
-          ComponentRenderMode::VectorPlanarProjectionColor == img->settings().componentRenderMode())
+          ComponentRenderMode::VectorPlanarProjectionColor == img->settings().componentRenderMode();
+
+        if (
+          RenderData::TextureDimension::Bricked == imageTextureLayout.dimension &&
+          (renderAsVector || img->settings().displayImageAsColor()))
         {
+          // Bricks hold only the active component
+          spdlog::trace("Skipping color rendering of image {}, which is paged into bricks", imgUid);
+        }
+        else if (renderAsVector) {
           renderVectorImageForImage(
             view,
             worldOffsetXhairs,
@@ -251,11 +262,13 @@ void Rendering::renderAllImagesForView(
     }
 
     case ShaderGroup::Metric: {
+      const profiling::GpuScope scope("Metric images");
       renderMetricImagesForView(view, worldOffsetXhairs);
       break;
     }
 
     case ShaderGroup::Volume: {
+      const profiling::GpuScope scope("Volume images");
       renderVolumeImagesForView(view);
       break;
     }
@@ -72,6 +72,9 @@ std::list<std::reference_wrapper<GLTexture>> Rendering::bindScalarImageTextures(
   imgTex.bind(msk_imgTexSampler.index);
   boundTextures.emplace_back(imgTex);
 
+  // Bind the indirection texture of images that are paged into bricks
+  boundTextures.splice(std::end(boundTextures), bindBrickedTextures(p));
+
   // Bind the color map
   const auto cmapUid = image ? m_appData.imageColorMapUid(image->settings().colorMapIndex()) : std::nullopt;
 
@@ -71,6 +71,8 @@ void Rendering::updateImageUniforms(const uuid_range_t& imageUids)
 
 void Rendering::updateImageUniforms(const uuid& imageUid)
 {
+  invalidateViewRenderCache();
+
   const uuid effectiveImageUid = m_appData.effectiveImageUidForRendering(imageUid);
   if (effectiveImageUid != imageUid) {
     Image* source = m_appData.image(imageUid);
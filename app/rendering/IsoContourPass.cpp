@@ -88,6 +88,7 @@ void Rendering::renderIsoContoursForImage(
       program = &shaderProgramForTextureDimension(
         m_shaderPrograms,
         m_shaderPrograms2D,
+        m_shaderProgramsBricked,
         renderWarped ? ShaderProgramType::IsoContourLinearFloatingWarped : ShaderProgramType::IsoContourLinearFloating,
         imageTextureLayout.dimension);
       break;
@@ -107,6 +108,7 @@ void Rendering::renderIsoContoursForImage(
       program = &shaderProgramForTextureDimension(
         m_shaderPrograms,
         m_shaderPrograms2D,
+        m_shaderProgramsBricked,
         shaderType,
         imageTextureLayout.dimension);
       break;
@@ -115,6 +117,7 @@ void Rendering::renderIsoContoursForImage(
       program = &shaderProgramForTextureDimension(
         m_shaderPrograms,
         m_shaderPrograms2D,
+        m_shaderProgramsBricked,
         renderWarped ? ShaderProgramType::IsoContourCubicFixedWarped : ShaderProgramType::IsoContourCubicFixed,
         imageTextureLayout.dimension);
       break;
@@ -145,6 +148,7 @@ void Rendering::renderIsoContoursForImage(
 
     program->setSamplerUniform("u_imgTex", msk_imgTexSampler.index);
     setTexture2DAxesUniforms(*program, imageTextureLayout);
+    setBrickedTextureUniforms(*program, imgSegPair);
 
     program->setUniform("u_numCheckers", static_cast<float>(renderData.m_numCheckerboardSquares));
     program->setUniform("u_tex_T_world", uniforms.imgTexture_T_world);
@@ -66,6 +66,10 @@ void Rendering::renderMetricImagesForView(const View& view, const glm::vec3& wor
       "Metric rendering between mixed 2D-fallback and 3D textures is not supported yet; skipping metric view");
     return;
   }
+  if (RenderData::TextureDimension::Bricked == metricTextureLayouts[0].dimension) {
+    spdlog::warn("Metric rendering of images paged into bricks is not supported yet; skipping metric view");
+    return;
+  }
   const RenderData::TextureDimension metricTextureDimension = metricTextureLayouts[0].dimension;
 
   const auto boundMetricTextures = bindMetricImageTextures(imageSegPairs, view.renderMode());
@@ -104,6 +108,7 @@ void Rendering::renderMetricImagesForView(const View& view, const glm::vec3& wor
     GLShaderProgram& program = shaderProgramForTextureDimension(
       m_shaderPrograms,
       m_shaderPrograms2D,
+      m_shaderProgramsBricked,
       useTricubic
         ? (renderWarpedMetric ? ShaderProgramType::DifferenceCubicWarped : ShaderProgramType::DifferenceCubic)
         : (renderWarpedMetric ? ShaderProgramType::DifferenceLinearWarped : ShaderProgramType::DifferenceLinear),
@@ -135,6 +140,7 @@ void Rendering::renderMetricImagesForView(const View& view, const glm::vec3& wor
     GLShaderProgram& program = shaderProgramForTextureDimension(
       m_shaderPrograms,
       m_shaderPrograms2D,
+      m_shaderProgramsBricked,
       useTricubic ? (renderWarpedMetric ? ShaderProgramType::LocalNccCubicWarped : ShaderProgramType::LocalNccCubic)
                   : (renderWarpedMetric ? ShaderProgramType::LocalNccLinearWarped : ShaderProgramType::LocalNccLinear),
       metricTextureDimension);
@@ -171,6 +177,7 @@ void Rendering::renderMetricImagesForView(const View& view, const glm::vec3& wor
     GLShaderProgram& program = shaderProgramForTextureDimension(
       m_shaderPrograms,
       m_shaderPrograms2D,
+      m_shaderProgramsBricked,
       useTricubic ? (renderWarpedMetric ? ShaderProgramType::LocalLinearResidualCubicWarped
                                         : ShaderProgramType::LocalLinearResidualCubic)
                   : (renderWarpedMetric ? ShaderProgramType::LocalLinearResidualLinearWarped
@@ -207,6 +214,7 @@ void Rendering::renderMetricImagesForView(const View& view, const glm::vec3& wor
     GLShaderProgram& program = shaderProgramForTextureDimension(
       m_shaderPrograms,
       m_shaderPrograms2D,
+      m_shaderProgramsBricked,
       useTricubic ? (renderWarpedMetric ? ShaderProgramType::OverlapCubicWarped : ShaderProgramType::OverlapCubic)
                   : (renderWarpedMetric ? ShaderProgramType::OverlapLinearWarped : ShaderProgramType::OverlapLinear),
       metricTextureDimension);
@@ -245,6 +253,7 @@ void Rendering::renderMetricImagesForView(const View& view, const glm::vec3& wor
     GLShaderProgram& program = shaderProgramForTextureDimension(
       m_shaderPrograms,
       m_shaderPrograms2D,
+      m_shaderProgramsBricked,
       (InterpolationMode::NearestNeighbor == segs[i]->settings().interpolationMode())
         ? ShaderProgramType::SegmentationNearest
         : ShaderProgramType::SegmentationLinear,
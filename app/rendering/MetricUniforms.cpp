@@ -8,6 +8,8 @@
 
 void Rendering::updateMetricUniforms()
 {
+  invalidateViewRenderCache();
+
   auto update = [this](RenderData::MetricParams& params, const char* name) {
     if (const auto cmapUid = m_appData.imageColorMapUid(params.m_colorMapIndex)) {
       if (const auto* map = m_appData.imageColorMap(*cmapUid)) {
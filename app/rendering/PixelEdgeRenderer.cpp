@@ -108,7 +108,11 @@ void PixelEdgeRenderer::render(
     return;
   }
 
-  ensureSceneFboSize(deviceSize);
+  // Views may be rendered into an offscreen target, such as the view render cache
+  GLint targetFboId = 0;
+  glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFboId);
+
+  ensureSceneFboSize(deviceSize, static_cast<GLuint>(targetFboId));
   if (!m_sceneColorTex) {
     return;
   }
@@ -133,7 +137,7 @@ void PixelEdgeRenderer::render(
   glClear(GL_COLOR_BUFFER_BIT);
   drawImage();
 
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(targetFboId));
   glViewport(defaultViewport.x, defaultViewport.y, deviceSize.x, deviceSize.y);
   glScissor(
     static_cast<GLint>(viewRect.windowX),
@@ -185,7 +189,7 @@ void PixelEdgeRenderer::render(
   previousStencilEnabled ? glEnable(GL_STENCIL_TEST) : glDisable(GL_STENCIL_TEST);
 }
 
-void PixelEdgeRenderer::ensureSceneFboSize(glm::ivec2 deviceSize)
+void PixelEdgeRenderer::ensureSceneFboSize(glm::ivec2 deviceSize, GLuint targetFboId)
 {
   if (deviceSize == m_sceneFboSize && m_sceneColorTex) {
     return;
@@ -215,5 +219,5 @@ void PixelEdgeRenderer::ensureSceneFboSize(glm::ivec2 deviceSize)
 
   m_sceneFbo.bind(fbo::TargetType::DrawAndRead);
   m_sceneFbo.attach2DTexture(fbo::TargetType::Draw, fbo::AttachmentType::Color, *m_sceneColorTex, 0);
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, targetFboId);
 }
@@ -20,7 +20,8 @@
  * @brief Renders screen-space image edges as a post-process over one view.
  *
  * The renderer captures the normal image pass into a reusable framebuffer, runs a
- * pixel-space edge shader, and composites the result back into the view rectangle.
+ * pixel-space edge shader, and composites the result back into the view rectangle
+ * of the framebuffer that was bound when rendering began.
  */
 class PixelEdgeRenderer
 {
@@ -58,7 +59,8 @@ public:
     const BindPostTexturesFn& bindPostTextures);
 
 private:
-  void ensureSceneFboSize(glm::ivec2 deviceSize);
+  /// Resize the capture framebuffer, then bind the framebuffer that views are rendered into again
+  void ensureSceneFboSize(glm::ivec2 deviceSize, GLuint targetFboId);
 
   GLFrameBufferObject m_sceneFbo{"ScenePixelEdgePostFbo"};
   std::optional<GLTexture> m_sceneColorTex;
@@ -25,6 +25,9 @@ void createShaderPrograms();
  */
 bool createRaycastIsoProgram(GLShaderProgram& program, bool warped);
 
+/// Label of a view in the frame profiler: its type, render mode, and the start of its UID
+std::string viewProfileLabel(const uuids::uuid& viewUid, const View& view) const;
+
 /// @}
 /// @name Top-level render passes
 /// @{
@@ -232,6 +235,46 @@ void setRaycastIsoUniforms(
   bool renderWarped,
   const std::optional<uuids::uuid>& deformationUid);
 
+/**
+ * @brief Build or rebuild the macrocells of the raycast component and time point of an image, if they are
+ * missing or stale, and upload their texture.
+ * @return The macrocells, or nullptr if the image cannot have them.
+ */
+RenderData::Macrocells* ensureMacrocells(const uuids::uuid& imageUid);
+
+/**
+ * @brief Recompute the macrocells that overlap a changed region of an image component and upload their texture.
+ */
+void updateMacrocells(
+  const uuids::uuid& imageUid,
+  uint32_t component,
+  const glm::uvec3& startOffsetVoxel,
+  const glm::uvec3& sizeInVoxels);
+
+/**
+ * @brief Build or rebuild the brick pyramid and cache of the active component and time point of an image whose texture
+ * is a brick pool, if they are missing or stale.
+ * @return The bricked texture, or nullptr if the image is not paged into bricks.
+ */
+RenderData::BrickedTexture* ensureBrickedTexture(const uuids::uuid& imageUid);
+
+/**
+ * @brief Start a new frame for the brick caches, which releases the bricks that the views of the last frame used.
+ */
+void beginBrickedTextureFrame();
+
+/**
+ * @brief Page the bricks that a view needs for its bricked images into their pools and update the indirection
+ * textures. Bricks are chosen at the pyramid level of the view zoom and nearest to the view center first.
+ */
+void updateBrickedTexturesForView(const View& view, const glm::vec3& worldOffsetXhairs);
+
+/**
+ * @brief Check whether a view renders bricked images whose coarse pyramid levels are still being built in the
+ * background, in which case the view is rendered every frame until they are paged in.
+ */
+bool hasPendingBrickedTextures(const View& view) const;
+
 /// @}
 /// @name Texture binding and deformation uniforms
 /// @{
@@ -241,6 +284,23 @@ void setRaycastIsoUniforms(
  */
 std::list<std::reference_wrapper<GLTexture>> bindScalarImageTextures(const ImgSegPair& p);
 
+/**
+ * @brief Bind the macrocell texture used to skip empty space when raycasting one image/segmentation pair.
+ * @return The bound texture, or an empty list if the image has no macrocells.
+ */
+std::list<std::reference_wrapper<GLTexture>> bindMacrocellTextures(const ImgSegPair& p);
+
+/**
+ * @brief Bind the brick indirection texture of an image that is paged into bricks.
+ * @return The bound texture, or an empty list if the image is not paged into bricks.
+ */
+std::list<std::reference_wrapper<GLTexture>> bindBrickedTextures(const ImgSegPair& p);
+
+/**
+ * @brief Set the uniforms of the bricked texture lookup for an image that is paged into bricks.
+ */
+void setBrickedTextureUniforms(GLShaderProgram& program, const ImgSegPair& p);
+
 /**
  * @brief Bind multi-component color image textures for one image/segmentation pair.
  */
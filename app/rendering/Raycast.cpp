@@ -73,6 +73,8 @@ void Rendering::renderVolumeImagesForView(const View& view)
   const auto boundDefTextures =
     renderWarped ? bindDeformationTextures(*deformationUid) : std::list<std::reference_wrapper<GLTexture>>{};
   const auto boundSegBufferTextures = bindSegBufferTextures(imgSegPair);
+  const auto boundMacrocellTextures =
+    renderWarped ? std::list<std::reference_wrapper<GLTexture>>{} : bindMacrocellTextures(imgSegPair);
 
   const auto& U = m_appData.renderData().m_uniforms.at(*imgSegPair.first);
   const auto& domainU = (referenceImageUid && m_appData.renderData().m_uniforms.count(*referenceImageUid) > 0u)
@@ -100,6 +102,7 @@ void Rendering::renderVolumeImagesForView(const View& view)
   }
   program.stopUse();
 
+  unbindTextures(boundMacrocellTextures);
   unbindTextures(boundDefTextures);
   unbindTextures(boundImageTextures);
   unbindBufferTextures(boundSegBufferTextures);
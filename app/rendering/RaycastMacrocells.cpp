@@ -0,0 +1,179 @@
+#include "rendering/Rendering.h"
+
+#include "image/Image.h"
+#include "image/ImageMacrocellGrid.h"
+#include "image/ImageSettings.h"
+#include "logic/app/Data.h"
+#include "rendering/RenderData.h"
+#include "rendering/utility/gl/GLTexture.h"
+
+#include <glm/glm.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using namespace uuids;
+
+const Uniforms::SamplerIndexType msk_macrocellTexSampler{2};
+
+/// Component of the image whose texture the raycaster samples, which for interleaved images with a single
+/// texture is always the first one
+std::optional<uint32_t> raycastComponent(const RenderData& renderData, const uuid& imageUid, const Image& image)
+{
+  const auto textureIt = renderData.m_imageTextures.find(imageUid);
+  if (std::end(renderData.m_imageTextures) == textureIt || textureIt->second.empty()) {
+    return std::nullopt;
+  }
+
+  const auto layoutIt = renderData.m_imageTextureLayouts.find(imageUid);
+  if (
+    layoutIt != std::end(renderData.m_imageTextureLayouts) &&
+    RenderData::TextureDimension::Texture2D == layoutIt->second.dimension)
+  {
+    return std::nullopt; // Planar textures are not raycast
+  }
+
+  if (Image::MultiComponentBufferType::InterleavedImage == image.bufferType() && 1u == textureIt->second.size()) {
+    return 0u;
+  }
+
+  return static_cast<uint32_t>(
+    std::min<std::size_t>(image.settings().activeComponent(), textureIt->second.size() - 1u));
+}
+
+/// Upload the cell ranges, mapped to the intensities of the image texture, into an RG float texture
+void uploadMacrocellTexture(GLTexture& texture, const ImageMacrocellGrid& grid, const ImageSettings& settings)
+{
+  static constexpr GLint sk_mipmapLevel = 0;
+  static const ComponentType sk_compType = ComponentType::Float32;
+
+  std::vector<float> ranges;
+  ranges.reserve(2 * grid.numCells());
+
+  for (std::size_t c = 0; c < grid.numCells(); ++c) {
+    ranges.push_back(static_cast<float>(settings.mapNativeIntensityToTexture(grid.minValue(c))));
+    ranges.push_back(static_cast<float>(settings.mapNativeIntensityToTexture(grid.maxValue(c))));
+  }
+
+  texture.setSize(grid.cellCounts());
+  texture.setData(
+    sk_mipmapLevel,
+    GLTexture::getSizedInternalNormalizedRGFormat(sk_compType),
+    GLTexture::getBufferPixelNormalizedRGFormat(sk_compType),
+    GLTexture::getBufferPixelDataType(sk_compType),
+    ranges.data());
+}
+
+GLTexture createMacrocellTexture()
+{
+  // Cells are looked up individually and must not be interpolated
+  static const tex::MinificationFilter sk_minFilter = tex::MinificationFilter::Nearest;
+  static const tex::MagnificationFilter sk_maxFilter = tex::MagnificationFilter::Nearest;
+
+  GLTexture::PixelStoreSettings pixelPackSettings;
+  pixelPackSettings.m_alignment = 4;
+  GLTexture::PixelStoreSettings pixelUnpackSettings = pixelPackSettings;
+
+  GLTexture texture(tex::Target::Texture3D, GLTexture::MultisampleSettings(), pixelPackSettings, pixelUnpackSettings);
+  texture.generate();
+  texture.setMinificationFilter(sk_minFilter);
+  texture.setMagnificationFilter(sk_maxFilter);
+  texture.setWrapMode(tex::WrapMode::ClampToEdge);
+  texture.setAutoGenerateMipmaps(false);
+  return texture;
+}
+
+} // namespace
+
+RenderData::Macrocells* Rendering::ensureMacrocells(const uuid& imageUid)
+{
+  RenderData& R = m_appData.renderData();
+
+  const Image* image = m_appData.image(imageUid);
+  if (!image || !image->hasPixelData()) {
+    R.m_macrocells.erase(imageUid);
+    return nullptr;
+  }
+
+  const std::optional<uint32_t> component = raycastComponent(R, imageUid, *image);
+  if (!component) {
+    R.m_macrocells.erase(imageUid);
+    return nullptr;
+  }
+
+  const uint32_t timePoint = image->timeAxis().clamp(image->settings().activeTimePoint());
+
+  auto it = R.m_macrocells.find(imageUid);
+  if (
+    std::end(R.m_macrocells) != it && it->second.grid.component() == *component &&
+    it->second.grid.timePoint() == timePoint && it->second.grid.dimensions() == image->header().pixelDimensions())
+  {
+    return &it->second;
+  }
+
+  R.m_macrocells.erase(imageUid);
+
+  std::optional<ImageMacrocellGrid> grid = ImageMacrocellGrid::build(*image, *component, timePoint);
+  if (!grid) {
+    spdlog::warn("Unable to build macrocells for component {} of image {}", *component, imageUid);
+    return nullptr;
+  }
+
+  spdlog::debug(
+    "Built {} macrocells for component {} at time point {} of image {}",
+    grid->numCells(),
+    *component,
+    timePoint,
+    imageUid);
+
+  it = R.m_macrocells.emplace(imageUid, RenderData::Macrocells{std::move(*grid), createMacrocellTexture()}).first;
+  uploadMacrocellTexture(it->second.texture, it->second.grid, image->settings());
+  return &it->second;
+}
+
+void Rendering::updateMacrocells(
+  const uuid& imageUid,
+  uint32_t component,
+  const glm::uvec3& startOffsetVoxel,
+  const glm::uvec3& sizeInVoxels)
+{
+  RenderData& R = m_appData.renderData();
+
+  const auto it = R.m_macrocells.find(imageUid);
+  if (std::end(R.m_macrocells) == it || it->second.grid.component() != component) {
+    return;
+  }
+
+  const Image* image = m_appData.image(imageUid);
+  if (!image || !it->second.grid.update(*image, startOffsetVoxel, sizeInVoxels)) {
+    // Rebuild from scratch the next time the image is raycast
+    R.m_macrocells.erase(it);
+    return;
+  }
+
+  uploadMacrocellTexture(it->second.texture, it->second.grid, image->settings());
+}
+
+std::list<std::reference_wrapper<GLTexture>> Rendering::bindMacrocellTextures(const ImgSegPair& p)
+{
+  std::list<std::reference_wrapper<GLTexture>> boundTextures;
+  if (!p.first) {
+    return boundTextures;
+  }
+
+  if (RenderData::Macrocells* macrocells = ensureMacrocells(*p.first)) {
+    macrocells->texture.bind(msk_macrocellTexSampler.index);
+    boundTextures.emplace_back(macrocells->texture);
+  }
+
+  return boundTextures;
+}
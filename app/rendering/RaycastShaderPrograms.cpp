@@ -29,6 +29,7 @@ const glm::vec4 sk_zeroVec4{0.0f, 0.0f, 0.0f, 0.0f};
 
 const Uniforms::SamplerIndexType msk_imgTexSampler{0};
 const Uniforms::SamplerIndexType msk_jumpTexSampler{1};
+const Uniforms::SamplerIndexType msk_macrocellTexSampler{2};
 const Uniforms::SamplerIndexVectorType msk_defTexSamplers{{4, 5, 6}};
 
 std::string loadFile(const std::string& path)
@@ -86,11 +87,18 @@ bool Rendering::createRaycastIsoProgram(GLShaderProgram& program, bool warped)
     "{\n"
     "  return 0.0;\n"
     "}\n";
+  const std::string macrocellSkipTextureRep = loadFile(shaderPath + "MacrocellSkip_Texture.glsl");
+  const std::string macrocellSkipDisabledRep =
+    "float raycastNextActiveDistance(vec3 texStartPos, vec3 texRayDir, float t, float tMax)\n"
+    "{\n"
+    "  return t;\n"
+    "}\n";
   fsSource = rendering::replacePlaceholders(
     fsSource,
     {{"$$SAMPLE_TEX_COORD_FUNCTION$$", warped ? sampleTexCoordDeformationRep : sampleTexCoordIdentityRep},
      {"$$SAMPLE_IMAGE_VALUE_FUNCTION$$", warped ? sampleImageValueDeformationRep : sampleImageValueIdentityRep},
-     {"$$RAYCAST_JUMP_DISTANCE_FUNCTION$$", warped ? jumpDisabledRep : jumpTextureRep}});
+     {"$$RAYCAST_JUMP_DISTANCE_FUNCTION$$", warped ? jumpDisabledRep : jumpTextureRep},
+     {"$$RAYCAST_MACROCELL_SKIP_FUNCTION$$", warped ? macrocellSkipDisabledRep : macrocellSkipTextureRep}});
 
   {
     Uniforms vsUniforms;
@@ -110,6 +118,7 @@ bool Rendering::createRaycastIsoProgram(GLShaderProgram& program, bool warped)
 
     fsUniforms.insertUniform("u_imgTex", UniformType::Sampler, msk_imgTexSampler);
     fsUniforms.insertUniform("u_jumpTex", UniformType::Sampler, msk_jumpTexSampler, !warped);
+    fsUniforms.insertUniform("u_macrocellTex", UniformType::Sampler, msk_macrocellTexSampler, !warped);
 
     fsUniforms.insertUniform("u_tex_T_world", UniformType::Mat4, sk_identMat4);
     fsUniforms.insertUniform("u_world_T_tex", UniformType::Mat4, sk_identMat4);
@@ -143,6 +152,11 @@ bool Rendering::createRaycastIsoProgram(GLShaderProgram& program, bool warped)
     fsUniforms.insertUniform("u_renderBackFaces", UniformType::Bool, true);
     fsUniforms.insertUniform("u_noHitTransparent", UniformType::Bool, true);
 
+    if (!warped) {
+      fsUniforms.insertUniform("u_macrocellSkipping", UniformType::Bool, false);
+      fsUniforms.insertUniform("u_macrocellVoxels", UniformType::Float, 8.0f);
+    }
+
     if (warped) {
       fsUniforms.insertUniform("u_defTex", UniformType::SamplerVector, msk_defTexSamplers);
       fsUniforms.insertUniform("u_defTex_T_world", UniformType::Mat4, sk_identMat4);
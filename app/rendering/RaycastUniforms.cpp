@@ -1,6 +1,7 @@
 #include "rendering/Rendering.h"
 
 #include "image/Image.h"
+#include "image/ImageMacrocellGrid.h"
 #include "image/ImageSettings.h"
 #include "logic/app/Data.h"
 #include "rendering/RenderData.h"
@@ -19,6 +20,7 @@ namespace
 
 const Uniforms::SamplerIndexType s_imgTexSampler{0};
 const Uniforms::SamplerIndexType s_jumpTexSampler{1};
+const Uniforms::SamplerIndexType s_macrocellTexSampler{2};
 
 } // namespace
 
@@ -35,6 +37,7 @@ void Rendering::setRaycastIsoUniforms(
 
   program.setSamplerUniform("u_imgTex", s_imgTexSampler.index);
   program.setSamplerUniform("u_jumpTex", s_jumpTexSampler.index);
+  program.setSamplerUniform("u_macrocellTex", s_macrocellTexSampler.index);
 
   program.setUniform("u_tex_T_world", uniforms.imgTexture_T_world);
   program.setUniform("u_world_T_tex", uniforms.world_T_imgTexture);
@@ -59,6 +62,16 @@ void Rendering::setRaycastIsoUniforms(
   program.setUniform("u_bgColor", renderData.m_3dBackgroundColor.a * renderData.m_3dBackgroundColor);
   program.setUniform("u_bgEdgeBrighteningEnabled", renderData.m_raycastBackgroundEdgeBrighteningEnabled);
   program.setUniform("u_noHitTransparent", renderData.m_3dTransparentIfNoHit);
+
+  // Macrocells are in the voxel coordinates of the image, which do not apply to warped rays
+  const auto macrocellsIt = imgSegPair.first ? renderData.m_macrocells.find(*imgSegPair.first)
+                                             : std::end(renderData.m_macrocells);
+  const bool skipMacrocells = !renderWarped && std::end(renderData.m_macrocells) != macrocellsIt;
+  program.setUniform("u_macrocellSkipping", skipMacrocells);
+  program.setUniform(
+    "u_macrocellVoxels",
+    skipMacrocells ? static_cast<float>(macrocellsIt->second.grid.cellSize())
+                   : static_cast<float>(ImageMacrocellGrid::sk_defaultCellSize));
   program.setUniform(
     "u_showCrosshairs3D",
     renderData.m_showCrosshairsIn3D && !view.threeDState().m_viewPositionFollowsCrosshairs);
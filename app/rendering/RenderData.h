@@ -1,8 +1,12 @@
 #pragma once
 
 #include "common/Types.h"
+#include "image/ImageMacrocellGrid.h"
 
 #include "rendering/TextureLayout.h"
+#include "rendering/TimePointUploadRing.h"
+#include "rendering/helpers/BrickedTextureHelpers.h"
+#include "rendering/helpers/ViewRenderCacheHelpers.h"
 #include "rendering/utility/containers/VertexAttributeInfo.h"
 #include "rendering/utility/containers/VertexIndicesInfo.h"
 #include "rendering/utility/gl/GLBufferObject.h"
@@ -17,8 +21,10 @@
 
 #include <uuid.h>
 
+#include <future>
 #include <optional>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 /**
@@ -192,6 +198,51 @@ struct RenderData
   /// Distance-map textures keyed by image UID and image component.
   std::unordered_map<uuids::uuid, std::unordered_map<uint32_t, GLTexture> > m_distanceMapTextures;
 
+  /// @brief Min/max macrocells of the raycast image component, which let rays skip empty space.
+  struct Macrocells
+  {
+    ImageMacrocellGrid grid;
+
+    /// Minimum and maximum of each cell, mapped to texture intensity, in the red and green channels
+    GLTexture texture;
+  };
+
+  /// Macrocells keyed by image UID, for the component and time point that were last raycast.
+  std::unordered_map<uuids::uuid, Macrocells> m_macrocells;
+
+  /// @brief Brick pyramid and cache of an image whose texture is a pool of bricks (or flat tiles, for planar images)
+  /// paged in for the visible region.
+  struct BrickedTexture
+  {
+    rendering::bricking::BrickPyramid pyramid;
+    rendering::bricking::BrickCache cache;
+
+    uint32_t component = 0; //!< Image component held by the bricks
+    uint32_t timePoint = 0; //!< Image time point held by the bricks
+
+    /// Voxels of pyramid levels 1 and up, mapped to texture intensity, in x-fastest order.
+    /// Level 0 bricks are read from the image. Empty until the background build finishes.
+    std::vector<std::vector<float>> coarseLevels;
+
+    /// Background build of the coarse levels, which is valid until its result is moved into coarseLevels.
+  /// Destroying the texture waits for the build to finish.
+    std::future<std::vector<std::vector<float>>> futureCoarseLevels;
+
+    /// Slot and level of the finest resident brick for each level-0 brick, as 16-bit unsigned RGBA
+    GLTexture indirectionTexture;
+    bool indirectionChanged = true;
+  };
+
+  /// Bricked textures keyed by image UID, for images with TextureDimension::Bricked layouts
+  std::unordered_map<uuids::uuid, BrickedTexture> m_brickedTextures;
+
+  /// Pixel buffers that prefetch upcoming time points, keyed by UID of the image whose time playback is running
+  std::unordered_map<uuids::uuid, TimePointUploadRing> m_timePointUploadRings;
+
+  /// UIDs of streamed images whose textures still show an earlier time point, because the frame of the
+  /// active time point is being read by the image's frame cache
+  std::unordered_set<uuids::uuid> m_pendingTimePointUploads;
+
   /// Uploaded segmentation textures keyed by segmentation UID.
   std::unordered_map<uuids::uuid, GLTexture> m_segTextures;
 
@@ -445,6 +496,16 @@ struct RenderData
   /// Target frame time, in seconds, used by the manual frame-rate limiter.
   double m_targetFrameTimeSeconds = 1.0 / 60.0;
 
+  /// Whether views whose inputs are unchanged are composited from the view render cache instead of rendered.
+  bool m_useViewRenderCache = true;
+
+  /// Revision of the inputs shared by all views, such as user input, settings, and textures. Bumping it renders all
+  /// views again.
+  uint64_t m_viewRenderRevision = 0;
+
+  /// Counts of views composited from the view render cache and views rendered, since the application started.
+  rendering::view_cache::ViewRenderCacheStats m_viewRenderCacheStats;
+
   /// Global landmark rendering parameters.
   struct LandmarkParams
   {
@@ -1,11 +1,15 @@
 #include "rendering/Rendering.h"
 
+#include "common/FrameProfiler.h"
 #include "common/Types.h"
 #include "logic/app/Data.h"
 #include "logic/app/DataHelper.h"
 #include "logic/app/StackTrace.h"
 #include "logic/camera/Camera3DControls.h"
 #include "logic/camera/CameraHelpers.h"
+#include "rendering/utility/gl/GLTimestampQueries.h"
+#include "viewer/ViewModes.h"
+#include "viewer/ViewTypes.h"
 #include "windowing/View.h"
 
 #include <cmrc/cmrc.hpp>
@@ -19,10 +23,13 @@
 
 #include <chrono>
 #include <cmath>
+#include <format>
 #include <limits>
 #include <list>
+#include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 CMRC_DECLARE(fonts);
 CMRC_DECLARE(shaders);
@@ -73,6 +80,7 @@ Rendering::Rendering(AppData& appData)
   , m_nvg(nvgCreateGL3(NVG_ANTIALIAS | NVG_STENCIL_STROKES /*| NVG_DEBUG*/))
   , m_asciiRenderer(appData)
   , m_pixelEdgeRenderer()
+  , m_viewRenderCache()
   , m_raycastIsoProgram("RaycastIsoSurfaceProgram")
   , m_raycastIsoWarpedProgram("RaycastIsoSurfaceWarpedProgram")
   , m_isAppDoneLoadingImages(false)
@@ -109,10 +117,15 @@ Rendering::Rendering(AppData& appData)
   logOpenGLTextureLimits();
 
   createShaderPrograms();
+
+  // GPU spans of the frame profiler are recorded with timestamp queries of this context
+  profiling::FrameProfiler::instance().setGpuTimestampQueries(GLTimestampQueries::create());
 }
 
 Rendering::~Rendering()
 {
+  profiling::FrameProfiler::instance().setGpuTimestampQueries(nullptr);
+
   if (m_nvg) {
     nvgDeleteGL3(m_nvg);
     m_nvg = nullptr;
@@ -145,11 +158,26 @@ void Rendering::setupOpenGLState()
   //    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+void Rendering::invalidateViewRenderCache()
+{
+  ++m_appData.renderData().m_viewRenderRevision;
+}
+
+std::string Rendering::viewProfileLabel(const uuids::uuid& viewUid, const View& view) const
+{
+  return std::format(
+    "{} {} ({})",
+    to_string(view.viewType(), false),
+    typeString(view.renderMode()),
+    uuids::to_string(viewUid).substr(0, 8));
+}
+
 void Rendering::init()
 {
   nvgReset(m_nvg);
   m_asciiRenderer.init();
   m_pixelEdgeRenderer.init();
+  m_viewRenderCache.init();
 }
 
 /// @todo Need to fix this to handle multicomponent images like
@@ -246,6 +274,8 @@ void Rendering::framerateLimiter(std::chrono::time_point<Clock>& lastFrameTime)
 
 void Rendering::render()
 {
+  const profiling::GpuScope scope("Scene");
+
   // Rebuild ASCII atlas if the charset changed via the UI
   m_asciiRenderer.maybeRebuildAtlas();
 
@@ -261,6 +291,7 @@ void Rendering::render()
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
   try {
+    const profiling::CpuScope imageScope("Image data");
     renderImageData();
   }
   catch (const std::exception& e) {
@@ -269,6 +300,7 @@ void Rendering::render()
   }
 
   try {
+    const profiling::CpuScope overlayScope("Vector overlays");
     renderVectorOverlays();
   }
   catch (const std::exception& e) {
@@ -288,6 +320,9 @@ void Rendering::renderImageData()
     return;
   }
 
+  // Upload segmentation edits made since the last frame:
+  flushSegTextureUpdates();
+
   if (m_asciiRenderer.enabled()) {
     m_asciiRenderer.render(
       m_shaderPrograms,
@@ -314,8 +349,34 @@ void Rendering::renderImageData()
     return scene;
   };
 
+  beginBrickedTextureFrame();
+
+  const auto& views = m_appData.windowData().currentLayout().views();
+
+  // Animations change what views show outside of input events
+  if (m_appData.state().animating()) {
+    invalidateViewRenderCache();
+  }
+
+  // Views whose inputs are unchanged since they were last rendered are composited from the view render cache
+  bool useViewRenderCache = false;
+  if (R.m_useViewRenderCache) {
+    std::vector<glm::vec4> clipViewports;
+    for (const auto& [viewUid, view] : views) {
+      if (view) {
+        clipViewports.push_back(view->windowClipViewport());
+      }
+    }
+
+    useViewRenderCache = m_viewRenderCache.beginFrame(
+      m_appData.windowData().viewport().getDeviceAsVec4(),
+      R.m_viewRenderRevision,
+      R.m_2dBackgroundColor,
+      clipViewports);
+  }
+
   // Render images for each view in the layout
-  for (const auto& [viewUid, view] : m_appData.windowData().currentLayout().views()) {
+  for (const auto& [viewUid, view] : views) {
     if (!view) {
       continue;
     }
@@ -348,6 +409,22 @@ void Rendering::renderImageData()
     const glm::vec3 worldXhairsOffset =
       view->updateImageSlice(m_appData, m_appData.state().worldCrosshairs().worldOrigin());
 
+    if (useViewRenderCache) {
+      const ViewRenderCache::ViewRenderKey key{
+        .revision = m_viewRenderCache.frameRevision(),
+        .world_T_clip = helper::world_T_clip(view->camera()),
+        .worldOffsetXhairs = worldXhairsOffset,
+        .clipViewport = view->windowClipViewport()};
+
+      if (!m_viewRenderCache.beginView(viewUid, key, hasPendingBrickedTextures(*view))) {
+        continue;
+      }
+    }
+
+    const profiling::GpuScope viewScope("View", [&] { return viewProfileLabel(viewUid, *view); });
+
+    updateBrickedTexturesForView(*view, worldXhairsOffset);
+
     const auto miewportViewBounds =
       helper::computeMiewportFrameBounds(view->windowClipViewport(), m_appData.windowData().viewport().getAsVec4());
 
@@ -364,4 +441,9 @@ void Rendering::renderImageData()
       }
     }
   }
+
+  if (useViewRenderCache) {
+    m_viewRenderCache.endFrame(m_shaderPrograms);
+    m_appData.renderData().m_viewRenderCacheStats = m_viewRenderCache.stats();
+  }
 }
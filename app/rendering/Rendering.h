@@ -4,15 +4,18 @@
 #include "common/UuidRange.h"
 #include "logic/camera/CameraTypes.h"
 #include "rendering/PixelEdgeRenderer.h"
+#include "rendering/ViewRenderCache.h"
 #include "rendering/ascii/AsciiRenderer.h"
 #include "rendering/common/ShaderType.h"
 #include "rendering/utility/gl/GLShaderProgram.h"
 #include "rendering/utility/containers/Uniforms.h"
 
 #include <glm/fwd.hpp>
+#include <glm/vec3.hpp>
 #include <uuid.h>
 
 #include <chrono>
+#include <cstddef>
 #include <list>
 #include <memory>
 #include <optional>
@@ -33,10 +36,10 @@ struct NVGcontext;
  * @brief Top-level renderer that owns GPU resources and draws every view in the current layout.
  *
  * Rendering is the integration point between application state and the lower-level drawing helpers. It owns the
- * OpenGL shader programs, texture objects, NanoVG context, ASCII renderer, and pixel-edge renderer. Most persistent
- * render settings live in AppData/RenderData; this class translates those settings into current GPU state and issues
- * the draw calls for image slices, metrics, raycast isosurfaces, overlays, segmentations, annotations, landmarks, and
- * brush previews.
+ * OpenGL shader programs, texture objects, NanoVG context, ASCII renderer, pixel-edge renderer, and view render cache.
+ * Most persistent render settings live in AppData/RenderData; this class translates those settings into current GPU
+ * state and issues the draw calls for image slices, metrics, raycast isosurfaces, overlays, segmentations, annotations,
+ * landmarks, and brush previews.
  *
  * The class is intentionally non-copyable through its OpenGL ownership. It should be initialized after an OpenGL
  * context exists and destroyed before the context is torn down.
@@ -165,6 +168,25 @@ public:
     const glm::uvec3& sizeInVoxels,
     const int64_t* data);
 
+  /**
+   * @brief Mark a voxel subregion of a segmentation as changed in its image buffer.
+   *
+   * Marked regions of each segmentation are merged into one box and uploaded from the image buffer in
+   * its native component type by the next call to flushSegTextureUpdates(), so repeated edits between
+   * frames cost a single texture upload.
+   *
+   * @param segUid Segmentation image whose voxels changed.
+   * @param startOffsetVoxel First changed voxel.
+   * @param sizeInVoxels Size of the changed region in voxels.
+   */
+  void markSegTextureDirty(
+    const uuids::uuid& segUid,
+    const glm::uvec3& startOffsetVoxel,
+    const glm::uvec3& sizeInVoxels);
+
+  /// @brief Upload the regions of all segmentations marked as changed since the last flush. Called once per frame.
+  void flushSegTextureUpdates();
+
   /**
    * @brief Upload the current segmentation brush preview mask and metadata.
    *
@@ -245,6 +267,12 @@ public:
    */
   void setShowVectorOverlays(bool show);
 
+  /**
+   * @brief Render all views again on the next frame instead of compositing them from the view render cache. Called when
+   * anything that views depend on changes.
+   */
+  void invalidateViewRenderCache();
+
 private:
   /// Number of image slots rendered by metric and comparison shaders.
   static constexpr std::size_t NUM_METRIC_IMAGES = 2;
@@ -267,12 +295,17 @@ private:
 
   PixelEdgeRenderer m_pixelEdgeRenderer; //!< Pixel-space image-edge post-processing pipeline
 
+  ViewRenderCache m_viewRenderCache; //!< Offscreen renders of views that are reused while their inputs are unchanged
+
   /// Shader programs for the normal 3D texture rendering path, keyed by render mode and interpolation variant.
   std::unordered_map<ShaderProgramType, std::unique_ptr<GLShaderProgram>> m_shaderPrograms;
 
   /// Shader programs for planar 2D fallback textures that exceed GL_MAX_3D_TEXTURE_SIZE but fit GL_MAX_TEXTURE_SIZE.
   std::unordered_map<ShaderProgramType, std::unique_ptr<GLShaderProgram>> m_shaderPrograms2D;
 
+  /// Shader programs for images that exceed the texture limits and are paged into a brick pool.
+  std::unordered_map<ShaderProgramType, std::unique_ptr<GLShaderProgram>> m_shaderProgramsBricked;
+
   GLShaderProgram m_raycastIsoProgram; //!< Raycast isosurface shader for unwarped scalar image volumes
 
   /// Raycast isosurface shader variant that samples an inverse deformation field before sampling the scalar image.
@@ -282,6 +315,11 @@ private:
 
   bool m_showOverlays; //!< Global runtime overlay switch used by the view overlay cycling actions
 
+  /// Changed segmentation regions awaiting upload, keyed by segmentation, as min and exclusive max voxel corners.
+  std::unordered_map<uuids::uuid, std::pair<glm::uvec3, glm::uvec3>> m_dirtySegRegions;
+
+  std::vector<std::byte> m_segUploadBuffer; //!< Staging buffer reused by segmentation region uploads
+
   /// Refresh the CPU-side isosurface arrays consumed by the 3D raycast shader for one image.
   void updateIsosurfaceDataFor3d(AppData& appData, const uuids::uuid& imageUid);
 };
@@ -61,8 +61,12 @@ void Rendering::renderSegmentationForImage(
       : (renderWarped ? ShaderProgramType::SegmentationLinearWarped : ShaderProgramType::SegmentationLinear);
   const RenderData::PlanarTextureLayout segTextureLayout =
     rendering::textureLayoutOrDefault(renderData.m_segTextureLayouts, segUid);
-  GLShaderProgram& program =
-    shaderProgramForTextureDimension(m_shaderPrograms, m_shaderPrograms2D, segShaderType, segTextureLayout.dimension);
+  GLShaderProgram& program = shaderProgramForTextureDimension(
+    m_shaderPrograms,
+    m_shaderPrograms2D,
+    m_shaderProgramsBricked,
+    segShaderType,
+    segTextureLayout.dimension);
 
   const auto boundTextures = bindSegTextures(imgSegPair);
   const auto boundDefTextures =
@@ -131,6 +131,25 @@ void Rendering::createShaderPrograms()
       spdlog::error(prog2D.error());
       throwDebug(std::format("Failed to create 2D shader program {}", to_string(shaderType)));
     }
+
+    auto progBricked = createShaderProgram(
+      to_string(shaderType) + " - Bricked",
+      info.vsFileName,
+      info.fsFileName,
+      rendering::shaderReplacementsForTextureDimension(
+        info.fsReplacements,
+        RenderData::TextureDimension::Bricked,
+        setup.lookupReplacementSources),
+      info.vsUniforms,
+      info.fsUniforms);
+
+    if (progBricked) {
+      m_shaderProgramsBricked.emplace(shaderType, std::move(*progBricked));
+    }
+    else {
+      spdlog::error(progBricked.error());
+      throwDebug(std::format("Failed to create bricked shader program {}", to_string(shaderType)));
+    }
   }
 
   if (!createRaycastIsoProgram(m_raycastIsoProgram, false)) {
@@ -142,4 +161,5 @@ void Rendering::createShaderPrograms()
 
   m_asciiRenderer.registerShaderPrograms(m_shaderPrograms);
   m_pixelEdgeRenderer.registerShaderPrograms(m_shaderPrograms);
+  m_viewRenderCache.registerShaderPrograms(m_shaderPrograms);
 }
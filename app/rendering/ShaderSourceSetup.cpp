@@ -28,7 +28,8 @@ TextureLookupReplacementSources ShaderSourceSet::textureLookupReplacementSources
     .floatingPointLinear2D = textureFloatingPointLinear2D,
     .cubic3D = textureCubic3D,
     .cubic2D = textureCubic2D,
-    .uintLinear2D = uintTextureLinear2D};
+    .uintLinear2D = uintTextureLinear2D,
+    .bricked = textureBricked};
 }
 
 ShaderSourceSet buildShaderSourceSet()
@@ -47,6 +48,7 @@ ShaderSourceSet buildShaderSourceSet()
     .textureLinear2D = loadShaderFile(shaderPath + "functions/TextureLookup_Linear_2D.glsl"),
     .textureCubic2D = loadShaderFile(shaderPath + "functions/TextureLookup_Cubic_2D.glsl"),
     .uintTextureLinear2D = loadShaderFile(shaderPath + "functions/UIntTextureLookup_Linear_2D.glsl"),
+    .textureBricked = loadShaderFile(shaderPath + "functions/TextureLookup_Bricked.glsl"),
     .sampleTexCoordIdentity = loadShaderFile(shaderPath + "functions/SampleTexCoord_Identity.glsl"),
     .sampleTexCoordDeformation = loadShaderFile(shaderPath + "functions/SampleTexCoord_Deformation.glsl"),
     .metricSamplingIdentity = loadShaderFile(shaderPath + "functions/MetricSampling_Identity.glsl"),
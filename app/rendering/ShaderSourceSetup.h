@@ -26,6 +26,7 @@ struct ShaderSourceSet
   std::string textureLinear2D;
   std::string textureCubic2D;
   std::string uintTextureLinear2D;
+  std::string textureBricked;
   std::string sampleTexCoordIdentity;
   std::string sampleTexCoordDeformation;
   std::string metricSamplingIdentity;
@@ -37,7 +38,7 @@ struct ShaderSourceSet
   std::string intensityProjection;
 
   /**
-   * @brief Return the texture lookup snippets needed to specialize shaders for 2D fallback textures.
+   * @brief Return the texture lookup snippets needed to specialize shaders for 2D fallback and bricked textures.
    */
   TextureLookupReplacementSources textureLookupReplacementSources() const;
 };
@@ -9,14 +9,15 @@ namespace rendering
 enum class TextureDimension
 {
   Texture3D, //!< Texture is uploaded as GL_TEXTURE_3D
-  Texture2D  //!< Planar texture is uploaded as GL_TEXTURE_2D because it exceeds 3D texture limits
+  Texture2D, //!< Planar texture is uploaded as GL_TEXTURE_2D because it exceeds 3D texture limits
+  Bricked    //!< Image exceeds the texture limits and is paged into a GL_TEXTURE_3D pool of bricks or planar tiles
 };
 
 /**
  * @brief Texture dimensionality and axis mapping for images that may be uploaded as 2D or 3D textures.
  *
- * For 3D textures, `axes` is ignored. For 2D textures, `axes` stores the two image axes represented by the texture
- * s/t coordinates, such as (0, 1) for an XY plane or (1, 2) for a YZ plane.
+ * For 3D and bricked textures, `axes` is ignored. For 2D textures, `axes` stores the two image axes represented by the
+ * texture s/t coordinates, such as (0, 1) for an XY plane or (1, 2) for a YZ plane.
  */
 struct PlanarTextureLayout
 {
@@ -42,6 +42,8 @@ void syncScalarProjectionLayerSettings(const ImageSettings& source, ImageSetting
 
 void Rendering::updateImageInterpolation(const uuid& imageUid)
 {
+  invalidateViewRenderCache();
+
   const uuid effectiveImageUid = m_appData.effectiveImageUidForRendering(imageUid);
   const auto* image = m_appData.image(effectiveImageUid);
   const auto* sourceImage = m_appData.image(imageUid);
@@ -138,6 +140,8 @@ void Rendering::updateImageInterpolation(const uuid& imageUid)
 
 void Rendering::updateImageColorMapInterpolation(std::size_t colorMapIndex)
 {
+  invalidateViewRenderCache();
+
   const auto cmapUid = m_appData.imageColorMapUid(colorMapIndex);
   if (!cmapUid) {
     spdlog::warn("Image color map index {} is invalid", colorMapIndex);
@@ -181,6 +185,8 @@ void Rendering::updateImageColorMapInterpolation(std::size_t colorMapIndex)
 
 void Rendering::updateLabelColorTableTexture(std::size_t tableIndex)
 {
+  invalidateViewRenderCache();
+
   SPDLOG_TRACE("Begin updating texture for 1D label color map at index {}", tableIndex);
 
   if (tableIndex >= m_appData.numLabelTables()) {
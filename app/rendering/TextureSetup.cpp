@@ -1,5 +1,7 @@
 #include "rendering/TextureSetup.h"
 #include "rendering/helpers/TextureSetupHelpers.h"
+#include "common/FrameProfiler.h"
+#include "image/TimePlaybackController.h"
 #include "logic/app/Data.h"
 #include "ui/dialogs/NativeMessageDialogs.h"
 
@@ -8,6 +10,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <sstream>
 #include <unordered_set>
@@ -207,31 +210,25 @@ texture_setup::TextureLimits logTextureLimitsOnce()
 template<typename T>
 std::vector<T> copyComponentFrameValues(const Image& image, uint32_t component, uint32_t timePoint)
 {
-  std::vector<T> values;
-  values.reserve(image.header().numPixels());
-
-  for (std::size_t index = 0; index < image.header().numPixels(); ++index) {
-    const std::optional<T> value = image.value<T>(component, index, timePoint);
-    if (!value) {
-      return {};
-    }
-    values.push_back(*value);
+  const std::optional<ImageView<const T>> view = image.view<T>(component, timePoint);
+  if (!view) {
+    return {};
   }
 
+  std::vector<T> values(view->numPixels());
+  view->forEachVoxel([&values](std::size_t index, const T& value) { values[index] = value; });
   return values;
 }
 
-std::size_t flatImageIndex(const glm::uvec3& coord, const glm::uvec3& size)
-{
-  return static_cast<std::size_t>(coord.x) +
-         static_cast<std::size_t>(size.x) *
-           (static_cast<std::size_t>(coord.y) + static_cast<std::size_t>(size.y) * static_cast<std::size_t>(coord.z));
-}
-
 template<typename T>
 std::vector<T>
 copyPlanarComponentFrameValues(const Image& image, uint32_t component, uint32_t timePoint, const glm::ivec2& axes)
 {
+  const std::optional<ImageView<const T>> view = image.view<T>(component, timePoint);
+  if (!view) {
+    return {};
+  }
+
   const glm::uvec3 size = image.header().pixelDimensions();
   std::vector<T> values;
   values.reserve(static_cast<std::size_t>(size[axes.x]) * static_cast<std::size_t>(size[axes.y]));
@@ -241,11 +238,7 @@ copyPlanarComponentFrameValues(const Image& image, uint32_t component, uint32_t
     coord[axes.y] = y;
     for (uint32_t x = 0; x < size[axes.x]; ++x) {
       coord[axes.x] = x;
-      const std::optional<T> value = image.value<T>(component, flatImageIndex(coord, size), timePoint);
-      if (!value) {
-        return {};
-      }
-      values.push_back(*value);
+      values.push_back(view->at(coord.x, coord.y, coord.z));
     }
   }
 
@@ -552,6 +545,137 @@ std::vector<std::byte> copyPlanarSegValuesBytes(const Image& seg, const RenderDa
   }
 }
 
+/// Create the brick pool texture of an image that is paged in bricks, or in flat tiles if the image is planar. The pool
+/// holds texture intensities of the active component as 32-bit floats, which the bricks are uploaded into when the
+/// image is drawn.
+bool appendBrickPoolTexture(
+  std::vector<GLTexture>& componentTextures,
+  const Image& image,
+  const texture_setup::TextureLimits& textureLimits,
+  const GLTexture::PixelStoreSettings& pixelPackSettings,
+  const GLTexture::PixelStoreSettings& pixelUnpackSettings)
+{
+  static constexpr std::size_t sk_poolBudgetInBytes = std::size_t{256} << 20;
+  static constexpr GLint sk_mipmapLevel = 0;
+  static const ComponentType sk_compType = ComponentType::Float32;
+
+  const rendering::bricking::BrickPyramid pyramid(image.header().pixelDimensions());
+  const std::size_t bytesPerBrick = pyramid.storedVoxelsPerBrick() * sizeof(float);
+  const glm::uvec3 slotCounts = rendering::bricking::brickPoolSlotCounts(
+    sk_poolBudgetInBytes / bytesPerBrick, pyramid.storedSize(), textureLimits.max3DTextureSize);
+
+  if (glm::any(glm::equal(slotCounts, glm::uvec3{0u}))) {
+    return false;
+  }
+
+  const bool nearest =
+    InterpolationMode::NearestNeighbor == image.settings().interpolationMode(image.settings().activeComponent());
+
+  GLTexture& texture = componentTextures.emplace_back(
+    tex::Target::Texture3D, GLTexture::MultisampleSettings(), pixelPackSettings, pixelUnpackSettings);
+
+  texture.generate();
+  texture.setMinificationFilter(nearest ? tex::MinificationFilter::Nearest : tex::MinificationFilter::Linear);
+  texture.setMagnificationFilter(nearest ? tex::MagnificationFilter::Nearest : tex::MagnificationFilter::Linear);
+  texture.setWrapMode(tex::WrapMode::ClampToEdge);
+  texture.setAutoGenerateMipmaps(false);
+  texture.setSize(slotCounts * pyramid.storedSize());
+  texture.setData(
+    sk_mipmapLevel,
+    GLTexture::getSizedInternalNormalizedRedFormat(sk_compType),
+    GLTexture::getBufferPixelNormalizedRedFormat(sk_compType),
+    GLTexture::getBufferPixelDataType(sk_compType),
+    nullptr);
+  return true;
+}
+
+/// Upload a time point of an image whose time playback is running from the pixel buffer that prefetched it, then
+/// prefetch the time points that playback shows next. The buffers of an image are kept only while its playback runs.
+/// Returns false if the time point was not prefetched, in which case it must be uploaded directly.
+bool uploadPrefetchedTimePoint(
+  AppData& appData,
+  const uuids::uuid& imageUid,
+  const Image& image,
+  const RenderData::PlanarTextureLayout& layout,
+  std::vector<GLTexture>& textures,
+  uint32_t timePoint)
+{
+  static constexpr std::size_t sk_ringBudgetInBytes = std::size_t{512} << 20;
+  static constexpr std::size_t sk_maxRingSlots = 4;
+
+  auto& rings = appData.renderData().m_timePointUploadRings;
+  auto ringIt = rings.find(imageUid);
+
+  const ImageSettings& settings = image.settings();
+  if (!settings.timePlaybackPlaying() || RenderData::TextureDimension::Texture3D != layout.dimension) {
+    if (std::end(rings) != ringIt) {
+      spdlog::debug(
+        "Uploaded {} time points of image {} from prefetched pixel buffers; {} were not prefetched in time",
+        ringIt->second.numUploaded(),
+        imageUid,
+        ringIt->second.numMissed());
+      rings.erase(ringIt);
+    }
+    return false;
+  }
+
+  if (std::end(rings) == ringIt) {
+    const std::size_t numSlots = TimePointUploadRing::numSlotsForBudget(image, sk_ringBudgetInBytes, sk_maxRingSlots);
+    if (0 == numSlots) {
+      return false;
+    }
+
+    spdlog::debug("Prefetching time points of image {} into {} pixel buffers", imageUid, numSlots);
+    ringIt = rings.try_emplace(imageUid, std::make_shared<const Image>(image), numSlots).first;
+  }
+
+  TimePointUploadRing& ring = ringIt->second;
+  const uint32_t numTimePoints = image.timeAxis().numTimePoints();
+  const int direction = ring.lastTimePoint() ? readAheadDirection(*ring.lastTimePoint(), timePoint, numTimePoints) : 1;
+
+  const bool uploaded = ring.upload(timePoint, textures);
+
+  ring.prefetch(upcomingPlaybackTimePoints(
+    timePoint,
+    numTimePoints,
+    settings.timePlaybackLoop(),
+    settings.timePlaybackBounce(),
+    direction,
+    static_cast<uint32_t>(ring.numSlots())));
+
+  return uploaded;
+}
+
+/// State of the active time point of an image after asking for it to be made resident
+enum class TimePointResidency
+{
+  Resident, //!< The active time point is resident, or the image does not stream time points
+  Pending,  //!< The frame cache worker is reading the active time point
+  Failed    //!< Reading the active time point failed
+};
+
+/// Make the active time point of an image with streamed time points resident before its pixels are
+/// uploaded, and pick up statistics of frames summarized in the background since the last upload.
+/// Unless \p wait is set, a frame that is not cached is queued to the frame cache worker instead of
+/// being read here.
+TimePointResidency makeActiveTimePointResident(AppData& appData, const uuids::uuid& imageUid, bool wait)
+{
+  Image* image = appData.image(imageUid);
+  if (!image || !image->streamsTimePoints()) {
+    return TimePointResidency::Resident;
+  }
+
+  const uint32_t activeTimePoint = image->timeAxis().clamp(image->settings().activeTimePoint());
+  const bool resident =
+    wait ? image->setResidentTimePoint(activeTimePoint) : image->requestResidentTimePoint(activeTimePoint);
+  image->updateStreamedComponentStats();
+
+  if (resident) {
+    return TimePointResidency::Resident;
+  }
+  return image->timePointReadFailed(activeTimePoint) ? TimePointResidency::Failed : TimePointResidency::Pending;
+}
+
 } // namespace
 
 TextureCreationResult createImageTexturesWithReport(AppData& appData, const uuid_range_t& imageUids)
@@ -566,6 +690,7 @@ TextureCreationResult createImageTexturesWithReport(AppData& appData, const uuid
   //    static const glm::vec4 sk_border{ 0.0f, 0.0f, 0.0f, 0.0f }; // Black border
 
   TextureCreationResult result;
+  ++appData.renderData().m_viewRenderRevision;
 
   spdlog::debug("Begin creating 3D image textures");
   const texture_setup::TextureLimits textureLimits = logTextureLimitsOnce();
@@ -577,6 +702,10 @@ TextureCreationResult createImageTexturesWithReport(AppData& appData, const uuid
   for (const auto& imageUid : imageUids) {
     spdlog::debug("Begin creating texture(s) for components of image {}", imageUid);
 
+    // Creating textures needs the pixels of the active time point, so wait for them
+    makeActiveTimePointResident(appData, imageUid, true);
+    appData.renderData().m_pendingTimePointUploads.erase(imageUid);
+
     const auto* image = appData.image(imageUid);
     if (!image) {
       image = appData.def(imageUid);
@@ -591,12 +720,14 @@ TextureCreationResult createImageTexturesWithReport(AppData& appData, const uuid
       continue;
     }
 
+    const profiling::CpuScope scope("Create image texture", [image] { return image->settings().displayName(); });
+
     const ComponentType compType = image->header().memoryComponentType();
     const uint32_t numComp = image->header().numComponentsPerPixel();
     const uint32_t activeTimePoint = image->timeAxis().clamp(image->settings().activeTimePoint());
     const glm::uvec3 textureSize = image->header().pixelDimensions();
     const std::optional<texture_setup::TextureUploadLayout> uploadLayout =
-      texture_setup::textureUploadLayoutForImage(textureSize, textureLimits);
+      texture_setup::textureUploadLayoutForImage(textureSize, textureLimits, nullptr != appData.image(imageUid));
     if (!uploadLayout) {
       spdlog::error(
         "Image {} ('{}') has dimensions {} and cannot be uploaded as an OpenGL texture. {}",
@@ -625,67 +756,31 @@ TextureCreationResult createImageTexturesWithReport(AppData& appData, const uuid
         uploadLayout->layout.axes.y,
         glm::to_string(uploadLayout->uploadSize));
     }
+    if (RenderData::TextureDimension::Bricked == uploadLayout->layout.dimension) {
+      spdlog::info(
+        "Image {} ('{}') has dimensions {}, which exceed the texture limits; paging it into a brick pool",
+        imageUid,
+        image->settings().displayName(),
+        glm::to_string(textureSize));
+    }
 
     std::vector<GLTexture> componentTextures;
 
     try {
-      switch (image->bufferType()) {
-        case Image::MultiComponentBufferType::InterleavedImage: {
-          spdlog::debug(
-            "Image {} has {} interleaved component(s); creating one scalar texture per logical component.",
-            imageUid,
-            numComp);
-          for (uint32_t comp = 0; comp < numComp; ++comp) {
-            if (!appendDeinterleavedComponentTexture(
-                  componentTextures,
-                  *image,
-                  comp,
-                  activeTimePoint,
-                  *uploadLayout,
-                  pixelPackSettings,
-                  pixelUnpackSettings,
-                  sk_wrapModeClampToEdge))
-            {
-              spdlog::warn("Image {} could not create a scalar texture for component {}", imageUid, comp);
-              componentTextures.clear();
-              break;
-            }
-          }
-          break;
+      if (RenderData::TextureDimension::Bricked == uploadLayout->layout.dimension) {
+        if (!appendBrickPoolTexture(componentTextures, *image, textureLimits, pixelPackSettings, pixelUnpackSettings))
+        {
+          spdlog::warn("Image {} could not create a brick pool texture", imageUid);
         }
-        case Image::MultiComponentBufferType::SeparateImages: {
-          spdlog::debug(
-            "Image {} has {} separate components, so {} textures will be created.",
-            imageUid,
-            numComp,
-            numComp);
-
-          for (uint32_t comp = 0; comp < numComp; ++comp) {
-            tex::MinificationFilter minFilter = tex::MinificationFilter::Linear;
-            tex::MagnificationFilter maxFilter = tex::MagnificationFilter::Linear;
-
-            switch (image->settings().interpolationMode(comp)) {
-              case InterpolationMode::NearestNeighbor: {
-                minFilter = tex::MinificationFilter::Nearest;
-                maxFilter = tex::MagnificationFilter::Nearest;
-                break;
-              }
-              case InterpolationMode::Linear:
-              case InterpolationMode::CubicBsplineConvolution: {
-                minFilter = tex::MinificationFilter::Linear;
-                maxFilter = tex::MagnificationFilter::Linear;
-                break;
-              }
-            }
-
-            // Use Red format for each component texture:
-            const tex::SizedInternalFormat sizedInternalNormalizedFormat =
-              GLTexture::getSizedInternalNormalizedRedFormat(compType);
-
-            const tex::BufferPixelFormat bufferPixelNormalizedFormat =
-              GLTexture::getBufferPixelNormalizedRedFormat(compType);
-
-            if (RenderData::TextureDimension::Texture2D == uploadLayout->layout.dimension) {
+      }
+      else {
+        switch (image->bufferType()) {
+          case Image::MultiComponentBufferType::InterleavedImage: {
+            spdlog::debug(
+              "Image {} has {} interleaved component(s); creating one scalar texture per logical component.",
+              imageUid,
+              numComp);
+            for (uint32_t comp = 0; comp < numComp; ++comp) {
               if (!appendDeinterleavedComponentTexture(
                     componentTextures,
                     *image,
@@ -696,46 +791,97 @@ TextureCreationResult createImageTexturesWithReport(AppData& appData, const uuid
                     pixelUnpackSettings,
                     sk_wrapModeClampToEdge))
               {
-                spdlog::warn("Image {} could not create a planar scalar texture for component {}", imageUid, comp);
+                spdlog::warn("Image {} could not create a scalar texture for component {}", imageUid, comp);
                 componentTextures.clear();
                 break;
               }
             }
-            else {
-              GLTexture& T = componentTextures.emplace_back(
-                tex::Target::Texture3D,
-                GLTexture::MultisampleSettings(),
-                pixelPackSettings,
-                pixelUnpackSettings);
-
-              T.generate();
-              T.setMinificationFilter(minFilter);
-              T.setMagnificationFilter(maxFilter);
-              //                T.setBorderColor( sk_border );
-              T.setWrapMode(sk_wrapModeClampToEdge);
-              T.setAutoGenerateMipmaps(false); // no mipmapping for images
-              T.setSize(textureSize);
-
-              const void* imageBuffer = image->bufferAsVoid(comp, activeTimePoint);
-              if (!imageBuffer) {
-                spdlog::warn("Image {} has no texture data for component {}", imageUid, comp);
-                componentTextures.clear();
-                break;
+            break;
+          }
+          case Image::MultiComponentBufferType::SeparateImages: {
+            spdlog::debug(
+              "Image {} has {} separate components, so {} textures will be created.",
+              imageUid,
+              numComp,
+              numComp);
+
+            for (uint32_t comp = 0; comp < numComp; ++comp) {
+              tex::MinificationFilter minFilter = tex::MinificationFilter::Linear;
+              tex::MagnificationFilter maxFilter = tex::MagnificationFilter::Linear;
+
+              switch (image->settings().interpolationMode(comp)) {
+                case InterpolationMode::NearestNeighbor: {
+                  minFilter = tex::MinificationFilter::Nearest;
+                  maxFilter = tex::MagnificationFilter::Nearest;
+                  break;
+                }
+                case InterpolationMode::Linear:
+                case InterpolationMode::CubicBsplineConvolution: {
+                  minFilter = tex::MinificationFilter::Linear;
+                  maxFilter = tex::MagnificationFilter::Linear;
+                  break;
+                }
               }
 
-              T.setData(
-                sk_mipmapLevel,
-                sizedInternalNormalizedFormat,
-                bufferPixelNormalizedFormat,
-                GLTexture::getBufferPixelDataType(compType),
-                imageBuffer);
+              // Use Red format for each component texture:
+              const tex::SizedInternalFormat sizedInternalNormalizedFormat =
+                GLTexture::getSizedInternalNormalizedRedFormat(compType);
+
+              const tex::BufferPixelFormat bufferPixelNormalizedFormat =
+                GLTexture::getBufferPixelNormalizedRedFormat(compType);
+
+              if (RenderData::TextureDimension::Texture2D == uploadLayout->layout.dimension) {
+                if (!appendDeinterleavedComponentTexture(
+                      componentTextures,
+                      *image,
+                      comp,
+                      activeTimePoint,
+                      *uploadLayout,
+                      pixelPackSettings,
+                      pixelUnpackSettings,
+                      sk_wrapModeClampToEdge))
+                {
+                  spdlog::warn("Image {} could not create a planar scalar texture for component {}", imageUid, comp);
+                  componentTextures.clear();
+                  break;
+                }
+              }
+              else {
+                GLTexture& T = componentTextures.emplace_back(
+                  tex::Target::Texture3D,
+                  GLTexture::MultisampleSettings(),
+                  pixelPackSettings,
+                  pixelUnpackSettings);
+
+                T.generate();
+                T.setMinificationFilter(minFilter);
+                T.setMagnificationFilter(maxFilter);
+                //                T.setBorderColor( sk_border );
+                T.setWrapMode(sk_wrapModeClampToEdge);
+                T.setAutoGenerateMipmaps(false); // no mipmapping for images
+                T.setSize(textureSize);
+
+                const void* imageBuffer = image->bufferAsVoid(comp, activeTimePoint);
+                if (!imageBuffer) {
+                  spdlog::warn("Image {} has no texture data for component {}", imageUid, comp);
+                  componentTextures.clear();
+                  break;
+                }
+
+                T.setData(
+                  sk_mipmapLevel,
+                  sizedInternalNormalizedFormat,
+                  bufferPixelNormalizedFormat,
+                  GLTexture::getBufferPixelDataType(compType),
+                  imageBuffer);
+              }
             }
-          }
 
-          spdlog::debug("Done creating {} image component textures", componentTextures.size());
-          break;
-        }
-      } // end switch ( image->bufferType() )
+            spdlog::debug("Done creating {} image component textures", componentTextures.size());
+            break;
+          }
+        } // end switch ( image->bufferType() )
+      }
     }
     catch (const std::exception& e) {
       spdlog::error("Image {} ('{}') texture upload failed: {}", imageUid, image->settings().displayName(), e.what());
@@ -755,6 +901,9 @@ TextureCreationResult createImageTexturesWithReport(AppData& appData, const uuid
     }
 
     appData.renderData().m_imageTextures.emplace(imageUid, std::move(componentTextures));
+    appData.renderData().m_macrocells.erase(imageUid);
+    appData.renderData().m_brickedTextures.erase(imageUid);
+    appData.renderData().m_timePointUploadRings.erase(imageUid);
     appData.renderData().m_imageTextureLayouts[imageUid] = uploadLayout->layout;
 
     result.createdUids.push_back(imageUid);
@@ -776,6 +925,22 @@ std::vector<uuids::uuid> createImageTextures(AppData& appData, const uuid_range_
 
 bool refreshImageTexturesForActiveTimePoint(AppData& appData, const uuids::uuid& imageUid)
 {
+  RenderData& R = appData.renderData();
+  R.m_pendingTimePointUploads.erase(imageUid);
+
+  // Until the frame cache worker reads a streamed frame, the textures keep the last resident frame
+  const TimePointResidency residency = makeActiveTimePointResident(appData, imageUid, false);
+  if (TimePointResidency::Failed == residency) {
+    spdlog::error("Could not read the active time point of image {}; its textures are not refreshed", imageUid);
+    return false;
+  }
+
+  const bool activeTimePointResident = (TimePointResidency::Resident == residency);
+  const auto deferUpload = [&R, &imageUid]() {
+    R.m_pendingTimePointUploads.insert(imageUid);
+    return false;
+  };
+
   const Image* image = appData.image(imageUid);
   if (!image) {
     image = appData.def(imageUid);
@@ -786,7 +951,8 @@ bool refreshImageTexturesForActiveTimePoint(AppData& appData, const uuids::uuid&
 
   const texture_setup::TextureLimits textureLimits = logTextureLimitsOnce();
   const std::optional<TextureUploadLayout> uploadLayout =
-    texture_setup::textureUploadLayoutForImage(image->header().pixelDimensions(), textureLimits);
+    texture_setup::textureUploadLayoutForImage(
+      image->header().pixelDimensions(), textureLimits, nullptr != appData.image(imageUid));
   if (!uploadLayout) {
     appData.renderData().m_imageTextures.erase(imageUid);
     appData.renderData().m_imageTextureLayouts.erase(imageUid);
@@ -801,11 +967,28 @@ bool refreshImageTexturesForActiveTimePoint(AppData& appData, const uuids::uuid&
     layoutIt != std::end(appData.renderData().m_imageTextureLayouts) &&
     layoutIt->second.dimension == uploadLayout->layout.dimension &&
     layoutIt->second.axes == uploadLayout->layout.axes &&
+    RenderData::TextureDimension::Bricked != uploadLayout->layout.dimension &&
     textureIt->second.size() == image->header().numComponentsPerPixel() &&
     std::all_of(textureIt->second.begin(), textureIt->second.end(), [&uploadLayout](const GLTexture& texture) {
       return texture.size() == uploadLayout->uploadSize;
     });
 
+  if (
+    RenderData::TextureDimension::Bricked == uploadLayout->layout.dimension &&
+    textureIt != std::end(appData.renderData().m_imageTextures) &&
+    layoutIt != std::end(appData.renderData().m_imageTextureLayouts) &&
+    RenderData::TextureDimension::Bricked == layoutIt->second.dimension)
+  {
+    if (!activeTimePointResident) {
+      return deferUpload();
+    }
+
+    // Bricks of the active time point are paged into the existing pool when the image is next drawn
+    ++R.m_viewRenderRevision;
+    appData.renderData().m_brickedTextures.erase(imageUid);
+    return true;
+  }
+
   if (!canUpdateExisting) {
     appData.renderData().m_imageTextures.erase(imageUid);
     appData.renderData().m_imageTextureLayouts.erase(imageUid);
@@ -815,6 +998,17 @@ bool refreshImageTexturesForActiveTimePoint(AppData& appData, const uuids::uuid&
 
   const uint32_t activeTimePoint = image->timeAxis().clamp(image->settings().activeTimePoint());
   std::vector<GLTexture>& textures = textureIt->second;
+  if (uploadPrefetchedTimePoint(appData, imageUid, *image, layoutIt->second, textures, activeTimePoint)) {
+    ++R.m_viewRenderRevision;
+    return true;
+  }
+
+  if (!activeTimePointResident) {
+    return deferUpload();
+  }
+
+  ++R.m_viewRenderRevision;
+
   for (uint32_t component = 0; component < image->header().numComponentsPerPixel(); ++component) {
     if (!uploadActiveTimePointToExistingTexture(
           textures.at(component),
@@ -834,6 +1028,22 @@ bool refreshImageTexturesForActiveTimePoint(AppData& appData, const uuids::uuid&
   return true;
 }
 
+void refreshPendingTimePointTextures(AppData& appData)
+{
+  if (appData.renderData().m_pendingTimePointUploads.empty()) {
+    return;
+  }
+
+  // Refreshing removes each image from the pending set and adds it back if its frame is still being read
+  const std::vector<uuids::uuid> pendingUids(
+    std::begin(appData.renderData().m_pendingTimePointUploads),
+    std::end(appData.renderData().m_pendingTimePointUploads));
+
+  for (const uuids::uuid& imageUid : pendingUids) {
+    refreshImageTexturesForActiveTimePoint(appData, imageUid);
+  }
+}
+
 std::unordered_map<uuids::uuid, std::unordered_map<uint32_t, GLTexture>> createDistanceMapTextures(
   const AppData& appData)
 {
@@ -963,6 +1173,7 @@ TextureCreationResult createSegTexturesWithReport(AppData& appData, const uuid_r
   std::unordered_map<uuids::uuid, GLTexture> textures;
 
   TextureCreationResult result;
+  ++appData.renderData().m_viewRenderRevision;
 
   spdlog::debug("Begin creating 3D segmentation textures");
   const texture_setup::TextureLimits textureLimits = logTextureLimitsOnce();
@@ -984,10 +1195,12 @@ TextureCreationResult createSegTexturesWithReport(AppData& appData, const uuid_r
       continue;
     }
 
+    const profiling::CpuScope scope("Create segmentation texture", [seg] { return seg->settings().displayName(); });
+
     const ComponentType compType = seg->header().memoryComponentType();
     const glm::uvec3 textureSize = seg->header().pixelDimensions();
     const std::optional<texture_setup::TextureUploadLayout> uploadLayout =
-      texture_setup::textureUploadLayoutForImage(textureSize, textureLimits);
+      texture_setup::textureUploadLayoutForImage(textureSize, textureLimits, nullptr != appData.image(imageUid));
     if (!uploadLayout) {
       spdlog::error(
         "Segmentation {} ('{}') has dimensions {} and cannot be uploaded as an OpenGL texture. {}",
@@ -68,12 +68,25 @@ std::vector<uuids::uuid> createImageTextures(AppData& appData, const uuid_range_
  * This avoids reallocating texture storage for compatible time-series updates. If the existing texture is missing or no
  * longer compatible with the image data, the function falls back to recreating the image textures.
  *
+ * For images with streamed time points, a frame that is not cached is read by the frame cache worker
+ * rather than on the calling thread. The textures keep showing the last resident frame, and the image
+ * is marked as pending until refreshPendingTimePointTextures() finds its frame read. When the worker's
+ * read fails, the frame is read once more on the calling thread. If that fails too, the error is
+ * logged and the image is no longer pending.
+ *
  * @param appData Application data containing images and render data.
  * @param imageUid Image UID whose active time point should be uploaded.
  * @return True when a compatible texture was refreshed or recreated successfully.
  */
 bool refreshImageTexturesForActiveTimePoint(AppData& appData, const uuids::uuid& imageUid);
 
+/**
+ * @brief Upload the active time points of streamed images whose frames have been read since their
+ * textures were last refreshed. Call once per frame.
+ * @param appData Application data containing images and render data.
+ */
+void refreshPendingTimePointTextures(AppData& appData);
+
 /**
  * @brief Create or recreate segmentation textures and report failures without showing user prompts.
  * @param appData Application data containing segmentations and render data.
@@ -1,6 +1,7 @@
 #include "rendering/Rendering.h"
 
 #include "common/Exception.hpp"
+#include "common/FrameProfiler.h"
 #include "common/MathFuncs.h"
 #include "common/Types.h"
 #include "common/UuidRange.h"
@@ -38,6 +39,8 @@ using namespace uuids;
 
 void Rendering::initTextures()
 {
+  invalidateViewRenderCache();
+
   m_appData.renderData().m_labelBufferTextures = createLabelColorTableTextures(m_appData);
 
   if (m_appData.renderData().m_labelBufferTextures.empty()) {
@@ -93,6 +96,8 @@ void Rendering::initTextures()
 
 bool Rendering::createLabelColorTableTexture(const uuid& labelTableUid)
 {
+  invalidateViewRenderCache();
+
   // static const glm::vec4 sk_border{ 0.0f, 0.0f, 0.0f, 0.0f };
 
   const auto* table = m_appData.labelTable(labelTableUid);
@@ -133,6 +138,8 @@ bool Rendering::createLabelColorTableTexture(const uuid& labelTableUid)
 
 bool Rendering::removeSegTexture(const uuid& segUid)
 {
+  invalidateViewRenderCache();
+
   const auto* seg = m_appData.seg(segUid);
   if (!seg) {
     spdlog::warn("Segmentation {} is invalid", segUid);
@@ -148,6 +155,7 @@ bool Rendering::removeSegTexture(const uuid& segUid)
 
   m_appData.renderData().m_segTextures.erase(it);
   m_appData.renderData().m_segTextureLayouts.erase(segUid);
+  m_dirtySegRegions.erase(segUid);
   return true;
 }
 
@@ -158,6 +166,8 @@ void Rendering::updateSegTexture(
   const glm::uvec3& sizeInVoxels,
   const void* data)
 {
+  invalidateViewRenderCache();
+
   // Load seg data into first mipmap level
   static constexpr GLint sk_mipmapLevel = 0;
 
@@ -184,6 +194,8 @@ void Rendering::updateSegTexture(
     return;
   }
 
+  const profiling::CpuScope scope("Upload segmentation texture", [seg] { return seg->settings().displayName(); });
+
   GLTexture& T = it->second;
   T.setSubData(
     sk_mipmapLevel,
@@ -253,6 +265,82 @@ void Rendering::updateSegTextureWithInt64Data(
   }
 }
 
+void Rendering::markSegTextureDirty(
+  const uuid& segUid,
+  const glm::uvec3& startOffsetVoxel,
+  const glm::uvec3& sizeInVoxels)
+{
+  invalidateViewRenderCache();
+
+  if (glm::any(glm::equal(sizeInVoxels, glm::uvec3{0}))) {
+    return;
+  }
+
+  const glm::uvec3 endVoxel = startOffsetVoxel + sizeInVoxels;
+  const auto [it, inserted] = m_dirtySegRegions.try_emplace(segUid, startOffsetVoxel, endVoxel);
+  if (!inserted) {
+    it->second.first = glm::min(it->second.first, startOffsetVoxel);
+    it->second.second = glm::max(it->second.second, endVoxel);
+  }
+}
+
+void Rendering::flushSegTextureUpdates()
+{
+  static constexpr uint32_t sk_comp = 0;
+
+  if (m_dirtySegRegions.empty()) {
+    return;
+  }
+
+  const profiling::CpuScope scope("Flush segmentation edits");
+
+  for (const auto& [segUid, region] : m_dirtySegRegions) {
+    const Image* seg = m_appData.seg(segUid);
+    if (!seg) {
+      continue;
+    }
+
+    const glm::uvec3 dims = seg->header().pixelDimensions();
+    const glm::uvec3 offset = glm::min(region.first, dims);
+    const glm::uvec3 size = glm::min(region.second, dims) - offset;
+    if (glm::any(glm::equal(size, glm::uvec3{0}))) {
+      continue;
+    }
+
+    const auto* buffer = static_cast<const std::byte*>(seg->bufferAsVoid(sk_comp));
+    if (!buffer) {
+      continue;
+    }
+
+    const ComponentType compType = seg->header().memoryComponentType();
+    const std::size_t voxelBytes = seg->header().memoryComponentSizeInBytes();
+    const std::size_t rowBytes = voxelBytes * dims.x;
+    const std::size_t sliceBytes = rowBytes * dims.y;
+    const std::size_t first = offset.z * sliceBytes + offset.y * rowBytes + offset.x * voxelBytes;
+
+    // Regions of whole rows spanning whole slices (or a single slice) are contiguous in the image buffer:
+    if (size.x == dims.x && (size.y == dims.y || 1 == size.z)) {
+      updateSegTexture(segUid, compType, offset, size, buffer + first);
+      continue;
+    }
+
+    const std::size_t regionRowBytes = voxelBytes * size.x;
+    m_segUploadBuffer.resize(regionRowBytes * size.y * size.z);
+
+    std::byte* dst = m_segUploadBuffer.data();
+    for (uint32_t k = 0; k < size.z; ++k) {
+      const std::byte* src = buffer + first + k * sliceBytes;
+      for (uint32_t j = 0; j < size.y; ++j, src += rowBytes, dst += regionRowBytes) {
+        std::copy_n(src, regionRowBytes, dst);
+      }
+    }
+
+    updateSegTexture(segUid, compType, offset, size, m_segUploadBuffer.data());
+  }
+
+  m_dirtySegRegions.clear();
+}
+
 void Rendering::updateBrushPreviewTexture(
   const uuid& imageUid,
   const uuid& segUid,
@@ -263,6 +351,8 @@ void Rendering::updateBrushPreviewTexture(
   bool allowFill,
   const int64_t* data)
 {
+  invalidateViewRenderCache();
+
   if (!data || glm::any(glm::lessThanEqual(sizeInVoxels, glm::uvec3{0}))) {
     return;
   }
@@ -343,11 +433,14 @@ void Rendering::updateBrushPreviewTexture(
 
 void Rendering::clearBrushPreviewTextures()
 {
+  invalidateViewRenderCache();
   m_appData.renderData().m_brushPreviews.clear();
 }
 
 void Rendering::hideBrushPreviewTextures()
 {
+  invalidateViewRenderCache();
+
   for (auto& entry : m_appData.renderData().m_brushPreviews) {
     entry.second.visible = false;
   }
@@ -361,6 +454,8 @@ void Rendering::updateImageTexture(
   const glm::uvec3& sizeInVoxels,
   const void* data)
 {
+  invalidateViewRenderCache();
+
   // Load data into first mipmap level
   static constexpr GLint sk_mipmapLevel = 0;
 
@@ -370,6 +465,18 @@ void Rendering::updateImageTexture(
     return;
   }
 
+  if (
+    RenderData::TextureDimension::Bricked ==
+    rendering::textureLayoutOrDefault(m_appData.renderData().m_imageTextureLayouts, imageUid).dimension)
+  {
+    // Rebuild the pyramid and page the bricks in again the next time the image is drawn
+    m_appData.renderData().m_brickedTextures.erase(imageUid);
+    return;
+  }
+
+  // Prefetched time points hold pixels from before the edit
+  m_appData.renderData().m_timePointUploadRings.erase(imageUid);
+
   std::vector<GLTexture>& T = it->second;
   if (component >= T.size()) {
     spdlog::error("Cannot update invalid component {} of image {}", component, imageUid);
@@ -393,6 +500,8 @@ void Rendering::updateImageTexture(
     return;
   }
 
+  const profiling::CpuScope scope("Upload image texture", [img] { return img->settings().displayName(); });
+
   T.at(component).setSubData(
     sk_mipmapLevel,
     startOffsetVoxel,
@@ -400,4 +509,6 @@ void Rendering::updateImageTexture(
     GLTexture::getBufferPixelRedFormat(compType),
     GLTexture::getBufferPixelDataType(compType),
     data);
+
+  updateMacrocells(imageUid, component, startOffsetVoxel, sizeInVoxels);
 }
@@ -0,0 +1,224 @@
+#include "rendering/TimePointUploadRing.h"
+
+#include "common/FrameProfiler.h"
+#include "image/Image.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <utility>
+
+namespace
+{
+
+/// Copy all components of a time point into a mapped pixel buffer. Runs on a worker thread.
+bool fillTimePoint(std::shared_ptr<const Image> image, uint32_t timePoint, void* mapped, std::size_t componentSize)
+{
+  const profiling::CpuScope scope("Read time point", [timePoint] { return std::to_string(timePoint); });
+
+  // Streamed images hold only their resident frame, so read the time point into a copy of the image
+  std::optional<Image> residentImage;
+  const Image* source = image.get();
+
+  if (image->streamsTimePoints()) {
+    residentImage.emplace(*image);
+    if (!residentImage->setResidentTimePoint(timePoint)) {
+      return false;
+    }
+    source = &(*residentImage);
+  }
+
+  for (uint32_t comp = 0; comp < source->header().numComponentsPerPixel(); ++comp) {
+    const void* data = source->bufferAsVoid(comp, timePoint);
+    if (!data) {
+      return false;
+    }
+    std::memcpy(static_cast<std::byte*>(mapped) + comp * componentSize, data, componentSize);
+  }
+
+  return true;
+}
+
+bool isFillDone(const std::future<bool>& fill)
+{
+  using namespace std::chrono_literals;
+  return !fill.valid() || std::future_status::ready == fill.wait_for(0ms);
+}
+
+} // namespace
+
+TimePointUploadRing::TimePointUploadRing(std::shared_ptr<const Image> image, std::size_t numSlots)
+  : m_image(std::move(image))
+  , m_componentSizeInBytes(
+      static_cast<std::size_t>(m_image->header().numPixels()) * m_image->header().memoryComponentSizeInBytes())
+{
+  const std::size_t bufferSize = m_componentSizeInBytes * m_image->header().numComponentsPerPixel();
+
+  m_slots.reserve(numSlots);
+  for (std::size_t i = 0; i < numSlots; ++i) {
+    Slot& slot = m_slots.emplace_back(Slot{
+      .buffer = GLBufferObject(BufferType::PixelUnpack, BufferUsagePattern::StreamDraw),
+      .mapped = nullptr,
+      .timePoint = std::nullopt,
+      .fill = {}});
+
+    slot.buffer.generate();
+    slot.buffer.allocate(bufferSize, nullptr);
+  }
+}
+
+std::size_t TimePointUploadRing::numSlotsForBudget(
+  const Image& image,
+  std::size_t budgetInBytes,
+  std::size_t maxSlots)
+{
+  if (
+    !image.isTimeSeries() || Image::MultiComponentBufferType::SeparateImages != image.bufferType() ||
+    0 == image.header().numPixels())
+  {
+    return 0;
+  }
+
+  const std::size_t bufferSize = static_cast<std::size_t>(image.header().numPixels()) *
+                                 image.header().memoryComponentSizeInBytes() * image.header().numComponentsPerPixel();
+
+  const std::size_t numSlots = std::min(maxSlots, budgetInBytes / bufferSize);
+  return (numSlots < 2) ? 0 : numSlots;
+}
+
+bool TimePointUploadRing::upload(uint32_t timePoint, std::vector<GLTexture>& textures)
+{
+  static constexpr GLint sk_mipmapLevel = 0;
+
+  m_lastTimePoint = timePoint;
+
+  const auto slotIt = std::ranges::find_if(m_slots, [timePoint](const Slot& slot) {
+    return slot.timePoint == timePoint;
+  });
+
+  if (std::end(m_slots) == slotIt) {
+    ++m_numMissed;
+    return false;
+  }
+
+  Slot& slot = *slotIt;
+  slot.timePoint = std::nullopt;
+
+  bool filled = false;
+  try {
+    filled = slot.fill.valid() && slot.fill.get();
+  }
+  catch (const std::exception& e) {
+    spdlog::error("Exception reading time point {} into a pixel buffer: {}", timePoint, e.what());
+  }
+
+  const ComponentType compType = m_image->header().memoryComponentType();
+  const uint32_t numComps = m_image->header().numComponentsPerPixel();
+
+  const bool texturesMatch =
+    textures.size() == numComps && std::ranges::all_of(textures, [this](const GLTexture& texture) {
+      const glm::uvec3 size = texture.size();
+      return static_cast<std::size_t>(size.x) * size.y * size.z * m_image->header().memoryComponentSizeInBytes() ==
+             m_componentSizeInBytes;
+    });
+
+  if (!filled || !texturesMatch) {
+    // Keep the buffer mapped for the next fill
+    ++m_numMissed;
+    return false;
+  }
+
+  slot.buffer.bind();
+  const bool unmapped = slot.buffer.unmap();
+  slot.mapped = nullptr;
+
+  if (!unmapped) {
+    // The contents of the buffer were lost while it was mapped
+    slot.buffer.unbind();
+    ++m_numMissed;
+    return false;
+  }
+
+  const profiling::CpuScope scope("Upload time point", [timePoint] { return std::to_string(timePoint); });
+
+  // With a pixel unpack buffer bound, texture data pointers are byte offsets into the buffer
+  for (uint32_t comp = 0; comp < numComps; ++comp) {
+    textures[comp].setSubData(
+      sk_mipmapLevel,
+      glm::uvec3{0u},
+      textures[comp].size(),
+      GLTexture::getBufferPixelNormalizedRedFormat(compType),
+      GLTexture::getBufferPixelDataType(compType),
+      reinterpret_cast<const GLvoid*>(comp * m_componentSizeInBytes));
+  }
+
+  slot.buffer.unbind();
+  ++m_numUploaded;
+  return true;
+}
+
+void TimePointUploadRing::prefetch(const std::vector<uint32_t>& timePoints)
+{
+  // Release the buffers of time points that are no longer upcoming, once their fills finish
+  for (Slot& slot : m_slots) {
+    const bool upcoming = slot.timePoint && std::ranges::find(timePoints, *slot.timePoint) != std::end(timePoints);
+    if (slot.timePoint && !upcoming && isFillDone(slot.fill)) {
+      slot.timePoint = std::nullopt;
+    }
+  }
+
+  for (const uint32_t timePoint : timePoints) {
+    if (std::ranges::any_of(m_slots, [timePoint](const Slot& slot) { return slot.timePoint == timePoint; })) {
+      continue;
+    }
+
+    const auto freeIt = std::ranges::find_if(m_slots, [](const Slot& slot) { return !slot.timePoint; });
+    if (std::end(m_slots) == freeIt) {
+      break;
+    }
+
+    Slot& slot = *freeIt;
+    if (!slot.mapped) {
+      // Invalidating the buffer lets the driver hand out new storage while uploads from the old storage are pending
+      slot.buffer.bind();
+      slot.mapped = slot.buffer.mapRange(
+        0,
+        static_cast<GLsizeiptr>(slot.buffer.size()),
+        {BufferMapRangeAccessFlag::MapWriteBit, BufferMapRangeAccessFlag::InvalidateBufferBit});
+      slot.buffer.unbind();
+
+      if (!slot.mapped) {
+        spdlog::warn("Unable to map a pixel buffer to prefetch time point {}", timePoint);
+        break;
+      }
+    }
+
+    slot.timePoint = timePoint;
+    slot.fill = std::async(std::launch::async, fillTimePoint, m_image, timePoint, slot.mapped, m_componentSizeInBytes);
+  }
+}
+
+std::optional<uint32_t> TimePointUploadRing::lastTimePoint() const
+{
+  return m_lastTimePoint;
+}
+
+std::size_t TimePointUploadRing::numSlots() const
+{
+  return m_slots.size();
+}
+
+uint64_t TimePointUploadRing::numUploaded() const
+{
+  return m_numUploaded;
+}
+
+uint64_t TimePointUploadRing::numMissed() const
+{
+  return m_numMissed;
+}
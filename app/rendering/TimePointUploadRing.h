@@ -0,0 +1,81 @@
+#pragma once
+
+#include "rendering/utility/gl/GLBufferObject.h"
+#include "rendering/utility/gl/GLTexture.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <optional>
+#include <vector>
+
+class Image;
+
+/**
+ * @brief Ring of pixel unpack buffers that stream the time points of a 4D image into its component textures.
+ *
+ * Worker threads copy the pixels of upcoming time points into mapped buffers, so that showing a prefetched time point
+ * only unmaps its buffer and issues the buffer-to-texture copies on the render thread. Each buffer holds all components
+ * of one time point. Buffers are mapped and unmapped on the render thread, which must have the GL context current.
+ *
+ * Only images whose components are held in separate buffers and uploaded whole into 3D textures can be streamed.
+ */
+class TimePointUploadRing
+{
+public:
+  /**
+   * @param image Copy of the image that buffers are filled from. Copies share pixel buffers with the original, so this
+   * holds no pixels of its own. It is read by the worker threads and must not be modified.
+   * @param numSlots Number of buffers in the ring.
+   */
+  TimePointUploadRing(std::shared_ptr<const Image> image, std::size_t numSlots);
+
+  /**
+   * @brief Number of buffers that fit in a memory budget.
+   * @return Up to \p maxSlots, or zero if the image cannot be streamed or fewer than two buffers fit.
+   */
+  static std::size_t numSlotsForBudget(const Image& image, std::size_t budgetInBytes, std::size_t maxSlots);
+
+  /**
+   * @brief Upload a prefetched time point from its buffer into the component textures, waiting for the buffer to be
+   * filled if that is still in progress.
+   * @param timePoint Time point to upload.
+   * @param textures Textures of the image components, sized to the image.
+   * @return True if the time point was uploaded; false if it was not prefetched or could not be read.
+   */
+  bool upload(uint32_t timePoint, std::vector<GLTexture>& textures);
+
+  /**
+   * @brief Fill free buffers with upcoming time points in the background. Buffers that hold time points which are no
+   * longer upcoming are reused once they are filled.
+   * @param timePoints Upcoming time points, in the order that they will be shown.
+   */
+  void prefetch(const std::vector<uint32_t>& timePoints);
+
+  /// Time point that was last uploaded or requested
+  std::optional<uint32_t> lastTimePoint() const;
+
+  std::size_t numSlots() const;
+  uint64_t numUploaded() const; //!< Time points uploaded from the buffers
+  uint64_t numMissed() const;   //!< Requested time points that were not uploaded from the buffers
+
+private:
+  struct Slot
+  {
+    // The fill is declared after the buffer, so that it is destroyed first, waiting for the worker to stop writing
+    // into the mapped buffer before the buffer is deleted
+    GLBufferObject buffer;
+    void* mapped = nullptr;            //!< Client pointer to the mapped buffer, or null when unmapped
+    std::optional<uint32_t> timePoint; //!< Time point that the buffer holds or is being filled with
+    std::future<bool> fill;            //!< Background copy of the time point into the mapped buffer
+  };
+
+  std::shared_ptr<const Image> m_image;
+  std::size_t m_componentSizeInBytes = 0; //!< Bytes of one component of one time point
+  std::vector<Slot> m_slots;
+
+  std::optional<uint32_t> m_lastTimePoint;
+  uint64_t m_numUploaded = 0;
+  uint64_t m_numMissed = 0;
+};
@@ -56,6 +56,11 @@ void Rendering::renderVectorWarpedGridOverlaysForView(
     const ImageSettings& settings = image->settings();
     const RenderData::PlanarTextureLayout imageTextureLayout =
       rendering::textureLayoutOrDefault(R.m_imageTextureLayouts, ImgSegPair{imageUid, std::nullopt}.first);
+    if (RenderData::TextureDimension::Bricked == imageTextureLayout.dimension) {
+      isFixedImage = false;
+      continue; // Bricks hold only the active component
+    }
+
     GLShaderProgram* program = nullptr;
     switch (settings.colorInterpolationMode()) {
       case InterpolationMode::NearestNeighbor:
@@ -63,6 +68,7 @@ void Rendering::renderVectorWarpedGridOverlaysForView(
         program = &rendering::shaderProgramForTextureDimension(
           m_shaderPrograms,
           m_shaderPrograms2D,
+          m_shaderProgramsBricked,
           ShaderProgramType::VectorWarpedGridLinear,
           imageTextureLayout.dimension);
         break;
@@ -70,6 +76,7 @@ void Rendering::renderVectorWarpedGridOverlaysForView(
         program = &rendering::shaderProgramForTextureDimension(
           m_shaderPrograms,
           m_shaderPrograms2D,
+          m_shaderProgramsBricked,
           ShaderProgramType::VectorWarpedGridCubic,
           imageTextureLayout.dimension);
         break;
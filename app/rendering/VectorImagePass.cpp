@@ -78,6 +78,7 @@ void Rendering::renderVectorImageForImage(
       program = &shaderProgramForTextureDimension(
         m_shaderPrograms,
         m_shaderPrograms2D,
+        m_shaderProgramsBricked,
         vectorShaderType(InterpolationMode::Linear),
         imageTextureLayout.dimension);
       break;
@@ -86,6 +87,7 @@ void Rendering::renderVectorImageForImage(
       program = &shaderProgramForTextureDimension(
         m_shaderPrograms,
         m_shaderPrograms2D,
+        m_shaderProgramsBricked,
         vectorShaderType(InterpolationMode::CubicBsplineConvolution),
         imageTextureLayout.dimension);
       break;
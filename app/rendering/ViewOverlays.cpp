@@ -1,5 +1,6 @@
 #include "rendering/Rendering.h"
 
+#include "common/FrameProfiler.h"
 #include "common/MathFuncs.h"
 #include "logic/app/Data.h"
 #include "logic/app/DataHelper.h"
@@ -176,6 +177,8 @@ void Rendering::renderVectorOverlays()
       continue;
     }
 
+    const profiling::CpuScope viewScope("View overlays", [&] { return viewProfileLabel(viewUid, *view); });
+
     // Bounds of the view frame in Miewport space:
     const auto miewportViewBounds =
       helper::computeMiewportFrameBounds(view->windowClipViewport(), windowVP.getAsVec4());
@@ -313,6 +316,8 @@ void Rendering::renderVectorOverlays()
 
   drawWindowOutline(m_nvg, windowVP);
 
+  // NanoVG issues all of its draw calls when the frame ends
+  const profiling::GpuScope flushScope("NanoVG flush");
   endNvgFrame(m_nvg);
 }
 
@@ -323,5 +328,6 @@ bool Rendering::showVectorOverlays() const
 
 void Rendering::setShowVectorOverlays(bool show)
 {
+  invalidateViewRenderCache();
   m_showOverlays = show;
 }
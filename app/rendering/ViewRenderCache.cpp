@@ -0,0 +1,283 @@
+#include "rendering/ViewRenderCache.h"
+
+#include "common/Exception.hpp"
+#include "rendering/geometry/PixelEdgeGeometry.h"
+#include "rendering/utility/containers/Uniforms.h"
+#include "rendering/utility/gl/GLShader.h"
+#include "rendering/utility/gl/GLTextureTypes.h"
+
+#include <cmrc/cmrc.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <expected>
+#include <format>
+
+CMRC_DECLARE(shaders);
+
+namespace
+{
+
+std::expected<std::unique_ptr<GLShaderProgram>, std::string> buildCompositeShaderProgram()
+{
+  static const std::string shaderPath("app/rendering/shaders/");
+  static const std::string vsName("AsciiPost.vs");
+  static const std::string fsName("ViewRenderCacheComposite.fs");
+
+  const auto filesystem = cmrc::shaders::get_filesystem();
+  std::string vsSource;
+  std::string fsSource;
+
+  try {
+    const cmrc::file vsData = filesystem.open(shaderPath + vsName);
+    const cmrc::file fsData = filesystem.open(shaderPath + fsName);
+    vsSource = std::string(vsData.begin(), vsData.end());
+    fsSource = std::string(fsData.begin(), fsData.end());
+  }
+  catch (const std::exception& e) {
+    return std::unexpected(std::format("Exception loading view render cache shader: {}", e.what()));
+  }
+
+  Uniforms fsUniforms;
+  fsUniforms.insertUniform("u_cacheTex", UniformType::Sampler, Uniforms::SamplerIndexType{0});
+
+  GLShader vs(vsName, ShaderType::Vertex, vsSource.c_str());
+  GLShader fs(fsName, ShaderType::Fragment, fsSource.c_str());
+  fs.setRegisteredUniforms(fsUniforms);
+
+  auto program = std::make_unique<GLShaderProgram>(to_string(ShaderProgramType::ViewRenderCacheComposite));
+
+  if (!program->attachShader(vs)) {
+    return std::unexpected(std::format("Unable to compile view render cache vertex shader {}", vsName));
+  }
+  if (!program->attachShader(fs)) {
+    return std::unexpected(std::format("Unable to compile view render cache fragment shader {}", fsName));
+  }
+  if (!program->link()) {
+    return std::unexpected("Failed to link view render cache shader program");
+  }
+
+  return program;
+}
+
+} // namespace
+
+void ViewRenderCache::init()
+{
+  m_compositeVao.generate();
+}
+
+void ViewRenderCache::registerShaderPrograms(
+  std::unordered_map<ShaderProgramType, std::unique_ptr<GLShaderProgram>>& programs)
+{
+  auto prog = buildCompositeShaderProgram();
+  if (prog) {
+    programs.emplace(ShaderProgramType::ViewRenderCacheComposite, std::move(*prog));
+  }
+  else {
+    spdlog::error(prog.error());
+    throwDebug(
+      std::format("Failed to create shader program {}", to_string(ShaderProgramType::ViewRenderCacheComposite)));
+  }
+}
+
+bool ViewRenderCache::beginFrame(
+  const glm::ivec4& deviceViewport,
+  uint64_t inputRevision,
+  const glm::vec3& backgroundColor,
+  const std::vector<glm::vec4>& clipViewports)
+{
+  // The cache mirrors the default framebuffer, so that views render into it with their usual viewports
+  const glm::ivec2 size{deviceViewport.x + deviceViewport.z, deviceViewport.y + deviceViewport.w};
+  if (size.x <= 0 || size.y <= 0) {
+    return false;
+  }
+
+  glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_targetFboId);
+
+  const bool resized = (size != m_size) || !m_colorTex;
+  ensureSize(size);
+  if (!m_colorTex || !m_depthStencilTex) {
+    return false;
+  }
+
+  m_fbo.bind(fbo::TargetType::Draw);
+  m_deviceViewport = deviceViewport;
+  m_revision = m_frameRevision.update(inputRevision);
+  m_inFrame = true;
+
+  // Areas between views are not covered by any view, so the whole cache is cleared when they may have changed
+  if (resized || backgroundColor != m_backgroundColor || clipViewports != m_clipViewports) {
+    m_backgroundColor = backgroundColor;
+    m_clipViewports = clipViewports;
+    m_views.clear();
+    clearRect(glm::ivec4{0, 0, size.x, size.y});
+  }
+
+  return true;
+}
+
+bool ViewRenderCache::beginView(const uuids::uuid& viewUid, ViewRenderKey key, bool forceRender)
+{
+  if (!m_inFrame) {
+    return true;
+  }
+
+  const auto it = m_views.find(viewUid);
+  const rendering::view_cache::CachedViewRender* cached = (std::end(m_views) != it) ? &it->second : nullptr;
+
+  if (!forceRender && !rendering::view_cache::isStale(cached, key)) {
+    ++m_stats.hits;
+    return false;
+  }
+
+  ++m_stats.misses;
+  m_views.insert_or_assign(viewUid, rendering::view_cache::CachedViewRender{key});
+
+  const rendering::pixel_edge::ViewRect rect =
+    rendering::pixel_edge::computeViewRect(key.clipViewport, glm::vec4{m_deviceViewport});
+  clearRect(glm::ivec4{rect.windowX, rect.windowY, rect.width, rect.height});
+
+  return true;
+}
+
+void ViewRenderCache::endFrame(std::unordered_map<ShaderProgramType, std::unique_ptr<GLShaderProgram>>& shaderPrograms)
+{
+  if (!m_inFrame) {
+    return;
+  }
+  m_inFrame = false;
+
+  GLboolean previousBlendEnabled = glIsEnabled(GL_BLEND);
+  GLboolean previousScissorEnabled = glIsEnabled(GL_SCISSOR_TEST);
+  GLboolean previousDepthEnabled = glIsEnabled(GL_DEPTH_TEST);
+  GLboolean previousStencilEnabled = glIsEnabled(GL_STENCIL_TEST);
+  GLint previousViewport[4] = {0, 0, 0, 0};
+  glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(m_targetFboId));
+
+  // Copy with a full-screen pass, since blits into a multisampled default framebuffer are not allowed
+  glViewport(0, 0, m_size.x, m_size.y);
+  glDisable(GL_BLEND);
+  glDisable(GL_SCISSOR_TEST);
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_STENCIL_TEST);
+
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, m_colorTex->id());
+
+  GLShaderProgram& program = *shaderPrograms.at(ShaderProgramType::ViewRenderCacheComposite);
+  program.use();
+  program.setSamplerUniform("u_cacheTex", 0);
+
+  m_compositeVao.bind();
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  m_compositeVao.release();
+  program.stopUse();
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+
+  previousBlendEnabled ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+  previousScissorEnabled ? glEnable(GL_SCISSOR_TEST) : glDisable(GL_SCISSOR_TEST);
+  previousDepthEnabled ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+  previousStencilEnabled ? glEnable(GL_STENCIL_TEST) : glDisable(GL_STENCIL_TEST);
+
+  static constexpr std::chrono::seconds sk_logPeriod{10};
+  const Clock::time_point now = Clock::now();
+  const bool counted = (m_stats.hits + m_stats.misses) > (m_loggedStats.hits + m_loggedStats.misses);
+  if (counted && now - m_lastLogTime >= sk_logPeriod) {
+    const ViewRenderCacheStats periodStats{
+      .hits = m_stats.hits - m_loggedStats.hits,
+      .misses = m_stats.misses - m_loggedStats.misses};
+
+    spdlog::debug(
+      "View render cache: {} views composited and {} rendered (hit rate {:.3f}) in the last {} s",
+      periodStats.hits,
+      periodStats.misses,
+      periodStats.hitRate(),
+      std::chrono::duration_cast<std::chrono::seconds>(now - m_lastLogTime).count());
+
+    m_loggedStats = m_stats;
+    m_lastLogTime = now;
+  }
+}
+
+uint64_t ViewRenderCache::frameRevision() const
+{
+  return m_revision;
+}
+
+const ViewRenderCache::ViewRenderCacheStats& ViewRenderCache::stats() const
+{
+  return m_stats;
+}
+
+void ViewRenderCache::ensureSize(const glm::ivec2& size)
+{
+  if (size == m_size && m_colorTex && m_depthStencilTex) {
+    return;
+  }
+  m_size = size;
+
+  using namespace tex;
+  const glm::uvec3 texSize{static_cast<uint32_t>(size.x), static_cast<uint32_t>(size.y), 1u};
+
+  if (!m_colorTex) {
+    m_colorTex.emplace(tex::Target::Texture2D);
+    m_colorTex->generate();
+    m_colorTex->setMinificationFilter(tex::MinificationFilter::Nearest);
+    m_colorTex->setMagnificationFilter(tex::MagnificationFilter::Nearest);
+    m_colorTex->setWrapMode(tex::WrapMode::ClampToEdge);
+  }
+
+  if (!m_depthStencilTex) {
+    m_depthStencilTex.emplace(tex::Target::Texture2D);
+    m_depthStencilTex->generate();
+    m_depthStencilTex->setMinificationFilter(tex::MinificationFilter::Nearest);
+    m_depthStencilTex->setMagnificationFilter(tex::MagnificationFilter::Nearest);
+    m_depthStencilTex->setWrapMode(tex::WrapMode::ClampToEdge);
+  }
+
+  m_colorTex->setSize(texSize);
+  m_colorTex->bind(std::nullopt);
+  m_colorTex
+    ->setData(0, SizedInternalFormat::RGBA8_UNorm, BufferPixelFormat::RGBA, BufferPixelDataType::UInt8, nullptr);
+  m_colorTex->unbind();
+
+  // NanoVG draws its overlays with stencil strokes
+  m_depthStencilTex->setSize(texSize);
+  m_depthStencilTex->bind(std::nullopt);
+  m_depthStencilTex->setData(
+    0,
+    SizedInternalFormat::Depth24_UNorm_Stencil8_UNorm,
+    BufferPixelFormat::DepthStencil,
+    BufferPixelDataType::UInt24_8,
+    nullptr);
+  m_depthStencilTex->unbind();
+
+  if (m_fbo.id() == 0) {
+    m_fbo.generate();
+  }
+
+  m_fbo.bind(fbo::TargetType::DrawAndRead);
+  m_fbo.attach2DTexture(fbo::TargetType::Draw, fbo::AttachmentType::Color, *m_colorTex, 0);
+  m_fbo.attach2DTexture(fbo::TargetType::Draw, fbo::AttachmentType::DepthStencil, *m_depthStencilTex);
+  glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(m_targetFboId));
+}
+
+void ViewRenderCache::clearRect(const glm::ivec4& rect)
+{
+  GLboolean previousScissorEnabled = glIsEnabled(GL_SCISSOR_TEST);
+  GLfloat previousClearColor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  glGetFloatv(GL_COLOR_CLEAR_VALUE, previousClearColor);
+
+  glEnable(GL_SCISSOR_TEST);
+  glScissor(rect.x, rect.y, rect.z, rect.w);
+  glClearColor(m_backgroundColor.r, m_backgroundColor.g, m_backgroundColor.b, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+  glClearColor(previousClearColor[0], previousClearColor[1], previousClearColor[2], previousClearColor[3]);
+  previousScissorEnabled ? glEnable(GL_SCISSOR_TEST) : glDisable(GL_SCISSOR_TEST);
+}
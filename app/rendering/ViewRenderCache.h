@@ -0,0 +1,111 @@
+#pragma once
+
+#include "rendering/common/ShaderType.h"
+#include "rendering/helpers/ViewRenderCacheHelpers.h"
+#include "rendering/utility/gl/GLFrameBufferObject.h"
+#include "rendering/utility/gl/GLShaderProgram.h"
+#include "rendering/utility/gl/GLTexture.h"
+#include "rendering/utility/gl/GLVertexArrayObject.h"
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <uuid.h>
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Offscreen copy of the rendered images of all views in the layout, which lets views whose inputs did not
+ * change since the last frame be composited instead of rendered.
+ *
+ * Views are rendered into a color and depth-stencil framebuffer the size of the default framebuffer. Each view keeps
+ * the key of the inputs that it was rendered with, and a view is rendered again only once its key changes. Changes of
+ * inputs that are not part of the key must bump the input revision (see Rendering::invalidateViewRenderCache). At the
+ * end of the frame, the whole cache is copied to the framebuffer that was bound when the
+ * frame began.
+ */
+class ViewRenderCache
+{
+public:
+  using ViewRenderKey = rendering::view_cache::ViewRenderKey;
+  using ViewRenderCacheStats = rendering::view_cache::ViewRenderCacheStats;
+
+  /** @brief Generate GL objects that do not depend on framebuffer size. */
+  void init();
+
+  /**
+   * @brief Add the composite shader to the shared shader map.
+   * @param programs Rendering-owned shader program map.
+   * @throws Debug exception if the shader cannot be loaded, compiled, or linked.
+   */
+  void registerShaderPrograms(std::unordered_map<ShaderProgramType, std::unique_ptr<GLShaderProgram>>& programs);
+
+  /**
+   * @brief Start a frame and bind the cache as the draw framebuffer. The cache is cleared if its size, the background
+   * color, or the rectangles of the views changed.
+   * @param deviceViewport Viewport of the default framebuffer in device pixels.
+   * @param inputRevision Revision of the inputs shared by all views.
+   * @param backgroundColor Background color of the views.
+   * @param clipViewports Rectangles of all views of the layout in window clip coordinates.
+   * @return False if the cache cannot be used, in which case the previous framebuffer stays bound.
+   */
+  bool beginFrame(
+    const glm::ivec4& deviceViewport,
+    uint64_t inputRevision,
+    const glm::vec3& backgroundColor,
+    const std::vector<glm::vec4>& clipViewports);
+
+  /**
+   * @brief Check whether a view must be rendered into the cache. If so, its rectangle of the cache is cleared and its
+   * key is recorded.
+   * @param viewUid View to check.
+   * @param key Inputs of the view in this frame, including the frame revision from frameRevision().
+   * @param forceRender Render the view even if its cached render is current, such as while it waits for data that is
+   * prepared in the background.
+   * @return True if the view must be rendered; false if its cached render is reused.
+   */
+  bool beginView(const uuids::uuid& viewUid, ViewRenderKey key, bool forceRender);
+
+  /**
+   * @brief Copy the cache to the framebuffer that was bound when the frame began and bind that framebuffer again.
+   * @param shaderPrograms Rendering-owned shader program map.
+   */
+  void endFrame(std::unordered_map<ShaderProgramType, std::unique_ptr<GLShaderProgram>>& shaderPrograms);
+
+  /// Revision of the inputs shared by all views in the current frame, set by beginFrame()
+  uint64_t frameRevision() const;
+
+  /// Counts of views composited from the cache and views rendered since the cache was created
+  const ViewRenderCacheStats& stats() const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  void ensureSize(const glm::ivec2& size);
+  void clearRect(const glm::ivec4& rect);
+
+  GLFrameBufferObject m_fbo{"ViewRenderCacheFbo"};
+  std::optional<GLTexture> m_colorTex;
+  std::optional<GLTexture> m_depthStencilTex;
+  glm::ivec2 m_size{0, 0};
+  GLVertexArrayObject m_compositeVao;
+
+  GLint m_targetFboId = 0;                //!< Draw framebuffer bound when the frame began
+  glm::ivec4 m_deviceViewport{0};         //!< Viewport of the default framebuffer in this frame
+  glm::vec3 m_backgroundColor{0.0f};      //!< Background color that the cache was cleared with
+  std::vector<glm::vec4> m_clipViewports; //!< View rectangles that the cache was cleared for
+  bool m_inFrame = false;                 //!< Whether the cache is bound for a frame
+
+  rendering::view_cache::FrameRevision m_frameRevision;
+  uint64_t m_revision = 0; //!< Frame revision of this frame
+
+  std::unordered_map<uuids::uuid, rendering::view_cache::CachedViewRender> m_views;
+
+  ViewRenderCacheStats m_stats;
+  ViewRenderCacheStats m_loggedStats;
+  Clock::time_point m_lastLogTime = Clock::now();
+};
@@ -117,6 +117,8 @@ std::string to_string(ShaderProgramType type)
       return "ASCII Post-Process Spatial";
     case ShaderProgramType::PixelEdgePost:
       return "Pixel Edge Post-Process";
+    case ShaderProgramType::ViewRenderCacheComposite:
+      return "View Render Cache Composite";
     default:
       return "Unknown shader program type";
   }
@@ -62,6 +62,7 @@ enum class ShaderProgramType
   VectorSignedNormalProjectionLinear, //!< Signed vector projection onto the slice normal with linear
   VectorWarpedGridCubic,              //!< Warped grid overlay from a vector field with cubic
   VectorWarpedGridLinear,             //!< Warped grid overlay from a vector field with linear
+  ViewRenderCacheComposite,           //!< View render cache composite pass
   XrayCubic,                          //!< Intensity projection or X-ray with cubic
   XrayCubicWarped,                    //!< Warped intensity projection or X-ray with cubic
   XrayLinear,                         //!< Intensity projection or X-ray with linear
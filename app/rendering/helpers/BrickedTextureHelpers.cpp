@@ -0,0 +1,390 @@
+#include "rendering/helpers/BrickedTextureHelpers.h"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <functional>
+
+namespace rendering::bricking
+{
+
+std::size_t BrickKeyHash::operator()(const BrickKey& key) const
+{
+  std::size_t seed = std::hash<uint32_t>{}(key.level);
+  for (int a = 0; a < 3; ++a) {
+    seed ^= std::hash<uint32_t>{}(key.brick[a]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  }
+  return seed;
+}
+
+namespace
+{
+
+bool isPlanar(const glm::uvec3& volumeSize)
+{
+  return glm::any(glm::lessThanEqual(volumeSize, glm::uvec3{1u}));
+}
+
+} // namespace
+
+BrickPyramid::BrickPyramid(const glm::uvec3& volumeSize)
+  : BrickPyramid(volumeSize, isPlanar(volumeSize) ? sk_defaultTilePayloadSize : sk_defaultPayloadSize)
+{
+}
+
+BrickPyramid::BrickPyramid(const glm::uvec3& volumeSize, uint32_t payloadSize)
+  : m_volumeSize(glm::max(volumeSize, glm::uvec3{1u}))
+  , m_payloadSize(std::max(payloadSize, 1u))
+  , m_apronSize(sk_apronSize)
+  , m_numLevels(1)
+{
+  // Single-voxel axes are not split and need no apron
+  for (int a = 0; a < 3; ++a) {
+    if (1u == m_volumeSize[a]) {
+      m_payloadSize[a] = 1;
+      m_apronSize[a] = 0;
+    }
+  }
+
+  while (glm::any(glm::greaterThan(levelSize(m_numLevels - 1), m_payloadSize))) {
+    ++m_numLevels;
+  }
+}
+
+const glm::uvec3& BrickPyramid::volumeSize() const
+{
+  return m_volumeSize;
+}
+
+const glm::uvec3& BrickPyramid::payloadSize() const
+{
+  return m_payloadSize;
+}
+
+const glm::uvec3& BrickPyramid::apronSize() const
+{
+  return m_apronSize;
+}
+
+glm::uvec3 BrickPyramid::storedSize() const
+{
+  return m_payloadSize + 2u * m_apronSize;
+}
+
+std::size_t BrickPyramid::storedVoxelsPerBrick() const
+{
+  const glm::uvec3 n = storedSize();
+  return static_cast<std::size_t>(n.x) * n.y * n.z;
+}
+
+uint32_t BrickPyramid::numLevels() const
+{
+  return m_numLevels;
+}
+
+glm::uvec3 BrickPyramid::levelSize(uint32_t level) const
+{
+  glm::uvec3 size;
+  for (int a = 0; a < 3; ++a) {
+    const uint64_t scale = uint64_t{1} << std::min(level, 32u);
+    size[a] = static_cast<uint32_t>((m_volumeSize[a] + scale - 1) / scale);
+  }
+  return size;
+}
+
+glm::uvec3 BrickPyramid::brickCounts(uint32_t level) const
+{
+  return (levelSize(level) + m_payloadSize - 1u) / m_payloadSize;
+}
+
+std::size_t BrickPyramid::numBricks(uint32_t level) const
+{
+  const glm::uvec3 counts = brickCounts(level);
+  return static_cast<std::size_t>(counts.x) * counts.y * counts.z;
+}
+
+glm::uvec3 BrickPyramid::brickVoxelOffset(const BrickKey& key) const
+{
+  return key.brick * m_payloadSize;
+}
+
+std::pair<glm::uvec3, glm::uvec3> BrickPyramid::bricksCovering(
+  uint32_t level,
+  const glm::vec3& voxelMin,
+  const glm::vec3& voxelMax) const
+{
+  const glm::vec3 brickExtent = glm::vec3{m_payloadSize} * std::ldexp(1.0f, static_cast<int>(level));
+  const glm::vec3 lastBrick{brickCounts(level) - 1u};
+
+  const glm::vec3 first = glm::clamp(glm::floor(voxelMin / brickExtent), glm::vec3{0.0f}, lastBrick);
+  const glm::vec3 last = glm::clamp(glm::floor(voxelMax / brickExtent), first, lastBrick);
+  return {glm::uvec3{first}, glm::uvec3{last}};
+}
+
+double BrickCacheStats::hitRate() const
+{
+  return (0 == requests) ? 1.0 : static_cast<double>(hits) / static_cast<double>(requests);
+}
+
+BrickCache::BrickCache(const glm::uvec3& slotCounts, std::size_t bytesPerBrick)
+  : m_slotCounts(slotCounts)
+  , m_bytesPerBrick(bytesPerBrick)
+  , m_slots(static_cast<std::size_t>(slotCounts.x) * slotCounts.y * slotCounts.z)
+{
+  for (std::size_t s = 0; s < m_slots.size(); ++s) {
+    m_slots[s].lruIt = m_lru.insert(std::end(m_lru), s);
+  }
+}
+
+const glm::uvec3& BrickCache::slotCounts() const
+{
+  return m_slotCounts;
+}
+
+std::size_t BrickCache::numSlots() const
+{
+  return m_slots.size();
+}
+
+glm::uvec3 BrickCache::slotCoordinates(std::size_t slot) const
+{
+  const std::size_t x = m_slotCounts.x;
+  const std::size_t xy = x * m_slotCounts.y;
+  return glm::uvec3{slot % x, (slot % xy) / x, slot / xy};
+}
+
+void BrickCache::beginFrame()
+{
+  ++m_frame;
+  m_numUsedInFrame = 0;
+  m_frameStats = BrickCacheStats{};
+}
+
+std::optional<BrickCache::Request> BrickCache::request(const BrickKey& key)
+{
+  auto count = [this](std::size_t BrickCacheStats::* counter, std::size_t amount = 1) {
+    m_frameStats.*counter += amount;
+    m_totalStats.*counter += amount;
+  };
+
+  auto use = [this](std::size_t s) {
+    m_lru.splice(std::begin(m_lru), m_lru, m_slots[s].lruIt);
+    if (m_slots[s].lastUsedFrame != m_frame) {
+      m_slots[s].lastUsedFrame = m_frame;
+      ++m_numUsedInFrame;
+    }
+  };
+
+  count(&BrickCacheStats::requests);
+
+  if (const auto it = m_residentSlots.find(key); std::end(m_residentSlots) != it) {
+    use(it->second);
+    count(&BrickCacheStats::hits);
+    return Request{it->second, true};
+  }
+
+  // The least recently used slot is in use in this frame only if all slots are
+  if (m_lru.empty() || m_frame == m_slots[m_lru.back()].lastUsedFrame) {
+    count(&BrickCacheStats::rejected);
+    return std::nullopt;
+  }
+
+  const std::size_t s = m_lru.back();
+  if (m_slots[s].key) {
+    m_residentSlots.erase(*m_slots[s].key);
+    count(&BrickCacheStats::evictions);
+  }
+
+  m_slots[s].key = key;
+  m_residentSlots.emplace(key, s);
+  use(s);
+
+  count(&BrickCacheStats::misses);
+  count(&BrickCacheStats::bytesUploaded, m_bytesPerBrick);
+  return Request{s, false};
+}
+
+std::optional<std::size_t> BrickCache::residentSlot(const BrickKey& key) const
+{
+  const auto it = m_residentSlots.find(key);
+  return (std::end(m_residentSlots) != it) ? std::optional<std::size_t>{it->second} : std::nullopt;
+}
+
+std::vector<std::pair<BrickKey, std::size_t>> BrickCache::residentBricks() const
+{
+  return {std::begin(m_residentSlots), std::end(m_residentSlots)};
+}
+
+std::size_t BrickCache::numResident() const
+{
+  return m_residentSlots.size();
+}
+
+std::size_t BrickCache::numUsedInFrame() const
+{
+  return m_numUsedInFrame;
+}
+
+void BrickCache::clear()
+{
+  for (Slot& slot : m_slots) {
+    slot.key = std::nullopt;
+    slot.lastUsedFrame = 0;
+  }
+  m_residentSlots.clear();
+  m_numUsedInFrame = 0;
+}
+
+const BrickCacheStats& BrickCache::frameStats() const
+{
+  return m_frameStats;
+}
+
+const BrickCacheStats& BrickCache::totalStats() const
+{
+  return m_totalStats;
+}
+
+uint32_t levelForResolution(const BrickPyramid& pyramid, float voxelsPerScreenPixel)
+{
+  if (!(voxelsPerScreenPixel > 1.0f)) {
+    return 0;
+  }
+
+  const float coarsest = static_cast<float>(pyramid.numLevels() - 1);
+  return static_cast<uint32_t>(std::min(std::floor(std::log2(voxelsPerScreenPixel)), coarsest));
+}
+
+std::vector<BrickKey> planBricks(
+  const BrickPyramid& pyramid,
+  const glm::vec3& voxelMin,
+  const glm::vec3& voxelMax,
+  float voxelsPerScreenPixel,
+  std::size_t maxBricks,
+  uint32_t coarsestLevel)
+{
+  std::vector<BrickKey> plan;
+  if (0 == maxBricks) {
+    return plan;
+  }
+
+  const uint32_t coarsest = pyramid.numLevels() - 1;
+  const uint32_t coarsestAvailable = std::min(coarsestLevel, coarsest);
+
+  if (coarsestAvailable == coarsest) {
+    plan.push_back(BrickKey{coarsest, glm::uvec3{0u}});
+  }
+
+  const glm::vec3 center = 0.5f * (voxelMin + voxelMax);
+  const uint32_t finest = std::min(levelForResolution(pyramid, voxelsPerScreenPixel), coarsestAvailable);
+
+  for (uint32_t level = finest; level < coarsest && level <= coarsestAvailable; ++level) {
+    const auto [first, last] = pyramid.bricksCovering(level, voxelMin, voxelMax);
+    const glm::uvec3 counts = last - first + 1u;
+    const bool lastAvailable = (level == coarsestAvailable);
+
+    if (static_cast<std::size_t>(counts.x) * counts.y * counts.z >= maxBricks && !lastAvailable) {
+      continue;
+    }
+
+    const std::size_t levelBegin = plan.size();
+    for (uint32_t k = first.z; k <= last.z; ++k) {
+      for (uint32_t j = first.y; j <= last.y; ++j) {
+        for (uint32_t i = first.x; i <= last.x; ++i) {
+          plan.push_back(BrickKey{level, glm::uvec3{i, j, k}});
+        }
+      }
+    }
+
+    const glm::vec3 brickExtent = glm::vec3{pyramid.payloadSize()} * std::ldexp(1.0f, static_cast<int>(level));
+    auto distance = [&center, &brickExtent](const BrickKey& key) {
+      const glm::vec3 d = (glm::vec3{key.brick} + 0.5f) * brickExtent - center;
+      return glm::dot(d, d);
+    };
+
+    std::stable_sort(
+      std::begin(plan) + static_cast<std::ptrdiff_t>(levelBegin),
+      std::end(plan),
+      [&distance](const BrickKey& a, const BrickKey& b) { return distance(a) < distance(b); });
+
+    plan.resize(std::min(plan.size(), maxBricks));
+    break;
+  }
+
+  return plan;
+}
+
+std::vector<uint16_t> buildIndirectionTable(const BrickPyramid& pyramid, const BrickCache& cache)
+{
+  const glm::uvec3 counts = pyramid.brickCounts(0);
+  const std::size_t numEntries = pyramid.numBricks(0);
+
+  std::vector<uint16_t> table(4 * numEntries, 0);
+  for (std::size_t e = 0; e < numEntries; ++e) {
+    table[4 * e + 3] = k_nonResidentLevel;
+  }
+
+  // Finer bricks overwrite the entries of the coarser bricks that contain them
+  std::vector<std::pair<BrickKey, std::size_t>> resident = cache.residentBricks();
+  std::sort(std::begin(resident), std::end(resident), [](const auto& a, const auto& b) {
+    return a.first.level > b.first.level;
+  });
+
+  for (const auto& [key, slot] : resident) {
+    if (key.level >= pyramid.numLevels()) {
+      continue;
+    }
+
+    const glm::uvec3 slotCoords = cache.slotCoordinates(slot);
+    const glm::uvec3 begin = glm::min(key.brick << key.level, counts);
+    const glm::uvec3 end = glm::min((key.brick + 1u) << key.level, counts);
+
+    for (uint32_t k = begin.z; k < end.z; ++k) {
+      for (uint32_t j = begin.y; j < end.y; ++j) {
+        for (uint32_t i = begin.x; i < end.x; ++i) {
+          const std::size_t e = (static_cast<std::size_t>(k) * counts.y + j) * counts.x + i;
+          table[4 * e + 0] = static_cast<uint16_t>(slotCoords.x);
+          table[4 * e + 1] = static_cast<uint16_t>(slotCoords.y);
+          table[4 * e + 2] = static_cast<uint16_t>(slotCoords.z);
+          table[4 * e + 3] = static_cast<uint16_t>(key.level);
+        }
+      }
+    }
+  }
+
+  return table;
+}
+
+glm::uvec3 brickPoolSlotCounts(std::size_t maxSlots, const glm::uvec3& storedSize, int max3DTextureSize)
+{
+  if (0 == maxSlots || max3DTextureSize <= 0 || glm::any(glm::equal(storedSize, glm::uvec3{0u}))) {
+    return glm::uvec3{0u};
+  }
+
+  const glm::uvec3 maxPerAxis = glm::uvec3{static_cast<uint32_t>(max3DTextureSize)} / storedSize;
+  if (glm::any(glm::equal(maxPerAxis, glm::uvec3{0u}))) {
+    return glm::uvec3{0u};
+  }
+
+  // Double the shortest side of the pool for as long as it stays within the slot budget and the texture limit
+  glm::uvec3 counts{1u};
+  std::size_t numSlots = 1;
+
+  while (2 * numSlots <= maxSlots) {
+    int axis = -1;
+    for (int a = 0; a < 3; ++a) {
+      if (2 * counts[a] <= maxPerAxis[a] && (axis < 0 || counts[a] * storedSize[a] < counts[axis] * storedSize[axis])) {
+        axis = a;
+      }
+    }
+    if (axis < 0) {
+      break;
+    }
+    counts[axis] *= 2;
+    numSlots *= 2;
+  }
+
+  return counts;
+}
+
+} // namespace rendering::bricking
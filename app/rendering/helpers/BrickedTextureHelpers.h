@@ -0,0 +1,319 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rendering::bricking
+{
+
+/// Entry level of indirection texels whose brick has no resident ancestor
+inline constexpr uint16_t k_nonResidentLevel = 0xFFFFu;
+
+/**
+ * @brief Brick of one level of a brick pyramid.
+ */
+struct BrickKey
+{
+  uint32_t level = 0;   //!< Pyramid level, where level 0 has the resolution of the image
+  glm::uvec3 brick{0u}; //!< Brick coordinates within the level
+
+  bool operator==(const BrickKey&) const = default;
+};
+
+struct BrickKeyHash
+{
+  std::size_t operator()(const BrickKey& key) const;
+};
+
+/**
+ * @brief Layout of a volume that is split into fixed-size bricks at a pyramid of resolutions.
+ *
+ * Level L + 1 halves the resolution of level L, so level L has ceil(size / 2^L) voxels along each axis, and the
+ * pyramid ends at the first level that fits in one brick. Every brick holds `payloadSize()` voxels of its level along
+ * each axis plus an apron of one voxel on each side, which lets linear interpolation across brick faces read from a
+ * single brick. Since all levels use the same payload size, brick b of level 0 lies in brick b / 2^L of level L.
+ *
+ * Axes along which the volume has a single voxel are not split: their bricks hold that voxel and no apron. The bricks
+ * of planar images are therefore flat tiles.
+ */
+class BrickPyramid
+{
+public:
+  static constexpr uint32_t sk_defaultPayloadSize = 30;      //!< Default payload voxels per brick side (32 with apron)
+  static constexpr uint32_t sk_defaultTilePayloadSize = 254; //!< Default payload pixels per tile side (256 with apron)
+  static constexpr uint32_t sk_apronSize = 1;                //!< Apron voxels on each side of a brick
+
+  /// @brief Split a volume into bricks of the default size, or into tiles of the default size if it is planar.
+  explicit BrickPyramid(const glm::uvec3& volumeSize);
+
+  BrickPyramid(const glm::uvec3& volumeSize, uint32_t payloadSize);
+
+  const glm::uvec3& volumeSize() const;
+  const glm::uvec3& payloadSize() const;
+  const glm::uvec3& apronSize() const;
+
+  /// @brief Get the number of voxels along each side of a brick, including its apron.
+  glm::uvec3 storedSize() const;
+
+  /// @brief Get the number of voxels of a brick, including its apron.
+  std::size_t storedVoxelsPerBrick() const;
+
+  uint32_t numLevels() const;
+  glm::uvec3 levelSize(uint32_t level) const;
+  glm::uvec3 brickCounts(uint32_t level) const;
+  std::size_t numBricks(uint32_t level) const;
+
+  /// @brief Get the voxel of its level at which the payload of a brick begins.
+  glm::uvec3 brickVoxelOffset(const BrickKey& key) const;
+
+  /**
+   * @brief Get the bricks of a level that cover a box of continuous level-0 voxel coordinates.
+   * @return First and last brick coordinates (inclusive), clamped to the level.
+   */
+  std::pair<glm::uvec3, glm::uvec3> bricksCovering(
+    uint32_t level,
+    const glm::vec3& voxelMin,
+    const glm::vec3& voxelMax) const;
+
+private:
+  glm::uvec3 m_volumeSize;
+  glm::uvec3 m_payloadSize;
+  glm::uvec3 m_apronSize;
+  uint32_t m_numLevels;
+};
+
+/**
+ * @brief Counts of the brick requests made to a cache.
+ */
+struct BrickCacheStats
+{
+  std::size_t requests = 0;      //!< Bricks requested
+  std::size_t hits = 0;          //!< Requested bricks that were already resident
+  std::size_t misses = 0;        //!< Requested bricks that had to be uploaded
+  std::size_t evictions = 0;     //!< Resident bricks replaced by uploaded bricks
+  std::size_t rejected = 0;      //!< Requests refused because every slot was in use in the frame
+  std::size_t bytesUploaded = 0; //!< Bytes of the uploaded bricks
+
+  /// @brief Get the fraction of requests that hit, or 1 if there were no requests.
+  double hitRate() const;
+};
+
+/**
+ * @brief Least-recently-used assignment of bricks to the slots of a fixed-size brick pool.
+ *
+ * The cache only does the bookkeeping: a miss returns the slot into which the caller uploads the brick. Bricks that
+ * were requested in the current frame are never evicted, so all views of a frame can share one pool.
+ */
+class BrickCache
+{
+public:
+  /**
+   * @param slotCounts Number of brick slots along each axis of the pool.
+   * @param bytesPerBrick Bytes uploaded for each missed brick.
+   */
+  BrickCache(const glm::uvec3& slotCounts, std::size_t bytesPerBrick);
+
+  // Slots refer to positions in the LRU list, which moves but does not copy with the cache
+  BrickCache(const BrickCache&) = delete;
+  BrickCache& operator=(const BrickCache&) = delete;
+  BrickCache(BrickCache&&) = default;
+  BrickCache& operator=(BrickCache&&) = default;
+
+  const glm::uvec3& slotCounts() const;
+  std::size_t numSlots() const;
+
+  /// @brief Get the coordinates of a slot in the pool, in units of bricks.
+  glm::uvec3 slotCoordinates(std::size_t slot) const;
+
+  /// @brief Start a new frame, which resets the frame statistics and releases the bricks of the last frame.
+  void beginFrame();
+
+  /// @brief Result of a brick request.
+  struct Request
+  {
+    std::size_t slot = 0; //!< Slot holding the brick
+    bool hit = false;     //!< False if the brick must be uploaded into the slot
+  };
+
+  /**
+   * @brief Request a brick for the current frame.
+   * @return Slot of the brick, or std::nullopt if every slot already holds a brick of the current frame.
+   */
+  std::optional<Request> request(const BrickKey& key);
+
+  /// @brief Get the slot of a resident brick without marking it as used.
+  std::optional<std::size_t> residentSlot(const BrickKey& key) const;
+
+  /// @brief Get all resident bricks and their slots.
+  std::vector<std::pair<BrickKey, std::size_t>> residentBricks() const;
+
+  std::size_t numResident() const;
+
+  /// @brief Get the number of slots that hold bricks requested in the current frame.
+  std::size_t numUsedInFrame() const;
+
+  /// @brief Release all slots, for example after the brick data changed.
+  void clear();
+
+  const BrickCacheStats& frameStats() const;
+  const BrickCacheStats& totalStats() const;
+
+private:
+  struct Slot
+  {
+    std::optional<BrickKey> key;
+    uint64_t lastUsedFrame = 0;
+    std::list<std::size_t>::iterator lruIt;
+  };
+
+  glm::uvec3 m_slotCounts;
+  std::size_t m_bytesPerBrick;
+
+  uint64_t m_frame = 1;
+  std::size_t m_numUsedInFrame = 0;
+
+  std::vector<Slot> m_slots;
+  std::list<std::size_t> m_lru; //!< Slots from most to least recently used
+  std::unordered_map<BrickKey, std::size_t, BrickKeyHash> m_residentSlots;
+
+  BrickCacheStats m_frameStats;
+  BrickCacheStats m_totalStats;
+};
+
+/**
+ * @brief Get the pyramid level whose voxels best match a screen resolution.
+ * @param voxelsPerScreenPixel Level-0 voxels per screen pixel along the most magnified axis.
+ * @return Coarsest level at which a screen pixel still covers at least one voxel.
+ */
+uint32_t levelForResolution(const BrickPyramid& pyramid, float voxelsPerScreenPixel);
+
+/**
+ * @brief Plan the bricks that a view needs to display a box of the volume.
+ *
+ * The plan starts with the coarsest level, which covers the volume in one brick and is the fallback for everything
+ * that finer bricks do not cover. It then lists the bricks of the level for the screen resolution that cover the box,
+ * nearest to the box center first. If those do not fit in the budget, coarser levels are planned instead.
+ *
+ * While the coarser levels of a pyramid are still being built, \p coarsestLevel limits the plan to the levels that
+ * are available. The plan then has no fallback brick, and if the bricks of the coarsest available level do not fit in
+ * the budget, only those nearest to the box center are planned.
+ *
+ * @param voxelMin Minimum corner of the visible box, in continuous level-0 voxel coordinates.
+ * @param voxelMax Maximum corner of the visible box, in continuous level-0 voxel coordinates.
+ * @param voxelsPerScreenPixel Level-0 voxels per screen pixel along the most magnified axis.
+ * @param maxBricks Maximum number of bricks in the plan.
+ * @param coarsestLevel Coarsest level whose voxels are available.
+ */
+std::vector<BrickKey> planBricks(
+  const BrickPyramid& pyramid,
+  const glm::vec3& voxelMin,
+  const glm::vec3& voxelMax,
+  float voxelsPerScreenPixel,
+  std::size_t maxBricks,
+  uint32_t coarsestLevel = std::numeric_limits<uint32_t>::max());
+
+/**
+ * @brief Build the indirection table, with one RGBA entry per level-0 brick in x-fastest order.
+ *
+ * Each entry holds the slot coordinates and level of the finest resident brick that covers the level-0 brick. Entries
+ * without a resident brick have level `k_nonResidentLevel`.
+ */
+std::vector<uint16_t> buildIndirectionTable(const BrickPyramid& pyramid, const BrickCache& cache);
+
+/**
+ * @brief Choose the slot counts of a brick pool.
+ * @param maxSlots Maximum number of slots, for example from a memory budget.
+ * @param storedSize Voxels along each side of a brick, including its apron.
+ * @param max3DTextureSize GL_MAX_3D_TEXTURE_SIZE
+ * @return Slot counts of a pool that is as close to a cube as possible, or zero if no brick fits in a texture.
+ */
+glm::uvec3 brickPoolSlotCounts(std::size_t maxSlots, const glm::uvec3& storedSize, int max3DTextureSize);
+
+/**
+ * @brief Copy a brick and its apron from one pyramid level, repeating the voxels on the level boundary.
+ * @param voxelValue Function returning the value of a voxel of the level of the brick.
+ * @param brickData Stored voxels of the brick, in x-fastest order.
+ */
+template<typename VoxelFn>
+void extractBrick(const BrickPyramid& pyramid, const BrickKey& key, VoxelFn&& voxelValue, std::vector<float>& brickData)
+{
+  const glm::ivec3 levelMax = glm::ivec3{pyramid.levelSize(key.level)} - 1;
+  const glm::ivec3 first = glm::ivec3{pyramid.brickVoxelOffset(key)} - glm::ivec3{pyramid.apronSize()};
+  const glm::ivec3 n{pyramid.storedSize()};
+
+  brickData.resize(pyramid.storedVoxelsPerBrick());
+  std::size_t index = 0;
+
+  for (int k = 0; k < n.z; ++k) {
+    const uint32_t z = static_cast<uint32_t>(std::clamp(first.z + k, 0, levelMax.z));
+    for (int j = 0; j < n.y; ++j) {
+      const uint32_t y = static_cast<uint32_t>(std::clamp(first.y + j, 0, levelMax.y));
+      for (int i = 0; i < n.x; ++i) {
+        const uint32_t x = static_cast<uint32_t>(std::clamp(first.x + i, 0, levelMax.x));
+        brickData[index++] = static_cast<float>(voxelValue(glm::uvec3{x, y, z}));
+      }
+    }
+  }
+}
+
+/**
+ * @brief Halve the resolution of a pyramid level by averaging blocks of 2x2x2 voxels.
+ * @param voxelValue Function returning the value of a voxel of the finer level, which is called concurrently.
+ * @param size Size of the finer level. Blocks past an odd upper boundary repeat the boundary voxels.
+ * @param numThreads Maximum number of threads, each of which computes a slab of the coarser level.
+ * @return Voxels of the coarser level, of size ceil(size / 2), in x-fastest order.
+ */
+template<typename VoxelFn>
+std::vector<float> downsampleLevel(VoxelFn&& voxelValue, const glm::uvec3& size, unsigned int numThreads = 1)
+{
+  const glm::uvec3 coarseSize = (size + 1u) / 2u;
+  const glm::uvec3 last = size - 1u;
+
+  std::vector<float> values(static_cast<std::size_t>(coarseSize.x) * coarseSize.y * coarseSize.z);
+
+  auto work = [&](uint32_t kBegin, uint32_t kEnd) {
+    std::size_t index = static_cast<std::size_t>(kBegin) * coarseSize.y * coarseSize.x;
+    for (uint32_t k = kBegin; k < kEnd; ++k) {
+      for (uint32_t j = 0; j < coarseSize.y; ++j) {
+        for (uint32_t i = 0; i < coarseSize.x; ++i) {
+          double sum = 0.0;
+          for (uint32_t c = 0; c < 8; ++c) {
+            const glm::uvec3 v{
+              std::min(2 * i + (c & 1u), last.x),
+              std::min(2 * j + ((c >> 1) & 1u), last.y),
+              std::min(2 * k + ((c >> 2) & 1u), last.z)};
+            sum += static_cast<double>(voxelValue(v));
+          }
+          values[index++] = static_cast<float>(sum / 8.0);
+        }
+      }
+    }
+  };
+
+  numThreads = std::clamp(numThreads, 1u, coarseSize.z);
+  const uint32_t slabSize = (coarseSize.z + numThreads - 1) / numThreads;
+
+  std::vector<std::thread> threads;
+  for (uint32_t kBegin = slabSize; kBegin < coarseSize.z; kBegin += slabSize) {
+    threads.emplace_back(work, kBegin, std::min(kBegin + slabSize, coarseSize.z));
+  }
+  work(0, std::min(slabSize, coarseSize.z));
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  return values;
+}
+
+} // namespace rendering::bricking
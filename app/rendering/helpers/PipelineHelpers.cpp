@@ -57,6 +57,14 @@ std::unordered_map<std::string, std::string> shaderReplacementsForTextureDimensi
 
   result["$$IMAGE_SAMPLER_TYPE$$"] = "sampler3D";
   result["$$SEG_SAMPLER_TYPE$$"] = "usampler3D";
+
+  if (TextureDimension::Bricked == dimension) {
+    // Bricks hold texture intensities, so cubic and floating-point lookups also use the bricked linear lookup
+    if (const auto it = result.find("$$TEXTURE_LOOKUP_FUNCTION$$"); it != std::end(result)) {
+      it->second = std::string{lookupSources.bricked};
+    }
+  }
+
   return result;
 }
 
@@ -128,10 +136,20 @@ std::list<uuids::uuid> raycastableImageUids(
 GLShaderProgram& shaderProgramForTextureDimension(
   std::unordered_map<ShaderProgramType, std::unique_ptr<GLShaderProgram>>& shaderPrograms3D,
   std::unordered_map<ShaderProgramType, std::unique_ptr<GLShaderProgram>>& shaderPrograms2D,
+  std::unordered_map<ShaderProgramType, std::unique_ptr<GLShaderProgram>>& shaderProgramsBricked,
   const ShaderProgramType shaderType,
   const TextureDimension dimension)
 {
-  return *(TextureDimension::Texture2D == dimension ? shaderPrograms2D : shaderPrograms3D).at(shaderType);
+  switch (dimension) {
+    case TextureDimension::Texture2D:
+      return *shaderPrograms2D.at(shaderType);
+    case TextureDimension::Bricked:
+      return *shaderProgramsBricked.at(shaderType);
+    case TextureDimension::Texture3D:
+      break;
+  }
+
+  return *shaderPrograms3D.at(shaderType);
 }
 
 void setTexture2DAxesUniforms(
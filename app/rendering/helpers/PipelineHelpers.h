@@ -44,13 +44,15 @@ struct TextureLookupReplacementSources
   std::string cubic3D;
   std::string cubic2D;
   std::string uintLinear2D;
+  std::string bricked;
 };
 
 /**
  * @brief Return shader placeholder replacements for the requested texture dimension.
  *
  * The 3D path only sets sampler placeholder types. The 2D fallback path also swaps texture lookup helpers to
- * dimension-specific implementations while preserving all unrelated placeholders.
+ * dimension-specific implementations while preserving all unrelated placeholders. The bricked path keeps 3D samplers
+ * and swaps every image texture lookup for the lookup through the brick indirection texture.
  */
 std::unordered_map<std::string, std::string> shaderReplacementsForTextureDimension(
   const std::unordered_map<std::string, std::string>& replacements,
@@ -107,11 +109,12 @@ std::list<uuids::uuid> raycastableImageUids(
   const std::unordered_map<uuids::uuid, PlanarTextureLayout>& textureLayouts);
 
 /**
- * @brief Select the matching 2D or 3D shader program for an uploaded texture layout.
+ * @brief Select the matching 2D, 3D or bricked shader program for an uploaded texture layout.
  */
 GLShaderProgram& shaderProgramForTextureDimension(
   std::unordered_map<ShaderProgramType, std::unique_ptr<GLShaderProgram>>& shaderPrograms3D,
   std::unordered_map<ShaderProgramType, std::unique_ptr<GLShaderProgram>>& shaderPrograms2D,
+  std::unordered_map<ShaderProgramType, std::unique_ptr<GLShaderProgram>>& shaderProgramsBricked,
   ShaderProgramType shaderType,
   TextureDimension dimension);
 
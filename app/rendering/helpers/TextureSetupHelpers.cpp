@@ -1,4 +1,5 @@
 #include "rendering/helpers/TextureSetupHelpers.h"
+#include "rendering/helpers/BrickedTextureHelpers.h"
 
 #include <cstdint>
 
@@ -30,7 +31,10 @@ bool fitsMax2DTextureSize(const glm::uvec2& size, const TextureLimits& limits)
          size.y <= static_cast<uint32_t>(limits.maxTextureSize);
 }
 
-std::optional<TextureUploadLayout> textureUploadLayoutForImage(const glm::uvec3& size, const TextureLimits& limits)
+std::optional<TextureUploadLayout> textureUploadLayoutForImage(
+  const glm::uvec3& size,
+  const TextureLimits& limits,
+  const bool allowBricking)
 {
   if (fitsMax3DTextureSize(size, limits)) {
     TextureUploadLayout uploadLayout;
@@ -39,14 +43,30 @@ std::optional<TextureUploadLayout> textureUploadLayoutForImage(const glm::uvec3&
     return uploadLayout;
   }
 
+  auto brickedLayout = [&size, &limits, allowBricking]() -> std::optional<TextureUploadLayout> {
+    // Both a brick and the indirection texture, with one texel per brick, must fit in 3D textures
+    const bricking::BrickPyramid pyramid(size);
+    if (
+      !allowBricking || !fitsMax3DTextureSize(pyramid.storedSize(), limits) ||
+      !fitsMax3DTextureSize(pyramid.brickCounts(0), limits))
+    {
+      return std::nullopt;
+    }
+
+    TextureUploadLayout uploadLayout;
+    uploadLayout.layout.dimension = TextureDimension::Bricked;
+    uploadLayout.uploadSize = size;
+    return uploadLayout;
+  };
+
   const std::vector<int> axes = nonSingletonAxes(size);
   if (axes.size() != 2u) {
-    return std::nullopt;
+    return brickedLayout();
   }
 
   const glm::uvec2 size2D{size[axes[0]], size[axes[1]]};
   if (!fitsMax2DTextureSize(size2D, limits)) {
-    return std::nullopt;
+    return brickedLayout();
   }
 
   TextureUploadLayout uploadLayout;
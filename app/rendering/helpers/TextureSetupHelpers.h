@@ -27,7 +27,7 @@ struct TextureLimits
 struct TextureUploadLayout
 {
   PlanarTextureLayout layout; //!< Texture dimensionality and, for 2D textures, the represented image axes
-  glm::uvec3 uploadSize{1u};  //!< OpenGL upload size; 2D textures use z = 1
+  glm::uvec3 uploadSize{1u};  //!< OpenGL upload size; 2D textures use z = 1 and bricked textures the volume size
 };
 
 /**
@@ -49,9 +49,13 @@ bool fitsMax2DTextureSize(const glm::uvec2& size, const TextureLimits& limits);
  * @brief Choose the OpenGL texture target and upload size for an image or segmentation.
  *
  * Volumes that fit within the reported 3D texture limit use GL_TEXTURE_3D. Planar images that exceed the 3D limit may
- * fall back to GL_TEXTURE_2D when their two non-singleton axes fit within the reported 2D texture limit.
+ * fall back to GL_TEXTURE_2D when their two non-singleton axes fit within the reported 2D texture limit. Other images
+ * are paged into a brick pool when `allowBricking` is set and a brick fits within the 3D limit.
  */
-std::optional<TextureUploadLayout> textureUploadLayoutForImage(const glm::uvec3& size, const TextureLimits& limits);
+std::optional<TextureUploadLayout> textureUploadLayoutForImage(
+  const glm::uvec3& size,
+  const TextureLimits& limits,
+  bool allowBricking = false);
 
 /**
  * @brief Return a user-facing explanation for why a texture exceeds the available OpenGL limits.
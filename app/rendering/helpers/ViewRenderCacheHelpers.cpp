@@ -0,0 +1,32 @@
+#include "rendering/helpers/ViewRenderCacheHelpers.h"
+
+namespace rendering::view_cache
+{
+
+uint64_t FrameRevision::update(uint64_t inputRevision)
+{
+  if (inputRevision != m_inputRevision) {
+    m_inputRevision = inputRevision;
+    m_settling = true;
+    ++m_revision;
+  }
+  else if (m_settling) {
+    m_settling = false;
+    ++m_revision;
+  }
+
+  return m_revision;
+}
+
+bool isStale(const CachedViewRender* cached, const ViewRenderKey& key)
+{
+  return !cached || cached->key != key;
+}
+
+double ViewRenderCacheStats::hitRate() const
+{
+  const uint64_t total = hits + misses;
+  return (total > 0) ? static_cast<double>(hits) / static_cast<double>(total) : 0.0;
+}
+
+} // namespace rendering::view_cache
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <cstdint>
+#include <optional>
+
+namespace rendering::view_cache
+{
+
+/**
+ * @brief Inputs that the rendered images of one view depend on. A view whose key is unchanged since it was rendered
+ * into the cache is composited from the cache.
+ */
+struct ViewRenderKey
+{
+  uint64_t revision = 0;             //!< Frame revision of the inputs shared by all views (see FrameRevision)
+  glm::mat4 world_T_clip{1.0f};      //!< Camera of the view
+  glm::vec3 worldOffsetXhairs{0.0f}; //!< Crosshairs offset to the image slice of the view
+  glm::vec4 clipViewport{0.0f};      //!< Rectangle of the view in window clip coordinates
+
+  bool operator==(const ViewRenderKey&) const = default;
+};
+
+/**
+ * @brief Render of one view held in the cache.
+ */
+struct CachedViewRender
+{
+  ViewRenderKey key; //!< Inputs that the view was rendered with
+};
+
+/**
+ * @brief Revision that keys the views of a frame, derived from the revision of the inputs shared by all views.
+ *
+ * A change of the input revision also changes the frame revision of the following frame: the UI applies the edits of
+ * an input event while it is drawn, which happens after the views of the frame that handled the event are rendered.
+ */
+class FrameRevision
+{
+public:
+  /**
+   * @brief Update the revision for a new frame.
+   * @param inputRevision Revision of the inputs shared by all views at the start of the frame.
+   * @return Frame revision.
+   */
+  uint64_t update(uint64_t inputRevision);
+
+private:
+  std::optional<uint64_t> m_inputRevision;
+  uint64_t m_revision = 0;
+  bool m_settling = false; //!< Whether the input revision changed in the last frame
+};
+
+/**
+ * @brief Check whether a view must be rendered instead of composited from the cache.
+ * @param cached Cached render of the view, or null if the view is not cached.
+ * @param key Inputs of the view in this frame.
+ * @return True if the view is not cached or was cached with other inputs.
+ */
+bool isStale(const CachedViewRender* cached, const ViewRenderKey& key);
+
+/**
+ * @brief Counts of the views that were composited from the cache and those that were rendered.
+ */
+struct ViewRenderCacheStats
+{
+  uint64_t hits = 0;   //!< Views composited from the cache
+  uint64_t misses = 0; //!< Views rendered into the cache
+
+  /// Fraction of views composited from the cache, or zero if no views were counted
+  double hitRate() const;
+};
+
+} // namespace rendering::view_cache
@@ -97,6 +97,7 @@ float getImageValue(sampler3D tex, vec3 texCoord)
 $$SAMPLE_TEX_COORD_FUNCTION$$
 $$SAMPLE_IMAGE_VALUE_FUNCTION$$
 $$RAYCAST_JUMP_DISTANCE_FUNCTION$$
+$$RAYCAST_MACROCELL_SKIP_FUNCTION$$
 const float EDGE_BRIGHTENING_DISTANCE_VOX = 1.0;
 const float EDGE_BACKGROUND_BRIGHTENING = 0.65;
 const float EDGE_OVERLAY_BRIGHTENING = 0.35;
@@ -373,6 +374,18 @@ void main()
 
     oldValue = value;
     oldT = t;
+
+    // Resume one step before the next macrocell that an isosurface may cross. Values do not cross any
+    // isovalue in the skipped cells, so the crossings found from there on do not change.
+    float activeT = raycastNextActiveDistance(texStartPos, texRayDir, t, tMax);
+    if (activeT > tMax) {
+      break;
+    }
+    if (activeT > t + texStep) {
+      t = activeT - texStep;
+      oldT = t;
+      oldValue = sampleImageValue(texStartPos + t * texRayDir);
+    }
   }
 
   //  float normDistance = abs(oldT - tMin);
@@ -0,0 +1,11 @@
+#version 330 core
+
+out vec4 o_color;
+
+uniform sampler2D u_cacheTex;
+
+// The cache has the size of the framebuffer, so fragments read their own texel
+void main()
+{
+  o_color = texelFetch(u_cacheTex, ivec2(gl_FragCoord.xy), 0);
+}
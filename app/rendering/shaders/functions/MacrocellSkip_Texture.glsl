@@ -0,0 +1,68 @@
+#define MAX_MACROCELL_STEPS 1024
+#define MACROCELL_RANGE_TOLERANCE 1.0e-5
+#define MACROCELL_FACE_STEP_VOX 1.0e-3
+
+uniform sampler3D u_macrocellTex; // Minimum (red) and maximum (green) image texture value of each macrocell
+uniform bool u_macrocellSkipping;
+uniform float u_macrocellVoxels; // Number of voxels along each side of a macrocell
+
+bool isActiveMacrocell(ivec3 cell)
+{
+  vec2 range = texelFetch(u_macrocellTex, cell, 0).rg;
+  vec2 tolerance = MACROCELL_RANGE_TOLERANCE * max(vec2(1.0), abs(range));
+  range += vec2(-tolerance.x, tolerance.y);
+
+  for (int i = 0; i < u_numIsos; ++i) {
+    if (u_isoOpacities[i] > 0.0 && range[0] < u_isoValues[i] && u_isoValues[i] <= range[1]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Step through the macrocells along the ray from parameter t to find where the ray enters the first cell
+// that an isosurface may cross. Cell c covers the voxel coordinates [c, c + 1] * u_macrocellVoxels, with
+// voxel centers at integer coordinates, and the outer cells extend to the image boundary.
+// Returns a parameter beyond tMax if no cell up to tMax is active.
+float raycastNextActiveDistance(vec3 texStartPos, vec3 texRayDir, float t, float tMax)
+{
+  if (!u_macrocellSkipping) {
+    return t;
+  }
+
+  ivec3 numCells = textureSize(u_macrocellTex, 0);
+  vec3 imgDims = 1.0 / u_imgInvDims;
+  vec3 voxStartPos = texStartPos * imgDims - 0.5;
+  vec3 voxRayDir = texRayDir * imgDims;
+  float faceStep = MACROCELL_FACE_STEP_VOX / compMax(abs(voxRayDir));
+
+  float entryT = t;
+
+  for (int n = 0; n < MAX_MACROCELL_STEPS && entryT <= tMax; ++n) {
+    vec3 voxPos = voxStartPos + t * voxRayDir;
+    ivec3 cell = clamp(ivec3(floor(voxPos / u_macrocellVoxels)), ivec3(0), numCells - 1);
+
+    if (isActiveMacrocell(cell)) {
+      return entryT;
+    }
+
+    float exitT = RAY_BOX_BIG;
+    for (int a = 0; a < 3; ++a) {
+      if (voxRayDir[a] > 0.0 && cell[a] + 1 < numCells[a]) {
+        exitT = min(exitT, (float(cell[a] + 1) * u_macrocellVoxels - voxStartPos[a]) / voxRayDir[a]);
+      }
+      else if (voxRayDir[a] < 0.0 && cell[a] > 0) {
+        exitT = min(exitT, (float(cell[a]) * u_macrocellVoxels - voxStartPos[a]) / voxRayDir[a]);
+      }
+    }
+
+    if (exitT >= RAY_BOX_BIG) {
+      return RAY_BOX_BIG; // The ray leaves the image
+    }
+
+    entryT = max(exitT, t) - faceStep;
+    t = max(exitT, t) + faceStep;
+  }
+
+  return entryT;
+}
@@ -0,0 +1,37 @@
+uniform usampler3D u_brickIndirectionTex; // Slot (xyz) and level (w) of the finest resident brick per level-0 brick
+uniform vec3 u_brickVolumeSize; // Voxels of the image
+uniform vec3 u_brickPoolSize; // Voxels of the brick pool texture
+uniform vec3 u_brickPayloadSize; // Voxels of a brick along each axis, without its apron
+uniform vec3 u_brickApronSize; // Apron voxels on each side of a brick (zero along flat axes of planar tiles)
+
+/**
+ * @brief Trilinear lookup into a volume that is paged into a pool of bricks (or of flat tiles for planar images).
+ * @param[in] tex Brick pool texture
+ * @param[in] texCoord Normalized 3D texture coordinate of the full image
+ * @return Interpolated value of the finest resident brick, or zero if no brick is resident
+ */
+float textureLookup(sampler3D tex, vec3 texCoord)
+{
+  vec3 voxel = clamp(texCoord, 0.0, 1.0) * u_brickVolumeSize;
+  ivec3 brick0 = min(ivec3(voxel / u_brickPayloadSize), textureSize(u_brickIndirectionTex, 0) - 1);
+  uvec4 entry = texelFetch(u_brickIndirectionTex, brick0, 0);
+
+  if (65535u == entry.w) {
+    return 0.0;
+  }
+
+  // Position within the payload of the brick at its level. The apron keeps the interpolation
+  // footprint inside the brick.
+  int level = int(entry.w);
+  vec3 storedSize = u_brickPayloadSize + 2.0 * u_brickApronSize;
+  vec3 origin = vec3(brick0 >> level) * u_brickPayloadSize;
+  vec3 local = clamp(voxel / exp2(float(level)) - origin + u_brickApronSize, vec3(0.5), storedSize - 0.5);
+
+  vec3 poolVoxel = vec3(entry.xyz) * storedSize + local;
+  return texture(tex, poolVoxel / u_brickPoolSize)[0];
+}
+
+float textureLookup(sampler3D tex, vec3 texCoord, int imageIndex)
+{
+  return textureLookup(tex, texCoord);
+}
@@ -0,0 +1,333 @@
+#include "rendering/helpers/BrickedTextureHelpers.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bricking = rendering::bricking;
+using bricking::BrickKey;
+
+namespace
+{
+
+float rampValue(const glm::uvec3& v)
+{
+  return static_cast<float>(v.x + 100 * v.y + 10000 * v.z);
+}
+
+} // namespace
+
+TEST_CASE("brick pyramid halves levels down to one brick", "[rendering][bricking]")
+{
+  const bricking::BrickPyramid pyramid(glm::uvec3{100, 70, 9});
+
+  REQUIRE(pyramid.payloadSize() == glm::uvec3{30});
+  REQUIRE(pyramid.storedSize() == glm::uvec3{32});
+  REQUIRE(pyramid.storedVoxelsPerBrick() == 32 * 32 * 32);
+  REQUIRE(pyramid.numLevels() == 3);
+
+  REQUIRE(pyramid.levelSize(0) == glm::uvec3{100, 70, 9});
+  REQUIRE(pyramid.levelSize(1) == glm::uvec3{50, 35, 5});
+  REQUIRE(pyramid.levelSize(2) == glm::uvec3{25, 18, 3});
+
+  REQUIRE(pyramid.brickCounts(0) == glm::uvec3{4, 3, 1});
+  REQUIRE(pyramid.brickCounts(1) == glm::uvec3{2, 2, 1});
+  REQUIRE(pyramid.brickCounts(2) == glm::uvec3{1, 1, 1});
+  REQUIRE(pyramid.numBricks(0) == 12);
+
+  REQUIRE(pyramid.brickVoxelOffset(BrickKey{1, glm::uvec3{1, 1, 0}}) == glm::uvec3{30, 30, 0});
+
+  // Level-0 voxels [45, 95) along x lie in bricks 1..3 of level 0 and in bricks 0..1 of level 1
+  auto covering = pyramid.bricksCovering(0, glm::vec3{45.0f, 0.0f, 0.0f}, glm::vec3{95.0f, 10.0f, 8.0f});
+  REQUIRE(covering.first == glm::uvec3{1, 0, 0});
+  REQUIRE(covering.second == glm::uvec3{3, 0, 0});
+
+  covering = pyramid.bricksCovering(1, glm::vec3{45.0f, 0.0f, 0.0f}, glm::vec3{95.0f, 10.0f, 8.0f});
+  REQUIRE(covering.first == glm::uvec3{0, 0, 0});
+  REQUIRE(covering.second == glm::uvec3{1, 0, 0});
+
+  // Boxes outside of the volume are clamped to it
+  covering = pyramid.bricksCovering(0, glm::vec3{-50.0f}, glm::vec3{500.0f});
+  REQUIRE(covering.first == glm::uvec3{0, 0, 0});
+  REQUIRE(covering.second == glm::uvec3{3, 2, 0});
+
+  REQUIRE(bricking::BrickPyramid(glm::uvec3{1, 1, 1}).numLevels() == 1);
+}
+
+TEST_CASE("brick pyramids of planar images are split into flat tiles", "[rendering][bricking]")
+{
+  const bricking::BrickPyramid pyramid(glm::uvec3{40000, 30000, 1});
+
+  REQUIRE(pyramid.payloadSize() == glm::uvec3{254, 254, 1});
+  REQUIRE(pyramid.apronSize() == glm::uvec3{1, 1, 0});
+  REQUIRE(pyramid.storedSize() == glm::uvec3{256, 256, 1});
+  REQUIRE(pyramid.storedVoxelsPerBrick() == 256 * 256);
+  REQUIRE(pyramid.numLevels() == 9);
+  REQUIRE(pyramid.levelSize(8) == glm::uvec3{157, 118, 1});
+  REQUIRE(pyramid.brickCounts(0) == glm::uvec3{158, 119, 1});
+
+  // Planes along other axes are tiled in their own axes
+  const bricking::BrickPyramid sagittal(glm::uvec3{1, 600, 500}, 100);
+  REQUIRE(sagittal.storedSize() == glm::uvec3{1, 102, 102});
+  REQUIRE(sagittal.brickCounts(0) == glm::uvec3{1, 6, 5});
+
+  // Tiles have no apron across the plane
+  std::vector<float> tile;
+  bricking::extractBrick(pyramid, BrickKey{0, glm::uvec3{2, 1, 0}}, rampValue, tile);
+  REQUIRE(tile.size() == 256 * 256);
+  REQUIRE(tile[0] == rampValue(glm::uvec3{507, 253, 0}));
+  REQUIRE(tile[257] == rampValue(glm::uvec3{508, 254, 0}));
+
+  // Tile pools stack tiles across the plane until the pool is as deep as it is wide
+  REQUIRE(bricking::brickPoolSlotCounts(64, pyramid.storedSize(), 2048) == glm::uvec3{1, 1, 64});
+  REQUIRE(bricking::brickPoolSlotCounts(1024, pyramid.storedSize(), 2048) == glm::uvec3{2, 2, 256});
+  REQUIRE(bricking::brickPoolSlotCounts(1024, pyramid.storedSize(), 128) == glm::uvec3{0});
+}
+
+TEST_CASE("bricks copy their payload and apron from a level", "[rendering][bricking]")
+{
+  const bricking::BrickPyramid pyramid(glm::uvec3{10, 7, 3}, 4);
+  REQUIRE(pyramid.storedSize() == glm::uvec3{6});
+  REQUIRE(pyramid.brickCounts(0) == glm::uvec3{3, 2, 1});
+
+  std::vector<float> brick;
+  bricking::extractBrick(pyramid, BrickKey{0, glm::uvec3{1, 1, 0}}, rampValue, brick);
+  REQUIRE(brick.size() == 6 * 6 * 6);
+
+  auto stored = [&brick](int i, int j, int k) { return brick[static_cast<std::size_t>((k * 6 + j) * 6 + i)]; };
+
+  // The payload starts at voxel (4, 4, 0), after one apron voxel
+  REQUIRE(stored(1, 1, 1) == rampValue(glm::uvec3{4, 4, 0}));
+  REQUIRE(stored(0, 0, 1) == rampValue(glm::uvec3{3, 3, 0}));
+  REQUIRE(stored(5, 2, 2) == rampValue(glm::uvec3{8, 5, 1}));
+
+  // Voxels past the level boundary repeat the boundary voxels
+  REQUIRE(stored(1, 4, 1) == rampValue(glm::uvec3{4, 6, 0}));
+  REQUIRE(stored(1, 5, 1) == rampValue(glm::uvec3{4, 6, 0}));
+  REQUIRE(stored(1, 1, 0) == rampValue(glm::uvec3{4, 4, 0}));
+  REQUIRE(stored(1, 1, 5) == rampValue(glm::uvec3{4, 4, 2}));
+}
+
+TEST_CASE("pyramid levels average blocks of the finer level", "[rendering][bricking]")
+{
+  const glm::uvec3 size{5, 4, 3};
+
+  for (unsigned int numThreads : {1u, 2u, 8u}) {
+    const std::vector<float> coarse = bricking::downsampleLevel(rampValue, size, numThreads);
+    REQUIRE(coarse.size() == 3 * 2 * 2);
+
+    // Averages of the ramp are the ramp at the block centers
+    REQUIRE(coarse[0] == rampValue(glm::uvec3{0, 0, 0}) + 0.5f + 50.0f + 5000.0f);
+    REQUIRE(coarse[1] == rampValue(glm::uvec3{2, 0, 0}) + 0.5f + 50.0f + 5000.0f);
+
+    // Blocks past odd boundaries repeat the boundary voxels
+    REQUIRE(coarse[2] == rampValue(glm::uvec3{4, 0, 0}) + 50.0f + 5000.0f);
+    REQUIRE(coarse[3 * 2 * 1 + 3 * 1 + 0] == rampValue(glm::uvec3{0, 2, 2}) + 0.5f + 50.0f);
+  }
+}
+
+TEST_CASE("brick cache evicts the least recently used bricks of earlier frames", "[rendering][bricking]")
+{
+  bricking::BrickCache cache(glm::uvec3{2, 1, 2}, 1000);
+  REQUIRE(cache.numSlots() == 4);
+  REQUIRE(cache.slotCoordinates(3) == glm::uvec3{1, 0, 1});
+
+  auto key = [](uint32_t i) { return BrickKey{0, glm::uvec3{i, 0, 0}}; };
+
+  cache.beginFrame();
+  for (uint32_t i = 0; i < 4; ++i) {
+    const auto request = cache.request(key(i));
+    REQUIRE(request);
+    REQUIRE_FALSE(request->hit);
+  }
+
+  // All slots hold bricks of this frame
+  REQUIRE_FALSE(cache.request(key(4)));
+  REQUIRE(cache.frameStats().requests == 5);
+  REQUIRE(cache.frameStats().misses == 4);
+  REQUIRE(cache.frameStats().rejected == 1);
+  REQUIRE(cache.frameStats().bytesUploaded == 4000);
+  REQUIRE(cache.numUsedInFrame() == 4);
+
+  cache.beginFrame();
+  REQUIRE(cache.frameStats().requests == 0);
+
+  const auto hit = cache.request(key(0));
+  REQUIRE(hit);
+  REQUIRE(hit->hit);
+  REQUIRE(cache.request(key(2))->hit);
+
+  // Brick 1 is now the least recently used brick
+  const std::optional<std::size_t> slot1 = cache.residentSlot(key(1));
+  REQUIRE(slot1);
+  const auto miss = cache.request(key(5));
+  REQUIRE(miss);
+  REQUIRE_FALSE(miss->hit);
+  REQUIRE(miss->slot == *slot1);
+  REQUIRE_FALSE(cache.residentSlot(key(1)));
+
+  REQUIRE(cache.frameStats().hits == 2);
+  REQUIRE(cache.frameStats().evictions == 1);
+  REQUIRE(cache.frameStats().bytesUploaded == 1000);
+  REQUIRE(cache.frameStats().hitRate() == 2.0 / 3.0);
+  REQUIRE(cache.totalStats().requests == 8);
+  REQUIRE(cache.totalStats().bytesUploaded == 5000);
+  REQUIRE(cache.numResident() == 4);
+
+  cache.clear();
+  REQUIRE(cache.numResident() == 0);
+  REQUIRE_FALSE(cache.request(key(0))->hit);
+}
+
+TEST_CASE("brick planner chooses levels for the screen resolution and budget", "[rendering][bricking]")
+{
+  const bricking::BrickPyramid pyramid(glm::uvec3{2000, 1500, 1000});
+  REQUIRE(pyramid.numLevels() == 8);
+  REQUIRE(bricking::levelForResolution(pyramid, 0.25f) == 0);
+  REQUIRE(bricking::levelForResolution(pyramid, 1.0f) == 0);
+  REQUIRE(bricking::levelForResolution(pyramid, 3.9f) == 1);
+  REQUIRE(bricking::levelForResolution(pyramid, 4.0f) == 2);
+  REQUIRE(bricking::levelForResolution(pyramid, 1.0e9f) == 7);
+
+  // An axial slab of 300 x 200 voxels around z = 500 at full resolution
+  const glm::vec3 voxelMin{400.0f, 300.0f, 499.0f};
+  const glm::vec3 voxelMax{700.0f, 500.0f, 501.0f};
+
+  std::vector<BrickKey> plan = bricking::planBricks(pyramid, voxelMin, voxelMax, 0.5f, 1000);
+  REQUIRE(plan.size() == 1 + 11 * 7 * 1);
+  REQUIRE(plan.front() == BrickKey{7, glm::uvec3{0}});
+  REQUIRE(std::all_of(plan.begin() + 1, plan.end(), [](const BrickKey& key) { return 0 == key.level; }));
+
+  // Bricks nearest to the center of the box come first
+  REQUIRE(plan[1] == BrickKey{0, glm::uvec3{18, 13, 16}});
+
+  // A smaller budget coarsens the plan
+  plan = bricking::planBricks(pyramid, voxelMin, voxelMax, 0.5f, 50);
+  REQUIRE(plan.size() == 1 + 6 * 4 * 1);
+  REQUIRE(plan.back().level == 1);
+
+  // Without budget for any finer level, only the coarsest level is planned
+  plan = bricking::planBricks(pyramid, voxelMin, voxelMax, 0.5f, 1);
+  REQUIRE(plan.size() == 1);
+  REQUIRE(bricking::planBricks(pyramid, voxelMin, voxelMax, 0.5f, 0).empty());
+
+  // Without the coarser levels, only the level-0 bricks nearest to the center are planned
+  plan = bricking::planBricks(pyramid, voxelMin, voxelMax, 0.5f, 20, 0);
+  REQUIRE(plan.size() == 20);
+  REQUIRE(plan.front() == BrickKey{0, glm::uvec3{18, 13, 16}});
+  REQUIRE(std::all_of(plan.begin(), plan.end(), [](const BrickKey& key) { return 0 == key.level; }));
+
+  plan = bricking::planBricks(pyramid, voxelMin, voxelMax, 8.0f, 1000, 1);
+  REQUIRE(plan.size() == 6 * 4 * 1);
+  REQUIRE(std::all_of(plan.begin(), plan.end(), [](const BrickKey& key) { return 1 == key.level; }));
+
+  // Zooming out plans coarser bricks
+  plan = bricking::planBricks(pyramid, voxelMin, voxelMax, 8.0f, 1000);
+  REQUIRE(plan.size() == 1 + 2 * 2 * 1);
+  REQUIRE(std::all_of(plan.begin() + 1, plan.end(), [](const BrickKey& key) { return 3 == key.level; }));
+}
+
+TEST_CASE("brick cache hit rates while panning a view", "[rendering][bricking]")
+{
+  const bricking::BrickPyramid pyramid(glm::uvec3{4000, 4000, 2000});
+  const std::size_t bytesPerBrick = pyramid.storedVoxelsPerBrick() * sizeof(float);
+  bricking::BrickCache cache(glm::uvec3{16, 16, 8}, bytesPerBrick);
+
+  glm::vec3 voxelMin{1000.0f, 1000.0f, 999.0f};
+  glm::vec3 voxelMax{1800.0f, 1600.0f, 1001.0f};
+
+  for (int frame = 0; frame < 60; ++frame) {
+    cache.beginFrame();
+
+    const std::vector<BrickKey> plan =
+      bricking::planBricks(pyramid, voxelMin, voxelMax, 1.0f, cache.numSlots() - cache.numUsedInFrame());
+    REQUIRE(plan.size() <= 1 + 28 * 21);
+
+    for (const BrickKey& key : plan) {
+      REQUIRE(cache.request(key));
+    }
+
+    const bricking::BrickCacheStats& stats = cache.frameStats();
+    REQUIRE(stats.bytesUploaded == stats.misses * bytesPerBrick);
+
+    if (0 == frame) {
+      REQUIRE(stats.hits == 0);
+    }
+    else {
+      // Panning by 5 voxels per frame uncovers at most one column and one row of bricks
+      REQUIRE(stats.misses <= 28 + 21 + 1);
+      REQUIRE(stats.hitRate() > 0.9);
+    }
+
+    voxelMin += glm::vec3{5.0f, 3.0f, 0.0f};
+    voxelMax += glm::vec3{5.0f, 3.0f, 0.0f};
+  }
+
+  REQUIRE(cache.totalStats().hitRate() > 0.95);
+
+  // Revisiting the same view uploads nothing
+  cache.beginFrame();
+  for (const BrickKey& key : bricking::planBricks(pyramid, voxelMin, voxelMax, 1.0f, cache.numSlots())) {
+    cache.request(key);
+  }
+  cache.beginFrame();
+  for (const BrickKey& key : bricking::planBricks(pyramid, voxelMin, voxelMax, 1.0f, cache.numSlots())) {
+    cache.request(key);
+  }
+  REQUIRE(cache.frameStats().hitRate() == 1.0);
+  REQUIRE(cache.frameStats().bytesUploaded == 0);
+}
+
+TEST_CASE("brick indirection table points to the finest resident bricks", "[rendering][bricking]")
+{
+  const bricking::BrickPyramid pyramid(glm::uvec3{100, 70, 9});
+  bricking::BrickCache cache(glm::uvec3{2, 2, 1}, 1);
+
+  auto entry = [&pyramid](const std::vector<uint16_t>& table, const glm::uvec3& brick) {
+    const glm::uvec3 counts = pyramid.brickCounts(0);
+    const std::size_t e = (static_cast<std::size_t>(brick.z) * counts.y + brick.y) * counts.x + brick.x;
+    return std::vector<uint16_t>{table.begin() + 4 * e, table.begin() + 4 * e + 4};
+  };
+
+  std::vector<uint16_t> table = bricking::buildIndirectionTable(pyramid, cache);
+  REQUIRE(table.size() == 4 * 12);
+  REQUIRE(entry(table, glm::uvec3{2, 1, 0})[3] == bricking::k_nonResidentLevel);
+
+  cache.beginFrame();
+  const std::size_t coarseSlot = cache.request(BrickKey{2, glm::uvec3{0}})->slot;
+  const std::size_t level1Slot = cache.request(BrickKey{1, glm::uvec3{1, 0, 0}})->slot;
+  const std::size_t level0Slot = cache.request(BrickKey{0, glm::uvec3{3, 1, 0}})->slot;
+
+  auto expected = [&cache](std::size_t slot, uint16_t level) {
+    const glm::uvec3 s = cache.slotCoordinates(slot);
+    return std::vector<uint16_t>{
+      static_cast<uint16_t>(s.x),
+      static_cast<uint16_t>(s.y),
+      static_cast<uint16_t>(s.z),
+      level};
+  };
+
+  table = bricking::buildIndirectionTable(pyramid, cache);
+  REQUIRE(entry(table, glm::uvec3{0, 0, 0}) == expected(coarseSlot, 2));
+  REQUIRE(entry(table, glm::uvec3{0, 2, 0}) == expected(coarseSlot, 2));
+  REQUIRE(entry(table, glm::uvec3{2, 0, 0}) == expected(level1Slot, 1));
+  REQUIRE(entry(table, glm::uvec3{3, 0, 0}) == expected(level1Slot, 1));
+  REQUIRE(entry(table, glm::uvec3{2, 1, 0}) == expected(level1Slot, 1));
+  REQUIRE(entry(table, glm::uvec3{3, 1, 0}) == expected(level0Slot, 0));
+  REQUIRE(entry(table, glm::uvec3{3, 2, 0}) == expected(coarseSlot, 2));
+}
+
+TEST_CASE("brick pools fit the slot budget and texture limit", "[rendering][bricking]")
+{
+  REQUIRE(bricking::brickPoolSlotCounts(2048, glm::uvec3{32}, 2048) == glm::uvec3{16, 16, 8});
+  REQUIRE(bricking::brickPoolSlotCounts(3000, glm::uvec3{32}, 2048) == glm::uvec3{16, 16, 8});
+  REQUIRE(bricking::brickPoolSlotCounts(2048, glm::uvec3{32}, 256) == glm::uvec3{8, 8, 8});
+  REQUIRE(bricking::brickPoolSlotCounts(1, glm::uvec3{32}, 2048) == glm::uvec3{1, 1, 1});
+  REQUIRE(bricking::brickPoolSlotCounts(0, glm::uvec3{32}, 2048) == glm::uvec3{0});
+  REQUIRE(bricking::brickPoolSlotCounts(2048, glm::uvec3{32}, 16) == glm::uvec3{0});
+}
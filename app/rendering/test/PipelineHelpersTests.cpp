@@ -23,7 +23,8 @@ TEST_CASE("rendering helpers preserve 3D shader texture lookup replacements", "[
     .floatingPointLinear2D = "floatingLinear2D",
     .cubic3D = "cubic3D",
     .cubic2D = "cubic2D",
-    .uintLinear2D = "uintLinear2D"};
+    .uintLinear2D = "uintLinear2D",
+    .bricked = "bricked"};
   const std::unordered_map<std::string, std::string> replacements{
     {"$$TEXTURE_LOOKUP_FUNCTION$$", "cubic3D"},
     {"$$UINT_TEXTURE_LOOKUP_FUNCTION$$", "uintLinear3D"},
@@ -50,7 +51,8 @@ TEST_CASE("rendering helpers adapt shader texture lookup replacements for 2D tex
     .floatingPointLinear2D = "floatingLinear2D",
     .cubic3D = "cubic3D",
     .cubic2D = "cubic2D",
-    .uintLinear2D = "uintLinear2D"};
+    .uintLinear2D = "uintLinear2D",
+    .bricked = "bricked"};
 
   auto replacements = std::unordered_map<std::string, std::string>{
     {"$$TEXTURE_LOOKUP_FUNCTION$$", "linear3D"},
@@ -79,6 +81,34 @@ TEST_CASE("rendering helpers adapt shader texture lookup replacements for 2D tex
   REQUIRE(result.at("$$TEXTURE_LOOKUP_FUNCTION$$") == "cubic2D");
 }
 
+TEST_CASE("rendering helpers adapt shader texture lookup replacements for bricked textures", "[rendering][helpers]")
+{
+  const rendering::TextureLookupReplacementSources lookupSources{
+    .linear3D = "linear3D",
+    .linear2D = "linear2D",
+    .floatingPointLinear3D = "floatingLinear3D",
+    .floatingPointLinear2D = "floatingLinear2D",
+    .cubic3D = "cubic3D",
+    .cubic2D = "cubic2D",
+    .uintLinear2D = "uintLinear2D",
+    .bricked = "bricked"};
+
+  for (const std::string lookup : {"linear3D", "floatingLinear3D", "cubic3D"}) {
+    const std::unordered_map<std::string, std::string> replacements{
+      {"$$TEXTURE_LOOKUP_FUNCTION$$", lookup},
+      {"$$UINT_TEXTURE_LOOKUP_FUNCTION$$", "uintLinear3D"}};
+    const auto result = rendering::shaderReplacementsForTextureDimension(
+      replacements,
+      rendering::TextureDimension::Bricked,
+      lookupSources);
+
+    REQUIRE(result.at("$$IMAGE_SAMPLER_TYPE$$") == "sampler3D");
+    REQUIRE(result.at("$$SEG_SAMPLER_TYPE$$") == "usampler3D");
+    REQUIRE(result.at("$$TEXTURE_LOOKUP_FUNCTION$$") == "bricked");
+    REQUIRE(result.at("$$UINT_TEXTURE_LOOKUP_FUNCTION$$") == "uintLinear3D");
+  }
+}
+
 TEST_CASE(
   "rendering helpers add only sampler placeholders when 2D lookup placeholders are absent",
   "[rendering][helpers]")
@@ -90,7 +120,8 @@ TEST_CASE(
     .floatingPointLinear2D = "floatingLinear2D",
     .cubic3D = "cubic3D",
     .cubic2D = "cubic2D",
-    .uintLinear2D = "uintLinear2D"};
+    .uintLinear2D = "uintLinear2D",
+    .bricked = "bricked"};
   const std::unordered_map<std::string, std::string> replacements{{"$$OTHER$$", "unchanged"}};
 
   const auto result = rendering::shaderReplacementsForTextureDimension(
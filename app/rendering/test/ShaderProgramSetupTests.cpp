@@ -85,6 +85,7 @@ TEST_CASE("shader program setup registers every main renderer shader exactly onc
   REQUIRE_FALSE(setup.shaderInfo.contains(ShaderProgramType::AsciiCellRegions));
   REQUIRE_FALSE(setup.shaderInfo.contains(ShaderProgramType::AsciiPostSpatial));
   REQUIRE_FALSE(setup.shaderInfo.contains(ShaderProgramType::PixelEdgePost));
+  REQUIRE_FALSE(setup.shaderInfo.contains(ShaderProgramType::ViewRenderCacheComposite));
 }
 
 TEST_CASE("shader program setup exposes complete texture lookup replacement sources", "[rendering][shaders]")
@@ -98,4 +99,5 @@ TEST_CASE("shader program setup exposes complete texture lookup replacement sour
   REQUIRE_FALSE(setup.lookupReplacementSources.cubic3D.empty());
   REQUIRE_FALSE(setup.lookupReplacementSources.cubic2D.empty());
   REQUIRE_FALSE(setup.lookupReplacementSources.uintLinear2D.empty());
+  REQUIRE_FALSE(setup.lookupReplacementSources.bricked.empty());
 }
@@ -44,3 +44,30 @@ TEST_CASE("texture setup helpers reject planar images that exceed 2D limits", "[
   const texture_setup::TextureLimits limits{.maxTextureSize = 4096, .max3DTextureSize = 2048};
   REQUIRE_FALSE(texture_setup::textureUploadLayoutForImage(glm::uvec3{1, 8192, 1536}, limits));
 }
+
+TEST_CASE("texture setup helpers page oversized images into bricks when allowed", "[rendering][texture-setup]")
+{
+  const texture_setup::TextureLimits limits{.maxTextureSize = 4096, .max3DTextureSize = 2048};
+
+  for (const glm::uvec3& size : {glm::uvec3{4096, 4096, 2}, glm::uvec3{1, 8192, 1536}}) {
+    const auto layout = texture_setup::textureUploadLayoutForImage(size, limits, true);
+
+    REQUIRE(layout);
+    REQUIRE(layout->layout.dimension == TextureDimension::Bricked);
+    REQUIRE(layout->uploadSize == size);
+  }
+
+  // Images that fit use a texture of their own
+  const auto layout = texture_setup::textureUploadLayoutForImage(glm::uvec3{1, 3072, 1536}, limits, true);
+  REQUIRE(layout);
+  REQUIRE(layout->layout.dimension == TextureDimension::Texture2D);
+
+  // Planar images are paged in tiles
+  const auto planarLayout = texture_setup::textureUploadLayoutForImage(glm::uvec3{100000, 60000, 1}, limits, true);
+  REQUIRE(planarLayout);
+  REQUIRE(planarLayout->layout.dimension == TextureDimension::Bricked);
+
+  // Not even one brick fits within the 3D limit
+  const texture_setup::TextureLimits tinyLimits{.maxTextureSize = 16, .max3DTextureSize = 16};
+  REQUIRE_FALSE(texture_setup::textureUploadLayoutForImage(glm::uvec3{64, 64, 64}, tinyLimits, true));
+}
@@ -0,0 +1,75 @@
+#include "rendering/helpers/ViewRenderCacheHelpers.h"
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace view_cache = rendering::view_cache;
+
+TEST_CASE("frame revision changes with the input revision and on the following frame", "[rendering][view_cache]")
+{
+  view_cache::FrameRevision revision;
+
+  const uint64_t first = revision.update(0);
+  const uint64_t settled = revision.update(0);
+  CHECK(settled != first);
+  CHECK(revision.update(0) == settled);
+  CHECK(revision.update(0) == settled);
+
+  const uint64_t changed = revision.update(1);
+  CHECK(changed != settled);
+  const uint64_t changedSettled = revision.update(1);
+  CHECK(changedSettled != changed);
+  CHECK(revision.update(1) == changedSettled);
+}
+
+TEST_CASE("frame revision keeps changing while the input revision changes every frame", "[rendering][view_cache]")
+{
+  view_cache::FrameRevision revision;
+
+  uint64_t last = revision.update(0);
+  for (uint64_t input = 1; input < 5; ++input) {
+    const uint64_t next = revision.update(input);
+    CHECK(next != last);
+    last = next;
+  }
+
+  const uint64_t settled = revision.update(4);
+  CHECK(settled != last);
+  CHECK(revision.update(4) == settled);
+}
+
+TEST_CASE("views are stale when uncached or when their inputs change", "[rendering][view_cache]")
+{
+  view_cache::ViewRenderKey key;
+  key.revision = 3;
+  key.worldOffsetXhairs = glm::vec3{1.0f, 2.0f, 3.0f};
+  key.clipViewport = glm::vec4{-1.0f, -1.0f, 1.0f, 1.0f};
+
+  const view_cache::CachedViewRender cached{key};
+
+  CHECK(view_cache::isStale(nullptr, key));
+  CHECK_FALSE(view_cache::isStale(&cached, key));
+
+  view_cache::ViewRenderKey otherRevision = key;
+  otherRevision.revision = 4;
+  CHECK(view_cache::isStale(&cached, otherRevision));
+
+  view_cache::ViewRenderKey movedCamera = key;
+  movedCamera.world_T_clip[3][0] = 5.0f;
+  CHECK(view_cache::isStale(&cached, movedCamera));
+
+  view_cache::ViewRenderKey movedCrosshairs = key;
+  movedCrosshairs.worldOffsetXhairs.z = 4.0f;
+  CHECK(view_cache::isStale(&cached, movedCrosshairs));
+
+  view_cache::ViewRenderKey movedView = key;
+  movedView.clipViewport.z = 0.5f;
+  CHECK(view_cache::isStale(&cached, movedView));
+}
+
+TEST_CASE("view render cache hit rate", "[rendering][view_cache]")
+{
+  CHECK(view_cache::ViewRenderCacheStats{}.hitRate() == 0.0);
+  CHECK(view_cache::ViewRenderCacheStats{.hits = 3, .misses = 1}.hitRate() == Catch::Approx(0.75));
+  CHECK(view_cache::ViewRenderCacheStats{.hits = 0, .misses = 4}.hitRate() == 0.0);
+}
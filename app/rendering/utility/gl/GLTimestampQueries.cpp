@@ -0,0 +1,82 @@
+#include "rendering/utility/gl/GLTimestampQueries.h"
+
+#include <spdlog/spdlog.h>
+
+namespace
+{
+
+/// Number of query names generated at once
+constexpr GLsizei sk_queryBatchSize = 64;
+
+} // namespace
+
+std::unique_ptr<GLTimestampQueries> GLTimestampQueries::create()
+{
+  // Timestamp queries are core in OpenGL 3.3, but a driver may report a timestamp counter without any bits
+  if (!glQueryCounter || !glGetQueryObjectui64v || !glGetInteger64v) {
+    spdlog::debug("OpenGL timestamp queries are not available; GPU profiling is disabled");
+    return nullptr;
+  }
+
+  GLint counterBits = 0;
+  glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &counterBits);
+  if (counterBits <= 0) {
+    spdlog::debug("OpenGL timestamp counter has no bits; GPU profiling is disabled");
+    return nullptr;
+  }
+
+  spdlog::debug("OpenGL timestamp counter has {} bits", counterBits);
+  return std::unique_ptr<GLTimestampQueries>(new GLTimestampQueries());
+}
+
+GLTimestampQueries::~GLTimestampQueries()
+{
+  if (!m_queries.empty()) {
+    glDeleteQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+  }
+}
+
+std::optional<uint32_t> GLTimestampQueries::record()
+{
+  if (m_freeQueries.empty()) {
+    if (m_queries.size() + sk_queryBatchSize > sk_maxQueries) {
+      return std::nullopt;
+    }
+
+    std::vector<GLuint> batch(sk_queryBatchSize, 0);
+    glGenQueries(sk_queryBatchSize, batch.data());
+    m_queries.insert(std::end(m_queries), std::begin(batch), std::end(batch));
+    m_freeQueries.insert(std::end(m_freeQueries), std::rbegin(batch), std::rend(batch));
+  }
+
+  const GLuint query = m_freeQueries.back();
+  m_freeQueries.pop_back();
+
+  glQueryCounter(query, GL_TIMESTAMP);
+  return query;
+}
+
+std::optional<int64_t> GLTimestampQueries::result(uint32_t query)
+{
+  GLint available = GL_FALSE;
+  glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+  if (GL_FALSE == available) {
+    return std::nullopt;
+  }
+
+  GLuint64 timestampNs = 0;
+  glGetQueryObjectui64v(query, GL_QUERY_RESULT, &timestampNs);
+  return static_cast<int64_t>(timestampNs);
+}
+
+void GLTimestampQueries::release(uint32_t query)
+{
+  m_freeQueries.push_back(query);
+}
+
+std::optional<int64_t> GLTimestampQueries::currentTime()
+{
+  GLint64 timestampNs = 0;
+  glGetInteger64v(GL_TIMESTAMP, &timestampNs);
+  return static_cast<int64_t>(timestampNs);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "common/FrameProfiler.h"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+/**
+ * @brief GPU timestamps for the frame profiler, recorded with OpenGL timestamp queries (`glQueryCounter`).
+ *
+ * Query names are generated in batches and reused once their results are read. The object must be destroyed while
+ * its context is current.
+ */
+class GLTimestampQueries final : public profiling::GpuTimestampQueries
+{
+public:
+  /// Maximum number of query names, which bounds the queries in flight when results are slow to arrive
+  static constexpr std::size_t sk_maxQueries = 4096;
+
+  /// @return Timestamp queries, or null if the current context cannot record timestamps
+  static std::unique_ptr<GLTimestampQueries> create();
+
+  ~GLTimestampQueries() override;
+
+  GLTimestampQueries(const GLTimestampQueries&) = delete;
+  GLTimestampQueries& operator=(const GLTimestampQueries&) = delete;
+
+  std::optional<uint32_t> record() override;
+  std::optional<int64_t> result(uint32_t query) override;
+  void release(uint32_t query) override;
+  std::optional<int64_t> currentTime() override;
+
+private:
+  GLTimestampQueries() = default;
+
+  std::vector<GLuint> m_queries;     //!< All generated query names
+  std::vector<GLuint> m_freeQueries; //!< Query names available for recording
+};
@@ -5,6 +5,7 @@
 #include "common/DirectionMaps.h"
 #include "common/Viewport.h"
 #include "image/Image.h"
+#include "image/ImageSampler.h"
 
 #include "logic/app/DeformationWarp.h"
 #include "logic/app/Data.h"
@@ -36,6 +37,7 @@
 #include <functional>
 #include <list>
 #include <limits>
+#include <optional>
 #include <vector>
 
 namespace
@@ -1143,7 +1145,12 @@ void drawVectorFieldArrows(
       k_referenceArrowLengthPx,
       k_maxArrowLengthPx);
 
-    const auto drawSample = [&](const glm::vec2& samplePos, const glm::vec3& subjectPos, const glm::vec3& pixelPos) {
+    // Arrow positions are collected first and the vector field is then sampled at all of them in one batch
+    std::vector<glm::vec2> samplePositions;
+    std::vector<glm::vec3> subjectPositions;
+    std::vector<glm::vec3> pixelPositions;
+
+    const auto queueSample = [&](const glm::vec2& samplePos, const glm::vec3& subjectPos, const glm::vec3& pixelPos) {
       const glm::vec2 viewClipPos =
         vector_drawing::viewClipFromMiewport(windowViewport, view.viewClip_T_windowClip(), samplePos);
       const glm::vec2 checkerCoord = vector_drawing::checkerCoordForViewClip(viewClipPos, numCheckers, aspectRatio);
@@ -1161,17 +1168,15 @@ void drawVectorFieldArrows(
         return;
       }
 
-      const auto xValue = image->valueLinear<double>(0, pixelPos.x, pixelPos.y, pixelPos.z, activeTimePoint);
-      const auto yValue = image->valueLinear<double>(1, pixelPos.x, pixelPos.y, pixelPos.z, activeTimePoint);
-      const auto zValue = image->valueLinear<double>(2, pixelPos.x, pixelPos.y, pixelPos.z, activeTimePoint);
-      if (!xValue || !yValue || !zValue) {
-        return;
-      }
+      samplePositions.push_back(samplePos);
+      subjectPositions.push_back(subjectPos);
+      pixelPositions.push_back(pixelPos);
+    };
+
+    const auto drawSample = [&](std::size_t sampleIndex, const glm::vec3& subjectVector) {
+      const glm::vec2& samplePos = samplePositions[sampleIndex];
+      const glm::vec3& subjectPos = subjectPositions[sampleIndex];
 
-      const glm::vec3 subjectVector{
-        static_cast<float>(*xValue),
-        static_cast<float>(*yValue),
-        static_cast<float>(*zValue)};
       if (glm::length(subjectVector) <= std::numeric_limits<float>::epsilon()) {
         return;
       }
@@ -1264,7 +1269,7 @@ void drawVectorFieldArrows(
             continue;
           }
 
-          drawSample(samplePos, subjectPos, pixelPos);
+          queueSample(samplePos, subjectPos, pixelPos);
         }
       }
     }
@@ -1280,7 +1285,23 @@ void drawVectorFieldArrows(
           const glm::vec3 worldOnSlice = worldNear - signedDistance * worldViewNormal;
           const glm::vec3 subjectPos{subject_T_world * glm::vec4{worldOnSlice, 1.0f}};
           const glm::vec3 pixelPos{pixel_T_subject * glm::vec4{subjectPos, 1.0f}};
-          drawSample(samplePos, subjectPos, pixelPos);
+          queueSample(samplePos, subjectPos, pixelPos);
+        }
+      }
+    }
+
+    ImageSamplerOptions samplerOptions;
+    samplerOptions.timePoint = activeTimePoint;
+    samplerOptions.numComponents = 3;
+
+    if (const auto samples = sampleImageAtPixels(*image, pixelPositions, samplerOptions)) {
+      for (std::size_t i = 0; i < samples->size(); ++i) {
+        if (samples->isValid(i)) {
+          const glm::vec3 subjectVector{
+            static_cast<float>(samples->value(i, 0)),
+            static_cast<float>(samples->value(i, 1)),
+            static_cast<float>(samples->value(i, 2))};
+          drawSample(i, subjectVector);
         }
       }
     }
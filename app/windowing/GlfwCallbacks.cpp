@@ -82,6 +82,15 @@ bool isLeftDoubleClick(int button, int action, const glm::vec2& windowCursorPos)
   s_lastLeftClickWindowPos = windowCursorPos;
   return isDoubleClick;
 }
+
+// Render all views again instead of compositing them from the view render cache. Input events can change anything
+// that views depend on, including settings that are edited in the UI.
+void invalidateViewRenderCache(GLFWwindow* window)
+{
+  if (auto* app = reinterpret_cast<EntropyApp*>(glfwGetWindowUserPointer(window))) {
+    app->rendering().invalidateViewRenderCache();
+  }
+}
 } // namespace
 
 void errorCallback(int error, const char* description)
@@ -99,6 +108,8 @@ void windowContentScaleCallback(GLFWwindow* window, float contentScaleX, float c
 
   spdlog::debug("*** windowContentScaleCallback: {}x{} ", contentScaleX, contentScaleY);
 
+  invalidateViewRenderCache(window);
+
   app->windowData().setContentScaleRatios(glm::vec2{contentScaleX, contentScaleY});
   app->imgui().setContentScale(app->windowData().getContentScaleRatio());
   app->glfw().postEmptyEvent();
@@ -184,6 +195,11 @@ void cursorPosCallback(GLFWwindow* window, double mindowCursorPosX, double mindo
 
   const ImGuiIO& io = ImGui::GetIO();
 
+  // Moving the cursor over the UI changes nothing in the views, unless it drags a UI control
+  if (!io.WantCaptureMouse || ImGui::IsAnyMouseDown()) {
+    invalidateViewRenderCache(window);
+  }
+
   if (io.WantCaptureMouse) {
     // Poll events, so that the UI is responsive:
     app->glfw().setEventProcessingMode(EventProcessingMode::Poll);
@@ -584,6 +600,8 @@ void cursorPosCallback(GLFWwindow* window, double mindowCursorPosX, double mindo
 
 void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
 {
+  invalidateViewRenderCache(window);
+
   auto* app = reinterpret_cast<EntropyApp*>(glfwGetWindowUserPointer(window));
   if (!app) {
     spdlog::warn("App is null in mouse button callback");
@@ -605,6 +623,9 @@ void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
   s_imageScaleEffectivePrevHit = std::nullopt;
   s_imageScaleViewAxisConstraint = std::nullopt;
 
+  // Pressing or releasing a button ends any segmentation brush stroke
+  app->callbackHandler().endSegmentStroke();
+
   double mindowCursorPosX = std::numeric_limits<double>::quiet_NaN();
   double mindowCursorPosY = std::numeric_limits<double>::quiet_NaN();
   glfwGetCursorPos(window, &mindowCursorPosX, &mindowCursorPosY);
@@ -655,6 +676,8 @@ void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
 
 void scrollCallback(GLFWwindow* window, double scrollOffsetX, double scrollOffsetY)
 {
+  invalidateViewRenderCache(window);
+
   const ImGuiIO& io = ImGui::GetIO();
   if (io.WantCaptureMouse) {
     return; // ImGui has captured event
@@ -724,6 +747,8 @@ void scrollCallback(GLFWwindow* window, double scrollOffsetX, double scrollOffse
 
 void keyCallback(GLFWwindow* window, int key, int /*scancode*/, int action, int mods)
 {
+  invalidateViewRenderCache(window);
+
   const ImGuiIO& io = ImGui::GetIO();
   if (io.WantCaptureKeyboard) {
     return; // ImGui has captured event
@@ -787,12 +812,27 @@ void keyCallback(GLFWwindow* window, int key, int /*scancode*/, int action, int
       break;
     }
     case GLFW_KEY_Y: {
-      H.setMouseMode(MouseMode::ImageScale);
+      if (s_modifierState.control || s_modifierState.super) {
+        H.redoSegmentationEdit();
+      }
+      else {
+        H.setMouseMode(MouseMode::ImageScale);
+      }
       break;
     }
 
     case GLFW_KEY_Z: {
-      H.setMouseMode(MouseMode::CameraZoom);
+      if (s_modifierState.control || s_modifierState.super) {
+        if (s_modifierState.shift) {
+          H.redoSegmentationEdit();
+        }
+        else {
+          H.undoSegmentationEdit();
+        }
+      }
+      else {
+        H.setMouseMode(MouseMode::CameraZoom);
+      }
       break;
     }
     case GLFW_KEY_X: {
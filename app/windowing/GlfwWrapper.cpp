@@ -2,6 +2,7 @@
 
 #include "EntropyApp.h"
 #include "common/Exception.hpp"
+#include "common/FrameProfiler.h"
 #include "common/Viewport.h"
 #include "ui/LinuxUiScale.h"
 #include "ui/ImGuiWrapper.h"
@@ -459,6 +460,9 @@ void GlfwWrapper::renderLoop(
 
   spdlog::debug("Starting GLFW rendering loop");
 
+  profiling::FrameProfiler& profiler = profiling::FrameProfiler::instance();
+  profiler.setThreadName("Main");
+
   auto lastFrameTime = Clock::now();
 
   while (!glfwWindowShouldClose(m_window)) {
@@ -482,14 +486,23 @@ void GlfwWrapper::renderLoop(
       m_framerateLimiter(lastFrameTime);
     }
 
+    // Profiled frames exclude the time spent throttling the frame rate and waiting for events
+    profiler.beginFrame();
+
     if (m_processBackground) {
+      const profiling::CpuScope scope("Background processing");
       m_processBackground();
     }
 
     processInput();
     renderOnce();
 
-    glfwSwapBuffers(m_window);
+    {
+      const profiling::CpuScope scope("Swap buffers");
+      glfwSwapBuffers(m_window);
+    }
+
+    profiler.endFrame();
 
     switch (m_eventProcessingMode) {
       case EventProcessingMode::Poll: {
@@ -0,0 +1,511 @@
+#include "common/FrameProfiler.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <map>
+#include <tuple>
+
+namespace profiling
+{
+
+namespace
+{
+
+/// Spans of the scopes of one thread, which are handed to the profiler once its outermost scope ends
+struct ThreadState
+{
+  std::optional<uint32_t> index;
+  uint32_t depth = 0;
+  std::vector<ProfileSpan> spans;
+};
+
+thread_local ThreadState t_thread;
+
+/// Chrome trace thread ID of the GPU track. CPU threads use their index plus one.
+constexpr uint32_t sk_gpuTraceThreadId = 0;
+
+void writeJsonString(std::ostream& os, std::string_view text)
+{
+  os << '"';
+  for (const char c : text) {
+    switch (c) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      case '\n':
+        os << "\\n";
+        break;
+      case '\r':
+        os << "\\r";
+        break;
+      case '\t':
+        os << "\\t";
+        break;
+      default: {
+        if (static_cast<unsigned char>(c) < 0x20) {
+          os << std::format("\\u{:04x}", static_cast<unsigned int>(c));
+        }
+        else {
+          os << c;
+        }
+      }
+    }
+  }
+  os << '"';
+}
+
+std::string formatMicroseconds(int64_t ns)
+{
+  return std::format("{:.3f}", static_cast<double>(ns) / 1000.0);
+}
+
+} // namespace
+
+std::atomic<bool> FrameProfiler::s_enabled{false};
+
+FrameProfiler& FrameProfiler::instance()
+{
+  static FrameProfiler s_profiler;
+  return s_profiler;
+}
+
+FrameProfiler::FrameProfiler()
+  : m_epoch(std::chrono::steady_clock::now())
+{
+}
+
+void FrameProfiler::setEnabled(bool enabled)
+{
+  s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void FrameProfiler::setGpuTimestampQueries(std::unique_ptr<GpuTimestampQueries> queries)
+{
+  if (m_gpuQueries) {
+    for (const PendingGpuSpan& pending : m_pendingGpuSpans) {
+      m_gpuQueries->release(pending.beginQuery);
+      if (pending.endQuery) {
+        m_gpuQueries->release(*pending.endQuery);
+      }
+    }
+  }
+
+  m_pendingGpuSpans.clear();
+  m_gpuDepth = 0;
+  m_gpuQueries = std::move(queries);
+}
+
+bool FrameProfiler::gpuTimingAvailable() const
+{
+  return (nullptr != m_gpuQueries);
+}
+
+void FrameProfiler::setThreadName(std::string name)
+{
+  const uint32_t index = currentThreadIndex();
+  std::lock_guard lock(m_threadsMutex);
+  m_threadNames.at(index) = std::move(name);
+}
+
+std::vector<std::string> FrameProfiler::threadNames() const
+{
+  std::lock_guard lock(m_threadsMutex);
+  return m_threadNames;
+}
+
+void FrameProfiler::beginFrame()
+{
+  m_inFrame = isEnabled();
+  if (!m_inFrame) {
+    return;
+  }
+
+  m_frameIndex.fetch_add(1, std::memory_order_relaxed);
+  m_frameStartNs = nowNs();
+
+  if (m_gpuQueries) {
+    if (const auto gpuNowNs = m_gpuQueries->currentTime()) {
+      m_gpuToCpuOffsetNs = nowNs() - *gpuNowNs;
+    }
+  }
+}
+
+void FrameProfiler::endFrame()
+{
+  if (m_inFrame) {
+    m_inFrame = false;
+
+    ProfiledFrame frame;
+    frame.index = m_frameIndex.load(std::memory_order_relaxed);
+    frame.startNs = m_frameStartNs;
+    frame.durationNs = nowNs() - m_frameStartNs;
+
+    {
+      std::lock_guard lock(m_pendingSpansMutex);
+      frame.spans.swap(m_pendingSpans);
+    }
+
+    captureSpans(frame.spans);
+
+    m_frames.push_back(std::move(frame));
+    while (m_frames.size() > sk_maxFrames) {
+      m_frames.pop_front();
+    }
+  }
+
+  resolveGpuSpans();
+}
+
+const std::deque<ProfiledFrame>& FrameProfiler::frames() const
+{
+  return m_frames;
+}
+
+void FrameProfiler::startCapture()
+{
+  m_capturedSpans.clear();
+  m_captureTruncated = false;
+  m_capturing = true;
+}
+
+void FrameProfiler::stopCapture()
+{
+  m_capturing = false;
+}
+
+bool FrameProfiler::capturing() const
+{
+  return m_capturing;
+}
+
+std::size_t FrameProfiler::capturedSpanCount() const
+{
+  return m_capturedSpans.size();
+}
+
+std::expected<std::size_t, std::string> FrameProfiler::exportCapture(const std::filesystem::path& fileName) const
+{
+  std::ofstream file(fileName, std::ios::out | std::ios::trunc);
+  if (!file) {
+    return std::unexpected(std::format("Unable to open {} for writing", fileName.string()));
+  }
+
+  writeChromeTrace(file, m_capturedSpans, threadNames());
+
+  file.close();
+  if (!file) {
+    return std::unexpected(std::format("Error writing trace to {}", fileName.string()));
+  }
+
+  spdlog::info("Wrote {} profiled spans to {}", m_capturedSpans.size(), fileName.string());
+  return m_capturedSpans.size();
+}
+
+void FrameProfiler::clear()
+{
+  m_frames.clear();
+  m_capturedSpans.clear();
+  m_captureTruncated = false;
+
+  std::lock_guard lock(m_pendingSpansMutex);
+  m_pendingSpans.clear();
+}
+
+int64_t FrameProfiler::nowNs() const
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+}
+
+uint32_t FrameProfiler::currentThreadIndex()
+{
+  if (!t_thread.index) {
+    std::lock_guard lock(m_threadsMutex);
+    t_thread.index = static_cast<uint32_t>(m_threadNames.size());
+    m_threadNames.push_back(std::format("Thread {}", *t_thread.index));
+  }
+  return *t_thread.index;
+}
+
+void FrameProfiler::flushThreadSpans(std::vector<ProfileSpan>& spans)
+{
+  std::lock_guard lock(m_pendingSpansMutex);
+
+  if (m_pendingSpans.size() + spans.size() <= sk_maxPendingSpans) {
+    std::move(std::begin(spans), std::end(spans), std::back_inserter(m_pendingSpans));
+  }
+  spans.clear();
+}
+
+std::optional<std::size_t> FrameProfiler::beginGpuSpan(const char* name, std::string detail)
+{
+  if (!m_gpuQueries) {
+    return std::nullopt;
+  }
+
+  const auto query = m_gpuQueries->record();
+  if (!query) {
+    return std::nullopt;
+  }
+
+  PendingGpuSpan pending;
+  pending.span.name = name;
+  pending.span.detail = std::move(detail);
+  pending.span.track = SpanTrack::Gpu;
+  pending.span.depth = m_gpuDepth++;
+  pending.span.frameIndex = m_frameIndex.load(std::memory_order_relaxed);
+  pending.beginQuery = *query;
+  pending.gpuToCpuOffsetNs = m_gpuToCpuOffsetNs;
+
+  m_pendingGpuSpans.push_back(std::move(pending));
+  return m_pendingGpuSpans.size() - 1;
+}
+
+void FrameProfiler::endGpuSpan(std::size_t pendingIndex)
+{
+  if (m_gpuDepth > 0) {
+    --m_gpuDepth;
+  }
+
+  // The span is gone if the timestamp source was replaced while the scope was open
+  if (!m_gpuQueries || pendingIndex >= m_pendingGpuSpans.size()) {
+    return;
+  }
+
+  m_pendingGpuSpans[pendingIndex].endQuery = m_gpuQueries->record();
+}
+
+void FrameProfiler::resolveGpuSpans()
+{
+  // Indices of pending spans are held by open scopes
+  if (m_pendingGpuSpans.empty() || m_gpuDepth > 0 || !m_gpuQueries) {
+    return;
+  }
+
+  const uint64_t frameIndex = m_frameIndex.load(std::memory_order_relaxed);
+
+  std::vector<ProfileSpan> resolved;
+  std::vector<PendingGpuSpan> stillPending;
+
+  for (PendingGpuSpan& pending : m_pendingGpuSpans) {
+    std::optional<int64_t> beginNs;
+    std::optional<int64_t> endNs;
+
+    // Timestamps complete in order, so the end result being available implies that the begin result is too
+    if (pending.endQuery) {
+      endNs = m_gpuQueries->result(*pending.endQuery);
+      beginNs = endNs ? m_gpuQueries->result(pending.beginQuery) : std::nullopt;
+    }
+
+    if (beginNs && endNs) {
+      pending.span.startNs = *beginNs + pending.gpuToCpuOffsetNs;
+      pending.span.durationNs = std::max<int64_t>(*endNs - *beginNs, 0);
+      resolved.push_back(std::move(pending.span));
+    }
+    else if (frameIndex <= pending.span.frameIndex + sk_maxGpuLatencyFrames) {
+      stillPending.push_back(std::move(pending));
+      continue;
+    }
+
+    m_gpuQueries->release(pending.beginQuery);
+    if (pending.endQuery) {
+      m_gpuQueries->release(*pending.endQuery);
+    }
+  }
+
+  m_pendingGpuSpans = std::move(stillPending);
+
+  captureSpans(resolved);
+
+  for (ProfiledFrame& frame : m_frames) {
+    for (ProfileSpan& span : resolved) {
+      if (span.frameIndex == frame.index) {
+        frame.spans.push_back(std::move(span));
+      }
+    }
+
+    frame.gpuPending = std::any_of(
+      std::begin(m_pendingGpuSpans),
+      std::end(m_pendingGpuSpans),
+      [&frame](const PendingGpuSpan& pending) { return pending.span.frameIndex == frame.index; });
+  }
+}
+
+void FrameProfiler::captureSpans(const std::vector<ProfileSpan>& spans)
+{
+  if (!m_capturing || spans.empty()) {
+    return;
+  }
+
+  if (m_capturedSpans.size() + spans.size() > sk_maxCapturedSpans) {
+    if (!m_captureTruncated) {
+      spdlog::warn("Profiler capture reached {} spans; later spans are not captured", sk_maxCapturedSpans);
+      m_captureTruncated = true;
+    }
+    return;
+  }
+
+  m_capturedSpans.insert(std::end(m_capturedSpans), std::begin(spans), std::end(spans));
+}
+
+void CpuScope::begin(const char* name, std::string detail)
+{
+  FrameProfiler& profiler = FrameProfiler::instance();
+
+  m_active = true;
+  m_name = name;
+  m_detail = std::move(detail);
+  m_depth = t_thread.depth++;
+  m_frameIndex = profiler.m_frameIndex.load(std::memory_order_relaxed);
+  m_startNs = profiler.nowNs();
+}
+
+void CpuScope::end()
+{
+  FrameProfiler& profiler = FrameProfiler::instance();
+
+  ProfileSpan span;
+  span.name = m_name;
+  span.detail = std::move(m_detail);
+  span.threadIndex = profiler.currentThreadIndex();
+  span.depth = m_depth;
+  span.frameIndex = m_frameIndex;
+  span.startNs = m_startNs;
+  span.durationNs = profiler.nowNs() - m_startNs;
+
+  t_thread.spans.push_back(std::move(span));
+
+  if (t_thread.depth > 0) {
+    --t_thread.depth;
+  }
+  if (0 == t_thread.depth) {
+    profiler.flushThreadSpans(t_thread.spans);
+  }
+}
+
+void GpuScope::beginPass(const char* name, std::string detail)
+{
+  CpuScope::begin(name, detail);
+  m_pendingIndex = FrameProfiler::instance().beginGpuSpan(name, std::move(detail));
+}
+
+std::vector<ScopeSummary> summarizeSpans(const std::vector<ProfileSpan>& spans)
+{
+  // Order the spans of each timeline so that every span follows its parent
+  std::vector<std::size_t> order(spans.size());
+  for (std::size_t i = 0; i < spans.size(); ++i) {
+    order[i] = i;
+  }
+
+  std::sort(std::begin(order), std::end(order), [&spans](std::size_t a, std::size_t b) {
+    const ProfileSpan& sa = spans[a];
+    const ProfileSpan& sb = spans[b];
+    return std::tie(sa.track, sa.threadIndex, sa.startNs, sa.depth) <
+           std::tie(sb.track, sb.threadIndex, sb.startNs, sb.depth);
+  });
+
+  std::vector<int64_t> selfNs(spans.size());
+  std::vector<std::size_t> ancestors;
+
+  for (std::size_t n = 0; n < order.size(); ++n) {
+    const std::size_t i = order[n];
+    const ProfileSpan& span = spans[i];
+    selfNs[i] = span.durationNs;
+
+    if (n > 0) {
+      const ProfileSpan& previous = spans[order[n - 1]];
+      if (previous.track != span.track || previous.threadIndex != span.threadIndex) {
+        ancestors.clear();
+      }
+    }
+
+    while (!ancestors.empty() && spans[ancestors.back()].depth >= span.depth) {
+      ancestors.pop_back();
+    }
+    if (!ancestors.empty()) {
+      selfNs[ancestors.back()] -= span.durationNs;
+    }
+    ancestors.push_back(i);
+  }
+
+  using Key = std::tuple<SpanTrack, std::string, std::string>;
+  std::map<Key, ScopeSummary> summaries;
+
+  for (std::size_t i = 0; i < spans.size(); ++i) {
+    const ProfileSpan& span = spans[i];
+    ScopeSummary& summary = summaries[Key{span.track, span.name, span.detail}];
+    summary.track = span.track;
+    summary.name = span.name;
+    summary.detail = span.detail;
+    ++summary.calls;
+    summary.totalNs += span.durationNs;
+    summary.selfNs += std::max<int64_t>(selfNs[i], 0);
+  }
+
+  std::vector<ScopeSummary> result;
+  result.reserve(summaries.size());
+  for (auto& entry : summaries) {
+    result.push_back(std::move(entry.second));
+  }
+
+  std::stable_sort(std::begin(result), std::end(result), [](const ScopeSummary& a, const ScopeSummary& b) {
+    return a.totalNs > b.totalNs;
+  });
+
+  return result;
+}
+
+void writeChromeTrace(
+  std::ostream& os,
+  const std::vector<ProfileSpan>& spans,
+  const std::vector<std::string>& threadNames)
+{
+  os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  bool first = true;
+  const auto beginEvent = [&os, &first]() {
+    os << (first ? "\n" : ",\n");
+    first = false;
+  };
+
+  const auto writeThreadName = [&os, &beginEvent](uint32_t traceThreadId, std::string_view name) {
+    beginEvent();
+    os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << traceThreadId << ",\"args\":{\"name\":";
+    writeJsonString(os, name);
+    os << "}}";
+  };
+
+  if (std::any_of(std::begin(spans), std::end(spans), [](const ProfileSpan& s) { return SpanTrack::Gpu == s.track; }))
+  {
+    writeThreadName(sk_gpuTraceThreadId, "GPU");
+  }
+  for (std::size_t i = 0; i < threadNames.size(); ++i) {
+    writeThreadName(static_cast<uint32_t>(i + 1), threadNames[i]);
+  }
+
+  for (const ProfileSpan& span : spans) {
+    const bool gpu = (SpanTrack::Gpu == span.track);
+
+    beginEvent();
+    os << "{\"name\":";
+    writeJsonString(os, span.name);
+    os << ",\"cat\":\"" << (gpu ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+       << (gpu ? sk_gpuTraceThreadId : span.threadIndex + 1) << ",\"ts\":" << formatMicroseconds(span.startNs)
+       << ",\"dur\":" << formatMicroseconds(span.durationNs) << ",\"args\":{\"frame\":" << span.frameIndex;
+
+    if (!span.detail.empty()) {
+      os << ",\"detail\":";
+      writeJsonString(os, span.detail);
+    }
+    os << "}}";
+  }
+
+  os << "\n]}\n";
+}
+
+} // namespace profiling
@@ -0,0 +1,318 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace profiling
+{
+
+/// Timeline that a profiled span was measured on
+enum class SpanTrack
+{
+  Cpu, //!< Wall-clock time of a thread
+  Gpu  //!< Execution time of GL commands, measured with timestamp queries
+};
+
+/**
+ * @brief Time interval of one profiled scope.
+ */
+struct ProfileSpan
+{
+  const char* name = "";            //!< Scope name: a string literal or other string that outlives the profiler
+  std::string detail;               //!< Optional qualifier, such as the view, image, or task of the scope
+  SpanTrack track = SpanTrack::Cpu; //!< Timeline of the span
+  uint32_t threadIndex = 0;         //!< Index of the recording thread (see FrameProfiler::threadNames)
+  uint32_t depth = 0;               //!< Nesting depth of the scope within its thread or within the GPU track
+  uint64_t frameIndex = 0;          //!< Frame during which the scope began
+  int64_t startNs = 0;              //!< Start time since the profiler epoch, in nanoseconds
+  int64_t durationNs = 0;           //!< Duration in nanoseconds
+};
+
+/**
+ * @brief Spans recorded during one frame of the render loop.
+ */
+struct ProfiledFrame
+{
+  uint64_t index = 0;      //!< Index of the frame, starting at one
+  int64_t startNs = 0;     //!< Start of the frame since the profiler epoch, in nanoseconds
+  int64_t durationNs = 0;  //!< Duration of the frame in nanoseconds
+  bool gpuPending = false; //!< Whether GPU spans of the frame are still waiting for query results
+  std::vector<ProfileSpan> spans;
+};
+
+/**
+ * @brief Totals of all spans of a frame that share a track, name, and detail.
+ */
+struct ScopeSummary
+{
+  SpanTrack track = SpanTrack::Cpu;
+  std::string name;
+  std::string detail;
+  uint32_t calls = 0;
+  int64_t totalNs = 0; //!< Summed duration of the spans
+  int64_t selfNs = 0;  //!< Summed duration of the spans, excluding time spent in nested spans
+};
+
+/**
+ * @brief Source of GPU timestamps, implemented with the graphics API of the renderer.
+ *
+ * All functions are called from the thread that owns the graphics context.
+ */
+class GpuTimestampQueries
+{
+public:
+  virtual ~GpuTimestampQueries() = default;
+
+  /// Record the GPU time at which all previously issued commands have completed.
+  /// @return Handle of the query, or none if no query could be issued
+  virtual std::optional<uint32_t> record() = 0;
+
+  /// @return Time of a recorded query in nanoseconds, or none while the result is not available yet
+  virtual std::optional<int64_t> result(uint32_t query) = 0;
+
+  /// Return a query handle for reuse
+  virtual void release(uint32_t query) = 0;
+
+  /// @return Current GPU time in nanoseconds, which is used to align GPU timestamps with the CPU clock
+  virtual std::optional<int64_t> currentTime() = 0;
+};
+
+/**
+ * @brief Profiler of the render loop that records nested CPU scopes on all threads and GPU scopes on the thread of
+ * the graphics context.
+ *
+ * Scopes are recorded with CpuScope and GpuScope objects. While the profiler is disabled, a scope costs one relaxed
+ * atomic load. Spans are grouped into frames that are delimited by beginFrame and endFrame. The most recent frames are
+ * kept for display, and all spans recorded during a capture are kept for export as a Chrome trace.
+ */
+class FrameProfiler
+{
+public:
+  /// Number of recent frames kept for display
+  static constexpr std::size_t sk_maxFrames = 300;
+
+  /// Maximum number of spans kept by a capture. This bounds the capture at roughly 100 MB.
+  static constexpr std::size_t sk_maxCapturedSpans = 1'000'000;
+
+  /// Number of frames after which GPU spans whose query results are still unavailable are dropped
+  static constexpr uint64_t sk_maxGpuLatencyFrames = 8;
+
+  /// Profiler shared by the whole application
+  static FrameProfiler& instance();
+
+  /// Whether scopes are recorded. This is the check made by every scope.
+  static bool isEnabled()
+  {
+    return s_enabled.load(std::memory_order_relaxed);
+  }
+
+  void setEnabled(bool enabled);
+
+  /// Install the GPU timestamp source. Pass null to disable GPU spans, which must be done before the graphics context
+  /// is destroyed.
+  void setGpuTimestampQueries(std::unique_ptr<GpuTimestampQueries> queries);
+  bool gpuTimingAvailable() const;
+
+  /// Name the calling thread in the timeline and in exported traces
+  void setThreadName(std::string name);
+
+  /// Names of the threads that recorded spans, indexed by ProfileSpan::threadIndex
+  std::vector<std::string> threadNames() const;
+
+  /// Start a frame. Called from the thread of the graphics context.
+  void beginFrame();
+
+  /// End the frame, collect the spans recorded since the frame began, and resolve finished GPU spans
+  void endFrame();
+
+  /// Recent frames, oldest first
+  const std::deque<ProfiledFrame>& frames() const;
+
+  /// Start keeping all spans for export, discarding those of a previous capture
+  void startCapture();
+  void stopCapture();
+  bool capturing() const;
+  std::size_t capturedSpanCount() const;
+
+  /**
+   * @brief Write the spans of the last capture to a file in Chrome trace-event JSON format, which can be opened in
+   * chrome://tracing or Perfetto.
+   * @return Number of spans written, or an error message.
+   */
+  std::expected<std::size_t, std::string> exportCapture(const std::filesystem::path& fileName) const;
+
+  /// Discard all frames and captured spans. GPU spans that are still waiting for query results are kept.
+  void clear();
+
+private:
+  friend class CpuScope;
+  friend class GpuScope;
+
+  FrameProfiler();
+
+  int64_t nowNs() const;
+  uint32_t currentThreadIndex();
+
+  void flushThreadSpans(std::vector<ProfileSpan>& spans);
+
+  std::optional<std::size_t> beginGpuSpan(const char* name, std::string detail);
+  void endGpuSpan(std::size_t pendingIndex);
+  void resolveGpuSpans();
+
+  void captureSpans(const std::vector<ProfileSpan>& spans);
+
+  struct PendingGpuSpan
+  {
+    ProfileSpan span;
+    uint32_t beginQuery = 0;
+    std::optional<uint32_t> endQuery;
+    int64_t gpuToCpuOffsetNs = 0; //!< Offset from GPU time to profiler time when the span began
+  };
+
+  static std::atomic<bool> s_enabled;
+
+  /// Maximum number of spans waiting for the end of a frame, which bounds memory while no frames are rendered
+  static constexpr std::size_t sk_maxPendingSpans = 100'000;
+
+  const std::chrono::steady_clock::time_point m_epoch;
+
+  mutable std::mutex m_threadsMutex;
+  std::vector<std::string> m_threadNames;
+
+  /// Spans of scopes that finished on any thread since the last frame ended
+  std::mutex m_pendingSpansMutex;
+  std::vector<ProfileSpan> m_pendingSpans;
+
+  std::atomic<uint64_t> m_frameIndex{0};
+  int64_t m_frameStartNs = 0;
+  bool m_inFrame = false;
+
+  std::deque<ProfiledFrame> m_frames;
+
+  bool m_capturing = false;
+  bool m_captureTruncated = false;
+  std::vector<ProfileSpan> m_capturedSpans;
+
+  std::unique_ptr<GpuTimestampQueries> m_gpuQueries;
+  std::vector<PendingGpuSpan> m_pendingGpuSpans;
+  uint32_t m_gpuDepth = 0;
+  int64_t m_gpuToCpuOffsetNs = 0;
+};
+
+/**
+ * @brief Record the lifetime of a scope on the CPU timeline of the calling thread.
+ */
+class CpuScope
+{
+public:
+  explicit CpuScope(const char* name)
+  {
+    if (FrameProfiler::isEnabled()) {
+      begin(name, {});
+    }
+  }
+
+  /// @param detail Callable returning the detail string, which is only invoked while the profiler is enabled
+  template<typename DetailFunc>
+    requires std::invocable<DetailFunc&>
+  CpuScope(const char* name, DetailFunc&& detail)
+  {
+    if (FrameProfiler::isEnabled()) {
+      begin(name, std::string(detail()));
+    }
+  }
+
+  ~CpuScope()
+  {
+    if (m_active) {
+      end();
+    }
+  }
+
+  CpuScope(const CpuScope&) = delete;
+  CpuScope& operator=(const CpuScope&) = delete;
+
+protected:
+  CpuScope() = default;
+
+  void begin(const char* name, std::string detail);
+  void end();
+
+private:
+  bool m_active = false;
+  const char* m_name = nullptr;
+  std::string m_detail;
+  uint32_t m_depth = 0;
+  uint64_t m_frameIndex = 0;
+  int64_t m_startNs = 0;
+};
+
+/**
+ * @brief Record a render pass on the GPU timeline and on the CPU timeline of the calling thread, which must own the
+ * graphics context. Without a GPU timestamp source, only the CPU span is recorded.
+ */
+class GpuScope : private CpuScope
+{
+public:
+  explicit GpuScope(const char* name)
+  {
+    if (FrameProfiler::isEnabled()) {
+      beginPass(name, {});
+    }
+  }
+
+  /// @param detail Callable returning the detail string, which is only invoked while the profiler is enabled
+  template<typename DetailFunc>
+    requires std::invocable<DetailFunc&>
+  GpuScope(const char* name, DetailFunc&& detail)
+  {
+    if (FrameProfiler::isEnabled()) {
+      beginPass(name, std::string(detail()));
+    }
+  }
+
+  /// The GPU span ends before the CPU span, which is ended by the base class
+  ~GpuScope()
+  {
+    if (m_pendingIndex) {
+      FrameProfiler::instance().endGpuSpan(*m_pendingIndex);
+    }
+  }
+
+  GpuScope(const GpuScope&) = delete;
+  GpuScope& operator=(const GpuScope&) = delete;
+
+private:
+  void beginPass(const char* name, std::string detail);
+
+  std::optional<std::size_t> m_pendingIndex; //!< Index of the GPU span among the pending GPU spans
+};
+
+/**
+ * @brief Sum the spans of a frame by track, name, and detail.
+ * @return Summaries sorted by decreasing total duration.
+ */
+std::vector<ScopeSummary> summarizeSpans(const std::vector<ProfileSpan>& spans);
+
+/**
+ * @brief Write spans as a Chrome trace-event JSON document with one complete ("X") event per span.
+ * @param threadNames Names of CPU threads, indexed by ProfileSpan::threadIndex.
+ */
+void writeChromeTrace(
+  std::ostream& os,
+  const std::vector<ProfileSpan>& spans,
+  const std::vector<std::string>& threadNames);
+
+} // namespace profiling
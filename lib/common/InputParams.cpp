@@ -24,6 +24,9 @@ std::ostream& operator<<(std::ostream& os, const InputParams& p)
   if (p.layoutsFile) {
     os << "\nLayouts file: " << *p.layoutsFile;
   }
+  if (p.timeFrameCacheMiB) {
+    os << "\nTime frame cache: " << *p.timeFrameCacheMiB << " MiB";
+  }
 
   os << "\nConsole log level: " << p.consoleLogLevel;
 
@@ -2,6 +2,7 @@
 
 #include <spdlog/spdlog.h>
 
+#include <cstddef>
 #include <filesystem>
 #include <optional>
 #include <ostream>
@@ -32,6 +33,10 @@ struct InputParams
   /// Optional standalone layout JSON file that overrides generated/project layouts
   std::optional<std::filesystem::path> layoutsFile;
 
+  /// When set, the time points of 4D images are read on demand through a frame cache of this size
+  /// in mebibytes, rather than all being loaded up front
+  std::optional<std::size_t> timeFrameCacheMiB;
+
   /// Console logging level
   spdlog::level::level_enum consoleLogLevel;
 
@@ -139,6 +139,10 @@ void logInputs(const InputParams& params)
   if (params.layoutsFile) {
     spdlog::info("Layouts file provided: {}", *params.layoutsFile);
   }
+
+  if (params.timeFrameCacheMiB) {
+    spdlog::info("Time points of 4D images are streamed through a {} MiB frame cache", *params.timeFrameCacheMiB);
+  }
 }
 
 std::vector<char*> filterPlatformArguments(const int argc, char* argv[])
@@ -167,6 +171,7 @@ bool parseCommandLine(const int argc, char* argv[], InputParams& params)
   params.dicomPaths.clear();
   params.projectFile = std::nullopt;
   params.layoutsFile = std::nullopt;
+  params.timeFrameCacheMiB = std::nullopt;
 
   std::ostringstream desc;
   desc << APP_DESCRIPTION;
@@ -182,6 +187,14 @@ bool parseCommandLine(const int argc, char* argv[], InputParams& params)
   auto* projectOption = program.add_option("-p,--project", projectFile, "JSON project file");
   std::string layoutsFile;
   program.add_option("--layouts", layoutsFile, "standalone JSON layout file");
+  std::size_t timeFrameCacheMiB = 0;
+  auto* timeFrameCacheOption =
+    program
+      .add_option(
+        "--time-frame-cache",
+        timeFrameCacheMiB,
+        "stream the time points of 4D images through a frame cache of this size in MiB")
+      ->check(CLI::PositiveNumber);
   std::vector<std::string> positionalImageFiles;
   auto* positionalImageOption =
     program.add_option("positional-images", positionalImageFiles, "image paths; first image is reference")
@@ -253,6 +266,9 @@ bool parseCommandLine(const int argc, char* argv[], InputParams& params)
   if (!layoutsFile.empty()) {
     params.layoutsFile = layoutsFile;
   }
+  if (timeFrameCacheOption->count() > 0) {
+    params.timeFrameCacheMiB = timeFrameCacheMiB;
+  }
   for (const std::string& imageFile : positionalImageFiles) {
     params.imageFiles.push_back({imageFile, {}});
   }
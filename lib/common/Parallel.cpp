@@ -0,0 +1,32 @@
+#include "common/Parallel.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace parallel
+{
+
+namespace
+{
+/// Thread budget of the calling thread, or zero when no ScopedThreadBudget is active
+thread_local unsigned int t_threadBudget = 0;
+} // namespace
+
+unsigned int threadBudget()
+{
+  const unsigned int hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  return (0 == t_threadBudget) ? hardwareThreads : std::min(t_threadBudget, hardwareThreads);
+}
+
+ScopedThreadBudget::ScopedThreadBudget(unsigned int numThreads)
+  : m_previousBudget(t_threadBudget)
+{
+  t_threadBudget = std::min(std::max(numThreads, 1u), threadBudget());
+}
+
+ScopedThreadBudget::~ScopedThreadBudget()
+{
+  t_threadBudget = m_previousBudget;
+}
+
+} // namespace parallel
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace parallel
+{
+
+/**
+ * @brief Number of threads that parallel work started on the calling thread may use, including the
+ * calling thread itself.
+ *
+ * This is the number of hardware threads, unless a ScopedThreadBudget on the calling thread lowers it.
+ * Parallel loops that pick their own thread count from the hardware should use this instead, so that
+ * work run on several pool threads at once does not start a full set of threads on each of them.
+ *
+ * @return Budget of at least one thread.
+ */
+unsigned int threadBudget();
+
+/**
+ * @brief Limit the thread budget of the calling thread for the lifetime of this object.
+ *
+ * Budgets nest: an inner scope cannot raise the budget of an outer one.
+ */
+class ScopedThreadBudget
+{
+public:
+  explicit ScopedThreadBudget(unsigned int numThreads);
+  ~ScopedThreadBudget();
+
+  ScopedThreadBudget(const ScopedThreadBudget&) = delete;
+  ScopedThreadBudget& operator=(const ScopedThreadBudget&) = delete;
+
+private:
+  unsigned int m_previousBudget;
+};
+
+/**
+ * @brief Split the range [begin, end) into contiguous slabs and run a function on each slab, with one
+ * thread per slab. The calling thread runs the only slab when there is one.
+ *
+ * @param numThreads Number of slabs, which is clamped to the number of elements in the range
+ * @param fn Function called as fn(slabIndex, slabBegin, slabEnd). Trailing slabs may be empty.
+ */
+template<typename Fn>
+void forEachSlab(unsigned int numThreads, int begin, int end, Fn&& fn)
+{
+  const int count = std::max(end - begin, 0);
+  numThreads = std::clamp(numThreads, 1u, static_cast<unsigned int>(std::max(count, 1)));
+  const int slabSize = (count + static_cast<int>(numThreads) - 1) / static_cast<int>(numThreads);
+
+  auto work = [&](unsigned int t) {
+    const int slabBegin = std::min(end, begin + static_cast<int>(t) * slabSize);
+    const int slabEnd = std::min(end, slabBegin + slabSize);
+    fn(t, slabBegin, slabEnd);
+  };
+
+  if (1 == numThreads) {
+    work(0);
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads);
+  for (unsigned int t = 0; t < numThreads; ++t) {
+    threads.emplace_back(work, t);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+} // namespace parallel
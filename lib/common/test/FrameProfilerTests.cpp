@@ -0,0 +1,320 @@
+#include "common/FrameProfiler.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace profiling;
+
+namespace
+{
+
+/// GPU timestamp source whose query results are set by the test
+class FakeGpuTimestampQueries : public GpuTimestampQueries
+{
+public:
+  struct State
+  {
+    uint32_t nextQuery = 0;
+    int64_t nextTimestampNs = 1000;
+    bool resultsAvailable = false;
+    std::unordered_map<uint32_t, int64_t> timestamps;
+    std::vector<uint32_t> released;
+  };
+
+  explicit FakeGpuTimestampQueries(std::shared_ptr<State> state)
+    : m_state(std::move(state))
+  {
+  }
+
+  std::optional<uint32_t> record() override
+  {
+    const uint32_t query = m_state->nextQuery++;
+    m_state->timestamps[query] = m_state->nextTimestampNs;
+    m_state->nextTimestampNs += 500;
+    return query;
+  }
+
+  std::optional<int64_t> result(uint32_t query) override
+  {
+    if (!m_state->resultsAvailable) {
+      return std::nullopt;
+    }
+    return m_state->timestamps.at(query);
+  }
+
+  void release(uint32_t query) override
+  {
+    m_state->released.push_back(query);
+  }
+
+  std::optional<int64_t> currentTime() override
+  {
+    return m_state->nextTimestampNs;
+  }
+
+private:
+  std::shared_ptr<State> m_state;
+};
+
+/// Enable a cleared profiler for one test and disable it afterwards
+struct EnabledProfiler
+{
+  EnabledProfiler()
+  {
+    FrameProfiler::instance().clear();
+    FrameProfiler::instance().setEnabled(true);
+  }
+
+  ~EnabledProfiler()
+  {
+    FrameProfiler& profiler = FrameProfiler::instance();
+    profiler.setEnabled(false);
+    profiler.stopCapture();
+    profiler.setGpuTimestampQueries(nullptr);
+    profiler.clear();
+  }
+
+  FrameProfiler& operator*() const
+  {
+    return FrameProfiler::instance();
+  }
+};
+
+ProfileSpan makeSpan(const char* name, uint32_t depth, int64_t startNs, int64_t durationNs)
+{
+  ProfileSpan span;
+  span.name = name;
+  span.depth = depth;
+  span.startNs = startNs;
+  span.durationNs = durationNs;
+  return span;
+}
+
+const ProfileSpan* findSpan(const ProfiledFrame& frame, std::string_view name)
+{
+  const auto it = std::find_if(
+    std::begin(frame.spans),
+    std::end(frame.spans),
+    [name](const ProfileSpan& span) { return name == span.name; });
+  return (std::end(frame.spans) != it) ? &(*it) : nullptr;
+}
+
+} // namespace
+
+TEST_CASE("disabled profiler records no frames and does not build details", "[common][profiler]")
+{
+  FrameProfiler& profiler = FrameProfiler::instance();
+  profiler.clear();
+  profiler.setEnabled(false);
+
+  bool detailBuilt = false;
+
+  profiler.beginFrame();
+  {
+    CpuScope scope("scope", [&detailBuilt] {
+      detailBuilt = true;
+      return std::string("detail");
+    });
+  }
+  profiler.endFrame();
+
+  CHECK(profiler.frames().empty());
+  CHECK_FALSE(detailBuilt);
+}
+
+TEST_CASE("nested CPU scopes are recorded with depth and detail in their frame", "[common][profiler]")
+{
+  const EnabledProfiler profiler;
+
+  (*profiler).beginFrame();
+  {
+    CpuScope outer("outer");
+    CpuScope inner("inner", [] { return std::string("view 1"); });
+  }
+  (*profiler).endFrame();
+
+  REQUIRE((*profiler).frames().size() == 1);
+  const ProfiledFrame& frame = (*profiler).frames().back();
+  REQUIRE(frame.spans.size() == 2);
+
+  const ProfileSpan* outer = findSpan(frame, "outer");
+  const ProfileSpan* inner = findSpan(frame, "inner");
+  REQUIRE(outer);
+  REQUIRE(inner);
+
+  CHECK(outer->depth == 0);
+  CHECK(inner->depth == 1);
+  CHECK(inner->detail == "view 1");
+  CHECK(outer->frameIndex == frame.index);
+  CHECK(inner->startNs >= outer->startNs);
+  CHECK(inner->startNs + inner->durationNs <= outer->startNs + outer->durationNs);
+  CHECK(outer->startNs >= frame.startNs);
+}
+
+TEST_CASE("scopes on other threads are recorded under the name of their thread", "[common][profiler]")
+{
+  const EnabledProfiler profiler;
+
+  (*profiler).beginFrame();
+  std::thread worker([] {
+    FrameProfiler::instance().setThreadName("Worker");
+    CpuScope scope("task");
+  });
+  worker.join();
+  (*profiler).endFrame();
+
+  REQUIRE_FALSE((*profiler).frames().empty());
+  const ProfileSpan* task = findSpan((*profiler).frames().back(), "task");
+  REQUIRE(task);
+
+  const std::vector<std::string> names = (*profiler).threadNames();
+  REQUIRE(task->threadIndex < names.size());
+  CHECK(names[task->threadIndex] == "Worker");
+}
+
+TEST_CASE("GPU scopes are resolved into their frame once query results are available", "[common][profiler]")
+{
+  const EnabledProfiler profiler;
+
+  auto state = std::make_shared<FakeGpuTimestampQueries::State>();
+  (*profiler).setGpuTimestampQueries(std::make_unique<FakeGpuTimestampQueries>(state));
+  REQUIRE((*profiler).gpuTimingAvailable());
+
+  (*profiler).beginFrame();
+  {
+    GpuScope pass("pass", [] { return std::string("image"); });
+  }
+  (*profiler).endFrame();
+
+  REQUIRE((*profiler).frames().size() == 1);
+  CHECK((*profiler).frames().back().gpuPending);
+  CHECK((*profiler).frames().back().spans.size() == 1); // CPU span of the pass
+
+  state->resultsAvailable = true;
+  (*profiler).beginFrame();
+  (*profiler).endFrame();
+
+  const ProfiledFrame& passFrame = (*profiler).frames().front();
+  CHECK_FALSE(passFrame.gpuPending);
+
+  const auto gpuSpan = std::find_if(std::begin(passFrame.spans), std::end(passFrame.spans), [](const ProfileSpan& s) {
+    return SpanTrack::Gpu == s.track;
+  });
+  REQUIRE(std::end(passFrame.spans) != gpuSpan);
+  CHECK(std::string(gpuSpan->name) == "pass");
+  CHECK(gpuSpan->detail == "image");
+  CHECK(gpuSpan->durationNs == 500);
+  CHECK(state->released.size() == 2);
+}
+
+TEST_CASE("GPU scopes whose results never arrive are dropped", "[common][profiler]")
+{
+  const EnabledProfiler profiler;
+
+  auto state = std::make_shared<FakeGpuTimestampQueries::State>();
+  (*profiler).setGpuTimestampQueries(std::make_unique<FakeGpuTimestampQueries>(state));
+
+  (*profiler).beginFrame();
+  {
+    GpuScope pass("pass");
+  }
+  (*profiler).endFrame();
+
+  for (uint64_t i = 0; i < FrameProfiler::sk_maxGpuLatencyFrames + 1; ++i) {
+    (*profiler).beginFrame();
+    (*profiler).endFrame();
+  }
+
+  CHECK_FALSE((*profiler).frames().front().gpuPending);
+  CHECK(state->released.size() == 2);
+}
+
+TEST_CASE("span summaries separate self time from time in nested spans", "[common][profiler]")
+{
+  std::vector<ProfileSpan> spans{
+    makeSpan("frame", 0, 0, 100),
+    makeSpan("view", 1, 10, 30),
+    makeSpan("view", 1, 50, 40),
+    makeSpan("layer", 2, 55, 20)};
+  spans[1].detail = "a";
+  spans[2].detail = "b";
+
+  const std::vector<ScopeSummary> summaries = summarizeSpans(spans);
+  REQUIRE(summaries.size() == 4);
+
+  CHECK(summaries[0].name == "frame");
+  CHECK(summaries[0].totalNs == 100);
+  CHECK(summaries[0].selfNs == 30);
+
+  CHECK(summaries[1].name == "view");
+  CHECK(summaries[1].detail == "b");
+  CHECK(summaries[1].selfNs == 20);
+
+  CHECK(summaries[2].detail == "a");
+  CHECK(summaries[2].selfNs == 30);
+
+  CHECK(summaries[3].name == "layer");
+  CHECK(summaries[3].calls == 1);
+}
+
+TEST_CASE("Chrome trace has thread names and one complete event per span", "[common][profiler]")
+{
+  std::vector<ProfileSpan> spans{makeSpan("upload", 0, 1500, 250), makeSpan("pass", 0, 2000, 1000)};
+  spans[0].detail = "brain \"T1\"";
+  spans[0].threadIndex = 1;
+  spans[1].track = SpanTrack::Gpu;
+  spans[1].frameIndex = 7;
+
+  std::ostringstream os;
+  writeChromeTrace(os, spans, {"Main", "Worker"});
+  const std::string trace = os.str();
+
+  CHECK(trace.starts_with("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+  CHECK(trace.find(R"("tid":0,"args":{"name":"GPU"})") != std::string::npos);
+  CHECK(trace.find(R"("tid":2,"args":{"name":"Worker"})") != std::string::npos);
+  CHECK(
+    trace.find(R"({"name":"upload","cat":"cpu","ph":"X","pid":1,"tid":2,"ts":1.500,"dur":0.250,"args":{"frame":0,)"
+               R"("detail":"brain \"T1\""}})") != std::string::npos);
+  CHECK(
+    trace.find(R"({"name":"pass","cat":"gpu","ph":"X","pid":1,"tid":0,"ts":2.000,"dur":1.000,"args":{"frame":7}})") !=
+    std::string::npos);
+}
+
+TEST_CASE("captured spans are exported for the whole capture", "[common][profiler]")
+{
+  const EnabledProfiler profiler;
+
+  (*profiler).startCapture();
+  for (int i = 0; i < 3; ++i) {
+    (*profiler).beginFrame();
+    {
+      CpuScope scope("scope");
+    }
+    (*profiler).endFrame();
+  }
+  (*profiler).stopCapture();
+
+  (*profiler).beginFrame();
+  {
+    CpuScope scope("after capture");
+  }
+  (*profiler).endFrame();
+
+  CHECK((*profiler).capturedSpanCount() == 3);
+
+  const std::filesystem::path fileName = std::filesystem::temp_directory_path() / "entropy-profiler-trace-test.json";
+  const auto written = (*profiler).exportCapture(fileName);
+  REQUIRE(written.has_value());
+  CHECK(*written == 3);
+  CHECK(std::filesystem::file_size(fileName) > 0);
+  std::filesystem::remove(fileName);
+}
@@ -376,3 +376,41 @@ TEST_CASE("project option cannot be mixed with image, segmentation, or DICOM inp
     CHECK_FALSE(parseCommandLine(static_cast<int>(argv.size()), argv.data(), params));
   }
 }
+
+TEST_CASE("time frame cache option sets the streaming cache size", "[common][input]")
+{
+  char app[] = "Entropy";
+  char image[] = "image-4d.nii.gz";
+
+  SECTION("The option is unset by default")
+  {
+    std::array<char*, 2> argv{app, image};
+
+    InputParams params;
+    REQUIRE(parseCommandLine(static_cast<int>(argv.size()), argv.data(), params));
+    CHECK_FALSE(params.timeFrameCacheMiB);
+  }
+
+  SECTION("The option takes a size in MiB")
+  {
+    char cacheOpt[] = "--time-frame-cache";
+    char cacheSize[] = "512";
+    std::array<char*, 4> argv{app, cacheOpt, cacheSize, image};
+
+    InputParams params;
+    REQUIRE(parseCommandLine(static_cast<int>(argv.size()), argv.data(), params));
+    REQUIRE(params.timeFrameCacheMiB);
+    CHECK(*params.timeFrameCacheMiB == 512);
+    REQUIRE(params.imageFiles.size() == 1);
+  }
+
+  SECTION("A zero size is rejected")
+  {
+    char cacheOpt[] = "--time-frame-cache";
+    char cacheSize[] = "0";
+    std::array<char*, 4> argv{app, cacheOpt, cacheSize, image};
+
+    InputParams params;
+    CHECK_FALSE(parseCommandLine(static_cast<int>(argv.size()), argv.data(), params));
+  }
+}
@@ -0,0 +1,67 @@
+#include "common/Parallel.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Thread budgets default to the hardware threads and nest", "[common][parallel]")
+{
+  const unsigned int hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  CHECK(parallel::threadBudget() == hardwareThreads);
+
+  {
+    const parallel::ScopedThreadBudget outer(2);
+    CHECK(parallel::threadBudget() == std::min(2u, hardwareThreads));
+
+    {
+      // An inner scope cannot raise the budget
+      const parallel::ScopedThreadBudget inner(hardwareThreads + 4);
+      CHECK(parallel::threadBudget() == std::min(2u, hardwareThreads));
+    }
+
+    {
+      const parallel::ScopedThreadBudget inner(0);
+      CHECK(parallel::threadBudget() == 1u);
+    }
+
+    // Budgets belong to the thread that set them
+    unsigned int otherThreadBudget = 0;
+    std::thread([&otherThreadBudget]() { otherThreadBudget = parallel::threadBudget(); }).join();
+    CHECK(otherThreadBudget == hardwareThreads);
+
+    CHECK(parallel::threadBudget() == std::min(2u, hardwareThreads));
+  }
+
+  CHECK(parallel::threadBudget() == hardwareThreads);
+}
+
+TEST_CASE("Slabs cover a range once, in order of their index", "[common][parallel]")
+{
+  for (unsigned int numThreads : {0u, 1u, 3u, 7u, 64u}) {
+    std::vector<int> visits(20, 0);
+    // There are no more slabs than elements
+    std::vector<int> slabBegins(std::clamp(numThreads, 1u, 20u), -1);
+
+    parallel::forEachSlab(numThreads, 5, 25, [&](unsigned int t, int begin, int end) {
+      slabBegins[t] = begin;
+      for (int i = begin; i < end; ++i) {
+        ++visits[static_cast<std::size_t>(i - 5)];
+      }
+    });
+
+    CHECK(std::ranges::all_of(visits, [](int count) { return 1 == count; }));
+    CHECK(5 == slabBegins.front());
+    CHECK(std::ranges::is_sorted(slabBegins));
+  }
+
+  // Empty ranges run one empty slab on the calling thread
+  int numCalls = 0;
+  parallel::forEachSlab(8, 3, 3, [&](unsigned int t, int begin, int end) {
+    CHECK(0 == t);
+    CHECK(begin == end);
+    ++numCalls;
+  });
+  CHECK(1 == numCalls);
+}
@@ -0,0 +1,289 @@
+#include "image/DicomHeaderIndex.h"
+
+#include <nlohmann/json.hpp>
+
+#include <spdlog/fmt/std.h>
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <fstream>
+#include <random>
+#include <system_error>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+/// Version of the index file layout. Indexes written with other versions are rescanned.
+/// Version 1 indexes kept every metadata tag and are replaced by allowlisted ones.
+constexpr int sk_indexVersion = 2;
+
+template<typename Vec>
+nlohmann::json vecToJson(const Vec& v)
+{
+  nlohmann::json json = nlohmann::json::array();
+  for (int i = 0; i < Vec::length(); ++i) {
+    json.push_back(v[i]);
+  }
+  return json;
+}
+
+template<typename Vec>
+Vec vecFromJson(const nlohmann::json& json)
+{
+  Vec v{0};
+  for (int i = 0; i < Vec::length(); ++i) {
+    v[i] = json.at(static_cast<std::size_t>(i)).get<typename Vec::value_type>();
+  }
+  return v;
+}
+
+nlohmann::json headerToJson(const dicom::FileHeader& header)
+{
+  nlohmann::json json{
+    {"path", header.path.string()},
+    {"size", header.fileSize},
+    {"mtime", header.modifiedTime},
+    {"dicom", header.isDicom}};
+
+  if (!header.isDicom) {
+    return json;
+  }
+
+  json["series"] = header.seriesIdentifier;
+  json["sop"] = header.sopInstanceUid;
+  json["instance"] = header.instanceNumber ? nlohmann::json(*header.instanceNumber) : nlohmann::json();
+
+  const dicom::SeriesGeometry& geometry = header.geometry;
+  nlohmann::json directions = nlohmann::json::array();
+  for (int c = 0; c < 3; ++c) {
+    for (int r = 0; r < 3; ++r) {
+      directions.push_back(geometry.directions[c][r]);
+    }
+  }
+
+  json["dimensions"] = vecToJson(geometry.dimensions);
+  json["spacing"] = vecToJson(geometry.spacing);
+  json["origin"] = vecToJson(geometry.origin);
+  json["directions"] = std::move(directions);
+  json["orientation"] = geometry.sliceOrientation;
+
+  if (!header.metadata.empty()) {
+    nlohmann::json metadata = nlohmann::json::array();
+    for (const auto& entry : header.metadata) {
+      if (dicom::isIndexedMetadataTag(entry.tag)) {
+        metadata.push_back(nlohmann::json::array({entry.tag, entry.value}));
+      }
+    }
+    json["metadata"] = std::move(metadata);
+  }
+
+  return json;
+}
+
+dicom::FileHeader headerFromJson(const nlohmann::json& json)
+{
+  dicom::FileHeader header;
+  header.path = fs::path{json.at("path").get<std::string>()};
+  header.fileSize = json.at("size").get<std::uintmax_t>();
+  header.modifiedTime = json.at("mtime").get<int64_t>();
+  header.isDicom = json.at("dicom").get<bool>();
+
+  if (!header.isDicom) {
+    return header;
+  }
+
+  header.seriesIdentifier = json.at("series").get<std::string>();
+  header.sopInstanceUid = json.at("sop").get<std::string>();
+  if (const auto& instance = json.at("instance"); !instance.is_null()) {
+    header.instanceNumber = instance.get<int32_t>();
+  }
+
+  dicom::SeriesGeometry& geometry = header.geometry;
+  geometry.dimensions = vecFromJson<glm::uvec3>(json.at("dimensions"));
+  geometry.spacing = vecFromJson<glm::vec3>(json.at("spacing"));
+  geometry.origin = vecFromJson<glm::vec3>(json.at("origin"));
+  const auto& directions = json.at("directions");
+  for (int c = 0; c < 3; ++c) {
+    for (int r = 0; r < 3; ++r) {
+      geometry.directions[c][r] = directions.at(static_cast<std::size_t>(3 * c + r)).get<float>();
+    }
+  }
+  geometry.sliceOrientation = json.at("orientation").get<std::string>();
+
+  if (const auto it = json.find("metadata"); it != json.end()) {
+    for (const auto& entry : *it) {
+      header.metadata.push_back(
+        dicom::RawMetadataEntry{entry.at(0).get<std::string>(), entry.at(1).get<std::string>()});
+    }
+  }
+
+  return header;
+}
+
+/// 64-bit FNV-1a hash, which unlike std::hash is stable across runs and platforms
+uint64_t stableHash(const std::string& text)
+{
+  uint64_t hash = 14695981039346656037ull;
+  for (const char c : text) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+/**
+ * @brief Temporary file next to an index file whose name is unique to this process and call. Names
+ * combine a per-process random nonce with a counter, so that saves from other threads and other
+ * processes sharing the index directory never collide.
+ */
+fs::path uniqueTempFile(const fs::path& indexFile)
+{
+  static const uint64_t sk_processNonce = (static_cast<uint64_t>(std::random_device{}()) << 32) ^
+                                          static_cast<uint64_t>(std::random_device{}());
+  static std::atomic<uint64_t> s_counter{0};
+
+  fs::path tempFile = indexFile;
+  tempFile += fmt::format(".{:016x}-{}.tmp", sk_processNonce, s_counter.fetch_add(1, std::memory_order_relaxed));
+  return tempFile;
+}
+
+void removeQuietly(const fs::path& file)
+{
+  std::error_code ec;
+  fs::remove(file, ec);
+}
+} // namespace
+
+namespace dicom
+{
+HeaderIndex::HeaderIndex(fs::path rootPath, bool recursive)
+  : m_rootPath(std::move(rootPath))
+  , m_recursive(recursive)
+{
+}
+
+std::optional<HeaderIndex> HeaderIndex::load(const fs::path& indexFile, const fs::path& rootPath, bool recursive)
+{
+  std::error_code ec;
+  if (!fs::is_regular_file(indexFile, ec)) {
+    return std::nullopt;
+  }
+
+  try {
+    std::ifstream in(indexFile, std::ios::binary);
+    const nlohmann::json json = nlohmann::json::parse(in);
+
+    if (json.at("version").get<int>() != sk_indexVersion) {
+      spdlog::debug("Ignoring DICOM header index {} written with another version", indexFile);
+      return std::nullopt;
+    }
+
+    if (fs::path{json.at("rootPath").get<std::string>()} != rootPath || json.at("recursive").get<bool>() != recursive) {
+      spdlog::debug("Ignoring DICOM header index {} of another scan", indexFile);
+      return std::nullopt;
+    }
+
+    HeaderIndex index(rootPath, recursive);
+    for (const auto& file : json.at("files")) {
+      index.insert(headerFromJson(file));
+    }
+
+    spdlog::debug("Loaded DICOM header index {} with {} files", indexFile, index.size());
+    return index;
+  }
+  catch (const std::exception& e) {
+    spdlog::warn("Could not read DICOM header index {}: {}", indexFile, e.what());
+    return std::nullopt;
+  }
+}
+
+bool HeaderIndex::save(const fs::path& indexFile) const
+{
+  try {
+    nlohmann::json files = nlohmann::json::array();
+    for (const auto& [path, header] : m_headers) {
+      files.push_back(headerToJson(header));
+    }
+
+    const nlohmann::json json{
+      {"version", sk_indexVersion},
+      {"rootPath", m_rootPath.string()},
+      {"recursive", m_recursive},
+      {"files", std::move(files)}};
+
+    fs::create_directories(indexFile.parent_path());
+
+    // Write next to the index and rename, so that concurrent readers never see a partial index.
+    // The temporary file is unique to this save, so that concurrent saves never write the same file.
+    const fs::path tempFile = uniqueTempFile(indexFile);
+    {
+      std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+      out << json.dump();
+      if (!out) {
+        spdlog::warn("Could not write DICOM header index {}", tempFile);
+        out.close();
+        removeQuietly(tempFile);
+        return false;
+      }
+    }
+
+    std::error_code ec;
+    fs::rename(tempFile, indexFile, ec);
+    if (ec) {
+      spdlog::warn("Could not replace DICOM header index {}: {}", indexFile, ec.message());
+      removeQuietly(tempFile);
+      return false;
+    }
+
+    spdlog::debug("Saved DICOM header index {} with {} files", indexFile, m_headers.size());
+    return true;
+  }
+  catch (const std::exception& e) {
+    spdlog::warn("Could not save DICOM header index {}: {}", indexFile, e.what());
+    return false;
+  }
+}
+
+const FileHeader* HeaderIndex::find(const fs::path& path, std::uintmax_t fileSize, int64_t modifiedTime) const
+{
+  const auto it = m_headers.find(path.string());
+  if (it == m_headers.end() || it->second.fileSize != fileSize || it->second.modifiedTime != modifiedTime) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
+void HeaderIndex::insert(FileHeader header)
+{
+  std::string key = header.path.string();
+  m_headers.insert_or_assign(std::move(key), std::move(header));
+}
+
+void HeaderIndex::clear()
+{
+  m_headers.clear();
+}
+
+std::size_t HeaderIndex::size() const
+{
+  return m_headers.size();
+}
+
+const fs::path& HeaderIndex::rootPath() const
+{
+  return m_rootPath;
+}
+
+bool HeaderIndex::recursive() const
+{
+  return m_recursive;
+}
+
+fs::path headerIndexFile(const fs::path& indexDirectory, const fs::path& rootPath, bool recursive)
+{
+  const uint64_t hash = stableHash(rootPath.string() + (recursive ? "|recursive" : "|flat"));
+  return indexDirectory / fmt::format("dicom-index-{:016x}.json", hash);
+}
+} // namespace dicom
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "image/DicomSeries.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dicom
+{
+/**
+ * @brief Header fields of one file found while scanning for DICOM series.
+ *
+ * Headers are cached by the header index, so they hold only what series discovery needs to group,
+ * order and measure slices without opening the file again.
+ */
+struct FileHeader
+{
+  std::filesystem::path path;
+  std::uintmax_t fileSize = 0;
+  int64_t modifiedTime = 0; //!< Last write time in ticks of the file clock
+  bool isDicom = false;     //!< False for files that are not DICOM images; other fields are then empty
+
+  /// Series Instance UID refined by the series details used by ITK's GDCMSeriesFileNames (series
+  /// number, sequence name, slice thickness, rows and columns), so that the identifiers match the
+  /// series UIDs that ITK reports
+  std::string seriesIdentifier;
+  std::string sopInstanceUid;
+  std::optional<int32_t> instanceNumber;
+
+  /// Geometry of the file on its own, as read by ITK's GDCMImageIO
+  SeriesGeometry geometry;
+
+  /// Metadata string values of the file. Only kept for the representative first file of each
+  /// series, whose metadata describes the series, and only for tags allowed by isIndexedMetadataTag().
+  std::vector<RawMetadataEntry> metadata;
+};
+
+/**
+ * @brief Persistent index of the file headers under one scanned folder.
+ *
+ * Headers are keyed by file path and are only reused while the size and last write time of the file
+ * are unchanged.
+ */
+class HeaderIndex
+{
+public:
+  /**
+   * @param rootPath Folder that the index describes.
+   * @param recursive Whether the folder is scanned recursively.
+   */
+  HeaderIndex(std::filesystem::path rootPath, bool recursive);
+
+  /**
+   * @brief Load an index from a file.
+   * @param indexFile File written by save().
+   * @param rootPath Folder that the index must describe.
+   * @param recursive Whether the index must describe a recursive scan.
+   * @return The index, or std::nullopt when the file does not exist, cannot be parsed, was written by
+   * another index version or describes another scan.
+   */
+  static std::optional<HeaderIndex>
+  load(const std::filesystem::path& indexFile, const std::filesystem::path& rootPath, bool recursive);
+
+  /**
+   * @brief Write the index to a file, replacing it atomically.
+   * @return True on success. Failures are logged.
+   */
+  bool save(const std::filesystem::path& indexFile) const;
+
+  /**
+   * @brief Find the cached header of a file.
+   * @return The header, or nullptr when the file is not indexed or its size or write time changed.
+   */
+  const FileHeader* find(const std::filesystem::path& path, std::uintmax_t fileSize, int64_t modifiedTime) const;
+
+  /// @brief Add or replace the header of a file.
+  void insert(FileHeader header);
+
+  /// @brief Remove all headers.
+  void clear();
+
+  std::size_t size() const;
+
+  const std::filesystem::path& rootPath() const;
+  bool recursive() const;
+
+private:
+  std::filesystem::path m_rootPath;
+  bool m_recursive = true;
+  std::unordered_map<std::string, FileHeader> m_headers; //!< Keyed by file path
+};
+
+/**
+ * @brief Name of the index file of a scanned folder within an index directory.
+ * @param indexDirectory Directory holding the indexes of all scanned folders.
+ * @param rootPath Scanned folder.
+ * @param recursive Whether the folder is scanned recursively.
+ */
+std::filesystem::path headerIndexFile(
+  const std::filesystem::path& indexDirectory,
+  const std::filesystem::path& rootPath,
+  bool recursive);
+} // namespace dicom
@@ -1,12 +1,13 @@
 #include "image/DicomSeries.h"
+#include "image/DicomHeaderIndex.h"
 
 #include "common/MathFuncs.h"
+#include "common/Parallel.h"
 
 #include "image/internal/ImageUtility.tpp"
 #include "image/internal/ImageUtilityItk.h"
 
 #include <itkGDCMImageIO.h>
-#include <itkGDCMSeriesFileNames.h>
 #include <itkImageFileReader.h>
 #include <itkImageRegionConstIterator.h>
 #include <itkImageSeriesReader.h>
@@ -17,11 +18,16 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <cctype>
+#include <functional>
 #include <limits>
+#include <map>
+#include <mutex>
 #include <set>
 #include <sstream>
+#include <thread>
 #include <type_traits>
 #include <vector>
 #include <unordered_map>
@@ -45,6 +51,8 @@ constexpr std::array<const char*, 9> sk_phiTags{
   "0008|1050"  // PerformingPhysicianName
 };
 
+/// Tags shown in series summaries and the only tags kept in the header index. They include every tag
+/// read by readSeriesMetadata() and readTemporalInfo().
 constexpr std::array<const char*, 18> sk_summaryTags{
   "0008|0020", // StudyDate
   "0008|0030", // StudyTime
@@ -282,40 +290,46 @@ std::string sliceOrientationFromDirections(const glm::mat3& directions)
   return plane;
 }
 
-template<typename T>
-dicom::SeriesGeometry geometryFromImage(const typename itk::Image<T, 3>::Pointer& image)
+dicom::SeriesGeometry geometryFromImageIo(const itk::ImageIOBase& imageIo)
 {
-  dicom::SeriesGeometry geometry;
-  if (!image) {
-    return geometry;
+  // Axes missing from 2D files keep unit size and spacing and an identity direction, as when
+  // ITK reads them into a 3D image
+  glm::uvec3 dimensions{1u};
+  glm::vec3 spacing{1.0f};
+  glm::vec3 origin{0.0f};
+  glm::mat3 directions{1.0f};
+
+  const unsigned int numDims = std::min(imageIo.GetNumberOfDimensions(), 3u);
+  for (unsigned int i = 0; i < numDims; ++i) {
+    dimensions[i] = static_cast<unsigned int>(imageIo.GetDimensions(i));
+    spacing[i] = static_cast<float>(imageIo.GetSpacing(i));
+    origin[i] = static_cast<float>(imageIo.GetOrigin(i));
+
+    // Same layout as the rows of the ITK image direction matrix: element [r][i] holds
+    // component r of the direction of axis i
+    const std::vector<double> axis = imageIo.GetDirection(i);
+    for (unsigned int r = 0; r < numDims && r < axis.size(); ++r) {
+      directions[r][i] = static_cast<float>(axis[r]);
+    }
   }
 
-  const auto region = image->GetLargestPossibleRegion();
-  const auto size = region.GetSize();
-  const auto spacing = image->GetSpacing();
-  const auto origin = image->GetOrigin();
-  const auto direction = image->GetDirection();
-
-  geometry.dimensions = glm::uvec3{
-    static_cast<unsigned int>(size[0]),
-    static_cast<unsigned int>(size[1]),
-    static_cast<unsigned int>(size[2])};
-  geometry.spacing = glm::vec3{spacing[0], spacing[1], spacing[2]};
-  geometry.origin = glm::vec3{origin[0], origin[1], origin[2]};
-  geometry.directions = glm::mat3{
-    direction[0][0],
-    direction[0][1],
-    direction[0][2],
-    direction[1][0],
-    direction[1][1],
-    direction[1][2],
-    direction[2][0],
-    direction[2][1],
-    direction[2][2]};
+  dicom::SeriesGeometry geometry;
+  geometry.dimensions = dimensions;
+  geometry.spacing = spacing;
+  geometry.origin = origin;
+  geometry.directions = directions;
   geometry.sliceOrientation = sliceOrientationFromDirections(geometry.directions);
   return geometry;
 }
 
+/// Unit normal of the slices of a geometry: the direction of its third axis
+glm::vec3 sliceNormal(const dicom::SeriesGeometry& geometry)
+{
+  const glm::mat3& d = geometry.directions;
+  const glm::vec3 normal{d[0][2], d[1][2], d[2][2]};
+  return glm::length(normal) > 0.0f ? glm::normalize(normal) : glm::vec3{0.0f, 0.0f, 1.0f};
+}
+
 std::vector<std::string> geometryWarnings(
   const dicom::SeriesGeometry& geometry,
   std::size_t fileCount,
@@ -334,40 +348,19 @@ std::vector<std::string> geometryWarnings(
   return warnings;
 }
 
-std::vector<std::string> sliceSpacingWarnings(const std::vector<fs::path>& files, const dicom::SeriesGeometry& geometry)
+std::vector<std::string> sliceSpacingWarnings(
+  const std::vector<float>& sortedPositions,
+  const dicom::SeriesGeometry& geometry)
 {
   std::vector<std::string> warnings;
-  if (files.size() < 3 || geometry.spacing.z <= 0.0f) {
+  if (sortedPositions.size() < 3 || geometry.spacing.z <= 0.0f) {
     return warnings;
   }
 
-  std::vector<float> positions;
-  positions.reserve(files.size());
-  const glm::vec3 sliceNormal = glm::normalize(geometry.directions[2]);
-
-  for (const auto& file : files) {
-    try {
-      auto imageIo = itk::GDCMImageIO::New();
-      imageIo->SetFileName(file.string());
-      imageIo->ReadImageInformation();
-      const auto position = parseDicomVec3(metadataValue(imageIo->GetMetaDataDictionary(), "0020|0032"));
-      if (!position) {
-        return warnings;
-      }
-      positions.push_back(glm::dot(*position, sliceNormal));
-    }
-    catch (const std::exception& e) {
-      spdlog::debug("Could not inspect DICOM slice position {}: {}", file, e.what());
-      return warnings;
-    }
-  }
-
-  std::sort(positions.begin(), positions.end());
-
   std::vector<float> gaps;
-  gaps.reserve(positions.size() - 1);
-  for (std::size_t i = 1; i < positions.size(); ++i) {
-    gaps.push_back(std::abs(positions.at(i) - positions.at(i - 1)));
+  gaps.reserve(sortedPositions.size() - 1);
+  for (std::size_t i = 1; i < sortedPositions.size(); ++i) {
+    gaps.push_back(std::abs(sortedPositions.at(i) - sortedPositions.at(i - 1)));
   }
 
   const float expectedGap = geometry.spacing.z;
@@ -385,35 +378,291 @@ std::vector<std::string> sliceSpacingWarnings(const std::vector<fs::path>& files
   return warnings;
 }
 
-template<typename T>
-std::optional<dicom::SeriesGeometry> readSeriesGeometry(
-  const std::vector<fs::path>& files,
-  const itk::GDCMImageIO::Pointer& imageIo)
+/// Series UID refinement used by GDCMSeriesFileNames::SetUseSeriesDetails(true): series number,
+/// sequence name, slice thickness, rows and columns
+constexpr std::array<const char*, 5> sk_seriesDetailTags{
+  "0020|0011", // SeriesNumber
+  "0018|0024", // SequenceName
+  "0018|0050", // SliceThickness
+  "0028|0010", // Rows
+  "0028|0011"  // Columns
+};
+
+/// Build the series identifier that GDCM's series helper reports for a file, so that series keep
+/// the identifiers they had when discovered with GDCMSeriesFileNames
+std::string seriesIdentifier(const MetadataDictionary& dict)
 {
-  using ImageType = itk::Image<T, 3>;
-  using ReaderType = itk::ImageSeriesReader<ImageType>;
+  const std::string uid = metadataValue(dict, "0020|000e");
+  std::string id = uid.c_str();
 
-  if (files.empty()) {
-    return std::nullopt;
+  for (const char* tag : sk_seriesDetailTags) {
+    const std::string detail = metadataValue(dict, tag);
+    if (id == uid && !detail.empty()) {
+      id += '.';
+    }
+    id += detail;
   }
 
-  std::vector<std::string> fileNames;
-  fileNames.reserve(files.size());
-  for (const auto& file : files) {
-    fileNames.push_back(file.string());
+  std::erase_if(id, [](char ch) { return ch != '.' && !std::isalnum(static_cast<unsigned char>(ch)); });
+  return id;
+}
+
+/// Metadata string values of a file for the tags that the header index may keep
+std::vector<dicom::RawMetadataEntry> indexableMetadataEntries(const MetadataDictionary& dict)
+{
+  std::vector<dicom::RawMetadataEntry> entries;
+  for (const char* tag : sk_summaryTags) {
+    if (const auto value = exposeString(dict, tag); value && !value->empty()) {
+      entries.push_back(dicom::RawMetadataEntry{tag, *value});
+    }
+  }
+  return entries;
+}
+
+MetadataDictionary dictionaryFromEntries(const std::vector<dicom::RawMetadataEntry>& entries)
+{
+  MetadataDictionary dict;
+  for (const auto& entry : entries) {
+    itk::EncapsulateMetaData<std::string>(dict, entry.tag, entry.value);
   }
+  return dict;
+}
+
+/// A file found under a scanned folder, with the attributes that key the header index
+struct ListedFile
+{
+  fs::path path;
+  std::uintmax_t size = 0;
+  int64_t modifiedTime = 0;
+};
+
+std::vector<ListedFile> listFiles(const fs::path& root, bool recursive)
+{
+  std::vector<ListedFile> files;
+
+  auto addFile = [&files](const fs::directory_entry& entry) {
+    std::error_code ec;
+    if (!entry.is_regular_file(ec)) {
+      return;
+    }
+    const std::uintmax_t size = entry.file_size(ec);
+    if (ec) {
+      return;
+    }
+    const auto modified = entry.last_write_time(ec);
+    if (ec) {
+      return;
+    }
+    files.push_back(ListedFile{entry.path(), size, static_cast<int64_t>(modified.time_since_epoch().count())});
+  };
+
+  std::error_code ec;
+  if (recursive) {
+    for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end;
+         it.increment(ec))
+    {
+      addFile(*it);
+    }
+  }
+  else {
+    for (fs::directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end;
+         it.increment(ec))
+    {
+      addFile(*it);
+    }
+  }
+
+  if (ec) {
+    spdlog::warn("Could not list all files in {}: {}", root, ec.message());
+  }
+
+  std::sort(files.begin(), files.end(), [](const ListedFile& a, const ListedFile& b) { return a.path < b.path; });
+  return files;
+}
+
+/**
+ * @brief Read the header of one file.
+ * @param keepMetadata Keep the metadata values of the file, which are otherwise dropped to keep the
+ * header index small.
+ * @return Header marked as not DICOM when GDCM cannot read the file as an image.
+ */
+dicom::FileHeader readFileHeader(const ListedFile& file, bool keepMetadata)
+{
+  dicom::FileHeader header;
+  header.path = file.path;
+  header.fileSize = file.size;
+  header.modifiedTime = file.modifiedTime;
 
   try {
-    auto reader = ReaderType::New();
-    reader->SetImageIO(imageIo);
-    reader->SetFileNames(fileNames);
-    reader->UpdateOutputInformation();
-    return geometryFromImage<T>(reader->GetOutput());
+    auto imageIo = itk::GDCMImageIO::New();
+    if (!imageIo->CanReadFile(file.path.string().c_str())) {
+      return header;
+    }
+
+    imageIo->SetFileName(file.path.string());
+    imageIo->ReadImageInformation();
+    const auto& dict = imageIo->GetMetaDataDictionary();
+
+    header.isDicom = true;
+    header.seriesIdentifier = seriesIdentifier(dict);
+    header.sopInstanceUid = metadataValue(dict, "0008|0018");
+    if (const auto instance = parseDicomDouble(metadataValue(dict, "0020|0013"))) {
+      header.instanceNumber = static_cast<int32_t>(*instance);
+    }
+    header.geometry = geometryFromImageIo(*imageIo);
+
+    if (keepMetadata) {
+      header.metadata = indexableMetadataEntries(dict);
+    }
   }
   catch (const std::exception& e) {
-    spdlog::warn("Could not read DICOM series geometry from {} files: {}", files.size(), e.what());
-    return std::nullopt;
+    spdlog::debug("Could not read DICOM image header {}: {}", file.path, e.what());
+    header.isDicom = false;
+  }
+
+  return header;
+}
+
+/// Number of threads for per-file work, including the calling thread. Zero maxThreads picks one
+/// fewer than the thread budget of the calling thread.
+unsigned int workerThreadCount(std::size_t numFiles, unsigned int maxThreads)
+{
+  if (0 == maxThreads) {
+    maxThreads = std::max(parallel::threadBudget() - 1, 1u);
+  }
+  return static_cast<unsigned int>(std::clamp<std::size_t>(numFiles, 1, static_cast<std::size_t>(maxThreads)));
+}
+
+/**
+ * @brief Get the headers of listed files, reusing indexed headers of unchanged files and reading the
+ * others in parallel.
+ * @param[out] numRead Number of headers read from disk.
+ */
+std::vector<dicom::FileHeader> scanFileHeaders(
+  const std::vector<ListedFile>& files,
+  const dicom::HeaderIndex* index,
+  unsigned int maxThreads,
+  std::size_t& numRead)
+{
+  std::vector<dicom::FileHeader> headers(files.size());
+  std::vector<std::size_t> toRead;
+
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    const ListedFile& file = files[i];
+    if (const dicom::FileHeader* cached = index ? index->find(file.path, file.size, file.modifiedTime) : nullptr) {
+      headers[i] = *cached;
+    }
+    else {
+      toRead.push_back(i);
+    }
+  }
+
+  numRead = toRead.size();
+  if (toRead.empty()) {
+    return headers;
+  }
+
+  std::atomic<std::size_t> next{0};
+  auto worker = [&]() {
+    for (std::size_t n = next++; n < toRead.size(); n = next++) {
+      const std::size_t i = toRead[n];
+      headers[i] = readFileHeader(files[i], false);
+    }
+  };
+
+  const unsigned int numThreads = workerThreadCount(toRead.size(), maxThreads);
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads - 1);
+  for (unsigned int t = 1; t < numThreads; ++t) {
+    threads.emplace_back(worker);
+  }
+  worker();
+
+  for (auto& thread : threads) {
+    thread.join();
   }
+
+  return headers;
+}
+
+/// Slices of one series in acquisition order, with their positions along the slice normal
+struct SeriesSlices
+{
+  std::vector<dicom::FileHeader*> headers;
+  std::vector<float> positions;
+};
+
+/**
+ * @brief Group DICOM file headers into series and order the slices of each series.
+ *
+ * Files repeating the SOP Instance UID of another file in the series are dropped. Slices are ordered
+ * by position along the slice normal, then by instance number and file name.
+ */
+std::map<std::string, SeriesSlices> groupSeries(std::vector<dicom::FileHeader>& headers)
+{
+  std::map<std::string, SeriesSlices> series;
+  std::unordered_map<std::string, std::unordered_set<std::string>> instances;
+
+  for (auto& header : headers) {
+    if (!header.isDicom) {
+      continue;
+    }
+    if (!header.sopInstanceUid.empty() && !instances[header.seriesIdentifier].insert(header.sopInstanceUid).second) {
+      spdlog::debug("Skipping DICOM file {} that repeats instance {}", header.path, header.sopInstanceUid);
+      continue;
+    }
+    series[header.seriesIdentifier].headers.push_back(&header);
+  }
+
+  for (auto& [identifier, slices] : series) {
+    const glm::vec3 normal = sliceNormal(slices.headers.front()->geometry);
+
+    std::vector<std::pair<float, dicom::FileHeader*>> ordered;
+    ordered.reserve(slices.headers.size());
+    for (dicom::FileHeader* header : slices.headers) {
+      ordered.emplace_back(glm::dot(header->geometry.origin, normal), header);
+    }
+
+    std::sort(ordered.begin(), ordered.end(), [](const auto& a, const auto& b) {
+      if (a.first != b.first) {
+        return a.first < b.first;
+      }
+      const int32_t instanceA = a.second->instanceNumber.value_or(std::numeric_limits<int32_t>::max());
+      const int32_t instanceB = b.second->instanceNumber.value_or(std::numeric_limits<int32_t>::max());
+      if (instanceA != instanceB) {
+        return instanceA < instanceB;
+      }
+      return a.second->path < b.second->path;
+    });
+
+    slices.headers.clear();
+    for (const auto& [position, header] : ordered) {
+      slices.positions.push_back(position);
+      slices.headers.push_back(header);
+    }
+  }
+
+  return series;
+}
+
+/// Geometry of a series of slices: the geometry of the first slice stacked over the slice count,
+/// with slice spacing averaged over the slice positions
+dicom::SeriesGeometry seriesGeometry(const SeriesSlices& slices)
+{
+  dicom::SeriesGeometry geometry = slices.headers.front()->geometry;
+  const std::size_t numSlices = slices.headers.size();
+
+  if (numSlices > 1 && geometry.dimensions.z <= 1u) {
+    geometry.dimensions.z = static_cast<unsigned int>(numSlices);
+
+    const float extent = slices.positions.back() - slices.positions.front();
+    if (extent > 0.0f) {
+      geometry.spacing.z = extent / static_cast<float>(numSlices - 1);
+    }
+  }
+
+  return geometry;
 }
 
 std::vector<fs::path> canonicalInputRoots(const std::vector<fs::path>& inputPaths)
@@ -448,16 +697,6 @@ std::vector<fs::path> canonicalInputRoots(const std::vector<fs::path>& inputPath
   return roots;
 }
 
-std::vector<fs::path> toPaths(const std::vector<std::string>& fileNames)
-{
-  std::vector<fs::path> paths;
-  paths.reserve(fileNames.size());
-  for (const auto& fileName : fileNames) {
-    paths.emplace_back(fileName);
-  }
-  return paths;
-}
-
 std::string uidTail(const std::string& uid)
 {
   const std::size_t lastSeparator = uid.rfind('.');
@@ -596,13 +835,14 @@ std::optional<Image> loadScalarMultiframeCineImage(const dicom::SeriesInfo& seri
   }
 }
 
+/**
+ * @brief Read a series with ITK's ImageSeriesReader, which decodes one file at a time.
+ *
+ * Used for series whose files are not single-frame scalar slices.
+ */
 template<typename T>
-std::optional<Image> loadScalarSeriesImage(const dicom::SeriesInfo& series)
+typename itk::Image<T, 3>::Pointer readSeriesWithItk(const dicom::SeriesInfo& series)
 {
-  if (series.temporal.multiframe && series.files.size() == 1u) {
-    return loadScalarMultiframeCineImage<T>(series);
-  }
-
   using ImageType = itk::Image<T, 3>;
   using ReaderType = itk::ImageSeriesReader<ImageType>;
 
@@ -612,14 +852,281 @@ std::optional<Image> loadScalarSeriesImage(const dicom::SeriesInfo& series)
     fileNames.push_back(file.string());
   }
 
+  auto imageIo = itk::GDCMImageIO::New();
+  auto reader = ReaderType::New();
+  reader->SetImageIO(imageIo);
+  reader->SetFileNames(fileNames);
+  reader->Update();
+  return reader->GetOutput();
+}
+
+/// In-plane geometry that every slice of a series must share with its first slice
+struct SliceGeometry
+{
+  glm::u64vec2 size{0};
+  glm::dvec2 spacing{1.0};
+  glm::dvec3 row{1.0, 0.0, 0.0};    //!< Direction of the slice rows
+  glm::dvec3 column{0.0, 1.0, 0.0}; //!< Direction of the slice columns
+};
+
+/// Largest difference between direction cosines of slices in one series
+constexpr double sk_sliceDirectionTolerance = 1.0e-4;
+
+/// Largest relative difference between in-plane spacings of slices in one series
+constexpr double sk_sliceSpacingTolerance = 1.0e-4;
+
+SliceGeometry sliceGeometryFromImageIo(const itk::ImageIOBase& imageIo)
+{
+  SliceGeometry geometry;
+  geometry.size = {imageIo.GetDimensions(0), imageIo.GetDimensions(1)};
+  geometry.spacing = {imageIo.GetSpacing(0), imageIo.GetSpacing(1)};
+
+  const std::vector<double> row = imageIo.GetDirection(0);
+  const std::vector<double> column = imageIo.GetDirection(1);
+  for (int r = 0; r < 3; ++r) {
+    const auto i = static_cast<std::size_t>(r);
+    geometry.row[r] = (i < row.size()) ? row[i] : ((0 == r) ? 1.0 : 0.0);
+    geometry.column[r] = (i < column.size()) ? column[i] : ((1 == r) ? 1.0 : 0.0);
+  }
+  return geometry;
+}
+
+/// Whether a slice has the orientation and in-plane spacing of the first slice of its series
+bool sliceGeometryMatches(const SliceGeometry& slice, const SliceGeometry& series)
+{
+  const auto spacingMatches = [](double a, double b) {
+    return std::abs(a - b) <= sk_sliceSpacingTolerance * std::max(std::abs(a), std::abs(b));
+  };
+
+  return glm::all(glm::lessThanEqual(glm::abs(slice.row - series.row), glm::dvec3{sk_sliceDirectionTolerance})) &&
+         glm::all(glm::lessThanEqual(glm::abs(slice.column - series.column), glm::dvec3{sk_sliceDirectionTolerance})) &&
+         spacingMatches(slice.spacing.x, series.spacing.x) && spacingMatches(slice.spacing.y, series.spacing.y);
+}
+
+/**
+ * @brief Decode one single-frame scalar slice into its place in the series buffer.
+ * @param[in] fileName Slice file.
+ * @param[in] seriesGeometry Geometry of the first slice of the series. Every slice must match its size,
+ * orientation and in-plane spacing.
+ * @param[in] normal Slice normal of the series.
+ * @param[out] dst Destination of the slice pixels in the series buffer.
+ * @param[out] position Position of the slice along the normal.
+ * @return True when the slice was validated and decoded.
+ */
+template<typename T>
+bool decodeSlice(
+  const fs::path& fileName,
+  const SliceGeometry& seriesGeometry,
+  const glm::dvec3& normal,
+  T* dst,
+  double& position)
+{
+  namespace detail = image_utility_load_detail;
+
+  const glm::u64vec2& sliceSize = seriesGeometry.size;
+
   try {
     auto imageIo = itk::GDCMImageIO::New();
-    auto reader = ReaderType::New();
-    reader->SetImageIO(imageIo);
-    reader->SetFileNames(fileNames);
-    reader->Update();
+    imageIo->SetFileName(fileName.string());
+    imageIo->ReadImageInformation();
+
+    const unsigned int numDims = imageIo->GetNumberOfDimensions();
+    if (
+      numDims < 2 || imageIo->GetNumberOfComponents() != 1 || imageIo->GetDimensions(0) != sliceSize.x ||
+      imageIo->GetDimensions(1) != sliceSize.y || (numDims > 2 && imageIo->GetDimensions(2) != 1))
+    {
+      spdlog::error(
+        "DICOM slice {} is not a single-frame scalar slice of the series size {} x {}",
+        fileName,
+        sliceSize.x,
+        sliceSize.y);
+      return false;
+    }
+
+    if (!sliceGeometryMatches(sliceGeometryFromImageIo(*imageIo), seriesGeometry)) {
+      spdlog::error(
+        "DICOM slice {} does not have the orientation and in-plane spacing of the first slice of its series",
+        fileName);
+      return false;
+    }
+
+    position = 0.0;
+    for (unsigned int i = 0; i < std::min(numDims, 3u); ++i) {
+      position += imageIo->GetOrigin(i) * normal[static_cast<int>(i)];
+    }
+
+    const std::size_t numPixels = sliceSize.x * sliceSize.y;
+    const itk::ImageIORegion region = detail::slabRegion(*imageIo, 0, imageIo->GetDimensions(numDims - 1));
+
+    return detail::dispatchImageIoComponentType(*imageIo, fileName, [&]<typename SrcType>() {
+      if constexpr (std::is_same_v<SrcType, T>) {
+        return detail::readImageIoRegion(*imageIo, region, dst, fileName);
+      }
+      else {
+        std::vector<SrcType> slice(numPixels);
+        if (!detail::readImageIoRegion(*imageIo, region, slice.data(), fileName)) {
+          return false;
+        }
+        for (std::size_t i = 0; i < numPixels; ++i) {
+          dst[i] = clampComponentValue<T>(slice[i]);
+        }
+        return true;
+      }
+    });
+  }
+  catch (const std::exception& e) {
+    spdlog::error("Exception decoding DICOM slice {}: {}", fileName, e.what());
+    return false;
+  }
+}
+
+/**
+ * @brief Decode the single-frame scalar slices of a series concurrently into one ITK image.
+ *
+ * Slices are decoded on a bounded pool of threads, each straight into the image buffer at its slice
+ * offset. As with ImageSeriesReader, the geometry is that of the first slice, every slice must
+ * match its size, orientation and in-plane spacing, and the slice spacing is the mean distance
+ * between slice positions.
+ *
+ * @return The image, or nullptr when a slice could not be decoded or loading was canceled.
+ */
+template<typename T>
+typename itk::Image<T, 3>::Pointer decodeSeriesSlices(
+  const dicom::SeriesInfo& series,
+  const itk::ImageIOBase& firstSliceIo,
+  const std::function<void(double)>& progress,
+  const std::atomic_bool* cancel)
+{
+  using ImageType = itk::Image<T, 3>;
+
+  const std::size_t numSlices = series.files.size();
+  const SliceGeometry sliceGeometry = sliceGeometryFromImageIo(firstSliceIo);
+  const glm::u64vec2& sliceSize = sliceGeometry.size;
+  const std::size_t numSlicePixels = sliceSize.x * sliceSize.y;
+
+  typename ImageType::PointType origin;
+  typename ImageType::SpacingType spacing;
+  typename ImageType::DirectionType direction;
+  origin.Fill(0.0);
+  spacing.Fill(1.0);
+  direction.SetIdentity();
+
+  const unsigned int numDims = std::min(firstSliceIo.GetNumberOfDimensions(), 3u);
+  for (unsigned int i = 0; i < numDims; ++i) {
+    origin[i] = firstSliceIo.GetOrigin(i);
+    spacing[i] = firstSliceIo.GetSpacing(i);
+    const std::vector<double> axis = firstSliceIo.GetDirection(i);
+    for (unsigned int r = 0; r < numDims && r < axis.size(); ++r) {
+      direction[r][i] = axis[r];
+    }
+  }
+
+  // Slices read as 2D images have no slice axis: complete the frame with the slice normal
+  if (numDims < 3) {
+    const glm::dvec3 row{direction[0][0], direction[1][0], direction[2][0]};
+    const glm::dvec3 column{direction[0][1], direction[1][1], direction[2][1]};
+    const glm::dvec3 normal = glm::cross(row, column);
+    for (unsigned int r = 0; r < 3; ++r) {
+      direction[r][2] = normal[static_cast<int>(r)];
+    }
+  }
+
+  typename ImageType::SizeType size;
+  size[0] = static_cast<itk::SizeValueType>(sliceSize.x);
+  size[1] = static_cast<itk::SizeValueType>(sliceSize.y);
+  size[2] = static_cast<itk::SizeValueType>(numSlices);
+
+  typename ImageType::RegionType region;
+  region.SetSize(size);
+
+  auto image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  T* buffer = image->GetBufferPointer();
+
+  const glm::dvec3 normal{direction[0][2], direction[1][2], direction[2][2]};
+  std::vector<double> positions(numSlices, 0.0);
+
+  std::atomic<std::size_t> nextSlice{0};
+  std::atomic_bool failed{false};
+  std::size_t numDecoded = 0;
+  std::mutex progressMutex;
+
+  auto worker = [&]() {
+    for (std::size_t k = nextSlice++; k < numSlices; k = nextSlice++) {
+      if (failed || (cancel && cancel->load())) {
+        return;
+      }
+      if (!decodeSlice<T>(series.files[k], sliceGeometry, normal, buffer + k * numSlicePixels, positions[k])) {
+        failed = true;
+        return;
+      }
+      if (progress) {
+        std::scoped_lock lock(progressMutex);
+        progress(static_cast<double>(++numDecoded) / static_cast<double>(numSlices));
+      }
+    }
+  };
+
+  const unsigned int numThreads = workerThreadCount(numSlices, 0);
+
+  spdlog::debug("Decoding {} slices of DICOM series {} on {} threads", numSlices, series.seriesInstanceUid, numThreads);
+
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads - 1);
+  for (unsigned int t = 1; t < numThreads; ++t) {
+    threads.emplace_back(worker);
+  }
+  worker();
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
 
-    Image image = createImageFromItkImage<T>(reader->GetOutput(), series.displayName);
+  if (cancel && cancel->load()) {
+    spdlog::info("Loading DICOM series {} was canceled", series.seriesInstanceUid);
+    return nullptr;
+  }
+  if (failed) {
+    return nullptr;
+  }
+
+  if (numSlices > 1) {
+    const double extent = std::abs(positions.back() - positions.front());
+    if (extent > 0.0) {
+      spacing[2] = extent / static_cast<double>(numSlices - 1);
+    }
+  }
+
+  image->SetOrigin(origin);
+  image->SetSpacing(spacing);
+  image->SetDirection(direction);
+  return image;
+}
+
+template<typename T>
+std::optional<Image> loadScalarSeriesImage(
+  const dicom::SeriesInfo& series,
+  const itk::ImageIOBase& firstSliceIo,
+  const std::function<void(double)>& progress,
+  const std::atomic_bool* cancel)
+{
+  if (series.temporal.multiframe && series.files.size() == 1u) {
+    return loadScalarMultiframeCineImage<T>(series);
+  }
+
+  const unsigned int numDims = firstSliceIo.GetNumberOfDimensions();
+  const bool singleFrameSlices =
+    numDims >= 2 && firstSliceIo.GetNumberOfComponents() == 1 && (numDims < 3 || firstSliceIo.GetDimensions(2) == 1);
+
+  try {
+    typename itk::Image<T, 3>::Pointer itkImage =
+      singleFrameSlices ? decodeSeriesSlices<T>(series, firstSliceIo, progress, cancel) : readSeriesWithItk<T>(series);
+    if (!itkImage) {
+      return std::nullopt;
+    }
+
+    Image image = createImageFromItkImage<T>(itkImage, series.displayName);
     if (!series.files.empty()) {
       image.header().setFileName(series.files.front());
       image.header().setExistsOnDisk(true);
@@ -786,6 +1293,12 @@ bool isPrivateTag(const std::string& tag)
   return (group % 2u) == 1u;
 }
 
+bool isIndexedMetadataTag(const std::string& tag)
+{
+  const std::string normalized = normalizeTag(tag);
+  return std::find(sk_summaryTags.begin(), sk_summaryTags.end(), normalized) != sk_summaryTags.end();
+}
+
 bool includeMetadataTag(const std::string& tag, bool includePrivateMetadata)
 {
   if (isPhiTag(tag)) {
@@ -858,57 +1371,78 @@ DiscoverResult discoverSeries(const std::vector<fs::path>& inputPaths, const Dis
     }
 
     try {
-      auto names = itk::GDCMSeriesFileNames::New();
-      names->SetUseSeriesDetails(true);
-      names->SetRecursive(options.recursive);
-      names->SetInputDirectory(root.string());
-
-      const auto seriesUids = names->GetSeriesUIDs();
-      for (const auto& seriesUid : seriesUids) {
-        const auto rawFiles = names->GetFileNames(seriesUid);
+      const bool useIndex = !options.indexDirectory.empty();
+      const fs::path indexFile =
+        useIndex ? headerIndexFile(options.indexDirectory, root, options.recursive) : fs::path{};
+      const std::optional<HeaderIndex> index =
+        useIndex ? HeaderIndex::load(indexFile, root, options.recursive) : std::nullopt;
+
+      const std::vector<ListedFile> files = listFiles(root, options.recursive);
+
+      std::size_t numRead = 0;
+      std::vector<FileHeader> headers = scanFileHeaders(files, index ? &*index : nullptr, options.maxThreads, numRead);
+      const std::size_t numFromIndex = files.size() - numRead;
+
+      for (auto& [identifier, slices] : groupSeries(headers)) {
+        FileHeader& first = *slices.headers.front();
+
+        // The first file of each series describes the series. Its metadata is read once and then
+        // kept in the index.
+        if (first.metadata.empty()) {
+          FileHeader reread = readFileHeader(ListedFile{first.path, first.fileSize, first.modifiedTime}, true);
+          first.metadata = std::move(reread.metadata);
+          ++numRead;
+        }
+
         SeriesInfo info;
         info.rootPath = root;
-        info.seriesInstanceUid = seriesUid;
-        info.files = toPaths(rawFiles);
-
-        if (info.files.empty()) {
-          info.warnings.emplace_back("Series contains no files");
-          result.series.push_back(std::move(info));
-          continue;
+        info.seriesInstanceUid = identifier;
+        info.files.reserve(slices.headers.size());
+        for (const FileHeader* header : slices.headers) {
+          info.files.push_back(header->path);
         }
 
-        auto imageIo = itk::GDCMImageIO::New();
-        imageIo->SetFileName(info.files.front().string());
-        imageIo->ReadImageInformation();
-        const auto& dict = imageIo->GetMetaDataDictionary();
+        const MetadataDictionary dict = dictionaryFromEntries(first.metadata);
         info.metadata = readSeriesMetadata(dict);
         if (info.metadata.seriesInstanceUid.empty()) {
-          info.metadata.seriesInstanceUid = seriesUid;
+          info.metadata.seriesInstanceUid = identifier;
         }
         info.temporal = readTemporalInfo(dict);
         info.metadataSummary = filteredMetadataEntries(rawMetadataEntries(dict), options.includePrivateMetadata);
-        info.displayName = displayNameForSeries(info.metadata, seriesUid);
+        info.displayName = displayNameForSeries(info.metadata, identifier);
 
         if (!isImageLikeModality(info.metadata.modality)) {
           info.warnings.emplace_back("Series modality is not an image volume: " + info.metadata.modality);
         }
 
-        const std::optional<SeriesGeometry> geometry = readSeriesGeometry<float>(info.files, imageIo);
-        if (geometry) {
-          info.geometry = *geometry;
-          auto warnings = geometryWarnings(info.geometry, info.files.size(), info.temporal);
-          info.warnings.insert(info.warnings.end(), warnings.begin(), warnings.end());
-          if (!info.temporal.multiframe) {
-            auto spacingWarnings = sliceSpacingWarnings(info.files, info.geometry);
-            info.warnings.insert(info.warnings.end(), spacingWarnings.begin(), spacingWarnings.end());
-          }
-        }
-        else {
-          info.warnings.emplace_back("Could not read series geometry");
+        info.geometry = seriesGeometry(slices);
+        auto warnings = geometryWarnings(info.geometry, info.files.size(), info.temporal);
+        info.warnings.insert(info.warnings.end(), warnings.begin(), warnings.end());
+        if (!info.temporal.multiframe) {
+          auto spacingWarnings = sliceSpacingWarnings(slices.positions, info.geometry);
+          info.warnings.insert(info.warnings.end(), spacingWarnings.begin(), spacingWarnings.end());
         }
 
         result.series.push_back(std::move(info));
       }
+
+      result.numHeadersRead += numRead;
+      result.numHeadersFromIndex += numFromIndex;
+      spdlog::debug(
+        "Scanned {} files in {}: read {} headers and reused {} indexed headers",
+        files.size(),
+        root,
+        numRead,
+        numFromIndex);
+
+      // Rewrite the index when headers were read or indexed files were removed
+      if (useIndex && (numRead > 0 || !index || index->size() != headers.size())) {
+        HeaderIndex updated(root, options.recursive);
+        for (auto& header : headers) {
+          updated.insert(std::move(header));
+        }
+        updated.save(indexFile);
+      }
     }
     catch (const std::exception& e) {
       result.warnings.push_back("Could not discover DICOM series in " + root.string() + ": " + e.what());
@@ -928,7 +1462,9 @@ DiscoverResult discoverSeries(const std::vector<fs::path>& inputPaths, const Dis
 std::optional<Image> loadSeriesImage(
   const SeriesInfo& series,
   Image::ImageRepresentation imageRep,
-  Image::MultiComponentBufferType bufferType)
+  Image::MultiComponentBufferType bufferType,
+  const std::function<void(double)>& progress,
+  const std::atomic_bool* cancel)
 {
   if (imageRep != Image::ImageRepresentation::Image || bufferType != Image::MultiComponentBufferType::SeparateImages) {
     spdlog::error("DICOM series loading currently supports scalar image volumes only");
@@ -946,21 +1482,21 @@ std::optional<Image> loadSeriesImage(
 
     switch (fromItkComponentType(imageIo->GetComponentType())) {
       case ComponentType::Int8:
-        return loadScalarSeriesImage<int8_t>(series);
+        return loadScalarSeriesImage<int8_t>(series, *imageIo, progress, cancel);
       case ComponentType::UInt8:
-        return loadScalarSeriesImage<uint8_t>(series);
+        return loadScalarSeriesImage<uint8_t>(series, *imageIo, progress, cancel);
       case ComponentType::Int16:
-        return loadScalarSeriesImage<int16_t>(series);
+        return loadScalarSeriesImage<int16_t>(series, *imageIo, progress, cancel);
       case ComponentType::UInt16:
-        return loadScalarSeriesImage<uint16_t>(series);
+        return loadScalarSeriesImage<uint16_t>(series, *imageIo, progress, cancel);
       case ComponentType::Int32:
-        return loadScalarSeriesImage<int32_t>(series);
+        return loadScalarSeriesImage<int32_t>(series, *imageIo, progress, cancel);
       case ComponentType::UInt32:
-        return loadScalarSeriesImage<uint32_t>(series);
+        return loadScalarSeriesImage<uint32_t>(series, *imageIo, progress, cancel);
       case ComponentType::Float32:
       case ComponentType::Float64:
       case ComponentType::LongDouble:
-        return loadScalarSeriesImage<float>(series);
+        return loadScalarSeriesImage<float>(series, *imageIo, progress, cancel);
       case ComponentType::Long:
       case ComponentType::ULong:
       case ComponentType::LongLong:
@@ -970,7 +1506,7 @@ std::optional<Image> loadSeriesImage(
           "DICOM series {} has unsupported component type {}; loading as signed 32-bit integer",
           series.seriesInstanceUid,
           componentTypeString(fromItkComponentType(imageIo->GetComponentType())));
-        return loadScalarSeriesImage<int32_t>(series);
+        return loadScalarSeriesImage<int32_t>(series, *imageIo, progress, cancel);
     }
 
     return std::nullopt;
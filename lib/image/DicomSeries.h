@@ -6,9 +6,11 @@
 #include <glm/vec3.hpp>
 #include <glm/geometric.hpp>
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <optional>
 #include <string>
 #include <vector>
@@ -103,6 +105,9 @@ struct SeriesInfo
   SeriesGeometry geometry;
   SeriesMetadata metadata;
   SeriesTemporalInfo temporal;
+
+  /// Display metadata of the series, limited to the tags kept in the header index
+  /// @see isIndexedMetadataTag
   std::vector<MetadataEntry> metadataSummary;
   std::vector<std::string> warnings;
 
@@ -120,12 +125,21 @@ struct DiscoverOptions
 {
   bool recursive = true;
   bool includePrivateMetadata = false;
+
+  /// Directory of persistent file header indexes, which let unchanged folders be scanned again
+  /// without opening their files. An empty path disables the indexes.
+  std::filesystem::path indexDirectory;
+
+  unsigned int maxThreads = 0; //!< Maximum number of header-reading threads; 0 picks a count from the thread budget
 };
 
 struct DiscoverResult
 {
   std::vector<SeriesInfo> series;
   std::vector<std::string> warnings;
+
+  std::size_t numHeadersRead = 0;      //!< Number of file headers read from disk
+  std::size_t numHeadersFromIndex = 0; //!< Number of file headers reused from header indexes
 };
 
 /**
@@ -155,6 +169,18 @@ bool isPhiTag(const std::string& tag);
  */
 bool isPrivateTag(const std::string& tag);
 
+/**
+ * @brief Check whether the value of a tag may be written to the persistent header index.
+ *
+ * The index keeps an allowlist of the tags that describe a series in discovery results: the summary
+ * tags, which include every tag read for series metadata and temporal information. Patient-identifying,
+ * private and all other tags are never written to disk.
+ *
+ * @param tag DICOM tag in `gggg|eeee` form.
+ * @return True when the tag is in the allowlist.
+ */
+bool isIndexedMetadataTag(const std::string& tag);
+
 /**
  * @brief Check whether metadata should be exposed in the UI.
  * @param tag DICOM tag in `gggg|eeee` form.
@@ -182,6 +208,11 @@ std::string displayNameForSeries(const SeriesMetadata& metadata, const std::stri
 
 /**
  * @brief Discover DICOM image series under folders or parent folders of files.
+ *
+ * The header of each file is read once, in parallel, and series are grouped, ordered and measured
+ * from the headers. When an index directory is set, headers are cached there per scanned folder and
+ * reused for files whose size and last write time are unchanged.
+ *
  * @param inputPaths Folders or DICOM files to scan.
  * @param options Discovery options.
  * @return Discovered series and scan warnings.
@@ -192,16 +223,26 @@ DiscoverResult discoverSeries(
   const DiscoverOptions& options = {});
 /**
  * @brief Load a discovered DICOM series as an Entropy image.
+ *
+ * Series of single-frame scalar slices are decoded concurrently, each slice straight into its place in
+ * the image buffer. Every slice must match the size, orientation and in-plane spacing of the first one,
+ * which defines the geometry.
+ *
  * @param series Series returned from `discoverSeries`.
  * @param imageRep Image representation to load.
  * @param bufferType Multi-component buffer mode.
- * @return Loaded image, or `std::nullopt` if loading failed.
+ * @param progress Optional callback receiving the fraction of slices decoded. Calls are serialized.
+ * @param cancel Optional flag that cancels loading when set.
+ * @return Loaded image, or `std::nullopt` if loading failed or was canceled. Callers tell a cancel from a
+ * failure by their cancel flag; a cancel is not logged as an error.
  * @throws Does not intentionally throw; load exceptions are logged and converted to `std::nullopt`.
  */
 std::optional<Image> loadSeriesImage(
   const SeriesInfo& series,
   Image::ImageRepresentation imageRep = Image::ImageRepresentation::Image,
-  Image::MultiComponentBufferType bufferType = Image::MultiComponentBufferType::SeparateImages);
+  Image::MultiComponentBufferType bufferType = Image::MultiComponentBufferType::SeparateImages,
+  const std::function<void(double)>& progress = {},
+  const std::atomic_bool* cancel = nullptr);
 
 /**
  * @brief Load downsampled grayscale previews spaced evenly along a DICOM series.
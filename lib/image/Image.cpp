@@ -2,9 +2,12 @@
 #include "internal/ImageCastHelper.tpp"
 #include "image/ImageWindowDefaults.h"
 #include "image/ImageUtility.h"
+#include "image/TimePlaybackController.h"
 #include "internal/ImageUtilityItk.h"
 #include "internal/ImageUtility.tpp"
 
+#include "common/Parallel.h"
+
 // clang-format off
 #include <spdlog/spdlog.h>
 #include <spdlog/fmt/std.h>
@@ -18,6 +21,7 @@
 #include <limits>
 #include <optional>
 #include <utility>
+#include <variant>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -150,45 +154,36 @@ bool isIntegerComponentType(ComponentType componentType)
   return false;
 }
 
-bool hasLabelLikeIntegerValues(const Image& image)
+bool hasLabelLikeIntegerValues(const Image& image, const std::vector<ComponentSummary>& summaries)
 {
   if (!isIntegerComponentType(image.header().memoryComponentType()) || 0u == image.header().numPixels()) {
     return false;
   }
 
-  constexpr std::size_t k_maxSamples = 100000;
-  constexpr std::size_t k_maxLabelValues = 64;
-  constexpr double k_maxUniqueFraction = 0.02;
+  return std::all_of(summaries.begin(), summaries.end(), [](const ComponentSummary& summary) {
+    return summary.labelLikeValues;
+  });
+}
 
-  const std::size_t numPixels = image.header().numPixels();
-  const std::size_t sampleCount = std::min(numPixels, k_maxSamples);
-  const std::size_t stride = std::max<std::size_t>(1, numPixels / sampleCount);
+/// Build component statistics from single-pass summaries, moving their T-digests into \p tdigests
+std::vector<ComponentStats>
+takeComponentStats(std::vector<ComponentSummary>& summaries, std::vector<tdigest::TDigest>& tdigests)
+{
+  std::vector<ComponentStats> componentStats(summaries.size());
+  tdigests.clear();
+  tdigests.reserve(summaries.size());
 
-  for (uint32_t component = 0; component < image.header().numComponentsPerPixel(); ++component) {
-    std::vector<double> uniqueValues;
-    uniqueValues.reserve(k_maxLabelValues + 1u);
+  for (std::size_t i = 0; i < componentStats.size(); ++i) {
+    componentStats[i].onlineStats = summaries[i].onlineStats;
 
-    for (std::size_t pixel = 0, samples = 0; pixel < numPixels && samples < sampleCount; pixel += stride, ++samples) {
-      const std::optional<double> value = image.value<double>(component, pixel);
-      if (!value) {
-        continue;
-      }
-      if (std::find(uniqueValues.begin(), uniqueValues.end(), *value) == uniqueValues.end()) {
-        uniqueValues.push_back(*value);
-        if (uniqueValues.size() > k_maxLabelValues) {
-          return false;
-        }
-      }
+    for (unsigned int q = 0; q <= 100; ++q) {
+      componentStats[i].quantiles[q] = summaries[i].tdigest.quantile(q / 100.0);
     }
 
-    const double uniqueFraction =
-      sampleCount > 0u ? static_cast<double>(uniqueValues.size()) / static_cast<double>(sampleCount) : 1.0;
-    if (uniqueValues.size() > k_maxLabelValues || uniqueFraction > k_maxUniqueFraction) {
-      return false;
-    }
+    tdigests.emplace_back(std::move(summaries[i].tdigest));
   }
 
-  return true;
+  return componentStats;
 }
 
 InterpolationMode defaultInterpolationMode(const ImageRepresentation& imageRep, bool labelLikeIntegerValues)
@@ -220,9 +215,107 @@ ImageTimeAxis timeAxisFromIoInfo(const ImageIoInfo& info)
     info.m_timeInfo.m_spacing,
     info.m_timeInfo.m_units};
 }
+
+/// Build a frame cache loader that reads single time frames of a file into buffers of type \p T
+template<typename T>
+ImageFrameCache::FrameLoader makeTypedFrameLoader(
+  const itk::ImageIOBase::Pointer& imageIo,
+  const fs::path& fileName,
+  std::size_t numFramePixels,
+  uint32_t numCompsOnDisk,
+  uint32_t componentsToLoad,
+  MultiComponentBufferType bufferType)
+{
+  return [=](uint32_t timePoint) -> std::optional<ImageFrameBuffers> {
+    SharedComponentBuffers<T> frame;
+    if (!loadImageFrameComponentBuffers(
+          imageIo,
+          fileName,
+          timePoint,
+          numFramePixels,
+          numCompsOnDisk,
+          componentsToLoad,
+          bufferType,
+          frame.mutableBuffers()))
+    {
+      return std::nullopt;
+    }
+    return ImageFrameBuffers{std::move(frame)};
+  };
+}
+
+ImageFrameCache::FrameLoader makeFrameLoader(
+  ComponentType memCompType,
+  const itk::ImageIOBase::Pointer& imageIo,
+  const fs::path& fileName,
+  std::size_t numFramePixels,
+  uint32_t numCompsOnDisk,
+  uint32_t componentsToLoad,
+  MultiComponentBufferType bufferType)
+{
+  auto makeLoader = [&]<typename T>() {
+    return makeTypedFrameLoader<T>(imageIo, fileName, numFramePixels, numCompsOnDisk, componentsToLoad, bufferType);
+  };
+
+  switch (memCompType) {
+    case ComponentType::Int8:
+      return makeLoader.template operator()<int8_t>();
+    case ComponentType::UInt8:
+      return makeLoader.template operator()<uint8_t>();
+    case ComponentType::Int16:
+      return makeLoader.template operator()<int16_t>();
+    case ComponentType::UInt16:
+      return makeLoader.template operator()<uint16_t>();
+    case ComponentType::Int32:
+      return makeLoader.template operator()<int32_t>();
+    case ComponentType::UInt32:
+      return makeLoader.template operator()<uint32_t>();
+    case ComponentType::Float32:
+      return makeLoader.template operator()<float>();
+    default:
+      return ImageFrameCache::FrameLoader{};
+  }
+}
+
+/// Build a frame cache summarizer for frames with \p numComponents components. Background frames are
+/// summarized with half of the thread budget of the constructing thread, leaving the rest for rendering.
+ImageFrameCache::FrameSummarizer
+makeFrameSummarizer(std::size_t numFramePixels, uint32_t numComponents, MultiComponentBufferType bufferType)
+{
+  const bool interleaved = (MultiComponentBufferType::InterleavedImage == bufferType);
+  const unsigned int numThreads = std::max(parallel::threadBudget() / 2, 1u);
+
+  return [=](const ImageFrameBuffers& frame) {
+    std::vector<ComponentSummary> summaries;
+    summaries.reserve(numComponents);
+
+    std::visit(
+      [&](const auto& frameBuffers) {
+        using T = typename std::decay_t<decltype(frameBuffers)>::value_type;
+        const auto& buffers = frameBuffers.buffers();
+
+        for (uint32_t c = 0; c < numComponents; ++c) {
+          const std::size_t b = interleaved ? 0 : c;
+          if (b >= buffers.size()) {
+            break;
+          }
+          const T* data = buffers[b].data() + (interleaved ? c : 0);
+          const std::size_t stride = interleaved ? numComponents : 1;
+          summaries.emplace_back(summarizeComponentValues<T>(data, numFramePixels, stride, numFramePixels, numThreads));
+        }
+      },
+      frame);
+
+    return summaries;
+  };
+}
 } // namespace
 
-Image::Image(const fs::path& fileName, const ImageRepresentation& imageRep, const MultiComponentBufferType& bufferType)
+Image::Image(
+  const fs::path& fileName,
+  const ImageRepresentation& imageRep,
+  const MultiComponentBufferType& bufferType,
+  const std::optional<ImageFrameCacheOptions>& frameStreaming)
   : m_imageRep(imageRep), m_bufferType(bufferType)
 {
   const itk::ImageIOBase::Pointer imageIo = createStandardImageIo(fileName.string().c_str());
@@ -243,12 +336,6 @@ Image::Image(const fs::path& fileName, const ImageRepresentation& imageRep, cons
   m_ioInfoInMemory = spatializedImageIoInfoForEntropy(m_ioInfoOnDisk);
   m_timeAxis = timeAxisFromIoInfo(m_ioInfoOnDisk);
 
-  const bool componentIsFloatingPoint = isComponentFloatingPoint(m_ioInfoOnDisk.m_componentInfo.m_componentType);
-
-  // Source and destination component types: Floating point images are loaded with 32-bit float
-  // components and integer images are loaded with 64-bit signed integer components.
-  const ComponentType srcCompType = componentIsFloatingPoint ? ComponentType::Float32 : ComponentType::LongLong;
-
   const ComponentType dstCompType = m_ioInfoInMemory.m_componentInfo.m_componentType;
 
   const std::size_t numPixels = m_ioInfoOnDisk.m_sizeInfo.m_imageSizeInPixels;
@@ -279,50 +366,89 @@ Image::Image(const fs::path& fileName, const ImageRepresentation& imageRep, cons
   }
 
   m_ioInfoInMemory.m_pixelInfo.m_numComponents = componentsToLoad;
+
+  // Pixels are read in their on-disk component type directly into the final buffers of the
+  // in-memory component type, without an intermediate widened copy of the image
+  const std::size_t numElementsToLoad = numPixels * componentsToLoad;
+  const ComponentType memCompType = (ImageRepresentation::Segmentation == m_imageRep)
+                                      ? resolveSegMemoryComponentType(dstCompType, numElementsToLoad)
+                                      : resolveImageMemoryComponentType(dstCompType, numElementsToLoad);
+
   m_ioInfoInMemory.m_pixelInfo.m_pixelStrideInBytes =
     componentsToLoad * m_ioInfoInMemory.m_componentInfo.m_componentSizeInBytes;
 
-  std::function<bool(const void* buffer, std::size_t numElements)> loadBufferFn = nullptr;
+  // Time frames of a 4D image are streamed when requested and the file format can read single frames.
+  // Segmentations are always fully loaded, since they are edited in place.
+  const uint32_t numTimePoints = m_timeAxis.numTimePoints();
+  const bool streamFrames = frameStreaming && numTimePoints > 1 && ImageRepresentation::Image == m_imageRep &&
+                            canLoadImageFrames(*imageIo);
 
-  switch (m_imageRep) {
-    case ImageRepresentation::Image: {
-      loadBufferFn = [this, &srcCompType, &dstCompType](const void* buffer, std::size_t numElements) {
-        return loadImageBuffer(buffer, numElements, srcCompType, dstCompType);
-      };
-      break;
-    }
-    case ImageRepresentation::Segmentation: {
-      loadBufferFn = [this, &srcCompType, &dstCompType](const void* buffer, std::size_t numElements) {
-        return loadSegBuffer(buffer, numElements, srcCompType, dstCompType);
-      };
-      break;
-    }
+  if (frameStreaming && numTimePoints > 1 && !streamFrames) {
+    spdlog::info("Loading all {} time points of image {}, since they cannot be streamed", numTimePoints, fileName);
   }
 
-  bool loaded = false;
-  if (componentIsFloatingPoint) {
-    // Read image with floating point components from disk to an ITK image with 32-bit float point
-    // pixel components
-    loaded = loadImage<float>(
-      fileName,
-      m_ioInfoOnDisk.m_spaceInfo.m_numDimensions,
-      numPixels,
-      componentsToLoad,
-      isMultiComponentImage,
-      m_bufferType,
-      loadBufferFn);
+  if (streamFrames) {
+    const std::size_t numFramePixels = numPixels / numTimePoints;
+    const std::size_t frameSizeInBytes = numFramePixels * m_ioInfoInMemory.m_pixelInfo.m_pixelStrideInBytes;
+
+    ImageFrameCache::FrameLoader loader =
+      makeFrameLoader(memCompType, imageIo, fileName, numFramePixels, numCompsOnDisk, componentsToLoad, m_bufferType);
+
+    if (!loader) {
+      spdlog::error("Unsupported in-memory component type for image from file {}", fileName);
+      throwDebug("Error loading image");
+    }
+
+    spdlog::info("Streaming {} time points of image {} through a frame cache", numTimePoints, fileName);
+
+    m_frameCache = std::make_shared<ImageFrameCache>(
+      numTimePoints,
+      frameSizeInBytes,
+      std::move(loader),
+      makeFrameSummarizer(numFramePixels, componentsToLoad, m_bufferType),
+      *frameStreaming);
   }
-  else {
-    // Read image with integer components from disk to an ITK image with 64-bit signed integer pixel
-    // components
-    loaded = loadImage<int64_t>(
+
+  auto loadBuffers = [&](auto& buffers) {
+    return loadImageComponentBuffers(
+      imageIo,
       fileName,
-      m_ioInfoOnDisk.m_spaceInfo.m_numDimensions,
       numPixels,
+      numCompsOnDisk,
       componentsToLoad,
-      isMultiComponentImage,
       m_bufferType,
-      loadBufferFn);
+      buffers);
+  };
+
+  // The first frame of a streamed image is made resident once the header is set
+  bool loaded = static_cast<bool>(m_frameCache);
+  if (!m_frameCache) {
+    switch (memCompType) {
+      case ComponentType::Int8:
+        loaded = loadBuffers(m_data_int8.mutableBuffers());
+        break;
+      case ComponentType::UInt8:
+        loaded = loadBuffers(m_data_uint8.mutableBuffers());
+        break;
+      case ComponentType::Int16:
+        loaded = loadBuffers(m_data_int16.mutableBuffers());
+        break;
+      case ComponentType::UInt16:
+        loaded = loadBuffers(m_data_uint16.mutableBuffers());
+        break;
+      case ComponentType::Int32:
+        loaded = loadBuffers(m_data_int32.mutableBuffers());
+        break;
+      case ComponentType::UInt32:
+        loaded = loadBuffers(m_data_uint32.mutableBuffers());
+        break;
+      case ComponentType::Float32:
+        loaded = loadBuffers(m_data_float32.mutableBuffers());
+        break;
+      default:
+        spdlog::error("Unsupported in-memory component type for image from file {}", fileName);
+        break;
+    }
   }
 
   if (!loaded) {
@@ -335,19 +461,23 @@ Image::Image(const fs::path& fileName, const ImageRepresentation& imageRep, cons
     ImageHeaderOverrides(m_header.pixelDimensions(), m_header.spacing(), m_header.origin(), m_header.directions());
   m_tx = ImageTransformations(m_header.pixelDimensions(), m_header.spacing(), m_header.origin(), m_header.directions());
 
-  std::vector<OnlineStats> onlineStats = computeImageStatisticsOnUnsortedValues(*this);
-  m_tdigests = computeTDigests(*this);
-
-  std::vector<ComponentStats> componentStats(onlineStats.size());
-
-  for (std::size_t i = 0; i < componentStats.size(); ++i) {
-    componentStats[i].onlineStats = onlineStats[i];
-
-    for (unsigned int q = 0; q <= 100; ++q) {
-      componentStats[i].quantiles[q] = m_tdigests[i].quantile(q / 100.0);
+  std::vector<ComponentSummary> summaries;
+  if (m_frameCache) {
+    // Statistics start from the first frame and are updated as the frame cache summarizes more frames
+    if (!setResidentTimePoint(0)) {
+      throwDebug("Error loading image");
     }
+    const ImageFrameSummaries frameSummaries = m_frameCache->summaries();
+    summaries = frameSummaries.components;
+    m_numSummarizedFrames = frameSummaries.numFrames;
+  }
+  else {
+    summaries = computeImageComponentSummaries(*this);
   }
 
+  const bool labelLikeValues = hasLabelLikeIntegerValues(*this, summaries);
+  std::vector<ComponentStats> componentStats = takeComponentStats(summaries, m_tdigests);
+
   m_settings = ImageSettings(
     getFileName(fileName.string(), false),
     m_header.numPixels(),
@@ -356,7 +486,7 @@ Image::Image(const fs::path& fileName, const ImageRepresentation& imageRep, cons
     componentStats);
   setDefaultComponentRendering(m_settings, m_header, m_imageRep, componentStats);
   setDefaultVectorFieldRendering(m_settings, m_header);
-  setDefaultInterpolationModes(m_settings, m_imageRep, hasLabelLikeIntegerValues(*this));
+  setDefaultInterpolationModes(m_settings, m_imageRep, labelLikeValues);
 
   m_loadState = LoadState::LoadedPixels;
 }
@@ -387,7 +517,8 @@ Image::Image(
     componentStats);
   setDefaultComponentRendering(m_settings, m_header, m_imageRep, componentStats);
   setDefaultVectorFieldRendering(m_settings, m_header);
-  setDefaultInterpolationModes(m_settings, m_imageRep, hasLabelLikeIntegerValues(*this));
+  // With no pixels to sample, nothing contradicts label-like integer values
+  setDefaultInterpolationModes(m_settings, m_imageRep, hasLabelLikeIntegerValues(*this, {}));
 }
 
 Image::Image(
@@ -563,18 +694,9 @@ Image::Image(
   m_headerOverrides =
     ImageHeaderOverrides(m_header.pixelDimensions(), m_header.spacing(), m_header.origin(), m_header.directions());
 
-  std::vector<OnlineStats> onlineStats = computeImageStatisticsOnUnsortedValues(*this);
-  m_tdigests = computeTDigests(*this);
-
-  std::vector<ComponentStats> componentStats(onlineStats.size());
-
-  for (std::size_t i = 0; i < componentStats.size(); ++i) {
-    componentStats[i].onlineStats = onlineStats[i];
-
-    for (unsigned int q = 0; q <= 100; ++q) {
-      componentStats[i].quantiles[q] = m_tdigests[i].quantile(q / 100.0);
-    }
-  }
+  std::vector<ComponentSummary> summaries = computeImageComponentSummaries(*this);
+  const bool labelLikeValues = hasLabelLikeIntegerValues(*this, summaries);
+  std::vector<ComponentStats> componentStats = takeComponentStats(summaries, m_tdigests);
 
   m_settings = ImageSettings(
     displayName,
@@ -584,7 +706,7 @@ Image::Image(
     componentStats);
   setDefaultComponentRendering(m_settings, m_header, m_imageRep, componentStats);
   setDefaultVectorFieldRendering(m_settings, m_header);
-  setDefaultInterpolationModes(m_settings, m_imageRep, hasLabelLikeIntegerValues(*this));
+  setDefaultInterpolationModes(m_settings, m_imageRep, labelLikeValues);
 
   m_loadState = LoadState::LoadedPixels;
 }
@@ -656,6 +778,110 @@ const ImageTimeAxis& Image::timeAxis() const
   return m_timeAxis;
 }
 
+bool Image::streamsTimePoints() const
+{
+  return static_cast<bool>(m_frameCache);
+}
+
+uint32_t Image::numBufferedTimePoints() const
+{
+  return m_frameCache ? 1u : m_timeAxis.numTimePoints();
+}
+
+bool Image::isTimePointResident(uint32_t timePoint) const
+{
+  return bufferFrame(timePoint).has_value();
+}
+
+bool Image::setResidentTimePoint(uint32_t timePoint)
+{
+  if (!m_frameCache) {
+    return timePoint < m_timeAxis.numTimePoints();
+  }
+
+  if (hasResidentFrame(timePoint)) {
+    return true;
+  }
+
+  const std::optional<ImageFrameBuffers> frame = m_frameCache->frame(timePoint);
+  if (!frame) {
+    spdlog::error("Could not make time point {} of image {} resident", timePoint, m_header.fileName());
+    return false;
+  }
+
+  makeFrameResident(timePoint, *frame);
+  return true;
+}
+
+bool Image::requestResidentTimePoint(uint32_t timePoint)
+{
+  if (!m_frameCache) {
+    return timePoint < m_timeAxis.numTimePoints();
+  }
+
+  if (hasResidentFrame(timePoint)) {
+    return true;
+  }
+
+  const std::optional<ImageFrameBuffers> frame = m_frameCache->requestFrame(timePoint);
+  if (!frame) {
+    // The worker does not retry failed reads, so retry here rather than wait for it forever
+    return m_frameCache->readFailed(timePoint) && setResidentTimePoint(timePoint);
+  }
+
+  makeFrameResident(timePoint, *frame);
+  return true;
+}
+
+bool Image::timePointReadFailed(uint32_t timePoint) const
+{
+  return m_frameCache && m_frameCache->readFailed(timePoint);
+}
+
+bool Image::hasResidentFrame(uint32_t timePoint) const
+{
+  const bool hasFrame =
+    dispatchMemoryComponentType([this]<typename T>() { return !componentBuffers<T>().empty(); });
+  return hasFrame && timePoint == m_residentTimePoint;
+}
+
+void Image::makeFrameResident(uint32_t timePoint, const ImageFrameBuffers& frame)
+{
+  std::visit(
+    [this](const auto& frameBuffers) {
+      using T = typename std::decay_t<decltype(frameBuffers)>::value_type;
+      componentBuffers<T>() = frameBuffers;
+    },
+    frame);
+
+  const int direction = readAheadDirection(m_residentTimePoint, timePoint, m_timeAxis.numTimePoints());
+  m_residentTimePoint = timePoint;
+  m_frameCache->readAhead(timePoint, direction);
+}
+
+bool Image::updateStreamedComponentStats()
+{
+  if (!m_frameCache) {
+    return false;
+  }
+
+  ImageFrameSummaries frameSummaries = m_frameCache->summaries();
+  if (frameSummaries.numFrames <= m_numSummarizedFrames) {
+    return false;
+  }
+
+  spdlog::debug(
+    "Updating statistics of image {} with {} of {} summarized time points",
+    m_header.fileName(),
+    frameSummaries.numFrames,
+    m_timeAxis.numTimePoints());
+
+  m_numSummarizedFrames = frameSummaries.numFrames;
+  std::vector<ComponentStats> componentStats = takeComponentStats(frameSummaries.components, m_tdigests);
+  m_settings.updateWithNewComponentStatistics(std::move(componentStats), false);
+  return true;
+}
+
 const ImageTransformations& Image::transformations() const
 {
   return m_tx;
@@ -754,26 +980,23 @@ std::ostream& Image::metaData(std::ostream& os) const
 
 void Image::updateComponentStats()
 {
-  std::vector<OnlineStats> onlineStats = computeImageStatisticsOnUnsortedValues(*this);
-  m_tdigests = computeTDigests(*this);
-
-  std::vector<ComponentStats> componentStats(onlineStats.size());
-
-  for (std::size_t i = 0; i < componentStats.size(); ++i) {
-    componentStats[i].onlineStats = onlineStats[i];
-
-    for (unsigned int q = 0; q <= 100; ++q) {
-      componentStats[i].quantiles[q] = m_tdigests[i].quantile(q / 100.0);
-    }
+  if (m_frameCache) {
+    // Statistics of a streamed image come from the frames summarized by its frame cache
+    m_numSummarizedFrames = 0;
+    updateStreamedComponentStats();
+    return;
   }
 
+  std::vector<ComponentSummary> summaries = computeImageComponentSummaries(*this);
+  std::vector<ComponentStats> componentStats = takeComponentStats(summaries, m_tdigests);
+
   m_settings.updateWithNewComponentStatistics(std::move(componentStats), false);
 }
 
-/// @todo Put this back when using sorted buffers for stats
-// if (!generateSortedBuffers()) {
-//   spdlog::error("Error generating sorted image component buffers");
-//   throwDebug("Error generating sorted image component buffers")
+/// @todo Put this back when using the exact quantile index for stats
+// if (!generateQuantileIndex()) {
+//   spdlog::error("Error generating image component quantile index");
+//   throwDebug("Error generating image component quantile index")
 // }
 // m_settings.setUsingExactQuantiles(true);
-// std::vector<ComponentStats> componentStats = computeImageStatisticsOnSortedValues(*this);
+// std::vector<ComponentStats> componentStats = computeImageStatisticsOnQuantileIndex(*this);
@@ -2,22 +2,29 @@
 
 #include "common/Types.h"
 
+#include "image/ImageFrameCache.h"
 #include "image/ImageHeader.h"
 #include "image/ImageHeaderOverrides.h"
 #include "image/ImageIoInfo.h"
 #include "image/ImageSettings.h"
 #include "image/ImageTimeAxis.h"
 #include "image/ImageTransformations.h"
+#include "image/ImageQuantileIndex.h"
 #include "image/ImageTypes.h"
+#include "image/ImageView.h"
+#include "image/SharedComponentBuffers.h"
 #include "image/external/TDigest.h"
 
 #include <glm/glm.hpp>
 
 #include <algorithm>
+#include <array>
 #include <filesystem>
+#include <memory>
 #include <optional>
 #include <ostream>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -47,11 +54,15 @@ public:
    * @param[in] imageRep Indicates whether this is an image or a segmentation
    * @param[in] bufferType Indicates whether multi-component images are loaded as
    * multiple buffers or as a single buffer with interleaved pixel components
+   * @param[in] frameStreaming When set, the time frames of a 4D image are read on demand through a
+   * bounded frame cache instead of all being loaded up front. Ignored for 3D images and for files
+   * whose format cannot read single frames.
    */
   Image(
     const std::filesystem::path& fileName,
     const ImageRepresentation& imageRep,
-    const MultiComponentBufferType& bufferType);
+    const MultiComponentBufferType& bufferType,
+    const std::optional<ImageFrameCacheOptions>& frameStreaming = std::nullopt);
 
   /**
    * @brief Construct a header-only image record without loading pixel data.
@@ -106,6 +117,14 @@ public:
   /// @brief Return true when this image owns pixel buffers that can be sampled or saved.
   bool hasPixelData() const;
 
+  /**
+   * @brief Return true when this image and \p other share the same pixel buffers.
+   *
+   * Copies of an image share pixel buffers until either copy writes to them through setValue(),
+   * setAllValues(), or a non-const buffer accessor.
+   */
+  bool sharesPixelDataWith(const Image& other) const;
+
   /**
    * @brief Recompute the settings that this image would have immediately after loading.
    *
@@ -114,9 +133,9 @@ public:
    */
   ImageSettings defaultSettings() const;
 
-  /// @brief Build sorted per-component buffers used by quantile and histogram queries.
-  /// @return True when sorted buffers were generated for the image's memory component type.
-  bool generateSortedBuffers();
+  /// @brief Build the per-component exact quantile index used when exact quantiles are enabled.
+  /// @return True when the index was generated for the image's memory component type.
+  bool generateQuantileIndex();
 
   /// @brief Return whether this object is interpreted as an intensity image or segmentation.
   const ImageRepresentation& imageRep() const;
@@ -141,15 +160,100 @@ public:
   void* bufferAsVoid(uint32_t component, uint32_t timePoint = 0);
 
   /**
-   * @brief Get a const void pointer to the sorted buffer data of an image component.
+   * @brief Get the exact quantile index of an image component.
    * @param[in] component Image component to get
+   * @return The index, or nullptr when the index has not been generated or the component is invalid
    * @note Ignores the \c MultiComponentBufferType setting, so that the
    * component must be in the range [0, header().numComponentsPerPixel() - 1]
    */
-  const void* bufferSortedAsVoid(uint32_t component) const;
+  const ImageQuantileIndex* quantileIndex(uint32_t component) const;
 
-  /// @brief Get a non-const void pointer to the sorted buffer data of an image component.
-  void* bufferSortedAsVoid(uint32_t component);
+  /**
+   * @brief Get a typed read-only view of one component of one time frame.
+   * @tparam T Component type. Must be the type of header().memoryComponentType().
+   * @return The view, or std::nullopt when the type, component or time point is invalid.
+   *
+   * The view reads pixels without per-voxel type dispatch or bounds checks. Prefer
+   * visitComponentView() when the memory component type is not known at compile time.
+   */
+  template<typename T>
+  std::optional<ImageView<const T>> view(uint32_t component, uint32_t timePoint = 0) const
+  {
+    return makeView<const T>(componentBuffers<T>().buffers(), component, timePoint);
+  }
+
+  /**
+   * @brief Get a typed mutable view of one component of one time frame.
+   *
+   * Detaches the pixel buffers from other copies of this image first. The view must not be held
+   * across copies of the image.
+   * @see view()
+   */
+  template<typename T>
+  std::optional<ImageView<T>> mutableView(uint32_t component, uint32_t timePoint = 0)
+  {
+    // Validate against the shared buffers before detaching them
+    if (!view<T>(component, timePoint)) {
+      return std::nullopt;
+    }
+    return makeView<T>(componentBuffers<T>().mutableBuffers(), component, timePoint);
+  }
+
+  /**
+   * @brief Call a visitor with a typed read-only view of one component of one time frame.
+   *
+   * The memory component type is resolved once, so loops in the visitor run without per-voxel
+   * dispatch.
+   * @param visitor Generic callable taking an ImageView<const T> for the memory component type.
+   * @return True when the view was created and the visitor was called.
+   */
+  template<typename Visitor>
+  bool visitComponentView(uint32_t component, uint32_t timePoint, Visitor&& visitor) const
+  {
+    return dispatchMemoryComponentType([&]<typename T>() {
+      const auto componentView = view<T>(component, timePoint);
+      if (componentView) {
+        visitor(*componentView);
+      }
+      return componentView.has_value();
+    });
+  }
+
+  /// @brief Call a visitor with a typed mutable view of one component of one time frame.
+  /// @see visitComponentView(), mutableView()
+  template<typename Visitor>
+  bool visitMutableComponentView(uint32_t component, uint32_t timePoint, Visitor&& visitor)
+  {
+    return dispatchMemoryComponentType([&]<typename T>() {
+      const auto componentView = mutableView<T>(component, timePoint);
+      if (componentView) {
+        visitor(*componentView);
+      }
+      return componentView.has_value();
+    });
+  }
+
+  /**
+   * @brief Call a visitor with typed read-only views of the first \p N components of one time frame.
+   * @param visitor Generic callable taking a const std::array<ImageView<const T>, N>&.
+   * @return True when all views were created and the visitor was called.
+   */
+  template<std::size_t N, typename Visitor>
+  bool visitComponentViews(uint32_t timePoint, Visitor&& visitor) const
+  {
+    return dispatchMemoryComponentType([&]<typename T>() {
+      std::array<ImageView<const T>, N> views;
+      for (std::size_t c = 0; c < N; ++c) {
+        const auto componentView = view<T>(static_cast<uint32_t>(c), timePoint);
+        if (!componentView) {
+          return false;
+        }
+        views[c] = *componentView;
+      }
+      visitor(std::as_const(views));
+      return true;
+    });
+  }
 
   /**
    * @brief Get a component value at a linear pixel index.
@@ -235,116 +339,13 @@ public:
   template<typename T>
   std::optional<T> valueLinear(uint32_t comp, double i, double j, double k, uint32_t timePoint = 0) const
   {
-    const glm::dvec3 ZERO{0.0};
-    const glm::dvec3 ONE{1.0};
-    const glm::u64vec3& dims = m_header.pixelDimensions();
+    std::optional<double> sample;
+    visitComponentView(comp, timePoint, [&](const auto& componentView) { sample = componentView.linear(i, j, k); });
 
-    if (i < -0.5 || j < -0.5 || k < -0.5 || i > dims.x - 0.5 || j > dims.y - 0.5 || k > dims.z - 0.5) {
+    if (!sample) {
       return std::nullopt;
     }
-
-    // Valid image coordinates are [-0.5, N-0.5]. However, we clamp coordinates to the edge samples,
-    // which are at 0 and N - 1:
-    const glm::dvec3 coordClamped = glm::clamp(glm::dvec3{i, j, k}, ZERO, glm::dvec3{dims} - ONE);
-    const glm::i64vec3 f = glm::i64vec3{glm::floor(coordClamped)};
-
-    // Get values of all 8 neighboring pixels. If a pixel outside the image is requested,
-    // then its sampling location was outside the image and its returned value is std::none
-    const int fx = static_cast<int>(f.x);
-    const int fy = static_cast<int>(f.y);
-    const int fz = static_cast<int>(f.z);
-
-    const auto c000 = value<double>(comp, fx + 0, fy + 0, fz + 0, timePoint);
-    const auto c001 = value<double>(comp, fx + 0, fy + 0, fz + 1, timePoint);
-    const auto c010 = value<double>(comp, fx + 0, fy + 1, fz + 0, timePoint);
-    const auto c011 = value<double>(comp, fx + 0, fy + 1, fz + 1, timePoint);
-    const auto c100 = value<double>(comp, fx + 1, fy + 0, fz + 0, timePoint);
-    const auto c101 = value<double>(comp, fx + 1, fy + 0, fz + 1, timePoint);
-    const auto c110 = value<double>(comp, fx + 1, fy + 1, fz + 0, timePoint);
-    const auto c111 = value<double>(comp, fx + 1, fy + 1, fz + 1, timePoint);
-
-    const glm::dvec3 diff = coordClamped - glm::floor(coordClamped);
-
-    // Interpolate along x, ignoring invalid samples:
-    std::optional<double> c00, c01, c10, c11;
-
-    if (c000 && c100) {
-      c00 = c000.value() * (1.0 - diff.x) + c100.value() * diff.x;
-    }
-    else if (c000) {
-      c00 = c000.value();
-    }
-    else if (c100) {
-      c00 = c100.value();
-    }
-
-    if (c001 && c101) {
-      c01 = c001.value() * (1.0 - diff.x) + c101.value() * diff.x;
-    }
-    else if (c001) {
-      c01 = c001.value();
-    }
-    else if (c101) {
-      c01 = c101.value();
-    }
-
-    if (c010 && c110) {
-      c10 = c010.value() * (1.0 - diff.x) + c110.value() * diff.x;
-    }
-    else if (c010) {
-      c10 = c010.value();
-    }
-    else if (c110) {
-      c10 = c110.value();
-    }
-
-    if (c011 && c111) {
-      c11 = c011.value() * (1.0 - diff.x) + c111.value() * diff.x;
-    }
-    else if (c011) {
-      c11 = c011.value();
-    }
-    else if (c111) {
-      c11 = c111.value();
-    }
-
-    // Interpolate along y, ignoring invalid samples:
-    std::optional<double> c0, c1;
-
-    if (c00 && c10) {
-      c0 = c00.value() * (1.0 - diff.y) + c10.value() * diff.y;
-    }
-    else if (c00) {
-      c0 = c00.value();
-    }
-    else if (c10) {
-      c0 = c10.value();
-    }
-
-    if (c01 && c11) {
-      c1 = c01.value() * (1.0 - diff.y) + c11.value() * diff.y;
-    }
-    else if (c01) {
-      c1 = c01.value();
-    }
-    else if (c11) {
-      c1 = c11.value();
-    }
-
-    // Interpolate along z, ignoring invalid samples:
-    std::optional<double> c;
-
-    if (c0 && c1) {
-      c = c0.value() * (1.0 - diff.z) + c1.value() * diff.z;
-    }
-    else if (c0) {
-      c = c0.value();
-    }
-    else if (c1) {
-      c = c1.value();
-    }
-
-    return c;
+    return static_cast<T>(*sample);
   }
 
   /**
@@ -374,31 +375,31 @@ public:
 
     switch (m_header.memoryComponentType()) {
       case ComponentType::Int8: {
-        m_data_int8.at(c)[offset] = static_cast<int8_t>(value);
+        m_data_int8.mutableAt(c)[offset] = static_cast<int8_t>(value);
         return true;
       }
       case ComponentType::UInt8: {
-        m_data_uint8.at(c)[offset] = static_cast<uint8_t>(value);
+        m_data_uint8.mutableAt(c)[offset] = static_cast<uint8_t>(value);
         return true;
       }
       case ComponentType::Int16: {
-        m_data_int16.at(c)[offset] = static_cast<int16_t>(value);
+        m_data_int16.mutableAt(c)[offset] = static_cast<int16_t>(value);
         return true;
       }
       case ComponentType::UInt16: {
-        m_data_uint16.at(c)[offset] = static_cast<uint16_t>(value);
+        m_data_uint16.mutableAt(c)[offset] = static_cast<uint16_t>(value);
         return true;
       }
       case ComponentType::Int32: {
-        m_data_int32.at(c)[offset] = static_cast<int32_t>(value);
+        m_data_int32.mutableAt(c)[offset] = static_cast<int32_t>(value);
         return true;
       }
       case ComponentType::UInt32: {
-        m_data_uint32.at(c)[offset] = static_cast<uint32_t>(value);
+        m_data_uint32.mutableAt(c)[offset] = static_cast<uint32_t>(value);
         return true;
       }
       case ComponentType::Float32: {
-        m_data_float32.at(c)[offset] = static_cast<float>(value);
+        m_data_float32.mutableAt(c)[offset] = static_cast<float>(value);
         return true;
       }
       default:
@@ -413,43 +414,43 @@ public:
   {
     switch (m_header.memoryComponentType()) {
       case ComponentType::Int8: {
-        for (auto& C : m_data_int8) {
+        for (auto& C : m_data_int8.mutableBuffers()) {
           std::fill(std::begin(C), std::end(C), static_cast<int8_t>(v));
         }
         return;
       }
       case ComponentType::UInt8: {
-        for (auto& C : m_data_uint8) {
+        for (auto& C : m_data_uint8.mutableBuffers()) {
           std::fill(std::begin(C), std::end(C), static_cast<uint8_t>(v));
         }
         return;
       }
       case ComponentType::Int16: {
-        for (auto& C : m_data_int16) {
+        for (auto& C : m_data_int16.mutableBuffers()) {
           std::fill(std::begin(C), std::end(C), static_cast<int16_t>(v));
         }
         return;
       }
       case ComponentType::UInt16: {
-        for (auto& C : m_data_uint16) {
+        for (auto& C : m_data_uint16.mutableBuffers()) {
           std::fill(std::begin(C), std::end(C), static_cast<uint16_t>(v));
         }
         return;
       }
       case ComponentType::Int32: {
-        for (auto& C : m_data_int32) {
+        for (auto& C : m_data_int32.mutableBuffers()) {
           std::fill(std::begin(C), std::end(C), static_cast<int32_t>(v));
         }
         return;
       }
       case ComponentType::UInt32: {
-        for (auto& C : m_data_uint32) {
+        for (auto& C : m_data_uint32.mutableBuffers()) {
           std::fill(std::begin(C), std::end(C), static_cast<uint32_t>(v));
         }
         return;
       }
       case ComponentType::Float32: {
-        for (auto& C : m_data_float32) {
+        for (auto& C : m_data_float32.mutableBuffers()) {
           std::fill(std::begin(C), std::end(C), static_cast<float>(v));
         }
         return;
@@ -513,6 +514,50 @@ public:
   /// @brief Get time-axis metadata.
   const ImageTimeAxis& timeAxis() const;
 
+  /// @brief Return true when the time frames of this image are read on demand and only the resident
+  /// frame is held in the pixel buffers.
+  bool streamsTimePoints() const;
+
+  /// @brief Number of time frames held in the pixel buffers: 1 when streaming, otherwise all frames.
+  uint32_t numBufferedTimePoints() const;
+
+  /// @brief Return true when pixel values of a time point can be read from the pixel buffers.
+  bool isTimePointResident(uint32_t timePoint) const;
+
+  /**
+   * @brief Make a time point the resident frame of a streamed image.
+   *
+   * Blocks until the frame is read, then asks the frame cache to read the following frames ahead in
+   * the direction of travel from the previous resident frame. Edits to the resident frame are not kept
+   * once another frame is made resident. Does nothing for images that are not streamed.
+   *
+   * @return True when the time point is resident.
+   */
+  bool setResidentTimePoint(uint32_t timePoint);
+
+  /**
+   * @brief Make a time point the resident frame of a streamed image if its frame is cached.
+   *
+   * Does not block: when the frame is not cached, asks the frame cache worker to read it and keeps the
+   * current resident frame. Call again once the read finishes to make the frame resident. When the
+   * worker's read failed, retries it with a blocking read instead.
+   *
+   * @return True when the time point is resident.
+   * @see setResidentTimePoint, timePointReadFailed
+   */
+  bool requestResidentTimePoint(uint32_t timePoint);
+
+  /// @brief Return true when the last read of a streamed time point failed, so that requesting it
+  /// again will not make it resident without another blocking read. False for other images.
+  bool timePointReadFailed(uint32_t timePoint) const;
+
+  /**
+   * @brief Update component statistics with the frames that the frame cache summarized since the
+   * last update. Statistics of a streamed image cover progressively more of the time series.
+   * @return True when the statistics changed.
+   */
+  bool updateStreamedComponentStats();
+
   /// @brief Get read-only access to affine and display transformations associated with the image.
   const ImageTransformations& transformations() const;
 
@@ -533,6 +578,21 @@ public:
   void updateComponentStats();
 
 private:
+  /**
+   * @brief Get the in-memory component type used for an intensity image with a given source type.
+   *
+   * Component types that Entropy does not hold in memory are narrowed. Any narrowing is recorded in
+   * the in-memory IO info and logged.
+   * @param[in] dstComponentType Component type requested for the image.
+   * @param[in] numElements Number of component values that will be stored.
+   * @return In-memory component type, or ComponentType::Undefined for an unknown type.
+   */
+  ComponentType resolveImageMemoryComponentType(ComponentType dstComponentType, std::size_t numElements);
+
+  /// @brief Get the unsigned in-memory component type used for a segmentation with a given source type.
+  /// @see resolveImageMemoryComponentType
+  ComponentType resolveSegMemoryComponentType(ComponentType dstComponentType, std::size_t numElements);
+
   /// @brief Load and optionally cast a buffer as an intensity-image component.
   bool loadImageBuffer(
     const void* buffer,
@@ -547,6 +607,100 @@ private:
     ComponentType srcComponentType,
     ComponentType dstComponentType);
 
+  /// @brief Return true when a streamed image holds the frame of a time point in its pixel buffers.
+  bool hasResidentFrame(uint32_t timePoint) const;
+
+  /// @brief Hold a frame read by the frame cache in the pixel buffers and read ahead from it.
+  void makeFrameResident(uint32_t timePoint, const ImageFrameBuffers& frame);
+
+  /// @brief Get the shared buffers that hold components of type \p T.
+  template<typename T>
+  const SharedComponentBuffers<T>& componentBuffers() const
+  {
+    if constexpr (std::is_same_v<T, int8_t>) {
+      return m_data_int8;
+    }
+    else if constexpr (std::is_same_v<T, uint8_t>) {
+      return m_data_uint8;
+    }
+    else if constexpr (std::is_same_v<T, int16_t>) {
+      return m_data_int16;
+    }
+    else if constexpr (std::is_same_v<T, uint16_t>) {
+      return m_data_uint16;
+    }
+    else if constexpr (std::is_same_v<T, int32_t>) {
+      return m_data_int32;
+    }
+    else if constexpr (std::is_same_v<T, uint32_t>) {
+      return m_data_uint32;
+    }
+    else {
+      static_assert(std::is_same_v<T, float>, "Unsupported image memory component type");
+      return m_data_float32;
+    }
+  }
+
+  template<typename T>
+  SharedComponentBuffers<T>& componentBuffers()
+  {
+    return const_cast<SharedComponentBuffers<T>&>(std::as_const(*this).template componentBuffers<T>());
+  }
+
+  /// @brief Make a view of one component frame of \p buffers, or std::nullopt when the buffers do
+  /// not hold that frame (including when they are not the buffers of the memory component type).
+  template<typename T, typename Buffers>
+  std::optional<ImageView<T>> makeView(Buffers& buffers, uint32_t component, uint32_t timePoint) const
+  {
+    const std::size_t numPixels = m_header.numPixels();
+    const auto compAndOffset = getComponentAndOffsetForBuffer(component, 0, timePoint);
+    if (!compAndOffset || 0 == numPixels) {
+      return std::nullopt;
+    }
+
+    const auto [c, offset] = *compAndOffset;
+    const std::size_t stride =
+      (MultiComponentBufferType::InterleavedImage == m_bufferType) ? m_header.numComponentsPerPixel() : 1;
+
+    if (c >= buffers.size() || offset + (numPixels - 1) * stride >= buffers[c].size()) {
+      return std::nullopt;
+    }
+
+    return ImageView<T>(buffers[c].data() + offset, m_header.pixelDimensions(), stride);
+  }
+
+  /// @brief Call fn.template operator()<T>() for the memory component type T.
+  /// @return The result of \p fn, or false for an unsupported memory component type.
+  template<typename Fn>
+  bool dispatchMemoryComponentType(Fn&& fn) const
+  {
+    switch (m_header.memoryComponentType()) {
+      case ComponentType::Int8:
+        return fn.template operator()<int8_t>();
+      case ComponentType::UInt8:
+        return fn.template operator()<uint8_t>();
+      case ComponentType::Int16:
+        return fn.template operator()<int16_t>();
+      case ComponentType::UInt16:
+        return fn.template operator()<uint16_t>();
+      case ComponentType::Int32:
+        return fn.template operator()<int32_t>();
+      case ComponentType::UInt32:
+        return fn.template operator()<uint32_t>();
+      case ComponentType::Float32:
+        return fn.template operator()<float>();
+      default:
+        return false;
+    }
+  }
+
+  /// @brief Get the frame of the pixel buffers that holds a time point, or std::nullopt when a
+  /// streamed image does not hold that time point.
+  std::optional<uint32_t> bufferFrame(uint32_t timePoint) const;
+
+  /// @brief Get the exact quantile index of a component, throwing when it has not been generated.
+  const ImageQuantileIndex& exactQuantileIndex(uint32_t comp) const;
+
   /// @brief Map a logical component and 3D pixel index to an owned buffer index and element offset.
   std::optional<std::pair<std::size_t, std::size_t>> getComponentAndOffsetForBuffer(uint32_t comp, int i, int j, int k)
     const;
@@ -557,24 +711,19 @@ private:
 
   /// Pixel buffers grouped by component type. For separated layout, the outer vector has one entry
   /// per logical component. For interleaved layout, the outer vector has one entry and stores all
-  /// logical components in pixel-major order
-  std::vector<std::vector<int8_t>> m_data_int8;
-  std::vector<std::vector<uint8_t>> m_data_uint8;
-  std::vector<std::vector<int16_t>> m_data_int16;
-  std::vector<std::vector<uint16_t>> m_data_uint16;
-  std::vector<std::vector<int32_t>> m_data_int32;
-  std::vector<std::vector<uint32_t>> m_data_uint32;
-  std::vector<std::vector<float>> m_data_float32;
-
-  /// @note These vectors separate out interleaved pixels into separate vectors for multi-component
-  /// images (regardless of m_bufferType)
-  std::vector<std::vector<int8_t>> m_dataSorted_int8;
-  std::vector<std::vector<uint8_t>> m_dataSorted_uint8;
-  std::vector<std::vector<int16_t>> m_dataSorted_int16;
-  std::vector<std::vector<uint16_t>> m_dataSorted_uint16;
-  std::vector<std::vector<int32_t>> m_dataSorted_int32;
-  std::vector<std::vector<uint32_t>> m_dataSorted_uint32;
-  std::vector<std::vector<float>> m_dataSorted_float32;
+  /// logical components in pixel-major order. Buffers are shared copy-on-write between copies of
+  /// the image, so copying an Image does not copy pixels until one of the copies writes
+  SharedComponentBuffers<int8_t> m_data_int8;
+  SharedComponentBuffers<uint8_t> m_data_uint8;
+  SharedComponentBuffers<int16_t> m_data_int16;
+  SharedComponentBuffers<uint16_t> m_data_uint16;
+  SharedComponentBuffers<int32_t> m_data_int32;
+  SharedComponentBuffers<uint32_t> m_data_uint32;
+  SharedComponentBuffers<float> m_data_float32;
+
+  /// Exact quantile index per image component (regardless of m_bufferType). The index is immutable
+  /// once built, so copies of the image share it
+  std::shared_ptr<const std::vector<ImageQuantileIndex>> m_quantileIndices;
 
   /// One T-digest per image component
   mutable std::vector<tdigest::TDigest> m_tdigests;
@@ -591,4 +740,10 @@ private:
   ImageTransformations m_tx;
   ImageSettings m_settings;
   LoadState m_loadState = LoadState::LoadedPixels;
+
+  /// Cache of time frames read on demand, or null when all frames are held in the pixel buffers.
+  /// Copies of the image share the cache, but each has its own resident frame
+  std::shared_ptr<ImageFrameCache> m_frameCache;
+  uint32_t m_residentTimePoint = 0;
+  uint32_t m_numSummarizedFrames = 0; //!< Frames covered by the current component statistics
 };
@@ -10,6 +10,7 @@
 
 #include <algorithm>
 #include <array>
+#include <memory>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -17,31 +18,28 @@ namespace fs = std::filesystem;
 namespace
 {
 template<typename T>
-std::vector<T> copyComponentValues(const Image& image, uint32_t component)
+const T* componentBufferForSave(const Image& image, uint32_t component, std::vector<T>& scratch)
 {
-  std::vector<T> values;
-  values.reserve(image.header().numPixels());
-
-  for (std::size_t i = 0; i < image.header().numPixels(); ++i) {
-    const auto value = image.value<T>(component, i);
-    if (!value) {
-      return {};
-    }
-    values.push_back(*value);
+  const auto componentView = image.view<T>(component);
+  if (!componentView) {
+    return nullptr;
+  }
+  if (1 == componentView->pixelStride()) {
+    return componentView->data();
   }
 
-  return values;
+  // Gather one component of an interleaved buffer
+  scratch.resize(componentView->numPixels());
+  componentView->forEachVoxel([&scratch](std::size_t i, const T& value) { scratch[i] = value; });
+  return scratch.data();
 }
 
-template<typename T>
-const T* componentBufferForSave(const Image& image, uint32_t component, std::vector<T>& scratch)
+/// Give each non-empty set of buffers sole ownership of its storage before handing out mutable
+/// pointers into it
+template<typename... Buffers>
+void detachBuffers(Buffers&... buffers)
 {
-  if (Image::MultiComponentBufferType::InterleavedImage == image.bufferType()) {
-    scratch = copyComponentValues<T>(image, component);
-    return scratch.size() == image.header().numPixels() ? scratch.data() : nullptr;
-  }
-
-  return static_cast<const T*>(image.bufferAsVoid(component));
+  ((buffers.empty() ? void() : void(buffers.mutableBuffers())), ...);
 }
 } // namespace
 
@@ -150,263 +148,92 @@ bool Image::saveComponentToDisk(uint32_t component, const std::optional<fs::path
   }
 }
 
-bool Image::generateSortedBuffers()
+bool Image::generateQuantileIndex()
 {
+  const std::size_t N = m_header.numPixels() * numBufferedTimePoints();
+  const std::size_t numComponents = m_header.numComponentsPerPixel();
+
+  auto buildIndices = [this, N, numComponents](const auto& buffers) -> bool {
+    auto indices = std::make_shared<std::vector<ImageQuantileIndex>>();
+    indices->reserve(numComponents);
+
+    for (std::size_t c = 0; c < numComponents; ++c) {
+      // Interleaved components are indexed with a stride, so no per-component copy is made
+      const bool interleaved = (MultiComponentBufferType::InterleavedImage == m_bufferType);
+      const std::size_t b = interleaved ? 0 : c;
+
+      if (b >= buffers.size()) {
+        return false;
+      }
+
+      const auto* first = buffers[b].data() + (interleaved ? c : 0);
+      indices->emplace_back(ImageQuantileIndex::build(first, N, interleaved ? numComponents : 1));
+    }
+
+    m_quantileIndices = std::move(indices);
+    return true;
+  };
+
   switch (m_header.memoryComponentType()) {
     case ComponentType::Int8:
-      m_dataSorted_int8.clear();
-      break;
+      return buildIndices(m_data_int8);
     case ComponentType::UInt8:
-      m_dataSorted_uint8.clear();
-      break;
+      return buildIndices(m_data_uint8);
     case ComponentType::Int16:
-      m_dataSorted_int16.clear();
-      break;
+      return buildIndices(m_data_int16);
     case ComponentType::UInt16:
-      m_dataSorted_uint16.clear();
-      break;
+      return buildIndices(m_data_uint16);
     case ComponentType::Int32:
-      m_dataSorted_int32.clear();
-      break;
+      return buildIndices(m_data_int32);
     case ComponentType::UInt32:
-      m_dataSorted_uint32.clear();
-      break;
+      return buildIndices(m_data_uint32);
     case ComponentType::Float32:
-      m_dataSorted_float32.clear();
-      break;
+      return buildIndices(m_data_float32);
     default:
       return false;
   }
-
-  switch (m_bufferType) {
-    case MultiComponentBufferType::SeparateImages: {
-      for (std::size_t c = 0; c < m_header.numComponentsPerPixel(); ++c) {
-        switch (m_header.memoryComponentType()) {
-          case ComponentType::Int8: {
-            const auto& src = m_data_int8[c];
-            auto& dst = m_dataSorted_int8;
-            dst.emplace_back(src);
-            std::sort(dst.back().begin(), dst.back().end());
-            break;
-          }
-          case ComponentType::UInt8: {
-            const auto& src = m_data_uint8[c];
-            auto& dst = m_dataSorted_uint8;
-            dst.emplace_back(src);
-            std::sort(dst.back().begin(), dst.back().end());
-            break;
-          }
-          case ComponentType::Int16: {
-            const auto& src = m_data_int16[c];
-            auto& dst = m_dataSorted_int16;
-            dst.emplace_back(src);
-            std::sort(dst.back().begin(), dst.back().end());
-            break;
-          }
-          case ComponentType::UInt16: {
-            const auto& src = m_data_uint16[c];
-            auto& dst = m_dataSorted_uint16;
-            dst.emplace_back(src);
-            std::sort(dst.back().begin(), dst.back().end());
-            break;
-          }
-          case ComponentType::Int32: {
-            const auto& src = m_data_int32[c];
-            auto& dst = m_dataSorted_int32;
-            dst.emplace_back(src);
-            std::sort(dst.back().begin(), dst.back().end());
-            break;
-          }
-          case ComponentType::UInt32: {
-            const auto& src = m_data_uint32[c];
-            auto& dst = m_dataSorted_uint32;
-            dst.emplace_back(src);
-            std::sort(dst.back().begin(), dst.back().end());
-            break;
-          }
-          case ComponentType::Float32: {
-            const auto& src = m_data_float32[c];
-            auto& dst = m_dataSorted_float32;
-            dst.emplace_back(src);
-            std::sort(dst.back().begin(), dst.back().end());
-            break;
-          }
-          default:
-            return false;
-        }
-      }
-      return true;
-    }
-    case MultiComponentBufferType::InterleavedImage: {
-      const std::size_t N = m_header.numPixels() * m_timeAxis.numTimePoints();
-      const std::size_t numComponents = m_header.numComponentsPerPixel();
-
-      switch (m_header.memoryComponentType()) {
-        case ComponentType::Int8:
-          m_dataSorted_int8.resize(numComponents);
-          break;
-        case ComponentType::UInt8:
-          m_dataSorted_uint8.resize(numComponents);
-          break;
-        case ComponentType::Int16:
-          m_dataSorted_int16.resize(numComponents);
-          break;
-        case ComponentType::UInt16:
-          m_dataSorted_uint16.resize(numComponents);
-          break;
-        case ComponentType::Int32:
-          m_dataSorted_int32.resize(numComponents);
-          break;
-        case ComponentType::UInt32:
-          m_dataSorted_uint32.resize(numComponents);
-          break;
-        case ComponentType::Float32:
-          m_dataSorted_float32.resize(numComponents);
-          break;
-        default:
-          return false;
-      }
-
-      for (std::size_t c = 0; c < m_header.numComponentsPerPixel(); ++c) {
-        switch (m_header.memoryComponentType()) {
-          case ComponentType::Int8: {
-            auto& dst = m_dataSorted_int8[c];
-            dst.resize(N);
-            for (std::size_t i = 0; i < N; ++i) {
-              dst[i] = m_data_int8[0][numComponents * i + c];
-            }
-            std::sort(std::begin(dst), std::end(dst));
-            break;
-          }
-          case ComponentType::UInt8: {
-            auto& dst = m_dataSorted_uint8[c];
-            dst.resize(N);
-            for (std::size_t i = 0; i < N; ++i) {
-              dst[i] = m_data_uint8[0][numComponents * i + c];
-            }
-            std::sort(std::begin(dst), std::end(dst));
-            break;
-          }
-          case ComponentType::Int16: {
-            auto& dst = m_dataSorted_int16[c];
-            dst.resize(N);
-            for (std::size_t i = 0; i < N; ++i) {
-              dst[i] = m_data_int16[0][numComponents * i + c];
-            }
-            std::sort(std::begin(dst), std::end(dst));
-            break;
-          }
-          case ComponentType::UInt16: {
-            auto& dst = m_dataSorted_uint16[c];
-            dst.resize(N);
-            for (std::size_t i = 0; i < N; ++i) {
-              dst[i] = m_data_uint16[0][numComponents * i + c];
-            }
-            std::sort(std::begin(dst), std::end(dst));
-            break;
-          }
-          case ComponentType::Int32: {
-            auto& dst = m_dataSorted_int32[c];
-            dst.resize(N);
-            for (std::size_t i = 0; i < N; ++i) {
-              dst[i] = m_data_int32[0][numComponents * i + c];
-            }
-            std::sort(std::begin(dst), std::end(dst));
-            break;
-          }
-          case ComponentType::UInt32: {
-            auto& dst = m_dataSorted_uint32[c];
-            dst.resize(N);
-            for (std::size_t i = 0; i < N; ++i) {
-              dst[i] = m_data_uint32[0][numComponents * i + c];
-            }
-            std::sort(std::begin(dst), std::end(dst));
-            break;
-          }
-          case ComponentType::Float32: {
-            auto& dst = m_dataSorted_float32[c];
-            dst.resize(N);
-            for (std::size_t i = 0; i < N; ++i) {
-              dst[i] = m_data_float32[0][numComponents * i + c];
-            }
-            std::sort(std::begin(dst), std::end(dst));
-            break;
-          }
-          default:
-            return false;
-        }
-      }
-      return true;
-    }
-  }
-
-  return false;
 }
 
-bool Image::loadImageBuffer(
-  const void* buffer,
-  std::size_t numElements,
-  ComponentType srcComponentType,
-  ComponentType dstComponentType)
+ComponentType Image::resolveImageMemoryComponentType(ComponentType dstComponentType, std::size_t numElements)
 {
   using CType = ComponentType;
 
-  bool didCast = false;
+  CType memoryType = dstComponentType;
   bool warnSizeConversion = false;
 
   switch (dstComponentType) {
     case CType::UInt8:
-      m_data_uint8.emplace_back(createBuffer<uint8_t>(buffer, numElements, srcComponentType));
-      break;
     case CType::Int8:
-      m_data_int8.emplace_back(createBuffer<int8_t>(buffer, numElements, srcComponentType));
-      break;
     case CType::UInt16:
-      m_data_uint16.emplace_back(createBuffer<uint16_t>(buffer, numElements, srcComponentType));
-      break;
     case CType::Int16:
-      m_data_int16.emplace_back(createBuffer<int16_t>(buffer, numElements, srcComponentType));
-      break;
     case CType::UInt32:
-      m_data_uint32.emplace_back(createBuffer<uint32_t>(buffer, numElements, srcComponentType));
-      break;
     case CType::Int32:
-      m_data_int32.emplace_back(createBuffer<int32_t>(buffer, numElements, srcComponentType));
-      break;
     case CType::Float32:
-      m_data_float32.emplace_back(createBuffer<float>(buffer, numElements, srcComponentType));
       break;
     case CType::ULong:
     case CType::ULongLong:
-      m_data_uint32.emplace_back(createBuffer<uint32_t>(buffer, numElements, srcComponentType));
-      m_ioInfoInMemory.m_componentInfo.m_componentType = CType::UInt32;
-      m_ioInfoInMemory.m_componentInfo.m_componentSizeInBytes = 4;
-      didCast = true;
+      memoryType = CType::UInt32;
       warnSizeConversion = true;
       break;
     case CType::Long:
     case CType::LongLong:
-      m_data_int32.emplace_back(createBuffer<int32_t>(buffer, numElements, srcComponentType));
-      m_ioInfoInMemory.m_componentInfo.m_componentType = CType::Int32;
-      m_ioInfoInMemory.m_componentInfo.m_componentSizeInBytes = 4;
-      didCast = true;
+      memoryType = CType::Int32;
       warnSizeConversion = true;
       break;
     case CType::Float64:
     case CType::LongDouble:
-      m_data_float32.emplace_back(createBuffer<float>(buffer, numElements, srcComponentType));
-      m_ioInfoInMemory.m_componentInfo.m_componentType = CType::Float32;
-      m_ioInfoInMemory.m_componentInfo.m_componentSizeInBytes = 4;
-      didCast = true;
+      memoryType = CType::Float32;
       warnSizeConversion = true;
       break;
     case CType::Undefined:
       spdlog::error("Unknown component type in image from file {}", m_ioInfoOnDisk.m_fileInfo.m_fileName);
-      return false;
+      return CType::Undefined;
   }
 
-  if (didCast) {
-    const std::string newTypeString = componentTypeString(m_ioInfoInMemory.m_componentInfo.m_componentType);
+  if (memoryType != dstComponentType) {
+    const std::string newTypeString = componentTypeString(memoryType);
+    m_ioInfoInMemory.m_componentInfo.m_componentType = memoryType;
+    m_ioInfoInMemory.m_componentInfo.m_componentSizeInBytes = 4;
     m_ioInfoInMemory.m_componentInfo.m_componentTypeString = newTypeString;
     m_ioInfoInMemory.m_sizeInfo.m_imageSizeInBytes =
       numElements * m_ioInfoInMemory.m_componentInfo.m_componentSizeInBytes;
@@ -425,88 +252,65 @@ bool Image::loadImageBuffer(
     }
   }
 
-  return true;
+  return memoryType;
 }
 
-bool Image::loadSegBuffer(
-  const void* buffer,
-  std::size_t numElements,
-  ComponentType srcComponentType,
-  ComponentType dstComponentType)
+ComponentType Image::resolveSegMemoryComponentType(ComponentType dstComponentType, std::size_t numElements)
 {
   using CType = ComponentType;
 
-  bool didCast = false;
+  CType memoryType = dstComponentType;
   bool warnFloatConversion = false;
   bool warnSizeConversion = false;
   bool warnSignConversion = false;
 
   switch (dstComponentType) {
     case CType::UInt8:
-      m_data_uint8.emplace_back(createBuffer<uint8_t>(buffer, numElements, srcComponentType));
-      break;
     case CType::UInt16:
-      m_data_uint16.emplace_back(createBuffer<uint16_t>(buffer, numElements, srcComponentType));
-      break;
     case CType::UInt32:
-      m_data_uint32.emplace_back(createBuffer<uint32_t>(buffer, numElements, srcComponentType));
       break;
     case CType::Int8:
-      m_data_uint8.emplace_back(createBuffer<uint8_t>(buffer, numElements, srcComponentType));
-      m_ioInfoInMemory.m_componentInfo.m_componentType = CType::UInt8;
-      m_ioInfoInMemory.m_componentInfo.m_componentSizeInBytes = 1;
-      didCast = true;
+      memoryType = CType::UInt8;
       warnSignConversion = true;
       break;
     case CType::Int16:
-      m_data_uint16.emplace_back(createBuffer<uint16_t>(buffer, numElements, srcComponentType));
-      m_ioInfoInMemory.m_componentInfo.m_componentType = CType::UInt16;
-      m_ioInfoInMemory.m_componentInfo.m_componentSizeInBytes = 2;
-      didCast = true;
+      memoryType = CType::UInt16;
       warnSignConversion = true;
       break;
     case CType::Int32:
-      m_data_uint32.emplace_back(createBuffer<uint32_t>(buffer, numElements, srcComponentType));
-      m_ioInfoInMemory.m_componentInfo.m_componentType = CType::UInt32;
-      m_ioInfoInMemory.m_componentInfo.m_componentSizeInBytes = 4;
-      didCast = true;
+      memoryType = CType::UInt32;
       warnSignConversion = true;
       break;
     case CType::ULong:
     case CType::ULongLong:
-      m_data_uint32.emplace_back(createBuffer<uint32_t>(buffer, numElements, srcComponentType));
-      m_ioInfoInMemory.m_componentInfo.m_componentType = CType::UInt32;
-      m_ioInfoInMemory.m_componentInfo.m_componentSizeInBytes = 4;
-      didCast = true;
+      memoryType = CType::UInt32;
       warnSizeConversion = true;
       break;
     case CType::Long:
     case CType::LongLong:
-      m_data_uint32.emplace_back(createBuffer<uint32_t>(buffer, numElements, srcComponentType));
-      m_ioInfoInMemory.m_componentInfo.m_componentType = CType::UInt32;
-      m_ioInfoInMemory.m_componentInfo.m_componentSizeInBytes = 4;
-      didCast = true;
+      memoryType = CType::UInt32;
       warnSizeConversion = true;
       warnSignConversion = true;
       break;
     case CType::Float32:
     case CType::Float64:
     case CType::LongDouble:
-      m_data_uint32.emplace_back(createBuffer<uint32_t>(buffer, numElements, srcComponentType));
-      m_ioInfoInMemory.m_componentInfo.m_componentType = CType::UInt32;
-      m_ioInfoInMemory.m_componentInfo.m_componentSizeInBytes = 4;
-      didCast = true;
+      memoryType = CType::UInt32;
       warnFloatConversion = true;
       warnSignConversion = true;
       break;
     case CType::Undefined:
       spdlog::error("Unknown component type in image from file {}", m_ioInfoOnDisk.m_fileInfo.m_fileName);
-      return false;
+      return CType::Undefined;
   }
 
-  if (didCast) {
-    const std::string newTypeString = componentTypeString(m_ioInfoInMemory.m_componentInfo.m_componentType);
+  if (memoryType != dstComponentType) {
+    const std::string newTypeString = componentTypeString(memoryType);
 
+    m_ioInfoInMemory.m_componentInfo.m_componentType = memoryType;
+    m_ioInfoInMemory.m_componentInfo.m_componentSizeInBytes = (CType::UInt8 == memoryType)    ? 1
+                                                              : (CType::UInt16 == memoryType) ? 2
+                                                                                              : 4;
     m_ioInfoInMemory.m_componentInfo.m_componentTypeString = newTypeString;
     m_ioInfoInMemory.m_sizeInfo.m_imageSizeInBytes =
       numElements * m_ioInfoInMemory.m_componentInfo.m_componentSizeInBytes;
@@ -542,12 +346,67 @@ bool Image::loadSegBuffer(
     }
   }
 
-  return true;
+  return memoryType;
+}
+
+bool Image::loadImageBuffer(
+  const void* buffer,
+  std::size_t numElements,
+  ComponentType srcComponentType,
+  ComponentType dstComponentType)
+{
+  switch (resolveImageMemoryComponentType(dstComponentType, numElements)) {
+    case ComponentType::UInt8:
+      m_data_uint8.mutableBuffers().emplace_back(createBuffer<uint8_t>(buffer, numElements, srcComponentType));
+      return true;
+    case ComponentType::Int8:
+      m_data_int8.mutableBuffers().emplace_back(createBuffer<int8_t>(buffer, numElements, srcComponentType));
+      return true;
+    case ComponentType::UInt16:
+      m_data_uint16.mutableBuffers().emplace_back(createBuffer<uint16_t>(buffer, numElements, srcComponentType));
+      return true;
+    case ComponentType::Int16:
+      m_data_int16.mutableBuffers().emplace_back(createBuffer<int16_t>(buffer, numElements, srcComponentType));
+      return true;
+    case ComponentType::UInt32:
+      m_data_uint32.mutableBuffers().emplace_back(createBuffer<uint32_t>(buffer, numElements, srcComponentType));
+      return true;
+    case ComponentType::Int32:
+      m_data_int32.mutableBuffers().emplace_back(createBuffer<int32_t>(buffer, numElements, srcComponentType));
+      return true;
+    case ComponentType::Float32:
+      m_data_float32.mutableBuffers().emplace_back(createBuffer<float>(buffer, numElements, srcComponentType));
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool Image::loadSegBuffer(
+  const void* buffer,
+  std::size_t numElements,
+  ComponentType srcComponentType,
+  ComponentType dstComponentType)
+{
+  switch (resolveSegMemoryComponentType(dstComponentType, numElements)) {
+    case ComponentType::UInt8:
+      m_data_uint8.mutableBuffers().emplace_back(createBuffer<uint8_t>(buffer, numElements, srcComponentType));
+      return true;
+    case ComponentType::UInt16:
+      m_data_uint16.mutableBuffers().emplace_back(createBuffer<uint16_t>(buffer, numElements, srcComponentType));
+      return true;
+    case ComponentType::UInt32:
+      m_data_uint32.mutableBuffers().emplace_back(createBuffer<uint32_t>(buffer, numElements, srcComponentType));
+      return true;
+    default:
+      return false;
+  }
 }
 
 const void* Image::bufferAsVoid(uint32_t comp, uint32_t timePoint) const
 {
-  if (timePoint >= m_timeAxis.numTimePoints()) {
+  const std::optional<uint32_t> frame = bufferFrame(timePoint);
+  if (!frame) {
     return nullptr;
   }
 
@@ -584,12 +443,12 @@ const void* Image::bufferAsVoid(uint32_t comp, uint32_t timePoint) const
       if (m_header.numComponentsPerPixel() <= comp) {
         return nullptr;
       }
-      return F(comp, static_cast<std::size_t>(timePoint) * m_header.numPixels());
+      return F(comp, static_cast<std::size_t>(*frame) * m_header.numPixels());
     case MultiComponentBufferType::InterleavedImage:
       if (1 <= comp) {
         return nullptr;
       }
-      return F(0, static_cast<std::size_t>(timePoint) * m_header.numPixels() * m_header.numComponentsPerPixel());
+      return F(0, static_cast<std::size_t>(*frame) * m_header.numPixels() * m_header.numComponentsPerPixel());
   }
 
   return nullptr;
@@ -597,42 +456,52 @@ const void* Image::bufferAsVoid(uint32_t comp, uint32_t timePoint) const
 
 void* Image::bufferAsVoid(uint32_t comp, uint32_t timePoint)
 {
+  // The caller may write through the returned pointer, so stop sharing pixels with other copies
+  detachBuffers(m_data_int8, m_data_uint8, m_data_int16, m_data_uint16, m_data_int32, m_data_uint32, m_data_float32);
   return const_cast<void*>(const_cast<const Image*>(this)->bufferAsVoid(comp, timePoint));
 }
 
-const void* Image::bufferSortedAsVoid(uint32_t comp) const
+bool Image::sharesPixelDataWith(const Image& other) const
 {
-  if (m_header.numComponentsPerPixel() <= comp) {
-    spdlog::error(
-      "Invalid image component {} when retrieving sorted buffer for image with {} components",
-      comp,
-      m_header.numComponentsPerPixel());
-    return nullptr;
+  if (m_header.memoryComponentType() != other.m_header.memoryComponentType()) {
+    return false;
   }
 
   switch (m_header.memoryComponentType()) {
     case ComponentType::Int8:
-      return static_cast<const void*>(m_dataSorted_int8.at(comp).data());
+      return m_data_int8.sharesStorageWith(other.m_data_int8);
     case ComponentType::UInt8:
-      return static_cast<const void*>(m_dataSorted_uint8.at(comp).data());
+      return m_data_uint8.sharesStorageWith(other.m_data_uint8);
     case ComponentType::Int16:
-      return static_cast<const void*>(m_dataSorted_int16.at(comp).data());
+      return m_data_int16.sharesStorageWith(other.m_data_int16);
     case ComponentType::UInt16:
-      return static_cast<const void*>(m_dataSorted_uint16.at(comp).data());
+      return m_data_uint16.sharesStorageWith(other.m_data_uint16);
     case ComponentType::Int32:
-      return static_cast<const void*>(m_dataSorted_int32.at(comp).data());
+      return m_data_int32.sharesStorageWith(other.m_data_int32);
     case ComponentType::UInt32:
-      return static_cast<const void*>(m_dataSorted_uint32.at(comp).data());
+      return m_data_uint32.sharesStorageWith(other.m_data_uint32);
     case ComponentType::Float32:
-      return static_cast<const void*>(m_dataSorted_float32.at(comp).data());
+      return m_data_float32.sharesStorageWith(other.m_data_float32);
     default:
-      return static_cast<const void*>(nullptr);
+      return false;
   }
 }
 
-void* Image::bufferSortedAsVoid(uint32_t comp)
+const ImageQuantileIndex* Image::quantileIndex(uint32_t comp) const
 {
-  return const_cast<void*>(const_cast<const Image*>(this)->bufferSortedAsVoid(comp));
+  if (m_header.numComponentsPerPixel() <= comp) {
+    spdlog::error(
+      "Invalid image component {} when retrieving quantile index for image with {} components",
+      comp,
+      m_header.numComponentsPerPixel());
+    return nullptr;
+  }
+
+  if (!m_quantileIndices || m_quantileIndices->size() <= comp) {
+    return nullptr;
+  }
+
+  return &(*m_quantileIndices)[comp];
 }
 
 std::optional<std::pair<std::size_t, std::size_t>>
@@ -658,17 +527,34 @@ Image::getComponentAndOffsetForBuffer(uint32_t comp, std::size_t index, uint32_t
     return std::nullopt;
   }
 
+  const std::optional<uint32_t> frame = bufferFrame(timePoint);
+  if (!frame) {
+    spdlog::debug("Image time point {} is not resident (resident time point is {})", timePoint, m_residentTimePoint);
+    return std::nullopt;
+  }
+
   switch (m_bufferType) {
     case MultiComponentBufferType::SeparateImages:
-      return separateComponentFrameAddress(comp, index, timePoint, m_header.numPixels());
+      return separateComponentFrameAddress(comp, index, *frame, m_header.numPixels());
     case MultiComponentBufferType::InterleavedImage:
       return interleavedComponentFrameAddress(
         comp,
         index,
-        timePoint,
+        *frame,
         m_header.numPixels(),
         m_header.numComponentsPerPixel());
   }
 
   return std::nullopt;
 }
+
+std::optional<uint32_t> Image::bufferFrame(uint32_t timePoint) const
+{
+  if (timePoint >= m_timeAxis.numTimePoints()) {
+    return std::nullopt;
+  }
+  if (!m_frameCache) {
+    return timePoint;
+  }
+  return (timePoint == m_residentTimePoint) ? std::optional<uint32_t>{0} : std::nullopt;
+}
@@ -1,5 +1,6 @@
 #include "image/ImageDerivedData.h"
 #include "image/ImageUtility.h"
+#include "image/ImageView.h"
 #include "internal/ImageUtility.tpp"
 
 #include <spdlog/spdlog.h>
@@ -10,6 +11,7 @@
 #include <glm/vec3.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <format>
 #include <limits>
@@ -17,6 +19,7 @@
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace
 {
@@ -29,51 +32,32 @@ bool isVectorDerivativeProjection(ComponentProjectionMode mode)
          ComponentProjectionMode::VectorLaplacianMagnitude == mode;
 }
 
-std::size_t linearIndex(const glm::uvec3& dims, uint32_t x, uint32_t y, uint32_t z)
-{
-  return static_cast<std::size_t>(dims.x) * dims.y * z + static_cast<std::size_t>(dims.x) * y + x;
-}
-
-double vectorValueAt(const Image& image, uint32_t component, uint32_t x, uint32_t y, uint32_t z, uint32_t timePoint)
-{
-  return image.value<double>(component, static_cast<int>(x), static_cast<int>(y), static_cast<int>(z), timePoint)
-    .value_or(0.0);
-}
+/// Typed read-only views of the three components of a vector field
+template<typename T>
+using VectorFieldViews = std::array<ImageView<const T>, 3>;
 
+template<typename T>
 double derivativeAt(
-  const Image& image,
+  const VectorFieldViews<T>& views,
+  const glm::vec3& spacing,
   uint32_t vectorComponent,
   uint32_t axis,
-  uint32_t x,
-  uint32_t y,
-  uint32_t z,
-  uint32_t timePoint)
+  const glm::uvec3& voxel)
 {
-  const glm::uvec3 dims = image.header().pixelDimensions();
-  const glm::vec3 spacing = image.header().spacing();
+  const ImageView<const T>& view = views[vectorComponent];
 
   auto sample = [&](uint32_t coordinate) {
-    uint32_t xx = x;
-    uint32_t yy = y;
-    uint32_t zz = z;
-    if (0u == axis) {
-      xx = coordinate;
-    }
-    else if (1u == axis) {
-      yy = coordinate;
-    }
-    else {
-      zz = coordinate;
-    }
-    return vectorValueAt(image, vectorComponent, xx, yy, zz, timePoint);
+    glm::uvec3 p = voxel;
+    p[axis] = coordinate;
+    return static_cast<double>(view.at(p.x, p.y, p.z));
   };
 
-  const uint32_t n = dims[axis];
+  const uint32_t n = static_cast<uint32_t>(view.dimensions()[axis]);
   if (n <= 1u) {
     return 0.0;
   }
 
-  const uint32_t coordinate = 0u == axis ? x : (1u == axis ? y : z);
+  const uint32_t coordinate = voxel[axis];
   const double dx = std::max(static_cast<double>(spacing[axis]), std::numeric_limits<double>::epsilon());
 
   if (0u == coordinate) {
@@ -86,40 +70,28 @@ double derivativeAt(
   return (sample(coordinate + 1u) - sample(coordinate - 1u)) / (2.0 * dx);
 }
 
+template<typename T>
 double secondDerivativeAt(
-  const Image& image,
+  const VectorFieldViews<T>& views,
+  const glm::vec3& spacing,
   uint32_t vectorComponent,
   uint32_t axis,
-  uint32_t x,
-  uint32_t y,
-  uint32_t z,
-  uint32_t timePoint)
+  const glm::uvec3& voxel)
 {
-  const glm::uvec3 dims = image.header().pixelDimensions();
-  const glm::vec3 spacing = image.header().spacing();
+  const ImageView<const T>& view = views[vectorComponent];
 
   auto sample = [&](uint32_t coordinate) {
-    uint32_t xx = x;
-    uint32_t yy = y;
-    uint32_t zz = z;
-    if (0u == axis) {
-      xx = coordinate;
-    }
-    else if (1u == axis) {
-      yy = coordinate;
-    }
-    else {
-      zz = coordinate;
-    }
-    return vectorValueAt(image, vectorComponent, xx, yy, zz, timePoint);
+    glm::uvec3 p = voxel;
+    p[axis] = coordinate;
+    return static_cast<double>(view.at(p.x, p.y, p.z));
   };
 
-  const uint32_t n = dims[axis];
+  const uint32_t n = static_cast<uint32_t>(view.dimensions()[axis]);
   if (n <= 2u) {
     return 0.0;
   }
 
-  const uint32_t coordinate = 0u == axis ? x : (1u == axis ? y : z);
+  const uint32_t coordinate = voxel[axis];
   const double dx = std::max(static_cast<double>(spacing[axis]), std::numeric_limits<double>::epsilon());
 
   if (0u == coordinate) {
@@ -132,6 +104,69 @@ double secondDerivativeAt(
   return (sample(coordinate + 1u) - 2.0 * sample(coordinate) + sample(coordinate - 1u)) / (dx * dx);
 }
 
+/**
+ * @brief Compute a vector derivative projection at one voxel that lies inside the views.
+ * @param directionsTranspose Transpose of the image direction matrix.
+ */
+template<typename T>
+std::optional<double> vectorDerivativeValue(
+  const VectorFieldViews<T>& views,
+  const glm::vec3& spacing,
+  const glm::dmat3& directionsTranspose,
+  ComponentProjectionMode mode,
+  const glm::uvec3& voxel)
+{
+  glm::dmat3 jacobian(0.0);
+  for (uint32_t component = 0; component < 3u; ++component) {
+    for (uint32_t axis = 0; axis < 3u; ++axis) {
+      jacobian[axis][component] = derivativeAt(views, spacing, component, axis, voxel);
+    }
+  }
+
+  jacobian = jacobian * directionsTranspose;
+
+  if (
+    ComponentProjectionMode::VectorJacobianDeterminant == mode ||
+    ComponentProjectionMode::VectorLogJacobianDeterminant == mode)
+  {
+    const double determinant = glm::determinant(glm::dmat3(1.0) + jacobian);
+    if (ComponentProjectionMode::VectorLogJacobianDeterminant == mode) {
+      return determinant > 0.0 ? std::log(determinant) : std::numeric_limits<double>::quiet_NaN();
+    }
+    return determinant;
+  }
+  if (ComponentProjectionMode::VectorGradientMagnitude == mode) {
+    double sumSquares = 0.0;
+    for (uint32_t column = 0; column < 3u; ++column) {
+      for (uint32_t row = 0; row < 3u; ++row) {
+        sumSquares += jacobian[column][row] * jacobian[column][row];
+      }
+    }
+    return std::sqrt(sumSquares);
+  }
+  if (ComponentProjectionMode::VectorDivergence == mode) {
+    return jacobian[0][0] + jacobian[1][1] + jacobian[2][2];
+  }
+  if (ComponentProjectionMode::VectorCurlMagnitude == mode) {
+    const glm::dvec3 curl{
+      jacobian[1][2] - jacobian[2][1],
+      jacobian[2][0] - jacobian[0][2],
+      jacobian[0][1] - jacobian[1][0]};
+    return glm::length(curl);
+  }
+  if (ComponentProjectionMode::VectorLaplacianMagnitude == mode) {
+    glm::dvec3 laplacian(0.0);
+    for (uint32_t component = 0; component < 3u; ++component) {
+      for (uint32_t axis = 0; axis < 3u; ++axis) {
+        laplacian[component] += secondDerivativeAt(views, spacing, component, axis, voxel);
+      }
+    }
+    return glm::length(laplacian);
+  }
+
+  return std::nullopt;
+}
+
 std::expected<std::vector<float>, std::string>
 createVectorDerivativeValues(const Image& image, ComponentProjectionMode mode, uint32_t timePoint)
 {
@@ -140,24 +175,117 @@ createVectorDerivativeValues(const Image& image, ComponentProjectionMode mode, u
   }
 
   const glm::uvec3 dims = image.header().pixelDimensions();
+  const glm::vec3 spacing = image.header().spacing();
+  const glm::dmat3 directionsTranspose = glm::transpose(glm::dmat3{image.header().directions()});
+
   std::vector<float> values(image.header().numPixels(), 0.0f);
 
-  for (uint32_t z = 0; z < dims.z; ++z) {
-    for (uint32_t y = 0; y < dims.y; ++y) {
-      for (uint32_t x = 0; x < dims.x; ++x) {
-        const std::optional<double> value =
-          vectorDerivativeProjectionValue(image, mode, glm::uvec3{x, y, z}, timePoint);
-        if (!value) {
-          return std::unexpected("Unsupported vector derivative projection");
+  const bool visited = image.visitComponentViews<3>(timePoint, [&](const auto& views) {
+    std::size_t index = 0;
+    for (uint32_t z = 0; z < dims.z; ++z) {
+      for (uint32_t y = 0; y < dims.y; ++y) {
+        for (uint32_t x = 0; x < dims.x; ++x) {
+          const double value =
+            vectorDerivativeValue(views, spacing, directionsTranspose, mode, glm::uvec3{x, y, z}).value_or(0.0);
+          values[index++] = static_cast<float>(std::isfinite(value) ? value : 0.0);
         }
-
-        values[linearIndex(dims, x, y, z)] = static_cast<float>(std::isfinite(*value) ? *value : 0.0);
       }
     }
+  });
+
+  if (!visited) {
+    return std::unexpected("Unable to read vector field components");
   }
 
   return values;
 }
+
+/**
+ * @brief Project the components of every pixel to one scalar value.
+ * @return Number of non-finite component values that were ignored.
+ */
+template<typename T>
+std::size_t projectComponentValues(
+  const std::vector<ImageView<const T>>& views,
+  ComponentProjectionMode mode,
+  std::vector<float>& values)
+{
+  const ComplexPhaseRange range = (ComponentProjectionMode::ComplexPhaseUnsignedRadians == mode ||
+                                   ComponentProjectionMode::ComplexPhaseUnsignedDegrees == mode)
+                                    ? ComplexPhaseRange::Unsigned
+                                    : ComplexPhaseRange::Signed;
+  const ComplexPhaseUnit unit = (ComponentProjectionMode::ComplexPhaseSignedDegrees == mode ||
+                                 ComponentProjectionMode::ComplexPhaseUnsignedDegrees == mode)
+                                  ? ComplexPhaseUnit::Degrees
+                                  : ComplexPhaseUnit::Radians;
+
+  std::size_t nonFiniteValueCount = 0;
+
+  for (std::size_t pixel = 0; pixel < values.size(); ++pixel) {
+    double minValue = std::numeric_limits<double>::max();
+    double maxValue = std::numeric_limits<double>::lowest();
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    uint32_t finiteComponentCount = 0;
+
+    for (const ImageView<const T>& view : views) {
+      const double value = static_cast<double>(view[pixel]);
+
+      if (!std::isfinite(value)) {
+        ++nonFiniteValueCount;
+        continue;
+      }
+
+      minValue = std::min(minValue, value);
+      maxValue = std::max(maxValue, value);
+      sum += value;
+      sumSquares += value * value;
+      ++finiteComponentCount;
+    }
+
+    if (finiteComponentCount == 0) {
+      values[pixel] = 0.0f;
+      continue;
+    }
+
+    switch (mode) {
+      case ComponentProjectionMode::Minimum:
+        values[pixel] = static_cast<float>(minValue);
+        break;
+      case ComponentProjectionMode::Mean:
+        values[pixel] = static_cast<float>(sum / static_cast<double>(finiteComponentCount));
+        break;
+      case ComponentProjectionMode::Maximum:
+        values[pixel] = static_cast<float>(maxValue);
+        break;
+      case ComponentProjectionMode::Magnitude:
+        values[pixel] = static_cast<float>(std::sqrt(sumSquares));
+        break;
+      case ComponentProjectionMode::ComplexPhaseSignedRadians:
+      case ComponentProjectionMode::ComplexPhaseUnsignedRadians:
+      case ComponentProjectionMode::ComplexPhaseSignedDegrees:
+      case ComponentProjectionMode::ComplexPhaseUnsignedDegrees: {
+        const double real = static_cast<double>(views[0][pixel]);
+        const double imaginary = static_cast<double>(views[1][pixel]);
+        if (!std::isfinite(real) || !std::isfinite(imaginary)) {
+          values[pixel] = 0.0f;
+          break;
+        }
+        values[pixel] = static_cast<float>(complexPhaseValue(real, imaginary, range, unit));
+        break;
+      }
+      case ComponentProjectionMode::VectorJacobianDeterminant:
+      case ComponentProjectionMode::VectorLogJacobianDeterminant:
+      case ComponentProjectionMode::VectorGradientMagnitude:
+      case ComponentProjectionMode::VectorDivergence:
+      case ComponentProjectionMode::VectorCurlMagnitude:
+      case ComponentProjectionMode::VectorLaplacianMagnitude:
+        break;
+    }
+  }
+
+  return nonFiniteValueCount;
+}
 } // namespace
 
 std::optional<ComponentProjectionMode> componentProjectionFromRenderMode(ComponentRenderMode mode)
@@ -296,56 +424,14 @@ std::optional<double> vectorDerivativeProjectionValue(
     return std::nullopt;
   }
   const uint32_t clampedTimePoint = image.timeAxis().clamp(timePoint);
+  const glm::dmat3 directionsTranspose = glm::transpose(glm::dmat3{image.header().directions()});
 
-  glm::dmat3 jacobian(0.0);
-  for (uint32_t component = 0; component < 3u; ++component) {
-    for (uint32_t axis = 0; axis < 3u; ++axis) {
-      jacobian[axis][component] = derivativeAt(image, component, axis, voxel.x, voxel.y, voxel.z, clampedTimePoint);
-    }
-  }
-
-  jacobian = jacobian * glm::transpose(glm::dmat3{image.header().directions()});
+  std::optional<double> value;
+  image.visitComponentViews<3>(clampedTimePoint, [&](const auto& views) {
+    value = vectorDerivativeValue(views, image.header().spacing(), directionsTranspose, mode, voxel);
+  });
 
-  if (
-    ComponentProjectionMode::VectorJacobianDeterminant == mode ||
-    ComponentProjectionMode::VectorLogJacobianDeterminant == mode)
-  {
-    const double determinant = glm::determinant(glm::dmat3(1.0) + jacobian);
-    if (ComponentProjectionMode::VectorLogJacobianDeterminant == mode) {
-      return determinant > 0.0 ? std::log(determinant) : std::numeric_limits<double>::quiet_NaN();
-    }
-    return determinant;
-  }
-  if (ComponentProjectionMode::VectorGradientMagnitude == mode) {
-    double sumSquares = 0.0;
-    for (uint32_t column = 0; column < 3u; ++column) {
-      for (uint32_t row = 0; row < 3u; ++row) {
-        sumSquares += jacobian[column][row] * jacobian[column][row];
-      }
-    }
-    return std::sqrt(sumSquares);
-  }
-  if (ComponentProjectionMode::VectorDivergence == mode) {
-    return jacobian[0][0] + jacobian[1][1] + jacobian[2][2];
-  }
-  if (ComponentProjectionMode::VectorCurlMagnitude == mode) {
-    const glm::dvec3 curl{
-      jacobian[1][2] - jacobian[2][1],
-      jacobian[2][0] - jacobian[0][2],
-      jacobian[0][1] - jacobian[1][0]};
-    return glm::length(curl);
-  }
-  if (ComponentProjectionMode::VectorLaplacianMagnitude == mode) {
-    glm::dvec3 laplacian(0.0);
-    for (uint32_t component = 0; component < 3u; ++component) {
-      for (uint32_t axis = 0; axis < 3u; ++axis) {
-        laplacian[component] += secondDerivativeAt(image, component, axis, voxel.x, voxel.y, voxel.z, clampedTimePoint);
-      }
-    }
-    return glm::length(laplacian);
-  }
-
-  return std::nullopt;
+  return value;
 }
 
 bool isComplexValuedImage(const Image& image)
@@ -526,80 +612,27 @@ createComponentProjectionImage(const Image& image, ComponentProjectionMode mode,
 
   std::size_t nonFiniteValueCount = 0;
 
-  for (std::size_t pixel = 0; !isVectorDerivativeProjection(mode) && pixel < numPixels; ++pixel) {
-    double minValue = std::numeric_limits<double>::max();
-    double maxValue = std::numeric_limits<double>::lowest();
-    double sum = 0.0;
-    double sumSquares = 0.0;
-    uint32_t finiteComponentCount = 0;
+  if (!isVectorDerivativeProjection(mode)) {
+    bool readAllComponents = false;
 
-    for (uint32_t component = 0; component < numComponents; ++component) {
-      const auto value = image.value<double>(component, pixel, clampedTimePoint);
-      if (!value) {
-        return std::unexpected(std::format("Unable to read component {} at pixel {}", component, pixel));
-      }
+    image.visitComponentView(0, clampedTimePoint, [&]<typename T>(const ImageView<T>& firstView) {
+      using ValueType = typename ImageView<T>::value_type;
 
-      if (!std::isfinite(*value)) {
-        ++nonFiniteValueCount;
-        continue;
+      std::vector<ImageView<T>> views{firstView};
+      for (uint32_t component = 1; component < numComponents; ++component) {
+        const auto componentView = image.view<ValueType>(component, clampedTimePoint);
+        if (!componentView) {
+          return;
+        }
+        views.push_back(*componentView);
       }
 
-      minValue = std::min(minValue, *value);
-      maxValue = std::max(maxValue, *value);
-      sum += *value;
-      sumSquares += (*value) * (*value);
-      ++finiteComponentCount;
-    }
-
-    if (finiteComponentCount == 0) {
-      values[pixel] = 0.0f;
-      continue;
-    }
+      nonFiniteValueCount = projectComponentValues(views, mode, values);
+      readAllComponents = true;
+    });
 
-    switch (mode) {
-      case ComponentProjectionMode::Minimum:
-        values[pixel] = static_cast<float>(minValue);
-        break;
-      case ComponentProjectionMode::Mean:
-        values[pixel] = static_cast<float>(sum / static_cast<double>(finiteComponentCount));
-        break;
-      case ComponentProjectionMode::Maximum:
-        values[pixel] = static_cast<float>(maxValue);
-        break;
-      case ComponentProjectionMode::Magnitude:
-        values[pixel] = static_cast<float>(std::sqrt(sumSquares));
-        break;
-      case ComponentProjectionMode::ComplexPhaseSignedRadians:
-      case ComponentProjectionMode::ComplexPhaseUnsignedRadians:
-      case ComponentProjectionMode::ComplexPhaseSignedDegrees:
-      case ComponentProjectionMode::ComplexPhaseUnsignedDegrees: {
-        const auto real = image.value<double>(0, pixel, clampedTimePoint);
-        const auto imaginary = image.value<double>(1, pixel, clampedTimePoint);
-        if (!real || !imaginary) {
-          return std::unexpected(std::format("Unable to read complex value at pixel {}", pixel));
-        }
-        if (!std::isfinite(*real) || !std::isfinite(*imaginary)) {
-          values[pixel] = 0.0f;
-          break;
-        }
-        const ComplexPhaseRange range = (ComponentProjectionMode::ComplexPhaseUnsignedRadians == mode ||
-                                         ComponentProjectionMode::ComplexPhaseUnsignedDegrees == mode)
-                                          ? ComplexPhaseRange::Unsigned
-                                          : ComplexPhaseRange::Signed;
-        const ComplexPhaseUnit unit = (ComponentProjectionMode::ComplexPhaseSignedDegrees == mode ||
-                                       ComponentProjectionMode::ComplexPhaseUnsignedDegrees == mode)
-                                        ? ComplexPhaseUnit::Degrees
-                                        : ComplexPhaseUnit::Radians;
-        values[pixel] = static_cast<float>(complexPhaseValue(*real, *imaginary, range, unit));
-        break;
-      }
-      case ComponentProjectionMode::VectorJacobianDeterminant:
-      case ComponentProjectionMode::VectorLogJacobianDeterminant:
-      case ComponentProjectionMode::VectorGradientMagnitude:
-      case ComponentProjectionMode::VectorDivergence:
-      case ComponentProjectionMode::VectorCurlMagnitude:
-      case ComponentProjectionMode::VectorLaplacianMagnitude:
-        break;
+    if (!readAllComponents) {
+      return std::unexpected("Unable to read image components for projection");
     }
   }
 
@@ -0,0 +1,299 @@
+#include "image/ImageFrameCache.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <utility>
+
+ImageFrameCache::ImageFrameCache(
+  uint32_t numTimePoints,
+  std::size_t frameSizeInBytes,
+  FrameLoader loader,
+  FrameSummarizer summarizer,
+  ImageFrameCacheOptions options)
+  : m_numTimePoints(numTimePoints)
+  , m_frameSizeInBytes(frameSizeInBytes)
+  , m_loader(std::move(loader))
+  , m_summarizer(std::move(summarizer))
+  , m_options(options)
+  , m_summarized(numTimePoints, false)
+{
+  spdlog::debug(
+    "Created frame cache for {} time points of {} bytes each, holding at most {} bytes",
+    m_numTimePoints,
+    m_frameSizeInBytes,
+    m_options.maxCacheBytes);
+
+  m_worker = std::thread(&ImageFrameCache::runWorker, this);
+}
+
+ImageFrameCache::~ImageFrameCache()
+{
+  {
+    std::scoped_lock lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+
+  if (m_worker.joinable()) {
+    m_worker.join();
+  }
+}
+
+std::optional<ImageFrameBuffers> ImageFrameCache::frame(uint32_t timePoint)
+{
+  if (timePoint >= m_numTimePoints) {
+    spdlog::error("Invalid time point {} requested from frame cache with {} time points", timePoint, m_numTimePoints);
+    return std::nullopt;
+  }
+
+  {
+    std::unique_lock lock(m_mutex);
+    m_cv.wait(lock, [this, timePoint]() { return !m_loading.contains(timePoint); });
+
+    if (const auto it = m_frames.find(timePoint); it != m_frames.end()) {
+      m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+      return it->second.frame;
+    }
+
+    m_loading.insert(timePoint);
+  }
+
+  std::optional<ImageFrameBuffers> loaded = load(timePoint);
+
+  {
+    std::scoped_lock lock(m_mutex);
+    m_loading.erase(timePoint);
+    if (loaded) {
+      m_failed.erase(timePoint);
+      insert(timePoint, *loaded);
+    }
+    else {
+      m_failed.insert(timePoint);
+    }
+  }
+  m_cv.notify_all();
+
+  return loaded;
+}
+
+std::optional<ImageFrameBuffers> ImageFrameCache::requestFrame(uint32_t timePoint)
+{
+  if (timePoint >= m_numTimePoints) {
+    return std::nullopt;
+  }
+
+  {
+    std::scoped_lock lock(m_mutex);
+
+    if (const auto it = m_frames.find(timePoint); it != m_frames.end()) {
+      m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+      return it->second.frame;
+    }
+
+    if (m_loading.contains(timePoint) || m_failed.contains(timePoint) || m_requested == timePoint) {
+      return std::nullopt;
+    }
+
+    m_requested = timePoint;
+  }
+  m_cv.notify_all();
+
+  return std::nullopt;
+}
+
+void ImageFrameCache::readAhead(uint32_t timePoint, int direction)
+{
+  if (timePoint >= m_numTimePoints) {
+    return;
+  }
+
+  {
+    std::scoped_lock lock(m_mutex);
+    m_readAhead.clear();
+
+    // Frames read ahead must not evict the requested frame, which is the most recently used one
+    const uint32_t count = std::min({m_options.readAheadFrames, m_numTimePoints - 1u, capacityInFrames() - 1u});
+    for (uint32_t i = 1; i <= count; ++i) {
+      const uint32_t next = (direction < 0) ? (timePoint + m_numTimePoints - i) % m_numTimePoints
+                                            : (timePoint + i) % m_numTimePoints;
+      if (!m_frames.contains(next)) {
+        m_readAhead.push_back(next);
+      }
+    }
+  }
+  m_cv.notify_all();
+}
+
+bool ImageFrameCache::isCached(uint32_t timePoint) const
+{
+  std::scoped_lock lock(m_mutex);
+  return m_frames.contains(timePoint);
+}
+
+bool ImageFrameCache::readFailed(uint32_t timePoint) const
+{
+  std::scoped_lock lock(m_mutex);
+  return m_failed.contains(timePoint);
+}
+
+std::size_t ImageFrameCache::cachedBytes() const
+{
+  std::scoped_lock lock(m_mutex);
+  return m_frames.size() * m_frameSizeInBytes;
+}
+
+uint32_t ImageFrameCache::numTimePoints() const
+{
+  return m_numTimePoints;
+}
+
+ImageFrameSummaries ImageFrameCache::summaries() const
+{
+  std::scoped_lock lock(m_mutex);
+  return m_summaries;
+}
+
+std::optional<ImageFrameBuffers> ImageFrameCache::load(uint32_t timePoint)
+{
+  std::optional<ImageFrameBuffers> loaded;
+  {
+    std::scoped_lock loaderLock(m_loaderMutex);
+    loaded = m_loader(timePoint);
+  }
+
+  if (!loaded) {
+    spdlog::error("Could not load time point {} of image", timePoint);
+    return std::nullopt;
+  }
+
+  bool summarize = false;
+  {
+    std::scoped_lock lock(m_mutex);
+    summarize = m_summarizer && !m_summarized[timePoint];
+    m_summarized[timePoint] = true;
+  }
+
+  if (summarize) {
+    std::vector<ComponentSummary> frameSummaries = m_summarizer(*loaded);
+
+    std::scoped_lock lock(m_mutex);
+    if (m_summaries.components.empty()) {
+      m_summaries.components = std::move(frameSummaries);
+    }
+    else {
+      const std::size_t n = std::min(m_summaries.components.size(), frameSummaries.size());
+      for (std::size_t c = 0; c < n; ++c) {
+        mergeComponentSummary(m_summaries.components[c], frameSummaries[c]);
+      }
+    }
+    ++m_summaries.numFrames;
+  }
+
+  return loaded;
+}
+
+void ImageFrameCache::insert(uint32_t timePoint, ImageFrameBuffers frame)
+{
+  if (const auto it = m_frames.find(timePoint); it != m_frames.end()) {
+    it->second.frame = std::move(frame);
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+    return;
+  }
+
+  m_lru.push_front(timePoint);
+  m_frames.emplace(timePoint, Entry{std::move(frame), m_lru.begin()});
+
+  while (m_frames.size() > 1 && m_frames.size() * m_frameSizeInBytes > m_options.maxCacheBytes) {
+    m_frames.erase(m_lru.back());
+    m_lru.pop_back();
+  }
+}
+
+bool ImageFrameCache::fitsWithoutEviction() const
+{
+  return (m_frames.size() + 1) * m_frameSizeInBytes <= m_options.maxCacheBytes;
+}
+
+uint32_t ImageFrameCache::capacityInFrames() const
+{
+  if (0 == m_frameSizeInBytes) {
+    return std::max(m_numTimePoints, 1u);
+  }
+  const std::size_t capacity = m_options.maxCacheBytes / m_frameSizeInBytes;
+  return static_cast<uint32_t>(std::clamp<std::size_t>(capacity, 1, std::max(m_numTimePoints, 1u)));
+}
+
+std::optional<ImageFrameCache::WorkerRequest> ImageFrameCache::nextWorkerRequest()
+{
+  if (const std::optional<uint32_t> requested = std::exchange(m_requested, std::nullopt)) {
+    if (!m_frames.contains(*requested) && !m_loading.contains(*requested)) {
+      return WorkerRequest{*requested, true};
+    }
+  }
+
+  while (!m_readAhead.empty()) {
+    const uint32_t timePoint = m_readAhead.front();
+    m_readAhead.pop_front();
+    if (!m_frames.contains(timePoint) && !m_loading.contains(timePoint)) {
+      return WorkerRequest{timePoint, true};
+    }
+  }
+
+  if (!m_options.summarizeInBackground || !m_summarizer) {
+    return std::nullopt;
+  }
+
+  for (; m_nextSweepFrame < m_numTimePoints; ++m_nextSweepFrame) {
+    if (!m_summarized[m_nextSweepFrame] && !m_loading.contains(m_nextSweepFrame)) {
+      return WorkerRequest{m_nextSweepFrame++, false};
+    }
+  }
+
+  return std::nullopt;
+}
+
+void ImageFrameCache::runWorker()
+{
+  std::unique_lock lock(m_mutex);
+
+  while (true) {
+    std::optional<WorkerRequest> request;
+    m_cv.wait(lock, [this, &request]() {
+      if (m_stop) {
+        return true;
+      }
+      request = nextWorkerRequest();
+      return request.has_value();
+    });
+
+    if (m_stop) {
+      return;
+    }
+
+    const uint32_t timePoint = request->timePoint;
+    m_loading.insert(timePoint);
+    lock.unlock();
+
+    std::optional<ImageFrameBuffers> loaded = load(timePoint);
+
+    lock.lock();
+    m_loading.erase(timePoint);
+
+    if (loaded) {
+      m_failed.erase(timePoint);
+    }
+    else {
+      m_failed.insert(timePoint);
+    }
+
+    // Frames read only to be summarized are cached when there is room, so that they do not
+    // displace frames read ahead for playback
+    if (loaded && (request->readAhead || fitsWithoutEviction())) {
+      insert(timePoint, std::move(*loaded));
+    }
+    lock.unlock();
+    m_cv.notify_all();
+    lock.lock();
+  }
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "image/ImageUtility.h"
+#include "image/SharedComponentBuffers.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+/**
+ * @brief Pixel buffers of one time frame of an image, in the image's in-memory component type and
+ * multi-component layout.
+ */
+using ImageFrameBuffers = std::variant<
+  SharedComponentBuffers<int8_t>,
+  SharedComponentBuffers<uint8_t>,
+  SharedComponentBuffers<int16_t>,
+  SharedComponentBuffers<uint16_t>,
+  SharedComponentBuffers<int32_t>,
+  SharedComponentBuffers<uint32_t>,
+  SharedComponentBuffers<float>>;
+
+/**
+ * @brief Options for paging the time frames of a 4D image on demand.
+ */
+struct ImageFrameCacheOptions
+{
+  /// Upper bound on the memory held by cached frames. The most recently requested frame is always
+  /// kept, even when it alone exceeds the bound.
+  std::size_t maxCacheBytes = std::size_t{1} << 30;
+
+  /// Number of frames loaded ahead of the requested frame in the playback direction. Capped so that
+  /// the requested frame and the frames read ahead of it fit in the cache together.
+  uint32_t readAheadFrames = 3;
+
+  /// Load and summarize every frame once in the background while no frames are requested, so that
+  /// statistics eventually cover the whole time series
+  bool summarizeInBackground = true;
+};
+
+/**
+ * @brief Per-component statistics merged over the frames of a time series summarized so far.
+ */
+struct ImageFrameSummaries
+{
+  uint32_t numFrames = 0; //!< Number of distinct frames included in the summaries
+  std::vector<ComponentSummary> components;
+};
+
+/**
+ * @brief Bounded least-recently-used cache of the time frames of a 4D image.
+ *
+ * Frames are read by a loader callback, either on demand by frame() or ahead of time by a worker
+ * thread. Reads are serialized, so the loader does not need to be thread-safe. The first time each
+ * frame is read, it is passed to a summarizer callback and the resulting per-component summaries are
+ * merged into progressive statistics over the time series.
+ *
+ * Frames are returned as copy-on-write buffers that share storage with the cache. Writes to a
+ * returned frame detach it from the cache, so edits are not seen by later requests for that frame.
+ */
+class ImageFrameCache
+{
+public:
+  /// Read the buffers of one time frame, returning std::nullopt on failure
+  using FrameLoader = std::function<std::optional<ImageFrameBuffers>(uint32_t timePoint)>;
+
+  /// Summarize every component of one frame
+  using FrameSummarizer = std::function<std::vector<ComponentSummary>(const ImageFrameBuffers& frame)>;
+
+  /**
+   * @param numTimePoints Number of frames in the time series.
+   * @param frameSizeInBytes Memory held by the buffers of one frame.
+   * @param loader Callback that reads one frame.
+   * @param summarizer Callback that summarizes one frame. May be empty.
+   * @param options Cache size, read-ahead and background summarization options.
+   */
+  ImageFrameCache(
+    uint32_t numTimePoints,
+    std::size_t frameSizeInBytes,
+    FrameLoader loader,
+    FrameSummarizer summarizer,
+    ImageFrameCacheOptions options = {});
+
+  ImageFrameCache(const ImageFrameCache&) = delete;
+  ImageFrameCache& operator=(const ImageFrameCache&) = delete;
+
+  /// @brief Stop the read-ahead worker, waiting for a read in progress to finish.
+  ~ImageFrameCache();
+
+  /**
+   * @brief Get a frame, reading it when it is not cached.
+   *
+   * Blocks until the frame is read. When the worker is already reading the frame, waits for it
+   * rather than reading it twice.
+   *
+   * @return The frame buffers, or std::nullopt when the time point is invalid or reading failed.
+   */
+  std::optional<ImageFrameBuffers> frame(uint32_t timePoint);
+
+  /**
+   * @brief Get a frame without blocking.
+   *
+   * When the frame is not cached, queues it for the worker to read ahead of any read-ahead frames,
+   * replacing a previously requested frame that the worker has not started reading. Frames whose
+   * last read failed are not queued again; frame() retries them.
+   *
+   * @return The frame buffers, or std::nullopt when the frame is not cached yet.
+   */
+  std::optional<ImageFrameBuffers> requestFrame(uint32_t timePoint);
+
+  /**
+   * @brief Replace pending read-ahead requests with the frames that follow a time point.
+   * @param timePoint Frame that was just requested.
+   * @param direction +1 to read ahead forwards, -1 backwards. Read-ahead wraps around the ends.
+   */
+  void readAhead(uint32_t timePoint, int direction);
+
+  /// @brief Return true when a frame is held in the cache.
+  bool isCached(uint32_t timePoint) const;
+
+  /// @brief Return true when the last read of a frame, by frame() or by the worker, failed.
+  bool readFailed(uint32_t timePoint) const;
+
+  /// @brief Memory held by cached frames.
+  std::size_t cachedBytes() const;
+
+  uint32_t numTimePoints() const;
+
+  /// @brief Per-component statistics merged over the frames summarized so far.
+  ImageFrameSummaries summaries() const;
+
+private:
+  /// Read and summarize a frame outside of the lock. The caller marks the frame as loading first.
+  std::optional<ImageFrameBuffers> load(uint32_t timePoint);
+
+  /// Cache a frame as the most recently used one, evicting older frames past the size bound
+  void insert(uint32_t timePoint, ImageFrameBuffers frame);
+
+  /// Return true when a frame can be cached without evicting another one
+  bool fitsWithoutEviction() const;
+
+  /// Number of frames that fit in the cache, which is at least one
+  uint32_t capacityInFrames() const;
+
+  struct WorkerRequest
+  {
+    uint32_t timePoint = 0;
+    bool readAhead = false; //!< True for read-ahead frames, false for frames read only to be summarized
+  };
+
+  /// Pick the next frame for the worker to read: the requested frame first, then a pending
+  /// read-ahead frame, then the next frame that has not been summarized
+  std::optional<WorkerRequest> nextWorkerRequest();
+
+  void runWorker();
+
+  struct Entry
+  {
+    ImageFrameBuffers frame;
+    std::list<uint32_t>::iterator lruPos;
+  };
+
+  const uint32_t m_numTimePoints;
+  const std::size_t m_frameSizeInBytes;
+  const FrameLoader m_loader;
+  const FrameSummarizer m_summarizer;
+  const ImageFrameCacheOptions m_options;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+
+  std::unordered_map<uint32_t, Entry> m_frames;
+  std::list<uint32_t> m_lru; //!< Cached time points, most recently used first
+  std::unordered_set<uint32_t> m_loading;
+  std::deque<uint32_t> m_readAhead;
+  std::optional<uint32_t> m_requested;   //!< Frame requested by requestFrame() and not yet read
+  std::unordered_set<uint32_t> m_failed; //!< Frames whose last read failed
+
+  std::vector<bool> m_summarized;
+  uint32_t m_nextSweepFrame = 0;
+  ImageFrameSummaries m_summaries;
+
+  /// Serializes calls to the loader
+  std::mutex m_loaderMutex;
+
+  bool m_stop = false;
+  std::thread m_worker;
+};
@@ -0,0 +1,246 @@
+#include "image/ImageMacrocellGrid.h"
+#include "image/Image.h"
+
+#include "common/Parallel.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+
+/// Relative widening of the cell ranges, which covers rounding in the interpolation of values
+constexpr double sk_rangeTolerance = 1.0e-6;
+
+/// Distance in voxels by which rays step past cell faces, so that they land inside of the next cell
+constexpr float sk_faceStep = 1.0e-3f;
+
+double widen(double value, double direction)
+{
+  return value + direction * sk_rangeTolerance * std::max(1.0, std::abs(value));
+}
+
+} // namespace
+
+std::optional<ImageMacrocellGrid> ImageMacrocellGrid::build(
+  const Image& image,
+  uint32_t component,
+  uint32_t timePoint,
+  uint32_t cellSize,
+  unsigned int numThreads)
+{
+  if (0 == cellSize) {
+    return std::nullopt;
+  }
+
+  ImageMacrocellGrid grid;
+  grid.m_component = component;
+  grid.m_timePoint = timePoint;
+  grid.m_cellSize = cellSize;
+  grid.m_dimensions = image.header().pixelDimensions();
+
+  // Cells span the intervals between voxel centers, of which images that are one voxel thin have none
+  for (int a = 0; a < 3; ++a) {
+    grid.m_cellCounts[a] =
+      (grid.m_dimensions[a] < 2) ? 1u : (grid.m_dimensions[a] - 1 + cellSize - 1) / cellSize;
+  }
+
+  if (0 == grid.m_dimensions.x * grid.m_dimensions.y * grid.m_dimensions.z) {
+    return std::nullopt;
+  }
+
+  grid.m_minValues.assign(grid.numCells(), std::numeric_limits<double>::max());
+  grid.m_maxValues.assign(grid.numCells(), std::numeric_limits<double>::lowest());
+
+  if (!grid.computeCells(image, glm::uvec3{0}, grid.m_cellCounts, numThreads)) {
+    return std::nullopt;
+  }
+
+  return grid;
+}
+
+bool ImageMacrocellGrid::update(
+  const Image& image,
+  const glm::uvec3& voxelOffset,
+  const glm::uvec3& voxelSize,
+  unsigned int numThreads)
+{
+  if (image.header().pixelDimensions() != m_dimensions) {
+    return false;
+  }
+
+  if (0 == voxelSize.x * voxelSize.y * voxelSize.z) {
+    return true;
+  }
+
+  // Voxels on cell faces belong to the cells on both sides of the face
+  glm::uvec3 cellBegin{0};
+  glm::uvec3 cellEnd{0};
+
+  for (int a = 0; a < 3; ++a) {
+    const uint32_t first = std::min(voxelOffset[a], m_dimensions[a] - 1);
+    const uint32_t last = std::min(voxelOffset[a] + voxelSize[a] - 1, m_dimensions[a] - 1);
+    cellBegin[a] = (0 == first) ? 0 : (first - 1) / m_cellSize;
+    cellEnd[a] = std::min(last / m_cellSize + 1, m_cellCounts[a]);
+  }
+
+  return computeCells(image, cellBegin, cellEnd, numThreads);
+}
+
+bool ImageMacrocellGrid::computeCells(
+  const Image& image,
+  const glm::uvec3& cellBegin,
+  const glm::uvec3& cellEnd,
+  unsigned int numThreads)
+{
+  const glm::ivec3 dims{m_dimensions};
+  const int cellSize = static_cast<int>(m_cellSize);
+
+  return image.visitComponentView(m_component, m_timePoint, [&](const auto& view) {
+    parallel::forEachSlab(
+      numThreads,
+      static_cast<int>(cellBegin.z),
+      static_cast<int>(cellEnd.z),
+      [&](unsigned int, int czBegin, int czEnd) {
+        for (uint32_t cz = static_cast<uint32_t>(czBegin); cz < static_cast<uint32_t>(czEnd); ++cz) {
+          for (uint32_t cy = cellBegin.y; cy < cellEnd.y; ++cy) {
+            for (uint32_t cx = cellBegin.x; cx < cellEnd.x; ++cx) {
+              const glm::ivec3 lo = glm::ivec3{glm::uvec3{cx, cy, cz}} * cellSize;
+              const glm::ivec3 hi = glm::min(lo + cellSize, dims - 1);
+
+              double minValue = std::numeric_limits<double>::max();
+              double maxValue = std::numeric_limits<double>::lowest();
+
+              for (int k = lo.z; k <= hi.z; ++k) {
+                for (int j = lo.y; j <= hi.y; ++j) {
+                  for (int i = lo.x; i <= hi.x; ++i) {
+                    const double value = static_cast<double>(view.at(
+                      static_cast<std::size_t>(i), static_cast<std::size_t>(j), static_cast<std::size_t>(k)));
+                    minValue = std::min(minValue, value);
+                    maxValue = std::max(maxValue, value);
+                  }
+                }
+              }
+
+              const std::size_t c = cellIndex(glm::uvec3{cx, cy, cz});
+              m_minValues[c] = minValue;
+              m_maxValues[c] = maxValue;
+            }
+          }
+        }
+      });
+  });
+}
+
+uint32_t ImageMacrocellGrid::component() const
+{
+  return m_component;
+}
+
+uint32_t ImageMacrocellGrid::timePoint() const
+{
+  return m_timePoint;
+}
+
+uint32_t ImageMacrocellGrid::cellSize() const
+{
+  return m_cellSize;
+}
+
+const glm::uvec3& ImageMacrocellGrid::dimensions() const
+{
+  return m_dimensions;
+}
+
+const glm::uvec3& ImageMacrocellGrid::cellCounts() const
+{
+  return m_cellCounts;
+}
+
+std::size_t ImageMacrocellGrid::numCells() const
+{
+  return static_cast<std::size_t>(m_cellCounts.x) * m_cellCounts.y * m_cellCounts.z;
+}
+
+std::size_t ImageMacrocellGrid::cellIndex(const glm::uvec3& cell) const
+{
+  return (static_cast<std::size_t>(cell.z) * m_cellCounts.y + cell.y) * m_cellCounts.x + cell.x;
+}
+
+glm::uvec3 ImageMacrocellGrid::cellAt(const glm::vec3& voxelPos) const
+{
+  const glm::vec3 cell = glm::floor(voxelPos / static_cast<float>(m_cellSize));
+  return glm::uvec3{glm::clamp(cell, glm::vec3{0.0f}, glm::vec3{m_cellCounts} - 1.0f)};
+}
+
+double ImageMacrocellGrid::minValue(std::size_t cell) const
+{
+  return m_minValues[cell];
+}
+
+double ImageMacrocellGrid::maxValue(std::size_t cell) const
+{
+  return m_maxValues[cell];
+}
+
+bool ImageMacrocellGrid::isActive(std::size_t cell, std::span<const double> isoValues) const
+{
+  // The surface separates values below the isovalue from values at or above it
+  const double lo = widen(m_minValues[cell], -1.0);
+  const double hi = widen(m_maxValues[cell], 1.0);
+
+  return std::ranges::any_of(isoValues, [lo, hi](double isoValue) { return lo < isoValue && isoValue <= hi; });
+}
+
+std::optional<float> ImageMacrocellGrid::firstActiveRayParameter(
+  const glm::vec3& voxelRayOrigin,
+  const glm::vec3& voxelRayDirection,
+  float tBegin,
+  float tEnd,
+  std::span<const double> isoValues) const
+{
+  const glm::vec3 absDirection = glm::abs(voxelRayDirection);
+  const float maxDirection = std::max({absDirection.x, absDirection.y, absDirection.z});
+  if (!(maxDirection > 0.0f) || m_minValues.empty()) {
+    return std::nullopt;
+  }
+
+  const float faceStep = sk_faceStep / maxDirection;
+  const float cellSize = static_cast<float>(m_cellSize);
+
+  float entryT = tBegin; // Where the ray enters the current cell, minus the face step
+  float t = tBegin;      // Where the current cell is looked up
+
+  // A ray crosses at most this many cells
+  const uint32_t maxSteps = 2 * (m_cellCounts.x + m_cellCounts.y + m_cellCounts.z) + 8;
+
+  for (uint32_t step = 0; step < maxSteps && entryT <= tEnd; ++step) {
+    const glm::uvec3 cell = cellAt(voxelRayOrigin + t * voxelRayDirection);
+    if (isActive(cellIndex(cell), isoValues)) {
+      return std::max(tBegin, entryT);
+    }
+
+    // The outer faces of the first and last cells extend to infinity
+    float exitT = std::numeric_limits<float>::infinity();
+    for (int a = 0; a < 3; ++a) {
+      if (voxelRayDirection[a] > 0.0f && cell[a] + 1 < m_cellCounts[a]) {
+        exitT = std::min(exitT, ((cell[a] + 1) * cellSize - voxelRayOrigin[a]) / voxelRayDirection[a]);
+      }
+      else if (voxelRayDirection[a] < 0.0f && cell[a] > 0) {
+        exitT = std::min(exitT, (cell[a] * cellSize - voxelRayOrigin[a]) / voxelRayDirection[a]);
+      }
+    }
+
+    if (!std::isfinite(exitT)) {
+      return std::nullopt; // The ray leaves the grid
+    }
+
+    entryT = std::max(exitT, t) - faceStep;
+    t = std::max(std::max(exitT, t) + faceStep, std::nextafter(t, std::numeric_limits<float>::infinity()));
+  }
+
+  return std::nullopt;
+}
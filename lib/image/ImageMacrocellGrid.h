@@ -0,0 +1,117 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+class Image;
+
+/**
+ * @brief Grid of the minimum and maximum values of blocks of voxels (macrocells) of one image component,
+ * which lets isosurface raycasting and picking skip the parts of rays that no isosurface can cross.
+ *
+ * Cell c covers the continuous voxel coordinates [c * cellSize, (c + 1) * cellSize] along each axis, so its
+ * range includes the voxels on its upper faces, which it shares with the next cells, and bounds all values
+ * that linear interpolation produces inside of it. The first and last cells along each axis also cover the
+ * half voxel between the outermost voxel centers and the image boundary.
+ *
+ * The grid is built in one parallel pass over one time point of the component and is then kept current by
+ * recomputing only the cells that overlap changed regions of the image.
+ */
+class ImageMacrocellGrid
+{
+public:
+  static constexpr uint32_t sk_defaultCellSize = 8; //!< Default number of voxels along each side of a cell
+
+  /**
+   * @brief Compute the cell ranges of one component of one time point of an image.
+   * @param cellSize Number of voxels along each side of a cell.
+   * @param numThreads Maximum number of threads, each of which computes a slab of cells.
+   * @return The grid, or std::nullopt if the component, time point or cell size is invalid.
+   */
+  static std::optional<ImageMacrocellGrid> build(
+    const Image& image,
+    uint32_t component,
+    uint32_t timePoint = 0,
+    uint32_t cellSize = sk_defaultCellSize,
+    unsigned int numThreads = std::thread::hardware_concurrency());
+
+  /**
+   * @brief Recompute the cells that overlap a changed region of the image.
+   * @param image Image from which the grid was built, with the changed values.
+   * @param voxelOffset First voxel of the changed region.
+   * @param voxelSize Size of the changed region in voxels.
+   * @return False if the image dimensions no longer match the grid or its values cannot be read.
+   */
+  bool update(
+    const Image& image,
+    const glm::uvec3& voxelOffset,
+    const glm::uvec3& voxelSize,
+    unsigned int numThreads = std::thread::hardware_concurrency());
+
+  uint32_t component() const;
+  uint32_t timePoint() const;
+  uint32_t cellSize() const;
+
+  /// @brief Get the voxel dimensions of the image.
+  const glm::uvec3& dimensions() const;
+
+  /// @brief Get the number of cells along each axis.
+  const glm::uvec3& cellCounts() const;
+
+  std::size_t numCells() const;
+
+  /// @brief Get the index of a cell, in x-fastest order.
+  std::size_t cellIndex(const glm::uvec3& cell) const;
+
+  /// @brief Get the cell that contains a position in continuous voxel coordinates, clamped to the grid.
+  glm::uvec3 cellAt(const glm::vec3& voxelPos) const;
+
+  double minValue(std::size_t cell) const;
+  double maxValue(std::size_t cell) const;
+
+  /// @brief Test whether the isosurface of any of the values may cross a cell.
+  bool isActive(std::size_t cell, std::span<const double> isoValues) const;
+
+  /**
+   * @brief Step through the cells along a ray (3D DDA) to find where it first enters a cell that the
+   * isosurface of any of the values may cross.
+   * @param voxelRayOrigin Ray origin in continuous voxel coordinates.
+   * @param voxelRayDirection Ray direction in continuous voxel coordinates. The points of the ray are
+   * origin + t * direction.
+   * @param tBegin Ray parameter from which to search.
+   * @param tEnd Ray parameter up to which to search.
+   * @return Ray parameter in [tBegin, tEnd] at which (or slightly before which) the ray enters an active
+   * cell, or std::nullopt if all cells between tBegin and tEnd are inactive.
+   */
+  std::optional<float> firstActiveRayParameter(
+    const glm::vec3& voxelRayOrigin,
+    const glm::vec3& voxelRayDirection,
+    float tBegin,
+    float tEnd,
+    std::span<const double> isoValues) const;
+
+private:
+  ImageMacrocellGrid() = default;
+
+  /// Compute the ranges of the cells [cellBegin, cellEnd) of the grid
+  bool computeCells(
+    const Image& image,
+    const glm::uvec3& cellBegin,
+    const glm::uvec3& cellEnd,
+    unsigned int numThreads);
+
+  uint32_t m_component = 0;
+  uint32_t m_timePoint = 0;
+  uint32_t m_cellSize = sk_defaultCellSize;
+
+  glm::uvec3 m_dimensions{0};
+  glm::uvec3 m_cellCounts{0};
+  std::vector<double> m_minValues; //!< Minimum value of each cell, in x-fastest cell order
+  std::vector<double> m_maxValues; //!< Maximum value of each cell, in x-fastest cell order
+};
@@ -0,0 +1,397 @@
+#include "image/ImageQuantileIndex.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+
+namespace
+{
+constexpr uint32_t k_signBit = 0x80000000u;
+
+template<typename T>
+constexpr ComponentType componentTypeOf()
+{
+  if constexpr (std::is_same_v<T, int8_t>) {
+    return ComponentType::Int8;
+  }
+  else if constexpr (std::is_same_v<T, uint8_t>) {
+    return ComponentType::UInt8;
+  }
+  else if constexpr (std::is_same_v<T, int16_t>) {
+    return ComponentType::Int16;
+  }
+  else if constexpr (std::is_same_v<T, uint16_t>) {
+    return ComponentType::UInt16;
+  }
+  else if constexpr (std::is_same_v<T, int32_t>) {
+    return ComponentType::Int32;
+  }
+  else if constexpr (std::is_same_v<T, uint32_t>) {
+    return ComponentType::UInt32;
+  }
+  else {
+    static_assert(std::is_same_v<T, float>, "Unsupported quantile index component type");
+    return ComponentType::Float32;
+  }
+}
+
+/// Order-preserving key of a component value: key(a) < key(b) iff a < b
+template<typename T>
+uint32_t keyOf(T value)
+{
+  if constexpr (std::is_same_v<T, float>) {
+    // Index negative zero as positive zero, as they compare equal
+    const uint32_t bits = std::bit_cast<uint32_t>(value == 0.0f ? 0.0f : value);
+    return (bits & k_signBit) ? ~bits : (bits | k_signBit);
+  }
+  else if constexpr (std::is_same_v<T, int32_t>) {
+    return static_cast<uint32_t>(value) ^ k_signBit;
+  }
+  else if constexpr (std::is_signed_v<T>) {
+    return static_cast<uint32_t>(static_cast<int32_t>(value) - std::numeric_limits<T>::lowest());
+  }
+  else {
+    return static_cast<uint32_t>(value);
+  }
+}
+
+template<typename T>
+T valueOfKey(uint32_t key)
+{
+  if constexpr (std::is_same_v<T, float>) {
+    return std::bit_cast<float>((key & k_signBit) ? (key & ~k_signBit) : ~key);
+  }
+  else if constexpr (std::is_same_v<T, int32_t>) {
+    return static_cast<int32_t>(key ^ k_signBit);
+  }
+  else if constexpr (std::is_signed_v<T>) {
+    return static_cast<T>(static_cast<int32_t>(key) + std::numeric_limits<T>::lowest());
+  }
+  else {
+    return static_cast<T>(key);
+  }
+}
+
+/**
+ * @brief Convert a query value to the bound on keys that are counted by a query
+ *
+ * The query counts the keys less than the bound: keys of values less than the query value,
+ * or also equal to it when inclusive. Rounding is towards the counted side of the open or closed
+ * bound, so fractional queries on integer components and queries outside of the range of the
+ * component type count the right values.
+ *
+ * @return False iff the query value is NaN
+ */
+template<typename T>
+bool keyBoundAs(double value, bool inclusive, uint64_t& bound)
+{
+  constexpr uint64_t allKeys = uint64_t{1} << 32;
+
+  if (std::isnan(value)) {
+    return false;
+  }
+
+  if constexpr (std::is_same_v<T, float>) {
+    constexpr double maxFloat = std::numeric_limits<float>::max();
+    constexpr float inf = std::numeric_limits<float>::infinity();
+
+    // The nearest float, so that no float lies strictly between it and the query value
+    const float nearest = (value > maxFloat) ? inf : (value < -maxFloat) ? -inf : static_cast<float>(value);
+    const double rounded = static_cast<double>(nearest);
+    const bool countNearest = (rounded < value) || (inclusive && rounded == value);
+
+    bound = uint64_t{keyOf(nearest)} + (countNearest ? 1 : 0);
+  }
+  else {
+    constexpr double lowest = static_cast<double>(std::numeric_limits<T>::lowest());
+    constexpr double highest = static_cast<double>(std::numeric_limits<T>::max());
+
+    // Integers less than the value are those less than its ceiling;
+    // integers less than or equal to the value are those up to its floor
+    const double limit = inclusive ? std::floor(value) : std::ceil(value);
+
+    if (limit < lowest) {
+      bound = 0;
+    }
+    else if (limit > highest) {
+      bound = allKeys;
+    }
+    else {
+      bound = uint64_t{keyOf(static_cast<T>(limit))} + (inclusive ? 1 : 0);
+    }
+  }
+  return true;
+}
+} // namespace
+
+template<typename T>
+ImageQuantileIndex ImageQuantileIndex::build(const T* values, std::size_t count, std::size_t stride)
+{
+  ImageQuantileIndex index;
+  index.m_componentType = componentTypeOf<T>();
+  index.m_twoLevel = (4 == sizeof(T));
+
+  if (!values || 0 == stride) {
+    count = 0;
+  }
+
+  if (!index.m_twoLevel) {
+    // Counting histogram with one bin per representable value
+    constexpr std::size_t numKeys = std::size_t{1} << (8 * sizeof(T));
+    index.m_bucketStart.assign(numKeys + 1, 0);
+
+    for (std::size_t i = 0; i < count; ++i) {
+      ++index.m_bucketStart[keyOf(values[i * stride]) + 1];
+    }
+
+    std::partial_sum(index.m_bucketStart.begin(), index.m_bucketStart.end(), index.m_bucketStart.begin());
+    return index;
+  }
+
+  // First level: count values per high-16-bit bucket
+  std::vector<std::size_t> bucketCounts(k_bucketWidth, 0);
+  for (std::size_t i = 0; i < count; ++i) {
+    const T v = values[i * stride];
+    if constexpr (std::is_floating_point_v<T>) {
+      if (std::isnan(v)) {
+        continue;
+      }
+    }
+    ++bucketCounts[keyOf(v) >> 16];
+  }
+
+  index.m_bucketStart.assign(k_bucketWidth + 1, 0);
+  std::partial_sum(bucketCounts.begin(), bucketCounts.end(), index.m_bucketStart.begin() + 1);
+
+  // Keep each bucket's low key bits in whichever representation is smaller
+  constexpr std::size_t denseBytes = (k_bucketWidth + 1) * sizeof(uint64_t);
+
+  index.m_denseSlot.assign(k_bucketWidth, -1);
+  index.m_sparseOffset.assign(k_bucketWidth, 0);
+
+  std::size_t numSparse = 0;
+  int32_t numDense = 0;
+
+  for (std::size_t b = 0; b < k_bucketWidth; ++b) {
+    if (bucketCounts[b] * sizeof(uint16_t) > denseBytes) {
+      index.m_denseSlot[b] = numDense++;
+    }
+    else {
+      index.m_sparseOffset[b] = numSparse;
+      numSparse += bucketCounts[b];
+    }
+  }
+
+  index.m_sparseLowKeys.resize(numSparse);
+  index.m_denseCumulative.assign(static_cast<std::size_t>(numDense) * (k_bucketWidth + 1), 0);
+
+  // Second level: scatter the low key bits into their buckets
+  std::vector<std::size_t> cursor = index.m_sparseOffset;
+
+  for (std::size_t i = 0; i < count; ++i) {
+    const T v = values[i * stride];
+    if constexpr (std::is_floating_point_v<T>) {
+      if (std::isnan(v)) {
+        continue;
+      }
+    }
+
+    const uint32_t key = keyOf(v);
+    const uint32_t bucket = key >> 16;
+    const uint16_t low = static_cast<uint16_t>(key & 0xFFFFu);
+
+    if (const int32_t slot = index.m_denseSlot[bucket]; slot >= 0) {
+      ++index.m_denseCumulative[static_cast<std::size_t>(slot) * (k_bucketWidth + 1) + low + 1];
+    }
+    else {
+      index.m_sparseLowKeys[cursor[bucket]++] = low;
+    }
+  }
+
+  for (std::size_t b = 0; b < k_bucketWidth; ++b) {
+    if (const int32_t slot = index.m_denseSlot[b]; slot >= 0) {
+      const auto first = index.m_denseCumulative.begin() + static_cast<std::ptrdiff_t>(slot) * (k_bucketWidth + 1);
+      std::partial_sum(first, first + k_bucketWidth + 1, first);
+    }
+    else if (bucketCounts[b] > 1) {
+      const auto first = index.m_sparseLowKeys.begin() + static_cast<std::ptrdiff_t>(index.m_sparseOffset[b]);
+      std::sort(first, first + static_cast<std::ptrdiff_t>(bucketCounts[b]));
+    }
+  }
+
+  return index;
+}
+
+template ImageQuantileIndex ImageQuantileIndex::build<int8_t>(const int8_t*, std::size_t, std::size_t);
+template ImageQuantileIndex ImageQuantileIndex::build<uint8_t>(const uint8_t*, std::size_t, std::size_t);
+template ImageQuantileIndex ImageQuantileIndex::build<int16_t>(const int16_t*, std::size_t, std::size_t);
+template ImageQuantileIndex ImageQuantileIndex::build<uint16_t>(const uint16_t*, std::size_t, std::size_t);
+template ImageQuantileIndex ImageQuantileIndex::build<int32_t>(const int32_t*, std::size_t, std::size_t);
+template ImageQuantileIndex ImageQuantileIndex::build<uint32_t>(const uint32_t*, std::size_t, std::size_t);
+template ImageQuantileIndex ImageQuantileIndex::build<float>(const float*, std::size_t, std::size_t);
+
+ComponentType ImageQuantileIndex::componentType() const
+{
+  return m_componentType;
+}
+
+std::size_t ImageQuantileIndex::size() const
+{
+  return m_bucketStart.empty() ? 0 : m_bucketStart.back();
+}
+
+bool ImageQuantileIndex::empty() const
+{
+  return 0 == size();
+}
+
+double ImageQuantileIndex::valueAtRank(std::size_t rank) const
+{
+  const std::size_t n = size();
+  if (0 == n) {
+    return 0.0;
+  }
+
+  rank = std::min(rank, n - 1);
+
+  // The bucket holding the rank is the last one that starts at or before it
+  const auto it = std::upper_bound(m_bucketStart.begin(), m_bucketStart.end(), rank);
+  const auto bucket = static_cast<uint32_t>(std::distance(m_bucketStart.begin(), it) - 1);
+
+  if (!m_twoLevel) {
+    return decodeKey(bucket);
+  }
+
+  const std::size_t rankInBucket = rank - m_bucketStart[bucket];
+  uint32_t low = 0;
+
+  if (const int32_t slot = m_denseSlot[bucket]; slot >= 0) {
+    const uint64_t* cumulative = denseCumulative(slot);
+    const uint64_t* lowIt = std::upper_bound(cumulative, cumulative + k_bucketWidth + 1, rankInBucket);
+    low = static_cast<uint32_t>(lowIt - cumulative - 1);
+  }
+  else {
+    low = m_sparseLowKeys[m_sparseOffset[bucket] + rankInBucket];
+  }
+
+  return decodeKey((bucket << 16) | low);
+}
+
+std::size_t ImageQuantileIndex::countLess(double value) const
+{
+  uint64_t bound = 0;
+  if (!keyBound(value, false, bound)) {
+    return 0;
+  }
+  return countKeysLess(bound);
+}
+
+std::size_t ImageQuantileIndex::countLessOrEqual(double value) const
+{
+  uint64_t bound = 0;
+  if (!keyBound(value, true, bound)) {
+    return size();
+  }
+  return countKeysLess(bound);
+}
+
+double ImageQuantileIndex::min() const
+{
+  return valueAtRank(0);
+}
+
+double ImageQuantileIndex::max() const
+{
+  const std::size_t n = size();
+  return valueAtRank(n > 0 ? n - 1 : 0);
+}
+
+std::size_t ImageQuantileIndex::memoryUsageInBytes() const
+{
+  return m_bucketStart.capacity() * sizeof(std::size_t) + m_denseSlot.capacity() * sizeof(int32_t) +
+         m_sparseOffset.capacity() * sizeof(std::size_t) + m_sparseLowKeys.capacity() * sizeof(uint16_t) +
+         m_denseCumulative.capacity() * sizeof(uint64_t);
+}
+
+bool ImageQuantileIndex::keyBound(double value, bool inclusive, uint64_t& bound) const
+{
+  switch (m_componentType) {
+    case ComponentType::Int8:
+      return keyBoundAs<int8_t>(value, inclusive, bound);
+    case ComponentType::UInt8:
+      return keyBoundAs<uint8_t>(value, inclusive, bound);
+    case ComponentType::Int16:
+      return keyBoundAs<int16_t>(value, inclusive, bound);
+    case ComponentType::UInt16:
+      return keyBoundAs<uint16_t>(value, inclusive, bound);
+    case ComponentType::Int32:
+      return keyBoundAs<int32_t>(value, inclusive, bound);
+    case ComponentType::UInt32:
+      return keyBoundAs<uint32_t>(value, inclusive, bound);
+    case ComponentType::Float32:
+      return keyBoundAs<float>(value, inclusive, bound);
+    default:
+      return false;
+  }
+}
+
+double ImageQuantileIndex::decodeKey(uint32_t key) const
+{
+  switch (m_componentType) {
+    case ComponentType::Int8:
+      return static_cast<double>(valueOfKey<int8_t>(key));
+    case ComponentType::UInt8:
+      return static_cast<double>(valueOfKey<uint8_t>(key));
+    case ComponentType::Int16:
+      return static_cast<double>(valueOfKey<int16_t>(key));
+    case ComponentType::UInt16:
+      return static_cast<double>(valueOfKey<uint16_t>(key));
+    case ComponentType::Int32:
+      return static_cast<double>(valueOfKey<int32_t>(key));
+    case ComponentType::UInt32:
+      return static_cast<double>(valueOfKey<uint32_t>(key));
+    case ComponentType::Float32:
+      return static_cast<double>(valueOfKey<float>(key));
+    default:
+      return 0.0;
+  }
+}
+
+std::size_t ImageQuantileIndex::countKeysLess(uint64_t key) const
+{
+  if (m_bucketStart.empty()) {
+    return 0;
+  }
+
+  if (!m_twoLevel) {
+    return m_bucketStart[std::min<uint64_t>(key, m_bucketStart.size() - 1)];
+  }
+
+  if (key >= (uint64_t{1} << 32)) {
+    return size();
+  }
+
+  const auto bucket = static_cast<uint32_t>(key >> 16);
+  const auto low = static_cast<uint16_t>(key & 0xFFFFu);
+  const std::size_t base = m_bucketStart[bucket];
+  const std::size_t bucketSize = m_bucketStart[bucket + 1] - base;
+
+  if (0 == bucketSize) {
+    return base;
+  }
+
+  if (const int32_t slot = m_denseSlot[bucket]; slot >= 0) {
+    return base + static_cast<std::size_t>(denseCumulative(slot)[low]);
+  }
+
+  const uint16_t* first = m_sparseLowKeys.data() + m_sparseOffset[bucket];
+  return base + static_cast<std::size_t>(std::lower_bound(first, first + bucketSize, low) - first);
+}
+
+const uint64_t* ImageQuantileIndex::denseCumulative(int32_t slot) const
+{
+  return m_denseCumulative.data() + static_cast<std::size_t>(slot) * (k_bucketWidth + 1);
+}
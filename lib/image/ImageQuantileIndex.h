@@ -0,0 +1,154 @@
+#pragma once
+
+#include "common/Types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Exact rank index over the values of one image component.
+ *
+ * The index answers the same queries as a sorted copy of the component (value at a rank, and number
+ * of values below a value) without storing that copy. Values are mapped to order-preserving 32-bit
+ * keys and counted in histograms:
+ * - 8- and 16-bit components use one counting histogram with a bin per representable value.
+ * - 32-bit integer and float components use a two-level histogram. The first level counts values by
+ *   the high 16 bits of their key. Within each first-level bucket, the low 16 bits are kept either as
+ *   a sorted list (sparse buckets) or as a counting histogram (dense buckets), whichever is smaller.
+ *
+ * Memory use is at most 2 bytes per value for 32-bit types plus fixed-size first-level tables, and
+ * is independent of the number of values for 8- and 16-bit types.
+ *
+ * NaN values are not indexed, and negative zero is indexed as positive zero.
+ */
+class ImageQuantileIndex
+{
+public:
+  ImageQuantileIndex() = default;
+
+  /**
+   * @brief Build the index over strided component values.
+   * @tparam T Component type: one of int8_t, uint8_t, int16_t, uint16_t, int32_t, uint32_t, float.
+   * @param values Pointer to the first value.
+   * @param count Number of values to index.
+   * @param stride Distance in elements between consecutive values (the number of components for
+   * interleaved buffers).
+   */
+  template<typename T>
+  static ImageQuantileIndex build(const T* values, std::size_t count, std::size_t stride = 1);
+
+  /// @brief Component type of the indexed values.
+  ComponentType componentType() const;
+
+  /// @brief Number of indexed values.
+  std::size_t size() const;
+
+  /// @brief Return true when no values are indexed.
+  bool empty() const;
+
+  /**
+   * @brief Get the value that a sorted copy of the component would hold at a rank.
+   * @param rank Zero-based rank, clamped to [0, size() - 1].
+   */
+  double valueAtRank(std::size_t rank) const;
+
+  /// @brief Number of indexed values strictly less than \p value (the lower_bound position).
+  std::size_t countLess(double value) const;
+
+  /// @brief Number of indexed values less than or equal to \p value (the upper_bound position).
+  std::size_t countLessOrEqual(double value) const;
+
+  /// @brief Smallest indexed value.
+  double min() const;
+
+  /// @brief Largest indexed value.
+  double max() const;
+
+  /// @brief Approximate heap memory held by the index.
+  std::size_t memoryUsageInBytes() const;
+
+  /**
+   * @brief Visit the distinct indexed values in ascending order.
+   * @param visitor Callable as visitor(double value, std::size_t count).
+   */
+  template<typename Visitor>
+  void forEachValue(Visitor&& visitor) const
+  {
+    if (!m_twoLevel) {
+      for (std::size_t key = 0; key + 1 < m_bucketStart.size(); ++key) {
+        if (const std::size_t n = m_bucketStart[key + 1] - m_bucketStart[key]) {
+          visitor(decodeKey(static_cast<uint32_t>(key)), n);
+        }
+      }
+      return;
+    }
+
+    for (std::size_t bucket = 0; bucket + 1 < m_bucketStart.size(); ++bucket) {
+      const std::size_t begin = m_bucketStart[bucket];
+      const std::size_t end = m_bucketStart[bucket + 1];
+      if (begin == end) {
+        continue;
+      }
+
+      const uint32_t high = static_cast<uint32_t>(bucket) << 16;
+
+      if (const int32_t slot = m_denseSlot[bucket]; slot >= 0) {
+        const uint64_t* cumulative = denseCumulative(slot);
+        for (uint32_t low = 0; low < k_bucketWidth; ++low) {
+          if (const uint64_t n = cumulative[low + 1] - cumulative[low]) {
+            visitor(decodeKey(high | low), static_cast<std::size_t>(n));
+          }
+        }
+        continue;
+      }
+
+      const uint16_t* lowKeys = m_sparseLowKeys.data() + m_sparseOffset[bucket];
+      const std::size_t n = end - begin;
+      for (std::size_t i = 0; i < n;) {
+        std::size_t j = i + 1;
+        while (j < n && lowKeys[j] == lowKeys[i]) {
+          ++j;
+        }
+        visitor(decodeKey(high | lowKeys[i]), j - i);
+        i = j;
+      }
+    }
+  }
+
+private:
+  static constexpr uint32_t k_bucketWidth = 1u << 16;
+
+  /// Map a query value to the bound on the keys counted by countKeysLess, rounding integer
+  /// queries to the open (\p inclusive false) or closed bound. Returns false for NaN.
+  bool keyBound(double value, bool inclusive, uint64_t& bound) const;
+
+  /// Map an order-preserving key back to its value.
+  double decodeKey(uint32_t key) const;
+
+  /// Number of indexed values whose key is strictly less than \p key.
+  std::size_t countKeysLess(uint64_t key) const;
+
+  /// Cumulative low-key counts of one dense bucket (k_bucketWidth + 1 entries).
+  const uint64_t* denseCumulative(int32_t slot) const;
+
+  ComponentType m_componentType = ComponentType::Undefined;
+  bool m_twoLevel = false; //!< True for 32-bit component types
+
+  /// For single-level indices, the number of values with key less than each key. For two-level
+  /// indices, the number of values in buckets less than each first-level bucket. Has one more entry
+  /// than there are keys or buckets.
+  std::vector<std::size_t> m_bucketStart;
+
+  /// Two-level indices only: dense-storage slot of each bucket, or -1 for sparse buckets
+  std::vector<int32_t> m_denseSlot;
+
+  /// Two-level indices only: offset of each sparse bucket's run in m_sparseLowKeys
+  std::vector<std::size_t> m_sparseOffset;
+
+  /// Two-level indices only: sorted low 16 key bits of the values of every sparse bucket
+  std::vector<uint16_t> m_sparseLowKeys;
+
+  /// Two-level indices only: cumulative low-key counts of every dense bucket
+  std::vector<uint64_t> m_denseCumulative;
+};
@@ -6,7 +6,16 @@
 
 #include <spdlog/spdlog.h>
 
-#include <span>
+const ImageQuantileIndex& Image::exactQuantileIndex(uint32_t comp) const
+{
+  const ImageQuantileIndex* index = quantileIndex(comp);
+  if (!index || index->empty()) {
+    spdlog::error("Exact quantile index for image component {} has not been generated", comp);
+    throwDebug("Exact quantile index has not been generated");
+  }
+  return *index;
+}
+
 
 QuantileOfValue Image::valueToQuantile(uint32_t comp, int64_t value) const
 {
@@ -22,19 +31,19 @@ QuantileOfValue Image::valueToQuantile(uint32_t comp, int64_t value) const
   if (m_settings.usingExactQuantiles()) {
     switch (m_header.memoryComponentType()) {
       case ComponentType::Int8:
-        return convertValueToQuantile<int8_t>(std::span{m_dataSorted_int8[comp]}, static_cast<int8_t>(value));
+        return convertValueToQuantile<int8_t>(exactQuantileIndex(comp), static_cast<int8_t>(value));
       case ComponentType::UInt8:
-        return convertValueToQuantile<uint8_t>(std::span{m_dataSorted_uint8[comp]}, static_cast<uint8_t>(value));
+        return convertValueToQuantile<uint8_t>(exactQuantileIndex(comp), static_cast<uint8_t>(value));
       case ComponentType::Int16:
-        return convertValueToQuantile<int16_t>(std::span{m_dataSorted_int16[comp]}, static_cast<int16_t>(value));
+        return convertValueToQuantile<int16_t>(exactQuantileIndex(comp), static_cast<int16_t>(value));
       case ComponentType::UInt16:
-        return convertValueToQuantile<uint16_t>(std::span{m_dataSorted_uint16[comp]}, static_cast<uint16_t>(value));
+        return convertValueToQuantile<uint16_t>(exactQuantileIndex(comp), static_cast<uint16_t>(value));
       case ComponentType::Int32:
-        return convertValueToQuantile<int32_t>(std::span{m_dataSorted_int32[comp]}, static_cast<int32_t>(value));
+        return convertValueToQuantile<int32_t>(exactQuantileIndex(comp), static_cast<int32_t>(value));
       case ComponentType::UInt32:
-        return convertValueToQuantile<uint32_t>(std::span{m_dataSorted_uint32[comp]}, static_cast<uint32_t>(value));
+        return convertValueToQuantile<uint32_t>(exactQuantileIndex(comp), static_cast<uint32_t>(value));
       case ComponentType::Float32:
-        return convertValueToQuantile<float>(std::span{m_dataSorted_float32[comp]}, static_cast<float>(value));
+        return convertValueToQuantile<float>(exactQuantileIndex(comp), static_cast<float>(value));
       default:
         spdlog::error("Invalid memory component type '{}'", m_header.memoryComponentTypeAsString());
         throwDebug("Invalid memory component type");
@@ -68,19 +77,19 @@ QuantileOfValue Image::valueToQuantile(uint32_t comp, double value) const
   if (m_settings.usingExactQuantiles()) {
     switch (m_header.memoryComponentType()) {
       case ComponentType::Int8:
-        return convertValueToQuantile(std::span{m_dataSorted_int8[comp]}, static_cast<int8_t>(value));
+        return convertValueToQuantile<int8_t>(exactQuantileIndex(comp), static_cast<int8_t>(value));
       case ComponentType::UInt8:
-        return convertValueToQuantile(std::span{m_dataSorted_uint8[comp]}, static_cast<uint8_t>(value));
+        return convertValueToQuantile<uint8_t>(exactQuantileIndex(comp), static_cast<uint8_t>(value));
       case ComponentType::Int16:
-        return convertValueToQuantile(std::span{m_dataSorted_int16[comp]}, static_cast<int16_t>(value));
+        return convertValueToQuantile<int16_t>(exactQuantileIndex(comp), static_cast<int16_t>(value));
       case ComponentType::UInt16:
-        return convertValueToQuantile(std::span{m_dataSorted_uint16[comp]}, static_cast<uint16_t>(value));
+        return convertValueToQuantile<uint16_t>(exactQuantileIndex(comp), static_cast<uint16_t>(value));
       case ComponentType::Int32:
-        return convertValueToQuantile(std::span{m_dataSorted_int32[comp]}, static_cast<int32_t>(value));
+        return convertValueToQuantile<int32_t>(exactQuantileIndex(comp), static_cast<int32_t>(value));
       case ComponentType::UInt32:
-        return convertValueToQuantile(std::span{m_dataSorted_uint32[comp]}, static_cast<uint32_t>(value));
+        return convertValueToQuantile<uint32_t>(exactQuantileIndex(comp), static_cast<uint32_t>(value));
       case ComponentType::Float32:
-        return convertValueToQuantile(std::span{m_dataSorted_float32[comp]}, static_cast<float>(value));
+        return convertValueToQuantile<float>(exactQuantileIndex(comp), static_cast<float>(value));
       default:
         spdlog::error("Invalid memory component type '{}'", m_header.memoryComponentTypeAsString());
         throwDebug("Invalid memory component type");
@@ -114,19 +123,19 @@ double Image::quantileToValue(uint32_t comp, double quantile) const
   if (m_settings.usingExactQuantiles()) {
     switch (m_header.memoryComponentType()) {
       case ComponentType::Int8:
-        return static_cast<double>(convertQuantileToValue(std::span{m_dataSorted_int8[comp]}, quantile));
+        return static_cast<double>(convertQuantileToValue<int8_t>(exactQuantileIndex(comp), quantile));
       case ComponentType::UInt8:
-        return static_cast<double>(convertQuantileToValue(std::span{m_dataSorted_uint8[comp]}, quantile));
+        return static_cast<double>(convertQuantileToValue<uint8_t>(exactQuantileIndex(comp), quantile));
       case ComponentType::Int16:
-        return static_cast<double>(convertQuantileToValue(std::span{m_dataSorted_int16[comp]}, quantile));
+        return static_cast<double>(convertQuantileToValue<int16_t>(exactQuantileIndex(comp), quantile));
       case ComponentType::UInt16:
-        return static_cast<double>(convertQuantileToValue(std::span{m_dataSorted_uint16[comp]}, quantile));
+        return static_cast<double>(convertQuantileToValue<uint16_t>(exactQuantileIndex(comp), quantile));
       case ComponentType::Int32:
-        return static_cast<double>(convertQuantileToValue(std::span{m_dataSorted_int32[comp]}, quantile));
+        return static_cast<double>(convertQuantileToValue<int32_t>(exactQuantileIndex(comp), quantile));
       case ComponentType::UInt32:
-        return static_cast<double>(convertQuantileToValue(std::span{m_dataSorted_uint32[comp]}, quantile));
+        return static_cast<double>(convertQuantileToValue<uint32_t>(exactQuantileIndex(comp), quantile));
       case ComponentType::Float32:
-        return static_cast<double>(convertQuantileToValue(std::span{m_dataSorted_float32[comp]}, quantile));
+        return static_cast<double>(convertQuantileToValue<float>(exactQuantileIndex(comp), quantile));
       default:
         spdlog::error("Invalid memory component type '{}'", m_header.memoryComponentTypeAsString());
         throwDebug("Invalid memory component type");
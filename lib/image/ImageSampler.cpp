@@ -0,0 +1,346 @@
+#include "image/ImageSampler.h"
+#include "image/Image.h"
+
+#include <spdlog/spdlog.h>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+/// Number of points whose stencils are computed before their values are gathered
+constexpr std::size_t k_blockSize = 64;
+
+/// Smallest number of points given to each sampling thread
+constexpr std::size_t k_minPointsPerThread = 16384;
+
+enum class PointState : uint8_t
+{
+  Inside,  //!< Sampled from the image
+  Invalid, //!< Not sampled and marked invalid
+  Outside  //!< Not sampled, but valid with the constant outside value
+};
+
+/// Interpolation stencils of a block of points, stored as one array per field so that the stencil and
+/// blending loops vectorize
+struct StencilBlock
+{
+  std::array<std::size_t, k_blockSize> base;  //!< Element offset of the lower corner pixel
+  std::array<std::size_t, k_blockSize> stepX; //!< Element offset to the upper neighbor along x, or 0
+  std::array<std::size_t, k_blockSize> stepY;
+  std::array<std::size_t, k_blockSize> stepZ;
+  std::array<double, k_blockSize> wx; //!< Weight of the upper neighbor along x
+  std::array<double, k_blockSize> wy;
+  std::array<double, k_blockSize> wz;
+  std::array<PointState, k_blockSize> state;
+};
+
+/// Pixel dimensions and element strides shared by all sampled component views
+struct SamplingGrid
+{
+  glm::u64vec3 dims{0};
+  std::array<std::size_t, 3> strides{0, 0, 0};
+};
+
+void computeStencil(
+  const SamplingGrid& grid,
+  const ImageSamplerOptions& options,
+  const glm::vec3& position,
+  StencilBlock& block,
+  std::size_t i)
+{
+  block.base[i] = 0;
+  block.stepX[i] = block.stepY[i] = block.stepZ[i] = 0;
+  block.wx[i] = block.wy[i] = block.wz[i] = 0.0;
+
+  const std::array<double, 3> coord{position.x, position.y, position.z};
+
+  bool inside = true;
+  for (int a = 0; a < 3; ++a) {
+    if (std::isnan(coord[a])) {
+      block.state[i] = PointState::Invalid;
+      return;
+    }
+    inside &= (coord[a] >= -0.5 && coord[a] <= static_cast<double>(grid.dims[a]) - 0.5);
+  }
+
+  if (!inside) {
+    if (SampleBoundary::Invalid == options.boundary) {
+      block.state[i] = PointState::Invalid;
+      return;
+    }
+    if (SampleBoundary::Constant == options.boundary) {
+      block.state[i] = PointState::Outside;
+      return;
+    }
+  }
+
+  std::array<std::size_t*, 3> steps{&block.stepX[i], &block.stepY[i], &block.stepZ[i]};
+  std::array<double*, 3> weights{&block.wx[i], &block.wy[i], &block.wz[i]};
+
+  for (int a = 0; a < 3; ++a) {
+    // Coordinates are clamped to the edge pixels, which are at 0 and N - 1
+    const double x = std::clamp(coord[a], 0.0, static_cast<double>(grid.dims[a] - 1));
+
+    if (SampleInterpolation::Nearest == options.interpolation) {
+      block.base[i] += static_cast<std::size_t>(std::floor(x + 0.5)) * grid.strides[a];
+      continue;
+    }
+
+    // The upper neighbor only falls outside the image when the coordinate is on the last pixel,
+    // where its weight is zero. It is then replaced by the lower neighbor.
+    const double f = std::floor(x);
+    const std::size_t index = static_cast<std::size_t>(f);
+    block.base[i] += index * grid.strides[a];
+    *steps[a] = (index + 1 < grid.dims[a]) ? grid.strides[a] : 0;
+    *weights[a] = x - f;
+  }
+
+  block.state[i] = PointState::Inside;
+}
+
+/**
+ * @brief Gather and blend the values of one component for a block of points.
+ * @param[out] values Point-major output values of the first point of the block.
+ */
+template<typename T>
+void sampleComponentBlock(
+  const T* data,
+  const StencilBlock& block,
+  std::size_t numPoints,
+  const ImageSamplerOptions& options,
+  uint32_t component,
+  double* values)
+{
+  const std::size_t numComponents = options.numComponents;
+
+  if (SampleInterpolation::Nearest == options.interpolation) {
+    for (std::size_t i = 0; i < numPoints; ++i) {
+      values[i * numComponents + component] = (PointState::Inside == block.state[i])
+                                                ? static_cast<double>(data[block.base[i]])
+                                                : options.outsideValue;
+    }
+    return;
+  }
+
+  for (std::size_t i = 0; i < numPoints; ++i) {
+    if (PointState::Inside != block.state[i]) {
+      values[i * numComponents + component] = options.outsideValue;
+      continue;
+    }
+
+    const T* p = data + block.base[i];
+    const std::size_t sx = block.stepX[i];
+    const std::size_t sy = block.stepY[i];
+    const std::size_t sz = block.stepZ[i];
+    const double wx = block.wx[i];
+    const double wy = block.wy[i];
+    const double wz = block.wz[i];
+
+    auto lerp = [](double a, double b, double w) { return a * (1.0 - w) + b * w; };
+
+    const double c00 = lerp(static_cast<double>(p[0]), static_cast<double>(p[sx]), wx);
+    const double c10 = lerp(static_cast<double>(p[sy]), static_cast<double>(p[sy + sx]), wx);
+    const double c01 = lerp(static_cast<double>(p[sz]), static_cast<double>(p[sz + sx]), wx);
+    const double c11 = lerp(static_cast<double>(p[sz + sy]), static_cast<double>(p[sz + sy + sx]), wx);
+
+    values[i * numComponents + component] = lerp(lerp(c00, c10, wy), lerp(c01, c11, wy), wz);
+  }
+}
+
+/// Sample all components at points [begin, end)
+template<typename T>
+void samplePointRange(
+  const std::vector<const T*>& componentData,
+  const SamplingGrid& grid,
+  const ImageSamplerOptions& options,
+  std::span<const glm::vec3> positions,
+  std::size_t begin,
+  std::size_t end,
+  ImageSamples& samples)
+{
+  StencilBlock block;
+
+  for (std::size_t first = begin; first < end; first += k_blockSize) {
+    const std::size_t n = std::min(k_blockSize, end - first);
+
+    for (std::size_t i = 0; i < n; ++i) {
+      computeStencil(grid, options, positions[first + i], block, i);
+      samples.valid[first + i] = (PointState::Invalid != block.state[i]) ? 1u : 0u;
+    }
+
+    double* values = samples.values.data() + first * options.numComponents;
+    for (uint32_t c = 0; c < options.numComponents; ++c) {
+      sampleComponentBlock(componentData[c], block, n, options, c, values);
+    }
+  }
+}
+
+bool isValidComponentRange(const Image& image, const ImageSamplerOptions& options)
+{
+  const uint32_t numImageComponents = image.header().numComponentsPerPixel();
+  if (
+    0 == options.numComponents || options.firstComponent >= numImageComponents ||
+    options.numComponents > numImageComponents - options.firstComponent)
+  {
+    spdlog::error(
+      "Cannot sample components [{}, {}) of image with {} components",
+      options.firstComponent,
+      options.firstComponent + options.numComponents,
+      numImageComponents);
+    return false;
+  }
+  return true;
+}
+
+unsigned int samplingThreadCount(std::size_t numPoints, unsigned int maxThreads)
+{
+  if (0 == maxThreads) {
+    maxThreads = std::max(std::thread::hardware_concurrency() - 1, 1u);
+  }
+  return static_cast<unsigned int>(
+    std::clamp<std::size_t>(numPoints / k_minPointsPerThread, 1, static_cast<std::size_t>(maxThreads)));
+}
+} // namespace
+
+std::optional<ImageSamples> sampleImageAtPixels(
+  const Image& image,
+  std::span<const glm::vec3> pixelPositions,
+  const ImageSamplerOptions& options)
+{
+  if (!isValidComponentRange(image, options)) {
+    return std::nullopt;
+  }
+
+  ImageSamples samples;
+  samples.numComponents = options.numComponents;
+  samples.values.resize(pixelPositions.size() * options.numComponents);
+  samples.valid.resize(pixelPositions.size());
+
+  bool sampled = false;
+
+  image.visitComponentView(
+    options.firstComponent,
+    options.timePoint,
+    [&]<typename T>(const ImageView<T>& firstView) {
+      using ValueType = typename ImageView<T>::value_type;
+
+      // All components of the image share dimensions, layout and strides
+      std::vector<const ValueType*> componentData{firstView.data()};
+      for (uint32_t c = 1; c < options.numComponents; ++c) {
+        const auto view = image.view<ValueType>(options.firstComponent + c, options.timePoint);
+        if (!view) {
+          return;
+        }
+        componentData.push_back(view->data());
+      }
+
+      SamplingGrid grid;
+      grid.dims = firstView.dimensions();
+      grid.strides = {firstView.pixelStride(), firstView.rowStride(), firstView.sliceStride()};
+
+      const std::size_t numPoints = pixelPositions.size();
+      const unsigned int numThreads = samplingThreadCount(numPoints, options.maxThreads);
+
+      sampled = true;
+
+      if (1 == numThreads) {
+        samplePointRange(componentData, grid, options, pixelPositions, 0, numPoints, samples);
+        return;
+      }
+
+      // Thread ranges are whole blocks, so no two threads write the same output values
+      const std::size_t numBlocks = (numPoints + k_blockSize - 1) / k_blockSize;
+      const std::size_t blocksPerThread = (numBlocks + numThreads - 1) / numThreads;
+
+      std::vector<std::thread> threads;
+      threads.reserve(numThreads);
+      for (unsigned int t = 0; t < numThreads; ++t) {
+        const std::size_t begin = std::min(numPoints, t * blocksPerThread * k_blockSize);
+        const std::size_t end = std::min(numPoints, begin + blocksPerThread * k_blockSize);
+        threads.emplace_back([&, begin, end]() {
+          samplePointRange(componentData, grid, options, pixelPositions, begin, end, samples);
+        });
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+    });
+
+  if (!sampled) {
+    return std::nullopt;
+  }
+
+  return samples;
+}
+
+std::optional<ImageSamples> sampleImageAtWorld(
+  const Image& image,
+  std::span<const glm::vec3> worldPositions,
+  const ImageSamplerOptions& options)
+{
+  const glm::mat4& pixel_T_worldDef = image.transformations().pixel_T_worldDef();
+
+  std::vector<glm::vec3> pixelPositions;
+  pixelPositions.reserve(worldPositions.size());
+  for (const glm::vec3& worldPos : worldPositions) {
+    const glm::vec4 pixelPos = pixel_T_worldDef * glm::vec4{worldPos, 1.0f};
+    pixelPositions.emplace_back(glm::vec3{pixelPos} / pixelPos.w);
+  }
+
+  return sampleImageAtPixels(image, pixelPositions, options);
+}
+
+bool sampleImageAtPixel(
+  const Image& image,
+  const glm::vec3& pixelPosition,
+  std::span<double> values,
+  const ImageSamplerOptions& options)
+{
+  if (values.size() < options.numComponents || !isValidComponentRange(image, options)) {
+    return false;
+  }
+
+  bool valid = false;
+
+  image.visitComponentView(
+    options.firstComponent,
+    options.timePoint,
+    [&]<typename T>(const ImageView<T>& firstView) {
+      using ValueType = typename ImageView<T>::value_type;
+
+      SamplingGrid grid;
+      grid.dims = firstView.dimensions();
+      grid.strides = {firstView.pixelStride(), firstView.rowStride(), firstView.sliceStride()};
+
+      StencilBlock block;
+      computeStencil(grid, options, pixelPosition, block, 0);
+
+      sampleComponentBlock(firstView.data(), block, 1, options, 0, values.data());
+      for (uint32_t c = 1; c < options.numComponents; ++c) {
+        const auto view = image.view<ValueType>(options.firstComponent + c, options.timePoint);
+        if (!view) {
+          return;
+        }
+        sampleComponentBlock(view->data(), block, 1, options, c, values.data());
+      }
+
+      valid = (PointState::Invalid != block.state[0]);
+    });
+
+  return valid;
+}
+
+bool sampleImageAtWorldPoint(
+  const Image& image,
+  const glm::vec3& worldPosition,
+  std::span<double> values,
+  const ImageSamplerOptions& options)
+{
+  const glm::vec4 pixelPos = image.transformations().pixel_T_worldDef() * glm::vec4{worldPosition, 1.0f};
+  return sampleImageAtPixel(image, glm::vec3{pixelPos} / pixelPos.w, values, options);
+}
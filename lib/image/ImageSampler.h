@@ -0,0 +1,129 @@
+#pragma once
+
+#include <glm/fwd.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+class Image;
+
+/**
+ * @brief Interpolation used when sampling an image at continuous pixel coordinates.
+ */
+enum class SampleInterpolation
+{
+  Nearest, //!< Value of the nearest pixel
+  Linear   //!< Trilinear interpolation of the eight surrounding pixels
+};
+
+/**
+ * @brief Handling of positions outside the image. Pixel coordinates are inside the image when they
+ * lie in the half-voxel-extended range [-0.5, N - 0.5] along every axis.
+ */
+enum class SampleBoundary
+{
+  Invalid,     //!< Mark the sample invalid
+  ClampToEdge, //!< Clamp the position to the image and sample the edge pixels
+  Constant     //!< Return ImageSamplerOptions::outsideValue as a valid sample
+};
+
+/**
+ * @brief Options for batched image sampling.
+ */
+struct ImageSamplerOptions
+{
+  SampleInterpolation interpolation = SampleInterpolation::Linear;
+  SampleBoundary boundary = SampleBoundary::Invalid;
+  double outsideValue = 0.0;   //!< Value of invalid and constant-boundary samples
+  uint32_t timePoint = 0;      //!< Image time point to sample
+  uint32_t firstComponent = 0; //!< First image component to sample
+  uint32_t numComponents = 1;  //!< Number of consecutive components to sample
+  unsigned int maxThreads = 0; //!< Maximum number of threads; 0 picks a count from the hardware
+};
+
+/**
+ * @brief Values sampled from an image at a batch of positions.
+ */
+struct ImageSamples
+{
+  uint32_t numComponents = 0;
+
+  /// Sampled values in point-major order: values[point * numComponents + component]
+  std::vector<double> values;
+
+  /// One flag per point: non-zero when the point was sampled inside the image or by the boundary rule
+  std::vector<uint8_t> valid;
+
+  std::size_t size() const
+  {
+    return valid.size();
+  }
+
+  bool isValid(std::size_t point) const
+  {
+    return 0 != valid[point];
+  }
+
+  double value(std::size_t point, uint32_t component = 0) const
+  {
+    return values[point * numComponents + component];
+  }
+};
+
+/**
+ * @brief Sample image components at a batch of continuous pixel coordinates.
+ *
+ * The memory component type, buffer layout and component addresses are resolved once for the whole
+ * batch. Points are processed in blocks that compute all interpolation offsets and weights before
+ * gathering values, and large batches are split across threads. With linear interpolation and the
+ * Invalid boundary rule, each sample equals Image::valueLinear() at the same coordinates.
+ *
+ * @param image Image to sample.
+ * @param pixelPositions Positions in continuous pixel coordinates (pixel centers at integers).
+ * @param options Interpolation, boundary rule, time point and components to sample.
+ * @return Samples for every position, or std::nullopt when the image has no pixel data or the
+ * time point or component range is invalid.
+ */
+std::optional<ImageSamples> sampleImageAtPixels(
+  const Image& image,
+  std::span<const glm::vec3> pixelPositions,
+  const ImageSamplerOptions& options = {});
+
+/**
+ * @brief Sample image components at a batch of Deformed World space positions.
+ * @see sampleImageAtPixels
+ */
+std::optional<ImageSamples> sampleImageAtWorld(
+  const Image& image,
+  std::span<const glm::vec3> worldPositions,
+  const ImageSamplerOptions& options = {});
+
+/**
+ * @brief Sample image components at one continuous pixel coordinate, without allocating.
+ *
+ * This is the single-point form of sampleImageAtPixels() for callers that sample a few points per
+ * frame, such as warped landmark positions. It uses the same interpolation and boundary rules.
+ *
+ * @param[out] values Receives ImageSamplerOptions::numComponents values. Invalid samples are set
+ * to ImageSamplerOptions::outsideValue.
+ * @return True when the point was sampled inside the image or by the boundary rule; false when the
+ * sample is invalid, \p values is too small, or the time point or component range is invalid.
+ */
+bool sampleImageAtPixel(
+  const Image& image,
+  const glm::vec3& pixelPosition,
+  std::span<double> values,
+  const ImageSamplerOptions& options = {});
+
+/**
+ * @brief Sample image components at one Deformed World space position, without allocating.
+ * @see sampleImageAtPixel
+ */
+bool sampleImageAtWorldPoint(
+  const Image& image,
+  const glm::vec3& worldPosition,
+  std::span<double> values,
+  const ImageSamplerOptions& options = {});
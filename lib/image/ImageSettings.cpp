@@ -120,6 +120,16 @@ bool ImageSettings::timePlaybackLoop() const
   return m_timePlaybackLoop;
 }
 
+void ImageSettings::setTimePlaybackBounce(bool bounce)
+{
+  m_timePlaybackBounce = bounce;
+}
+
+bool ImageSettings::timePlaybackBounce() const
+{
+  return m_timePlaybackBounce;
+}
+
 void ImageSettings::setTimePlaybackPlaying(bool playing)
 {
   m_timePlaybackPlaying = playing;
@@ -131,6 +131,12 @@ public:
   /// @brief Return whether time playback loops when it reaches the last frame.
   bool timePlaybackLoop() const;
 
+  /// @brief Set whether time playback reverses direction at the first and last frames, which overrides looping.
+  void setTimePlaybackBounce(bool bounce);
+
+  /// @brief Return whether time playback reverses direction at the first and last frames.
+  bool timePlaybackBounce() const;
+
   /// @brief Set whether time-series playback is actively advancing frames.
   void setTimePlaybackPlaying(bool playing);
 
@@ -1017,6 +1023,7 @@ private:
   uint32_t m_activeComponent{0};     //!< Active component
   uint32_t m_activeTimePoint{0};     //!< Active time point for time-series display
   bool m_timePlaybackLoop{true};     //!< Loop playback at the last time point
+  bool m_timePlaybackBounce{false};  //!< Reverse playback at the first and last time points
   bool m_timePlaybackPlaying{false}; //!< Whether time-series playback is running
   double m_timePlaybackSpeed{1.0};   //!< Time playback speed multiplier
 
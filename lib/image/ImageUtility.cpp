@@ -3,6 +3,7 @@
 #include "internal/ImageUtility.tpp"
 
 #include "common/MathFuncs.h"
+#include "common/Parallel.h"
 #include <spdlog/fmt/std.h>
 
 #include <glm/gtc/epsilon.hpp>
@@ -87,28 +88,6 @@ uint32_t componentSizeInBytes(ComponentType type)
   return 0;
 }
 
-template<typename T>
-std::vector<T> copyImageComponentValues(const Image& image, uint32_t component)
-{
-  const std::size_t numPixels = image.header().numPixels();
-  const std::size_t numValues = numPixels * image.timeAxis().numTimePoints();
-  std::vector<T> values;
-  values.reserve(numValues);
-
-  for (uint32_t timePoint = 0; timePoint < image.timeAxis().numTimePoints(); ++timePoint) {
-    for (std::size_t i = 0; i < numPixels; ++i) {
-      const auto value = image.value<T>(component, i, timePoint);
-      if (!value) {
-        spdlog::error("Unable to read image component {} value at index {} and time {}", component, i, timePoint);
-        throwDebug("Unable to read image component value");
-      }
-      values.push_back(*value);
-    }
-  }
-
-  return values;
-}
-
 } // namespace
 
 std::optional<ImageHeader> readImageHeaderOnly(
@@ -506,49 +485,44 @@ std::size_t computeNumImageSlicesAlongWorldDirection(const Image& image, const g
   return static_cast<std::size_t>(std::ceil((maxDistance - minDistance) / spacing));
 }
 
-std::vector<ComponentStats> computeImageStatisticsOnSortedValues(const Image& image)
+std::vector<ComponentStats> computeImageStatisticsOnQuantileIndex(const Image& image)
 {
   std::vector<ComponentStats> componentStats;
 
-  const std::size_t N = image.header().numPixels() * image.timeAxis().numTimePoints();
-
   for (uint32_t i = 0; i < image.header().numComponentsPerPixel(); ++i) {
-    const void* bufferSorted = image.bufferSortedAsVoid(i);
+    const ImageQuantileIndex* index = image.quantileIndex(i);
+    if (!index || index->empty()) {
+      spdlog::error("Quantile index for image component {} has not been generated", i);
+      return componentStats;
+    }
 
     switch (image.header().memoryComponentType()) {
       case ComponentType::Int8: {
-        componentStats.emplace_back(
-          computeStatsOnSortedBuffers<int8_t>(std::span(static_cast<const int8_t*>(bufferSorted), N)));
+        componentStats.emplace_back(computeStatsOnQuantileIndex<int8_t>(*index));
         break;
       }
       case ComponentType::UInt8: {
-        componentStats.emplace_back(
-          computeStatsOnSortedBuffers<uint8_t>(std::span(static_cast<const uint8_t*>(bufferSorted), N)));
+        componentStats.emplace_back(computeStatsOnQuantileIndex<uint8_t>(*index));
         break;
       }
       case ComponentType::Int16: {
-        componentStats.emplace_back(
-          computeStatsOnSortedBuffers<int16_t>(std::span(static_cast<const int16_t*>(bufferSorted), N)));
+        componentStats.emplace_back(computeStatsOnQuantileIndex<int16_t>(*index));
         break;
       }
       case ComponentType::UInt16: {
-        componentStats.emplace_back(
-          computeStatsOnSortedBuffers<uint16_t>(std::span(static_cast<const uint16_t*>(bufferSorted), N)));
+        componentStats.emplace_back(computeStatsOnQuantileIndex<uint16_t>(*index));
         break;
       }
       case ComponentType::Int32: {
-        componentStats.emplace_back(
-          computeStatsOnSortedBuffers<int32_t>(std::span(static_cast<const int32_t*>(bufferSorted), N)));
+        componentStats.emplace_back(computeStatsOnQuantileIndex<int32_t>(*index));
         break;
       }
       case ComponentType::UInt32: {
-        componentStats.emplace_back(
-          computeStatsOnSortedBuffers<uint32_t>(std::span(static_cast<const uint32_t*>(bufferSorted), N)));
+        componentStats.emplace_back(computeStatsOnQuantileIndex<uint32_t>(*index));
         break;
       }
       case ComponentType::Float32: {
-        componentStats.emplace_back(
-          computeStatsOnSortedBuffers<float>(std::span(static_cast<const float*>(bufferSorted), N)));
+        componentStats.emplace_back(computeStatsOnQuantileIndex<float>(*index));
         break;
       }
       default: {
@@ -561,179 +535,112 @@ std::vector<ComponentStats> computeImageStatisticsOnSortedValues(const Image& im
   return componentStats;
 }
 
-std::vector<OnlineStats> computeImageStatisticsOnUnsortedValues(const Image& image)
+std::vector<ComponentSummary> computeImageComponentSummaries(const Image& image)
 {
-  std::vector<OnlineStats> componentStats;
+  spdlog::debug("Computing statistics and T-digests for image intensities");
 
-  const std::size_t N = image.header().numPixels() * image.timeAxis().numTimePoints();
-
-  for (uint32_t i = 0; i < image.header().numComponentsPerPixel(); ++i) {
-    const void* buffer = image.bufferAsVoid(i);
-
-    switch (image.header().memoryComponentType()) {
-      case ComponentType::Int8: {
-        if (!buffer || image.bufferType() == Image::MultiComponentBufferType::InterleavedImage) {
-          const auto values = copyImageComponentValues<int8_t>(image, i);
-          componentStats.emplace_back(computeStatsOnUnsortedBuffers<int8_t>(std::span(values)));
-          break;
-        }
-        componentStats.emplace_back(
-          computeStatsOnUnsortedBuffers<int8_t>(std::span(static_cast<const int8_t*>(buffer), N)));
-        break;
-      }
-      case ComponentType::UInt8: {
-        if (!buffer || image.bufferType() == Image::MultiComponentBufferType::InterleavedImage) {
-          const auto values = copyImageComponentValues<uint8_t>(image, i);
-          componentStats.emplace_back(computeStatsOnUnsortedBuffers<uint8_t>(std::span(values)));
-          break;
-        }
-        componentStats.emplace_back(
-          computeStatsOnUnsortedBuffers<uint8_t>(std::span(static_cast<const uint8_t*>(buffer), N)));
-        break;
-      }
-      case ComponentType::Int16: {
-        if (!buffer || image.bufferType() == Image::MultiComponentBufferType::InterleavedImage) {
-          const auto values = copyImageComponentValues<int16_t>(image, i);
-          componentStats.emplace_back(computeStatsOnUnsortedBuffers<int16_t>(std::span(values)));
-          break;
-        }
-        componentStats.emplace_back(
-          computeStatsOnUnsortedBuffers<int16_t>(std::span(static_cast<const int16_t*>(buffer), N)));
-        break;
-      }
-      case ComponentType::UInt16: {
-        if (!buffer || image.bufferType() == Image::MultiComponentBufferType::InterleavedImage) {
-          const auto values = copyImageComponentValues<uint16_t>(image, i);
-          componentStats.emplace_back(computeStatsOnUnsortedBuffers<uint16_t>(std::span(values)));
-          break;
-        }
-        componentStats.emplace_back(
-          computeStatsOnUnsortedBuffers<uint16_t>(std::span(static_cast<const uint16_t*>(buffer), N)));
-        break;
-      }
-      case ComponentType::Int32: {
-        if (!buffer || image.bufferType() == Image::MultiComponentBufferType::InterleavedImage) {
-          const auto values = copyImageComponentValues<int32_t>(image, i);
-          componentStats.emplace_back(computeStatsOnUnsortedBuffers<int32_t>(std::span(values)));
-          break;
-        }
-        componentStats.emplace_back(
-          computeStatsOnUnsortedBuffers<int32_t>(std::span(static_cast<const int32_t*>(buffer), N)));
-        break;
-      }
-      case ComponentType::UInt32: {
-        if (!buffer || image.bufferType() == Image::MultiComponentBufferType::InterleavedImage) {
-          const auto values = copyImageComponentValues<uint32_t>(image, i);
-          componentStats.emplace_back(computeStatsOnUnsortedBuffers<uint32_t>(std::span(values)));
-          break;
-        }
-        componentStats.emplace_back(
-          computeStatsOnUnsortedBuffers<uint32_t>(std::span(static_cast<const uint32_t*>(buffer), N)));
-        break;
-      }
-      case ComponentType::Float32: {
-        if (!buffer || image.bufferType() == Image::MultiComponentBufferType::InterleavedImage) {
-          const auto values = copyImageComponentValues<float>(image, i);
-          componentStats.emplace_back(computeStatsOnUnsortedBuffers<float>(std::span(values)));
-          break;
-        }
-        componentStats.emplace_back(
-          computeStatsOnUnsortedBuffers<float>(std::span(static_cast<const float*>(buffer), N)));
-        break;
-      }
-      default: {
-        spdlog::error("Invalid image component type '{}'", componentTypeString(image.header().memoryComponentType()));
-        return componentStats;
+  const std::size_t numPixels = image.header().numPixels();
+  const std::size_t N = numPixels * image.numBufferedTimePoints();
+  const uint32_t numComponents = image.header().numComponentsPerPixel();
+  const bool interleaved = (Image::MultiComponentBufferType::InterleavedImage == image.bufferType());
+
+  const unsigned int numTh = std::max(parallel::threadBudget() - 1, 1u);
+
+  std::vector<ComponentSummary> summaries;
+  summaries.reserve(numComponents);
+
+  auto summarize = [&]<typename T>() -> bool {
+    for (uint32_t i = 0; i < numComponents; ++i) {
+      // Interleaved components are read in place with a stride
+      const void* buffer = interleaved ? image.bufferAsVoid(0) : image.bufferAsVoid(i);
+      if (!buffer) {
+        spdlog::error("Image component {} has no pixel buffer", i);
+        return false;
       }
+
+      const T* data = static_cast<const T*>(buffer) + (interleaved ? i : 0);
+      const std::size_t stride = interleaved ? numComponents : 1;
+      summaries.emplace_back(summarizeComponentValues<T>(data, N, stride, numPixels, numTh));
     }
+    return true;
+  };
+
+  switch (image.header().memoryComponentType()) {
+    case ComponentType::Int8:
+      summarize.template operator()<int8_t>();
+      break;
+    case ComponentType::UInt8:
+      summarize.template operator()<uint8_t>();
+      break;
+    case ComponentType::Int16:
+      summarize.template operator()<int16_t>();
+      break;
+    case ComponentType::UInt16:
+      summarize.template operator()<uint16_t>();
+      break;
+    case ComponentType::Int32:
+      summarize.template operator()<int32_t>();
+      break;
+    case ComponentType::UInt32:
+      summarize.template operator()<uint32_t>();
+      break;
+    case ComponentType::Float32:
+      summarize.template operator()<float>();
+      break;
+    default:
+      spdlog::error("Invalid image component type '{}'", componentTypeString(image.header().memoryComponentType()));
+      break;
   }
 
-  return componentStats;
+  return summaries;
 }
 
-std::vector<tdigest::TDigest> computeTDigests(const Image& image)
+void mergeComponentSummary(ComponentSummary& summary, const ComponentSummary& other)
 {
-  spdlog::debug("Computing T-digest for image intensities");
+  OnlineStats& a = summary.onlineStats;
+  const OnlineStats& b = other.onlineStats;
 
-  const std::size_t N = image.header().numPixels() * image.timeAxis().numTimePoints();
-  std::vector<tdigest::TDigest> digests;
-
-  const unsigned int numTh = std::max(std::thread::hardware_concurrency() - 1, 1u);
+  if (0 == b.count) {
+    return;
+  }
+  if (0 == a.count) {
+    summary = other;
+    return;
+  }
 
-  for (uint32_t i = 0; i < image.header().numComponentsPerPixel(); ++i) {
-    const void* buffer = image.bufferAsVoid(i);
+  const long double na = static_cast<long double>(a.count);
+  const long double nb = static_cast<long double>(b.count);
+  const long double n = na + nb;
+  const long double delta = b.mean - a.mean;
+  const long double m2 = a.variance * (na - 1.0L) + b.variance * (nb - 1.0L) + delta * delta * (na * nb / n);
+
+  a.mean += delta * (nb / n);
+  a.sum += b.sum;
+  a.min = std::min(a.min, b.min);
+  a.max = std::max(a.max, b.max);
+  a.count += b.count;
+  a.variance = m2 / (n - 1.0L);
+  a.stdev = std::sqrt(a.variance);
+
+  summary.tdigest.merge(&other.tdigest);
+  summary.tdigest.compress();
+}
 
-    switch (image.header().memoryComponentType()) {
-      case ComponentType::Int8: {
-        if (!buffer || image.bufferType() == Image::MultiComponentBufferType::InterleavedImage) {
-          const auto values = copyImageComponentValues<int8_t>(image, i);
-          digests.emplace_back(buildTDigest<int8_t>(std::span(values), numTh));
-          break;
-        }
-        digests.emplace_back(buildTDigest<int8_t>(std::span(static_cast<const int8_t*>(buffer), N), numTh));
-        break;
-      }
-      case ComponentType::UInt8: {
-        if (!buffer || image.bufferType() == Image::MultiComponentBufferType::InterleavedImage) {
-          const auto values = copyImageComponentValues<uint8_t>(image, i);
-          digests.emplace_back(buildTDigest<uint8_t>(std::span(values), numTh));
-          break;
-        }
-        digests.emplace_back(buildTDigest<uint8_t>(std::span(static_cast<const uint8_t*>(buffer), N), numTh));
-        break;
-      }
-      case ComponentType::Int16: {
-        if (!buffer || image.bufferType() == Image::MultiComponentBufferType::InterleavedImage) {
-          const auto values = copyImageComponentValues<int16_t>(image, i);
-          digests.emplace_back(buildTDigest<int16_t>(std::span(values), numTh));
-          break;
-        }
-        digests.emplace_back(buildTDigest<int16_t>(std::span(static_cast<const int16_t*>(buffer), N), numTh));
-        break;
-      }
-      case ComponentType::UInt16: {
-        if (!buffer || image.bufferType() == Image::MultiComponentBufferType::InterleavedImage) {
-          const auto values = copyImageComponentValues<uint16_t>(image, i);
-          digests.emplace_back(buildTDigest<uint16_t>(std::span(values), numTh));
-          break;
-        }
-        digests.emplace_back(buildTDigest<uint16_t>(std::span(static_cast<const uint16_t*>(buffer), N), numTh));
-        break;
-      }
-      case ComponentType::Int32: {
-        if (!buffer || image.bufferType() == Image::MultiComponentBufferType::InterleavedImage) {
-          const auto values = copyImageComponentValues<int32_t>(image, i);
-          digests.emplace_back(buildTDigest<int32_t>(std::span(values), numTh));
-          break;
-        }
-        digests.emplace_back(buildTDigest<int32_t>(std::span(static_cast<const int32_t*>(buffer), N), numTh));
-        break;
-      }
-      case ComponentType::UInt32: {
-        if (!buffer || image.bufferType() == Image::MultiComponentBufferType::InterleavedImage) {
-          const auto values = copyImageComponentValues<uint32_t>(image, i);
-          digests.emplace_back(buildTDigest<uint32_t>(std::span(values), numTh));
-          break;
-        }
-        digests.emplace_back(buildTDigest<uint32_t>(std::span(static_cast<const uint32_t*>(buffer), N), numTh));
-        break;
-      }
-      case ComponentType::Float32: {
-        if (!buffer || image.bufferType() == Image::MultiComponentBufferType::InterleavedImage) {
-          const auto values = copyImageComponentValues<float>(image, i);
-          digests.emplace_back(buildTDigest<float>(std::span(values), numTh));
-          break;
-        }
-        digests.emplace_back(buildTDigest<float>(std::span(static_cast<const float*>(buffer), N), numTh));
-        break;
-      }
-      default: {
-        spdlog::error("Invalid image component type '{}'", componentTypeString(image.header().memoryComponentType()));
-        return digests;
-      }
-    }
+std::vector<OnlineStats> computeImageStatisticsOnUnsortedValues(const Image& image)
+{
+  std::vector<OnlineStats> componentStats;
+  for (auto& summary : computeImageComponentSummaries(image)) {
+    componentStats.emplace_back(summary.onlineStats);
   }
+  return componentStats;
+}
 
+std::vector<tdigest::TDigest> computeTDigests(const Image& image)
+{
+  std::vector<tdigest::TDigest> digests;
+  for (auto& summary : computeImageComponentSummaries(image)) {
+    digests.emplace_back(std::move(summary.tdigest));
+  }
   return digests;
 }
 
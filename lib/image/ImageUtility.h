@@ -97,8 +97,35 @@ bool isLinearOrPlanarImage(const ImageHeader& header);
  */
 std::size_t computeNumImageSlicesAlongWorldDirection(const Image& image, const glm::vec3& worldDir);
 
-/// @brief Compute exact component statistics from sorted image values.
-std::vector<ComponentStats> computeImageStatisticsOnSortedValues(const Image& image);
+/// @brief Compute exact component statistics from the image's quantile index.
+/// @note Image::generateQuantileIndex() must have been called on \p image.
+std::vector<ComponentStats> computeImageStatisticsOnQuantileIndex(const Image& image);
+
+/**
+ * @brief Statistics gathered for one image component in a single pass over its values.
+ */
+struct ComponentSummary
+{
+  OnlineStats onlineStats;      //!< Descriptive statistics over all time frames
+  tdigest::TDigest tdigest;     //!< Approximate distribution over all time frames
+  bool labelLikeValues = false; //!< Integer component with few distinct values in a first-frame sample
+};
+
+/**
+ * @brief Summarize every image component in one fused, multithreaded pass per component.
+ *
+ * Reads the pixel buffers in place for both separated and interleaved layouts.
+ */
+std::vector<ComponentSummary> computeImageComponentSummaries(const Image& image);
+
+/**
+ * @brief Merge the summary of a disjoint set of component values into \p summary.
+ *
+ * Moments are combined with the pairwise update of Chan et al. and the T-digests are merged. The
+ * label-likeness flag, which comes from a first-frame sample, is kept from \p summary unless it is
+ * empty.
+ */
+void mergeComponentSummary(ComponentSummary& summary, const ComponentSummary& other);
 
 /// @brief Compute online component statistics without sorting image values.
 std::vector<OnlineStats> computeImageStatisticsOnUnsortedValues(const Image& image);
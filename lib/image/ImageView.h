@@ -0,0 +1,208 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Typed, non-owning view of one component of one time frame of an image.
+ *
+ * A view resolves the memory component type, component, time point and buffer layout once, so loops
+ * over it read pixel values with plain pointer arithmetic. Pixels are addressed in x-fastest order;
+ * consecutive pixels are pixelStride() elements apart (1 for separate component buffers, the number
+ * of components for interleaved buffers).
+ *
+ * Views are obtained from Image::view(), Image::mutableView() or the Image::visitComponentView()
+ * family. A view is invalidated by any operation that reallocates or detaches the image buffers,
+ * including writes through another copy of a mutable image.
+ *
+ * @tparam T Component type. Use a const-qualified type for read-only views.
+ */
+template<typename T>
+class ImageView
+{
+public:
+  using value_type = std::remove_const_t<T>;
+
+  ImageView() = default;
+
+  /**
+   * @param data Pointer to the component value of the first pixel of the frame.
+   * @param dims Pixel dimensions of the frame.
+   * @param pixelStride Distance in elements between the values of consecutive pixels.
+   */
+  ImageView(T* data, const glm::u64vec3& dims, std::size_t pixelStride)
+    : m_data(data)
+    , m_dims(dims)
+    , m_pixelStride(pixelStride)
+    , m_rowStride(pixelStride * dims.x)
+    , m_sliceStride(pixelStride * dims.x * dims.y)
+  {
+  }
+
+  /// @brief Allow read-only views to be made from mutable views.
+  template<typename U>
+    requires(std::is_const_v<T> && std::is_same_v<const U, T>)
+  ImageView(const ImageView<U>& other)
+    : ImageView(other.data(), other.dimensions(), other.pixelStride())
+  {
+  }
+
+  T* data() const
+  {
+    return m_data;
+  }
+
+  const glm::u64vec3& dimensions() const
+  {
+    return m_dims;
+  }
+
+  std::size_t numPixels() const
+  {
+    return m_dims.x * m_dims.y * m_dims.z;
+  }
+
+  /// @brief Distance in elements between the values of consecutive pixels along x.
+  std::size_t pixelStride() const
+  {
+    return m_pixelStride;
+  }
+
+  /// @brief Distance in elements between the values of consecutive rows.
+  std::size_t rowStride() const
+  {
+    return m_rowStride;
+  }
+
+  /// @brief Distance in elements between the values of consecutive slices.
+  std::size_t sliceStride() const
+  {
+    return m_sliceStride;
+  }
+
+  /// @brief Return true when the pixel index lies inside the frame.
+  bool contains(int64_t i, int64_t j, int64_t k) const
+  {
+    return i >= 0 && j >= 0 && k >= 0 && i < static_cast<int64_t>(m_dims.x) && j < static_cast<int64_t>(m_dims.y) &&
+           k < static_cast<int64_t>(m_dims.z);
+  }
+
+  /// @brief Unchecked access by linear pixel index in x-fastest order.
+  T& operator[](std::size_t index) const
+  {
+    return m_data[index * m_pixelStride];
+  }
+
+  /// @brief Unchecked access by 3D pixel index. The index must satisfy contains().
+  T& at(std::size_t i, std::size_t j, std::size_t k) const
+  {
+    return m_data[k * m_sliceStride + j * m_rowStride + i * m_pixelStride];
+  }
+
+  /// @brief Checked read by 3D pixel index.
+  /// @return The value, or std::nullopt when the index is outside the frame.
+  std::optional<value_type> value(int64_t i, int64_t j, int64_t k) const
+  {
+    if (!contains(i, j, k)) {
+      return std::nullopt;
+    }
+    return at(static_cast<std::size_t>(i), static_cast<std::size_t>(j), static_cast<std::size_t>(k));
+  }
+
+  /**
+   * @brief Trilinearly sample the frame at continuous 3D pixel coordinates.
+   *
+   * Matches Image::valueLinear(): coordinates are valid in the half-voxel-extended range
+   * [-0.5, N - 0.5] and are clamped to the edge samples before interpolation. NaN coordinates are
+   * invalid.
+   *
+   * @return The interpolated value, or std::nullopt when the coordinate is outside the valid range.
+   */
+  std::optional<double> linear(double i, double j, double k) const
+  {
+    if (
+      !(i >= -0.5 && j >= -0.5 && k >= -0.5 && i <= m_dims.x - 0.5 && j <= m_dims.y - 0.5 && k <= m_dims.z - 0.5) ||
+      0 == numPixels())
+    {
+      return std::nullopt;
+    }
+
+    const glm::dvec3 coord = glm::clamp(glm::dvec3{i, j, k}, glm::dvec3{0.0}, glm::dvec3{m_dims} - glm::dvec3{1.0});
+    const glm::dvec3 f = glm::floor(coord);
+    const glm::dvec3 t = coord - f;
+
+    // The upper neighbor is outside the frame only when the coordinate sits on the last sample.
+    // As in Image::valueLinear(), such missing samples are ignored rather than interpolated.
+    const std::size_t x0 = static_cast<std::size_t>(f.x);
+    const std::size_t y0 = static_cast<std::size_t>(f.y);
+    const std::size_t z0 = static_cast<std::size_t>(f.z);
+    const bool hasX1 = x0 + 1 < m_dims.x;
+    const bool hasY1 = y0 + 1 < m_dims.y;
+    const bool hasZ1 = z0 + 1 < m_dims.z;
+    const std::size_t x1 = hasX1 ? x0 + 1 : x0;
+    const std::size_t y1 = hasY1 ? y0 + 1 : y0;
+    const std::size_t z1 = hasZ1 ? z0 + 1 : z0;
+
+    auto lerp = [](double a, double b, double w, bool hasB) { return hasB ? a * (1.0 - w) + b * w : a; };
+
+    auto row = [&](std::size_t y, std::size_t z) {
+      return lerp(static_cast<double>(at(x0, y, z)), static_cast<double>(at(x1, y, z)), t.x, hasX1);
+    };
+
+    const double c0 = lerp(row(y0, z0), row(y1, z0), t.y, hasY1);
+    const double c1 = hasZ1 ? lerp(row(y0, z1), row(y1, z1), t.y, hasY1) : c0;
+    return lerp(c0, c1, t.z, hasZ1);
+  }
+
+  /**
+   * @brief Visit every pixel of the frame in x-fastest order.
+   * @param visitor Callable as visitor(std::size_t index, T& value).
+   */
+  template<typename Visitor>
+  void forEachVoxel(Visitor&& visitor) const
+  {
+    const std::size_t n = numPixels();
+    T* p = m_data;
+    for (std::size_t index = 0; index < n; ++index, p += m_pixelStride) {
+      visitor(index, *p);
+    }
+  }
+
+  /**
+   * @brief Visit the pixels of a box in x-fastest order.
+   * @param lo Inclusive lower corner of the box.
+   * @param hi Exclusive upper corner of the box. The box is clipped to the frame.
+   * @param visitor Callable as visitor(const glm::i64vec3& voxel, T& value).
+   */
+  template<typename Visitor>
+  void forEachInRegion(const glm::i64vec3& lo, const glm::i64vec3& hi, Visitor&& visitor) const
+  {
+    const glm::i64vec3 begin = glm::max(lo, glm::i64vec3{0});
+    const glm::i64vec3 end = glm::min(hi, glm::i64vec3{m_dims});
+
+    glm::i64vec3 voxel;
+    for (voxel.z = begin.z; voxel.z < end.z; ++voxel.z) {
+      for (voxel.y = begin.y; voxel.y < end.y; ++voxel.y) {
+        T* p =
+          &at(static_cast<std::size_t>(begin.x), static_cast<std::size_t>(voxel.y), static_cast<std::size_t>(voxel.z));
+        for (voxel.x = begin.x; voxel.x < end.x; ++voxel.x, p += m_pixelStride) {
+          visitor(std::as_const(voxel), *p);
+        }
+      }
+    }
+  }
+
+private:
+  T* m_data = nullptr;
+  glm::u64vec3 m_dims{0};
+  std::size_t m_pixelStride = 1;
+  std::size_t m_rowStride = 0;
+  std::size_t m_sliceStride = 0;
+};
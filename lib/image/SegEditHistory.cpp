@@ -0,0 +1,297 @@
+#include "image/SegEditHistory.h"
+#include "image/Image.h"
+
+#include <spdlog/fmt/ostr.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+namespace
+{
+constexpr uint32_t sk_comp = 0;
+constexpr uint32_t sk_timePoint = 0;
+} // namespace
+
+SegEditHistory::SegEditHistory(std::size_t memoryBudgetInBytes)
+  : m_memoryBudget(memoryBudgetInBytes)
+{
+}
+
+std::optional<SegmentationBlock>
+SegEditHistory::captureBlock(const Image& seg, const glm::ivec3& minVoxel, const glm::ivec3& maxVoxel)
+{
+  const glm::ivec3 dims{seg.header().pixelDimensions()};
+  const glm::ivec3 lo = glm::max(minVoxel, glm::ivec3{0});
+  const glm::ivec3 hi = glm::min(maxVoxel, dims - glm::ivec3{1});
+
+  if (glm::any(glm::lessThan(hi, lo))) {
+    return std::nullopt;
+  }
+
+  SegmentationBlock block;
+  block.offset = glm::uvec3{lo};
+  block.size = glm::uvec3{hi - lo + glm::ivec3{1}};
+  block.labels.resize(static_cast<std::size_t>(block.size.x) * block.size.y * block.size.z);
+
+  const bool copied = seg.visitComponentView(sk_comp, sk_timePoint, [&](const auto& view) {
+    const std::size_t stride = view.pixelStride();
+    uint32_t* out = block.labels.data();
+
+    for (int k = lo.z; k <= hi.z; ++k) {
+      for (int j = lo.y; j <= hi.y; ++j, out += block.size.x) {
+        const auto* row = &view.at(
+          static_cast<std::size_t>(lo.x), static_cast<std::size_t>(j), static_cast<std::size_t>(k));
+        for (uint32_t i = 0; i < block.size.x; ++i) {
+          out[i] = static_cast<uint32_t>(row[i * stride]);
+        }
+      }
+    }
+  });
+
+  if (!copied) {
+    return std::nullopt;
+  }
+  return block;
+}
+
+void SegEditHistory::beginStep()
+{
+  m_stepOpen = true;
+  m_openStepEdited = false;
+}
+
+void SegEditHistory::endStep()
+{
+  m_stepOpen = false;
+  m_openStepEdited = false;
+}
+
+bool SegEditHistory::record(const uuids::uuid& segUid, const SegmentationBlock& before, const Image& segAfter)
+{
+  const glm::uvec3 dims = segAfter.header().pixelDimensions();
+  const glm::uvec3 end = before.offset + before.size;
+
+  if (glm::any(glm::greaterThan(end, dims)) || glm::any(glm::equal(before.size, glm::uvec3{0}))) {
+    spdlog::warn("Cannot record edit of segmentation {} outside of its bounds", segUid);
+    return false;
+  }
+
+  Delta delta;
+  delta.segUid = segUid;
+  delta.segDims = dims;
+  delta.minVoxel = end;
+  delta.maxVoxel = before.offset;
+
+  const bool compared = segAfter.visitComponentView(sk_comp, sk_timePoint, [&](const auto& view) {
+    const std::size_t stride = view.pixelStride();
+    const uint32_t* oldRow = before.labels.empty() ? nullptr : before.labels.data();
+
+    for (uint32_t k = before.offset.z; k < end.z; ++k) {
+      for (uint32_t j = before.offset.y; j < end.y; ++j) {
+        const auto* row = &view.at(before.offset.x, j, k);
+
+        // Split the row into runs of changed voxels with constant old and new labels:
+        uint32_t i = 0;
+        while (i < before.size.x) {
+          const uint32_t oldLabel = oldRow ? oldRow[i] : before.fillLabel;
+          const uint32_t newLabel = static_cast<uint32_t>(row[i * stride]);
+          if (oldLabel == newLabel) {
+            ++i;
+            continue;
+          }
+
+          const uint32_t begin = i++;
+          while (i < before.size.x && (oldRow ? oldRow[i] : before.fillLabel) == oldLabel &&
+                 static_cast<uint32_t>(row[i * stride]) == newLabel)
+          {
+            ++i;
+          }
+
+          delta.runs.push_back(SegmentationLabelRun{before.offset.x + begin, j, k, i - begin, oldLabel, newLabel});
+          delta.minVoxel = glm::min(delta.minVoxel, glm::uvec3{before.offset.x + begin, j, k});
+          delta.maxVoxel = glm::max(delta.maxVoxel, glm::uvec3{before.offset.x + i - 1, j, k});
+        }
+
+        if (oldRow) {
+          oldRow += before.size.x;
+        }
+      }
+    }
+  });
+
+  if (!compared || delta.runs.empty()) {
+    return false;
+  }
+
+  delta.runs.shrink_to_fit();
+  const std::size_t bytes = sizeof(Delta) + delta.runs.size() * sizeof(SegmentationLabelRun);
+
+  // Any new edit invalidates the undone steps:
+  for (const Step& step : m_redoSteps) {
+    m_memoryUsage -= step.bytes;
+  }
+  m_redoSteps.clear();
+
+  if (!(m_stepOpen && m_openStepEdited) || m_undoSteps.empty()) {
+    m_undoSteps.emplace_back();
+    m_openStepEdited = m_stepOpen;
+  }
+
+  Step& step = m_undoSteps.back();
+  step.deltas.push_back(std::move(delta));
+  step.bytes += bytes;
+  m_memoryUsage += bytes;
+
+  if (m_editObserver) {
+    m_editObserver(segUid, step.deltas.back().runs, false);
+  }
+
+  enforceBudget();
+  return true;
+}
+
+bool SegEditHistory::undo(const ImageLookup& lookup, const RegionCallback& onRegionRestored)
+{
+  endStep();
+
+  if (m_undoSteps.empty()) {
+    return false;
+  }
+
+  Step step = std::move(m_undoSteps.back());
+  m_undoSteps.pop_back();
+
+  apply(step, true, lookup, onRegionRestored);
+  m_redoSteps.push_back(std::move(step));
+  return true;
+}
+
+bool SegEditHistory::redo(const ImageLookup& lookup, const RegionCallback& onRegionRestored)
+{
+  endStep();
+
+  if (m_redoSteps.empty()) {
+    return false;
+  }
+
+  Step step = std::move(m_redoSteps.back());
+  m_redoSteps.pop_back();
+
+  apply(step, false, lookup, onRegionRestored);
+  m_undoSteps.push_back(std::move(step));
+  return true;
+}
+
+bool SegEditHistory::canUndo() const
+{
+  return !m_undoSteps.empty();
+}
+
+bool SegEditHistory::canRedo() const
+{
+  return !m_redoSteps.empty();
+}
+
+std::size_t SegEditHistory::numUndoSteps() const
+{
+  return m_undoSteps.size();
+}
+
+std::size_t SegEditHistory::numRedoSteps() const
+{
+  return m_redoSteps.size();
+}
+
+std::size_t SegEditHistory::memoryUsage() const
+{
+  return m_memoryUsage;
+}
+
+std::size_t SegEditHistory::memoryBudget() const
+{
+  return m_memoryBudget;
+}
+
+void SegEditHistory::setMemoryBudget(std::size_t bytes)
+{
+  m_memoryBudget = bytes;
+  enforceBudget();
+}
+
+void SegEditHistory::clear()
+{
+  m_undoSteps.clear();
+  m_redoSteps.clear();
+  m_memoryUsage = 0;
+  endStep();
+}
+
+void SegEditHistory::setEditObserver(EditObserver observer)
+{
+  m_editObserver = std::move(observer);
+}
+
+void SegEditHistory::apply(
+  const Step& step,
+  bool undo,
+  const ImageLookup& lookup,
+  const RegionCallback& onRegionRestored) const
+{
+  auto applyDelta = [this, undo, &lookup, &onRegionRestored](const Delta& delta) {
+    Image* seg = lookup ? lookup(delta.segUid) : nullptr;
+    if (!seg) {
+      spdlog::debug("Skipping edit of segmentation {}, which no longer exists", delta.segUid);
+      return;
+    }
+
+    if (seg->header().pixelDimensions() != delta.segDims) {
+      spdlog::warn("Skipping edit of segmentation {}, whose dimensions changed", delta.segUid);
+      return;
+    }
+
+    seg->visitMutableComponentView(sk_comp, sk_timePoint, [&](const auto& view) {
+      using LabelValueType = typename std::remove_cvref_t<decltype(view)>::value_type;
+      const std::size_t stride = view.pixelStride();
+
+      for (const SegmentationLabelRun& run : delta.runs) {
+        const auto label = static_cast<LabelValueType>(undo ? run.oldLabel : run.newLabel);
+        LabelValueType* row = &view.at(run.x, run.y, run.z);
+        for (uint32_t i = 0; i < run.length; ++i) {
+          row[i * stride] = label;
+        }
+      }
+    });
+
+    if (m_editObserver) {
+      m_editObserver(delta.segUid, delta.runs, undo);
+    }
+
+    if (onRegionRestored) {
+      onRegionRestored(delta.segUid, delta.minVoxel, delta.maxVoxel - delta.minVoxel + glm::uvec3{1});
+    }
+  };
+
+  // Undo in reverse order of recording, so that overlapping edits of a step restore the oldest labels:
+  if (undo) {
+    std::for_each(step.deltas.rbegin(), step.deltas.rend(), applyDelta);
+  }
+  else {
+    std::for_each(step.deltas.begin(), step.deltas.end(), applyDelta);
+  }
+}
+
+void SegEditHistory::enforceBudget()
+{
+  // Undone steps are the first to go, then the oldest steps:
+  while (m_memoryUsage > m_memoryBudget && !m_redoSteps.empty()) {
+    m_memoryUsage -= m_redoSteps.front().bytes;
+    m_redoSteps.erase(m_redoSteps.begin());
+  }
+
+  while (m_memoryUsage > m_memoryBudget && m_undoSteps.size() > 1) {
+    m_memoryUsage -= m_undoSteps.front().bytes;
+    m_undoSteps.pop_front();
+  }
+}
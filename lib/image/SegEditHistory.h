@@ -0,0 +1,165 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <uuid.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+class Image;
+
+/**
+ * @brief Labels of a block of segmentation voxels, copied before an edit of the block.
+ */
+struct SegmentationBlock
+{
+  glm::uvec3 offset{0}; //!< First voxel of the block
+  glm::uvec3 size{0};   //!< Size of the block in voxels
+
+  /// Labels of the block in x-fastest order, or empty when all voxels hold fillLabel
+  std::vector<uint32_t> labels;
+  uint32_t fillLabel = 0;
+};
+
+/**
+ * @brief Voxels [x, x + length) of image row (y, z) whose label changed from oldLabel to newLabel.
+ */
+struct SegmentationLabelRun
+{
+  uint32_t x = 0;
+  uint32_t y = 0;
+  uint32_t z = 0;
+  uint32_t length = 0;
+  uint32_t oldLabel = 0;
+  uint32_t newLabel = 0;
+};
+
+/**
+ * @brief Bounded journal of segmentation edits for undo and redo.
+ *
+ * Each edit is stored as a delta: runs of voxels along image rows whose old and new labels are both
+ * constant. Unchanged voxels are not stored, so the memory of a delta follows the number of changed
+ * row runs rather than the size of the edited block, and undoing an edit rewrites only those runs.
+ *
+ * Edits recorded between beginStep() and endStep() form one step that is undone and redone as a
+ * whole, which coalesces the many edits of a continuous brush stroke. When the journal exceeds its
+ * memory budget, the oldest steps are dropped. The newest step is always kept.
+ */
+class SegEditHistory
+{
+public:
+  /// Find the segmentation image of an edit. Edits of segmentations that no longer exist are skipped.
+  using ImageLookup = std::function<Image*(const uuids::uuid& segUid)>;
+
+  /// Called after undo or redo rewrote a region of a segmentation image
+  using RegionCallback =
+    std::function<void(const uuids::uuid& segUid, const glm::uvec3& offset, const glm::uvec3& size)>;
+
+  /// Called with the changed runs of every recorded, undone and redone edit. When undone is true,
+  /// the voxels of the runs changed back from newLabel to oldLabel.
+  using EditObserver =
+    std::function<void(const uuids::uuid& segUid, std::span<const SegmentationLabelRun> runs, bool undone)>;
+
+  static constexpr std::size_t sk_defaultMemoryBudget = std::size_t{256} << 20;
+
+  explicit SegEditHistory(std::size_t memoryBudgetInBytes = sk_defaultMemoryBudget);
+
+  /**
+   * @brief Copy the labels of a segmentation block before editing it.
+   * @param seg Segmentation image. Only component 0 of time point 0 is copied.
+   * @param minVoxel, maxVoxel Inclusive corners of the block, which is clipped to the image.
+   * @return The block, or std::nullopt when it lies outside of the image.
+   */
+  static std::optional<SegmentationBlock>
+  captureBlock(const Image& seg, const glm::ivec3& minVoxel, const glm::ivec3& maxVoxel);
+
+  /// @brief Start a step. Edits recorded until endStep() are undone together.
+  void beginStep();
+
+  /// @brief End the current step, if any.
+  void endStep();
+
+  /**
+   * @brief Record an edit by comparing a block copied before the edit with the edited segmentation.
+   *
+   * Recording an edit clears the redo steps. Edits recorded outside of beginStep() and endStep()
+   * form a step of their own.
+   *
+   * @param segUid Segmentation that was edited.
+   * @param before Block copied by captureBlock() before the edit.
+   * @param segAfter Segmentation image after the edit.
+   * @return True if any voxel of the block changed.
+   */
+  bool record(const uuids::uuid& segUid, const SegmentationBlock& before, const Image& segAfter);
+
+  /**
+   * @brief Restore the labels from before the newest step.
+   * @return False if there is no step to undo.
+   */
+  bool undo(const ImageLookup& lookup, const RegionCallback& onRegionRestored);
+
+  /**
+   * @brief Reapply the newest undone step.
+   * @return False if there is no step to redo.
+   */
+  bool redo(const ImageLookup& lookup, const RegionCallback& onRegionRestored);
+
+  bool canUndo() const;
+  bool canRedo() const;
+
+  std::size_t numUndoSteps() const;
+  std::size_t numRedoSteps() const;
+
+  /// @brief Bytes held by the deltas of all undo and redo steps.
+  std::size_t memoryUsage() const;
+
+  std::size_t memoryBudget() const;
+
+  /// @brief Set the memory budget, dropping the oldest steps that no longer fit.
+  void setMemoryBudget(std::size_t bytes);
+
+  /// @brief Drop all steps.
+  void clear();
+
+  /// @brief Set the function that observes the label changes of edits, e.g. to update label statistics.
+  void setEditObserver(EditObserver observer);
+
+private:
+  /// Changed runs of one edit of one segmentation
+  struct Delta
+  {
+    uuids::uuid segUid;
+    glm::uvec3 segDims{0}; //!< Dimensions of the segmentation when edited
+    glm::uvec3 minVoxel{0};
+    glm::uvec3 maxVoxel{0}; //!< Inclusive bounds of the runs
+    std::vector<SegmentationLabelRun> runs;
+  };
+
+  struct Step
+  {
+    std::vector<Delta> deltas;
+    std::size_t bytes = 0;
+  };
+
+  /// Write the old (undo) or new (redo) labels of a step, in reverse order of recording for undo
+  void apply(const Step& step, bool undo, const ImageLookup& lookup, const RegionCallback& onRegionRestored) const;
+
+  /// Drop the oldest steps while over budget
+  void enforceBudget();
+
+  std::size_t m_memoryBudget = sk_defaultMemoryBudget;
+  std::size_t m_memoryUsage = 0;
+
+  EditObserver m_editObserver;
+
+  std::deque<Step> m_undoSteps;
+  std::vector<Step> m_redoSteps;
+
+  bool m_stepOpen = false;       //!< Between beginStep() and endStep()
+  bool m_openStepEdited = false; //!< Whether the open step is the newest undo step
+};
@@ -0,0 +1,254 @@
+#include "image/SegLabelIndex.h"
+#include "image/Image.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace
+{
+constexpr uint32_t sk_comp = 0;
+constexpr uint32_t sk_timePoint = 0;
+
+/// Add the voxels [x, x + length) of row (y, z) to the statistics of a label
+void addRun(SegLabelStats& stats, uint32_t x, uint32_t y, uint32_t z, uint32_t length)
+{
+  const glm::uvec3 first{x, y, z};
+  const glm::uvec3 last{x + length - 1, y, z};
+
+  if (0 == stats.voxelCount) {
+    stats.minVoxel = first;
+    stats.maxVoxel = last;
+    stats.boundsAreTight = true;
+  }
+  else {
+    stats.minVoxel = glm::min(stats.minVoxel, first);
+    stats.maxVoxel = glm::max(stats.maxVoxel, last);
+  }
+
+  const uint64_t n = length;
+  stats.voxelCount += n;
+  stats.voxelSum += glm::u64vec3{n * x + n * (n - 1) / 2, n * y, n * z};
+}
+
+/// Remove the voxels [x, x + length) of row (y, z) from the statistics of a label
+void removeRun(SegLabelStats& stats, uint32_t x, uint32_t y, uint32_t z, uint32_t length)
+{
+  const uint64_t n = length;
+  stats.voxelCount -= n;
+  stats.voxelSum -= glm::u64vec3{n * x + n * (n - 1) / 2, n * y, n * z};
+
+  // Removing voxels from the boundary may shrink the bounds:
+  if (x == stats.minVoxel.x || x + length - 1 == stats.maxVoxel.x || y == stats.minVoxel.y ||
+      y == stats.maxVoxel.y || z == stats.minVoxel.z || z == stats.maxVoxel.z)
+  {
+    stats.boundsAreTight = false;
+  }
+}
+
+void mergeStats(SegLabelStats& stats, const SegLabelStats& other)
+{
+  if (0 == stats.voxelCount) {
+    stats = other;
+    return;
+  }
+
+  stats.voxelCount += other.voxelCount;
+  stats.voxelSum += other.voxelSum;
+  stats.minVoxel = glm::min(stats.minVoxel, other.minVoxel);
+  stats.maxVoxel = glm::max(stats.maxVoxel, other.maxVoxel);
+}
+
+/// Add the voxels of the rows of slices [zBegin, zEnd) to per-label statistics, one run of equal labels at a time
+template<typename View>
+void indexSlices(const View& view, uint32_t zBegin, uint32_t zEnd, std::map<uint32_t, SegLabelStats>& stats)
+{
+  const glm::uvec3 dims{view.dimensions()};
+  const std::size_t stride = view.pixelStride();
+
+  for (uint32_t k = zBegin; k < zEnd; ++k) {
+    for (uint32_t j = 0; j < dims.y; ++j) {
+      const auto* row = &view.at(0, j, k);
+
+      uint32_t i = 0;
+      while (i < dims.x) {
+        const uint32_t label = static_cast<uint32_t>(row[i * stride]);
+        const uint32_t begin = i++;
+        while (i < dims.x && static_cast<uint32_t>(row[i * stride]) == label) {
+          ++i;
+        }
+        addRun(stats[label], begin, j, k, i - begin);
+      }
+    }
+  }
+}
+} // namespace
+
+std::optional<SegLabelIndex> SegLabelIndex::build(const Image& seg, unsigned int numThreads)
+{
+  SegLabelIndex index;
+  index.m_dims = seg.header().pixelDimensions();
+
+  const glm::dvec3 spacing{seg.header().spacing()};
+  index.m_voxelVolume = spacing.x * spacing.y * spacing.z;
+
+  numThreads = std::clamp(numThreads, 1u, std::max(index.m_dims.z, 1u));
+  std::vector<std::map<uint32_t, SegLabelStats>> partials(numThreads);
+
+  const bool indexed = seg.visitComponentView(sk_comp, sk_timePoint, [&](const auto& view) {
+    const uint32_t slabSize = (index.m_dims.z + numThreads - 1) / numThreads;
+
+    auto work = [&](unsigned int t) {
+      const uint32_t zBegin = std::min(index.m_dims.z, t * slabSize);
+      const uint32_t zEnd = std::min(index.m_dims.z, zBegin + slabSize);
+      indexSlices(view, zBegin, zEnd, partials[t]);
+    };
+
+    if (1 == numThreads) {
+      work(0);
+    }
+    else {
+      std::vector<std::thread> threads;
+      threads.reserve(numThreads);
+      for (unsigned int t = 0; t < numThreads; ++t) {
+        threads.emplace_back(work, t);
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+    }
+  });
+
+  if (!indexed) {
+    spdlog::error("Unable to index the labels of segmentation {}", seg.settings().displayName());
+    return std::nullopt;
+  }
+
+  for (const auto& partial : partials) {
+    for (const auto& [label, stats] : partial) {
+      mergeStats(index.m_stats[label], stats);
+    }
+  }
+
+  spdlog::debug("Indexed {} labels of segmentation {}", index.m_stats.size(), seg.settings().displayName());
+  return index;
+}
+
+void SegLabelIndex::applyRuns(std::span<const SegmentationLabelRun> runs, bool undone)
+{
+  for (const SegmentationLabelRun& run : runs) {
+    const uint32_t removedLabel = undone ? run.newLabel : run.oldLabel;
+    const uint32_t addedLabel = undone ? run.oldLabel : run.newLabel;
+
+    const auto it = m_stats.find(removedLabel);
+    if (std::end(m_stats) == it || it->second.voxelCount < run.length) {
+      spdlog::warn("Label {} of segmentation label index has fewer voxels than were changed", removedLabel);
+      continue;
+    }
+
+    removeRun(it->second, run.x, run.y, run.z, run.length);
+    if (0 == it->second.voxelCount) {
+      m_stats.erase(it);
+    }
+
+    addRun(m_stats[addedLabel], run.x, run.y, run.z, run.length);
+  }
+}
+
+const SegLabelStats* SegLabelIndex::stats(uint32_t label) const
+{
+  const auto it = m_stats.find(label);
+  return (std::end(m_stats) != it) ? &it->second : nullptr;
+}
+
+uint64_t SegLabelIndex::voxelCount(uint32_t label) const
+{
+  const SegLabelStats* s = stats(label);
+  return s ? s->voxelCount : 0;
+}
+
+double SegLabelIndex::volume(uint32_t label) const
+{
+  return static_cast<double>(voxelCount(label)) * m_voxelVolume;
+}
+
+std::optional<glm::vec3> SegLabelIndex::centroid(uint32_t label) const
+{
+  const SegLabelStats* s = stats(label);
+  if (!s) {
+    return std::nullopt;
+  }
+  return glm::vec3{glm::dvec3{s->voxelSum} / static_cast<double>(s->voxelCount)};
+}
+
+bool SegLabelIndex::tightenBounds(uint32_t label, const Image& seg)
+{
+  const auto it = m_stats.find(label);
+  if (std::end(m_stats) == it || seg.header().pixelDimensions() != m_dims) {
+    return false;
+  }
+
+  SegLabelStats& stats = it->second;
+  if (stats.boundsAreTight) {
+    return true;
+  }
+
+  glm::uvec3 minVoxel = stats.maxVoxel;
+  glm::uvec3 maxVoxel = stats.minVoxel;
+
+  const bool scanned = seg.visitComponentView(sk_comp, sk_timePoint, [&](const auto& view) {
+    const std::size_t stride = view.pixelStride();
+
+    for (uint32_t k = stats.minVoxel.z; k <= stats.maxVoxel.z; ++k) {
+      for (uint32_t j = stats.minVoxel.y; j <= stats.maxVoxel.y; ++j) {
+        const auto* row = &view.at(0, j, k);
+        for (uint32_t i = stats.minVoxel.x; i <= stats.maxVoxel.x; ++i) {
+          if (static_cast<uint32_t>(row[i * stride]) == label) {
+            minVoxel = glm::min(minVoxel, glm::uvec3{i, j, k});
+            maxVoxel = glm::max(maxVoxel, glm::uvec3{i, j, k});
+          }
+        }
+      }
+    }
+  });
+
+  if (!scanned || glm::any(glm::lessThan(maxVoxel, minVoxel))) {
+    return false;
+  }
+
+  stats.minVoxel = minVoxel;
+  stats.maxVoxel = maxVoxel;
+  stats.boundsAreTight = true;
+  return true;
+}
+
+std::vector<uint32_t> SegLabelIndex::labels() const
+{
+  std::vector<uint32_t> labels;
+  labels.reserve(m_stats.size());
+  for (const auto& [label, stats] : m_stats) {
+    labels.push_back(label);
+  }
+  return labels;
+}
+
+LabelIndexMaps SegLabelIndex::labelIndexMaps(bool ignoreBackgroundZeroLabel) const
+{
+  LabelIndexMaps labelMaps;
+
+  std::size_t labelIndex = 0;
+  for (const auto& [label, stats] : m_stats) {
+    if (0 == label && ignoreBackgroundZeroLabel) {
+      continue;
+    }
+    labelMaps.labelToIndex.emplace(label, labelIndex);
+    labelMaps.indexToLabel.emplace(labelIndex++, label);
+  }
+
+  return labelMaps;
+}
+
+const glm::uvec3& SegLabelIndex::dimensions() const
+{
+  return m_dims;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "common/SegmentationTypes.h"
+#include "image/SegEditHistory.h"
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+class Image;
+
+/**
+ * @brief Statistics of the voxels of one segmentation label.
+ */
+struct SegLabelStats
+{
+  uint64_t voxelCount = 0;
+  glm::u64vec3 voxelSum{0}; //!< Sum of the voxel coordinates, from which the centroid is computed
+  glm::uvec3 minVoxel{0};
+  glm::uvec3 maxVoxel{0}; //!< Inclusive bounds of the voxels
+
+  /// False when removed voxels may have left the bounds larger than the voxels of the label
+  bool boundsAreTight = true;
+};
+
+/**
+ * @brief Index of per-label voxel counts, volumes, bounding boxes and centroids of a segmentation.
+ *
+ * The index is built in one parallel pass over the segmentation and is then kept current from the
+ * label runs of edits (see SegEditHistory::EditObserver), at a cost proportional to the number of
+ * changed runs. Counts, volumes and centroids are always exact. Bounds grow exactly as voxels are
+ * added; when voxels are removed from the boundary of a label, its bounds are only marked loose and
+ * are tightened on demand by a scan of the old bounds.
+ *
+ * Only component 0 of time point 0 of the segmentation is indexed.
+ */
+class SegLabelIndex
+{
+public:
+  /**
+   * @brief Index the labels of a segmentation.
+   * @param seg Segmentation image.
+   * @param numThreads Maximum number of threads, each of which indexes a slab of slices.
+   * @return The index, or std::nullopt if the segmentation has no integer component view.
+   */
+  static std::optional<SegLabelIndex>
+  build(const Image& seg, unsigned int numThreads = std::thread::hardware_concurrency());
+
+  /**
+   * @brief Update the statistics with the changed runs of an edit.
+   * @param runs Runs whose voxels changed from oldLabel to newLabel.
+   * @param undone When true, the voxels changed back from newLabel to oldLabel.
+   */
+  void applyRuns(std::span<const SegmentationLabelRun> runs, bool undone);
+
+  /// @brief Statistics of a label, or nullptr if no voxel has the label.
+  const SegLabelStats* stats(uint32_t label) const;
+
+  /// @brief Number of voxels with a label.
+  uint64_t voxelCount(uint32_t label) const;
+
+  /// @brief Volume of the voxels with a label, in mm^3.
+  double volume(uint32_t label) const;
+
+  /// @brief Centroid of the voxels with a label in voxel coordinates, or std::nullopt if there are none.
+  std::optional<glm::vec3> centroid(uint32_t label) const;
+
+  /**
+   * @brief Shrink loose bounds of a label to its voxels, by scanning the voxels inside the old bounds.
+   * @param label Label whose bounds are tightened.
+   * @param seg Segmentation image from which the index was built.
+   * @return False if the label has no voxels or the segmentation does not match the index.
+   */
+  bool tightenBounds(uint32_t label, const Image& seg);
+
+  /// @brief Labels that have voxels, in ascending order.
+  std::vector<uint32_t> labels() const;
+
+  /**
+   * @brief Map the labels that have voxels to contiguous indices, in ascending label order.
+   * @param ignoreBackgroundZeroLabel When true, label 0 is not mapped.
+   */
+  LabelIndexMaps labelIndexMaps(bool ignoreBackgroundZeroLabel) const;
+
+  /// @brief Pixel dimensions of the indexed segmentation.
+  const glm::uvec3& dimensions() const;
+
+private:
+  SegLabelIndex() = default;
+
+  glm::uvec3 m_dims{0};
+  double m_voxelVolume = 1.0; //!< Volume of one voxel in mm^3
+
+  std::map<uint32_t, SegLabelStats> m_stats; //!< Statistics of the labels that have voxels
+};
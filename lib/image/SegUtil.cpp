@@ -13,14 +13,62 @@
 #include <spdlog/fmt/ostr.h>
 #include <spdlog/spdlog.h>
 
-#include <queue>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <tuple>
+#include <type_traits>
 #include <unordered_set>
 #include <vector>
 
 namespace
 {
 
+/// Brush stencils cached at most, beyond which the cache is cleared
+constexpr std::size_t sk_maxCachedStencils = 64;
+
+/**
+ * @brief Brush footprint as row spans of voxel offsets from the brush center.
+ */
+struct BrushStencil
+{
+  std::vector<SegmentationVoxelSpan> spans;
+};
+
+/// Parameters that define a brush stencil
+struct BrushStencilParams
+{
+  bool brushIsRound = true;
+  bool brushIs3d = false;
+  int brushSizeInVoxels = 1;
+  std::array<float, 3> mmToVoxelSpacings{1.0f, 1.0f, 1.0f};
+  std::array<int, 3> mmToVoxelCoeffs{1, 1, 1};
+
+  /// View plane in voxel offsets from the brush center. Zero for 3D brushes.
+  glm::vec4 relativeViewPlane{0.0f};
+
+  auto key() const
+  {
+    return std::make_tuple(
+      brushIsRound,
+      brushIs3d,
+      brushSizeInVoxels,
+      mmToVoxelSpacings,
+      std::array<float, 4>{relativeViewPlane.x, relativeViewPlane.y, relativeViewPlane.z, relativeViewPlane.w});
+  }
+
+  /// Largest voxel offset from the center along each axis that the brush can reach
+  glm::ivec3 halfExtent() const
+  {
+    const int radius = brushSizeInVoxels - 1;
+    return {mmToVoxelCoeffs[0] * radius, mmToVoxelCoeffs[1] * radius, mmToVoxelCoeffs[2] * radius};
+  }
+};
+
 // Does the voxel intersect a plane?
 // The plane is given in Voxel coordinates.
 bool voxelInterectsPlane(const glm::vec4& voxelViewPlane, const glm::vec3& voxelPos)
@@ -29,197 +77,370 @@ bool voxelInterectsPlane(const glm::vec4& voxelViewPlane, const glm::vec3& voxel
   return math::testAABBoxPlaneIntersection(voxelPos, voxelPos + cornerOffset, voxelViewPlane);
 }
 
-// Check if the voxel is inside the segmentation
-bool isVoxelInSeg(const glm::ivec3 segDims, const glm::ivec3& voxelPos)
+// Is the voxel at an offset from the brush center inside the brush?
+bool isOffsetInBrush(const BrushStencilParams& params, const glm::ivec3& offset)
 {
-  return (
-    voxelPos.x >= 0 && voxelPos.x < segDims.x && voxelPos.y >= 0 && voxelPos.y < segDims.y && voxelPos.z >= 0 &&
-    voxelPos.z < segDims.z);
+  const float radius = static_cast<float>(params.brushSizeInVoxels - 1);
+  const std::array<float, 3>& s = params.mmToVoxelSpacings;
+  const glm::vec3 d{offset};
+
+  if (!params.brushIsRound) {
+    // Equation for a rectangle:
+    return std::max(std::max(std::abs(d.x / s[0]), std::abs(d.y / s[1])), std::abs(d.z / s[2])) <= radius;
+  }
+
+  // Equation for an ellipsoid:
+  return (d.x * d.x / (s[0] * s[0]) + d.y * d.y / (s[1] * s[1]) + d.z * d.z / (s[2] * s[2])) <= radius * radius;
 }
 
-std::tuple<std::unordered_set<glm::ivec3>, glm::ivec3, glm::ivec3> paintBrush2d(
-  const glm::vec4& voxelViewPlane,
-  const glm::ivec3& segDims,
-  const glm::ivec3& roundedPixelPos,
-  const std::array<float, 3>& mmToVoxelSpacings,
-  int brushSizeInVoxels,
-  bool brushIsRound)
+/// Append the runs of marked voxels of a dense offset grid to a stencil
+void appendGridSpans(
+  const std::vector<uint8_t>& marked,
+  const glm::ivec3& lo,
+  const glm::ivec3& size,
+  std::vector<SegmentationVoxelSpan>& spans)
 {
-  // Queue of voxels to test for intersection with the view plane
-  std::queue<glm::ivec3> voxelsToTest;
+  for (int k = 0; k < size.z; ++k) {
+    for (int j = 0; j < size.y; ++j) {
+      const std::size_t row =
+        static_cast<std::size_t>(size.x) *
+        (static_cast<std::size_t>(j) + static_cast<std::size_t>(size.y) * static_cast<std::size_t>(k));
+      int i = 0;
+      while (i < size.x) {
+        if (!marked[row + static_cast<std::size_t>(i)]) {
+          ++i;
+          continue;
+        }
+        const int begin = i;
+        while (i < size.x && marked[row + static_cast<std::size_t>(i)]) {
+          ++i;
+        }
+        spans.push_back(SegmentationVoxelSpan{lo.y + j, lo.z + k, lo.x + begin, lo.x + i});
+      }
+    }
+  }
+}
 
-  // Set of voxels that have been sent off for testing
-  std::unordered_set<glm::ivec3> voxelsProcessed;
+/**
+ * @brief Build the stencil of a 3D brush: all offsets inside the brush shape.
+ */
+BrushStencil buildBrushStencil3d(const BrushStencilParams& params)
+{
+  const glm::ivec3 half = params.halfExtent();
+  BrushStencil stencil;
+
+  for (int k = -half.z; k <= half.z; ++k) {
+    for (int j = -half.y; j <= half.y; ++j) {
+      int i = -half.x;
+      while (i <= half.x) {
+        if (!isOffsetInBrush(params, {i, j, k})) {
+          ++i;
+          continue;
+        }
+        const int begin = i;
+        while (i <= half.x && isOffsetInBrush(params, {i, j, k})) {
+          ++i;
+        }
+        stencil.spans.push_back(SegmentationVoxelSpan{j, k, begin, i});
+      }
+    }
+  }
 
-  // Set of voxels that intersect with the view plane and that should be painted
-  std::unordered_set<glm::ivec3> voxelsToPaint;
+  return stencil;
+}
 
-  // Set of voxels that do not intersect with view plane or that should not be painted
-  std::unordered_set<glm::ivec3> voxelsToIgnore;
+/**
+ * @brief Build the stencil of a 2D brush: the offsets inside the brush shape that intersect the view
+ * plane and that connect to the center through such offsets.
+ * @param clipLo, clipHi Inclusive range of offsets that lie inside the segmentation.
+ */
+BrushStencil buildBrushStencil2d(const BrushStencilParams& params, const glm::ivec3& clipLo, const glm::ivec3& clipHi)
+{
+  const glm::ivec3 lo = glm::max(-params.halfExtent(), clipLo);
+  const glm::ivec3 hi = glm::min(params.halfExtent(), clipHi);
+
+  BrushStencil stencil;
+  if (glm::any(glm::lessThan(hi, lo)) || glm::any(glm::greaterThan(lo, glm::ivec3{0})) ||
+      glm::any(glm::lessThan(hi, glm::ivec3{0})))
+  {
+    return stencil;
+  }
 
-  // Insert the first voxel as a voxel to test, if it's inside the segmentation.
-  // This voxel should intersect the view plane, since it was clicked by the mouse,
-  // but test it to make sure.
+  const glm::ivec3 size = hi - lo + glm::ivec3{1};
+  auto index = [&lo, &size](const glm::ivec3& q) {
+    const glm::ivec3 r = q - lo;
+    return static_cast<std::size_t>(r.x) +
+           static_cast<std::size_t>(size.x) *
+             (static_cast<std::size_t>(r.y) + static_cast<std::size_t>(size.y) * static_cast<std::size_t>(r.z));
+  };
 
-  if (isVoxelInSeg(segDims, roundedPixelPos) && voxelInterectsPlane(voxelViewPlane, roundedPixelPos)) {
-    voxelsToTest.push(roundedPixelPos);
-    voxelsProcessed.insert(roundedPixelPos);
-  }
+  // Offsets to paint, and offsets that were queued for testing
+  std::vector<uint8_t> paint(static_cast<std::size_t>(size.x) * size.y * size.z, 0);
+  std::vector<uint8_t> queued(paint.size(), 0);
 
-  std::array<glm::ivec3, 6> neighbors;
+  // The center voxel should intersect the view plane, since it was clicked by the mouse,
+  // but test it to make sure.
+  std::vector<glm::ivec3> voxelsToTest;
+  if (voxelInterectsPlane(params.relativeViewPlane, glm::vec3{0.0f})) {
+    voxelsToTest.emplace_back(0);
+    queued[index(glm::ivec3{0})] = 1;
+  }
 
-  const float radius = static_cast<float>(brushSizeInVoxels - 1);
+  static const std::array<glm::ivec3, 6> sk_neighbors{
+    glm::ivec3{-1, 0, 0}, glm::ivec3{1, 0, 0}, glm::ivec3{0, -1, 0},
+    glm::ivec3{0, 1, 0}, glm::ivec3{0, 0, -1}, glm::ivec3{0, 0, 1}};
 
-  // Loop over all voxels in the test queue
   while (!voxelsToTest.empty()) {
-    const glm::ivec3 q = voxelsToTest.front();
-    voxelsToTest.pop();
-
-    // Check if the voxel is inside the brush
-    const glm::vec3 d = q - roundedPixelPos;
-
-    if (!brushIsRound) {
-      // Equation for a rectangle:
-      if (
-        std::max(
-          std::max(std::abs(d.x / mmToVoxelSpacings[0]), std::abs(d.y / mmToVoxelSpacings[1])),
-          std::abs(d.z / mmToVoxelSpacings[2])) > radius)
-      {
-        voxelsToIgnore.insert(q);
-        continue;
-      }
+    const glm::ivec3 q = voxelsToTest.back();
+    voxelsToTest.pop_back();
+
+    if (!isOffsetInBrush(params, q)) {
+      continue;
     }
-    else {
-      if (
-        (d.x * d.x / (mmToVoxelSpacings[0] * mmToVoxelSpacings[0]) +
-         d.y * d.y / (mmToVoxelSpacings[1] * mmToVoxelSpacings[1]) +
-         d.z * d.z / (mmToVoxelSpacings[2] * mmToVoxelSpacings[2])) > radius * radius)
-      {
-        voxelsToIgnore.insert(q);
+    paint[index(q)] = 1;
+
+    for (const glm::ivec3& step : sk_neighbors) {
+      const glm::ivec3 n = q + step;
+      if (glm::any(glm::lessThan(n, lo)) || glm::any(glm::greaterThan(n, hi)) || queued[index(n)]) {
         continue;
       }
+      if (voxelInterectsPlane(params.relativeViewPlane, glm::vec3{n})) {
+        queued[index(n)] = 1;
+        voxelsToTest.push_back(n);
+      }
     }
+  }
 
-    // Mark that voxel intersects the view plane and is inside the brush:
-    voxelsToPaint.insert(q);
-
-    // Test its six neighbors, too:
-    neighbors.fill(q);
-
-    neighbors[0].x -= 1;
-    neighbors[1].x += 1;
-    neighbors[2].y -= 1;
-    neighbors[3].y += 1;
-    neighbors[4].z -= 1;
-    neighbors[5].z += 1;
-
-    for (const auto& n : neighbors) {
-      if (
-        0 == voxelsProcessed.count(n) && 0 == voxelsToIgnore.count(n) && 0 == voxelsToPaint.count(n) &&
-        voxelInterectsPlane(voxelViewPlane, n) && isVoxelInSeg(segDims, n))
-      {
-        voxelsToTest.push(n);
-        voxelsProcessed.insert(n);
-      }
-      else {
-        voxelsToIgnore.insert(n);
-      }
+  appendGridSpans(paint, lo, size, stencil.spans);
+  return stencil;
+}
+
+/**
+ * @brief Get the stencil of a brush from the cache, building it on a miss.
+ */
+std::shared_ptr<const BrushStencil> cachedBrushStencil(const BrushStencilParams& params)
+{
+  using Key = decltype(params.key());
+
+  static std::mutex s_mutex;
+  static std::map<Key, std::shared_ptr<const BrushStencil>> s_stencils;
+
+  const Key key = params.key();
+  {
+    std::scoped_lock lock(s_mutex);
+    if (const auto it = s_stencils.find(key); it != s_stencils.end()) {
+      return it->second;
     }
   }
 
-  // Create a unique set of voxels to change:
-  std::unordered_set<glm::ivec3> voxelsToChange;
+  const glm::ivec3 half = params.halfExtent();
+  auto stencil = std::make_shared<const BrushStencil>(
+    params.brushIs3d ? buildBrushStencil3d(params) : buildBrushStencil2d(params, -half, half));
 
-  // Min/max corners of the set of voxels to change:
-  glm::ivec3 minVoxel{std::numeric_limits<int>::max()};
-  glm::ivec3 maxVoxel{std::numeric_limits<int>::lowest()};
+  std::scoped_lock lock(s_mutex);
+  if (s_stencils.size() >= sk_maxCachedStencils) {
+    s_stencils.clear();
+  }
+  s_stencils.emplace(key, stencil);
+  return stencil;
+}
+
+/**
+ * @brief Stamp a stencil at a center voxel, clipping its spans to the segmentation.
+ */
+SegmentationBrushFootprint
+stampBrushStencil(const BrushStencil& stencil, const glm::ivec3& center, const glm::ivec3& segDims)
+{
+  SegmentationBrushFootprint footprint;
+  footprint.spans.reserve(stencil.spans.size());
+
+  for (const SegmentationVoxelSpan& span : stencil.spans) {
+    const int y = center.y + span.y;
+    const int z = center.z + span.z;
+    const int xBegin = std::max(center.x + span.xBegin, 0);
+    const int xEnd = std::min(center.x + span.xEnd, segDims.x);
+
+    if (y < 0 || y >= segDims.y || z < 0 || z >= segDims.z || xBegin >= xEnd) {
+      continue;
+    }
+    footprint.spans.push_back(SegmentationVoxelSpan{y, z, xBegin, xEnd});
+  }
+
+  if (footprint.spans.empty()) {
+    return footprint;
+  }
 
-  for (const auto& p : voxelsToPaint) {
-    voxelsToChange.insert(p);
-    minVoxel = glm::min(minVoxel, p);
-    maxVoxel = glm::max(maxVoxel, p);
+  footprint.minVoxel = glm::ivec3{std::numeric_limits<int>::max()};
+  footprint.maxVoxel = glm::ivec3{std::numeric_limits<int>::lowest()};
+  for (const SegmentationVoxelSpan& span : footprint.spans) {
+    footprint.minVoxel = glm::min(footprint.minVoxel, glm::ivec3{span.xBegin, span.y, span.z});
+    footprint.maxVoxel = glm::max(footprint.maxVoxel, glm::ivec3{span.xEnd - 1, span.y, span.z});
   }
 
-  return std::make_tuple(voxelsToChange, minVoxel, maxVoxel);
+  return footprint;
 }
 
-std::tuple<std::unordered_set<glm::ivec3>, glm::ivec3, glm::ivec3> paintBrush3d(
-  const glm::ivec3& segDims,
-  const glm::ivec3& roundedPixelPos,
-  const std::array<float, 3>& mmToVoxelSpacings,
-  const std::array<int, 3>& mmToVoxelCoeffs,
-  int brushSizeInVoxels,
-  bool brushIsRound)
+/**
+ * @brief Sort the spans of a footprint and merge those that overlap or abut within a row.
+ */
+void mergeFootprintSpans(SegmentationBrushFootprint& footprint)
 {
-  // Set of unique voxels to change:
-  std::unordered_set<glm::ivec3> voxelToChange;
-
-  // Min/max corners of the set of voxels to change:
-  glm::ivec3 minVoxel{std::numeric_limits<int>::max()};
-  glm::ivec3 maxVoxel{std::numeric_limits<int>::lowest()};
-
-  const int radius_int = brushSizeInVoxels - 1;
-  const float radius_f = static_cast<float>(radius_int);
-
-  for (int k = -mmToVoxelCoeffs[2] * radius_int; k <= mmToVoxelCoeffs[2] * radius_int; ++k) {
-    const int K = roundedPixelPos.z + k;
-    if (K < 0 || K >= segDims.z) continue;
-
-    for (int j = -mmToVoxelCoeffs[1] * radius_int; j <= mmToVoxelCoeffs[1] * radius_int; ++j) {
-      const int J = roundedPixelPos.y + j;
-      if (J < 0 || J >= segDims.y) continue;
-
-      for (int i = -mmToVoxelCoeffs[0] * radius_int; i <= mmToVoxelCoeffs[0] * radius_int; ++i) {
-        const int I = roundedPixelPos.x + i;
-        if (I < 0 || I >= segDims.x) continue;
-
-        const glm::ivec3 p{I, J, K};
-        bool changed = false;
-
-        const float ii = static_cast<float>(i);
-        const float jj = static_cast<float>(j);
-        const float kk = static_cast<float>(k);
-
-        if (!brushIsRound) {
-          // Square brush
-          if (
-            std::max(
-              std::max(std::abs(ii / mmToVoxelSpacings[0]), std::abs(jj / mmToVoxelSpacings[1])),
-              std::abs(kk / mmToVoxelSpacings[2])) <= radius_f)
-          {
-            voxelToChange.insert(p);
-            changed = true;
+  std::vector<SegmentationVoxelSpan>& spans = footprint.spans;
+
+  std::sort(spans.begin(), spans.end(), [](const SegmentationVoxelSpan& a, const SegmentationVoxelSpan& b) {
+    return std::tie(a.z, a.y, a.xBegin) < std::tie(b.z, b.y, b.xBegin);
+  });
+
+  std::size_t numMerged = 0;
+  for (const SegmentationVoxelSpan& span : spans) {
+    if (numMerged > 0) {
+      SegmentationVoxelSpan& last = spans[numMerged - 1];
+      if (last.z == span.z && last.y == span.y && span.xBegin <= last.xEnd) {
+        last.xEnd = std::max(last.xEnd, span.xEnd);
+        continue;
+      }
+    }
+    spans[numMerged++] = span;
+  }
+  spans.resize(numMerged);
+}
+
+/**
+ * @brief Paint the spans of a footprint in place.
+ * @param blockLabels Optional output for the labels of the footprint's whole bounding block after
+ * painting, in x-fastest order. When null, only the voxels of the spans are visited.
+ * @return False if the footprint does not lie inside the segmentation.
+ */
+bool paintFootprintSpans(
+  const SegmentationBrushFootprint& footprint,
+  int64_t labelToPaint,
+  int64_t labelToReplace,
+  bool brushReplacesBgWithFg,
+  Image& seg,
+  int64_t* blockLabels)
+{
+  static constexpr uint32_t sk_comp = 0;
+  static constexpr uint32_t sk_timePoint = 0;
+
+  const glm::ivec3& minVoxel = footprint.minVoxel;
+  const glm::ivec3& maxVoxel = footprint.maxVoxel;
+  bool inside = true;
+
+  const bool painted = seg.visitMutableComponentView(sk_comp, sk_timePoint, [&](const auto& view) {
+    using LabelValueType = typename std::remove_cvref_t<decltype(view)>::value_type;
+
+    if (!view.contains(minVoxel.x, minVoxel.y, minVoxel.z) || !view.contains(maxVoxel.x, maxVoxel.y, maxVoxel.z)) {
+      inside = false;
+      return;
+    }
+
+    const std::size_t stride = view.pixelStride();
+    const LabelValueType paintValue = static_cast<LabelValueType>(labelToPaint);
+
+    if (!blockLabels) {
+      // Visit only the voxels of the spans:
+      for (const SegmentationVoxelSpan& span : footprint.spans) {
+        LabelValueType* row = &view.at(
+          static_cast<std::size_t>(span.xBegin), static_cast<std::size_t>(span.y), static_cast<std::size_t>(span.z));
+
+        for (std::size_t i = 0; i < static_cast<std::size_t>(span.xEnd - span.xBegin); ++i) {
+          // Paint the voxel, unless the brush only replaces one label:
+          if (!brushReplacesBgWithFg || labelToReplace == static_cast<int64_t>(row[i * stride])) {
+            row[i * stride] = paintValue;
           }
         }
-        else {
-          // Round brush: additional check that voxel is inside the sphere of radius N
-          if (
-            (ii * ii / (mmToVoxelSpacings[0] * mmToVoxelSpacings[0]) +
-             jj * jj / (mmToVoxelSpacings[1] * mmToVoxelSpacings[1]) +
-             kk * kk / (mmToVoxelSpacings[2] * mmToVoxelSpacings[2])) <= radius_f * radius_f)
-          {
-            voxelToChange.insert(p);
-            changed = true;
-          }
+      }
+      return;
+    }
+
+    // Copy each row of the block, then paint the spans of that row in place:
+    const uint32_t rowLength = static_cast<uint32_t>(maxVoxel.x - minVoxel.x + 1);
+    auto span = footprint.spans.begin();
+
+    int64_t* out = blockLabels;
+    for (int k = minVoxel.z; k <= maxVoxel.z; ++k) {
+      for (int j = minVoxel.y; j <= maxVoxel.y; ++j, out += rowLength) {
+        LabelValueType* row = &view.at(
+          static_cast<std::size_t>(minVoxel.x), static_cast<std::size_t>(j), static_cast<std::size_t>(k));
+
+        for (uint32_t x = 0; x < rowLength; ++x) {
+          out[x] = static_cast<int64_t>(row[x * stride]);
         }
 
-        if (changed) {
-          minVoxel = glm::min(minVoxel, p);
-          maxVoxel = glm::max(maxVoxel, p);
+        for (; span != footprint.spans.end() && span->z == k && span->y == j; ++span) {
+          for (int i = span->xBegin - minVoxel.x; i < span->xEnd - minVoxel.x; ++i) {
+            // Paint the voxel, unless the brush only replaces one label:
+            if (!brushReplacesBgWithFg || labelToReplace == out[i]) {
+              row[static_cast<std::size_t>(i) * stride] = paintValue;
+              out[i] = labelToPaint;
+            }
+          }
         }
       }
     }
-  }
+  });
 
-  return std::make_tuple(voxelToChange, minVoxel, maxVoxel);
+  return painted && inside;
 }
 
 } // namespace
 
+bool SegmentationBrushFootprint::empty() const
+{
+  return spans.empty();
+}
+
+std::size_t SegmentationBrushFootprint::numVoxels() const
+{
+  std::size_t count = 0;
+  for (const SegmentationVoxelSpan& span : spans) {
+    count += static_cast<std::size_t>(span.xEnd - span.xBegin);
+  }
+  return count;
+}
+
+bool SegmentationBrushFootprint::contains(const glm::ivec3& voxel) const
+{
+  const auto it = std::lower_bound(
+    spans.begin(), spans.end(), voxel, [](const SegmentationVoxelSpan& span, const glm::ivec3& v) {
+      return std::tie(span.z, span.y, span.xEnd) <= std::tie(v.z, v.y, v.x);
+    });
+  return it != spans.end() && it->z == voxel.z && it->y == voxel.y && it->xBegin <= voxel.x;
+}
+
+SegmentationBrushFootprint makeSegmentationFootprint(const SegmentationVoxelSet& voxels)
+{
+  std::vector<glm::ivec3> sorted(voxels.begin(), voxels.end());
+  std::sort(sorted.begin(), sorted.end(), [](const glm::ivec3& a, const glm::ivec3& b) {
+    return std::tie(a.z, a.y, a.x) < std::tie(b.z, b.y, b.x);
+  });
+
+  SegmentationBrushFootprint footprint;
+  if (sorted.empty()) {
+    return footprint;
+  }
+
+  footprint.minVoxel = glm::ivec3{std::numeric_limits<int>::max()};
+  footprint.maxVoxel = glm::ivec3{std::numeric_limits<int>::lowest()};
+
+  for (const glm::ivec3& p : sorted) {
+    footprint.minVoxel = glm::min(footprint.minVoxel, p);
+    footprint.maxVoxel = glm::max(footprint.maxVoxel, p);
+
+    SegmentationVoxelSpan* last = footprint.spans.empty() ? nullptr : &footprint.spans.back();
+    if (last && last->z == p.z && last->y == p.y && last->xEnd == p.x) {
+      ++last->xEnd;
+    }
+    else {
+      footprint.spans.push_back(SegmentationVoxelSpan{p.y, p.z, p.x, p.x + 1});
+    }
+  }
+
+  return footprint;
+}
+
 void updateSegmentationVoxels(
-  const SegmentationVoxelSet& voxelsToChange,
-  const glm::ivec3& minVoxel,
-  const glm::ivec3& maxVoxel,
+  const SegmentationBrushFootprint& footprint,
 
   int64_t labelToPaint,
   int64_t labelToReplace,
@@ -229,65 +450,87 @@ void updateSegmentationVoxels(
 
   const SegmentationVoxelUpdateCallback& notifyVoxelsChanged)
 {
-  static constexpr std::size_t sk_comp = 0;
   static const glm::ivec3 sk_voxelOne{1, 1, 1};
 
-  // Create a rectangular block of contiguous voxel value data for changed-region consumers:
-  std::vector<glm::ivec3> voxelPositions;
-  std::vector<int64_t> voxelValues;
-
-  for (int k = minVoxel.z; k <= maxVoxel.z; ++k) {
-    for (int j = minVoxel.y; j <= maxVoxel.y; ++j) {
-      for (int i = minVoxel.x; i <= maxVoxel.x; ++i) {
-        const glm::ivec3 p{i, j, k};
-        voxelPositions.emplace_back(p);
-
-        if (voxelsToChange.count(p) > 0) {
-          // Marked to change, so paint it:
-          if (brushReplacesBgWithFg) {
-            const int64_t currentLabel = seg.value<int64_t>(sk_comp, i, j, k).value_or(0);
-
-            if (labelToReplace == currentLabel) {
-              voxelValues.emplace_back(labelToPaint);
-            }
-            else {
-              voxelValues.emplace_back(currentLabel);
-            }
-          }
-          else {
-            voxelValues.emplace_back(labelToPaint);
-          }
-        }
-        else {
-          // Not marked to change, so replace with the current label:
-          voxelValues.emplace_back(seg.value<int64_t>(sk_comp, i, j, k).value_or(0));
-        }
-      }
-    }
-  }
+  const glm::ivec3& minVoxel = footprint.minVoxel;
+  const glm::ivec3& maxVoxel = footprint.maxVoxel;
 
-  if (voxelPositions.empty()) {
+  if (footprint.empty() || glm::any(glm::lessThan(maxVoxel, minVoxel))) {
     return;
   }
 
   const glm::uvec3 dataOffset{minVoxel};
   const glm::uvec3 dataSize{maxVoxel - minVoxel + sk_voxelOne};
 
-  // Safety check:
   const std::size_t N =
     static_cast<std::size_t>(dataSize.x) * static_cast<std::size_t>(dataSize.y) * static_cast<std::size_t>(dataSize.z);
 
-  if (N != voxelPositions.size() || N != voxelValues.size()) {
+  // Create a rectangular block of contiguous voxel value data for changed-region consumers:
+  std::vector<int64_t> voxelValues(N);
+
+  if (!paintFootprintSpans(footprint, labelToPaint, labelToReplace, brushReplacesBgWithFg, seg, voxelValues.data())) {
     spdlog::error("Invalid number of voxels when performing segmentation");
     return;
   }
 
-  // Set values in the segmentation image:
-  for (std::size_t i = 0; i < voxelPositions.size(); ++i) {
-    seg.setValue(sk_comp, voxelPositions[i].x, voxelPositions[i].y, voxelPositions[i].z, voxelValues[i]);
+  notifyVoxelsChanged(seg.header().memoryComponentType(), dataOffset, dataSize, voxelValues.data());
+}
+
+void updateSegmentationVoxels(
+  const SegmentationBrushFootprint& footprint,
+
+  int64_t labelToPaint,
+  int64_t labelToReplace,
+  bool brushReplacesBgWithFg,
+
+  Image& seg,
+
+  const SegmentationRegionUpdateCallback& notifyRegionChanged)
+{
+  static const glm::ivec3 sk_voxelOne{1, 1, 1};
+
+  const glm::ivec3& minVoxel = footprint.minVoxel;
+  const glm::ivec3& maxVoxel = footprint.maxVoxel;
+
+  if (footprint.empty() || glm::any(glm::lessThan(maxVoxel, minVoxel))) {
+    return;
+  }
+
+  if (!paintFootprintSpans(footprint, labelToPaint, labelToReplace, brushReplacesBgWithFg, seg, nullptr)) {
+    spdlog::error("Segmentation footprint lies outside of the segmentation");
+    return;
   }
 
-  notifyVoxelsChanged(seg.header().memoryComponentType(), dataOffset, dataSize, voxelValues.data());
+  notifyRegionChanged(glm::uvec3{minVoxel}, glm::uvec3{maxVoxel - minVoxel + sk_voxelOne});
+}
+
+void updateSegmentationVoxels(
+  const SegmentationVoxelSet& voxelsToChange,
+  const glm::ivec3& minVoxel,
+  const glm::ivec3& maxVoxel,
+
+  int64_t labelToPaint,
+  int64_t labelToReplace,
+  bool brushReplacesBgWithFg,
+
+  Image& seg,
+
+  const SegmentationVoxelUpdateCallback& notifyVoxelsChanged)
+{
+  if (glm::any(glm::lessThan(maxVoxel, minVoxel))) {
+    return;
+  }
+
+  SegmentationBrushFootprint footprint = makeSegmentationFootprint(voxelsToChange);
+  if (footprint.empty()) {
+    return;
+  }
+
+  // Keep the caller's block, which may be larger than the voxels to change
+  footprint.minVoxel = glm::min(footprint.minVoxel, minVoxel);
+  footprint.maxVoxel = glm::max(footprint.maxVoxel, maxVoxel);
+
+  updateSegmentationVoxels(footprint, labelToPaint, labelToReplace, brushReplacesBgWithFg, seg, notifyVoxelsChanged);
 }
 
 SegmentationBrushFootprint computeSegmentationBrushFootprint(
@@ -300,8 +543,10 @@ SegmentationBrushFootprint computeSegmentationBrushFootprint(
   const glm::vec4& voxelViewPlane,
   std::optional<glm::vec3> referenceSpacing)
 {
-  std::array<float, 3> mmToVoxelSpacings{1.0f, 1.0f, 1.0f};
-  std::array<int, 3> mmToVoxelCoeffs{1, 1, 1};
+  BrushStencilParams params;
+  params.brushIsRound = brushIsRound;
+  params.brushIs3d = brushIs3d;
+  params.brushSizeInVoxels = brushSizeInVoxels;
 
   if (brushIsIsotropic) {
     static constexpr bool sk_isotropicAlongMaxSpacingAxis = false;
@@ -309,32 +554,98 @@ SegmentationBrushFootprint computeSegmentationBrushFootprint(
     const float spacing = (sk_isotropicAlongMaxSpacingAxis) ? glm::compMax(brushSpacing) : glm::compMin(brushSpacing);
 
     for (uint32_t i = 0; i < 3; ++i) {
-      mmToVoxelSpacings[i] = spacing / seg.header().spacing()[static_cast<int>(i)];
-      mmToVoxelCoeffs[i] = std::max(static_cast<int>(std::ceil(mmToVoxelSpacings[i])), 1);
+      params.mmToVoxelSpacings[i] = spacing / seg.header().spacing()[static_cast<int>(i)];
+      params.mmToVoxelCoeffs[i] = std::max(static_cast<int>(std::ceil(params.mmToVoxelSpacings[i])), 1);
     }
   }
 
-  SegmentationBrushFootprint footprint;
-  if (brushIs3d) {
-    std::tie(footprint.voxels, footprint.minVoxel, footprint.maxVoxel) = paintBrush3d(
-      seg.header().pixelDimensions(),
-      roundedPixelPos,
-      mmToVoxelSpacings,
-      mmToVoxelCoeffs,
-      brushSizeInVoxels,
-      brushIsRound);
+  const glm::ivec3 segDims{seg.header().pixelDimensions()};
+  if (glm::any(glm::lessThan(roundedPixelPos, glm::ivec3{0})) ||
+      glm::any(glm::greaterThanEqual(roundedPixelPos, segDims)))
+  {
+    return {};
   }
-  else {
-    std::tie(footprint.voxels, footprint.minVoxel, footprint.maxVoxel) = paintBrush2d(
-      voxelViewPlane,
-      seg.header().pixelDimensions(),
-      roundedPixelPos,
-      mmToVoxelSpacings,
+
+  if (!brushIs3d) {
+    // Express the view plane relative to the brush center, so that the stencil can be reused
+    // wherever the plane passes through the center voxel in the same way
+    const glm::vec3 normal{voxelViewPlane};
+    params.relativeViewPlane = glm::vec4{normal, voxelViewPlane.w + glm::dot(normal, glm::vec3{roundedPixelPos})};
+
+    // Connectivity within the plane depends on the image bounds, so stencils that reach outside
+    // of the segmentation are built for this position and not cached
+    const glm::ivec3 clipLo = -roundedPixelPos;
+    const glm::ivec3 clipHi = segDims - glm::ivec3{1} - roundedPixelPos;
+    const glm::ivec3 half = params.halfExtent();
+
+    if (glm::any(glm::lessThan(-half, clipLo)) || glm::any(glm::greaterThan(half, clipHi))) {
+      return stampBrushStencil(buildBrushStencil2d(params, clipLo, clipHi), roundedPixelPos, segDims);
+    }
+  }
+
+  return stampBrushStencil(*cachedBrushStencil(params), roundedPixelPos, segDims);
+}
+
+SegmentationBrushFootprint computeSegmentationStrokeFootprint(
+  const Image& seg,
+  bool brushIsRound,
+  bool brushIs3d,
+  bool brushIsIsotropic,
+  int brushSizeInVoxels,
+  const glm::vec3& startPixelPos,
+  const glm::vec3& endPixelPos,
+  const glm::vec4& voxelViewPlane,
+  std::optional<glm::vec3> referenceSpacing)
+{
+  const glm::vec3 delta = endPixelPos - startPixelPos;
+  const int numSteps = static_cast<int>(std::ceil(glm::compMax(glm::abs(delta))));
+
+  SegmentationBrushFootprint stroke;
+  stroke.minVoxel = glm::ivec3{std::numeric_limits<int>::max()};
+  stroke.maxVoxel = glm::ivec3{std::numeric_limits<int>::lowest()};
+
+  // Skip the start stamp, unless it is the only one:
+  const glm::ivec3 startCenter{glm::round(startPixelPos)};
+  std::optional<glm::ivec3> lastCenter;
+  if (startCenter != glm::ivec3{glm::round(endPixelPos)}) {
+    lastCenter = startCenter;
+  }
+
+  // Stamp at most one voxel apart, so that consecutive stamps overlap:
+  for (int step = 0; step <= numSteps; ++step) {
+    const float t = (numSteps > 0) ? static_cast<float>(step) / static_cast<float>(numSteps) : 1.0f;
+    const glm::ivec3 center{glm::round(startPixelPos + t * delta)};
+
+    if (lastCenter && *lastCenter == center) {
+      continue;
+    }
+    lastCenter = center;
+
+    const SegmentationBrushFootprint stamp = computeSegmentationBrushFootprint(
+      seg,
+      brushIsRound,
+      brushIs3d,
+      brushIsIsotropic,
       brushSizeInVoxels,
-      brushIsRound);
+      center,
+      voxelViewPlane,
+      referenceSpacing);
+
+    if (stamp.empty()) {
+      continue;
+    }
+
+    stroke.spans.insert(stroke.spans.end(), stamp.spans.begin(), stamp.spans.end());
+    stroke.minVoxel = glm::min(stroke.minVoxel, stamp.minVoxel);
+    stroke.maxVoxel = glm::max(stroke.maxVoxel, stamp.maxVoxel);
   }
 
-  return footprint;
+  if (stroke.empty()) {
+    return {};
+  }
+
+  mergeFootprintSpans(stroke);
+  return stroke;
 }
 
 void paintSegmentation(
@@ -363,14 +674,12 @@ void paintSegmentation(
     roundedPixelPos,
     voxelViewPlane,
     referenceSpacing);
-  if (footprint.voxels.empty()) {
+  if (footprint.empty()) {
     return;
   }
 
   updateSegmentationVoxels(
-    footprint.voxels,
-    footprint.minVoxel,
-    footprint.maxVoxel,
+    footprint,
     labelToPaint,
     labelToReplace,
     brushReplacesBgWithFg,
@@ -7,10 +7,12 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <optional>
 #include <unordered_set>
+#include <vector>
 
 class Image;
 
@@ -29,18 +31,64 @@ using SegmentationVoxelUpdateCallback = std::function<void(
   const glm::uvec3& size,
   const int64_t* data)>;
 
+/**
+ * @brief Callback invoked after a contiguous block of segmentation voxels changes, for consumers that
+ * read changed labels from the segmentation itself. It receives the changed block offset and size.
+ */
+using SegmentationRegionUpdateCallback = std::function<void(const glm::uvec3& offset, const glm::uvec3& size)>;
+
+/**
+ * @brief Run of consecutive voxels along the x axis of an image row.
+ */
+struct SegmentationVoxelSpan
+{
+  int y = 0;
+  int z = 0;
+  int xBegin = 0; //!< First voxel of the run
+  int xEnd = 0;   //!< One past the last voxel of the run
+};
+
 /**
  * @brief Voxel footprint of a segmentation brush in image voxel coordinates.
+ *
+ * The footprint is encoded as row spans, which are disjoint and ordered by z, y and x.
  */
 struct SegmentationBrushFootprint
 {
-  SegmentationVoxelSet voxels; //!< Unique voxels touched by the brush
-  glm::ivec3 minVoxel{0};      //!< Minimum touched voxel coordinate
-  glm::ivec3 maxVoxel{0};      //!< Maximum touched voxel coordinate
+  std::vector<SegmentationVoxelSpan> spans; //!< Runs of voxels touched by the brush
+  glm::ivec3 minVoxel{0};                   //!< Minimum touched voxel coordinate
+  glm::ivec3 maxVoxel{0};                   //!< Maximum touched voxel coordinate
+
+  bool empty() const;
+
+  /// @brief Number of voxels touched by the brush.
+  std::size_t numVoxels() const;
+
+  /// @brief Return true when the brush touches a voxel.
+  bool contains(const glm::ivec3& voxel) const;
+
+  /// @brief Call a function with every touched voxel, in span order.
+  template<typename Fn>
+  void forEachVoxel(Fn&& fn) const
+  {
+    for (const SegmentationVoxelSpan& span : spans) {
+      for (int x = span.xBegin; x < span.xEnd; ++x) {
+        fn(glm::ivec3{x, span.y, span.z});
+      }
+    }
+  }
 };
 
 /**
- * @brief Compute the set of voxels touched by a segmentation brush.
+ * @brief Encode a set of voxels as a footprint of row spans.
+ */
+SegmentationBrushFootprint makeSegmentationFootprint(const SegmentationVoxelSet& voxels);
+
+/**
+ * @brief Compute the voxels touched by a segmentation brush.
+ *
+ * Footprints are stamped from brush stencils that are cached by brush size, shape, voxel spacing and,
+ * for 2D brushes, by the view plane relative to the brush center. Stencils are clipped to the image.
  * @param seg Segmentation image defining bounds and spacing.
  * @param brushIsRound When true, use an ellipsoidal/circular footprint rather than a box.
  * @param brushIs3d When true, include voxels through-plane; otherwise restrict to the view plane.
@@ -60,6 +108,27 @@ SegmentationBrushFootprint computeSegmentationBrushFootprint(
   const glm::vec4& voxelViewPlane,
   std::optional<glm::vec3> referenceSpacing = std::nullopt);
 
+/**
+ * @brief Compute the voxels touched by a segmentation brush swept along a straight stroke segment.
+ *
+ * The brush is stamped at every voxel step from the start to the end position, so that strokes leave
+ * no gaps however far the cursor moves between events. The stamp at the start position is omitted,
+ * since it belongs to the previous stroke segment, unless the start and end voxels are the same.
+ * @param startPixelPos Stroke segment start in voxel coordinates.
+ * @param endPixelPos Stroke segment end in voxel coordinates.
+ * @see computeSegmentationBrushFootprint for the other parameters.
+ */
+SegmentationBrushFootprint computeSegmentationStrokeFootprint(
+  const Image& seg,
+  bool brushIsRound,
+  bool brushIs3d,
+  bool brushIsIsotropic,
+  int brushSizeInVoxels,
+  const glm::vec3& startPixelPos,
+  const glm::vec3& endPixelPos,
+  const glm::vec4& voxelViewPlane,
+  std::optional<glm::vec3> referenceSpacing = std::nullopt);
+
 /**
  * @brief Paint labels into a segmentation image using a computed brush footprint.
  * @param seg Segmentation image to modify.
@@ -93,6 +162,43 @@ void paintSegmentation(
 
   const SegmentationVoxelUpdateCallback& notifyVoxelsChanged);
 
+/**
+ * @brief Paint labels into the voxels of a footprint, one image row span at a time.
+ * @param footprint Voxels eligible for update, which must lie inside the segmentation.
+ * @param labelToPaint Label written to changed voxels.
+ * @param labelToReplace Label eligible for replacement when brushReplacesBgWithFg is true.
+ * @param brushReplacesBgWithFg When true, only voxels with labelToReplace are painted.
+ * @param seg Segmentation image to modify.
+ * @param notifyVoxelsChanged Callback receiving the footprint's bounding block of voxel labels.
+ */
+void updateSegmentationVoxels(
+  const SegmentationBrushFootprint& footprint,
+
+  int64_t labelToPaint,
+  int64_t labelToReplace,
+  bool brushReplacesBgWithFg,
+
+  Image& seg,
+
+  const SegmentationVoxelUpdateCallback& notifyVoxelsChanged);
+
+/**
+ * @brief Paint labels into the voxels of a footprint, visiting only the voxels of its spans. Unlike
+ * the overload above, no copy of the changed block is made.
+ * @param notifyRegionChanged Callback receiving the footprint's bounding block.
+ * @see updateSegmentationVoxels for the other parameters.
+ */
+void updateSegmentationVoxels(
+  const SegmentationBrushFootprint& footprint,
+
+  int64_t labelToPaint,
+  int64_t labelToReplace,
+  bool brushReplacesBgWithFg,
+
+  Image& seg,
+
+  const SegmentationRegionUpdateCallback& notifyRegionChanged);
+
 /**
  * @brief Apply a precomputed set of segmentation voxel updates.
  * @param voxelsToChange Voxels eligible for update.
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Reference-counted, copy-on-write storage for the pixel component buffers of an image.
+ *
+ * Copies of this object share the same underlying buffers, so copying an Image (for example, to hand
+ * it to a background task) does not copy voxels. Read access never copies. The first mutable access
+ * through mutableBuffers() or mutableAt() on storage that is shared with another copy detaches this
+ * object by deep-copying the buffers, leaving the other copies unchanged.
+ *
+ * Sharing is tracked by an explicit owner count rather than by shared_ptr::use_count(), which is only
+ * a relaxed snapshot. Copies that are destroyed or reassigned release the count, and detaching
+ * acquires it, so the reads of a copy released on another thread (e.g. by a std::async task) happen
+ * before this object writes in place.
+ *
+ * @note As for any standard library object, one SharedComponentBuffers object must not be copied on
+ * one thread while it is mutated on another. Copies of it may be used on any thread.
+ * @note Mutable references and pointers obtained from this object must not be held across copies
+ * of it: writes through them after a copy would be visible to every copy that shares the storage.
+ */
+template<typename T>
+class SharedComponentBuffers
+{
+public:
+  using value_type = T;
+  using Buffer = std::vector<T>;
+  using Buffers = std::vector<Buffer>;
+
+  SharedComponentBuffers() = default;
+
+  /// @brief Take ownership of existing buffers without copying them.
+  explicit SharedComponentBuffers(Buffers buffers)
+    : m_storage(std::make_shared<Storage>(std::move(buffers)))
+  {
+  }
+
+  SharedComponentBuffers(const SharedComponentBuffers& other)
+    : m_storage(other.m_storage)
+  {
+    acquireOwnership();
+  }
+
+  SharedComponentBuffers(SharedComponentBuffers&& other) noexcept
+    : m_storage(std::move(other.m_storage))
+  {
+  }
+
+  SharedComponentBuffers& operator=(const SharedComponentBuffers& other)
+  {
+    if (m_storage != other.m_storage) {
+      releaseOwnership();
+      m_storage = other.m_storage;
+      acquireOwnership();
+    }
+    return *this;
+  }
+
+  SharedComponentBuffers& operator=(SharedComponentBuffers&& other) noexcept
+  {
+    if (this != &other) {
+      releaseOwnership();
+      m_storage = std::move(other.m_storage);
+    }
+    return *this;
+  }
+
+  ~SharedComponentBuffers()
+  {
+    releaseOwnership();
+  }
+
+  /// @brief Read-only access to all buffers. Never copies.
+  const Buffers& buffers() const
+  {
+    return m_storage ? m_storage->buffers : emptyBuffers();
+  }
+
+  /// @brief Mutable access to all buffers, detaching from other copies first when shared.
+  Buffers& mutableBuffers()
+  {
+    detach();
+    return m_storage->buffers;
+  }
+
+  /// @brief Mutable access to one buffer, detaching from other copies first when shared.
+  /// @throws std::out_of_range if \p i is not a valid buffer index.
+  Buffer& mutableAt(std::size_t i)
+  {
+    return mutableBuffers().at(i);
+  }
+
+  /// @brief Read-only access to one buffer.
+  const Buffer& operator[](std::size_t i) const
+  {
+    return buffers()[i];
+  }
+
+  /// @brief Read-only access to one buffer.
+  /// @throws std::out_of_range if \p i is not a valid buffer index.
+  const Buffer& at(std::size_t i) const
+  {
+    return buffers().at(i);
+  }
+
+  std::size_t size() const
+  {
+    return buffers().size();
+  }
+
+  bool empty() const
+  {
+    return buffers().empty();
+  }
+
+  auto begin() const
+  {
+    return buffers().begin();
+  }
+
+  auto end() const
+  {
+    return buffers().end();
+  }
+
+  /// @brief Drop this object's reference to the buffers. Other copies keep their data.
+  void clear()
+  {
+    releaseOwnership();
+    m_storage.reset();
+  }
+
+  /// @brief Return true when the buffers are currently shared with at least one other copy.
+  bool isShared() const
+  {
+    return m_storage && m_storage->owners.load(std::memory_order_acquire) > 1;
+  }
+
+  /// @brief Return true when this object and \p other refer to the same underlying buffers.
+  bool sharesStorageWith(const SharedComponentBuffers& other) const
+  {
+    return m_storage && m_storage == other.m_storage;
+  }
+
+private:
+  struct Storage
+  {
+    explicit Storage(Buffers b)
+      : buffers(std::move(b))
+    {
+    }
+
+    Buffers buffers;
+
+    /// Number of SharedComponentBuffers objects that refer to this storage
+    std::atomic<std::size_t> owners{1};
+  };
+
+  void acquireOwnership()
+  {
+    if (m_storage) {
+      m_storage->owners.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void releaseOwnership()
+  {
+    if (m_storage) {
+      m_storage->owners.fetch_sub(1, std::memory_order_release);
+    }
+  }
+
+  static const Buffers& emptyBuffers()
+  {
+    static const Buffers s_empty;
+    return s_empty;
+  }
+
+  /// Ensure this object is the sole owner of its buffers. Owners are only added by copying an
+  /// existing owner, so once the count reads one, no other thread can share the buffers again.
+  void detach()
+  {
+    if (!m_storage) {
+      m_storage = std::make_shared<Storage>(Buffers{});
+    }
+    else if (m_storage->owners.load(std::memory_order_acquire) > 1) {
+      auto copy = std::make_shared<Storage>(m_storage->buffers);
+      releaseOwnership();
+      m_storage = std::move(copy);
+    }
+  }
+
+  std::shared_ptr<Storage> m_storage;
+};
@@ -25,6 +25,79 @@ uint32_t nextPlaybackTimePoint(uint32_t activeTimePoint, uint32_t numTimePoints,
   return loop ? 0u : maxTimePoint;
 }
 
+uint32_t stepPlaybackTimePoint(
+  uint32_t activeTimePoint,
+  uint32_t numTimePoints,
+  bool loop,
+  bool bounce,
+  int& direction)
+{
+  if (numTimePoints <= 1u) {
+    return 0u;
+  }
+
+  const uint32_t maxTimePoint = numTimePoints - 1u;
+  const uint32_t clamped = std::min(activeTimePoint, maxTimePoint);
+
+  if (bounce) {
+    if (direction > 0 && clamped == maxTimePoint) {
+      direction = -1;
+    }
+    else if (direction < 0 && clamped == 0u) {
+      direction = 1;
+    }
+    return (direction > 0) ? clamped + 1u : clamped - 1u;
+  }
+
+  if (direction > 0) {
+    return nextPlaybackTimePoint(clamped, numTimePoints, loop);
+  }
+  if (clamped > 0u) {
+    return clamped - 1u;
+  }
+  return loop ? maxTimePoint : 0u;
+}
+
+std::vector<uint32_t> upcomingPlaybackTimePoints(
+  uint32_t activeTimePoint,
+  uint32_t numTimePoints,
+  bool loop,
+  bool bounce,
+  int direction,
+  uint32_t maxCount)
+{
+  std::vector<uint32_t> timePoints;
+  uint32_t timePoint = activeTimePoint;
+
+  // Two passes over the series cover a full cycle of bouncing playback
+  for (uint32_t step = 0; step < 2u * numTimePoints && timePoints.size() < maxCount; ++step) {
+    const uint32_t next = stepPlaybackTimePoint(timePoint, numTimePoints, loop, bounce, direction);
+    if (next == timePoint) {
+      break;
+    }
+    if (next != activeTimePoint && std::ranges::find(timePoints, next) == timePoints.end()) {
+      timePoints.push_back(next);
+    }
+    timePoint = next;
+  }
+  return timePoints;
+}
+
+int readAheadDirection(uint32_t fromTimePoint, uint32_t toTimePoint, uint32_t numTimePoints)
+{
+  if (numTimePoints <= 1u) {
+    return 1;
+  }
+
+  if (toTimePoint == (fromTimePoint + 1u) % numTimePoints) {
+    return 1;
+  }
+  if (toTimePoint == (fromTimePoint + numTimePoints - 1u) % numTimePoints) {
+    return -1;
+  }
+  return (toTimePoint >= fromTimePoint) ? 1 : -1;
+}
+
 TimePlaybackUpdate updateTimePlaybackFrame(TimePlaybackState& state, const TimePlaybackInput& input)
 {
   const uint32_t numTimePoints = std::max(1u, input.numTimePoints);
@@ -36,6 +109,10 @@ TimePlaybackUpdate updateTimePlaybackFrame(TimePlaybackState& state, const TimeP
     .advanced = false,
     .playingChanged = false};
 
+  if (!input.bounce) {
+    state.direction = 1;
+  }
+
   if (!input.playing || numTimePoints <= 1u) {
     state.lastAdvanceTimeSeconds = 0.0;
     return update;
@@ -46,21 +123,47 @@ TimePlaybackUpdate updateTimePlaybackFrame(TimePlaybackState& state, const TimeP
     return update;
   }
 
-  if (input.nowSeconds - state.lastAdvanceTimeSeconds < safeFramePeriod(input.framePeriodSeconds)) {
+  const double framePeriod = safeFramePeriod(input.framePeriodSeconds);
+  const double elapsedSeconds = input.nowSeconds - state.lastAdvanceTimeSeconds;
+  if (elapsedSeconds < framePeriod) {
     return update;
   }
 
-  const uint32_t requestedTimePoint = nextPlaybackTimePoint(activeTimePoint, numTimePoints, input.loop);
-  if (requestedTimePoint == activeTimePoint && !input.loop) {
+  // Step over every frame that was due since the last advance, so that late updates do not slow playback down
+  const double dueFramesCount = std::floor(elapsedSeconds / framePeriod);
+  const uint32_t dueFrames =
+    static_cast<uint32_t>(std::clamp(dueFramesCount, 1.0, static_cast<double>(numTimePoints)));
+
+  uint32_t requestedTimePoint = activeTimePoint;
+  uint32_t numSteps = 0;
+  for (; numSteps < dueFrames; ++numSteps) {
+    const uint32_t next =
+      stepPlaybackTimePoint(requestedTimePoint, numTimePoints, input.loop, input.bounce, state.direction);
+    if (next == requestedTimePoint) {
+      break;
+    }
+    requestedTimePoint = next;
+  }
+
+  if (0 == numSteps) {
     state.lastAdvanceTimeSeconds = 0.0;
     update.playing = false;
     update.playingChanged = true;
     return update;
   }
 
-  state.lastAdvanceTimeSeconds = input.nowSeconds;
+  // Keep the cadence of the requested frame rate, unless playback stalled for longer than the whole series
+  state.lastAdvanceTimeSeconds += dueFrames * framePeriod;
+  if (input.nowSeconds - state.lastAdvanceTimeSeconds >= framePeriod) {
+    state.lastAdvanceTimeSeconds = input.nowSeconds;
+  }
+
+  state.numShownFrames += 1;
+  state.numDroppedFrames += numSteps - 1u;
+
   update.timePoint = requestedTimePoint;
-  update.advanced = requestedTimePoint != activeTimePoint;
+  update.advanced = true;
+  update.droppedFrames = numSteps - 1u;
   return update;
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 
 /**
  * @brief State retained between time-series playback ticks.
@@ -8,6 +9,9 @@
 struct TimePlaybackState
 {
   double lastAdvanceTimeSeconds = 0.0; //!< Wall-clock time of the previous frame advance
+  int direction = 1;                   //!< Playback direction: +1 forwards, -1 backwards while bouncing
+  uint64_t numShownFrames = 0;         //!< Frames shown since playback started
+  uint64_t numDroppedFrames = 0;       //!< Frames skipped since playback started to keep the frame rate
 };
 
 /**
@@ -17,6 +21,7 @@ struct TimePlaybackInput
 {
   bool playing = false;            //!< Whether playback is currently running
   bool loop = true;                //!< Whether playback wraps from the last frame to the first
+  bool bounce = false;             //!< Whether playback reverses at the first and last frames (overrides loop)
   uint32_t activeTimePoint = 0;    //!< Currently displayed time point
   uint32_t numTimePoints = 1;      //!< Number of available time points
   double framePeriodSeconds = 0.1; //!< Playback period for one frame
@@ -32,6 +37,7 @@ struct TimePlaybackUpdate
   bool playing = false;        //!< Whether playback should remain active
   bool advanced = false;       //!< True when the displayed frame changed
   bool playingChanged = false; //!< True when playback should be started or stopped
+  uint32_t droppedFrames = 0;  //!< Frames skipped by this update because it ran late
 };
 
 /**
@@ -43,8 +49,59 @@ struct TimePlaybackUpdate
  */
 uint32_t nextPlaybackTimePoint(uint32_t activeTimePoint, uint32_t numTimePoints, bool loop);
 
+/**
+ * @brief Step one frame in a playback direction, respecting the loop and bounce settings.
+ * @param activeTimePoint Currently displayed time point.
+ * @param numTimePoints Number of available time points.
+ * @param loop Whether to wrap at the ends.
+ * @param bounce Whether to reverse at the ends. Takes precedence over \p loop.
+ * @param[in,out] direction Playback direction (+1 or -1), which is reversed when bouncing off an end.
+ * @return Next time point, or \p activeTimePoint when playback cannot continue.
+ */
+uint32_t stepPlaybackTimePoint(
+  uint32_t activeTimePoint,
+  uint32_t numTimePoints,
+  bool loop,
+  bool bounce,
+  int& direction);
+
+/**
+ * @brief Time points that playback will show next, in order, so that they can be read ahead.
+ * @param activeTimePoint Currently displayed time point, which is not included.
+ * @param numTimePoints Number of available time points.
+ * @param loop Whether playback wraps at the ends.
+ * @param bounce Whether playback reverses at the ends.
+ * @param direction Current playback direction (+1 or -1).
+ * @param maxCount Maximum number of time points to return.
+ * @return Distinct upcoming time points other than the active one, stopping early at the end of non-looping playback.
+ */
+std::vector<uint32_t> upcomingPlaybackTimePoints(
+  uint32_t activeTimePoint,
+  uint32_t numTimePoints,
+  bool loop,
+  bool bounce,
+  int direction,
+  uint32_t maxCount);
+
+/**
+ * @brief Direction in which to read time frames ahead after moving between two time points.
+ *
+ * A step to the next or previous time point, including the wrap between the last and first time
+ * points, gives that direction. Larger jumps read forwards unless they go back in time.
+ *
+ * @param fromTimePoint Previously displayed time point.
+ * @param toTimePoint Newly displayed time point.
+ * @param numTimePoints Number of available time points.
+ * @return +1 to read ahead forwards, -1 to read ahead backwards.
+ */
+int readAheadDirection(uint32_t fromTimePoint, uint32_t toTimePoint, uint32_t numTimePoints);
+
 /**
  * @brief Advance time-series playback if enough wall-clock time has elapsed.
+ *
+ * Playback keeps to the requested frame rate: when an update runs more than one frame period late, the frames that were
+ * due in between are skipped and counted as dropped.
+ *
  * @param state Mutable playback state retained between calls.
  * @param input Playback inputs for this tick.
  * @return Requested playback update.
@@ -145,22 +145,21 @@ std::expected<FieldImage::Pointer, std::string> makeFieldFromImage(const Image&
   }
 
   FieldImage::Pointer field = makeFieldLikeDomain(image);
-  itk::ImageRegionIterator<FieldImage> it(field, field->GetLargestPossibleRegion());
-  for (it.GoToBegin(); !it.IsAtEnd(); ++it) {
-    const FieldImage::IndexType index = it.GetIndex();
-    const uint64_t linearIndex =
-      static_cast<uint64_t>(index[0]) +
-      static_cast<uint64_t>(image.header().pixelDimensions().x) *
-        (static_cast<uint64_t>(index[1]) +
-         static_cast<uint64_t>(image.header().pixelDimensions().y) * static_cast<uint64_t>(index[2]));
 
-    const auto dx = image.value<float>(0, linearIndex);
-    const auto dy = image.value<float>(1, linearIndex);
-    const auto dz = image.value<float>(2, linearIndex);
-    if (!dx || !dy || !dz) {
-      return std::unexpected(std::format("Unable to read warp value at pixel {}", linearIndex));
+  // The field region iterator and the image views both visit pixels in x-fastest order
+  const bool copied = image.visitComponentViews<3>(0, [&field](const auto& views) {
+    itk::ImageRegionIterator<FieldImage> it(field, field->GetLargestPossibleRegion());
+    std::size_t linearIndex = 0;
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it, ++linearIndex) {
+      it.Set(makeVectorPixel(
+        static_cast<float>(views[0][linearIndex]),
+        static_cast<float>(views[1][linearIndex]),
+        static_cast<float>(views[2][linearIndex])));
     }
-    it.Set(makeVectorPixel(*dx, *dy, *dz));
+  });
+
+  if (!copied) {
+    return std::unexpected("Unable to read warp field components");
   }
 
   return field;
@@ -5,9 +5,61 @@
 
 #include <spdlog/spdlog.h>
 
+#include <cmath>
 #include <limits>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+/**
+ * @brief Convert one component value to a destination component type, clamping to its range.
+ * @tparam DstCompType Destination component type.
+ * @tparam SrcCompType Source component type.
+ * @param[in] value Source value.
+ * @return \p value clamped to [lowest, max] of \p DstCompType. NaN converts to zero for integer
+ * destinations and is preserved for floating point destinations.
+ *
+ * Integer comparisons are sign-aware, so mixed signed/unsigned conversions clamp correctly without
+ * widening through a 64-bit intermediate.
+ */
+template<typename DstCompType, typename SrcCompType>
+DstCompType clampComponentValue(SrcCompType value)
+{
+  using DstLimits = std::numeric_limits<DstCompType>;
+
+  if constexpr (std::is_same_v<SrcCompType, DstCompType>) {
+    return value;
+  }
+  else if constexpr (std::is_integral_v<SrcCompType> && std::is_integral_v<DstCompType>) {
+    if (std::cmp_less(value, DstLimits::lowest())) {
+      return DstLimits::lowest();
+    }
+    if (std::cmp_greater(value, DstLimits::max())) {
+      return DstLimits::max();
+    }
+    return static_cast<DstCompType>(value);
+  }
+  else if constexpr (std::is_integral_v<SrcCompType>) {
+    // Every supported integer type fits in the range of a floating point destination
+    return static_cast<DstCompType>(value);
+  }
+  else {
+    if (std::isnan(value)) {
+      // NaN is meaningful in floating point images, but has no integer representation
+      return std::is_floating_point_v<DstCompType> ? static_cast<DstCompType>(value) : DstCompType{0};
+    }
+
+    const auto wide = static_cast<long double>(value);
+    if (wide <= static_cast<long double>(DstLimits::lowest())) {
+      return DstLimits::lowest();
+    }
+    if (wide >= static_cast<long double>(DstLimits::max())) {
+      return DstLimits::max();
+    }
+    return static_cast<DstCompType>(value);
+  }
+}
+
 /**
  * @brief Copy and clamp a raw typed buffer into a destination component vector.
  * @tparam SrcCompType Source component type in \p buffer.
@@ -19,10 +71,6 @@
 template<typename SrcCompType, typename DstCompType>
 std::vector<DstCompType> createBuffer_dispatch(const void* buffer, std::size_t numElements)
 {
-  // Lowest and max values of destination component type, cast to source component type
-  static const SrcCompType k_lowestValue = static_cast<SrcCompType>(std::numeric_limits<DstCompType>::lowest());
-  static const SrcCompType k_maximumValue = static_cast<SrcCompType>(std::numeric_limits<DstCompType>::max());
-
   std::vector<DstCompType> data(numElements, 0);
 
   if (!buffer) {
@@ -34,7 +82,7 @@ std::vector<DstCompType> createBuffer_dispatch(const void* buffer, std::size_t n
 
   // Clamp values to destination range [lowest, maximum] prior to cast:
   for (std::size_t i = 0; i < numElements; ++i) {
-    data[i] = static_cast<DstCompType>(std::min(std::max(bufferCast[i], k_lowestValue), k_maximumValue));
+    data[i] = clampComponentValue<DstCompType>(bufferCast[i]);
   }
 
   return data;
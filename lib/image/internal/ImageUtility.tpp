@@ -13,6 +13,7 @@
 #include "../Image.h"
 
 #include "../external/TDigest.h"
+#include "ImageCastHelper.tpp"
 
 #include <itkBinaryThresholdImageFilter.h>
 #include <itkCastImageFilter.h>
@@ -40,6 +41,7 @@
 #include <cstdio>
 #include <filesystem>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <numeric>
 #include <optional>
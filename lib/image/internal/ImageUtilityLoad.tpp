@@ -2,174 +2,445 @@
 
 /**
  * @file ImageUtilityLoad.tpp
- * @brief Template dispatcher for loading scalar and vector image buffers from disk.
+ * @brief Template dispatcher for loading image files directly into typed component buffers.
+ *
+ * Pixel data is read through the ITK ImageIO object in its on-disk component type and written
+ * straight into the final in-memory component buffers. When the on-disk component type and layout
+ * match the in-memory ones, ImageIO reads into the destination buffer in place. Otherwise, when the
+ * ImageIO supports streamed reads, the file is read in bounded chunks of slabs along the slowest axis
+ * and each chunk is clamped into the destination buffers. An ImageIO that cannot stream reads the
+ * whole image at once, so its pixels are held in their on-disk component type alongside the
+ * destination buffers until they are converted.
  */
 
 namespace image_utility_load_detail
 {
-template<typename ReadComponentType, uint32_t Dimension>
-bool loadImageAtDimension(
-  const std::filesystem::path& fileName,
+/// Approximate number of on-disk component values read per chunk when converting component types
+/// or splitting interleaved components into separate buffers
+constexpr std::size_t k_loadChunkComponents = std::size_t{1} << 24;
+
+/**
+ * @brief Build an ImageIO region covering a range of slabs along the slowest image axis.
+ * @param[in] imageIo ImageIO with image information already read.
+ * @param[in] firstSlab Index of the first slab along the last ImageIO axis.
+ * @param[in] numSlabs Number of slabs to cover.
+ */
+inline itk::ImageIORegion slabRegion(const itk::ImageIOBase& imageIo, std::size_t firstSlab, std::size_t numSlabs)
+{
+  const unsigned int numDims = imageIo.GetNumberOfDimensions();
+  itk::ImageIORegion region(numDims);
+
+  for (unsigned int d = 0; d < numDims; ++d) {
+    region.SetIndex(d, 0);
+    region.SetSize(d, imageIo.GetDimensions(d));
+  }
+
+  if (numDims > 0) {
+    region.SetIndex(numDims - 1, static_cast<itk::ImageIORegion::IndexValueType>(firstSlab));
+    region.SetSize(numDims - 1, numSlabs);
+  }
+
+  return region;
+}
+
+/**
+ * @brief Read one region of the image file into a raw buffer sized for that region.
+ * @return True when ImageIO read the region without throwing.
+ */
+inline bool readImageIoRegion(
+  itk::ImageIOBase& imageIo,
+  const itk::ImageIORegion& region,
+  void* buffer,
+  const std::filesystem::path& fileName)
+{
+  try {
+    imageIo.SetIORegion(region);
+    imageIo.Read(buffer);
+    return true;
+  }
+  catch (const std::exception& e) {
+    spdlog::error("Exception reading pixel data from {}: {}", fileName, e.what());
+    return false;
+  }
+}
+
+/**
+ * @brief Clamp a chunk of on-disk pixels into the destination component buffers.
+ * @param[in] src Chunk of on-disk pixels with \p numComponentsOnDisk interleaved components.
+ * @param[in] firstPixel Linear index of the first pixel of the chunk.
+ * @param[in] numPixels Number of pixels in the chunk.
+ */
+template<typename SrcType, typename DstType>
+void storeChunk(
+  const SrcType* src,
+  std::size_t firstPixel,
   std::size_t numPixels,
+  uint32_t numComponentsOnDisk,
   uint32_t componentsToLoad,
-  bool isMultiComponentImage,
   const Image::MultiComponentBufferType bufferType,
-  std::function<bool(const void* buffer, std::size_t numElements)> loadBuffer)
+  std::vector<std::vector<DstType>>& buffers)
 {
-  using ReadImageType = itk::Image<ReadComponentType, Dimension>;
-
-  if (isMultiComponentImage) {
-    constexpr bool pixelIsVector = true;
-    typename itk::ImageBase<Dimension>::Pointer baseImage =
-      readImage<ReadComponentType, Dimension, pixelIsVector>(fileName.string());
-    if (!baseImage) {
-      spdlog::error("Unable to read {}D vector ImageBase for image {}", Dimension, fileName);
-      return false;
+  if (Image::MultiComponentBufferType::InterleavedImage == bufferType || 1u == componentsToLoad) {
+    DstType* dst = buffers[0].data() + firstPixel * componentsToLoad;
+
+    if (numComponentsOnDisk == componentsToLoad) {
+      const std::size_t n = numPixels * componentsToLoad;
+      for (std::size_t i = 0; i < n; ++i) {
+        dst[i] = clampComponentValue<DstType>(src[i]);
+      }
+      return;
     }
 
-    std::vector<typename ReadImageType::Pointer> componentImages =
-      splitImageIntoComponents<ReadComponentType, Dimension>(baseImage);
+    for (std::size_t p = 0; p < numPixels; ++p) {
+      const SrcType* srcPixel = src + p * numComponentsOnDisk;
+      DstType* dstPixel = dst + p * componentsToLoad;
+      for (uint32_t c = 0; c < componentsToLoad; ++c) {
+        dstPixel[c] = clampComponentValue<DstType>(srcPixel[c]);
+      }
+    }
+    return;
+  }
 
-    if (componentImages.size() < componentsToLoad) {
-      spdlog::error(
-        "Only {} image component(s) were loaded from {}, but {} component(s) were expected",
-        componentImages.size(),
-        fileName,
-        componentsToLoad);
-      return false;
+  // Separate component buffers: write one component at a time so that each destination stream is
+  // sequential
+  for (uint32_t c = 0; c < componentsToLoad; ++c) {
+    DstType* dst = buffers[c].data() + firstPixel;
+    const SrcType* srcComponent = src + c;
+    for (std::size_t p = 0; p < numPixels; ++p) {
+      dst[p] = clampComponentValue<DstType>(srcComponent[p * numComponentsOnDisk]);
     }
+  }
+}
 
-    std::unique_ptr<ReadComponentType[]> allComponentBuffers = nullptr;
-    if (Image::MultiComponentBufferType::InterleavedImage == bufferType) {
-      allComponentBuffers = std::make_unique<ReadComponentType[]>(numPixels * componentsToLoad);
-      if (!allComponentBuffers) {
-        spdlog::error("Null buffer holding all components of image file {}", fileName);
-        return false;
-      }
+/**
+ * @brief Allocate the final in-memory buffers for \p numPixels pixels, replacing existing contents.
+ */
+template<typename DstType>
+void allocateComponentBuffers(
+  std::size_t numPixels,
+  uint32_t componentsToLoad,
+  const Image::MultiComponentBufferType bufferType,
+  std::vector<std::vector<DstType>>& buffers)
+{
+  buffers.clear();
+  if (Image::MultiComponentBufferType::InterleavedImage == bufferType || 1u == componentsToLoad) {
+    buffers.emplace_back(numPixels * componentsToLoad);
+  }
+  else {
+    buffers.resize(componentsToLoad);
+    for (auto& buffer : buffers) {
+      buffer.resize(numPixels);
     }
+  }
+}
 
-    for (uint32_t component = 0; component < componentsToLoad; ++component) {
-      const ReadComponentType* buffer =
-        componentImages[component] ? componentImages[component]->GetBufferPointer() : nullptr;
-      if (!buffer) {
-        spdlog::error("Null buffer of image component {} for image file {}", component, fileName);
-        return false;
-      }
+/**
+ * @brief Load all pixels of a file with on-disk component type \p SrcType into \p DstType buffers.
+ */
+template<typename SrcType, typename DstType>
+bool loadImageIoAs(
+  itk::ImageIOBase& imageIo,
+  const std::filesystem::path& fileName,
+  std::size_t numPixels,
+  uint32_t numComponentsOnDisk,
+  uint32_t componentsToLoad,
+  const Image::MultiComponentBufferType bufferType,
+  std::vector<std::vector<DstType>>& buffers)
+{
+  const unsigned int numDims = imageIo.GetNumberOfDimensions();
+  if (0 == numDims || 0 == numPixels || 0 == numComponentsOnDisk) {
+    spdlog::error("Image file {} has no pixel data to load", fileName);
+    return false;
+  }
 
-      switch (bufferType) {
-        case Image::MultiComponentBufferType::SeparateImages: {
-          if (!loadBuffer(static_cast<const void*>(buffer), numPixels)) {
-            spdlog::error("Error loading separated image component buffer {} for image file {}", component, fileName);
-            return false;
-          }
-          break;
-        }
-        case Image::MultiComponentBufferType::InterleavedImage: {
-          for (std::size_t pixel = 0; pixel < numPixels; ++pixel) {
-            allComponentBuffers[componentsToLoad * pixel + component] = buffer[pixel];
-          }
-          break;
-        }
-      }
+  const std::size_t numElementsOnDisk = numPixels * numComponentsOnDisk;
+  if (imageIo.GetImageSizeInComponents() != numElementsOnDisk) {
+    spdlog::error(
+      "Image file {} holds {} components, but {} pixels with {} components each were expected",
+      fileName,
+      imageIo.GetImageSizeInComponents(),
+      numPixels,
+      numComponentsOnDisk);
+    return false;
+  }
+
+  allocateComponentBuffers(numPixels, componentsToLoad, bufferType, buffers);
+
+  const itk::ImageIORegion fullRegion = slabRegion(imageIo, 0, imageIo.GetDimensions(numDims - 1));
+
+  // In-place read: the on-disk layout is exactly the in-memory layout
+  if constexpr (std::is_same_v<SrcType, DstType>) {
+    if (numComponentsOnDisk == componentsToLoad && 1u == buffers.size()) {
+      spdlog::debug("Reading {} components from {} in place", numElementsOnDisk, fileName);
+      return readImageIoRegion(imageIo, fullRegion, buffers[0].data(), fileName);
     }
+  }
 
-    if (Image::MultiComponentBufferType::InterleavedImage == bufferType) {
-      const std::size_t numElements = numPixels * componentsToLoad;
-      if (!loadBuffer(static_cast<const void*>(allComponentBuffers.get()), numElements)) {
-        spdlog::error("Error loading interleaved image buffer for image file {}", fileName);
-        return false;
-      }
+  // Slabs along the last ImageIO axis hold whole pixels, unless that axis encodes components
+  std::size_t numSlabs = imageIo.GetDimensions(numDims - 1);
+  if (0 == numSlabs || 0 != numPixels % numSlabs) {
+    numSlabs = 1;
+  }
+
+  const std::size_t pixelsPerSlab = numPixels / numSlabs;
+  const std::size_t componentsPerSlab = pixelsPerSlab * numComponentsOnDisk;
+
+  // Stream slab chunks when ImageIO is able to read exactly the requested region
+  std::size_t slabsPerChunk = numSlabs;
+  const std::size_t desiredSlabs = std::clamp<std::size_t>(k_loadChunkComponents / componentsPerSlab, 1, numSlabs);
+
+  if (desiredSlabs < numSlabs) {
+    const itk::ImageIORegion requested = slabRegion(imageIo, 0, desiredSlabs);
+    if (imageIo.GenerateStreamableReadRegionFromRequestedRegion(requested) == requested) {
+      slabsPerChunk = desiredSlabs;
     }
+  }
 
-    return true;
+  if (desiredSlabs < slabsPerChunk) {
+    spdlog::debug(
+      "ImageIO cannot stream {}, so all {} components are read in the on-disk component type before conversion",
+      fileName,
+      numElementsOnDisk);
+  }
+  else {
+    spdlog::debug(
+      "Reading {} components from {} in {} chunk(s) of {} slab(s)",
+      numElementsOnDisk,
+      fileName,
+      (numSlabs + slabsPerChunk - 1) / slabsPerChunk,
+      slabsPerChunk);
   }
 
-  constexpr bool pixelIsVector = false;
-  typename itk::ImageBase<Dimension>::Pointer baseImage =
-    readImage<ReadComponentType, Dimension, pixelIsVector>(fileName.string());
-  if (!baseImage) {
-    spdlog::error("Unable to read {}D ImageBase from file {}", Dimension, fileName);
-    return false;
+  std::vector<SrcType> chunk(slabsPerChunk * componentsPerSlab);
+
+  for (std::size_t slab = 0; slab < numSlabs; slab += slabsPerChunk) {
+    const std::size_t chunkSlabs = std::min(slabsPerChunk, numSlabs - slab);
+    const itk::ImageIORegion region =
+      (chunkSlabs == numSlabs) ? fullRegion : slabRegion(imageIo, slab, chunkSlabs);
+
+    if (!readImageIoRegion(imageIo, region, chunk.data(), fileName)) {
+      return false;
+    }
+
+    storeChunk(
+      chunk.data(),
+      slab * pixelsPerSlab,
+      chunkSlabs * pixelsPerSlab,
+      numComponentsOnDisk,
+      componentsToLoad,
+      bufferType,
+      buffers);
   }
 
-  typename ReadImageType::Pointer image = downcastImageBaseToImage<ReadComponentType, Dimension>(baseImage);
-  if (!image) {
-    spdlog::error("Null {}D image for file {} following downcast from ImageBase", Dimension, fileName);
+  return true;
+}
+/**
+ * @brief Load the pixels of one time frame of a file with on-disk component type \p SrcType into
+ * \p DstType buffers. The time axis is the last ImageIO axis.
+ */
+template<typename SrcType, typename DstType>
+bool loadImageIoFrameAs(
+  itk::ImageIOBase& imageIo,
+  const std::filesystem::path& fileName,
+  uint32_t timePoint,
+  std::size_t numFramePixels,
+  uint32_t numComponentsOnDisk,
+  uint32_t componentsToLoad,
+  const Image::MultiComponentBufferType bufferType,
+  std::vector<std::vector<DstType>>& buffers)
+{
+  const unsigned int numDims = imageIo.GetNumberOfDimensions();
+  if (numDims < 2 || timePoint >= imageIo.GetDimensions(numDims - 1) || 0 == numFramePixels) {
+    spdlog::error("Image file {} has no time frame {} to load", fileName, timePoint);
     return false;
   }
 
-  const ReadComponentType* buffer = image->GetBufferPointer();
-  if (!buffer) {
-    spdlog::error("Null buffer of scalar image file {}", fileName);
-    return false;
+  allocateComponentBuffers(numFramePixels, componentsToLoad, bufferType, buffers);
+
+  const itk::ImageIORegion region = slabRegion(imageIo, timePoint, 1);
+
+  if constexpr (std::is_same_v<SrcType, DstType>) {
+    if (numComponentsOnDisk == componentsToLoad && 1u == buffers.size()) {
+      return readImageIoRegion(imageIo, region, buffers[0].data(), fileName);
+    }
   }
 
-  if (!loadBuffer(static_cast<const void*>(buffer), numPixels)) {
-    spdlog::error("Error loading scalar buffer for image file {}", fileName);
+  std::vector<SrcType> frame(numFramePixels * numComponentsOnDisk);
+  if (!readImageIoRegion(imageIo, region, frame.data(), fileName)) {
     return false;
   }
 
+  storeChunk(frame.data(), 0, numFramePixels, numComponentsOnDisk, componentsToLoad, bufferType, buffers);
   return true;
 }
+
+/**
+ * @brief Call fn.template operator()<SrcType>() for the on-disk component type of an ImageIO.
+ * @return The result of \p fn, or false for an unsupported component type.
+ */
+template<typename Fn>
+bool dispatchImageIoComponentType(const itk::ImageIOBase& imageIo, const std::filesystem::path& fileName, Fn&& fn)
+{
+  using IOC = itk::IOComponentEnum;
+
+  switch (imageIo.GetComponentType()) {
+    case IOC::UCHAR:
+      return fn.template operator()<uint8_t>();
+    case IOC::CHAR:
+      return fn.template operator()<int8_t>();
+    case IOC::USHORT:
+      return fn.template operator()<uint16_t>();
+    case IOC::SHORT:
+      return fn.template operator()<int16_t>();
+    case IOC::UINT:
+      return fn.template operator()<uint32_t>();
+    case IOC::INT:
+      return fn.template operator()<int32_t>();
+    case IOC::ULONG:
+      return fn.template operator()<unsigned long>();
+    case IOC::LONG:
+      return fn.template operator()<long>();
+    case IOC::ULONGLONG:
+      return fn.template operator()<unsigned long long>();
+    case IOC::LONGLONG:
+      return fn.template operator()<long long>();
+    case IOC::FLOAT:
+      return fn.template operator()<float>();
+    case IOC::DOUBLE:
+      return fn.template operator()<double>();
+    case IOC::LDOUBLE:
+      return fn.template operator()<long double>();
+    default:
+      spdlog::error(
+        "Unsupported component type {} when loading image {}",
+        itk::ImageIOBase::GetComponentTypeAsString(imageIo.GetComponentType()),
+        fileName);
+      return false;
+  }
+}
 } // namespace image_utility_load_detail
 
 /**
- * @brief Load scalar or vector image data from disk and forward raw buffers to a caller callback.
- * @tparam ReadComponentType Component type used by ITK while reading.
- * @param[in] fileName Image file to load.
- * @param[in] numDimensions Number of image dimensions to request from ITK.
- * @param[in] numPixels Expected number of pixels in the loaded file buffer.
- * @param[in] componentsToLoad Number of logical components to load into memory.
- * @param[in] isMultiComponentImage Whether the on-disk image has more than one component per pixel.
+ * @brief Load image pixels from disk directly into typed in-memory component buffers.
+ * @tparam DstType In-memory component type of the destination buffers.
+ * @param[in] imageIo ImageIO object for the file, with image information already read.
+ * @param[in] fileName Image file to load, used for logging.
+ * @param[in] numPixels Number of pixels in the file, including all time frames.
+ * @param[in] numComponentsOnDisk Number of interleaved components per pixel in the file.
+ * @param[in] componentsToLoad Number of leading components to keep in memory.
  * @param[in] bufferType Desired in-memory multi-component buffer layout.
- * @param[in] loadBuffer Callback that stores each raw loaded buffer.
+ * @param[out] buffers Destination buffers: one per component for separated layout, or a single
+ * interleaved buffer. Existing contents are replaced.
  * @return True when all requested image data was loaded.
+ *
+ * The on-disk component type reported by ImageIO selects the source type. Values outside the range
+ * of \p DstType are clamped.
  */
-template<typename ReadComponentType>
-bool loadImage(
+template<typename DstType>
+bool loadImageComponentBuffers(
+  const itk::ImageIOBase::Pointer& imageIo,
   const std::filesystem::path& fileName,
-  uint32_t numDimensions,
   std::size_t numPixels,
+  uint32_t numComponentsOnDisk,
   uint32_t componentsToLoad,
-  bool isMultiComponentImage,
   const Image::MultiComponentBufferType bufferType,
-  std::function<bool(const void* buffer, std::size_t numElements)> loadBuffer)
+  std::vector<std::vector<DstType>>& buffers)
 {
-  switch (numDimensions) {
-    case 1u:
-      return image_utility_load_detail::loadImageAtDimension<ReadComponentType, 1>(
-        fileName,
-        numPixels,
-        componentsToLoad,
-        isMultiComponentImage,
-        bufferType,
-        std::move(loadBuffer));
-    case 2u:
-      return image_utility_load_detail::loadImageAtDimension<ReadComponentType, 2>(
-        fileName,
-        numPixels,
-        componentsToLoad,
-        isMultiComponentImage,
-        bufferType,
-        std::move(loadBuffer));
-    case 3u:
-      return image_utility_load_detail::loadImageAtDimension<ReadComponentType, 3>(
-        fileName,
-        numPixels,
-        componentsToLoad,
-        isMultiComponentImage,
-        bufferType,
-        std::move(loadBuffer));
-    case 4u:
-      return image_utility_load_detail::loadImageAtDimension<ReadComponentType, 4>(
-        fileName,
-        numPixels,
-        componentsToLoad,
-        isMultiComponentImage,
-        bufferType,
-        std::move(loadBuffer));
-    default:
-      spdlog::error("Unsupported image dimension {} when loading image {}", numDimensions, fileName);
-      return false;
+  using namespace image_utility_load_detail;
+
+  if (!imageIo || imageIo.IsNull()) {
+    spdlog::error("Null ImageIO when loading image {}", fileName);
+    return false;
+  }
+
+  if (0 == componentsToLoad || componentsToLoad > numComponentsOnDisk) {
+    spdlog::error(
+      "Cannot load {} component(s) from image {} with {} component(s)",
+      componentsToLoad,
+      fileName,
+      numComponentsOnDisk);
+    return false;
+  }
+
+  return dispatchImageIoComponentType(*imageIo, fileName, [&]<typename SrcType>() {
+    return loadImageIoAs<SrcType, DstType>(
+      *imageIo,
+      fileName,
+      numPixels,
+      numComponentsOnDisk,
+      componentsToLoad,
+      bufferType,
+      buffers);
+  });
+}
+
+/**
+ * @brief Enable streamed reads on an ImageIO and return true when it can read single time frames of
+ * a file without reading the rest.
+ * @param[in,out] imageIo ImageIO object for the file, with image information already read.
+ */
+inline bool canLoadImageFrames(itk::ImageIOBase& imageIo)
+{
+  const unsigned int numDims = imageIo.GetNumberOfDimensions();
+  if (numDims < 2 || imageIo.GetDimensions(numDims - 1) < 2) {
+    return false;
+  }
+
+  imageIo.SetUseStreamedReading(true);
+
+  const itk::ImageIORegion region = image_utility_load_detail::slabRegion(imageIo, 1, 1);
+  return imageIo.GenerateStreamableReadRegionFromRequestedRegion(region) == region;
+}
+
+/**
+ * @brief Load one time frame of a 4D image from disk into typed in-memory component buffers.
+ * @tparam DstType In-memory component type of the destination buffers.
+ * @param[in] imageIo ImageIO object for the file, with image information already read.
+ * @param[in] fileName Image file to load, used for logging.
+ * @param[in] timePoint Time frame to load, indexed along the last ImageIO axis.
+ * @param[in] numFramePixels Number of pixels in one time frame.
+ * @param[in] numComponentsOnDisk Number of interleaved components per pixel in the file.
+ * @param[in] componentsToLoad Number of leading components to keep in memory.
+ * @param[in] bufferType Desired in-memory multi-component buffer layout.
+ * @param[out] buffers Destination buffers for the frame. Existing contents are replaced.
+ * @return True when the frame was loaded.
+ */
+template<typename DstType>
+bool loadImageFrameComponentBuffers(
+  const itk::ImageIOBase::Pointer& imageIo,
+  const std::filesystem::path& fileName,
+  uint32_t timePoint,
+  std::size_t numFramePixels,
+  uint32_t numComponentsOnDisk,
+  uint32_t componentsToLoad,
+  const Image::MultiComponentBufferType bufferType,
+  std::vector<std::vector<DstType>>& buffers)
+{
+  using namespace image_utility_load_detail;
+
+  if (!imageIo || imageIo.IsNull()) {
+    spdlog::error("Null ImageIO when loading time frame {} of image {}", timePoint, fileName);
+    return false;
   }
+
+  if (0 == componentsToLoad || componentsToLoad > numComponentsOnDisk) {
+    spdlog::error(
+      "Cannot load {} component(s) from image {} with {} component(s)",
+      componentsToLoad,
+      fileName,
+      numComponentsOnDisk);
+    return false;
+  }
+
+  return dispatchImageIoComponentType(*imageIo, fileName, [&]<typename SrcType>() {
+    return loadImageIoFrameAs<SrcType, DstType>(
+      *imageIo,
+      fileName,
+      timePoint,
+      numFramePixels,
+      numComponentsOnDisk,
+      componentsToLoad,
+      bufferType,
+      buffers);
+  });
 }
@@ -2,7 +2,7 @@
 
 /**
  * @file ImageUtilityStatistics.tpp
- * @brief Template helpers for exact quantiles, online statistics, and T-digest construction.
+ * @brief Template helpers for exact quantiles and single-pass component statistics.
  */
 
 /**
@@ -15,223 +15,388 @@ double lerp(T a, T b, T t)
 }
 
 /**
- * @brief Convert an exact quantile into a value using sorted component data.
+ * @brief Convert an exact quantile into a value using the component's quantile index.
  * @tparam T Component value type.
- * @param[in] dataSorted Sorted component values.
+ * @param[in] index Exact quantile index of the component values.
  * @param[in] quantile Quantile in [0, 1].
  * @return Interpolated value at \p quantile.
  */
 template<typename T>
-T convertQuantileToValue(const std::span<const T> dataSorted, double quantile)
+T convertQuantileToValue(const ImageQuantileIndex& index, double quantile)
 {
-  const std::size_t N = dataSorted.size();
+  const std::size_t N = index.size();
 
   if (0 == N) {
-    spdlog::error("Sorted data has zero elements");
-    throwDebug("Sorted data is empty");
+    spdlog::error("Quantile index has zero elements");
+    throwDebug("Quantile index is empty");
   }
   else if (1 == N) {
-    return dataSorted.front();
+    return static_cast<T>(index.valueAtRank(0));
   }
 
   constexpr int64_t indexMin = 0;
   const int64_t indexMax = N - 1;
 
-  // Interpolated index corresponding to quantile
-  const double index = lerp<double>(-0.5, N - 0.5, quantile);
+  // Interpolated rank corresponding to quantile
+  const double rank = lerp<double>(-0.5, N - 0.5, quantile);
 
-  const std::size_t indexLeft = std::max(static_cast<int64_t>(std::floor(index)), indexMin);
-  const std::size_t indexRight = std::min(static_cast<int64_t>(std::ceil(index)), indexMax);
+  const std::size_t rankLeft = std::max(static_cast<int64_t>(std::floor(rank)), indexMin);
+  const std::size_t rankRight = std::min(static_cast<int64_t>(std::ceil(rank)), indexMax);
 
-  const T dataLeft = dataSorted[indexLeft];
-  const T dataRight = dataSorted[indexRight];
-  return lerp<T>(dataLeft, dataRight, index - static_cast<double>(indexLeft));
+  const T dataLeft = static_cast<T>(index.valueAtRank(rankLeft));
+  const T dataRight = static_cast<T>(index.valueAtRank(rankRight));
+  return lerp<T>(dataLeft, dataRight, rank - static_cast<double>(rankLeft));
 }
 
 /**
  * @brief Locate the exact quantile interval containing a value.
  * @tparam T Component value type.
- * @param[in] dataSorted Sorted component values.
+ * @param[in] index Exact quantile index of the component values.
  * @param[in] value Value to locate.
- * @return Quantile metadata for \p value.
+ * @return Quantile metadata for \p value, with indices being ranks in the sorted component values.
  */
 template<typename T>
-QuantileOfValue convertValueToQuantile(const std::span<const T> dataSorted, T value)
+QuantileOfValue convertValueToQuantile(const ImageQuantileIndex& index, T value)
 {
-  const std::size_t N = dataSorted.size();
+  const std::size_t N = index.size();
   if (0 == N) {
-    spdlog::error("Sorted data has zero elements");
-    throwDebug("Sorted data is empty");
+    spdlog::error("Quantile index has zero elements");
+    throwDebug("Quantile index is empty");
   }
 
   QuantileOfValue Q{};
 
-  // Find lower and upper bounds
-  auto lower = std::lower_bound(dataSorted.begin(), dataSorted.end(), value);
-  auto upper = std::upper_bound(dataSorted.begin(), dataSorted.end(), value);
+  // Lower and upper bound ranks, clamped for out-of-range values
+  const std::size_t lowerIndex = std::min(index.countLess(static_cast<double>(value)), N - 1);
+  const std::size_t upperIndex = std::min(index.countLessOrEqual(static_cast<double>(value)), N - 1);
 
-  // Compute indices, clamped to valid range
-  std::size_t lowerIndex = std::distance(dataSorted.begin(), lower);
-  std::size_t upperIndex = std::distance(dataSorted.begin(), upper);
-
-  // Clamp indices for out-of-range values
-  lowerIndex = std::min(lowerIndex, N - 1);
-  upperIndex = std::min(upperIndex, N - 1);
-
-  Q.foundValue = (value >= dataSorted.front() && value <= dataSorted.back());
+  Q.foundValue = (value >= static_cast<T>(index.min()) && value <= static_cast<T>(index.max()));
   Q.lowerIndex = lowerIndex;
   Q.upperIndex = upperIndex;
   Q.lowerQuantile = static_cast<double>(lowerIndex) / N;
   Q.upperQuantile = static_cast<double>(upperIndex) / N;
-  Q.lowerValue = dataSorted[lowerIndex];
-  Q.upperValue = dataSorted[upperIndex];
+  Q.lowerValue = index.valueAtRank(lowerIndex);
+  Q.upperValue = index.valueAtRank(upperIndex);
   return Q;
 }
 
-/**
- * @brief Build an approximate T-digest from component values.
- * @tparam T Component value type.
- * @param[in] data Component values.
- * @param[in] numThreads Maximum number of worker threads.
- * @return T-digest summarizing \p data.
- */
-template<typename T>
-tdigest::TDigest buildTDigest(
-  const std::span<const T>& data,
-  unsigned int numThreads = std::thread::hardware_concurrency())
+namespace image_statistics_detail
 {
-  using TD = tdigest::TDigest;
+/// Number of values summarized per block. Blocks stay cache-resident for their two passes.
+constexpr std::size_t k_blockSize = 4096;
 
-  const auto N = data.size();
-  if (0 == N) {
-    return TD{};
-  }
+/// Label-likeness sampling: at most this many pixels of the first frame are inspected
+constexpr std::size_t k_labelMaxSamples = 100000;
 
-  // Adjust compression and batchSize heuristics for performance.
-  // -memory use (bytes) ≈ 30 × 15 × compression ≈ 450 × compression
-  // -compression of 1000 takes about 450 kB, gives 99.9% quantile error of 1e-4,
-  //  with high-fidelity tails
-  const double compression = std::clamp(200.0 * std::cbrt(N / 1.0e6), 200.0, 1000.0);
-  const auto batchSize = std::clamp<std::size_t>(static_cast<std::size_t>(N / (numThreads * 1000)), 10'000, 1'000'000);
+/// Label-likeness: at most this many distinct sampled values
+constexpr std::size_t k_labelMaxValues = 64;
 
-  // launch one digest per thread
-  std::vector<std::unique_ptr<TD>> localDigests;
-  localDigests.reserve(numThreads);
+/// Label-likeness: at most this fraction of the sampled values may be distinct
+constexpr double k_labelMaxUniqueFraction = 0.02;
 
-  for (unsigned int i = 0; i < numThreads; ++i) {
-    localDigests.emplace_back(std::make_unique<TD>(compression));
+/// Count, mean, sum of squared deviations, sum and range of a set of values
+struct Moments
+{
+  std::size_t count = 0;
+  double mean = 0.0;
+  double m2 = 0.0;
+  long double sum = 0.0L;
+  double min = std::numeric_limits<double>::infinity();
+  double max = -std::numeric_limits<double>::infinity();
+};
+
+/// Merge moments of two disjoint sets (Chan et al. pairwise update)
+inline void mergeMoments(Moments& a, const Moments& b)
+{
+  if (0 == b.count) {
+    return;
+  }
+  if (0 == a.count) {
+    a = b;
+    return;
   }
 
-  std::vector<std::thread> threads;
-  const std::size_t chunkSize = (N + numThreads - 1) / numThreads;
-
-  for (unsigned int t = 0; t < numThreads; ++t) {
-    auto& td = localDigests[t];
-
-    threads.emplace_back([&, t]() {
-      const auto start = t * chunkSize;
-      const auto end = std::min(start + chunkSize, N);
-
-      // Process in batches to improve cache and reduce compress overhead
-      for (std::size_t i = start; i < end; i += batchSize) {
-        const auto e = std::min(i + batchSize, end);
-        for (std::size_t j = i; j < e; ++j) {
-          td->add(data[j]);
-        }
-      }
+  const double na = static_cast<double>(a.count);
+  const double nb = static_cast<double>(b.count);
+  const double n = na + nb;
+  const double delta = b.mean - a.mean;
+
+  a.mean += delta * (nb / n);
+  a.m2 += b.m2 + delta * delta * (na * nb / n);
+  a.sum += b.sum;
+  a.min = std::min(a.min, b.min);
+  a.max = std::max(a.max, b.max);
+  a.count += b.count;
+}
 
-      td->compress(); // finalize local digest
-    });
+/// Two-pass moments of one block of strided values. The loops only carry reductions, so they
+/// vectorize for contiguous data.
+template<typename T>
+Moments blockMoments(const T* data, std::size_t n, std::size_t stride)
+{
+  Moments m;
+  m.count = n;
+
+  double sum = 0.0;
+  double lo = std::numeric_limits<double>::infinity();
+  double hi = -std::numeric_limits<double>::infinity();
+
+  for (std::size_t i = 0; i < n; ++i) {
+    const double x = static_cast<double>(data[i * stride]);
+    sum += x;
+    lo = (x < lo) ? x : lo;
+    hi = (x > hi) ? x : hi;
   }
 
-  for (auto& thread : threads) {
-    thread.join();
+  const double mean = sum / static_cast<double>(n);
+  double m2 = 0.0;
+  for (std::size_t i = 0; i < n; ++i) {
+    const double d = static_cast<double>(data[i * stride]) - mean;
+    m2 += d * d;
   }
 
-  // merge results
-  TD globalDigest(compression);
-  for (auto& td : localDigests) {
-    globalDigest.merge(td.get());
-  }
+  m.mean = mean;
+  m.m2 = m2;
+  m.sum = sum;
+  m.min = lo;
+  m.max = hi;
+  return m;
+}
 
-  globalDigest.compress();
-  globalDigest.cdf(0.0); // Force it to process
+/// Distinct values seen at the label-likeness sample positions, capped just above the limit
+template<typename T>
+void sampleLabelValues(
+  const T* data,
+  std::size_t stride,
+  std::size_t begin,
+  std::size_t end,
+  std::size_t sampleStride,
+  std::size_t sampleCount,
+  std::vector<T>& uniqueValues)
+{
+  std::size_t k = (begin + sampleStride - 1) / sampleStride;
+  for (std::size_t p = k * sampleStride; k < sampleCount && p < end; ++k, p += sampleStride) {
+    if (uniqueValues.size() > k_labelMaxValues) {
+      return;
+    }
+    const T value = data[p * stride];
+    if (std::find(uniqueValues.begin(), uniqueValues.end(), value) == uniqueValues.end()) {
+      uniqueValues.push_back(value);
+    }
+  }
+}
 
-  return globalDigest;
+/// T-digest compression used for a component with \p count values
+inline double tdigestCompression(std::size_t count)
+{
+  // -memory use (bytes) ≈ 30 × 15 × compression ≈ 450 × compression
+  // -compression of 1000 takes about 450 kB, gives 99.9% quantile error of 1e-4,
+  //  with high-fidelity tails
+  return std::clamp(200.0 * std::cbrt(static_cast<double>(count) / 1.0e6), 200.0, 1000.0);
 }
+} // namespace image_statistics_detail
 
 /**
- * @brief Compute online descriptive statistics from unsorted component values.
+ * @brief Summarize one image component in a single parallel pass over its values.
+ *
+ * Computes descriptive statistics, a T-digest, and whether the component looks like a label map,
+ * without copying the values. Each thread summarizes a contiguous range; partial moments are merged
+ * with the pairwise update of Chan et al. 8- and 16-bit components are counted into histograms and
+ * the T-digest is built from weighted histogram bins rather than from every value.
+ *
  * @tparam T Component value type.
- * @param[in] data Component values.
- * @return Online statistics for \p data.
+ * @param[in] data Pointer to the first value of the component.
+ * @param[in] count Number of component values, across all time frames.
+ * @param[in] stride Distance in elements between consecutive values of the component.
+ * @param[in] labelSamplePixels Number of leading values (the first frame) sampled for label-likeness.
+ * @param[in] numThreads Maximum number of worker threads.
  */
 template<typename T>
-OnlineStats computeStatsOnUnsortedBuffers(const std::span<const T> data)
+ComponentSummary summarizeComponentValues(
+  const T* data,
+  std::size_t count,
+  std::size_t stride,
+  std::size_t labelSamplePixels,
+  unsigned int numThreads = std::thread::hardware_concurrency())
 {
-  spdlog::debug("Computing statistics on unsorted image intensities");
+  using namespace image_statistics_detail;
+  using TD = tdigest::TDigest;
 
-  OnlineStats s;
-  const auto N = data.size();
+  constexpr bool k_histogrammed = (sizeof(T) <= 2);
+  constexpr std::size_t k_numBins = k_histogrammed ? (std::size_t{1} << (8 * sizeof(T))) : 0;
 
-  if (0 == N) {
+  ComponentSummary summary;
+  summary.onlineStats.count = count;
+
+  if (!data || 0 == count) {
     spdlog::error("Image contains no data on which to compute statistics");
-    return s;
+    return summary;
   }
 
-  s.count = N;
-  s.min = s.max = data[0];
-  s.sum = 0.0L;
-  s.mean = static_cast<long double>(data[0]);
-  long double ssd = 0.0L; // sum of squares of differences from the mean
+  const double compression = tdigestCompression(count);
+
+  numThreads = static_cast<unsigned int>(
+    std::clamp<std::size_t>(std::min<std::size_t>(numThreads, (count + k_blockSize - 1) / k_blockSize), 1, 256));
+
+  const std::size_t chunkSize = (count + numThreads - 1) / numThreads;
+
+  labelSamplePixels = std::min(labelSamplePixels, count);
+  const std::size_t sampleCount = std::min(labelSamplePixels, k_labelMaxSamples);
+  const std::size_t sampleStride = std::max<std::size_t>(1, labelSamplePixels / std::max<std::size_t>(1, sampleCount));
 
-  // Welford's online algorithm
-  for (std::size_t i = 0; i < N; ++i) {
-    const auto x = static_cast<long double>(data[i]);
+  struct Partial
+  {
+    Moments moments;
+    std::vector<std::size_t> histogram;
+    std::unique_ptr<TD> tdigest;
+    std::vector<T> labelValues;
+  };
 
-    if (x < s.min) {
-      s.min = x;
+  std::vector<Partial> partials(numThreads);
+
+  auto work = [&](unsigned int t) {
+    Partial& part = partials[t];
+    const std::size_t begin = std::min(count, t * chunkSize);
+    const std::size_t end = std::min(count, begin + chunkSize);
+
+    if constexpr (std::is_integral_v<T>) {
+      if (sampleCount > 0) {
+        sampleLabelValues(data, stride, begin, std::min(end, labelSamplePixels), sampleStride, sampleCount, part.labelValues);
+      }
     }
 
-    if (x > s.max) {
-      s.max = x;
+    if constexpr (k_histogrammed) {
+      // Counting is all that is needed: moments and the T-digest come from the merged histogram
+      part.histogram.assign(k_numBins, 0);
+      for (std::size_t i = begin; i < end; ++i) {
+        ++part.histogram[static_cast<std::size_t>(static_cast<int64_t>(data[i * stride]) - std::numeric_limits<T>::lowest())];
+      }
     }
+    else {
+      part.tdigest = std::make_unique<TD>(compression);
+      for (std::size_t i = begin; i < end; i += k_blockSize) {
+        const std::size_t n = std::min(k_blockSize, end - i);
+        const T* block = data + i * stride;
+        mergeMoments(part.moments, blockMoments(block, n, stride));
+        for (std::size_t j = 0; j < n; ++j) {
+          part.tdigest->add(static_cast<double>(block[j * stride]));
+        }
+      }
+      part.tdigest->compress();
+    }
+  };
 
-    s.sum += x;
+  if (1 == numThreads) {
+    work(0);
+  }
+  else {
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    for (unsigned int t = 0; t < numThreads; ++t) {
+      threads.emplace_back(work, t);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  Moments total;
+  TD digest(compression);
 
-    const auto delta = x - s.mean;
-    s.mean += delta / (i + 1);
-    ssd += delta * (x - s.mean);
+  if constexpr (k_histogrammed) {
+    std::vector<std::size_t>& histogram = partials[0].histogram;
+    for (unsigned int t = 1; t < numThreads; ++t) {
+      for (std::size_t b = 0; b < k_numBins; ++b) {
+        histogram[b] += partials[t].histogram[b];
+      }
+    }
+
+    // Exact moments of the histogram, in two passes over the occupied bins
+    for (std::size_t b = 0; b < k_numBins; ++b) {
+      if (const std::size_t n = histogram[b]) {
+        const double x = static_cast<double>(static_cast<int64_t>(b) + std::numeric_limits<T>::lowest());
+        total.sum += static_cast<long double>(x) * n;
+        total.min = std::min(total.min, x);
+        total.max = std::max(total.max, x);
+        digest.add(x, static_cast<double>(n));
+      }
+    }
+
+    total.count = count;
+    total.mean = static_cast<double>(total.sum / count);
+    for (std::size_t b = 0; b < k_numBins; ++b) {
+      if (const std::size_t n = histogram[b]) {
+        const double d = static_cast<double>(static_cast<int64_t>(b) + std::numeric_limits<T>::lowest()) - total.mean;
+        total.m2 += d * d * static_cast<double>(n);
+      }
+    }
+  }
+  else {
+    for (auto& part : partials) {
+      mergeMoments(total, part.moments);
+      digest.merge(part.tdigest.get());
+    }
   }
 
-  s.variance = (N > 1) ? ssd / (N - 1) : 0.0L;
+  digest.compress();
+  digest.cdf(0.0); // Force it to process
+
+  OnlineStats& s = summary.onlineStats;
+  s.count = count;
+  s.min = total.min;
+  s.max = total.max;
+  s.sum = total.sum;
+  s.mean = total.mean;
+  s.variance = (count > 1) ? total.m2 / static_cast<double>(count - 1) : 0.0L;
   s.stdev = std::sqrt(s.variance);
-  return s;
+
+  summary.tdigest = std::move(digest);
+
+  if constexpr (std::is_integral_v<T>) {
+    std::vector<T> uniqueValues;
+    for (const auto& part : partials) {
+      for (const T value : part.labelValues) {
+        if (std::find(uniqueValues.begin(), uniqueValues.end(), value) == uniqueValues.end()) {
+          uniqueValues.push_back(value);
+        }
+      }
+    }
+
+    const double uniqueFraction =
+      sampleCount > 0u ? static_cast<double>(uniqueValues.size()) / static_cast<double>(sampleCount) : 1.0;
+    summary.labelLikeValues = (uniqueValues.size() <= k_labelMaxValues && uniqueFraction <= k_labelMaxUniqueFraction);
+  }
+
+  return summary;
 }
 
 /**
- * @brief Compute descriptive statistics and exact percentile table from sorted values.
+ * @brief Compute descriptive statistics and exact percentile table from a quantile index.
  * @tparam T Component value type.
- * @param[in] dataSorted Sorted component values.
+ * @param[in] index Exact quantile index of the component values.
  * @return Component statistics including percentiles.
  */
 template<typename T>
-ComponentStats computeStatsOnSortedBuffers(const std::span<const T> dataSorted)
+ComponentStats computeStatsOnQuantileIndex(const ImageQuantileIndex& index)
 {
   OnlineStats os;
-  os.min = static_cast<double>(dataSorted.front());
-  os.max = static_cast<double>(dataSorted.back());
+  os.min = index.min();
+  os.max = index.max();
+
+  const std::size_t N = index.size();
+  os.count = N;
 
-  const std::size_t N = dataSorted.size();
-  os.sum = std::accumulate(std::begin(dataSorted), std::end(dataSorted), 0.0);
-  os.mean = os.sum / N;
+  double sum = 0.0;
+  index.forEachValue([&sum](double value, std::size_t count) { sum += value * static_cast<double>(count); });
+  os.sum = sum;
+  os.mean = sum / N;
 
-  std::vector<double> diff(N);
-  std::transform(std::begin(dataSorted), std::end(dataSorted), std::begin(diff), [&os](double x) {
-    return x - os.mean;
+  double squaredSum = 0.0;
+  index.forEachValue([&squaredSum, &os](double value, std::size_t count) {
+    const double diff = value - static_cast<double>(os.mean);
+    squaredSum += diff * diff * static_cast<double>(count);
   });
 
-  const double squaredSum = std::inner_product(std::begin(diff), std::end(diff), std::begin(diff), 0.0);
   os.variance = squaredSum / N;
   os.stdev = std::sqrt(os.variance);
 
@@ -240,7 +405,7 @@ ComponentStats computeStatsOnSortedBuffers(const std::span<const T> dataSorted)
 
   for (std::size_t i = 0; i <= 100; ++i) {
     const double quantile = static_cast<double>(i) / 100.0;
-    const T value = convertQuantileToValue(dataSorted, quantile);
+    const T value = convertQuantileToValue<T>(index, quantile);
     compStats.quantiles[i] = static_cast<double>(value);
   }
 
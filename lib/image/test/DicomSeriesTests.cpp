@@ -1,11 +1,137 @@
+#include "image/DicomHeaderIndex.h"
 #include "image/DicomSeries.h"
 
+#include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 
+#include <itkGDCMImageIO.h>
+#include <itkImage.h>
+#include <itkImageFileWriter.h>
+#include <itkMetaDataObject.h>
+
+#include <nlohmann/json.hpp>
+
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+namespace fs = std::filesystem;
+
+struct SyntheticSeries
+{
+  std::string seriesUid;
+  std::string seriesNumber;
+  std::string description;
+  std::vector<double> slicePositions; //!< Slice z positions, in the order that files are written
+};
+
+/// Write one 16x16 axial DICOM slice with the given series and position tags
+void writeDicomSlice(
+  const fs::path& fileName,
+  const SyntheticSeries& series,
+  std::size_t sliceIndex,
+  double rowSpacing = 0.8)
+{
+  using ImageType = itk::Image<int16_t, 2>;
+
+  ImageType::RegionType region;
+  region.SetSize({{16, 16}});
+
+  ImageType::SpacingType spacing;
+  spacing[0] = rowSpacing;
+  spacing[1] = 0.9;
+
+  auto image = ImageType::New();
+  image->SetRegions(region);
+  image->SetSpacing(spacing);
+  image->Allocate();
+  image->FillBuffer(static_cast<int16_t>(10 * sliceIndex));
+
+  const std::string instance = std::to_string(sliceIndex + 1);
+  std::ostringstream position;
+  position << "-10\\-20\\" << series.slicePositions.at(sliceIndex);
+
+  itk::MetaDataDictionary dict;
+  itk::EncapsulateMetaData<std::string>(dict, "0008|0060", "MR");
+  itk::EncapsulateMetaData<std::string>(dict, "0008|103e", series.description);
+  itk::EncapsulateMetaData<std::string>(dict, "0010|0010", "Doe^Jane");
+  itk::EncapsulateMetaData<std::string>(dict, "0010|1000", "MRN-7731");          // OtherPatientIDs
+  itk::EncapsulateMetaData<std::string>(dict, "0010|1010", "042Y");              // PatientAge
+  itk::EncapsulateMetaData<std::string>(dict, "0008|0081", "1 Example Street");  // InstitutionAddress
+  itk::EncapsulateMetaData<std::string>(dict, "0008|1070", "Roe^Operator");      // OperatorsName
+  itk::EncapsulateMetaData<std::string>(dict, "0009|0010", "ENTROPY TEST");      // Private creator
+  itk::EncapsulateMetaData<std::string>(dict, "0020|000d", "1.2.826.0.1.3680043.2.1125.9");
+  itk::EncapsulateMetaData<std::string>(dict, "0020|000e", series.seriesUid);
+  itk::EncapsulateMetaData<std::string>(dict, "0008|0018", series.seriesUid + "." + instance);
+  itk::EncapsulateMetaData<std::string>(dict, "0020|0011", series.seriesNumber);
+  itk::EncapsulateMetaData<std::string>(dict, "0020|0013", instance);
+  itk::EncapsulateMetaData<std::string>(dict, "0020|0032", position.str());
+  itk::EncapsulateMetaData<std::string>(dict, "0020|0037", "1\\0\\0\\0\\1\\0");
+  itk::EncapsulateMetaData<std::string>(dict, "0018|0050", "2.5");
+  image->SetMetaDataDictionary(dict);
+
+  auto imageIo = itk::GDCMImageIO::New();
+  imageIo->KeepOriginalUIDOn();
+
+  auto writer = itk::ImageFileWriter<ImageType>::New();
+  writer->SetImageIO(imageIo);
+  writer->SetInput(image);
+  writer->SetFileName(fileName.string());
+  writer->Update();
+}
+
+/**
+ * @brief Write a folder with a regular series whose file names do not follow slice order, a series
+ * with a missing slice, a duplicate of one slice in a subfolder and a file that is not DICOM.
+ * @return Number of files written.
+ */
+std::size_t writeDicomFolder(const fs::path& dir, const SyntheticSeries& regular, const SyntheticSeries& gapped)
+{
+  fs::create_directories(dir / "copies");
+  std::size_t numFiles = 0;
+
+  for (std::size_t i = 0; i < regular.slicePositions.size(); ++i, ++numFiles) {
+    writeDicomSlice(dir / ("a" + std::to_string((i * 7) % regular.slicePositions.size()) + ".dcm"), regular, i);
+  }
+  for (std::size_t i = 0; i < gapped.slicePositions.size(); ++i, ++numFiles) {
+    writeDicomSlice(dir / ("b" + std::to_string(i) + ".dcm"), gapped, i);
+  }
+
+  writeDicomSlice(dir / "copies" / "a-copy.dcm", regular, 0);
+  ++numFiles;
+
+  std::ofstream(dir / "notes.txt") << "not a dicom file\n";
+  ++numFiles;
+
+  return numFiles;
+}
+
+const dicom::SeriesInfo* findSeries(const dicom::DiscoverResult& result, const std::string& description)
+{
+  const auto it = std::find_if(result.series.begin(), result.series.end(), [&](const dicom::SeriesInfo& series) {
+    return series.metadata.seriesDescription == description;
+  });
+  return it == result.series.end() ? nullptr : &*it;
+}
+
+template<typename Scan>
+double scanMilliseconds(Scan&& scan)
+{
+  const auto start = std::chrono::steady_clock::now();
+  scan();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
 
 TEST_CASE("DICOM metadata filtering excludes PHI tags", "[image][dicom]")
 {
@@ -218,3 +344,259 @@ TEST_CASE("DICOM discovery preview and load work on an external fixture", "[imag
   CHECK(image->header().pixelDimensions().y > 0);
   CHECK(image->header().pixelDimensions().z > 0);
 }
+
+TEST_CASE("DICOM discovery groups, orders and indexes a generated folder", "[image][dicom][discovery][index]")
+{
+  const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+  const fs::path baseDir = fs::temp_directory_path() / ("entropy-dicom-index-tests-" + std::to_string(stamp));
+  const fs::path dicomDir = baseDir / "study";
+  const fs::path indexDir = baseDir / "index";
+
+  SyntheticSeries regular{"1.2.826.0.1.3680043.2.1125.9.1", "3", "Axial regular", {}};
+  for (int i = 0; i < 12; ++i) {
+    regular.slicePositions.push_back(2.5 * ((i * 5) % 12));
+  }
+  const SyntheticSeries gapped{"1.2.826.0.1.3680043.2.1125.9.2", "4", "Axial gapped", {0.0, 3.0, 6.0, 9.0, 15.0, 18.0}};
+
+  const std::size_t numFiles = writeDicomFolder(dicomDir, regular, gapped);
+
+  dicom::DiscoverOptions options;
+  options.indexDirectory = indexDir;
+
+  dicom::DiscoverResult cold;
+  const double coldMs = scanMilliseconds([&]() { cold = dicom::discoverSeries({dicomDir}, options); });
+
+  dicom::DiscoverResult warm;
+  const double warmMs = scanMilliseconds([&]() { warm = dicom::discoverSeries({dicomDir}, options); });
+
+  INFO("Cold scan of " << numFiles << " files: " << coldMs << " ms; warm scan: " << warmMs << " ms");
+
+  SECTION("Series are grouped by UID and ordered along the slice normal")
+  {
+    REQUIRE(cold.series.size() == 2);
+
+    const dicom::SeriesInfo* series = findSeries(cold, "Axial regular");
+    REQUIRE(series != nullptr);
+    CHECK(series->seriesInstanceUid.starts_with(regular.seriesUid));
+    CHECK(series->metadata.seriesInstanceUid == regular.seriesUid);
+
+    // The duplicate instance in the subfolder is dropped
+    REQUIRE(series->files.size() == 12);
+    CHECK((series->files.front() == fs::weakly_canonical(dicomDir) / "a0.dcm"));
+    CHECK((series->geometry.dimensions == glm::uvec3{16, 16, 12}));
+    CHECK(series->geometry.spacing.x == Catch::Approx(0.8f));
+    CHECK(series->geometry.spacing.y == Catch::Approx(0.9f));
+    CHECK(series->geometry.spacing.z == Catch::Approx(2.5f));
+    CHECK(series->geometry.origin.z == Catch::Approx(0.0f));
+    CHECK(series->geometry.sliceOrientation == "Axial");
+    CHECK(series->warnings.empty());
+
+    // Patient-identifying values are not shown
+    for (const auto& entry : series->metadataSummary) {
+      CHECK_FALSE(dicom::isPhiTag(entry.tag));
+    }
+  }
+
+  SECTION("Only allowlisted tags are written to the index")
+  {
+    const fs::path indexFile = dicom::headerIndexFile(indexDir, fs::weakly_canonical(dicomDir), true);
+    REQUIRE(fs::exists(indexFile));
+
+    std::ifstream in(indexFile);
+    const nlohmann::json index = nlohmann::json::parse(in);
+
+    std::size_t numIndexedTags = 0;
+    for (const auto& file : index.at("files")) {
+      const auto metadata = file.find("metadata");
+      if (metadata == file.end()) {
+        continue;
+      }
+      for (const auto& entry : *metadata) {
+        const std::string tag = entry.at(0).get<std::string>();
+        INFO("Indexed tag " << tag);
+        CHECK(dicom::isIndexedMetadataTag(tag));
+        CHECK_FALSE(dicom::isPrivateTag(tag));
+        ++numIndexedTags;
+      }
+    }
+    CHECK(numIndexedTags > 0);
+
+    const std::string indexText = index.dump();
+    for (const char* value : {"Doe^Jane", "MRN-7731", "042Y", "1 Example Street", "Roe^Operator", "ENTROPY TEST"}) {
+      INFO("Value " << value);
+      CHECK(indexText.find(value) == std::string::npos);
+    }
+  }
+
+  SECTION("Spacing warnings are computed from cached slice positions")
+  {
+    const dicom::SeriesInfo* series = findSeries(cold, "Axial gapped");
+    REQUIRE(series != nullptr);
+    CHECK(series->files.size() == 6);
+    const bool hasSpacingWarning =
+      std::any_of(series->warnings.begin(), series->warnings.end(), [](const std::string& warning) {
+        return warning.find("Irregular slice spacing") != std::string::npos;
+      });
+    CHECK(hasSpacingWarning);
+  }
+
+  SECTION("A warm scan reuses every indexed header")
+  {
+    CHECK(cold.numHeadersFromIndex == 0);
+    CHECK(cold.numHeadersRead >= numFiles);
+    CHECK(warm.numHeadersRead == 0);
+    CHECK(warm.numHeadersFromIndex == numFiles);
+
+    REQUIRE(warm.series.size() == cold.series.size());
+    for (std::size_t i = 0; i < cold.series.size(); ++i) {
+      CHECK(warm.series[i].seriesInstanceUid == cold.series[i].seriesInstanceUid);
+      CHECK(warm.series[i].displayName == cold.series[i].displayName);
+      CHECK((warm.series[i].files == cold.series[i].files));
+      CHECK((warm.series[i].geometry.dimensions == cold.series[i].geometry.dimensions));
+      CHECK((warm.series[i].geometry.spacing == cold.series[i].geometry.spacing));
+      CHECK(warm.series[i].warnings == cold.series[i].warnings);
+      CHECK(warm.series[i].metadataSummary.size() == cold.series[i].metadataSummary.size());
+    }
+  }
+
+  SECTION("Changed files are read again")
+  {
+    std::ofstream(dicomDir / "notes.txt", std::ios::app) << "changed\n";
+    const auto rescan = dicom::discoverSeries({dicomDir}, options);
+    CHECK(rescan.numHeadersRead == 1);
+    CHECK(rescan.numHeadersFromIndex == numFiles - 1);
+    CHECK(rescan.series.size() == 2);
+  }
+
+  SECTION("Concurrent scans share the index without clobbering each other")
+  {
+    std::vector<dicom::DiscoverResult> results(4);
+    std::vector<std::thread> scans;
+    for (auto& result : results) {
+      scans.emplace_back([&result, &dicomDir, &options]() { result = dicom::discoverSeries({dicomDir}, options); });
+    }
+    for (auto& scan : scans) {
+      scan.join();
+    }
+
+    for (const auto& result : results) {
+      CHECK(result.series.size() == cold.series.size());
+    }
+
+    // Only the index itself remains: every save renamed or removed its own temporary file
+    std::size_t numIndexFiles = 0;
+    for (const auto& entry : fs::directory_iterator(indexDir)) {
+      INFO("Index directory entry " << entry.path());
+      CHECK(entry.path().extension() == ".json");
+      ++numIndexFiles;
+    }
+    CHECK(numIndexFiles == 1);
+
+    const auto rescan = dicom::discoverSeries({dicomDir}, options);
+    CHECK(rescan.numHeadersFromIndex == numFiles);
+  }
+
+  SECTION("Serial scans without an index match threaded scans")
+  {
+    dicom::DiscoverOptions serialOptions;
+    serialOptions.maxThreads = 1;
+    const auto serial = dicom::discoverSeries({dicomDir}, serialOptions);
+    CHECK(serial.numHeadersFromIndex == 0);
+
+    REQUIRE(serial.series.size() == cold.series.size());
+    for (std::size_t i = 0; i < cold.series.size(); ++i) {
+      CHECK(serial.series[i].seriesInstanceUid == cold.series[i].seriesInstanceUid);
+      CHECK((serial.series[i].files == cold.series[i].files));
+    }
+  }
+
+  std::error_code ec;
+  fs::remove_all(baseDir, ec);
+}
+
+TEST_CASE("DICOM series slices are decoded in parallel into slice order", "[image][dicom][loading]")
+{
+  const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+  const fs::path dicomDir = fs::temp_directory_path() / ("entropy-dicom-load-tests-" + std::to_string(stamp));
+  fs::create_directories(dicomDir);
+
+  // Slice i is written at position 2.5 * (5i mod 12), so sorted slice k is the one written as 5k mod 12
+  SyntheticSeries synthetic{"1.2.826.0.1.3680043.2.1125.9.3", "5", "Axial load", {}};
+  for (int i = 0; i < 12; ++i) {
+    synthetic.slicePositions.push_back(2.5 * ((i * 5) % 12));
+  }
+  for (std::size_t i = 0; i < synthetic.slicePositions.size(); ++i) {
+    writeDicomSlice(dicomDir / ("s" + std::to_string(i) + ".dcm"), synthetic, i);
+  }
+
+  const dicom::DiscoverResult discovered = dicom::discoverSeries({dicomDir});
+  REQUIRE(discovered.series.size() == 1);
+  const dicom::SeriesInfo& series = discovered.series.front();
+  REQUIRE(series.files.size() == 12);
+
+  SECTION("Voxels, geometry and progress")
+  {
+    std::vector<double> fractions;
+    const std::optional<Image> image = dicom::loadSeriesImage(
+      series,
+      Image::ImageRepresentation::Image,
+      Image::MultiComponentBufferType::SeparateImages,
+      [&fractions](double fraction) { fractions.push_back(fraction); });
+
+    REQUIRE(image.has_value());
+    CHECK((image->header().pixelDimensions() == glm::uvec3{16, 16, 12}));
+    CHECK(image->header().spacing().x == Catch::Approx(0.8f));
+    CHECK(image->header().spacing().y == Catch::Approx(0.9f));
+    CHECK(image->header().spacing().z == Catch::Approx(2.5f));
+    CHECK(image->header().origin().z == Catch::Approx(0.0f));
+
+    for (int k = 0; k < 12; ++k) {
+      const int16_t expected = static_cast<int16_t>(10 * ((5 * k) % 12));
+      CHECK(image->value<int16_t>(0, 0, 0, k) == expected);
+      CHECK(image->value<int16_t>(0, 15, 15, k) == expected);
+    }
+
+    REQUIRE(fractions.size() == 12);
+    CHECK(std::is_sorted(fractions.begin(), fractions.end()));
+    CHECK(fractions.back() == Catch::Approx(1.0));
+  }
+
+  SECTION("Cancellation")
+  {
+    const std::atomic_bool cancel{true};
+    CHECK_FALSE(dicom::loadSeriesImage(
+                  series,
+                  Image::ImageRepresentation::Image,
+                  Image::MultiComponentBufferType::SeparateImages,
+                  {},
+                  &cancel)
+                  .has_value());
+  }
+
+  std::error_code ec;
+  fs::remove_all(dicomDir, ec);
+}
+
+TEST_CASE("DICOM series with a slice of another in-plane spacing are not loaded", "[image][dicom][loading]")
+{
+  const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+  const fs::path dicomDir = fs::temp_directory_path() / ("entropy-dicom-geometry-tests-" + std::to_string(stamp));
+  fs::create_directories(dicomDir);
+
+  SyntheticSeries synthetic{"1.2.826.0.1.3680043.2.1125.9.4", "6", "Axial mixed spacing", {}};
+  for (int i = 0; i < 4; ++i) {
+    synthetic.slicePositions.push_back(2.5 * i);
+  }
+  for (std::size_t i = 0; i < synthetic.slicePositions.size(); ++i) {
+    writeDicomSlice(dicomDir / ("s" + std::to_string(i) + ".dcm"), synthetic, i, (2 == i) ? 1.6 : 0.8);
+  }
+
+  const dicom::DiscoverResult discovered = dicom::discoverSeries({dicomDir});
+  REQUIRE(discovered.series.size() == 1);
+  REQUIRE(discovered.series.front().files.size() == 4);
+
+  CHECK_FALSE(dicom::loadSeriesImage(discovered.series.front()).has_value());
+
+  std::error_code ec;
+  fs::remove_all(dicomDir, ec);
+}
@@ -11,6 +11,7 @@
 #include <cstddef>
 #include <glm/glm.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdint>
@@ -18,7 +19,10 @@
 #include <functional>
 #include <limits>
 #include <numbers>
+#include <numeric>
 #include <stdexcept>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace
@@ -431,7 +435,7 @@ void checkExactQuantilesForType()
   std::vector<T> values{static_cast<T>(4), static_cast<T>(2), static_cast<T>(2), static_cast<T>(8), static_cast<T>(10)};
   Image image = makeSeparateRawImage(values);
 
-  REQUIRE(image.generateSortedBuffers());
+  REQUIRE(image.generateQuantileIndex());
   image.settings().setUsingExactQuantiles(true);
 
   CHECK(image.quantileToValue(0, 0.0) == Catch::Approx(2.0));
@@ -588,6 +592,200 @@ TEST_CASE("Raw component buffers convert and clamp every supported source type",
     std::exception);
 }
 
+TEST_CASE("Image copies share pixel buffers until written", "[image][buffer][cow]")
+{
+  Image original = makeRawImage();
+  Image copy = original;
+
+  REQUIRE(copy.sharesPixelDataWith(original));
+  CHECK(std::as_const(copy).bufferAsVoid(0) == std::as_const(original).bufferAsVoid(0));
+  CHECK(copy.value<int>(0, 3).value() == 4);
+
+  SECTION("Writing one copy leaves the other unchanged")
+  {
+    REQUIRE(copy.setValue(0, 1, 1, 0, 40));
+    CHECK_FALSE(copy.sharesPixelDataWith(original));
+    CHECK(copy.value<int>(0, 3).value() == 40);
+    CHECK(original.value<int>(0, 3).value() == 4);
+  }
+
+  SECTION("Filling the original leaves the copy unchanged")
+  {
+    original.setAllValues(7);
+    CHECK_FALSE(copy.sharesPixelDataWith(original));
+    CHECK(original.value<int>(0, 0).value() == 7);
+    CHECK(copy.value<int>(0, 0).value() == 1);
+  }
+
+  SECTION("Mutable buffer access detaches the copy")
+  {
+    auto* values = static_cast<uint16_t*>(copy.bufferAsVoid(0));
+    REQUIRE(values != nullptr);
+    CHECK_FALSE(copy.sharesPixelDataWith(original));
+    values[0] = 11;
+    CHECK(copy.value<int>(0, 0).value() == 11);
+    CHECK(original.value<int>(0, 0).value() == 1);
+  }
+
+  SECTION("An unshared image is written in place")
+  {
+    const void* before = std::as_const(original).bufferAsVoid(0);
+    copy = makeThreeComponentImage();
+    REQUIRE(original.setValue(0, 0, 0, 0, 9));
+    CHECK(std::as_const(original).bufferAsVoid(0) == before);
+  }
+  SECTION("A copy released on another thread lets the original write in place")
+  {
+    const void* before = std::as_const(original).bufferAsVoid(0);
+    int copiedValue = 0;
+    std::thread reader([&copy, &copiedValue]() {
+      const Image image = std::move(copy);
+      copiedValue = image.value<int>(0, 3).value();
+    });
+    reader.join();
+    CHECK(copiedValue == 4);
+
+    REQUIRE(original.setValue(0, 0, 0, 0, 9));
+    CHECK(std::as_const(original).bufferAsVoid(0) == before);
+  }
+}
+
+TEST_CASE("Typed image views match checked value access", "[image][view]")
+{
+  SECTION("Interleaved components are strided views")
+  {
+    const Image rgb = makeRawRasterRgbImage();
+
+    REQUIRE_FALSE(rgb.view<uint16_t>(0).has_value());
+    REQUIRE_FALSE(rgb.view<uint8_t>(3).has_value());
+
+    const auto green = rgb.view<uint8_t>(1);
+    REQUIRE(green.has_value());
+    CHECK(green->pixelStride() == 3);
+    CHECK(green->numPixels() == 4);
+
+    green->forEachVoxel([&](std::size_t i, const uint8_t& value) {
+      CHECK(static_cast<int>(value) == rgb.value<int>(1, i).value());
+    });
+    CHECK(green->at(1, 1, 0) == 140);
+    CHECK_FALSE(green->value(2, 0, 0).has_value());
+  }
+
+  SECTION("Visitors resolve the memory component type once")
+  {
+    const Image image = makeThreeComponentImage();
+
+    double sum = 0.0;
+    CHECK(image.visitComponentView(2, 0, [&](const auto& view) {
+      view.forEachVoxel([&](std::size_t, const auto& value) { sum += value; });
+    }));
+    CHECK(sum == 32.0);
+
+    CHECK_FALSE(image.visitComponentView(3, 0, [](const auto&) { FAIL("Visitor called for invalid component"); }));
+
+    std::size_t visited = 0;
+    CHECK(image.visitComponentViews<3>(0, [&](const auto& views) {
+      views[0].forEachInRegion(glm::i64vec3{-1, 1, -1}, glm::i64vec3{5, 5, 5}, [&](const glm::i64vec3& voxel, float v) {
+        CHECK(voxel.y == 1);
+        CHECK(v + views[1].at(voxel.x, voxel.y, voxel.z) == 5.0f);
+        ++visited;
+      });
+    }));
+    CHECK(visited == 2);
+  }
+
+  SECTION("Linear sampling matches Image::valueLinear")
+  {
+    const Image image = makeTimeSeriesVectorImage();
+    const auto view = image.view<float>(1, 1);
+    REQUIRE(view.has_value());
+
+    for (const glm::dvec3& p : {glm::dvec3{0.25, 0.75, 0.0}, glm::dvec3{-0.5, 1.5, 0.5}, glm::dvec3{1.0, 0.0, -0.25}}) {
+      const auto expected = image.valueLinear<double>(1, p.x, p.y, p.z, 1);
+      REQUIRE(expected.has_value());
+      CHECK(view->linear(p.x, p.y, p.z).value() == Catch::Approx(*expected));
+    }
+    CHECK_FALSE(view->linear(1.6, 0.0, 0.0).has_value());
+  }
+
+  SECTION("Mutable views detach shared pixel data")
+  {
+    const Image original = makeRawImage();
+    Image copy = original;
+
+    const auto view = copy.mutableView<uint16_t>(0);
+    REQUIRE(view.has_value());
+    CHECK_FALSE(copy.sharesPixelDataWith(original));
+
+    view->at(1, 0, 0) = 20;
+    CHECK(copy.value<int>(0, 1).value() == 20);
+    CHECK(original.value<int>(0, 1).value() == 2);
+  }
+}
+
+TEST_CASE("Component summaries read interleaved and separated buffers alike", "[image][statistics]")
+{
+  const glm::uvec3 dims{64, 64, 1};
+  const std::size_t numPixels = static_cast<std::size_t>(dims.x) * dims.y;
+
+  std::vector<int16_t> c0(numPixels);
+  std::vector<int16_t> c1(numPixels);
+  std::vector<int16_t> interleaved(2 * numPixels);
+  for (std::size_t i = 0; i < numPixels; ++i) {
+    c0[i] = static_cast<int16_t>(static_cast<int>(i % 997) - 300);
+    c1[i] = static_cast<int16_t>(i % 2);
+    interleaved[2 * i] = c0[i];
+    interleaved[2 * i + 1] = c1[i];
+  }
+
+  ImageIoInfo ioInfo = makeIoInfo(ComponentType::Int16, 2, dims);
+  ioInfo.m_sizeInfo.m_imageSizeInPixels = numPixels;
+  ioInfo.m_sizeInfo.m_imageSizeInComponents = 2 * numPixels;
+  ioInfo.m_sizeInfo.m_imageSizeInBytes = 2 * numPixels * sizeof(int16_t);
+
+  const Image separate(
+    ImageHeader(ioInfo, ioInfo, false),
+    "separate",
+    Image::ImageRepresentation::Image,
+    Image::MultiComponentBufferType::SeparateImages,
+    {c0.data(), c1.data()});
+
+  const Image interleavedImage(
+    ImageHeader(ioInfo, ioInfo, true),
+    "interleaved",
+    Image::ImageRepresentation::Image,
+    Image::MultiComponentBufferType::InterleavedImage,
+    {interleaved.data()});
+
+  const std::vector<ComponentSummary> a = computeImageComponentSummaries(separate);
+  const std::vector<ComponentSummary> b = computeImageComponentSummaries(interleavedImage);
+  REQUIRE(a.size() == 2);
+  REQUIRE(b.size() == 2);
+
+  for (std::size_t c = 0; c < 2; ++c) {
+    const std::vector<int16_t>& values = (0 == c) ? c0 : c1;
+    const double mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(numPixels);
+    double ssd = 0.0;
+    for (const int16_t v : values) {
+      ssd += (v - mean) * (v - mean);
+    }
+
+    for (const auto* summary : {&a[c], &b[c]}) {
+      CHECK(summary->onlineStats.count == numPixels);
+      CHECK(static_cast<double>(summary->onlineStats.min) == *std::min_element(values.begin(), values.end()));
+      CHECK(static_cast<double>(summary->onlineStats.max) == *std::max_element(values.begin(), values.end()));
+      CHECK(static_cast<double>(summary->onlineStats.mean) == Catch::Approx(mean));
+      CHECK(static_cast<double>(summary->onlineStats.variance) == Catch::Approx(ssd / (numPixels - 1)));
+    }
+
+    CHECK(a[c].tdigest.quantile(0.5) == Catch::Approx(b[c].tdigest.quantile(0.5)));
+  }
+
+  CHECK_FALSE(a[0].labelLikeValues);
+  CHECK(a[1].labelLikeValues);
+  CHECK(b[1].labelLikeValues);
+}
+
 TEST_CASE("Image IO metadata validation rejects incomplete metadata", "[image][io-info]")
 {
   ImageIoInfo info = makeIoInfo(ComponentType::UInt16, 1, glm::uvec3(2, 2, 1));
@@ -861,7 +1059,7 @@ TEST_CASE("Raw interleaved images preserve all components per pixel", "[image][r
   CHECK(image.value<double>(3, 1).value() == Catch::Approx(23.0));
   CHECK(image.value<double>(4, 1).value() == Catch::Approx(24.0));
 
-  CHECK(image.generateSortedBuffers());
+  CHECK(image.generateQuantileIndex());
   CHECK(image.quantileToValue(0, 1.0) == Catch::Approx(20.0));
   CHECK(image.quantileToValue(3, 1.0) == Catch::Approx(23.0));
   CHECK(image.quantileToValue(4, 1.0) == Catch::Approx(24.0));
@@ -920,7 +1118,7 @@ TEST_CASE("Raw images expose logical components for separated and interleaved la
         }
       }
 
-      CHECK(image.generateSortedBuffers());
+      CHECK(image.generateQuantileIndex());
       for (uint32_t component = 0; component < numComponents; ++component) {
         CHECK(image.quantileToValue(component, 0.0) == Catch::Approx(100.0 * component + 1.0));
         CHECK(image.quantileToValue(component, 1.0) == Catch::Approx(100.0 * component + 3.0));
@@ -1407,7 +1605,7 @@ TEST_CASE("Approximate image quantiles use T-digest data before exact buffers ar
   CHECK_THROWS_AS(image.valueToQuantile(1, 30.0), std::exception);
 }
 
-TEST_CASE("Exact quantiles split interleaved component buffers before sorting", "[image][quantiles][interleaved]")
+TEST_CASE("Exact quantiles index interleaved component buffers per component", "[image][quantiles][interleaved]")
 {
   const glm::uvec3 dims{3, 1, 1};
   ImageIoInfo ioInfo = makeIoInfo(ComponentType::Int16, 3, dims);
@@ -1423,7 +1621,7 @@ TEST_CASE("Exact quantiles split interleaved component buffers before sorting",
     Image::MultiComponentBufferType::InterleavedImage,
     buffers);
 
-  REQUIRE(image.generateSortedBuffers());
+  REQUIRE(image.generateQuantileIndex());
   image.settings().setUsingExactQuantiles(true);
 
   CHECK(image.quantileToValue(0, 0.0) == Catch::Approx(10.0));
@@ -0,0 +1,289 @@
+#include "image/ImageFrameCache.h"
+#include "image/ImageUtility.h"
+#include "image/TimePlaybackController.h"
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace
+{
+constexpr std::size_t k_numFramePixels = 1000;
+constexpr std::size_t k_frameBytes = k_numFramePixels * sizeof(int16_t);
+
+/// Pixel values of a frame of a synthetic time series: frames differ in both mean and spread
+int16_t frameValue(uint32_t timePoint, std::size_t i)
+{
+  return static_cast<int16_t>(static_cast<int>(timePoint) * 50 + static_cast<int>(i % (timePoint + 7)));
+}
+
+ImageFrameCache::FrameLoader makeLoader(std::atomic<uint32_t>& numLoads)
+{
+  return [&numLoads](uint32_t timePoint) -> std::optional<ImageFrameBuffers> {
+    ++numLoads;
+    SharedComponentBuffers<int16_t> frame;
+    auto& buffer = frame.mutableBuffers().emplace_back(k_numFramePixels);
+    for (std::size_t i = 0; i < k_numFramePixels; ++i) {
+      buffer[i] = frameValue(timePoint, i);
+    }
+    return ImageFrameBuffers{std::move(frame)};
+  };
+}
+
+/// Summarize values with the sample variance convention used for image statistics
+ComponentSummary summarizeValues(const std::vector<int16_t>& values)
+{
+  ComponentSummary summary;
+  OnlineStats& stats = summary.onlineStats;
+  stats.count = values.size();
+  stats.min = *std::min_element(values.begin(), values.end());
+  stats.max = *std::max_element(values.begin(), values.end());
+
+  for (const int16_t v : values) {
+    stats.sum += v;
+    summary.tdigest.add(static_cast<double>(v));
+  }
+  stats.mean = stats.sum / static_cast<long double>(values.size());
+
+  long double m2 = 0.0;
+  for (const int16_t v : values) {
+    m2 += (v - stats.mean) * (v - stats.mean);
+  }
+  stats.variance = m2 / static_cast<long double>(values.size() - 1);
+  stats.stdev = std::sqrt(stats.variance);
+
+  summary.tdigest.compress();
+  return summary;
+}
+
+std::vector<ComponentSummary> summarizeFrame(const ImageFrameBuffers& frame)
+{
+  return {summarizeValues(std::get<SharedComponentBuffers<int16_t>>(frame).buffers()[0])};
+}
+
+/// Wait for the background worker of a cache to reach a condition
+template<typename Predicate>
+bool waitFor(Predicate&& predicate)
+{
+  for (int i = 0; i < 2000; ++i) {
+    if (predicate()) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return predicate();
+}
+} // namespace
+
+TEST_CASE("Frame cache returns frames and bounds its memory", "[image][time][cache]")
+{
+  std::atomic<uint32_t> numLoads{0};
+
+  ImageFrameCacheOptions options;
+  options.maxCacheBytes = 3 * k_frameBytes;
+  options.readAheadFrames = 0;
+  options.summarizeInBackground = false;
+
+  ImageFrameCache cache(10, k_frameBytes, makeLoader(numLoads), summarizeFrame, options);
+
+  for (uint32_t t = 0; t < 10; ++t) {
+    const auto frame = cache.frame(t);
+    REQUIRE(frame.has_value());
+    const auto& buffers = std::get<SharedComponentBuffers<int16_t>>(*frame).buffers();
+    CHECK(buffers[0][3] == frameValue(t, 3));
+    CHECK(cache.cachedBytes() <= options.maxCacheBytes);
+  }
+
+  CHECK(numLoads == 10);
+
+  // The three most recently used frames are cached
+  CHECK(cache.isCached(9));
+  CHECK(cache.isCached(8));
+  CHECK(cache.isCached(7));
+  CHECK_FALSE(cache.isCached(6));
+
+  // Requesting a cached frame does not read it again, and makes it the most recently used one
+  REQUIRE(cache.frame(7).has_value());
+  CHECK(numLoads == 10);
+  REQUIRE(cache.frame(0).has_value());
+  CHECK(cache.isCached(7));
+  CHECK_FALSE(cache.isCached(8));
+
+  CHECK_FALSE(cache.frame(10).has_value());
+}
+
+TEST_CASE("Frame cache reads frames ahead in the playback direction", "[image][time][cache]")
+{
+  std::atomic<uint32_t> numLoads{0};
+
+  ImageFrameCacheOptions options;
+  options.maxCacheBytes = 8 * k_frameBytes;
+  options.readAheadFrames = 2;
+  options.summarizeInBackground = false;
+
+  ImageFrameCache cache(6, k_frameBytes, makeLoader(numLoads), summarizeFrame, options);
+
+  SECTION("Forwards, wrapping from the last frame to the first")
+  {
+    REQUIRE(cache.frame(5).has_value());
+    cache.readAhead(5, +1);
+    CHECK(waitFor([&cache]() { return cache.isCached(0) && cache.isCached(1); }));
+    CHECK_FALSE(cache.isCached(2));
+  }
+
+  SECTION("Backwards")
+  {
+    REQUIRE(cache.frame(3).has_value());
+    cache.readAhead(3, -1);
+    CHECK(waitFor([&cache]() { return cache.isCached(2) && cache.isCached(1); }));
+    CHECK_FALSE(cache.isCached(0));
+
+    // Frames read ahead are not read again when requested
+    const uint32_t loadsBefore = numLoads;
+    REQUIRE(cache.frame(2).has_value());
+    CHECK(numLoads == loadsBefore);
+  }
+}
+
+TEST_CASE("Frame cache reads requested frames in the background", "[image][time][cache]")
+{
+  std::atomic<uint32_t> numLoads{0};
+
+  ImageFrameCacheOptions options;
+  options.maxCacheBytes = 8 * k_frameBytes;
+  options.readAheadFrames = 0;
+  options.summarizeInBackground = false;
+
+  ImageFrameCache cache(6, k_frameBytes, makeLoader(numLoads), summarizeFrame, options);
+
+  // A frame that is not cached is queued rather than read by the caller
+  CHECK_FALSE(cache.requestFrame(4).has_value());
+  REQUIRE(waitFor([&cache]() { return cache.isCached(4); }));
+
+  const uint32_t loadsBefore = numLoads;
+  const auto frame = cache.requestFrame(4);
+  REQUIRE(frame.has_value());
+  CHECK(std::get<SharedComponentBuffers<int16_t>>(*frame).buffers()[0][5] == frameValue(4, 5));
+  CHECK(numLoads == loadsBefore);
+
+  CHECK_FALSE(cache.requestFrame(6).has_value());
+}
+
+TEST_CASE("Progressive frame summaries match whole-series statistics", "[image][time][cache]")
+{
+  constexpr uint32_t numTimePoints = 8;
+  std::atomic<uint32_t> numLoads{0};
+
+  ImageFrameCacheOptions options;
+  options.maxCacheBytes = 2 * k_frameBytes;
+  options.readAheadFrames = 1;
+
+  ImageFrameCache cache(numTimePoints, k_frameBytes, makeLoader(numLoads), summarizeFrame, options);
+
+  REQUIRE(cache.frame(0).has_value());
+  REQUIRE(waitFor([&cache]() { return cache.summaries().numFrames == numTimePoints; }));
+
+  // Every frame is summarized once, even though the cache holds only two of them
+  CHECK(cache.cachedBytes() <= options.maxCacheBytes);
+  ImageFrameSummaries summaries = cache.summaries();
+  REQUIRE(summaries.components.size() == 1);
+
+  std::vector<int16_t> series;
+  for (uint32_t t = 0; t < numTimePoints; ++t) {
+    for (std::size_t i = 0; i < k_numFramePixels; ++i) {
+      series.push_back(frameValue(t, i));
+    }
+  }
+  ComponentSummary expected = summarizeValues(series);
+
+  const OnlineStats& stats = summaries.components[0].onlineStats;
+  CHECK(stats.count == expected.onlineStats.count);
+  CHECK(stats.min == expected.onlineStats.min);
+  CHECK(stats.max == expected.onlineStats.max);
+  CHECK(static_cast<double>(stats.sum) == Catch::Approx(static_cast<double>(expected.onlineStats.sum)));
+  CHECK(static_cast<double>(stats.mean) == Catch::Approx(static_cast<double>(expected.onlineStats.mean)));
+  CHECK(
+    static_cast<double>(stats.variance) == Catch::Approx(static_cast<double>(expected.onlineStats.variance)));
+
+  const double range = static_cast<double>(expected.onlineStats.max - expected.onlineStats.min);
+  for (const double q : {0.1, 0.5, 0.9}) {
+    CHECK(
+      summaries.components[0].tdigest.quantile(q) ==
+      Catch::Approx(expected.tdigest.quantile(q)).margin(0.02 * range));
+  }
+}
+
+TEST_CASE("Read-ahead direction follows steps between time points", "[image][time]")
+{
+  CHECK(readAheadDirection(2, 3, 10) == 1);
+  CHECK(readAheadDirection(3, 2, 10) == -1);
+  CHECK(readAheadDirection(9, 0, 10) == 1);
+  CHECK(readAheadDirection(0, 9, 10) == -1);
+  CHECK(readAheadDirection(2, 7, 10) == 1);
+  CHECK(readAheadDirection(7, 2, 10) == -1);
+  CHECK(readAheadDirection(4, 4, 10) == 1);
+  CHECK(readAheadDirection(0, 0, 1) == 1);
+}
+
+TEST_CASE("Frame cache reports failed reads and retries them on demand", "[image][time][cache]")
+{
+  std::atomic<uint32_t> numLoads{0};
+  std::atomic<bool> failReads{true};
+
+  const ImageFrameCache::FrameLoader loader = makeLoader(numLoads);
+  const auto failingLoader = [&loader, &failReads](uint32_t timePoint) -> std::optional<ImageFrameBuffers> {
+    return failReads ? std::nullopt : loader(timePoint);
+  };
+
+  ImageFrameCacheOptions options;
+  options.maxCacheBytes = 4 * k_frameBytes;
+  options.readAheadFrames = 0;
+  options.summarizeInBackground = false;
+
+  ImageFrameCache cache(6, k_frameBytes, failingLoader, summarizeFrame, options);
+
+  CHECK_FALSE(cache.requestFrame(2).has_value());
+  REQUIRE(waitFor([&cache]() { return cache.readFailed(2); }));
+
+  // The worker does not queue the frame again
+  CHECK_FALSE(cache.requestFrame(2).has_value());
+  CHECK(cache.readFailed(2));
+
+  // A blocking read retries it
+  CHECK_FALSE(cache.frame(2).has_value());
+  CHECK(cache.readFailed(2));
+
+  failReads = false;
+  REQUIRE(cache.frame(2).has_value());
+  CHECK_FALSE(cache.readFailed(2));
+  CHECK(cache.requestFrame(2).has_value());
+}
+
+TEST_CASE("Frame cache reads ahead no more frames than it can hold", "[image][time][cache]")
+{
+  std::atomic<uint32_t> numLoads{0};
+
+  ImageFrameCacheOptions options;
+  options.maxCacheBytes = 3 * k_frameBytes;
+  options.readAheadFrames = 5;
+  options.summarizeInBackground = false;
+
+  ImageFrameCache cache(10, k_frameBytes, makeLoader(numLoads), summarizeFrame, options);
+
+  REQUIRE(cache.frame(0).has_value());
+  cache.readAhead(0, +1);
+  REQUIRE(waitFor([&cache]() { return cache.isCached(1) && cache.isCached(2); }));
+
+  // Give the worker time to read further ahead if it were going to
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  CHECK(numLoads == 3);
+  CHECK(cache.isCached(0));
+  CHECK_FALSE(cache.isCached(3));
+}
@@ -411,7 +411,7 @@ void checkScalarImageRoundTrip(
   CHECK(image.settings().interpolationMode() == expectedDefaultInterpolationMode(expectedMemoryType));
   CHECK(image.settings().colorInterpolationMode() == expectedDefaultInterpolationMode(expectedMemoryType));
 
-  CHECK(image.generateSortedBuffers());
+  CHECK(image.generateQuantileIndex());
   CHECK(
     image.quantileToValue(0, 0.0) ==
     Catch::Approx(static_cast<double>(*std::min_element(values.begin(), values.end()))));
@@ -585,6 +585,62 @@ TEST_CASE(
   CHECK(segmentation.value<double>(0, 2).value() == Catch::Approx(2.0));
 }
 
+TEST_CASE("Images narrower than 64 bits load without widening and clamp when narrowed", "[image][loading][io][cast]")
+{
+  const fs::path dir = testDirectory();
+
+  const fs::path uint16File = writeScalarImage<uint16_t, 3>(
+    dir,
+    "native-uint16",
+    {2, 2, 1},
+    {1.0, 1.0, 1.0},
+    {0.0, 0.0, 0.0},
+    {0, 1, 40000, std::numeric_limits<uint16_t>::max()});
+  Image uint16Image(uint16File, Rep::Image, BufferType::SeparateImages);
+  CHECK(uint16Image.header().memoryComponentType() == ComponentType::UInt16);
+  CHECK(uint16Image.value<double>(0, 2).value() == Catch::Approx(40000.0));
+  CHECK(uint16Image.value<double>(0, 3).value() == Catch::Approx(65535.0));
+
+  const fs::path int64File = writeScalarImage<int64_t, 3>(
+    dir,
+    "narrowed-int64",
+    {3, 1, 1},
+    {1.0, 1.0, 1.0},
+    {0.0, 0.0, 0.0},
+    {-5'000'000'000, 7, 5'000'000'000});
+  Image int64Image(int64File, Rep::Image, BufferType::SeparateImages);
+  CHECK(int64Image.header().memoryComponentType() == ComponentType::Int32);
+  CHECK(int64Image.value<double>(0, 0).value() == Catch::Approx(std::numeric_limits<int32_t>::lowest()));
+  CHECK(int64Image.value<double>(0, 1).value() == Catch::Approx(7.0));
+  CHECK(int64Image.value<double>(0, 2).value() == Catch::Approx(std::numeric_limits<int32_t>::max()));
+
+  const fs::path floatSegFile =
+    writeScalarImage<float, 3>(dir, "float-seg", {3, 1, 1}, {1.0, 1.0, 1.0}, {0.0, 0.0, 0.0}, {-2.0f, 3.0f, 4.0f});
+  Image floatSeg(floatSegFile, Rep::Segmentation, BufferType::SeparateImages);
+  CHECK(floatSeg.header().memoryComponentType() == ComponentType::UInt32);
+  CHECK(floatSeg.value<double>(0, 0).value() == Catch::Approx(0.0));
+  CHECK(floatSeg.value<double>(0, 2).value() == Catch::Approx(4.0));
+}
+
+TEST_CASE("Vector segmentations load only their first component", "[image][loading][vector][segmentation]")
+{
+  const fs::path dir = testDirectory();
+  const fs::path fileName = writeVectorImage<uint8_t>(
+    dir,
+    "vector-segmentation",
+    {2, 1, 1},
+    {1.0, 1.0, 1.0},
+    {0.0, 0.0, 0.0},
+    2,
+    {3, 100, 4, 101});
+
+  Image segmentation(fileName, Rep::Segmentation, BufferType::InterleavedImage);
+
+  CHECK(segmentation.header().numComponentsPerPixel() == 1);
+  CHECK(segmentation.value<double>(0, 0).value() == Catch::Approx(3.0));
+  CHECK(segmentation.value<double>(0, 1).value() == Catch::Approx(4.0));
+}
+
 TEST_CASE("Vector images can be loaded as separate component buffers", "[image][loading][vector]")
 {
   const fs::path dir = testDirectory();
@@ -629,7 +685,7 @@ TEST_CASE("Vector images can be loaded as one interleaved component buffer", "[i
   CHECK(image.value<double>(1, 2).value() == Catch::Approx(22.0));
   CHECK(image.value<double>(2, 2).value() == Catch::Approx(32.0));
 
-  CHECK(image.generateSortedBuffers());
+  CHECK(image.generateQuantileIndex());
   CHECK(image.quantileToValue(0, 0.0) == Catch::Approx(10.0));
   CHECK(image.quantileToValue(1, 0.0) == Catch::Approx(20.0));
   CHECK(image.quantileToValue(2, 0.0) == Catch::Approx(30.0));
@@ -749,7 +805,7 @@ TEST_CASE("4D vector images preserve interleaved frame offsets", "[image][loadin
   CHECK(image.value<double>(2, 1, 1).value() == Catch::Approx(16.0));
   CHECK(image.bufferAsVoid(0, 2) == nullptr);
 
-  CHECK(image.generateSortedBuffers());
+  CHECK(image.generateQuantileIndex());
   CHECK(image.quantileToValue(0, 0.0) == Catch::Approx(1.0));
   CHECK(image.quantileToValue(0, 1.0) == Catch::Approx(14.0));
   CHECK(image.quantileToValue(2, 0.0) == Catch::Approx(3.0));
@@ -0,0 +1,147 @@
+#include "image/ImageMacrocellGrid.h"
+#include "image/Image.h"
+
+#include "ImageFixtures.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+/// Check the cell ranges against the values of the voxels that each cell covers
+void checkRanges(const ImageMacrocellGrid& grid, const Image& image)
+{
+  const glm::uvec3 dims = image.header().pixelDimensions();
+  const uint32_t s = grid.cellSize();
+
+  for (uint32_t cz = 0; cz < grid.cellCounts().z; ++cz) {
+    for (uint32_t cy = 0; cy < grid.cellCounts().y; ++cy) {
+      for (uint32_t cx = 0; cx < grid.cellCounts().x; ++cx) {
+        double minValue = std::numeric_limits<double>::max();
+        double maxValue = std::numeric_limits<double>::lowest();
+
+        for (uint32_t k = cz * s; k <= std::min((cz + 1) * s, dims.z - 1); ++k) {
+          for (uint32_t j = cy * s; j <= std::min((cy + 1) * s, dims.y - 1); ++j) {
+            for (uint32_t i = cx * s; i <= std::min((cx + 1) * s, dims.x - 1); ++i) {
+              const double value = *image.value<double>(0, i, j, k);
+              minValue = std::min(minValue, value);
+              maxValue = std::max(maxValue, value);
+            }
+          }
+        }
+
+        const std::size_t c = grid.cellIndex(glm::uvec3{cx, cy, cz});
+        CHECK(grid.minValue(c) == minValue);
+        CHECK(grid.maxValue(c) == maxValue);
+      }
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE("Macrocell ranges cover the voxels of their cells", "[image][macrocells]")
+{
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> dist(-5.0f, 5.0f);
+  Image image =
+    image_fixtures::makeScalarImage<float>({21, 17, 9}, glm::dvec3{1.0}, [&](const glm::vec3&) { return dist(rng); });
+
+  for (unsigned int numThreads : {1u, 3u}) {
+    const auto grid = ImageMacrocellGrid::build(image, 0, 0, 4, numThreads);
+    REQUIRE(grid.has_value());
+    CHECK(grid->cellCounts() == glm::uvec3(5, 4, 2));
+    CHECK(grid->numCells() == 40);
+    checkRanges(*grid, image);
+  }
+
+  CHECK_FALSE(ImageMacrocellGrid::build(image, 1).has_value());
+  CHECK_FALSE(ImageMacrocellGrid::build(image, 0, 3).has_value());
+  CHECK_FALSE(ImageMacrocellGrid::build(image, 0, 0, 0).has_value());
+
+  // Changed regions are recomputed, including the cells that share their boundary voxels
+  auto grid = ImageMacrocellGrid::build(image, 0, 0, 4);
+  REQUIRE(grid.has_value());
+
+  for (uint32_t k = 2; k <= 4; ++k) {
+    for (uint32_t j = 8; j <= 12; ++j) {
+      for (uint32_t i = 4; i <= 20; ++i) {
+        REQUIRE(image.setValue(0, static_cast<int>(i), static_cast<int>(j), static_cast<int>(k), 100.0f + i));
+      }
+    }
+  }
+
+  CHECK(grid->update(image, glm::uvec3(4, 8, 2), glm::uvec3(17, 5, 3)));
+  checkRanges(*grid, image);
+}
+
+TEST_CASE("Macrocells are active where an isosurface may cross them", "[image][macrocells]")
+{
+  // A ball of high values in a background of zeros
+  const glm::vec3 center{20.0f, 14.0f, 9.0f};
+  Image image = image_fixtures::makeScalarImage<float>({40, 32, 24}, glm::dvec3{1.0}, [&center](const glm::vec3& p) {
+    return std::max(0.0f, 5.0f - glm::length(p - center));
+  });
+
+  const auto grid = ImageMacrocellGrid::build(image, 0);
+  REQUIRE(grid.has_value());
+  CHECK(grid->cellCounts() == glm::uvec3(5, 4, 3));
+
+  const std::array<double, 1> iso{2.5};
+  const std::array<double, 2> outside{-1.0, 6.0};
+  std::size_t numActive = 0;
+
+  for (std::size_t c = 0; c < grid->numCells(); ++c) {
+    numActive += grid->isActive(c, iso) ? 1 : 0;
+
+    // All values are in [0, 5], so no surface outside of that range crosses the image
+    CHECK_FALSE(grid->isActive(c, outside));
+  }
+
+  CHECK(numActive > 0);
+  CHECK(numActive <= 8);
+  CHECK(grid->isActive(grid->cellIndex(grid->cellAt(center)), iso));
+
+  // The ray search finds the first cell along the ray that a brute-force walk of the ray finds
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<float> pos(-0.5f, 39.5f);
+
+  for (int n = 0; n < 200; ++n) {
+    const glm::vec3 a{pos(rng), pos(rng) * 0.8f, pos(rng) * 0.6f};
+    const glm::vec3 b{pos(rng), pos(rng) * 0.8f, pos(rng) * 0.6f};
+    const glm::vec3 dir = b - a;
+
+    const std::optional<float> found = grid->firstActiveRayParameter(a, dir, 0.0f, 1.0f, iso);
+
+    std::optional<float> walked;
+    for (int i = 0; i <= 4000; ++i) {
+      const float t = static_cast<float>(i) / 4000.0f;
+      if (grid->isActive(grid->cellIndex(grid->cellAt(a + t * dir)), iso)) {
+        walked = t;
+        break;
+      }
+    }
+
+    // The walk may step over corners of active cells, which the search does not
+    if (walked) {
+      REQUIRE(found.has_value());
+      CHECK(*found <= *walked);
+      CHECK(*found >= *walked - 1.0f / 4000.0f - 1.0e-3f);
+    }
+
+    if (found) {
+      const float maxDir = std::max({std::abs(dir.x), std::abs(dir.y), std::abs(dir.z)});
+      CHECK(grid->isActive(grid->cellIndex(grid->cellAt(a + (*found + 2.0e-3f / maxDir) * dir)), iso));
+    }
+  }
+}
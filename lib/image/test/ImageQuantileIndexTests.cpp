@@ -0,0 +1,177 @@
+#include "image/ImageQuantileIndex.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+/// Check every rank and a spread of value queries against a sorted copy of the values
+template<typename T, typename Generator>
+void checkIndexMatchesSortedValues(Generator generate, std::size_t count, std::size_t stride = 1)
+{
+  std::mt19937 rng(1234);
+
+  std::vector<T> values(count * stride);
+  for (auto& v : values) {
+    v = generate(rng);
+  }
+
+  const ImageQuantileIndex index = ImageQuantileIndex::build<T>(values.data(), count, stride);
+
+  std::vector<T> sorted;
+  for (std::size_t i = 0; i < count; ++i) {
+    sorted.push_back(values[i * stride]);
+  }
+  std::sort(sorted.begin(), sorted.end());
+
+  REQUIRE(index.size() == sorted.size());
+  CHECK(index.min() == static_cast<double>(sorted.front()));
+  CHECK(index.max() == static_cast<double>(sorted.back()));
+
+  for (std::size_t rank = 0; rank < sorted.size(); ++rank) {
+    REQUIRE(index.valueAtRank(rank) == static_cast<double>(sorted[rank]));
+  }
+
+  for (int q = 0; q < 200; ++q) {
+    const T v = generate(rng);
+    const auto lower = static_cast<std::size_t>(std::lower_bound(sorted.begin(), sorted.end(), v) - sorted.begin());
+    const auto upper = static_cast<std::size_t>(std::upper_bound(sorted.begin(), sorted.end(), v) - sorted.begin());
+    REQUIRE(index.countLess(static_cast<double>(v)) == lower);
+    REQUIRE(index.countLessOrEqual(static_cast<double>(v)) == upper);
+  }
+
+  std::size_t visited = 0;
+  double previous = -std::numeric_limits<double>::infinity();
+  index.forEachValue([&](double value, std::size_t n) {
+    CHECK(value > previous);
+    previous = value;
+    visited += n;
+  });
+  CHECK(visited == sorted.size());
+}
+} // namespace
+
+TEST_CASE("Quantile index matches sorted values for 8- and 16-bit components", "[image][quantiles][index]")
+{
+  checkIndexMatchesSortedValues<int8_t>([](auto& rng) { return static_cast<int8_t>(rng() % 256 - 128); }, 5000);
+  checkIndexMatchesSortedValues<uint8_t>([](auto& rng) { return static_cast<uint8_t>(rng() % 7); }, 5000, 3);
+  checkIndexMatchesSortedValues<int16_t>([](auto& rng) { return static_cast<int16_t>(rng() % 4000 - 1024); }, 20000);
+  checkIndexMatchesSortedValues<uint16_t>([](auto& rng) { return static_cast<uint16_t>(rng()); }, 20000);
+}
+
+TEST_CASE("Quantile index matches sorted values for 32-bit components", "[image][quantiles][index]")
+{
+  SECTION("Sparse buckets")
+  {
+    checkIndexMatchesSortedValues<int32_t>([](auto& rng) { return static_cast<int32_t>(rng()); }, 20000);
+    checkIndexMatchesSortedValues<uint32_t>([](auto& rng) { return static_cast<uint32_t>(rng()); }, 20000, 2);
+
+    std::normal_distribution<float> normal(0.0f, 1000.0f);
+    checkIndexMatchesSortedValues<float>([&normal](auto& rng) { return normal(rng); }, 20000);
+  }
+
+  SECTION("Dense buckets")
+  {
+    // Enough values in a single first-level bucket to switch it to a counting histogram
+    checkIndexMatchesSortedValues<int32_t>([](auto& rng) { return static_cast<int32_t>(rng() % 3000) - 1500; }, 600000);
+    checkIndexMatchesSortedValues<float>([](auto& rng) { return static_cast<float>(rng() % 9) * 0.25f; }, 600000);
+  }
+}
+
+TEST_CASE("Quantile index skips NaN and merges signed zeros", "[image][quantiles][index]")
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const std::vector<float> values{3.0f, nan, -0.0f, 0.0f, -2.0f, nan};
+
+  const ImageQuantileIndex index = ImageQuantileIndex::build(values.data(), values.size());
+
+  REQUIRE(index.size() == 4);
+  CHECK(index.valueAtRank(0) == -2.0);
+  CHECK(index.valueAtRank(1) == 0.0);
+  CHECK(index.valueAtRank(2) == 0.0);
+  CHECK(index.valueAtRank(3) == 3.0);
+  CHECK(index.countLess(0.0) == 1);
+  CHECK(index.countLessOrEqual(-0.0) == 3);
+  CHECK(index.countLessOrEqual(100.0) == 4);
+}
+
+TEST_CASE("Empty quantile index reports no values", "[image][quantiles][index]")
+{
+  const ImageQuantileIndex index = ImageQuantileIndex::build<uint16_t>(nullptr, 0);
+  CHECK(index.empty());
+  CHECK(index.countLess(5.0) == 0);
+  CHECK(index.countLessOrEqual(5.0) == 0);
+}
+
+TEST_CASE("Quantile index rounds fractional and out-of-range queries", "[image][quantiles][index]")
+{
+  SECTION("Fractional queries on integer components")
+  {
+    const std::vector<int16_t> values{1, 3, 3, 5, -2};
+    const ImageQuantileIndex index = ImageQuantileIndex::build(values.data(), values.size());
+
+    CHECK(index.countLess(3.5) == 4);
+    CHECK(index.countLess(2.5) == 2);
+    CHECK(index.countLess(-1.5) == 1);
+    CHECK(index.countLessOrEqual(2.5) == 2);
+    CHECK(index.countLessOrEqual(3.5) == 4);
+    CHECK(index.countLessOrEqual(-2.5) == 0);
+  }
+
+  SECTION("Fractional queries on 32-bit integer components")
+  {
+    const std::vector<int32_t> values{-7, 0, 0, 100000};
+    const ImageQuantileIndex index = ImageQuantileIndex::build(values.data(), values.size());
+
+    CHECK(index.countLess(-6.5) == 1);
+    CHECK(index.countLess(0.25) == 3);
+    CHECK(index.countLessOrEqual(-0.25) == 1);
+    CHECK(index.countLessOrEqual(99999.9) == 3);
+  }
+
+  SECTION("Queries outside of the component range")
+  {
+    const std::vector<uint8_t> values{0, 0, 7, 255};
+    const ImageQuantileIndex index = ImageQuantileIndex::build(values.data(), values.size());
+
+    CHECK(index.countLessOrEqual(-1.0) == 0);
+    CHECK(index.countLess(-0.5) == 0);
+    CHECK(index.countLessOrEqual(-0.5) == 0);
+    CHECK(index.countLess(0.0) == 0);
+    CHECK(index.countLessOrEqual(0.0) == 2);
+    CHECK(index.countLess(255.0) == 3);
+    CHECK(index.countLess(255.5) == 4);
+    CHECK(index.countLess(300.0) == 4);
+    CHECK(index.countLessOrEqual(255.5) == 4);
+    CHECK(index.countLess(-std::numeric_limits<double>::infinity()) == 0);
+    CHECK(index.countLessOrEqual(std::numeric_limits<double>::infinity()) == 4);
+
+    const std::vector<uint32_t> wide{0, 1, std::numeric_limits<uint32_t>::max()};
+    const ImageQuantileIndex wideIndex = ImageQuantileIndex::build(wide.data(), wide.size());
+
+    CHECK(wideIndex.countLessOrEqual(-1.0) == 0);
+    CHECK(wideIndex.countLess(5.0e9) == 3);
+    CHECK(wideIndex.countLessOrEqual(4294967295.0) == 3);
+  }
+
+  SECTION("Queries between float components")
+  {
+    const std::vector<float> values{0.1f, 1.0f, 1.0f, std::numeric_limits<float>::max()};
+    const ImageQuantileIndex index = ImageQuantileIndex::build(values.data(), values.size());
+
+    // The float nearest to 0.1 is greater than the double 0.1
+    CHECK(index.countLessOrEqual(0.1) == 0);
+    CHECK(index.countLess(static_cast<double>(0.1f)) == 0);
+    CHECK(index.countLessOrEqual(static_cast<double>(0.1f)) == 1);
+    CHECK(index.countLess(1.0 + 1.0e-12) == 3);
+    CHECK(index.countLessOrEqual(1.0 - 1.0e-12) == 1);
+    CHECK(index.countLess(1.0e300) == 4);
+    CHECK(index.countLessOrEqual(-1.0e300) == 0);
+  }
+}
@@ -0,0 +1,220 @@
+#include "image/Image.h"
+#include "image/ImageSampler.h"
+
+#include "ImageFixtures.h"
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+/// Three-component image with two time points and random values
+Image makeRandomVectorImage(Image::MultiComponentBufferType bufferType)
+{
+  constexpr uint32_t numComponents = 3;
+  constexpr uint32_t numTimePoints = 2;
+  const glm::uvec3 dims{7, 5, 4};
+
+  const ImageIoInfo ioInfo =
+    image_fixtures::makeIoInfo(ComponentType::Float32, numComponents, dims, {0.5, 1.5, 2.5}, {-1.0, 2.0, 3.0});
+  ImageHeader header(ioInfo, ioInfo, Image::MultiComponentBufferType::InterleavedImage == bufferType);
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+
+  const std::size_t numValues = static_cast<std::size_t>(numTimePoints) * header.numPixels();
+  std::vector<std::vector<float>> values;
+
+  if (Image::MultiComponentBufferType::InterleavedImage == bufferType) {
+    values.emplace_back(numValues * numComponents);
+  }
+  else {
+    values.assign(numComponents, std::vector<float>(numValues));
+  }
+
+  std::vector<const void*> buffers;
+  for (auto& buffer : values) {
+    for (float& v : buffer) {
+      v = dist(rng);
+    }
+    buffers.push_back(buffer.data());
+  }
+
+  return Image(
+    header,
+    "random-vector",
+    Image::ImageRepresentation::Image,
+    bufferType,
+    buffers,
+    ImageTimeAxis{numTimePoints, 0.0, 1.0, "sec"});
+}
+
+std::vector<glm::vec3> makeRandomPositions(std::size_t count, const glm::vec3& lo, const glm::vec3& hi)
+{
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> dx(lo.x, hi.x);
+  std::uniform_real_distribution<float> dy(lo.y, hi.y);
+  std::uniform_real_distribution<float> dz(lo.z, hi.z);
+
+  std::vector<glm::vec3> positions(count);
+  for (auto& p : positions) {
+    p = glm::vec3{dx(rng), dy(rng), dz(rng)};
+  }
+  return positions;
+}
+} // namespace
+
+TEST_CASE("Batched linear samples match Image::valueLinear", "[image][sampler]")
+{
+  for (const auto bufferType :
+       {Image::MultiComponentBufferType::SeparateImages, Image::MultiComponentBufferType::InterleavedImage})
+  {
+    const Image image = makeRandomVectorImage(bufferType);
+
+    // Include positions outside the image and exact edge coordinates
+    std::vector<glm::vec3> positions =
+      makeRandomPositions(5000, glm::vec3{-1.5f, -1.5f, -1.5f}, glm::vec3{7.5f, 5.5f, 4.5f});
+    positions.push_back(glm::vec3{-0.5f, -0.5f, -0.5f});
+    positions.push_back(glm::vec3{6.5f, 4.5f, 3.5f});
+    positions.push_back(glm::vec3{6.0f, 4.0f, 3.0f});
+    positions.push_back(glm::vec3{std::numeric_limits<float>::quiet_NaN(), 1.0f, 1.0f});
+
+    ImageSamplerOptions options;
+    options.timePoint = 1;
+    options.numComponents = 3;
+
+    const auto samples = sampleImageAtPixels(image, positions, options);
+    REQUIRE(samples.has_value());
+    REQUIRE(samples->size() == positions.size());
+
+    for (std::size_t p = 0; p < positions.size(); ++p) {
+      const glm::vec3& pos = positions[p];
+      for (uint32_t c = 0; c < 3; ++c) {
+        const auto expected = image.valueLinear<double>(c, pos.x, pos.y, pos.z, 1);
+        REQUIRE(samples->isValid(p) == expected.has_value());
+        if (expected) {
+          REQUIRE(samples->value(p, c) == Catch::Approx(*expected).margin(1.0e-9));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Batched sampling applies interpolation and boundary rules", "[image][sampler]")
+{
+  const Image image = makeRandomVectorImage(Image::MultiComponentBufferType::SeparateImages);
+
+  const std::vector<glm::vec3> positions{
+    glm::vec3{2.4f, 1.6f, 0.5f}, glm::vec3{-3.0f, 2.0f, 1.0f}, glm::vec3{2.0f, 9.0f, 1.0f}};
+
+  SECTION("Nearest interpolation reads the nearest pixel")
+  {
+    ImageSamplerOptions options;
+    options.interpolation = SampleInterpolation::Nearest;
+    options.firstComponent = 2;
+
+    const auto samples = sampleImageAtPixels(image, positions, options);
+    REQUIRE(samples.has_value());
+    CHECK(samples->isValid(0));
+    CHECK(samples->value(0) == image.value<double>(2, 2, 2, 1).value());
+    CHECK_FALSE(samples->isValid(1));
+    CHECK_FALSE(samples->isValid(2));
+  }
+
+  SECTION("Clamp-to-edge samples the edge pixels")
+  {
+    ImageSamplerOptions options;
+    options.interpolation = SampleInterpolation::Nearest;
+    options.boundary = SampleBoundary::ClampToEdge;
+
+    const auto samples = sampleImageAtPixels(image, positions, options);
+    REQUIRE(samples.has_value());
+    CHECK(samples->isValid(1));
+    CHECK(samples->value(1) == image.value<double>(0, 0, 2, 1).value());
+    CHECK(samples->isValid(2));
+    CHECK(samples->value(2) == image.value<double>(0, 2, 4, 1).value());
+  }
+
+  SECTION("Constant boundary returns the outside value")
+  {
+    ImageSamplerOptions options;
+    options.boundary = SampleBoundary::Constant;
+    options.outsideValue = -7.0;
+
+    const auto samples = sampleImageAtPixels(image, positions, options);
+    REQUIRE(samples.has_value());
+    CHECK(samples->value(0) == Catch::Approx(image.valueLinear<double>(0, 2.4f, 1.6f, 0.5f).value()));
+    CHECK(samples->isValid(1));
+    CHECK(samples->value(1) == -7.0);
+    CHECK(samples->isValid(2));
+    CHECK(samples->value(2) == -7.0);
+  }
+
+  SECTION("Invalid component ranges and time points are rejected")
+  {
+    ImageSamplerOptions options;
+    options.firstComponent = 1;
+    options.numComponents = 3;
+    CHECK_FALSE(sampleImageAtPixels(image, positions, options).has_value());
+
+    options = {};
+    options.timePoint = 2;
+    CHECK_FALSE(sampleImageAtPixels(image, positions, options).has_value());
+  }
+}
+
+TEST_CASE("Threaded batched sampling matches single-threaded sampling", "[image][sampler]")
+{
+  const Image image = makeRandomVectorImage(Image::MultiComponentBufferType::InterleavedImage);
+  const std::vector<glm::vec3> positions =
+    makeRandomPositions(100003, glm::vec3{-1.0f, -1.0f, -1.0f}, glm::vec3{7.0f, 5.0f, 4.0f});
+
+  ImageSamplerOptions options;
+  options.numComponents = 3;
+  options.maxThreads = 1;
+  const auto serial = sampleImageAtPixels(image, positions, options);
+
+  options.maxThreads = 4;
+  const auto threaded = sampleImageAtPixels(image, positions, options);
+
+  REQUIRE(serial.has_value());
+  REQUIRE(threaded.has_value());
+  CHECK(serial->valid == threaded->valid);
+  CHECK(serial->values == threaded->values);
+}
+
+TEST_CASE("Single-point sampling matches batched sampling", "[image][sampler]")
+{
+  const Image image = makeRandomVectorImage(Image::MultiComponentBufferType::InterleavedImage);
+  const std::vector<glm::vec3> positions =
+    makeRandomPositions(200, glm::vec3{-1.5f, -1.5f, -1.5f}, glm::vec3{7.5f, 5.5f, 4.5f});
+
+  ImageSamplerOptions options;
+  options.timePoint = 1;
+  options.firstComponent = 1;
+  options.numComponents = 2;
+
+  const auto batch = sampleImageAtPixels(image, positions, options);
+  REQUIRE(batch.has_value());
+
+  for (std::size_t p = 0; p < positions.size(); ++p) {
+    std::array<double, 2> values{};
+    CHECK(sampleImageAtPixel(image, positions[p], values, options) == batch->isValid(p));
+    if (batch->isValid(p)) {
+      CHECK(values[0] == batch->value(p, 0));
+      CHECK(values[1] == batch->value(p, 1));
+    }
+  }
+
+  std::array<double, 1> tooSmall{};
+  CHECK_FALSE(sampleImageAtPixel(image, glm::vec3{1.0f}, tooSmall, options));
+}
@@ -0,0 +1,164 @@
+#include "image/Image.h"
+#include "image/SegEditHistory.h"
+
+#include "ImageFixtures.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+
+using image_fixtures::makeSegmentation;
+
+/// Paint a box of voxels, recording the edit
+void paintBox(
+  SegEditHistory& history,
+  const uuids::uuid& segUid,
+  Image& seg,
+  const glm::ivec3& minVoxel,
+  const glm::ivec3& maxVoxel,
+  uint8_t label)
+{
+  const auto before = SegEditHistory::captureBlock(seg, minVoxel, maxVoxel);
+  REQUIRE(before.has_value());
+
+  for (int k = minVoxel.z; k <= maxVoxel.z; ++k) {
+    for (int j = minVoxel.y; j <= maxVoxel.y; ++j) {
+      for (int i = minVoxel.x; i <= maxVoxel.x; ++i) {
+        seg.mutableView<uint8_t>(0)->at(i, j, k) = label;
+      }
+    }
+  }
+
+  history.record(segUid, *before, seg);
+}
+
+int64_t labelSum(const Image& seg)
+{
+  const auto view = seg.view<uint8_t>(0);
+  return std::accumulate(view->data(), view->data() + view->numPixels(), int64_t{0});
+}
+
+} // namespace
+
+TEST_CASE("Segmentation edit history undoes and redoes coalesced strokes", "[image][segmentation]")
+{
+  const uuids::uuid segUid = uuids::uuid::from_string("11111111-2222-3333-4444-555555555555").value();
+  Image seg = makeSegmentation({16, 16, 4});
+  SegEditHistory history;
+
+  // One stroke of overlapping dabs, then a separate edit
+  history.beginStep();
+  paintBox(history, segUid, seg, {0, 0, 1}, {3, 3, 1}, 2);
+  paintBox(history, segUid, seg, {2, 0, 1}, {5, 3, 1}, 2);
+  history.endStep();
+  paintBox(history, segUid, seg, {8, 8, 2}, {9, 9, 2}, 7);
+
+  CHECK(history.numUndoSteps() == 2);
+  CHECK(labelSum(seg) == 2 * 24 + 7 * 4);
+
+  std::vector<glm::uvec3> restoredOffsets;
+  std::vector<glm::uvec3> restoredSizes;
+  auto lookup = [&seg](const uuids::uuid&) { return &seg; };
+  auto onRestored = [&](const uuids::uuid& uid, const glm::uvec3& offset, const glm::uvec3& size) {
+    CHECK(uid == segUid);
+    restoredOffsets.push_back(offset);
+    restoredSizes.push_back(size);
+  };
+
+  // Only the region of each edit is restored
+  REQUIRE(history.undo(lookup, onRestored));
+  CHECK(labelSum(seg) == 2 * 24);
+  REQUIRE(restoredOffsets.size() == 1);
+  CHECK(restoredOffsets.front() == glm::uvec3(8, 8, 2));
+  CHECK(restoredSizes.front() == glm::uvec3(2, 2, 1));
+
+  REQUIRE(history.undo(lookup, onRestored));
+  CHECK(labelSum(seg) == 0);
+  CHECK_FALSE(history.canUndo());
+  CHECK_FALSE(history.undo(lookup, onRestored));
+
+  REQUIRE(history.redo(lookup, onRestored));
+  CHECK(labelSum(seg) == 2 * 24);
+  CHECK(seg.value<int64_t>(0, 5, 3, 1).value() == 2);
+  CHECK(seg.value<int64_t>(0, 6, 3, 1).value() == 0);
+
+  // A new edit discards the undone step
+  paintBox(history, segUid, seg, {0, 0, 0}, {0, 0, 0}, 1);
+  CHECK_FALSE(history.canRedo());
+  CHECK(history.numUndoSteps() == 2);
+}
+
+TEST_CASE("Segmentation edit history stores only changed runs within its memory budget", "[image][segmentation]")
+{
+  const uuids::uuid segUid = uuids::uuid::from_string("11111111-2222-3333-4444-555555555555").value();
+  Image seg = makeSegmentation({64, 64, 8});
+  SegEditHistory history;
+
+  // Painting a label over itself changes nothing and records nothing
+  paintBox(history, segUid, seg, {0, 0, 0}, {63, 63, 7}, 0);
+  CHECK(history.numUndoSteps() == 0);
+  CHECK(history.memoryUsage() == 0);
+
+  // A whole-image edit recorded against a blank block is stored as one run per row
+  for (int i = 0; i < 8; ++i) {
+    paintBox(history, segUid, seg, {0, 0, i}, {63, 63, i}, static_cast<uint8_t>(i + 1));
+  }
+  CHECK(history.numUndoSteps() == 8);
+
+  const std::size_t usage = history.memoryUsage();
+  CHECK(usage > 0);
+  CHECK(usage < 8 * 64 * 64);
+
+  // The oldest steps are dropped first, but the newest step is kept
+  history.setMemoryBudget(usage / 2);
+  CHECK(history.memoryUsage() <= usage / 2);
+  CHECK(history.numUndoSteps() < 8);
+  CHECK(history.numUndoSteps() > 0);
+
+  history.setMemoryBudget(1);
+  CHECK(history.numUndoSteps() == 1);
+
+  auto lookup = [&seg](const uuids::uuid&) { return &seg; };
+  REQUIRE(history.undo(lookup, {}));
+  CHECK(seg.value<int64_t>(0, 10, 10, 7).value() == 0);
+  CHECK(seg.value<int64_t>(0, 10, 10, 6).value() == 7);
+
+  // Edits of segmentations that no longer exist are skipped
+  REQUIRE(history.redo([](const uuids::uuid&) -> Image* { return nullptr; }, {}));
+  CHECK(seg.value<int64_t>(0, 10, 10, 7).value() == 0);
+}
+
+TEST_CASE("Segmentation edit history undoes clearing a segmentation as one step", "[image][segmentation]")
+{
+  const uuids::uuid segUid = uuids::uuid::from_string("11111111-2222-3333-4444-555555555555").value();
+  Image seg = makeSegmentation({16, 16, 4});
+  SegEditHistory history;
+
+  paintBox(history, segUid, seg, {0, 0, 0}, {3, 3, 0}, 2);
+  paintBox(history, segUid, seg, {4, 4, 1}, {5, 5, 1}, 5);
+
+  const auto before = SegEditHistory::captureBlock(seg, {0, 0, 0}, {15, 15, 3});
+  REQUIRE(before.has_value());
+  seg.setAllValues(0);
+  REQUIRE(history.record(segUid, *before, seg));
+  CHECK(history.numUndoSteps() == 3);
+
+  // Undoing the clear restores the labels, and the earlier edits then undo onto them
+  auto lookup = [&seg](const uuids::uuid&) { return &seg; };
+  REQUIRE(history.undo(lookup, {}));
+  CHECK(labelSum(seg) == 2 * 16 + 5 * 4);
+
+  REQUIRE(history.undo(lookup, {}));
+  CHECK(labelSum(seg) == 2 * 16);
+
+  REQUIRE(history.redo(lookup, {}));
+  REQUIRE(history.redo(lookup, {}));
+  CHECK(labelSum(seg) == 0);
+}
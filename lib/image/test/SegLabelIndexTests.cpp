@@ -0,0 +1,110 @@
+#include "image/Image.h"
+#include "image/SegEditHistory.h"
+#include "image/SegLabelIndex.h"
+
+#include "ImageFixtures.h"
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+using image_fixtures::fillBox;
+using image_fixtures::makeSegmentation;
+} // namespace
+
+TEST_CASE("Segmentation label index summarizes labels in one pass", "[image][segmentation]")
+{
+  Image seg = makeSegmentation({20, 10, 6}, {0.5, 1.0, 2.0});
+  fillBox(seg, {2, 1, 0}, {5, 4, 1}, 3);
+  fillBox(seg, {10, 0, 3}, {19, 9, 5}, 9);
+
+  // The result does not depend on how the slices are split between threads
+  for (unsigned int numThreads : {1u, 4u, 16u}) {
+    const auto index = SegLabelIndex::build(seg, numThreads);
+    REQUIRE(index.has_value());
+
+    CHECK(index->labels() == std::vector<uint32_t>{0, 3, 9});
+    CHECK(index->voxelCount(3) == 4 * 4 * 2);
+    CHECK(index->voxelCount(9) == 10 * 10 * 3);
+    CHECK(index->voxelCount(0) == 20 * 10 * 6 - 32 - 300);
+    CHECK(index->voxelCount(1) == 0);
+    CHECK(index->volume(3) == Catch::Approx(32.0));
+
+    const SegLabelStats* stats = index->stats(3);
+    REQUIRE(stats);
+    CHECK(stats->minVoxel == glm::uvec3(2, 1, 0));
+    CHECK(stats->maxVoxel == glm::uvec3(5, 4, 1));
+    CHECK(index->centroid(3) == glm::vec3(3.5f, 2.5f, 0.5f));
+    CHECK_FALSE(index->centroid(1).has_value());
+
+    const LabelIndexMaps labelMaps = index->labelIndexMaps(true);
+    CHECK(labelMaps.indexToLabel.size() == 2);
+    CHECK(labelMaps.labelToIndex.at(3) == 0);
+    CHECK(labelMaps.labelToIndex.at(9) == 1);
+  }
+}
+
+TEST_CASE("Segmentation label index follows recorded, undone and redone edits", "[image][segmentation]")
+{
+  const uuids::uuid segUid = uuids::uuid::from_string("11111111-2222-3333-4444-555555555555").value();
+  Image seg = makeSegmentation({16, 16, 4}, {1.0, 1.0, 1.0});
+  fillBox(seg, {0, 0, 0}, {7, 7, 0}, 1);
+
+  auto index = SegLabelIndex::build(seg);
+  REQUIRE(index.has_value());
+
+  SegEditHistory history;
+  history.setEditObserver([&index](const uuids::uuid&, std::span<const SegmentationLabelRun> runs, bool undone) {
+    index->applyRuns(runs, undone);
+  });
+
+  auto edit = [&](const glm::ivec3& minVoxel, const glm::ivec3& maxVoxel, uint8_t label) {
+    const auto before = SegEditHistory::captureBlock(seg, minVoxel, maxVoxel);
+    REQUIRE(before.has_value());
+    fillBox(seg, minVoxel, maxVoxel, label);
+    history.record(segUid, *before, seg);
+  };
+
+  // Erase the right half of label 1 and paint label 2 elsewhere
+  edit({4, 0, 0}, {7, 7, 0}, 0);
+  edit({10, 10, 2}, {11, 11, 3}, 2);
+
+  CHECK(index->voxelCount(1) == 32);
+  CHECK(index->voxelCount(2) == 8);
+  CHECK(index->centroid(1) == glm::vec3(1.5f, 3.5f, 0.0f));
+  CHECK(index->centroid(2) == glm::vec3(10.5f, 10.5f, 2.5f));
+
+  // Bounds of the shrunk label are loose until tightened
+  const SegLabelStats* stats = index->stats(1);
+  REQUIRE(stats);
+  CHECK_FALSE(stats->boundsAreTight);
+  CHECK(stats->maxVoxel == glm::uvec3(7, 7, 0));
+  REQUIRE(index->tightenBounds(1, seg));
+  CHECK(stats->boundsAreTight);
+  CHECK(stats->maxVoxel == glm::uvec3(3, 7, 0));
+
+  auto lookup = [&seg](const uuids::uuid&) { return &seg; };
+  REQUIRE(history.undo(lookup, {}));
+  CHECK(index->voxelCount(2) == 0);
+  CHECK(index->stats(2) == nullptr);
+
+  REQUIRE(history.undo(lookup, {}));
+  CHECK(index->voxelCount(1) == 64);
+  CHECK(index->stats(1)->maxVoxel == glm::uvec3(7, 7, 0));
+
+  REQUIRE(history.redo(lookup, {}));
+  CHECK(index->voxelCount(1) == 32);
+  CHECK(index->voxelCount(0) == 16 * 16 * 4 - 32);
+
+  // The incrementally updated index matches a rebuilt one
+  const auto rebuilt = SegLabelIndex::build(seg);
+  REQUIRE(rebuilt.has_value());
+  CHECK(rebuilt->labels() == index->labels());
+  CHECK(rebuilt->centroid(1) == index->centroid(1));
+}
@@ -95,21 +95,85 @@ TEST_CASE("Segmentation brush footprints respect 3D shape, bounds, and isotropic
   const glm::vec4 unusedPlane{0.0f, 0.0f, 1.0f, -2.0f};
 
   const auto cube = computeSegmentationBrushFootprint(seg, false, true, false, 2, glm::ivec3(2, 2, 2), unusedPlane);
-  CHECK(cube.voxels.size() == 27);
+  CHECK(cube.numVoxels() == 27);
+  CHECK(cube.spans.size() == 9);
   CHECK(cube.minVoxel == glm::ivec3(1, 1, 1));
   CHECK(cube.maxVoxel == glm::ivec3(3, 3, 3));
 
   const auto sphere = computeSegmentationBrushFootprint(seg, true, true, false, 2, glm::ivec3(2, 2, 2), unusedPlane);
-  CHECK(sphere.voxels.size() == 7);
-  CHECK(sphere.voxels.count(glm::ivec3(2, 2, 2)) == 1);
-  CHECK(sphere.voxels.count(glm::ivec3(3, 3, 2)) == 0);
+  CHECK(sphere.numVoxels() == 7);
+  CHECK(sphere.contains(glm::ivec3(2, 2, 2)));
+  CHECK_FALSE(sphere.contains(glm::ivec3(3, 3, 2)));
 
   const auto clipped = computeSegmentationBrushFootprint(seg, false, true, false, 2, glm::ivec3(0, 0, 0), unusedPlane);
-  CHECK(clipped.voxels.size() == 8);
+  CHECK(clipped.numVoxels() == 8);
   CHECK(clipped.minVoxel == glm::ivec3(0, 0, 0));
   CHECK(clipped.maxVoxel == glm::ivec3(1, 1, 1));
 }
 
+TEST_CASE("Segmentation brush stencils are reused across centers and clipped in view planes", "[image][segmentation]")
+{
+  Image seg = makeSegmentation();
+  const glm::vec4 axialPlane{0.0f, 0.0f, 1.0f, -2.0f};
+
+  const auto disk = computeSegmentationBrushFootprint(seg, true, false, false, 2, glm::ivec3(2, 2, 2), axialPlane);
+  CHECK(disk.numVoxels() == 5);
+  CHECK(disk.spans.size() == 3);
+  CHECK(disk.minVoxel == glm::ivec3(1, 1, 2));
+  CHECK(disk.maxVoxel == glm::ivec3(3, 3, 2));
+
+  // The cached stencil gives the same footprint again, translated with the brush center
+  const auto again = computeSegmentationBrushFootprint(seg, true, false, false, 2, glm::ivec3(2, 2, 2), axialPlane);
+  CHECK(again.numVoxels() == disk.numVoxels());
+  CHECK(again.minVoxel == disk.minVoxel);
+
+  const auto moved = computeSegmentationBrushFootprint(seg, true, false, false, 2, glm::ivec3(1, 2, 2), axialPlane);
+  CHECK(moved.numVoxels() == 5);
+  CHECK(moved.contains(glm::ivec3(0, 2, 2)));
+  CHECK_FALSE(moved.contains(glm::ivec3(3, 2, 2)));
+
+  const auto corner = computeSegmentationBrushFootprint(seg, true, false, false, 2, glm::ivec3(0, 0, 2), axialPlane);
+  CHECK(corner.numVoxels() == 3);
+  CHECK(corner.minVoxel == glm::ivec3(0, 0, 2));
+  CHECK(corner.maxVoxel == glm::ivec3(1, 1, 2));
+
+  // Footprints built from voxel sets merge consecutive voxels of a row into one span
+  const SegmentationVoxelSet voxels{glm::ivec3(1, 0, 0), glm::ivec3(2, 0, 0), glm::ivec3(4, 0, 0), glm::ivec3(0, 1, 0)};
+  const auto fromSet = makeSegmentationFootprint(voxels);
+  CHECK(fromSet.spans.size() == 3);
+  CHECK(fromSet.numVoxels() == 4);
+  CHECK(fromSet.minVoxel == glm::ivec3(0, 0, 0));
+  CHECK(fromSet.maxVoxel == glm::ivec3(4, 1, 0));
+  CHECK_FALSE(fromSet.contains(glm::ivec3(3, 0, 0)));
+}
+
+TEST_CASE("Segmentation brush strokes are swept between positions without gaps", "[image][segmentation]")
+{
+  Image seg = makeSegmentation();
+  const glm::vec4 axialPlane{0.0f, 0.0f, 1.0f, -2.0f};
+
+  // A one-voxel brush moved four voxels stamps every voxel after the start
+  const auto line = computeSegmentationStrokeFootprint(
+    seg, true, false, false, 1, glm::vec3(0.0f, 2.0f, 2.0f), glm::vec3(4.0f, 2.0f, 2.0f), axialPlane);
+  CHECK(line.numVoxels() == 4);
+  CHECK(line.spans.size() == 1);
+  CHECK_FALSE(line.contains(glm::ivec3(0, 2, 2)));
+  CHECK(line.contains(glm::ivec3(4, 2, 2)));
+
+  // Overlapping disks are merged into one span per row
+  const auto swept = computeSegmentationStrokeFootprint(
+    seg, true, false, false, 2, glm::vec3(1.0f, 2.0f, 2.0f), glm::vec3(3.0f, 2.0f, 2.0f), axialPlane);
+  CHECK(swept.numVoxels() == 8);
+  CHECK(swept.spans.size() == 3);
+  CHECK(swept.minVoxel == glm::ivec3(1, 1, 2));
+  CHECK(swept.maxVoxel == glm::ivec3(4, 3, 2));
+
+  // A stroke within one voxel stamps that voxel
+  const auto dab = computeSegmentationStrokeFootprint(
+    seg, true, false, false, 2, glm::vec3(2.2f, 2.0f, 2.0f), glm::vec3(2.0f, 2.0f, 2.0f), axialPlane);
+  CHECK(dab.numVoxels() == 5);
+}
+
 TEST_CASE("Painting segmentation updates labels and reports the changed texture block", "[image][segmentation]")
 {
   Image seg = makeSegmentation();
@@ -167,6 +231,52 @@ TEST_CASE("Painting segmentation updates labels and reports the changed texture
   CHECK(seg.value<int64_t>(0, 2, 2, 2).value() == 5);
 }
 
+TEST_CASE("Painting segmentation regions matches painting with changed labels", "[image][segmentation]")
+{
+  Image segWithLabels = makeSegmentation();
+  Image segWithRegion = makeSegmentation();
+  const glm::vec4 unusedPlane{0.0f, 0.0f, 1.0f, -2.0f};
+
+  const SegmentationBrushFootprint footprint =
+    computeSegmentationBrushFootprint(segWithLabels, true, true, false, 3, glm::ivec3(2, 2, 2), unusedPlane);
+  REQUIRE_FALSE(footprint.empty());
+
+  glm::uvec3 labelsOffset{0};
+  glm::uvec3 labelsSize{0};
+  updateSegmentationVoxels(
+    footprint,
+    7,
+    0,
+    true,
+    segWithLabels,
+    [&](const ComponentType&, const glm::uvec3& offset, const glm::uvec3& size, const int64_t*) {
+      labelsOffset = offset;
+      labelsSize = size;
+    });
+
+  glm::uvec3 regionOffset{0};
+  glm::uvec3 regionSize{0};
+  updateSegmentationVoxels(footprint, 7, 0, true, segWithRegion, [&](const glm::uvec3& offset, const glm::uvec3& size) {
+    regionOffset = offset;
+    regionSize = size;
+  });
+
+  CHECK(regionOffset == labelsOffset);
+  CHECK(regionSize == labelsSize);
+
+  // Only background voxels were replaced, so the center keeps its label
+  CHECK(segWithRegion.value<int64_t>(0, 2, 2, 2).value() == 1);
+  CHECK(segWithRegion.value<int64_t>(0, 1, 2, 2).value() == 7);
+
+  for (int k = 0; k < 5; ++k) {
+    for (int j = 0; j < 5; ++j) {
+      for (int i = 0; i < 5; ++i) {
+        CHECK(segWithRegion.value<int64_t>(0, i, j, k) == segWithLabels.value<int64_t>(0, i, j, k));
+      }
+    }
+  }
+}
+
 TEST_CASE("ImageDerivedData creates derived images and skips unsupported interleaved distance maps", "[image][derived]")
 {
   Image image = makeScalarImage();
@@ -68,3 +68,85 @@ TEST_CASE("Playback frame rate is derived from frame period", "[image][time]")
   CHECK(nextPlaybackTimePoint(3, 4, false) == 3);
   CHECK(nextPlaybackTimePoint(99, 4, true) == 0);
 }
+
+TEST_CASE("Time playback bounces between the first and last frames", "[image][time]")
+{
+  int direction = 1;
+  CHECK(stepPlaybackTimePoint(1, 3, true, true, direction) == 2);
+  CHECK(direction == 1);
+  CHECK(stepPlaybackTimePoint(2, 3, true, true, direction) == 1);
+  CHECK(direction == -1);
+  CHECK(stepPlaybackTimePoint(0, 3, false, true, direction) == 1);
+  CHECK(direction == 1);
+
+  direction = -1;
+  CHECK(stepPlaybackTimePoint(0, 3, true, false, direction) == 2);
+  CHECK(stepPlaybackTimePoint(0, 3, false, false, direction) == 0);
+
+  TimePlaybackState state;
+  TimePlaybackInput input{
+    .playing = true,
+    .loop = true,
+    .bounce = true,
+    .activeTimePoint = 2,
+    .numTimePoints = 3,
+    .framePeriodSeconds = 0.1,
+    .nowSeconds = 1.0};
+
+  (void)updateTimePlaybackFrame(state, input);
+  input.nowSeconds = 1.1;
+  const auto update = updateTimePlaybackFrame(state, input);
+  CHECK(update.timePoint == 1);
+  CHECK(update.advanced);
+  CHECK(state.direction == -1);
+}
+
+TEST_CASE("Upcoming playback time points follow the loop and bounce settings", "[image][time]")
+{
+  CHECK(upcomingPlaybackTimePoints(3, 5, true, false, 1, 3) == std::vector<uint32_t>{4, 0, 1});
+  CHECK(upcomingPlaybackTimePoints(3, 5, false, false, 1, 3) == std::vector<uint32_t>{4});
+  CHECK(upcomingPlaybackTimePoints(3, 5, true, true, 1, 4) == std::vector<uint32_t>{4, 2, 1, 0});
+  CHECK(upcomingPlaybackTimePoints(1, 5, false, true, -1, 3) == std::vector<uint32_t>{0, 2, 3});
+  CHECK(upcomingPlaybackTimePoints(0, 3, true, false, 1, 8) == std::vector<uint32_t>{1, 2});
+  CHECK(upcomingPlaybackTimePoints(0, 1, true, true, 1, 8).empty());
+}
+
+TEST_CASE("Late time playback updates skip due frames and count them as dropped", "[image][time]")
+{
+  TimePlaybackState state;
+  TimePlaybackInput input{
+    .playing = true,
+    .loop = true,
+    .activeTimePoint = 0,
+    .numTimePoints = 10,
+    .framePeriodSeconds = 0.1,
+    .nowSeconds = 1.0};
+
+  (void)updateTimePlaybackFrame(state, input);
+  input.nowSeconds = 1.35;
+  auto update = updateTimePlaybackFrame(state, input);
+  CHECK(update.timePoint == 3);
+  CHECK(update.droppedFrames == 2);
+  CHECK(state.numShownFrames == 1);
+  CHECK(state.numDroppedFrames == 2);
+
+  // The cadence of the frame rate is kept: the next frame is due 0.1 s after 1.3 s
+  input.activeTimePoint = update.timePoint;
+  input.nowSeconds = 1.38;
+  update = updateTimePlaybackFrame(state, input);
+  CHECK_FALSE(update.advanced);
+
+  input.nowSeconds = 1.42;
+  update = updateTimePlaybackFrame(state, input);
+  CHECK(update.timePoint == 4);
+  CHECK(update.droppedFrames == 0);
+
+  // Non-looping playback stops at the last frame
+  input.loop = false;
+  input.activeTimePoint = 8;
+  input.nowSeconds = 2.0;
+  update = updateTimePlaybackFrame(state, input);
+  CHECK(update.timePoint == 9);
+  CHECK(update.playing);
+  CHECK(update.droppedFrames == 0);
+}
@@ -71,6 +71,7 @@ struct GuiData
   bool m_showOpacityBlenderWindow = false;    //!< Show the opacity mixer window
   bool m_showImGuiDemoWindow = false;         //!< Show the ImGui demo window
   bool m_showImPlotDemoWindow = false;        //!< Show the ImPlot demo window
+  bool m_showProfilerWindow = false;          //!< Show the frame profiler window
   bool m_showAboutDialog = false;             //!< Show the About Entropy dialog
   bool m_showKeyboardShortcutsWindow = false; //!< Show the keyboard shortcuts reference window
   bool m_showAddLayoutPopup = false;          //!< Show the Add Layout popup
@@ -170,6 +171,7 @@ struct GuiData
     std::filesystem::path fileName;      //!< Source file shown in the loading popup
     std::optional<std::uintmax_t> bytes; //!< Source file size, when known
     bool loaded = false;                 //!< True after the file has loaded successfully
+    float fractionLoaded = 0.0f;         //!< Partial progress reported by the loader while not yet loaded
   };
 
   struct LoadingStatus
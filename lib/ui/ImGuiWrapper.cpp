@@ -1,5 +1,6 @@
 ﻿#include "ui/ImGuiWrapper.h"
 
+#include "common/FrameProfiler.h"
 #include "common/MathFuncs.h"
 
 #include "ui/Helpers.h"
@@ -1085,8 +1086,24 @@ void updateTimePlayback(AppData& appData, const uuids::uuid& imageUid, Image& im
 {
   static std::unordered_map<uuids::uuid, TimePlaybackState> s_playbackStateByImage;
 
+  // Report the frames that playback dropped to keep its frame rate once it stops
+  const auto stopPlayback = [&imageUid]() {
+    const auto it = s_playbackStateByImage.find(imageUid);
+    if (it == s_playbackStateByImage.end()) {
+      return;
+    }
+    if (it->second.numDroppedFrames > 0) {
+      spdlog::info(
+        "Time playback of image {} showed {} frames and dropped {} frames to keep the frame rate",
+        imageUid,
+        it->second.numShownFrames,
+        it->second.numDroppedFrames);
+    }
+    s_playbackStateByImage.erase(it);
+  };
+
   if (!image.settings().timePlaybackPlaying()) {
-    s_playbackStateByImage.erase(imageUid);
+    stopPlayback();
     return;
   }
 
@@ -1096,6 +1113,7 @@ void updateTimePlayback(AppData& appData, const uuids::uuid& imageUid, Image& im
     TimePlaybackInput{
       .playing = image.settings().timePlaybackPlaying(),
       .loop = image.settings().timePlaybackLoop(),
+      .bounce = image.settings().timePlaybackBounce(),
       .activeTimePoint = activeTimePoint,
       .numTimePoints = image.timeAxis().numTimePoints(),
       .framePeriodSeconds = image.timeAxis().playbackFramePeriodSeconds(image.settings().timePlaybackSpeed()),
@@ -1103,8 +1121,11 @@ void updateTimePlayback(AppData& appData, const uuids::uuid& imageUid, Image& im
   if (update.playingChanged) {
     image.settings().setTimePlaybackPlaying(update.playing);
   }
+  if (update.droppedFrames > 0) {
+    spdlog::debug("Time playback of image {} dropped {} frames", imageUid, update.droppedFrames);
+  }
   if (!update.playing) {
-    s_playbackStateByImage.erase(imageUid);
+    stopPlayback();
   }
   if (!update.advanced) {
     return;
@@ -1123,6 +1144,9 @@ bool anyTimeSeriesPlaybackRunning(const AppData& appData)
 
 void updateAllTimeSeriesPlayback(AppData& appData)
 {
+  // Show streamed time points whose frames were read in the background since the last frame
+  refreshPendingTimePointTextures(appData);
+
   std::optional<uuids::uuid> playbackDriverUid;
   for (const uuids::uuid& imageUid : appData.imageUidsOrdered()) {
     Image* image = appData.image(imageUid);
@@ -1130,6 +1154,9 @@ void updateAllTimeSeriesPlayback(AppData& appData)
       continue;
     }
 
+    // Statistics of streamed images grow as their frame caches summarize more time points
+    image->updateStreamedComponentStats();
+
     if (image->settings().timePlaybackPlaying()) {
       if (playbackDriverUid) {
         image->settings().setTimePlaybackPlaying(false);
@@ -1269,6 +1296,14 @@ void renderGlobalTimeControl(AppData& appData)
     if (ImGui::IsItemHovered()) {
       ImGui::SetTooltip("Loop playback from the last frame back to the first frame");
     }
+    ImGui::SameLine();
+    bool bounce = image->settings().timePlaybackBounce();
+    if (ImGui::Checkbox("Bounce##globalTimePlaybackBounce", &bounce)) {
+      image->settings().setTimePlaybackBounce(bounce);
+    }
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip("Play back and forth between the first and last frames");
+    }
 
     if (requestedTimePoint != activeTimePoint) {
       setTimePointWithSynchronization(appData, *imageUid, *image, requestedTimePoint);
@@ -1649,6 +1684,14 @@ bool imageIsOnlyNonWarpImage(const AppData& appData, const uuids::uuid& imageUid
   return foundImage && nonWarpImageCount == 1u;
 }
 
+/// Finish the ImGui frame and draw it with OpenGL
+void renderImGuiDrawData()
+{
+  const profiling::GpuScope scope("ImGui draw");
+  ImGui::Render();
+  ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+}
+
 } // namespace
 
 ImGuiWrapper::ImGuiWrapper(GLFWwindow* window, AppData& appData, CallbackHandler& callbackHandler)
@@ -1716,6 +1759,7 @@ void ImGuiWrapper::setCallbacks(ImGuiWrapperCallbacks callbacks)
 {
   m_postEmptyGlfwEvent = std::move(callbacks.platform.postEmptyGlfwEvent);
   m_readjustViewport = std::move(callbacks.platform.readjustViewport);
+  m_invalidateViewRenderCache = std::move(callbacks.platform.invalidateViewRenderCache);
 
   m_openImageFiles = std::move(callbacks.project.openImageFiles);
   m_addImageFiles = std::move(callbacks.project.addImageFiles);
@@ -1763,8 +1807,11 @@ void ImGuiWrapper::setCallbacks(ImGuiWrapperCallbacks callbacks)
 
   m_createBlankSeg = std::move(callbacks.editing.createBlankSeg);
   m_clearSeg = std::move(callbacks.editing.clearSeg);
+  m_exportSegLabelMeshes = std::move(callbacks.editing.exportSegLabelMeshes);
   m_removeSeg = std::move(callbacks.editing.removeSeg);
   m_executePoissonSeg = std::move(callbacks.editing.executePoissonSeg);
+  m_getPoissonSegProgress = std::move(callbacks.editing.getPoissonSegProgress);
+  m_cancelPoissonSeg = std::move(callbacks.editing.cancelPoissonSeg);
   m_setLockManualImageTransformation = std::move(callbacks.editing.setLockManualImageTransformation);
   m_setReferenceImage = std::move(callbacks.editing.setReferenceImage);
   m_removeImage = std::move(callbacks.editing.removeImage);
@@ -1954,7 +2001,8 @@ void ImGuiWrapper::requestComponentProjectionImage(
   std::vector<uint32_t> requestedTimePoints;
   requestedTimePoints.reserve(image->timeAxis().numTimePoints());
   requestedTimePoints.push_back(timePoint);
-  for (uint32_t i = 0; i < image->timeAxis().numTimePoints(); ++i) {
+  // Only the resident time point of an image with streamed time points can be projected
+  for (uint32_t i = 0; i < image->timeAxis().numTimePoints() && !image->streamsTimePoints(); ++i) {
     if (i != timePoint) {
       requestedTimePoints.push_back(i);
     }
@@ -1998,6 +2046,7 @@ void ImGuiWrapper::requestComponentProjectionImages(
   Image imageCopy = *image;
   auto future =
     std::async(std::launch::async, [imageUid, mode, missingTimePoints, imageCopy = std::move(imageCopy)]() mutable {
+      const profiling::CpuScope scope("Component projection");
       ComponentProjectionTaskResult result{imageUid, mode, {}};
       result.frames.reserve(missingTimePoints.size());
       for (const uint32_t timePoint : missingTimePoints) {
@@ -2041,7 +2090,7 @@ void ImGuiWrapper::requestMissingComponentProjectionImages()
       std::vector<uint32_t> requestedTimePoints;
       requestedTimePoints.reserve(image->timeAxis().numTimePoints());
       requestedTimePoints.push_back(timePoint);
-      for (uint32_t i = 0; i < image->timeAxis().numTimePoints(); ++i) {
+      for (uint32_t i = 0; i < image->timeAxis().numTimePoints() && !image->streamsTimePoints(); ++i) {
         if (i != timePoint) {
           requestedTimePoints.push_back(i);
         }
@@ -2124,8 +2173,8 @@ void ImGuiWrapper::processComponentProjectionFutures()
       result.frames.size());
   }
 
-  if (!readyTasks.empty() && m_postEmptyGlfwEvent) {
-    m_postEmptyGlfwEvent();
+  if (!readyTasks.empty()) {
+    redrawViews();
   }
 }
 
@@ -2235,6 +2284,7 @@ void ImGuiWrapper::requestWarpInversion(
      postEmptyEvent,
      sourceWarpCopy = std::move(sourceWarpCopy),
      outputDomainCopy = std::move(outputDomainCopy)]() mutable {
+      const profiling::CpuScope scope("Warp inversion");
       auto progressCallback = [progress, lastPostedProgress, postEmptyEvent](double value) {
         const double clamped = std::clamp(value, 0.0, 1.0);
         progress->store(clamped);
@@ -2361,8 +2411,8 @@ void ImGuiWrapper::processWarpInversionFutures()
     }
   }
 
-  if (!readyTasks.empty() && m_postEmptyGlfwEvent) {
-    m_postEmptyGlfwEvent();
+  if (!readyTasks.empty()) {
+    redrawViews();
   }
 }
 
@@ -2442,6 +2492,7 @@ void ImGuiWrapper::requestQueuedRegistrationJobs()
        keepTemporaryFiles,
        pendingOutputLines,
        registrationMutex]() {
+        const profiling::CpuScope scope("Registration job");
         registration::JobExecution execution;
         try {
           registration::ShellProcessRunner runner;
@@ -2577,7 +2628,17 @@ void ImGuiWrapper::processRegistrationJobFutures()
     }
   }
 
-  if (!readyTasks.empty() && m_postEmptyGlfwEvent) {
+  if (!readyTasks.empty()) {
+    redrawViews();
+  }
+}
+
+void ImGuiWrapper::redrawViews()
+{
+  if (m_invalidateViewRenderCache) {
+    m_invalidateViewRenderCache();
+  }
+  if (m_postEmptyGlfwEvent) {
     m_postEmptyGlfwEvent();
   }
 }
@@ -2696,93 +2757,51 @@ void ImGuiWrapper::addTaskToIsosurfaceGpuMeshGenerationQueue(const uuids::uuid&
 
 void ImGuiWrapper::generateIsosurfaceMeshGpuRecords()
 {
-  std::lock_guard<std::mutex> lock(m_isosurfaceTaskQueueMutex);
+  std::queue<uuids::uuid> taskUids;
+  {
+    std::lock_guard<std::mutex> lock(m_isosurfaceTaskQueueMutex);
+    std::swap(taskUids, m_isosurfaceTaskQueueForGpuMeshGeneration);
+  }
 
-  while (!m_isosurfaceTaskQueueForGpuMeshGeneration.empty()) {
-    const uuids::uuid taskUid = m_isosurfaceTaskQueueForGpuMeshGeneration.front();
-    m_isosurfaceTaskQueueForGpuMeshGeneration.pop();
+  while (!taskUids.empty()) {
+    const uuids::uuid taskUid = taskUids.front();
+    taskUids.pop();
 
-    auto it = m_futures.find(taskUid);
-    if (std::end(m_futures) == it) {
-      spdlog::error("Invalid task {}", taskUid);
-      continue;
+    std::future<AsyncTaskDetails> future;
+    {
+      std::lock_guard<std::mutex> lock(m_futuresMutex);
+      auto it = m_futures.find(taskUid);
+      if (std::end(m_futures) == it) {
+        spdlog::error("Invalid task {}", taskUid);
+        continue;
+      }
+      future = std::move(it->second);
+      m_futures.erase(it);
     }
 
-    auto& future = it->second;
-
     // In case the CPU mesh generation task is not done, then wait for it to finish
     // and get the result. (Note: it should be done, since tasks only get on this queue when
     // CPU mesh generation is done.)
-    const AsyncTaskDetails value = future.get();
-
-    // Remove the future
-    m_futures.erase(it);
-
-    if (
-      AsyncTasks::IsosurfaceMeshGeneration != value.task || !value.success || !value.imageUid ||
-      !value.imageComponent || !value.objectUid)
-    {
-      spdlog::error("Failed task {}", taskUid);
-      continue;
-    }
-
-    spdlog::info("Task {}: Start generating GPU mesh for isosurface {} ", taskUid, *value.objectUid);
-
-    // Get the isosurface associated with this task
-    const Isosurface* surface = m_appData.isosurface(*value.imageUid, *value.imageComponent, *value.objectUid);
-    if (!surface) {
-      spdlog::error("Null isosurface for isosurface {} of image {}", *value.objectUid, *value.imageUid);
-      continue;
+    AsyncTaskDetails value;
+    try {
+      value = future.get();
     }
-
-#if 0
-    const MeshCpuRecord* cpuMeshRecord = surface->mesh.cpuData();
-
-    if (!cpuMeshRecord)
-    {
-      spdlog::error(
-        "Null CPU mesh record for isosurface {} of image {}", *value.objectUid, *value.imageUid
-      );
+    catch (const std::exception& e) {
+      spdlog::error("Task {} failed: {}", taskUid, e.what());
       continue;
     }
 
-    std::unique_ptr<MeshGpuRecord> gpuMeshRecord = gpuhelper::createMeshGpuRecordFromVtkPolyData(
-      cpuMeshRecord->polyData(),
-      cpuMeshRecord->meshInfo().primitiveType(),
-      BufferUsagePattern::StreamDraw
-    );
-
-    if (!gpuMeshRecord)
+    if (
+      AsyncTasks::IsosurfaceMeshGeneration != value.task || !value.success || !value.imageUid ||
+      !value.imageComponent || !value.objectUid)
     {
-      spdlog::error(
-        "Error generating GPU mesh record for isosurface {} of image {}",
-        *value.objectUid,
-        *value.imageUid
-      );
+      spdlog::debug("Failed task {}", taskUid);
       continue;
     }
 
-    spdlog::info("Task {}: Done generating GPU mesh for isosurface {} ", taskUid, *value.objectUid);
-
-    const bool updated = m_appData.updateIsosurfaceMeshGpuRecord(
-      *value.imageUid, *value.imageComponent, *value.objectUid, std::move(gpuMeshRecord)
-    );
-
-    if (updated)
-    {
-      spdlog::info(
-        "Updated GPU record for isosurface mesh {} of image {}", *value.objectUid, *value.imageUid
-      );
-    }
-    else
-    {
-      spdlog::error(
-        "Could not update GPU record for isosurface mesh {} of image {}",
-        *value.objectUid,
-        *value.imageUid
-      );
-    }
-#endif
+    // Isosurfaces are drawn by raycasting the image, so the CPU mesh record stays in AppData,
+    // where it is exported from, and is not uploaded to the GPU.
+    spdlog::debug("Task {}: Done generating mesh for isosurface {}", taskUid, *value.objectUid);
   }
 }
 
@@ -2938,13 +2957,18 @@ void ImGuiWrapper::render()
   using namespace std::placeholders;
   const bool loadingOrImporting = m_appData.state().animating();
 
-  generateIsosurfaceMeshGpuRecords();
-  if (!loadingOrImporting) {
-    processComponentProjectionFutures();
+  const profiling::CpuScope scope("UI");
+
+  {
+    const profiling::CpuScope tasksScope("Background tasks");
+    generateIsosurfaceMeshGpuRecords();
+    if (!loadingOrImporting) {
+      processComponentProjectionFutures();
+    }
+    processWarpInversionFutures();
+    processRegistrationJobFutures();
+    requestQueuedRegistrationJobs();
   }
-  processWarpInversionFutures();
-  processRegistrationJobFutures();
-  requestQueuedRegistrationJobs();
 
   if (m_pendingUserScaleOverride) {
     m_uiScaleManager.setUserScaleOverride(*m_pendingUserScaleOverride);
@@ -3851,6 +3875,9 @@ void ImGuiWrapper::render()
       case MainMenuAction::ToggleImPlotDemoWindow:
         m_appData.guiData().m_showImPlotDemoWindow = !m_appData.guiData().m_showImPlotDemoWindow;
         break;
+      case MainMenuAction::ToggleProfilerWindow:
+        m_appData.guiData().m_showProfilerWindow = !m_appData.guiData().m_showProfilerWindow;
+        break;
       case MainMenuAction::ToggleToolbar:
         m_appData.guiData().m_showModeToolbar = !m_appData.guiData().m_showModeToolbar;
         if (m_readjustViewport) m_readjustViewport();
@@ -3961,6 +3988,8 @@ void ImGuiWrapper::render()
         case MainMenuAction::ToggleImPlotDemoWindow:
         case MainMenuAction::ToggleToolbar:
           return !backgroundTaskRunning;
+        case MainMenuAction::ToggleProfilerWindow:
+          return true;
         case MainMenuAction::ToggleSegmentationVisibility:
         case MainMenuAction::ToggleSegmentationOutline:
         case MainMenuAction::DecreaseSegmentationOpacity:
@@ -4155,6 +4184,8 @@ void ImGuiWrapper::render()
         return m_appData.guiData().m_showImGuiDemoWindow;
       case MainMenuAction::ToggleImPlotDemoWindow:
         return m_appData.guiData().m_showImPlotDemoWindow;
+      case MainMenuAction::ToggleProfilerWindow:
+        return m_appData.guiData().m_showProfilerWindow;
       default:
         return false;
     }
@@ -4346,6 +4377,10 @@ void ImGuiWrapper::render()
       ImPlot::ShowDemoWindow(&m_appData.guiData().m_showImPlotDemoWindow);
     }
 
+    ui::renderProfilerWindow(
+      m_appData.guiData().m_showProfilerWindow,
+      m_appData.renderData().m_targetFrameTimeSeconds);
+
     const auto activeImageUidForMenu = m_appData.activeImageUid();
     const auto refImageUidForMenu = m_appData.refImageUid();
     const bool activeImageCanSelfWarp =
@@ -4601,8 +4636,7 @@ void ImGuiWrapper::render()
       {
         m_postEmptyGlfwEvent();
       }
-      ImGui::Render();
-      ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+      renderImGuiDrawData();
       return;
     }
 
@@ -4690,6 +4724,7 @@ void ImGuiWrapper::render()
         m_createBlankSeg,
         m_addSegmentationFileToImage,
         m_clearSeg,
+        m_exportSegLabelMeshes,
         m_removeSeg,
         m_recenterAllViews);
     }
@@ -4765,14 +4800,15 @@ void ImGuiWrapper::render()
       m_updateImageUniforms,
       setMouseMode,
       m_readjustViewport,
-      m_executePoissonSeg);
+      m_executePoissonSeg,
+      m_getPoissonSegProgress,
+      m_cancelPoissonSeg);
 
     annotationToolbar(m_paintActiveSegmentationWithActivePolygon);
   }
 
   if (ProjectLoadState::Loaded != m_appData.state().projectLoadState() || 0 == m_appData.windowData().numLayouts()) {
-    ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    renderImGuiDrawData();
     return;
   }
 
@@ -5156,17 +5192,16 @@ void ImGuiWrapper::render()
 
   m_callbackHandler.refreshBrushPreviewIfNeeded();
 
+  // Edits made in the UI are applied while it is drawn, which is after the views of this frame were rendered
   if (
-    m_postEmptyGlfwEvent &&
-    (ImGui::IsAnyItemActive() || ImGui::IsMouseClicked(ImGuiMouseButton_Left) ||
-     ImGui::IsMouseReleased(ImGuiMouseButton_Left) || ImGui::IsMouseClicked(ImGuiMouseButton_Right) ||
-     ImGui::IsMouseReleased(ImGuiMouseButton_Right)))
+    ImGui::IsAnyItemActive() || ImGui::IsMouseClicked(ImGuiMouseButton_Left) ||
+    ImGui::IsMouseReleased(ImGuiMouseButton_Left) || ImGui::IsMouseClicked(ImGuiMouseButton_Right) ||
+    ImGui::IsMouseReleased(ImGuiMouseButton_Right))
   {
-    m_postEmptyGlfwEvent();
+    redrawViews();
   }
 
-  ImGui::Render();
-  ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+  renderImGuiDrawData();
 }
 
 void ImGuiWrapper::annotationToolbar(const std::function<void()>& paintActiveAnnotation)
@@ -44,6 +44,9 @@ struct ImGuiPlatformCallbacks
 
   /** @brief Resize and re-layout the viewport after UI state changes. */
   std::function<void()> readjustViewport;
+
+  /** @brief Render all views again instead of compositing them from the view render cache. */
+  std::function<void()> invalidateViewRenderCache;
 };
 
 /**
@@ -209,6 +212,9 @@ struct ImGuiEditingCallbacks
   /** @brief Clear all voxels in a segmentation. */
   std::function<bool(const uuids::uuid& segUid)> clearSeg;
 
+  /** @brief Mesh the label surfaces of a segmentation and write them to a directory. */
+  std::function<bool(const uuids::uuid& segUid, const std::filesystem::path& directory)> exportSegLabelMeshes;
+
   /** @brief Remove a segmentation. */
   std::function<bool(const uuids::uuid& segUid)> removeSeg;
 
@@ -216,6 +222,12 @@ struct ImGuiEditingCallbacks
   std::function<bool(const uuids::uuid& imageUid, const uuids::uuid& seedSegUid, const SeedSegmentationType& segType)>
     executePoissonSeg;
 
+  /** @brief Get the fraction complete of the running Poisson segmentation, or std::nullopt if none is running. */
+  std::function<std::optional<float>()> getPoissonSegProgress;
+
+  /** @brief Cancel the running Poisson segmentation. */
+  std::function<void()> cancelPoissonSeg;
+
   /** @brief Lock or unlock an image's manual transformation. */
   std::function<bool(const uuids::uuid& imageUid, bool locked)> setLockManualImageTransformation;
 
@@ -329,6 +341,7 @@ private:
   // Callbacks:
   std::function<void(void)> m_postEmptyGlfwEvent = nullptr;
   std::function<void(void)> m_readjustViewport = nullptr;
+  std::function<void(void)> m_invalidateViewRenderCache = nullptr;
   std::function<void(const std::vector<std::filesystem::path>& fileNames)> m_openImageFiles = nullptr;
   std::function<void(const std::vector<std::filesystem::path>& fileNames)> m_addImageFiles = nullptr;
   std::function<void(const std::vector<std::filesystem::path>& folderNames)> m_openDicomFolders = nullptr;
@@ -386,9 +399,13 @@ private:
   std::function<std::optional<uuids::uuid>(const uuids::uuid& matchingImageUid, const std::string& segDisplayName)>
     m_createBlankSeg = nullptr;
   std::function<bool(const uuids::uuid& segUid)> m_clearSeg = nullptr;
+  std::function<bool(const uuids::uuid& segUid, const std::filesystem::path& directory)> m_exportSegLabelMeshes =
+    nullptr;
   std::function<bool(const uuids::uuid& segUid)> m_removeSeg = nullptr;
   std::function<bool(const uuids::uuid& imageUid, const uuids::uuid& seedSegUid, const SeedSegmentationType&)>
     m_executePoissonSeg = nullptr;
+  std::function<std::optional<float>()> m_getPoissonSegProgress = nullptr;
+  std::function<void()> m_cancelPoissonSeg = nullptr;
   std::function<bool(const uuids::uuid& imageUid, bool locked)> m_setLockManualImageTransformation = nullptr;
   std::function<bool(const uuids::uuid& imageUid)> m_setReferenceImage = nullptr;
   std::function<bool(const uuids::uuid& imageUid)> m_removeImage = nullptr;
@@ -480,6 +497,9 @@ private:
   void requestQueuedRegistrationJobs();
   void processRegistrationJobFutures();
 
+  /// Render all views again and wake the event loop, after the UI changed what views show
+  void redrawViews();
+
   std::future<ui::updates::CheckResult> m_updateCheckFuture;
   ui::updates::CheckWindowState m_updateCheckWindowState;
   std::string m_updateCheckEtag;
@@ -490,8 +510,7 @@ private:
   void processUpdateCheckFuture();
 
   /// Queue of UIDs referring to task UIDs of futures.
-  /// These are completed isosurface mesh generation tasks that now need
-  /// mesh generation to be run on the GPU
+  /// These are completed isosurface mesh generation tasks whose futures need to be collected
   std::queue<uuids::uuid> m_isosurfaceTaskQueueForGpuMeshGeneration;
 
   /// Mutex protecting \c m_isosurfaceTaskQueueForGpuMeshGeneration
@@ -501,7 +520,7 @@ private:
   /// This is called once CPU mesh generation is complete.
   void addTaskToIsosurfaceGpuMeshGenerationQueue(const uuids::uuid& taskUid);
 
-  /// Generate GPU mesh records for isosurfaces in \c m_isosurfaceTaskQueueForGpuMeshGeneration
+  /// Collect the finished tasks in \c m_isosurfaceTaskQueueForGpuMeshGeneration
   void generateIsosurfaceMeshGpuRecords();
 
   /**
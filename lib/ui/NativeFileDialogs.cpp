@@ -283,4 +283,9 @@ std::vector<Filter> annotationFilters()
 {
   return {{"Annotation JSON", "json"}};
 }
+
+std::vector<Filter> meshFilters()
+{
+  return {{"PLY meshes", "ply"}, {"STL meshes", "stl"}, {"Wavefront OBJ meshes", "obj"}};
+}
 } // namespace native_dialog
@@ -135,4 +135,9 @@ std::vector<Filter> landmarkFilters();
  * @brief Filters for annotation files.
  */
 std::vector<Filter> annotationFilters();
+
+/**
+ * @brief Filters for surface mesh files that Entropy can export.
+ */
+std::vector<Filter> meshFilters();
 } // namespace native_dialog
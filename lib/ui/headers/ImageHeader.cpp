@@ -57,6 +57,7 @@
 #include <string>
 #include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -892,6 +893,14 @@ void renderTimeSeriesHeader(AppData& appData, const uuids::uuid& imageUid, Image
     if (ImGui::Checkbox("Loop", &loop)) {
       settings.setTimePlaybackLoop(loop);
     }
+    ImGui::SameLine();
+    bool bounce = settings.timePlaybackBounce();
+    if (ImGui::Checkbox("Bounce", &bounce)) {
+      settings.setTimePlaybackBounce(bounce);
+    }
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip("Play back and forth between the first and last frames");
+    }
 
     const double minPlaybackSpeed = minTimePlaybackSpeed(image);
     const double maxPlaybackSpeed = maxTimePlaybackSpeed(image);
@@ -3363,7 +3372,7 @@ void renderImageHeader(
     }
 
     const uint32_t comp = activeComp;
-    const void* buffer = image->bufferAsVoid(comp);
+    const void* buffer = std::as_const(*image).bufferAsVoid(comp);
     const int bufferSize = static_cast<int>(image->header().numPixels());
     const std::string& format = appData.guiData().m_imageValuePrecisionFormat;
 
@@ -1,11 +1,16 @@
 #include "ui/headers/IsosurfaceHeader.h"
 #include "ui/Helpers.h"
 #include "ui/IsosurfaceRangeModel.h"
+#include "ui/NativeFileDialogs.h"
 #include "ui/headers/HeaderCommon.h"
 
+#include "common/UuidUtility.h"
+
 #include "logic/SurfaceUtility.h"
 #include "logic/app/Data.h"
 
+#include "mesh/MeshLoading.h"
+
 #include <IconsForkAwesome.h>
 
 #include <imgui/imgui.h>
@@ -21,6 +26,8 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -74,6 +81,119 @@ std::pair<ImVec4, ImVec4> computeHeaderBgAndTextColors(const glm::vec3& color)
   return {headerColor, headerTextColor};
 }
 
+/**
+ * @brief Start generating the mesh of an isosurface at its isovalue and at the active time point of the image,
+ * unless a task is already generating its mesh or its mesh was already requested for them.
+ *
+ * @param appData Application data store that owns the isosurface meshes.
+ * @param image Image of the isosurface.
+ * @param imageUid UID of the image.
+ * @param component Image component of the isosurface.
+ * @param isosurfaceUid UID of the isosurface.
+ * @param isoValue Isovalue to mesh.
+ * @param storeFuture Callback that takes ownership of the mesh generation task future.
+ * @param addTaskToIsosurfaceGpuMeshGenerationQueue Callback that queues the finished task.
+ */
+void updateIsosurfaceMesh(
+  AppData& appData,
+  const Image& image,
+  const uuids::uuid& imageUid,
+  uint32_t component,
+  const uuids::uuid& isosurfaceUid,
+  double isoValue,
+  const std::function<void(const uuids::uuid& taskUid, std::future<AsyncTaskDetails> future)>& storeFuture,
+  const std::function<void(const uuids::uuid& taskUid)>& addTaskToIsosurfaceGpuMeshGenerationQueue)
+{
+  if (!storeFuture || !addTaskToIsosurfaceGpuMeshGenerationQueue) {
+    return;
+  }
+
+  const uint32_t timePoint = image.timeAxis().clamp(image.settings().activeTimePoint());
+
+  if (!appData.beginIsosurfaceMeshUpdate(imageUid, component, isosurfaceUid, isoValue, timePoint)) {
+    return;
+  }
+
+  // Function to cache the block ranges that a task computes, so that later tasks skip computing them
+  auto blockRangesUpdater =
+    [&appData, imageUid, component, timePoint](std::shared_ptr<const IsosurfaceBlockRanges> blockRanges)
+  {
+    appData.setIsosurfaceBlockRanges(imageUid, component, timePoint, std::move(blockRanges));
+  };
+
+  // Function to update the mesh record in AppData after the mesh is generated.
+  // The UIDs are captured by value, since the function is called from the task's thread.
+  auto meshCpuRecordUpdater =
+    [&appData, imageUid, component](const uuids::uuid& _isosurfaceUid, std::unique_ptr<MeshCpuRecord> meshCpuRecord)
+    -> bool
+  {
+    if (appData.updateIsosurfaceMeshCpuRecord(imageUid, component, _isosurfaceUid, std::move(meshCpuRecord))) {
+      spdlog::debug(
+        "Updated isosurface {} for image {} (component {}) with new mesh record", _isosurfaceUid, imageUid, component);
+      return true;
+    }
+
+    return false;
+  };
+
+  // Generate a new UID for the mesh generation task
+  const uuids::uuid taskUid = generateRandomUuid();
+
+  // Need to store the future so that its destructor is not called.
+  // Calling the destructor will cause us to wait on the future.
+  // Note: Bind the task ID to addTaskToIsosurfaceGpuMeshGenerationQueue
+  storeFuture(
+    taskUid,
+    generateIsosurfaceMeshCpuRecord(
+      image,
+      imageUid,
+      component,
+      timePoint,
+      isoValue,
+      isosurfaceUid,
+      appData.isosurfaceBlockRanges(imageUid, component, timePoint),
+      blockRangesUpdater,
+      meshCpuRecordUpdater,
+      std::bind(addTaskToIsosurfaceGpuMeshGenerationQueue, taskUid)));
+}
+
+/**
+ * @brief Save the latest mesh of an isosurface to a file chosen with the native save dialog.
+ *
+ * @param appData Application data store that owns the isosurface meshes.
+ * @param imageUid UID of the image.
+ * @param component Image component of the isosurface.
+ * @param isosurfaceUid UID of the isosurface.
+ * @param surface The isosurface.
+ */
+void saveIsosurfaceMesh(
+  const AppData& appData,
+  const uuids::uuid& imageUid,
+  uint32_t component,
+  const uuids::uuid& isosurfaceUid,
+  const Isosurface& surface)
+{
+  const auto record = appData.isosurfaceMeshCpuRecord(imageUid, component, isosurfaceUid);
+  if (!record) {
+    spdlog::warn("Isosurface {} has no mesh to save yet", isosurfaceUid);
+    return;
+  }
+
+  if (record->meshInfo().isoValue() != surface.value) {
+    spdlog::warn(
+      "Saving the mesh of isosurface {} at isovalue {}, since its mesh at isovalue {} is not ready yet",
+      isosurfaceUid,
+      record->meshInfo().isoValue(),
+      surface.value);
+  }
+
+  if (const auto selectedFile = native_dialog::saveFile(native_dialog::meshFilters(), {}, surface.name + ".ply")) {
+    if (!writeMeshToFile(*record, selectedFile->string())) {
+      spdlog::error("Failed to save mesh of isosurface {} to {}", isosurfaceUid, selectedFile->string());
+    }
+  }
+}
+
 /**
  * @brief Add an isosurface with a specific isovalue for one image component.
  *
@@ -84,8 +204,8 @@ std::pair<ImVec4, ImVec4> computeHeaderBgAndTextColors(const glm::vec3& color)
  * @param index One-based display index used to build the default surface name.
  * @param value Isovalue for the new surface.
  * @param color Display color for the new surface.
- * @param storeFuture Callback reserved for asynchronous mesh-generation task ownership.
- * @param addTaskToIsosurfaceGpuMeshGenerationQueue Callback reserved for queueing GPU mesh generation.
+ * @param storeFuture Callback that takes ownership of the mesh generation task future.
+ * @param addTaskToIsosurfaceGpuMeshGenerationQueue Callback that queues the finished mesh generation task.
  * @return UID of the created isosurface, or std::nullopt when creation fails.
  */
 std::optional<uuids::uuid> addSurfaceAtValue(
@@ -96,8 +216,8 @@ std::optional<uuids::uuid> addSurfaceAtValue(
   size_t index,
   double value,
   const glm::vec3& color,
-  const std::function<void(const uuids::uuid& taskUid, std::future<AsyncTaskDetails> future)>& /*storeFuture*/,
-  const std::function<void(const uuids::uuid& taskUid)>& /*addTaskToIsosurfaceGpuMeshGenerationQueue*/
+  const std::function<void(const uuids::uuid& taskUid, std::future<AsyncTaskDetails> future)>& storeFuture,
+  const std::function<void(const uuids::uuid& taskUid)>& addTaskToIsosurfaceGpuMeshGenerationQueue
 )
 {
   if (!image) {
@@ -119,56 +239,15 @@ std::optional<uuids::uuid> addSurfaceAtValue(
       component,
       value);
 
-#if 0
-    // Function to update the mesh record in AppData after the mesh is generated
-    auto meshCpuRecordUpdater =
-      [&appData,
-       &imageUid,
-       component](const uuids::uuid& _isosurfaceUid, std::unique_ptr<MeshCpuRecord> meshCpuRecord)
-      -> bool
-    {
-      if (appData.updateIsosurfaceMeshCpuRecord(
-            imageUid, component, _isosurfaceUid, std::move(meshCpuRecord)
-          ))
-      {
-        spdlog::debug(
-          "Updated isosurface {} for image {} (component {}) with new mesh record",
-          _isosurfaceUid,
-          imageUid,
-          component
-        );
-        return true;
-      }
-
-      spdlog::error(
-        "Error updating isosurface {} for image {} (component {}) with new mesh record",
-        _isosurfaceUid,
-        imageUid,
-        component
-      );
-
-      return false;
-    };
-
-    // Generate a new UID for the mesh generation task
-    uuids::uuid taskUid = generateRandomUuid();
-
-    // Need to store the future so that its destructor is not called.
-    // Calling the destructor will cause us to wait on the future.
-    // Note: Bind the task ID to addTaskToIsosurfaceGpuMeshGenerationQueue
-    storeFuture(
-      taskUid,
-      generateIsosurfaceMeshCpuRecord(
-        *image,
-        imageUid,
-        component,
-        value,
-        *isosurfaceUid,
-        meshCpuRecordUpdater,
-        std::bind(addTaskToIsosurfaceGpuMeshGenerationQueue, taskUid)
-      )
-    );
-#endif
+    updateIsosurfaceMesh(
+      appData,
+      *image,
+      imageUid,
+      component,
+      *isosurfaceUid,
+      value,
+      storeFuture,
+      addTaskToIsosurfaceGpuMeshGenerationQueue);
 
     return isosurfaceUid;
   }
@@ -187,8 +266,8 @@ std::optional<uuids::uuid> addSurfaceAtValue(
  * @param nextSurfaceIndex One-based display index for the first generated surface.
  * @param selectedSurfaceUid Selection updated to the last generated surface.
  * @param imageToSelectedSurfaceUid Per-image surface selection map.
- * @param storeFuture Callback reserved for asynchronous mesh-generation task ownership.
- * @param addTaskToIsosurfaceGpuMeshGenerationQueue Callback reserved for queueing GPU mesh generation.
+ * @param storeFuture Callback that takes ownership of the mesh generation task future.
+ * @param addTaskToIsosurfaceGpuMeshGenerationQueue Callback that queues the finished mesh generation task.
  * @return True when isosurfaces were added.
  */
 bool renderAddSurfacesDialog(
@@ -449,8 +528,8 @@ bool compareWithSortSpecs(
  * @param imageUid UID of the image receiving the new isosurface.
  * @param component Image component index receiving the new isosurface.
  * @param index One-based display index used to build the default surface name.
- * @param storeFuture Callback reserved for asynchronous mesh-generation task ownership.
- * @param addTaskToIsosurfaceGpuMeshGenerationQueue Callback reserved for queueing GPU mesh generation.
+ * @param storeFuture Callback that takes ownership of the mesh generation task future.
+ * @param addTaskToIsosurfaceGpuMeshGenerationQueue Callback that queues the finished mesh generation task.
  * @return UID of the created isosurface, or std::nullopt when creation fails.
  */
 std::optional<uuids::uuid> addNewSurface(
@@ -506,9 +585,6 @@ void renderIsosurfacesHeader(
   static const std::string sk_removeSurfaceButtonText = std::string(ICON_FK_TRASH_O) + std::string(" Remove");
   static const std::string sk_saveSurfacesButtonText = std::string(ICON_FK_FLOPPY_O) + std::string(" Save...");
 
-  //    static const char* sk_saveSurfaceDialogTitle( "Save Isosurface Mesh" );
-  //    static const std::vector< const char* > sk_saveSurfaceDialogFilters{};
-
   static const float sk_textBaseHeight = ImGui::GetTextLineHeightWithSpacing();
 
   static const IsosurfaceTableItemContentsType sk_contentsType = IsosurfaceTableItemContentsType::SelectableSpanRow;
@@ -855,6 +931,25 @@ void renderIsosurfacesHeader(
         ImGui::PopItemWidth();
       }
 
+      // Regenerate the mesh once the isovalue or time point changes. A surface has at most one task
+      // running, so dragging the isovalue meshes the latest value as soon as the previous task is done.
+      updateIsosurfaceMesh(
+        appData,
+        *image,
+        imageUid,
+        componentToAdjust,
+        item.m_surfaceUid,
+        item.m_surface->value,
+        storeFuture,
+        addTaskToIsosurfaceGpuMeshGenerationQueue);
+
+      item.m_surface->meshInSync = appData.isosurfaceMeshInSync(
+        imageUid,
+        componentToAdjust,
+        item.m_surfaceUid,
+        item.m_surface->value,
+        image->timeAxis().clamp(imgSettings.activeTimePoint()));
+
       ImGui::PopID(); // item.surfaceUid
     }
     ImGui::PopButtonRepeat();
@@ -932,13 +1027,18 @@ void renderIsosurfacesHeader(
     }
 
     ImGui::SameLine();
+    const bool hasMesh = (nullptr != appData.isosurfaceMeshCpuRecord(imageUid, componentToAdjust, *selectedSurfaceUid));
+    ImGui::BeginDisabled(!hasMesh);
     const bool saveSurface = ImGui::Button(sk_saveSurfacesButtonText.c_str());
-    if (ImGui::IsItemHovered()) {
-      ImGui::SetTooltip("Save isosurface...");
+    ImGui::EndDisabled();
+    if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+      ImGui::SetTooltip(hasMesh ? "Save isosurface mesh..." : "The isosurface mesh is being generated");
     }
 
     if (saveSurface) {
-      /// @todo Save
+      if (const Isosurface* surface = appData.isosurface(imageUid, componentToAdjust, *selectedSurfaceUid)) {
+        saveIsosurfaceMesh(appData, imageUid, componentToAdjust, *selectedSurfaceUid, *surface);
+      }
     }
 
     ImGui::Spacing();
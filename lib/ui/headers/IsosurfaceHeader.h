@@ -18,7 +18,7 @@ class AppData;
  * @param isActiveImage True when this image is the active image.
  * @param hasFollowingHeader True when another image header follows this one in the panel.
  * @param storeFuture Callback that stores asynchronous mesh-generation task futures.
- * @param addTaskToIsosurfaceGpuMeshGenerationQueue Callback that queues completed CPU meshes for GPU upload.
+ * @param addTaskToIsosurfaceGpuMeshGenerationQueue Callback that queues finished mesh generation tasks.
  */
 void renderIsosurfacesHeader(
   AppData& appData,
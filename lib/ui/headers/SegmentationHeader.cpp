@@ -83,11 +83,13 @@ void renderSegmentationHeader(
     std::optional<uuids::uuid>(const uuids::uuid& matchingImageUid, const std::string& segDisplayName)>& createBlankSeg,
   const std::function<void(const uuids::uuid& imageUid, const fs::path& fileName)>& addSegmentationFile,
   const std::function<bool(const uuids::uuid& segUid)>& clearSeg,
+  const std::function<bool(const uuids::uuid& segUid, const fs::path& directory)>& exportSegLabelMeshes,
   const std::function<bool(const uuids::uuid& segUid)>& removeSeg,
   const AllViewsRecenterType& recenterAllViews)
 {
   static const std::string addSegFromFileString = std::string(ICON_FK_FOLDER_OPEN_O) + " Add...";
   static const std::string SaveSegString = std::string(ICON_FK_FLOPPY_O) + " Save...";
+  static const std::string exportSegMeshesString = std::string(ICON_FK_CUBE) + " Export surfaces...";
   static const std::string addNewSegString = std::string(ICON_FK_FILE_O) + " Create";
   static const std::string clearSegString = std::string(ICON_FK_ERASER) + " Clear";
   static const std::string removeSegString = std::string(ICON_FK_TRASH_O) + " Remove";
@@ -261,6 +263,21 @@ void renderSegmentationHeader(
     }
   }
 
+  // Export the label surface meshes:
+  ImGui::SameLine();
+  ImGui::BeginDisabled(!exportSegLabelMeshes);
+  if (ImGui::Button(exportSegMeshesString.c_str())) {
+    if (const auto directory = native_dialog::pickFolder()) {
+      if (!exportSegLabelMeshes(*activeSegUid, *directory)) {
+        spdlog::error("Error exporting label surface meshes of segmentation {}", *activeSegUid);
+      }
+    }
+  }
+  ImGui::EndDisabled();
+  if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+    ImGui::SetTooltip("Mesh the surface of each label and save the meshes as PLY files in a folder");
+  }
+
   // Create blank segmentation:
   ImGui::SameLine();
   if (ImGui::Button(addNewSegString.c_str())) {
@@ -35,5 +35,6 @@ void renderSegmentationHeader(
     std::optional<uuids::uuid>(const uuids::uuid& matchingImageUid, const std::string& segDisplayName)>& createBlankSeg,
   const std::function<void(const uuids::uuid& imageUid, const std::filesystem::path& fileName)>& addSegmentationFile,
   const std::function<bool(const uuids::uuid& segUid)>& clearSeg,
+  const std::function<bool(const uuids::uuid& segUid, const std::filesystem::path& directory)>& exportSegLabelMeshes,
   const std::function<bool(const uuids::uuid& segUid)>& removeSeg,
   const AllViewsRecenterType& recenterAllViews);
@@ -895,6 +895,7 @@ void addWindowsMenu(NSMenu* mainMenu) {
   addSymbolActionMenuItem(menu, @"Reset Panel Layout", MainMenuAction::ResetPanelLayout, @"rectangle.3.group");
   [menu addItem:[NSMenuItem separatorItem]];
   addSymbolActionMenuItem(menu, @"Toolbar", MainMenuAction::ToggleToolbar, @"wrench.and.screwdriver");
+  addSymbolActionMenuItem(menu, @"Frame Profiler", MainMenuAction::ToggleProfilerWindow, @"gauge.with.needle");
 #ifndef NDEBUG
   addActionMenuItem(menu, @"ImGui Demo", MainMenuAction::ToggleImGuiDemoWindow);
   addActionMenuItem(menu, @"ImPlot Demo", MainMenuAction::ToggleImPlotDemoWindow);
@@ -744,6 +744,7 @@ void renderMainMenuBar(GuiData& uiData, const MainMenuBarCallbacks& callbacks)
       main_menu::actionMenuItem(callbacks, "Application Settings", MainMenuAction::ToggleSettingsWindow, "Ctrl+,");
       ImGui::Separator();
       main_menu::actionMenuItem(callbacks, "Toolbar", MainMenuAction::ToggleToolbar);
+      main_menu::actionMenuItem(callbacks, "Frame Profiler", MainMenuAction::ToggleProfilerWindow);
 #ifndef NDEBUG
       main_menu::actionMenuItem(callbacks, "ImGui Demo", MainMenuAction::ToggleImGuiDemoWindow);
       main_menu::actionMenuItem(callbacks, "ImPlot Demo", MainMenuAction::ToggleImPlotDemoWindow);
@@ -112,6 +112,7 @@ enum class MainMenuAction
   ShowSynchronizeSettingsWindow,
   ToggleInspectorWindow,
   ToggleOpacityMixerWindow,
+  ToggleProfilerWindow,
   ResetPanelLayout,
   ToggleImGuiDemoWindow,
   ToggleImPlotDemoWindow,
@@ -1015,7 +1015,8 @@ bool populateWindowsMenu(HMENU menu)
     insertActionMenuItem(menu, position++, MainMenuAction::ToggleRegistrationJobsWindow, L"Registration &Jobs") &&
     insertActionMenuItem(menu, position++, MainMenuAction::ToggleSettingsWindow, L"Application Se&ttings\tCtrl+,") &&
     insertSeparator(menu, position++) &&
-    insertActionMenuItem(menu, position++, MainMenuAction::ToggleToolbar, L"T&oolbar");
+    insertActionMenuItem(menu, position++, MainMenuAction::ToggleToolbar, L"T&oolbar") &&
+    insertActionMenuItem(menu, position++, MainMenuAction::ToggleProfilerWindow, L"&Frame Profiler");
 #ifndef NDEBUG
   ok = ok && insertActionMenuItem(menu, position++, MainMenuAction::ToggleImGuiDemoWindow, L"ImGui &Demo") &&
        insertActionMenuItem(menu, position++, MainMenuAction::ToggleImPlotDemoWindow, L"ImPlot Demo");
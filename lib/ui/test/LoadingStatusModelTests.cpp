@@ -45,3 +45,17 @@ TEST_CASE("Loading status progress gives unknown-size items fallback weight", "[
   CHECK(progress.total == 2u);
   CHECK(model::progressFraction(progress) == Catch::Approx(0.5f));
 }
+
+TEST_CASE("Loading status progress counts partially loaded items", "[ui][loading_status]")
+{
+  std::vector<GuiData::LoadingStatusItem> items{
+    {GuiData::LoadingStatusItem::Kind::Image, "series-a.dcm", 100u, true},
+    {GuiData::LoadingStatusItem::Kind::Image, "series-b.dcm", 300u, false}};
+  items[1].fractionLoaded = 0.5f;
+
+  const model::LoadingProgress progress = model::loadingProgress(items);
+
+  CHECK(progress.loaded == 250u);
+  CHECK(progress.total == 400u);
+  CHECK(model::progressFraction(progress) == Catch::Approx(0.625f));
+}
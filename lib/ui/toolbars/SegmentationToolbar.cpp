@@ -33,7 +33,9 @@ void renderSegToolbar(
   const std::function<void(MouseMode)>& setMouseMode,
   const std::function<void(void)>& readjustViewport,
   const std::function<bool(const uuids::uuid& imageUid, const uuids::uuid& seedSegUid, const SeedSegmentationType&)>&
-    executePoissonSeg)
+    executePoissonSeg,
+  const std::function<std::optional<float>(void)>& getPoissonSegProgress,
+  const std::function<void(void)>& cancelPoissonSeg)
 {
   // Show the segmentation toolbar in either Segmentation mode,
   // in Annotation mode (when the Fill button is also visible),
@@ -44,8 +46,6 @@ void renderSegToolbar(
 
   GuiData& guiData = appData.guiData();
 
-  static_cast<void>(executePoissonSeg);
-
   const auto buttonSize = scaledToolbarButtonSize(appData.windowData().getContentScaleRatios());
   const auto padSize = scaledPad(appData.windowData().getContentScaleRatios());
 
@@ -340,6 +340,45 @@ void renderSegToolbar(
     }
     ImGui::PopID();
 
+    // Random walker segmentation of the active image, seeded by the labels of its active segmentation.
+    // While it runs in the background, the button shows its progress and cancels it.
+    if (inSegmentationMode) {
+      if (isHoriz) {
+        ImGui::SameLine();
+      }
+
+      ImGui::PushID(id);
+      {
+        const std::optional<float> poissonProgress = getPoissonSegProgress ? getPoissonSegProgress() : std::nullopt;
+
+        if (!poissonProgress) {
+          if (ImGui::Button(ICON_FK_MAGIC, buttonSize) && executePoissonSeg) {
+            executePoissonSeg(*activeImageUid, *activeSegUid, SeedSegmentationType::MultiLabel);
+          }
+          if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("%s", "Segment the active image from the labels of the active segmentation (random walker)");
+          }
+        }
+        else {
+          const std::string progressLabel =
+            std::to_string(static_cast<int>(100.0f * *poissonProgress)) + "%###poissonProgress";
+
+          ImGui::PushStyleColor(ImGuiCol_Button, activeColor);
+          if (ImGui::Button(progressLabel.c_str(), buttonSize) && cancelPoissonSeg) {
+            cancelPoissonSeg();
+          }
+          ImGui::PopStyleColor(1); // ImGuiCol_Button
+
+          if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("%s", "Random walker segmentation is running: click to cancel it");
+          }
+        }
+
+        ++id;
+      }
+      ImGui::PopID();
+    }
+
     // Only show these segmentation toolbar buttons when in Segmentation mode
     if (inSegmentationMode) {
       if (isHoriz) {
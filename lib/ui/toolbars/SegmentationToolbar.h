@@ -31,4 +31,6 @@ void renderSegToolbar(
   const std::function<void(MouseMode)>& setMouseMode,
   const std::function<void(void)>& readjustViewport,
   const std::function<bool(const uuids::uuid& imageUid, const uuids::uuid& seedSegUid, const SeedSegmentationType&)>&
-    executePoissonSeg);
+    executePoissonSeg,
+  const std::function<std::optional<float>(void)>& getPoissonSegProgress,
+  const std::function<void(void)>& cancelPoissonSeg);
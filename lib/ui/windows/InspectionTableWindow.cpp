@@ -423,15 +423,20 @@ warpedSamplePosition(const AppData& appData, const uuid& imageUid, const Image&
   const glm::dvec3 defVoxel = glm::dvec3{defVoxelH} / defVoxelH.w;
   const uint32_t timePoint = def->timeAxis().clamp(def->settings().activeTimePoint());
 
-  const auto dx = def->valueLinear<double>(0, defVoxel.x, defVoxel.y, defVoxel.z, timePoint);
-  const auto dy = def->valueLinear<double>(1, defVoxel.x, defVoxel.y, defVoxel.z, timePoint);
-  const auto dz = def->valueLinear<double>(2, defVoxel.x, defVoxel.y, defVoxel.z, timePoint);
-  if (!dx || !dy || !dz) {
+  std::optional<glm::dvec3> displacement;
+  def->visitComponentViews<3>(timePoint, [&](const auto& views) {
+    const auto dx = views[0].linear(defVoxel.x, defVoxel.y, defVoxel.z);
+    const auto dy = views[1].linear(defVoxel.x, defVoxel.y, defVoxel.z);
+    const auto dz = views[2].linear(defVoxel.x, defVoxel.y, defVoxel.z);
+    if (dx && dy && dz) {
+      displacement = glm::dvec3{*dx, *dy, *dz};
+    }
+  });
+  if (!displacement) {
     return std::nullopt;
   }
 
-  const glm::dvec3 sampleWorld =
-    worldPos + static_cast<double>(image.settings().warpStrength()) * glm::dvec3{*dx, *dy, *dz};
+  const glm::dvec3 sampleWorld = worldPos + static_cast<double>(image.settings().warpStrength()) * *displacement;
   const glm::dvec4 sampleVoxelH = glm::dmat4{image.transformations().pixel_T_worldDef()} * glm::dvec4{sampleWorld, 1.0};
   const glm::dvec4 sampleSubjectH =
     glm::dmat4{image.transformations().subject_T_worldDef()} * glm::dvec4{sampleWorld, 1.0};
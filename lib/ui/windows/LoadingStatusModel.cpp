@@ -20,6 +20,10 @@ LoadingProgress loadingProgress(const std::vector<GuiData::LoadingStatusItem>& i
     if (item.loaded) {
       progress.loaded += weight;
     }
+    else if (item.fractionLoaded > 0.0f) {
+      const double fraction = std::clamp(static_cast<double>(item.fractionLoaded), 0.0, 1.0);
+      progress.loaded += static_cast<std::uintmax_t>(fraction * static_cast<double>(weight));
+    }
   }
   return progress;
 }
@@ -28,6 +28,8 @@ std::uintmax_t loadingItemWeight(const GuiData::LoadingStatusItem& item);
 
 /**
  * @brief Compute aggregate byte-weighted progress over all loading rows.
+ *
+ * @details Rows that are not yet loaded count with the fraction of their weight reported by their loader.
  */
 LoadingProgress loadingProgress(const std::vector<GuiData::LoadingStatusItem>& items);
 
@@ -0,0 +1,383 @@
+#include "ui/windows/ProfilerWindow.h"
+
+#include "common/FrameProfiler.h"
+#include "ui/NativeFileDialogs.h"
+#include "ui/Scaling.h"
+
+#include <imgui/imgui.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <format>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ui
+{
+namespace
+{
+using profiling::FrameProfiler;
+using profiling::ProfiledFrame;
+using profiling::ProfileSpan;
+using profiling::ScopeSummary;
+using profiling::SpanTrack;
+
+constexpr float k_historyHeight = 80.0f;
+constexpr float k_timelineRowHeight = 18.0f;
+constexpr double k_nsPerMs = 1.0e6;
+
+/// State of the profiler window that persists between frames
+struct ProfilerWindowState
+{
+  bool paused = false;
+  std::deque<ProfiledFrame> pausedFrames; //!< Frames shown while paused
+  std::optional<uint64_t> selectedFrame;  //!< Index of the frame shown in the timeline, or none for the latest
+  std::string exportStatus;
+};
+
+ProfilerWindowState& windowState()
+{
+  static ProfilerWindowState s_state;
+  return s_state;
+}
+
+double toMs(int64_t ns)
+{
+  return static_cast<double>(ns) / k_nsPerMs;
+}
+
+/// Color of a scope, which is stable across frames
+ImU32 scopeColor(std::string_view name, bool overBudget)
+{
+  if (overBudget) {
+    return ImColor::HSV(0.0f, 0.65f, 0.85f);
+  }
+  const float hue = static_cast<float>(std::hash<std::string_view>{}(name) % 1000) / 1000.0f;
+  return ImColor::HSV(0.25f + 0.45f * hue, 0.45f, 0.75f);
+}
+
+/// Frame shown in the timeline: the selected one if it is still kept, else the latest frame with all GPU results
+const ProfiledFrame* frameToShow(const std::deque<ProfiledFrame>& frames, const std::optional<uint64_t>& selected)
+{
+  if (selected) {
+    const auto it = std::find_if(std::begin(frames), std::end(frames), [&selected](const ProfiledFrame& f) {
+      return f.index == *selected;
+    });
+    if (std::end(frames) != it) {
+      return &(*it);
+    }
+  }
+
+  const auto it =
+    std::find_if(std::rbegin(frames), std::rend(frames), [](const ProfiledFrame& f) { return !f.gpuPending; });
+  return (std::rend(frames) != it) ? &(*it) : (frames.empty() ? nullptr : &frames.back());
+}
+
+void renderCaptureControls(FrameProfiler& profiler)
+{
+  ProfilerWindowState& state = windowState();
+
+  if (profiler.capturing()) {
+    if (ImGui::Button("Stop Capture")) {
+      profiler.stopCapture();
+    }
+    ImGui::SameLine();
+    ImGui::Text("Capturing: %zu spans", profiler.capturedSpanCount());
+    return;
+  }
+
+  if (ImGui::Button("Start Capture")) {
+    profiler.setEnabled(true);
+    profiler.startCapture();
+    state.exportStatus.clear();
+  }
+  if (ImGui::IsItemHovered(ImGuiHoveredFlags_ForTooltip)) {
+    ImGui::SetTooltip("%s", "Keep every span until the capture stops, for export as a trace");
+  }
+
+  if (0 == profiler.capturedSpanCount()) {
+    return;
+  }
+
+  ImGui::SameLine();
+  if (ImGui::Button("Export Trace...")) {
+    if (const auto fileName = native_dialog::saveFile({{"Chrome trace", "json"}}, {}, "entropy-trace.json")) {
+      const auto written = profiler.exportCapture(*fileName);
+      state.exportStatus = written ? std::format("Wrote {} spans to {}", *written, fileName->string())
+                                   : std::format("Export failed: {}", written.error());
+    }
+  }
+  if (ImGui::IsItemHovered(ImGuiHoveredFlags_ForTooltip)) {
+    ImGui::SetTooltip("%s", "Save the capture as Chrome trace events, which Perfetto and chrome://tracing open");
+  }
+
+  ImGui::SameLine();
+  ImGui::Text("%zu spans captured", profiler.capturedSpanCount());
+}
+
+/// Bars of recent frame times with a line at the frame budget. Clicking a bar selects its frame.
+void renderFrameHistory(const std::deque<ProfiledFrame>& frames, const ProfiledFrame* shown, double budgetNs)
+{
+  ProfilerWindowState& state = windowState();
+
+  const float width = ImGui::GetContentRegionAvail().x;
+  const float height = scaledSize(0.0f, k_historyHeight).y;
+  const ImVec2 p0 = ImGui::GetCursorScreenPos();
+  const ImVec2 p1{p0.x + width, p0.y + height};
+
+  ImGui::InvisibleButton("##frameHistory", ImVec2{width, height});
+  const bool hovered = ImGui::IsItemHovered();
+  const bool clicked = ImGui::IsItemClicked(ImGuiMouseButton_Left);
+
+  ImDrawList* drawList = ImGui::GetWindowDrawList();
+  drawList->AddRectFilled(p0, p1, ImGui::GetColorU32(ImGuiCol_FrameBg));
+
+  int64_t maxNs = static_cast<int64_t>(2.0 * budgetNs);
+  for (const ProfiledFrame& frame : frames) {
+    maxNs = std::max(maxNs, frame.durationNs);
+  }
+
+  const float barWidth = width / static_cast<float>(FrameProfiler::sk_maxFrames);
+  const float mouseX = ImGui::GetIO().MousePos.x;
+
+  for (std::size_t i = 0; i < frames.size(); ++i) {
+    const ProfiledFrame& frame = frames[i];
+    const float x0 = p1.x - static_cast<float>(frames.size() - i) * barWidth;
+    const float barHeight = height * static_cast<float>(frame.durationNs) / static_cast<float>(maxNs);
+    const bool overBudget = static_cast<double>(frame.durationNs) > budgetNs;
+
+    ImU32 color = overBudget ? ImColor::HSV(0.0f, 0.65f, 0.85f) : ImColor::HSV(0.33f, 0.55f, 0.7f);
+    if (shown && shown->index == frame.index) {
+      color = ImGui::GetColorU32(ImGuiCol_PlotHistogramHovered);
+    }
+    drawList->AddRectFilled(ImVec2{x0, p1.y - barHeight}, ImVec2{x0 + std::max(barWidth - 1.0f, 1.0f), p1.y}, color);
+
+    if (hovered && mouseX >= x0 && mouseX < x0 + barWidth) {
+      ImGui::SetTooltip("Frame %llu: %.2f ms", static_cast<unsigned long long>(frame.index), toMs(frame.durationNs));
+      if (clicked) {
+        state.selectedFrame = frame.index;
+      }
+    }
+  }
+
+  const float budgetY = p1.y - height * static_cast<float>(budgetNs / static_cast<double>(maxNs));
+  drawList->AddLine(ImVec2{p0.x, budgetY}, ImVec2{p1.x, budgetY}, ImGui::GetColorU32(ImGuiCol_Text), 1.0f);
+  drawList->AddText(
+    ImVec2{p0.x + 4.0f, budgetY - ImGui::GetTextLineHeight()},
+    ImGui::GetColorU32(ImGuiCol_Text),
+    std::format("Budget {:.2f} ms", budgetNs / k_nsPerMs).c_str());
+}
+
+/// One lane of the timeline per thread and one for the GPU, with a row per nesting depth
+void renderTimeline(const ProfiledFrame& frame, const std::vector<std::string>& threadNames, double budgetNs)
+{
+  // Lanes are keyed by (track, thread) so that the GPU lane comes after the threads
+  std::map<std::pair<SpanTrack, uint32_t>, uint32_t> laneDepths;
+
+  int64_t beginNs = frame.startNs;
+  int64_t endNs = frame.startNs + frame.durationNs;
+
+  for (const ProfileSpan& span : frame.spans) {
+    const uint32_t thread = (SpanTrack::Gpu == span.track) ? 0 : span.threadIndex;
+    uint32_t& depth = laneDepths[{span.track, thread}];
+    depth = std::max(depth, span.depth + 1);
+
+    // GPU spans may finish after the frame ends on the CPU
+    beginNs = std::min(beginNs, span.startNs);
+    endNs = std::max(endNs, span.startNs + span.durationNs);
+  }
+
+  if (laneDepths.empty()) {
+    ImGui::TextDisabled("No scopes were recorded in this frame");
+    return;
+  }
+
+  const float rowHeight = scaledSize(0.0f, k_timelineRowHeight).y;
+  const float labelWidth = scaledSize(90.0f, 0.0f).x;
+  const float width = std::max(ImGui::GetContentRegionAvail().x - labelWidth, 1.0f);
+  const double nsToPixels = static_cast<double>(width) / static_cast<double>(std::max<int64_t>(endNs - beginNs, 1));
+
+  ImDrawList* drawList = ImGui::GetWindowDrawList();
+  const ImU32 textColor = ImGui::GetColorU32(ImGuiCol_Text);
+  const ImVec2 mouse = ImGui::GetIO().MousePos;
+
+  for (const auto& [lane, numRows] : laneDepths) {
+    const auto& [track, thread] = lane;
+    std::string laneName = "GPU";
+    if (SpanTrack::Cpu == track) {
+      laneName = (thread < threadNames.size()) ? threadNames[thread] : std::format("Thread {}", thread);
+    }
+
+    const ImVec2 p0 = ImGui::GetCursorScreenPos();
+    const float laneHeight = static_cast<float>(numRows) * rowHeight;
+    ImGui::Dummy(ImVec2{labelWidth + width, laneHeight + 2.0f});
+    const bool laneHovered = ImGui::IsItemHovered();
+
+    drawList->AddText(p0, textColor, laneName.c_str());
+    drawList->AddRectFilled(
+      ImVec2{p0.x + labelWidth, p0.y},
+      ImVec2{p0.x + labelWidth + width, p0.y + laneHeight},
+      ImGui::GetColorU32(ImGuiCol_FrameBg));
+
+    for (const ProfileSpan& span : frame.spans) {
+      if (span.track != track || (SpanTrack::Cpu == track && span.threadIndex != thread)) {
+        continue;
+      }
+
+      const float x0 = p0.x + labelWidth + static_cast<float>((span.startNs - beginNs) * nsToPixels);
+      const float x1 = std::max(x0 + 1.0f, x0 + static_cast<float>(span.durationNs * nsToPixels));
+      const float y0 = p0.y + static_cast<float>(span.depth) * rowHeight;
+      const ImVec2 r0{x0, y0};
+      const ImVec2 r1{x1, y0 + rowHeight - 1.0f};
+
+      const bool overBudget = static_cast<double>(span.durationNs) > budgetNs;
+      drawList->AddRectFilled(r0, r1, scopeColor(span.name, overBudget));
+
+      // Label the span with as much of its name as fits
+      if (x1 - x0 > 8.0f) {
+        const std::string label =
+          span.detail.empty() ? std::string(span.name) : std::format("{}: {}", span.name, span.detail);
+        drawList->PushClipRect(r0, r1, true);
+        drawList->AddText(ImVec2{x0 + 2.0f, y0 + 1.0f}, IM_COL32(0, 0, 0, 255), label.c_str());
+        drawList->PopClipRect();
+      }
+
+      if (laneHovered && mouse.x >= r0.x && mouse.x < r1.x && mouse.y >= r0.y && mouse.y < r1.y) {
+        ImGui::BeginTooltip();
+        ImGui::TextUnformatted(span.name);
+        if (!span.detail.empty()) {
+          ImGui::TextUnformatted(span.detail.c_str());
+        }
+        ImGui::Text("%.3f ms", toMs(span.durationNs));
+        ImGui::Text("Starts at %.3f ms", toMs(span.startNs - frame.startNs));
+        ImGui::EndTooltip();
+      }
+    }
+  }
+}
+
+/// Table of the scopes of a frame by total time. Scopes that exceed the frame budget are highlighted.
+void renderSummaryTable(const ProfiledFrame& frame, double budgetNs)
+{
+  constexpr ImGuiTableFlags flags = ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_BordersOuter |
+                                    ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY |
+                                    ImGuiTableFlags_SizingStretchProp;
+
+  if (!ImGui::BeginTable("ProfilerSummaryTable", 6, flags, ImVec2{0.0f, 0.0f})) {
+    return;
+  }
+
+  ImGui::TableSetupColumn("Track", ImGuiTableColumnFlags_WidthFixed);
+  ImGui::TableSetupColumn("Scope", ImGuiTableColumnFlags_WidthStretch);
+  ImGui::TableSetupColumn("Detail", ImGuiTableColumnFlags_WidthStretch);
+  ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_WidthFixed);
+  ImGui::TableSetupColumn("Total (ms)", ImGuiTableColumnFlags_WidthFixed);
+  ImGui::TableSetupColumn("Self (ms)", ImGuiTableColumnFlags_WidthFixed);
+  ImGui::TableSetupScrollFreeze(0, 1);
+  ImGui::TableHeadersRow();
+
+  const ImU32 overBudgetColor = ImColor(0.85f, 0.2f, 0.2f, 0.35f);
+
+  for (const ScopeSummary& summary : profiling::summarizeSpans(frame.spans)) {
+    ImGui::TableNextRow();
+    if (static_cast<double>(summary.totalNs) > budgetNs) {
+      ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg1, overBudgetColor);
+    }
+
+    ImGui::TableNextColumn();
+    ImGui::TextUnformatted(SpanTrack::Gpu == summary.track ? "GPU" : "CPU");
+    ImGui::TableNextColumn();
+    ImGui::TextUnformatted(summary.name.c_str());
+    ImGui::TableNextColumn();
+    ImGui::TextUnformatted(summary.detail.c_str());
+    ImGui::TableNextColumn();
+    ImGui::Text("%u", summary.calls);
+    ImGui::TableNextColumn();
+    ImGui::Text("%.3f", toMs(summary.totalNs));
+    ImGui::TableNextColumn();
+    ImGui::Text("%.3f", toMs(summary.selfNs));
+  }
+
+  ImGui::EndTable();
+}
+} // namespace
+
+void renderProfilerWindow(bool& open, double frameBudgetSeconds)
+{
+  if (!open) {
+    return;
+  }
+
+  ImGui::SetNextWindowSize(ui::viewportClampedScaledSize(900.0f, 640.0f), ImGuiCond_FirstUseEver);
+  if (!ImGui::Begin("Frame Profiler", &open)) {
+    ImGui::End();
+    return;
+  }
+
+  FrameProfiler& profiler = FrameProfiler::instance();
+  ProfilerWindowState& state = windowState();
+  const double budgetNs = frameBudgetSeconds * 1.0e9;
+
+  bool enabled = FrameProfiler::isEnabled();
+  if (ImGui::Checkbox("Record frames", &enabled)) {
+    profiler.setEnabled(enabled);
+  }
+  ImGui::SameLine();
+  if (ImGui::Checkbox("Pause", &state.paused) && state.paused) {
+    state.pausedFrames = profiler.frames();
+  }
+  ImGui::SameLine();
+  ImGui::TextDisabled(profiler.gpuTimingAvailable() ? "GPU timing available" : "GPU timing unavailable");
+
+  renderCaptureControls(profiler);
+  if (!state.exportStatus.empty()) {
+    ImGui::TextWrapped("%s", state.exportStatus.c_str());
+  }
+
+  ImGui::Separator();
+
+  const std::deque<ProfiledFrame>& frames = state.paused ? state.pausedFrames : profiler.frames();
+  if (frames.empty()) {
+    ImGui::TextDisabled("Enable recording to profile frames");
+    ImGui::End();
+    return;
+  }
+
+  const ProfiledFrame* shown = frameToShow(frames, state.selectedFrame);
+  renderFrameHistory(frames, shown, budgetNs);
+
+  if (!shown) {
+    ImGui::End();
+    return;
+  }
+
+  ImGui::Text(
+    "Frame %llu: %.2f ms%s",
+    static_cast<unsigned long long>(shown->index),
+    toMs(shown->durationNs),
+    shown->gpuPending ? " (waiting for GPU results)" : "");
+  if (state.selectedFrame) {
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Show Latest")) {
+      state.selectedFrame.reset();
+    }
+  }
+
+  if (ImGui::CollapsingHeader("Timeline", ImGuiTreeNodeFlags_DefaultOpen)) {
+    renderTimeline(*shown, profiler.threadNames(), budgetNs);
+  }
+
+  if (ImGui::CollapsingHeader("Scopes", ImGuiTreeNodeFlags_DefaultOpen)) {
+    renderSummaryTable(*shown, budgetNs);
+  }
+
+  ImGui::End();
+}
+} // namespace ui
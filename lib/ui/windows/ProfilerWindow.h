@@ -0,0 +1,13 @@
+#pragma once
+
+namespace ui
+{
+/**
+ * @brief Render the frame profiler window: recent frame times, a timeline of the scopes of one frame on each thread
+ * and on the GPU, a summary of the scopes, and controls for capturing and exporting a trace.
+ *
+ * @param open Whether the window is open. Cleared when the user closes the window.
+ * @param frameBudgetSeconds Target frame time. Frames and scopes that exceed it are highlighted.
+ */
+void renderProfilerWindow(bool& open, double frameBudgetSeconds);
+} // namespace ui
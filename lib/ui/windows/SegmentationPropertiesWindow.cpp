@@ -32,6 +32,7 @@ void renderSegmentationPropertiesWindow(
     createBlankSeg,
   const std::function<void(const uuid& imageUid, const fs::path& fileName)>& addSegmentationFile,
   const std::function<bool(const uuid& segUid)>& clearSeg,
+  const std::function<bool(const uuid& segUid, const fs::path& directory)>& exportSegLabelMeshes,
   const std::function<bool(const uuid& segUid)>& removeSeg,
   const AllViewsRecenterType& recenterAllViews)
 {
@@ -66,6 +67,7 @@ void renderSegmentationPropertiesWindow(
           createBlankSeg,
           addSegmentationFile,
           clearSeg,
+          exportSegLabelMeshes,
           removeSeg,
           recenterAllViews);
       }
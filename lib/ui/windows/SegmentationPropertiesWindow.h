@@ -23,6 +23,7 @@ class ParcellationLabelTable;
  * @param createBlankSeg Callback that creates a blank segmentation for an image.
  * @param addSegmentationFile Callback that loads a segmentation file for an image.
  * @param clearSeg Callback that clears a segmentation.
+ * @param exportSegLabelMeshes Callback that writes the label surface meshes of a segmentation to a directory.
  * @param removeSeg Callback that removes a segmentation.
  * @param recenterAllViews Callback used by segmentation controls that reposition views.
  */
@@ -36,5 +37,6 @@ void renderSegmentationPropertiesWindow(
     std::optional<uuids::uuid>(const uuids::uuid& matchingImageUid, const std::string& segDisplayName)>& createBlankSeg,
   const std::function<void(const uuids::uuid& imageUid, const std::filesystem::path& fileName)>& addSegmentationFile,
   const std::function<bool(const uuids::uuid& segUid)>& clearSeg,
+  const std::function<bool(const uuids::uuid& segUid, const std::filesystem::path& directory)>& exportSegLabelMeshes,
   const std::function<bool(const uuids::uuid& segUid)>& removeSeg,
   const AllViewsRecenterType& recenterAllViews);
@@ -2323,6 +2323,21 @@ void renderRenderingTab(RenderData& renderData)
         renderData.m_targetFrameTimeSeconds = sec;
       }
     }
+
+    ImGui::Checkbox("Reuse unchanged views", &(renderData.m_useViewRenderCache));
+    ImGui::SameLine();
+    helpMarker(
+      "Keep an offscreen copy of each view and redraw a view only when its camera, crosshairs, "
+      "settings, or data change. This lowers CPU and GPU usage while the views are idle");
+
+    if (renderData.m_useViewRenderCache) {
+      const auto& stats = renderData.m_viewRenderCacheStats;
+      ImGui::Text(
+        "Views reused: %llu, redrawn: %llu (%.1f%% reused)",
+        static_cast<unsigned long long>(stats.hits),
+        static_cast<unsigned long long>(stats.misses),
+        100.0 * stats.hitRate());
+    }
   }
   finishSettingsSection(frameRateOpen);
 
@@ -6,6 +6,7 @@
 #include "ui/windows/IsosurfacesWindow.h"
 #include "ui/windows/KeyboardShortcuts.h"
 #include "ui/windows/LandmarkPropertiesWindow.h"
+#include "ui/windows/ProfilerWindow.h"
 #include "ui/windows/RegistrationWindow.h"
 #include "ui/windows/SegmentationPropertiesWindow.h"
 #include "ui/windows/SettingsWindow.h"
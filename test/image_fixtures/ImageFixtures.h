@@ -0,0 +1,171 @@
+#pragma once
+
+#include "common/Types.h"
+#include "image/Image.h"
+#include "image/ImageHeader.h"
+#include "image/ImageIoInfo.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief In-memory images for unit tests, which would otherwise each fill in an ImageIoInfo by hand.
+ */
+namespace image_fixtures
+{
+
+/// Component type that stores values of type T
+template<typename T>
+constexpr ComponentType componentTypeOf()
+{
+  if constexpr (std::is_same_v<T, int8_t>) {
+    return ComponentType::Int8;
+  }
+  else if constexpr (std::is_same_v<T, uint8_t>) {
+    return ComponentType::UInt8;
+  }
+  else if constexpr (std::is_same_v<T, int16_t>) {
+    return ComponentType::Int16;
+  }
+  else if constexpr (std::is_same_v<T, uint16_t>) {
+    return ComponentType::UInt16;
+  }
+  else if constexpr (std::is_same_v<T, int32_t>) {
+    return ComponentType::Int32;
+  }
+  else if constexpr (std::is_same_v<T, uint32_t>) {
+    return ComponentType::UInt32;
+  }
+  else {
+    static_assert(std::is_same_v<T, float>, "Unsupported component type");
+    return ComponentType::Float32;
+  }
+}
+
+/// Size of one component, or 0 for types that images do not store
+inline uint32_t componentSizeInBytes(ComponentType componentType)
+{
+  switch (componentType) {
+    case ComponentType::Int8:
+    case ComponentType::UInt8:
+      return 1;
+    case ComponentType::Int16:
+    case ComponentType::UInt16:
+      return 2;
+    case ComponentType::Int32:
+    case ComponentType::UInt32:
+    case ComponentType::Float32:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief I/O information of a 3D NRRD image with identity directions.
+ * @param componentType Component type
+ * @param numComponents Number of components per pixel. Images with more than one are vector images.
+ * @param dims Image dimensions in voxels
+ * @param spacing Voxel spacing
+ * @param origin Origin of the first voxel
+ */
+inline ImageIoInfo makeIoInfo(
+  ComponentType componentType,
+  uint32_t numComponents,
+  const glm::uvec3& dims,
+  const glm::dvec3& spacing = glm::dvec3{1.0},
+  const glm::dvec3& origin = glm::dvec3{0.0})
+{
+  ImageIoInfo info;
+  info.m_fileInfo.m_fileName = "synthetic.nrrd";
+  info.m_fileInfo.m_fileTypeString = "Nrrd";
+
+  info.m_componentInfo.m_componentType = componentType;
+  info.m_componentInfo.m_componentTypeString = componentTypeString(componentType);
+  info.m_componentInfo.m_componentSizeInBytes = componentSizeInBytes(componentType);
+
+  info.m_pixelInfo.m_pixelType = (1 == numComponents) ? PixelType::Scalar : PixelType::Vector;
+  info.m_pixelInfo.m_pixelTypeString = (1 == numComponents) ? "scalar" : "vector";
+  info.m_pixelInfo.m_numComponents = numComponents;
+  info.m_pixelInfo.m_pixelStrideInBytes = info.m_componentInfo.m_componentSizeInBytes * numComponents;
+
+  info.m_sizeInfo.m_imageSizeInPixels = static_cast<std::size_t>(dims.x) * dims.y * dims.z;
+  info.m_sizeInfo.m_imageSizeInComponents = info.m_sizeInfo.m_imageSizeInPixels * numComponents;
+  info.m_sizeInfo.m_imageSizeInBytes =
+    info.m_sizeInfo.m_imageSizeInComponents * info.m_componentInfo.m_componentSizeInBytes;
+
+  info.m_spaceInfo.m_numDimensions = 3;
+  info.m_spaceInfo.m_dimensions = {dims.x, dims.y, dims.z};
+  info.m_spaceInfo.m_origin = {origin.x, origin.y, origin.z};
+  info.m_spaceInfo.m_spacing = {spacing.x, spacing.y, spacing.z};
+  info.m_spaceInfo.m_directions = {{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}};
+  return info;
+}
+
+/**
+ * @brief Scalar image with values from a function of the voxel index.
+ * @param dims Image dimensions in voxels
+ * @param spacing Voxel spacing
+ * @param fn Value of the voxel at an index
+ * @param displayName Display name of the image
+ */
+template<typename T>
+Image makeScalarImage(
+  const glm::uvec3& dims,
+  const glm::dvec3& spacing,
+  const std::function<T(const glm::vec3&)>& fn,
+  const std::string& displayName = "image")
+{
+  const ImageIoInfo info = makeIoInfo(componentTypeOf<T>(), 1, dims, spacing);
+
+  std::vector<T> values;
+  values.reserve(info.m_sizeInfo.m_imageSizeInPixels);
+  for (uint32_t k = 0; k < dims.z; ++k) {
+    for (uint32_t j = 0; j < dims.y; ++j) {
+      for (uint32_t i = 0; i < dims.x; ++i) {
+        values.push_back(fn(glm::vec3{i, j, k}));
+      }
+    }
+  }
+
+  const ImageHeader header(info, info, false);
+  const std::vector<const void*> buffers{values.data()};
+  return Image(
+    header, displayName, Image::ImageRepresentation::Image, Image::MultiComponentBufferType::SeparateImages, buffers);
+}
+
+/// Segmentation with 8-bit labels that are all 0
+inline Image makeSegmentation(const glm::uvec3& dims, const glm::dvec3& spacing = glm::dvec3{1.0})
+{
+  const ImageIoInfo info = makeIoInfo(ComponentType::UInt8, 1, dims, spacing);
+
+  const ImageHeader header(info, info, false);
+  const std::vector<uint8_t> labels(info.m_sizeInfo.m_imageSizeInPixels, 0);
+  const std::vector<const void*> buffers{labels.data()};
+  return Image(
+    header,
+    "seg",
+    Image::ImageRepresentation::Segmentation,
+    Image::MultiComponentBufferType::SeparateImages,
+    buffers);
+}
+
+/// Set the label of the voxels in a box of an 8-bit segmentation, including both corners
+inline void fillBox(Image& seg, const glm::ivec3& minVoxel, const glm::ivec3& maxVoxel, uint8_t label)
+{
+  for (int k = minVoxel.z; k <= maxVoxel.z; ++k) {
+    for (int j = minVoxel.y; j <= maxVoxel.y; ++j) {
+      for (int i = minVoxel.x; i <= maxVoxel.x; ++i) {
+        seg.mutableView<uint8_t>(0)->at(i, j, k) = label;
+      }
+    }
+  }
+}
+
+} // namespace image_fixtures